@@ -35,6 +35,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <time.h>
 #include <signal.h>
 
 #include <sys/epoll.h>
@@ -47,6 +48,7 @@
 #include "assertions.h"
 #include "intertask_interface.h"
 #include "intertask_interface_dump.h"
+#include "intertask_interface_trace.h"
 
 #include "memory_pools.h"
 
@@ -61,6 +63,8 @@
 #include "timer.h"
 #include "dynamic_memory_check.h"
 #include "log.h"
+#include "msc.h"
+#include "probes.h"
 
 /* ITTI DEBUG groups */
 #define ITTI_DEBUG_POLL             (1<<0)
@@ -150,11 +154,63 @@ typedef struct task_desc_s {
    * Queue of messages belonging to the task
    */
   struct lfds611_queue_state             *message_queue;
+
+  /*
+   * Number of messages waiting in the queue
+   */
+  volatile uint32_t                       queue_depth;
+
+  /*
+   * Shard running the task, 0 if the task has its own thread
+   */
+  uint32_t                                shard;
+
+  /*
+   * Handler of the messages of the task when it runs in a shard
+   */
+  itti_task_handler_t                     handler;
+
+  /*
+   * Set by the shard thread when the task exits, its next messages are dropped
+   */
+  uint32_t                                shard_task_ended;
 } task_desc_t;
 
+/* Tasks run to completion by one thread */
+typedef struct shard_desc_s {
+  pthread_t                               thread;
+
+  /*
+   * Thread of the first task of the shard, its event fd is the event fd of all tasks of the shard
+   */
+  thread_id_t                             thread_id;
+
+  /*
+   * Tasks of the shard, nb_tasks is read by the shard thread while tasks are added
+   */
+  task_id_t                              *task_ids;
+  volatile uint32_t                       nb_tasks;
+  uint32_t                                nb_tasks_ended;
+  uint32_t                                next_task;    ///< Round robin over the task queues
+
+  /*
+   * Messages sent between tasks of the shard, only accessed by the shard thread
+   */
+  message_list_t                         *run_queue;
+  uint32_t                                run_queue_size;
+  uint32_t                                run_queue_head;
+  uint32_t                                run_queue_tail;
+
+  /*
+   * READY once the thread is created, ENDED once joined, both by the thread that creates and joins tasks
+   */
+  task_state_t                            state;
+} shard_desc_t;
+
 typedef struct itti_desc_s {
   thread_desc_t                          *threads;
   task_desc_t                            *tasks;
+  shard_desc_t                           *shards;  ///< Indexed by shard, shard 0 unused
 
   /*
    * Current message number. Incremented every call to send_msg_to_task
@@ -167,6 +223,7 @@ typedef struct itti_desc_s {
 
   bool                                    thread_handling_signals;
   pthread_t                               thread_ref;
+  task_id_t                               statistics_task_id;  ///< Receives STATISTICS_MESSAGE on SIGUSR2
 
   const task_info_t                      *tasks_info;
   const message_info_t                   *messages_info;
@@ -188,6 +245,12 @@ typedef struct itti_desc_s {
 
 static itti_desc_t                      itti_desc;
 
+/* Shard run by the current thread and task of the message it handles */
+static __thread shard_desc_t           *itti_shard_current = NULL;
+static __thread task_id_t               itti_shard_task_id = TASK_UNKNOWN;
+
+#define ITTI_SHARD_RUN_QUEUE_SIZE       (64)
+
 void                                   *
 itti_malloc (
   task_id_t origin_task_id,
@@ -263,6 +326,54 @@ itti_get_task_name (
   return (itti_desc.tasks_info[task_id].name);
 }
 
+uint64_t
+itti_get_task_cpu_time_ns (
+  task_id_t task_id)
+{
+  thread_id_t                             thread_id = TASK_GET_THREAD_ID (task_id);
+  clockid_t                               clock_id;
+  struct timespec                         ts;
+
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  if ((itti_desc.threads[thread_id].task_state != TASK_STATE_READY) ||
+      (pthread_getcpuclockid (itti_desc.threads[thread_id].task_thread, &clock_id) != 0) ||
+      (clock_gettime (clock_id, &ts) != 0)) {
+    return 0;
+  }
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+uint32_t
+itti_get_task_queue_depth (
+  task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  return __atomic_load_n (&itti_desc.tasks[task_id].queue_depth, __ATOMIC_RELAXED);
+}
+
+uint32_t
+itti_get_task_queue_size (
+  task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  return itti_desc.tasks_info[task_id].queue_size;
+}
+
+int
+itti_get_memory_pool_stats (
+  uint32_t pool,
+  memory_pool_stats_t * stats)
+{
+  return memory_pools_get_stats (itti_desc.memory_pools_handle, pool, stats);
+}
+
+uint32_t
+itti_release_idle_memory (
+  void)
+{
+  return memory_pools_release_idle (itti_desc.memory_pools_handle);
+}
+
 static                                  task_id_t
 itti_get_current_task_id (
   void)
@@ -271,6 +382,10 @@ itti_get_current_task_id (
   thread_id_t                             thread_id;
   pthread_t                               thread = pthread_self ();
 
+  if (itti_shard_task_id != TASK_UNKNOWN) {
+    return itti_shard_task_id;
+  }
+
   for (task_id = TASK_FIRST; task_id < itti_desc.task_max; task_id++) {
     thread_id = TASK_GET_THREAD_ID (task_id);
 
@@ -282,6 +397,24 @@ itti_get_current_task_id (
   return TASK_UNKNOWN;
 }
 
+static void
+itti_shard_push (
+  shard_desc_t * shard,
+  MessageDef * message,
+  message_number_t message_number,
+  uint32_t priority)
+{
+  if (shard->run_queue_tail == shard->run_queue_size) {
+    shard->run_queue_size *= 2;
+    shard->run_queue = realloc (shard->run_queue, shard->run_queue_size * sizeof (message_list_t));
+    AssertFatal (shard->run_queue != NULL, "Shard run queue of %u messages allocation failed!\n", shard->run_queue_size);
+  }
+
+  shard->run_queue[shard->run_queue_tail].msg = message;
+  shard->run_queue[shard->run_queue_tail].message_number = message_number;
+  shard->run_queue[shard->run_queue_tail].message_priority = priority;
+  shard->run_queue_tail++;
+}
 
 void
 itti_update_lte_time (
@@ -361,6 +494,9 @@ itti_alloc_new_message_sized (
   temp->ittiMsgHeader.messageId = message_id;
   temp->ittiMsgHeader.originTaskId = origin_task_id;
   temp->ittiMsgHeader.ittiMsgSize = size;
+#if ITTI_TRACE
+  itti_trace_message_alloc (temp);
+#endif
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_ALLOC_MSG, 0);
   return temp;
 }
@@ -402,6 +538,10 @@ itti_send_msg_to_task (
    * Increment the global message number
    */
   message_number = itti_increment_message_number ();
+  OAI_PROBE5 (itti_send, message_id, message_number, origin_task_id, destination_task_id, instance);
+#if ITTI_TRACE
+  itti_trace_message_send (message);
+#endif
 #if ENABLE_ITTI_ANALYZER
   itti_dump_queue_message (origin_task_id, message_number, message, itti_desc.messages_info[message_id].name, sizeof (MessageHeader) + message->ittiMsgHeader.ittiMsgSize);
 #endif
@@ -421,6 +561,19 @@ itti_send_msg_to_task (
       AssertFatal (itti_desc.threads[destination_thread_id].task_state == TASK_STATE_READY,
                    "Task %s Cannot send message %s (%d) to thread %d, it is not in ready state (%d)!\n",
                    itti_get_task_name (origin_task_id), itti_desc.messages_info[message_id].name, message_id, destination_thread_id, itti_desc.threads[destination_thread_id].task_state);
+
+      if ((itti_shard_current != NULL) && (itti_shard_current == &itti_desc.shards[itti_desc.tasks[destination_task_id].shard])) {
+        /*
+         * Destination task runs in this thread, handled when the current message is done
+         */
+        itti_shard_push (itti_shard_current, message, message_number, priority);
+        __atomic_add_fetch (&itti_desc.tasks[destination_task_id].queue_depth, 1, __ATOMIC_RELAXED);
+        ITTI_DEBUG (ITTI_DEBUG_SEND, " Message %s, number %lu with priority %d successfully sent from %s to shard task (%u:%s)\n",
+                    itti_desc.messages_info[message_id].name, message_number, priority, itti_get_task_name (origin_task_id), destination_task_id, itti_get_task_name (destination_task_id));
+        VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_SEND_MSG, __sync_and_and_fetch (&itti_desc.vcd_send_msg, ~(1L << destination_task_id)));
+        return 0;
+      }
+
       /*
        * Allocate new list element
        */
@@ -434,7 +587,10 @@ itti_send_msg_to_task (
       /*
        * Enqueue message in destination task queue
        */
-      lfds611_queue_enqueue (itti_desc.tasks[destination_task_id].message_queue, new);
+      __atomic_add_fetch (&itti_desc.tasks[destination_task_id].queue_depth, 1, __ATOMIC_RELAXED);
+      if (lfds611_queue_enqueue (itti_desc.tasks[destination_task_id].message_queue, new) == 0) {
+        __atomic_sub_fetch (&itti_desc.tasks[destination_task_id].queue_depth, 1, __ATOMIC_RELAXED);
+      }
       VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE, VCD_FUNCTION_OUT);
       {
         /*
@@ -477,6 +633,7 @@ itti_subscribe_event_fd (
   struct epoll_event                      event;
 
   AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  AssertFatal (itti_desc.tasks[task_id].shard == 0, "Task %s runs in shard %u, it cannot monitor fd %d!\n", itti_get_task_name (task_id), itti_desc.tasks[task_id].shard, fd);
   thread_id = TASK_GET_THREAD_ID (task_id);
   itti_desc.threads[thread_id].nb_events++;
   /*
@@ -608,7 +765,12 @@ itti_receive_msg_internal_event_fd (
       }
 
       AssertFatal (message != NULL, "Message from message queue is NULL!\n");
+      __atomic_sub_fetch (&itti_desc.tasks[task_id].queue_depth, 1, __ATOMIC_RELAXED);
       *received_msg = message->msg;
+      OAI_PROBE4 (itti_receive, ITTI_MSG_ID (message->msg), message->message_number, task_id, ITTI_MSG_ORIGIN_ID (message->msg));
+#if ITTI_TRACE
+      itti_trace_task_receive (task_id, message->msg, message->message_number);
+#endif
       result = itti_free (ITTI_MSG_ORIGIN_ID (message->msg), message);
       AssertFatal (result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
       /*
@@ -626,6 +788,10 @@ itti_receive_msg (
   MessageDef ** received_msg)
 {
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_RECV_MSG, __sync_and_and_fetch (&itti_desc.vcd_receive_msg, ~(1L << task_id)));
+#if ITTI_TRACE
+  // the previous message is processed, the events of the fds are not messages
+  itti_trace_task_idle ();
+#endif
   itti_receive_msg_internal_event_fd (task_id, 0, received_msg);
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_RECV_MSG, __sync_or_and_fetch (&itti_desc.vcd_receive_msg, 1L << task_id));
 }
@@ -637,6 +803,9 @@ itti_poll_msg (
 {
   AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
   *received_msg = NULL;
+#if ITTI_TRACE
+  itti_trace_task_idle ();
+#endif
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_POLL_MSG, __sync_or_and_fetch (&itti_desc.vcd_poll_msg, 1L << task_id));
   {
     struct message_list_s                  *message;
@@ -644,7 +813,12 @@ itti_poll_msg (
     if (lfds611_queue_dequeue (itti_desc.tasks[task_id].message_queue, (void **)&message) == 1) {
       int                                     result;
 
+      __atomic_sub_fetch (&itti_desc.tasks[task_id].queue_depth, 1, __ATOMIC_RELAXED);
       *received_msg = message->msg;
+      OAI_PROBE4 (itti_receive, ITTI_MSG_ID (message->msg), message->message_number, task_id, ITTI_MSG_ORIGIN_ID (message->msg));
+#if ITTI_TRACE
+      itti_trace_task_receive (task_id, message->msg, message->message_number);
+#endif
       result = itti_free (ITTI_MSG_ORIGIN_ID (*received_msg), message);
       AssertFatal (result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
     }
@@ -698,6 +872,187 @@ itti_create_task (
   return 0;
 }
 
+void
+itti_set_task_shard (
+  task_id_t task_id,
+  uint32_t shard)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  AssertFatal (shard < itti_desc.task_max, "Shard (%u) is out of range (%d)!\n", shard, itti_desc.task_max);
+  AssertFatal (TASK_GET_PARENT_TASK_ID (task_id) == TASK_UNKNOWN, "Sub-task %s cannot run in a shard!\n", itti_get_task_name (task_id));
+  AssertFatal (itti_desc.threads[TASK_GET_THREAD_ID (task_id)].task_state == TASK_STATE_NOT_CONFIGURED, "Task %s is already created!\n", itti_get_task_name (task_id));
+  itti_desc.tasks[task_id].shard = shard;
+}
+
+uint32_t
+itti_get_task_shard (
+  task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task id (%d) is out of range (%d)!\n", task_id, itti_desc.task_max);
+  return itti_desc.tasks[task_id].shard;
+}
+
+static void
+itti_shard_handle_message (
+  task_id_t task_id,
+  MessageDef * message,
+  message_number_t message_number)
+{
+  OAI_PROBE4 (itti_receive, ITTI_MSG_ID (message), message_number, task_id, ITTI_MSG_ORIGIN_ID (message));
+
+  if (itti_desc.tasks[task_id].shard_task_ended) {
+    /*
+     * Task exited while other tasks of the shard are running
+     */
+    itti_free (ITTI_MSG_ORIGIN_ID (message), message);
+    return;
+  }
+
+#if ITTI_TRACE
+  itti_trace_task_receive (task_id, message, message_number);
+#endif
+  itti_shard_task_id = task_id;
+  itti_desc.tasks[task_id].handler (message);
+  itti_shard_task_id = TASK_UNKNOWN;
+}
+
+static void                            *
+itti_shard_thread (
+  void *args_p)
+{
+  shard_desc_t                           *shard = (shard_desc_t *) args_p;
+  int                                     event_fd = itti_desc.threads[shard->thread_id].task_event_fd;
+  uint32_t                                nb_tasks_used = 0;
+
+  itti_shard_current = shard;
+  OAILOG_START_USE ();
+  MSC_START_USE ();
+#if ENABLE_ITTI_ANALYZER
+  itti_dump_thread_use_ring_buffer ();
+#endif
+
+  while (itti_desc.wait_tasks != 0) {
+    usleep (10000);
+  }
+
+  while (1) {
+    struct message_list_s                  *message = NULL;
+    eventfd_t                               sem_counter;
+    ssize_t                                 read_ret;
+    uint32_t                                nb_tasks;
+    uint32_t                                i;
+
+#if ITTI_TRACE
+    itti_trace_task_idle ();
+#endif
+    /*
+     * One message in the queue of one of the tasks for each count of the event fd
+     */
+    do {
+      read_ret = read (event_fd, &sem_counter, sizeof (sem_counter));
+    } while (read_ret < 0 && errno == EINTR);
+    AssertFatal (read_ret == sizeof (sem_counter), "Read from shard message FD (%d) failed (%d/%d)!\n", shard->thread_id, (int)read_ret, (int)sizeof (sem_counter));
+
+    nb_tasks = __atomic_load_n (&shard->nb_tasks, __ATOMIC_ACQUIRE);
+    /*
+     * Mark the thread as using the LFDS queues of the tasks added since the last message
+     */
+    for (; nb_tasks_used < nb_tasks; nb_tasks_used++) {
+      lfds611_queue_use (itti_desc.tasks[shard->task_ids[nb_tasks_used]].message_queue);
+    }
+
+    for (i = 0; i < nb_tasks; i++) {
+      task_id_t                               task_id = shard->task_ids[(shard->next_task + i) % nb_tasks];
+
+      if (lfds611_queue_dequeue (itti_desc.tasks[task_id].message_queue, (void **)&message) == 1) {
+        MessageDef                             *received_msg = message->msg;
+        message_number_t                        message_number = message->message_number;
+
+        shard->next_task = (shard->next_task + i + 1) % nb_tasks;
+        __atomic_sub_fetch (&itti_desc.tasks[task_id].queue_depth, 1, __ATOMIC_RELAXED);
+        itti_free (ITTI_MSG_ORIGIN_ID (received_msg), message);
+        itti_shard_handle_message (task_id, received_msg, message_number);
+        break;
+      }
+    }
+
+    AssertFatal (i < nb_tasks, "No message in the queues of the %u tasks of the shard of thread %d!\n", nb_tasks, shard->thread_id);
+
+    /*
+     * Run to completion the messages sent between the tasks of the shard
+     */
+    while (shard->run_queue_head < shard->run_queue_tail) {
+      message_list_t                          local = shard->run_queue[shard->run_queue_head++];
+      task_id_t                               task_id = ITTI_MSG_DESTINATION_ID (local.msg);
+
+      __atomic_sub_fetch (&itti_desc.tasks[task_id].queue_depth, 1, __ATOMIC_RELAXED);
+      itti_shard_handle_message (task_id, local.msg, local.message_number);
+    }
+
+    shard->run_queue_head = 0;
+    shard->run_queue_tail = 0;
+  }
+
+  return NULL;
+}
+
+int
+itti_create_task_handler (
+  task_id_t task_id,
+  void *                                  (*start_routine) (void *),
+  itti_task_handler_t handler,
+  void *args_p)
+{
+  thread_id_t                             thread_id = TASK_GET_THREAD_ID (task_id);
+  shard_desc_t                           *shard = NULL;
+  int                                     result = 0;
+
+  AssertFatal (handler != NULL, "Handler is NULL!\n");
+  if (itti_desc.tasks[task_id].shard == 0) {
+    return itti_create_task (task_id, start_routine, args_p);
+  }
+
+  AssertFatal (thread_id < itti_desc.thread_max, "Thread id (%d) is out of range (%d)!\n", thread_id, itti_desc.thread_max);
+  AssertFatal (itti_desc.threads[thread_id].task_state == TASK_STATE_NOT_CONFIGURED, "Task %d, thread %d state is not correct (%d)!\n", task_id, thread_id, itti_desc.threads[thread_id].task_state);
+  shard = &itti_desc.shards[itti_desc.tasks[task_id].shard];
+  itti_desc.tasks[task_id].handler = handler;
+  ITTI_DEBUG (ITTI_DEBUG_INIT, " Adding task %s to shard %u ...\n", itti_get_task_name (task_id), itti_desc.tasks[task_id].shard);
+
+  if (shard->nb_tasks == 0) {
+    shard->thread_id = thread_id;
+    shard->task_ids = calloc (itti_desc.task_max, sizeof (task_id_t));
+    shard->run_queue_size = ITTI_SHARD_RUN_QUEUE_SIZE;
+    shard->run_queue = calloc (shard->run_queue_size, sizeof (message_list_t));
+    AssertFatal ((shard->task_ids != NULL) && (shard->run_queue != NULL), "Shard %u allocation failed!\n", itti_desc.tasks[task_id].shard);
+  } else {
+    /*
+     * Senders to the task wake up the shard thread
+     */
+    close (itti_desc.threads[thread_id].task_event_fd);
+    itti_desc.threads[thread_id].task_event_fd = itti_desc.threads[shard->thread_id].task_event_fd;
+  }
+
+  shard->task_ids[shard->nb_tasks] = task_id;
+  __atomic_store_n (&shard->nb_tasks, shard->nb_tasks + 1, __ATOMIC_RELEASE);
+
+  if (shard->state == TASK_STATE_NOT_CONFIGURED) {
+    char                                    name[16];
+
+    shard->state = TASK_STATE_READY;
+    result = pthread_create (&shard->thread, NULL, itti_shard_thread, shard);
+    AssertFatal (result == 0, "Thread creation for shard %u failed (%d)!\n", itti_desc.tasks[task_id].shard, result);
+    snprintf (name, sizeof (name), "ITTI shard %u", itti_desc.tasks[task_id].shard);
+    pthread_setname_np (shard->thread, name);
+  }
+
+  itti_desc.threads[thread_id].task_thread = shard->thread;
+  itti_desc.threads[thread_id].task_state = TASK_STATE_READY;
+  itti_desc.created_tasks++;
+  itti_desc.ready_tasks++;
+  ITTI_DEBUG (ITTI_DEBUG_INIT, " task %s started in shard %u\n", itti_get_task_name (task_id), itti_desc.tasks[task_id].shard);
+  return 0;
+}
+
 void
 itti_set_task_real_time (
   task_id_t task_id)
@@ -754,6 +1109,16 @@ itti_exit_task (
   if (task_id > TASK_UNKNOWN) {
     VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_ITTI_RECV_MSG, __sync_and_and_fetch (&itti_desc.vcd_receive_msg, ~(1L << task_id)));
   }
+
+  if (itti_shard_current != NULL) {
+    /*
+     * The shard thread keeps running the other tasks of the shard, it is joined by itti_wait_tasks_end
+     */
+    itti_desc.tasks[task_id].shard_task_ended = 1;
+    if (++itti_shard_current->nb_tasks_ended < itti_shard_current->nb_tasks) {
+      return;
+    }
+  }
   pthread_exit (NULL);
 }
 
@@ -796,6 +1161,7 @@ itti_init (
   itti_desc.thread_max = thread_max;
   itti_desc.messages_id_max = messages_id_max;
   itti_desc.thread_handling_signals = false;
+  itti_desc.statistics_task_id = TASK_UNKNOWN;
   itti_desc.tasks_info = tasks_info;
   itti_desc.messages_info = messages_info;
   /*
@@ -806,6 +1172,10 @@ itti_init (
    * Allocates memory for threads info
    */
   itti_desc.threads = calloc (itti_desc.thread_max, sizeof (thread_desc_t));
+  /*
+   * Allocates memory for shards info, at most one shard per task
+   */
+  itti_desc.shards = calloc (itti_desc.task_max, sizeof (shard_desc_t));
 
   /*
    * Initializing each queue and related stuff
@@ -869,12 +1239,13 @@ itti_init (
   itti_desc.created_tasks = 0;
   itti_desc.ready_tasks = 0;
 
-  itti_desc.memory_pools_handle = memory_pools_create (5);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 1000 + ITTI_QUEUE_MAX_ELEMENTS, 50);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 1000 + (2 * ITTI_QUEUE_MAX_ELEMENTS), 100);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 10000, 1000);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 400, 20050);
-  memory_pools_add_pool (itti_desc.memory_pools_handle, 100, 30050);
+#define ITTI_MEMORY_POOL_COUNT(iTEMsIZE, iNITIALiTEMS, mAXiTEMS) + 1
+#define ITTI_MEMORY_POOL_ADD(iTEMsIZE, iNITIALiTEMS, mAXiTEMS) \
+  memory_pools_add_elastic_pool (itti_desc.memory_pools_handle, iNITIALiTEMS, mAXiTEMS, iTEMsIZE, ITTI_MEMORY_POOLS_RELEASE_IDLE);
+  itti_desc.memory_pools_handle = memory_pools_create (0 ITTI_MEMORY_POOLS (ITTI_MEMORY_POOL_COUNT));
+  ITTI_MEMORY_POOLS (ITTI_MEMORY_POOL_ADD)
+#undef ITTI_MEMORY_POOL_ADD
+#undef ITTI_MEMORY_POOL_COUNT
   {
     char                                   *statistics = memory_pools_statistics (itti_desc.memory_pools_handle);
 
@@ -931,6 +1302,24 @@ itti_wait_tasks_end (
           task_id++;
         }
 
+        if (itti_desc.tasks[task_id].shard != 0) {
+          shard_desc_t                           *shard = &itti_desc.shards[itti_desc.tasks[task_id].shard];
+
+          /*
+           * Tasks of a shard end with the shard thread, joined once
+           */
+          if ((shard->state == TASK_STATE_READY) && (pthread_tryjoin_np (shard->thread, NULL) == 0)) {
+            shard->state = TASK_STATE_ENDED;
+          }
+
+          if (shard->state == TASK_STATE_ENDED) {
+            itti_desc.threads[thread_id].task_state = TASK_STATE_ENDED;
+          } else {
+            ready_tasks++;
+          }
+          continue;
+        }
+
         result = pthread_tryjoin_np (itti_desc.threads[thread_id].task_thread, NULL);
         ITTI_DEBUG (ITTI_DEBUG_EXIT, " Thread %s join status %d\n", itti_get_task_name (task_id), result);
 
@@ -962,6 +1351,12 @@ itti_wait_tasks_end (
     free_wrapper ((void**) &statistics);
   }
 
+#if ITTI_TRACE
+  if (ready_tasks == 0) {
+    itti_trace_exit ();
+  }
+#endif
+
   if (ready_tasks > 0) {
     ITTI_DEBUG (ITTI_DEBUG_ISSUES, " Some threads are still running, force exit\n");
     exit (0);
@@ -981,3 +1376,25 @@ itti_send_terminate_message (
   terminate_message_p = itti_alloc_new_message (task_id, TERMINATE_MESSAGE);
   itti_send_broadcast_message (terminate_message_p);
 }
+
+void
+itti_set_statistics_task (
+  task_id_t task_id)
+{
+  AssertFatal (task_id < itti_desc.task_max, "Task index is invalid (%d/%d)!\n", task_id, itti_desc.task_max);
+  itti_desc.statistics_task_id = task_id;
+}
+
+void
+itti_send_statistics_message (
+  task_id_t task_id)
+{
+  MessageDef                             *statistics_message_p;
+
+  if (TASK_UNKNOWN == itti_desc.statistics_task_id) {
+    ITTI_DEBUG (ITTI_DEBUG_ISSUES, " No task displays the statistics\n");
+    return;
+  }
+  statistics_message_p = itti_alloc_new_message (task_id, STATISTICS_MESSAGE);
+  itti_send_msg_to_task (itti_desc.statistics_task_id, INSTANCE_DEFAULT, statistics_message_p);
+}
@@ -48,6 +48,7 @@
 
 #include "intertask_interface_conf.h"
 #include "intertask_interface_types.h"
+#include "memory_pools.h"
 
 #define ITTI_MSG_ID(mSGpTR)                 ((mSGpTR)->ittiMsgHeader.messageId)
 #define ITTI_MSG_ORIGIN_ID(mSGpTR)          ((mSGpTR)->ittiMsgHeader.originTaskId)
@@ -163,6 +164,38 @@ int itti_create_task(task_id_t task_id,
                      void *(*start_routine) (void *),
                      void *args_p);
 
+/** \brief Handler of the messages of a task, it releases the message
+ * \param received_message_p Message received by the task
+ **/
+typedef void (*itti_task_handler_t)(MessageDef *received_message_p);
+
+/** \brief Run the task in a shard, a thread shared with the other tasks of the shard.
+ * The tasks of a shard run to completion: a message sent to a task of the same shard is
+ * handled by the shard thread right after the current message, without the task queue nor
+ * the event fd. Must be called before the task is created.
+ * \param task_id task to run in the shard
+ * \param shard shard of the task, 0 for a thread per task
+ **/
+void itti_set_task_shard(task_id_t task_id, uint32_t shard);
+
+/** \brief Return the shard of a task
+ * \param task_id Id of the task
+ * @returns the shard set by itti_set_task_shard, 0 if the task has its own thread
+ **/
+uint32_t itti_get_task_shard(task_id_t task_id);
+
+/** \brief Start the task, in its shard if one is set else in its own thread
+ * \param task_id task to start
+ * \param start_routine entry point of the thread of the task, calling handler for each message
+ * \param handler handler of the messages of the task when it runs in a shard
+ * \param args_p Optional argument to pass to the start routine
+ * @returns -1 on failure, 0 otherwise
+ **/
+int itti_create_task_handler(task_id_t task_id,
+                             void *(*start_routine) (void *),
+                             itti_task_handler_t handler,
+                             void *args_p);
+
 //#ifdef RTAI
 /** \brief Mark the task as a real time task
  * \param task_id task to mark as real time
@@ -181,6 +214,7 @@ void itti_wait_ready(int wait_tasks);
 void itti_mark_task_ready(task_id_t task_id);
 
 /** \brief Exit the current task.
+ * In a shard, returns while other tasks of the shard are running.
  **/
 void itti_exit_task(void);
 
@@ -199,6 +233,35 @@ const char *itti_get_message_name(MessagesIds message_id);
  **/
 const char *itti_get_task_name(task_id_t task_id);
 
+/** \brief Return the CPU time consumed so far by the thread of a task
+ * \param task_id Id of the task
+ * @returns CPU time in nanoseconds, 0 if the task is not running.
+ * The tasks of a shard return the CPU time of the shard thread.
+ **/
+uint64_t itti_get_task_cpu_time_ns(task_id_t task_id);
+
+/** \brief Return the number of messages waiting in the queue of a task
+ * \param task_id Id of the task
+ **/
+uint32_t itti_get_task_queue_depth(task_id_t task_id);
+
+/** \brief Return the configured capacity of the queue of a task
+ * \param task_id Id of the task
+ **/
+uint32_t itti_get_task_queue_size(task_id_t task_id);
+
+/** \brief Return the usage and the high water marks of a memory pool of the messages
+ * \param pool Index of the pool in ITTI_MEMORY_POOLS
+ * \param stats Filled with the usage of the pool
+ * @returns 0 if the pool exists
+ **/
+int itti_get_memory_pool_stats(uint32_t pool, memory_pool_stats_t *stats);
+
+/** \brief Give back to the system the chunks of the memory pools that stayed idle since the previous call
+ * @returns the number of chunks given back
+ **/
+uint32_t itti_release_idle_memory(void);
+
 /** \brief Alloc and memset(0) a new itti message.
  * \param origin_task_id Task ID of the sending task
  * \param message_id Message ID
@@ -229,6 +292,16 @@ void itti_wait_tasks_end(void);
  **/
 void itti_send_terminate_message(task_id_t task_id);
 
+/** \brief Select the task that displays the statistics of the process on demand (SIGUSR2).
+ * \param task_id task that receives STATISTICS_MESSAGE.
+ **/
+void itti_set_statistics_task(task_id_t task_id);
+
+/** \brief Send a statistics message to the task selected by itti_set_statistics_task(), if any.
+ * \param task_id task that is sending the message.
+ **/
+void itti_send_statistics_message(task_id_t task_id);
+
 void *itti_malloc(task_id_t origin_task_id, task_id_t destination_task_id, ssize_t size);
 
 int itti_free(task_id_t task_id, void *ptr);
@@ -44,22 +44,29 @@
 #include <errno.h>
 #include <error.h>
 #include <sched.h>
+#include <stddef.h>
 
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/select.h>
 #include <sys/types.h>
+#include <sys/time.h>
 #include <arpa/inet.h>
 
 #include <sys/eventfd.h>
 
 #include "assertions.h"
 #include "liblfds611.h"
+#include "bstrlib.h"
 
 #include "itti_types.h"
 #include "intertask_interface.h"
 #include "intertask_interface_dump.h"
+#if ITTI_DUMP_RING
+#include "intertask_interface_dump_ring.h"
+#endif
 #include "dynamic_memory_check.h"
+#include "oai_clock.h"
 
 #if OAI_EMU
 #  include "vcd_signal_dumper.h"
@@ -128,12 +135,26 @@ typedef struct {
   itti_socket_header_t                    socket_header;
 } itti_statistic_message_t;
 
+typedef struct {
+  MessagesIds                             message_id;
+  size_t                                  offset;
+} itti_dump_bstring_field_t;
+
+static const itti_dump_bstring_field_t  itti_dump_bstring_fields[] = {
+#define MESSAGE_BSTRING_DEF(iD, fIELD) {iD, offsetof (MessageDef, ittiMsg.fIELD)},
+#include <messages_bstring_def.h>
+#undef MESSAGE_BSTRING_DEF
+};
+
 static const itti_message_types_t       itti_dump_xml_definition_end = ITTI_DUMP_XML_DEFINITION_END;
 static const itti_message_types_t       itti_dump_message_type_end = ITTI_DUMP_MESSAGE_TYPE_END;
 
 static itti_desc_t                      itti_dump_queue;
 static FILE                            *dump_file = NULL;
 static int                              itti_dump_running = 1;
+#if ITTI_DUMP_RING
+static int                              itti_dump_ring_mode = 0;
+#endif
 
 static volatile uint32_t                pending_messages = 0;
 
@@ -190,6 +211,75 @@ itti_dump_send_message (
   return total_sent;
 }
 
+/*------------------------------------------------------------------------------*/
+/* Size of the content of the bstring fields of a message, as appended to the dumped message */
+static uint32_t
+itti_dump_bstrings_size (
+  const MessageDef * const message_p)
+{
+  const_bstring                           b = NULL;
+  uint32_t                                size = 0;
+  int                                     i;
+
+  for (i = 0; i < sizeof (itti_dump_bstring_fields) / sizeof (itti_dump_bstring_fields[0]); i++) {
+    if (itti_dump_bstring_fields[i].message_id == ITTI_MSG_ID (message_p)) {
+      memcpy (&b, (const uint8_t *)message_p + itti_dump_bstring_fields[i].offset, sizeof (b));
+      size += sizeof (uint32_t) + ((b != NULL) ? ((blength (b) + 3) & ~3) : 0);
+    }
+  }
+
+  return size;
+}
+
+static void
+itti_dump_copy_bstrings (
+  const MessageDef * const message_p,
+  uint8_t *data)
+{
+  const_bstring                           b = NULL;
+  uint32_t                                length;
+  int                                     i;
+
+  for (i = 0; i < sizeof (itti_dump_bstring_fields) / sizeof (itti_dump_bstring_fields[0]); i++) {
+    if (itti_dump_bstring_fields[i].message_id == ITTI_MSG_ID (message_p)) {
+      memcpy (&b, (const uint8_t *)message_p + itti_dump_bstring_fields[i].offset, sizeof (b));
+      length = (b != NULL) ? blength (b) : ITTI_DUMP_BSTRING_NULL;
+      memcpy (data, &length, sizeof (length));
+      data += sizeof (length);
+
+      if (b != NULL) {
+        memcpy (data, b->data, length);
+        memset (data + length, 0, ((length + 3) & ~3) - length);
+        data += (length + 3) & ~3;
+      }
+    }
+  }
+}
+
+/* Dumped message: the message, then the content of its bstring fields */
+static void
+itti_dump_copy_message (
+  const MessageDef * const message_p,
+  const uint32_t message_size,
+  uint8_t *data)
+{
+  MessageDef                             *dumped_message_p = (MessageDef *) data;
+
+  memcpy (data, message_p, message_size);
+
+  /*
+   * The MME does not maintain the LTE time, dumped messages are stamped with the time they are sent instead
+   */
+  if ((dumped_message_p->ittiMsgHeader.lte_time.time.tv_sec == 0) && (dumped_message_p->ittiMsgHeader.lte_time.time.tv_usec == 0)) {
+    struct timeval                          now;
+
+    oai_clock_coarse_realtime (&now);
+    dumped_message_p->ittiMsgHeader.lte_time.time = now;
+  }
+
+  itti_dump_copy_bstrings (message_p, data + message_size);
+}
+
 static int
 itti_dump_fwrite_message (
   itti_dump_queue_item_t * message)
@@ -729,8 +819,23 @@ itti_dump_queue_message (
   const char *message_name,
   const uint32_t message_size)
 {
+#if ITTI_DUMP_RING
+  if (itti_dump_ring_mode) {
+    uint32_t                                bstrings_size = itti_dump_bstrings_size (message_p);
+    itti_dump_ring_record_hdr_t            *record_p = itti_dump_ring_reserve (message_size + bstrings_size);
+
+    if (record_p != NULL) {
+      itti_dump_copy_message (message_p, message_size, (uint8_t *) &record_p[1]);
+      itti_dump_ring_commit (record_p, message_number);
+    }
+
+    return 0;
+  }
+#endif
+
   if (itti_dump_running) {
     itti_dump_queue_item_t                 *new;
+    uint32_t                                bstrings_size = itti_dump_bstrings_size (message_p);
 
     AssertFatal (message_name != NULL, "Message name is NULL!\n");
     AssertFatal (message_p != NULL, "Message is NULL!\n");
@@ -744,14 +849,14 @@ itti_dump_queue_message (
 #if OAI_EMU
     VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_DUMP_ENQUEUE_MESSAGE_malloc, VCD_FUNCTION_IN);
 #endif
-    new->data = itti_malloc (sender_task, TASK_MAX, message_size);
+    new->data = itti_malloc (sender_task, TASK_MAX, message_size + bstrings_size);
 #if OAI_EMU
     VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME (VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_DUMP_ENQUEUE_MESSAGE_malloc, VCD_FUNCTION_OUT);
 #endif
-    memcpy (new->data, message_p, message_size);
-    new->data_size = message_size;
+    itti_dump_copy_message (message_p, message_size, (uint8_t *) new->data);
+    new->data_size = message_size + bstrings_size;
     new->message_number = message_number;
-    itti_dump_enqueue_message (new, message_size, ITTI_DUMP_MESSAGE_TYPE);
+    itti_dump_enqueue_message (new, message_size + bstrings_size, ITTI_DUMP_MESSAGE_TYPE);
   }
 
   return 0;
@@ -762,6 +867,11 @@ void
 itti_dump_thread_use_ring_buffer (
   void)
 {
+#if ITTI_DUMP_RING
+  if (itti_dump_ring_mode) {
+    return;
+  }
+#endif
   lfds611_ringbuffer_use (itti_dump_queue.itti_message_queue);
 }
 
@@ -776,6 +886,20 @@ itti_dump_init (
 
   scheduler_param.sched_priority = sched_get_priority_min (SCHED_FIFO) + 1;
 
+#if ITTI_DUMP_RING
+  /*
+   * Messages are written by the sending thread in the mapped file, no queue, no thread, no remote analyzer
+   */
+  if (dump_file_name != NULL) {
+    if (itti_dump_ring_open (dump_file_name, messages_definition_xml) == 0) {
+      itti_dump_ring_mode = 1;
+      return 0;
+    }
+
+    ITTI_DUMP_ERROR (" can not open dump ring file \"%s\", dumping through the queue\n", dump_file_name);
+  }
+#endif
+
   if (dump_file_name != NULL) {
     dump_file = fopen (dump_file_name, "wb");
 
@@ -860,6 +984,13 @@ itti_dump_exit (
   void                                   *arg;
   itti_dump_queue_item_t                 *new;
 
+#if ITTI_DUMP_RING
+  if (itti_dump_ring_mode) {
+    itti_dump_running = 0;
+    itti_dump_ring_close ();
+    return;
+  }
+#endif
   new = itti_malloc (TASK_UNKNOWN, TASK_UNKNOWN, sizeof (itti_dump_queue_item_t));
   memset (new, 0, sizeof (itti_dump_queue_item_t));
   /*
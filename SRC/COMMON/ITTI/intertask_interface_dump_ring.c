@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file intertask_interface_dump_ring.c
+   \brief ITTI dump in a memory mapped ring file. The sending thread copies the message in the chunk of the ring it reserved, there is no
+   queue, no allocation and no flush thread. The file survives a crash of the process.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "intertask_interface_conf.h"
+#include "intertask_interface_dump_ring.h"
+
+#ifndef ITTI_DUMP_RING_MAX_FILES
+#  define ITTI_DUMP_RING_MAX_FILES      0
+#endif
+#define ITTI_DUMP_RING_MAX_FILENAME_LENGTH     256
+
+typedef struct itti_dump_ring_file_s {
+  uint8_t                   *map;
+  size_t                     map_size;
+  itti_dump_ring_file_hdr_t *hdr;
+  uint8_t                   *ring;
+  uint32_t                   file_number;
+} itti_dump_ring_file_t;
+
+typedef struct itti_dump_ring_s {
+  bool                       is_open;
+  uint32_t                   generation;       /*!< \brief Incremented at each open, invalidates the chunks of the threads */
+  char                       filename[ITTI_DUMP_RING_MAX_FILENAME_LENGTH];
+  const char                *messages_definition_xml;
+  uint64_t                   head;             /*!< \brief Absolute position of the next chunk, position 0 is never used */
+  uint64_t                   dropped;
+  pthread_mutex_t            rotation_mutex;
+  itti_dump_ring_file_t      files[2];         /*!< \brief File n in files[n & 1], with rotation, files[0] without */
+} itti_dump_ring_t;
+
+static itti_dump_ring_t g_itti_dump_ring = {.is_open = false, .rotation_mutex = PTHREAD_MUTEX_INITIALIZER};
+
+// chunk of the calling thread
+static __thread uint32_t    itti_dump_ring_chunk_generation = 0;
+static __thread uint64_t    itti_dump_ring_chunk_position = 0;
+static __thread uint8_t    *itti_dump_ring_chunk_p = NULL;
+static __thread uint32_t    itti_dump_ring_chunk_used = 0;
+static __thread uint64_t    itti_dump_ring_record_position = 0;
+
+/*------------------------------------------------------------------------------*/
+static void itti_dump_ring_filename(const uint32_t file_numberP, char * const filenameP)
+{
+  if (0 == file_numberP) {
+    snprintf(filenameP, ITTI_DUMP_RING_MAX_FILENAME_LENGTH, "%s", g_itti_dump_ring.filename);
+  } else {
+    snprintf(filenameP, ITTI_DUMP_RING_MAX_FILENAME_LENGTH, "%s.%u", g_itti_dump_ring.filename, file_numberP);
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+static void itti_dump_ring_unmap_file(itti_dump_ring_file_t * const fileP)
+{
+  if (NULL != fileP->map) {
+    if (msync(fileP->map, fileP->map_size, MS_ASYNC)) {
+      fprintf (stderr, "Error while syncing ITTI dump file %u: %s\n", fileP->file_number, strerror (errno));
+    }
+    munmap(fileP->map, fileP->map_size);
+    fileP->map = NULL;
+    fileP->hdr = NULL;
+    fileP->ring = NULL;
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+static int itti_dump_ring_map_file(itti_dump_ring_file_t * const fileP, const uint32_t file_numberP)
+{
+  char      filename[ITTI_DUMP_RING_MAX_FILENAME_LENGTH];
+  size_t    xml_size = strlen(g_itti_dump_ring.messages_definition_xml) + 1;
+  size_t    xml_offset = (sizeof(itti_dump_ring_file_hdr_t) + 7) & ~(size_t)7;
+  size_t    ring_offset = (xml_offset + xml_size + 4095) & ~(size_t)4095;
+  int       fd = -1;
+
+  itti_dump_ring_filename(file_numberP, filename);
+  fileP->map_size = ring_offset + ITTI_DUMP_RING_SIZE;
+  fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (0 > fd) {
+    fprintf (stderr, "Could not open ITTI dump file %s : %s\n", filename, strerror (errno));
+    return -1;
+  }
+  if (ftruncate(fd, fileP->map_size)) {
+    fprintf (stderr, "Could not size ITTI dump file %s : %s\n", filename, strerror (errno));
+    close(fd);
+    return -1;
+  }
+  fileP->map = mmap(NULL, fileP->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (MAP_FAILED == fileP->map) {
+    fprintf (stderr, "Could not map ITTI dump file %s : %s\n", filename, strerror (errno));
+    fileP->map = NULL;
+    return -1;
+  }
+  fileP->hdr         = (itti_dump_ring_file_hdr_t *)fileP->map;
+  fileP->ring        = fileP->map + ring_offset;
+  fileP->file_number = file_numberP;
+
+  // file is zero filled by ftruncate, the magic is written last
+  memcpy(fileP->map + xml_offset, g_itti_dump_ring.messages_definition_xml, xml_size);
+  fileP->hdr->version     = ITTI_DUMP_RING_VERSION;
+  fileP->hdr->xml_offset  = xml_offset;
+  fileP->hdr->xml_size    = xml_size;
+  fileP->hdr->ring_offset = ring_offset;
+  fileP->hdr->ring_size   = ITTI_DUMP_RING_SIZE;
+  fileP->hdr->chunk_size  = ITTI_DUMP_RING_CHUNK_SIZE;
+  fileP->hdr->file_number = file_numberP;
+  fileP->hdr->base        = (ITTI_DUMP_RING_MAX_FILES) ? (uint64_t)file_numberP * ITTI_DUMP_RING_SIZE : 0;
+  fileP->hdr->head        = 0;
+  __atomic_store_n (&fileP->hdr->magic, ITTI_DUMP_RING_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+/*------------------------------------------------------------------------------*/
+// Rotation: the file of a chunk, created when its first chunk is reserved, the file older than the previous one is unmapped
+static itti_dump_ring_file_t * itti_dump_ring_get_file(const uint32_t file_numberP)
+{
+  itti_dump_ring_file_t   *file_p = &g_itti_dump_ring.files[file_numberP & 1];
+  char                     filename[ITTI_DUMP_RING_MAX_FILENAME_LENGTH];
+
+  pthread_mutex_lock (&g_itti_dump_ring.rotation_mutex);
+  if ((NULL == file_p->map) || (file_p->file_number != file_numberP)) {
+    itti_dump_ring_unmap_file(file_p);
+    if (file_numberP >= ITTI_DUMP_RING_MAX_FILES) {
+      itti_dump_ring_filename(file_numberP - ITTI_DUMP_RING_MAX_FILES, filename);
+      unlink(filename);
+    }
+    if (itti_dump_ring_map_file(file_p, file_numberP)) {
+      file_p = NULL;
+    }
+  }
+  pthread_mutex_unlock (&g_itti_dump_ring.rotation_mutex);
+  return file_p;
+}
+
+/*------------------------------------------------------------------------------*/
+static bool itti_dump_ring_new_chunk(void)
+{
+  itti_dump_ring_file_t   *file_p = &g_itti_dump_ring.files[0];
+  uint64_t                 position = __atomic_fetch_add (&g_itti_dump_ring.head, ITTI_DUMP_RING_CHUNK_SIZE, __ATOMIC_ACQ_REL);
+  uint64_t                 head = 0;
+
+  if (ITTI_DUMP_RING_MAX_FILES) {
+    file_p = itti_dump_ring_get_file(position / ITTI_DUMP_RING_SIZE);
+    if (NULL == file_p) {
+      // no more room on the disk, stop recording
+      g_itti_dump_ring.is_open = false;
+      return false;
+    }
+  }
+  itti_dump_ring_chunk_generation = g_itti_dump_ring.generation;
+  itti_dump_ring_chunk_position   = position;
+  itti_dump_ring_chunk_p          = &file_p->ring[position & (ITTI_DUMP_RING_SIZE - 1)];
+  itti_dump_ring_chunk_used       = 0;
+  // the reader takes the records of the last ring size before the head
+  head = __atomic_load_n (&file_p->hdr->head, __ATOMIC_ACQUIRE);
+  while ((head < position + ITTI_DUMP_RING_CHUNK_SIZE) &&
+         (!__atomic_compare_exchange_n (&file_p->hdr->head, &head, position + ITTI_DUMP_RING_CHUNK_SIZE, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)));
+  return true;
+}
+
+/*------------------------------------------------------------------------------*/
+int itti_dump_ring_open(const char * const filenameP, const char * const messages_definition_xmlP)
+{
+  snprintf(g_itti_dump_ring.filename, ITTI_DUMP_RING_MAX_FILENAME_LENGTH, "%s", filenameP);
+  g_itti_dump_ring.messages_definition_xml = messages_definition_xmlP;
+  g_itti_dump_ring.head    = ITTI_DUMP_RING_CHUNK_SIZE;
+  g_itti_dump_ring.dropped = 0;
+  if (itti_dump_ring_map_file(&g_itti_dump_ring.files[0], 0)) {
+    return -1;
+  }
+  g_itti_dump_ring.generation++;
+  g_itti_dump_ring.is_open = true;
+  return 0;
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_dump_ring_close(void)
+{
+  int i = 0;
+
+  g_itti_dump_ring.is_open = false;
+  for (i = 0; i < 2; i++) {
+    if (NULL != g_itti_dump_ring.files[i].map) {
+      g_itti_dump_ring.files[i].hdr->dropped = g_itti_dump_ring.dropped;
+    }
+    itti_dump_ring_unmap_file(&g_itti_dump_ring.files[i]);
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+itti_dump_ring_record_hdr_t *itti_dump_ring_reserve(const uint32_t data_sizeP)
+{
+  itti_dump_ring_record_hdr_t *record_p = NULL;
+  uint32_t                     size = (sizeof(itti_dump_ring_record_hdr_t) + data_sizeP + 7) & ~7;
+
+  if (!g_itti_dump_ring.is_open) {
+    return NULL;
+  }
+  if (size > ITTI_DUMP_RING_CHUNK_SIZE) {
+    __atomic_add_fetch (&g_itti_dump_ring.dropped, 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+  // a chunk older than half the ring is left, it must not be overwritten by other threads while this one writes in it
+  if ((itti_dump_ring_chunk_generation != g_itti_dump_ring.generation) ||
+      (itti_dump_ring_chunk_used + size > ITTI_DUMP_RING_CHUNK_SIZE) ||
+      (__atomic_load_n (&g_itti_dump_ring.head, __ATOMIC_RELAXED) - itti_dump_ring_chunk_position > ITTI_DUMP_RING_SIZE / 2)) {
+    if (!itti_dump_ring_new_chunk()) {
+      return NULL;
+    }
+  }
+  record_p = (itti_dump_ring_record_hdr_t *)&itti_dump_ring_chunk_p[itti_dump_ring_chunk_used];
+  itti_dump_ring_record_position = itti_dump_ring_chunk_position + itti_dump_ring_chunk_used;
+  itti_dump_ring_chunk_used += size;
+  record_p->size      = size;
+  record_p->data_size = data_sizeP;
+  return record_p;
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_dump_ring_commit(itti_dump_ring_record_hdr_t * const recordP, const uint64_t message_numberP)
+{
+  recordP->message_number = message_numberP;
+  // the position validates the record, the previous one at this place has a position older by a multiple of the ring size
+  __atomic_store_n (&recordP->position, itti_dump_ring_record_position, __ATOMIC_RELEASE);
+}
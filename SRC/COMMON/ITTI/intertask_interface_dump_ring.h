@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file intertask_interface_dump_ring.h
+   \brief ITTI dump written by the sending thread in a memory mapped ring file (ITTI_DUMP_RING), converted offline to the itti_analyzer
+   format by itti_ring2dump.
+   Each thread reserves a chunk of the ring at once, then writes its messages in it without synchronization. When the ring is full, the
+   oldest chunks are overwritten, or with ITTI_DUMP_RING_MAX_FILES the file is left as is and the next one, <file>.<n>, is started.
+   A thread leaves its chunk when it is older than half the ring, a thread preempted while the whole ring is written may still corrupt one
+   record.
+*/
+#ifndef FILE_INTERTASK_INTERFACE_DUMP_RING_SEEN
+#define FILE_INTERTASK_INTERFACE_DUMP_RING_SEEN
+#include <stdint.h>
+
+#define ITTI_DUMP_RING_MAGIC            0x52495449  /* "ITIR" */
+#define ITTI_DUMP_RING_VERSION                   1
+
+/*! \struct  itti_dump_ring_file_hdr_t
+* \brief Header of a ring file, followed by the XML definition of the messages then by the ring of chunks.
+*/
+typedef struct itti_dump_ring_file_hdr_s {
+  uint32_t        magic;                 /*!< \brief Written last */
+  uint16_t        version;
+  uint16_t        reserved;
+  uint32_t        xml_offset;            /*!< \brief From the beginning of the file */
+  uint32_t        xml_size;              /*!< \brief NUL included */
+  uint64_t        ring_offset;           /*!< \brief From the beginning of the file */
+  uint64_t        ring_size;
+  uint32_t        chunk_size;
+  uint32_t        file_number;           /*!< \brief Rank of the file in the rotation, 0 without rotation */
+  uint64_t        base;                  /*!< \brief Absolute position of the first chunk of the ring of this file */
+  uint64_t        head;                  /*!< \brief Absolute position after the last chunk reserved, at least */
+  uint64_t        dropped;               /*!< \brief Messages larger than a chunk */
+} itti_dump_ring_file_hdr_t;
+
+/*! \struct  itti_dump_ring_record_hdr_t
+* \brief Header of a record in a chunk, followed by the dumped message: MessageDef then the content of its bstrings, 8 bytes aligned.
+* Records of a chunk are contiguous from its beginning.
+*/
+typedef struct itti_dump_ring_record_hdr_s {
+  uint64_t        position;              /*!< \brief Absolute position of the record, stored last, a stale value means no valid record */
+  uint64_t        message_number;
+  uint32_t        size;                  /*!< \brief Whole record size, 8 bytes aligned */
+  uint32_t        data_size;
+} itti_dump_ring_record_hdr_t;
+
+int  itti_dump_ring_open(const char * const filenameP, const char * const messages_definition_xmlP);
+void itti_dump_ring_close(void);
+
+/* Room for a message of data_sizeP bytes in the chunk of the calling thread, NULL if it can not be recorded */
+itti_dump_ring_record_hdr_t *itti_dump_ring_reserve(const uint32_t data_sizeP);
+
+/* The record becomes valid */
+void itti_dump_ring_commit(itti_dump_ring_record_hdr_t * const recordP, const uint64_t message_numberP);
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file intertask_interface_trace.c
+   \brief Cross-task trace of procedures. The context of the message processed by a thread is kept in thread local storage, copied in
+   the header of the messages it allocates; the spans are buffered per thread and appended to the trace file by a single write().
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "intertask_interface.h"
+#include "intertask_interface_trace.h"
+#include "oai_clock.h"
+
+#define ITTI_TRACE_BUFFER_SPANS            256
+#define ITTI_TRACE_BUFFER_MAX_AGE_NS       1000000000ULL  /* spans of a thread written at least every second while it is active */
+#define ITTI_TRACE_SAVED_CONTEXTS          4096           /* power of 2, a context is overwritten by a colliding key */
+
+typedef struct itti_trace_buffer_s {
+  struct itti_trace_buffer_s *next;
+  uint32_t                    count;
+  uint64_t                    first_ns;
+  itti_trace_span_t           spans[ITTI_TRACE_BUFFER_SPANS];
+} itti_trace_buffer_t;
+
+typedef struct itti_trace_saved_context_s {
+  uint64_t                    key;             /*!< \brief 0 if the slot is free */
+  itti_trace_context_t        context;
+} itti_trace_saved_context_t;
+
+typedef struct itti_trace_s {
+  bool                        is_open;
+  int                         fd;
+  uint32_t                    sampling;
+  uint64_t                    last_trace_id;
+  uint64_t                    lost_spans;
+  pthread_mutex_t             mutex;           /*!< \brief Protects the list of buffers and the saved contexts */
+  itti_trace_buffer_t        *buffers;
+  itti_trace_saved_context_t  saved[ITTI_TRACE_SAVED_CONTEXTS];
+} itti_trace_t;
+
+static itti_trace_t g_itti_trace = {.is_open = false, .fd = -1, .mutex = PTHREAD_MUTEX_INITIALIZER};
+
+// state of the calling thread
+static __thread itti_trace_context_t  itti_trace_current = {0};       /* context of the message processed */
+static __thread bool                  itti_trace_in_message = false;  /* an ITTI message is processed */
+static __thread bool                  itti_trace_in_span = false;
+static __thread itti_trace_span_t     itti_trace_span;
+static __thread uint32_t              itti_trace_roots = 0;
+static __thread itti_trace_buffer_t  *itti_trace_buffer = NULL;
+
+/*------------------------------------------------------------------------------*/
+static inline uint64_t itti_trace_now_ns(void)
+{
+  return oai_clock_precise_ns();
+}
+
+/*------------------------------------------------------------------------------*/
+static void itti_trace_write(const void * const dataP, const size_t sizeP)
+{
+  // O_APPEND: a single write() per buffer, threads do not interleave their spans
+  if (write(g_itti_trace.fd, dataP, sizeP) != (ssize_t)sizeP) {
+    __sync_fetch_and_add(&g_itti_trace.lost_spans, sizeP / sizeof(itti_trace_span_t));
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+static void itti_trace_flush_buffer(itti_trace_buffer_t * const bufferP)
+{
+  if (bufferP->count) {
+    itti_trace_write(bufferP->spans, bufferP->count * sizeof(itti_trace_span_t));
+    bufferP->count = 0;
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+static inline uint32_t itti_trace_saved_slot(const uint64_t keyP)
+{
+  return (uint32_t)((keyP * UINT64_C(0x9E3779B97F4A7C15)) >> 40) & (ITTI_TRACE_SAVED_CONTEXTS - 1);
+}
+
+/*------------------------------------------------------------------------------*/
+int itti_trace_init(const char * const filenameP, const uint32_t samplingP)
+{
+  itti_trace_file_hdr_t hdr = {0};
+  char                  name[ITTI_TRACE_NAME_LENGTH];
+  uint32_t              i;
+
+  if ((NULL == filenameP) || (0 == samplingP)) {
+    return 0;
+  }
+  g_itti_trace.fd = open(filenameP, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+  if (0 > g_itti_trace.fd) {
+    fprintf (stderr, "Could not open ITTI trace file %s : %s\n", filenameP, strerror (errno));
+    return -1;
+  }
+  hdr.magic     = ITTI_TRACE_MAGIC;
+  hdr.version   = ITTI_TRACE_VERSION;
+  hdr.span_size = sizeof(itti_trace_span_t);
+  hdr.tasks     = TASK_MAX;
+  hdr.messages  = MESSAGES_ID_MAX;
+  hdr.sampling  = samplingP;
+  itti_trace_write(&hdr, sizeof(hdr));
+  for (i = 0; i < TASK_MAX; i++) {
+    memset(name, 0, sizeof(name));
+    strncpy(name, itti_get_task_name(i), sizeof(name) - 1);
+    itti_trace_write(name, sizeof(name));
+  }
+  for (i = 0; i < MESSAGES_ID_MAX; i++) {
+    memset(name, 0, sizeof(name));
+    strncpy(name, itti_get_message_name(i), sizeof(name) - 1);
+    itti_trace_write(name, sizeof(name));
+  }
+  g_itti_trace.sampling = samplingP;
+  g_itti_trace.is_open  = true;
+  return 0;
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_exit(void)
+{
+  itti_trace_buffer_t *buffer = NULL;
+
+  if (!g_itti_trace.is_open) {
+    return;
+  }
+  g_itti_trace.is_open = false;
+  pthread_mutex_lock(&g_itti_trace.mutex);
+  while (g_itti_trace.buffers) {
+    buffer = g_itti_trace.buffers;
+    g_itti_trace.buffers = buffer->next;
+    itti_trace_flush_buffer(buffer);
+    free(buffer);
+  }
+  pthread_mutex_unlock(&g_itti_trace.mutex);
+  if (g_itti_trace.lost_spans) {
+    fprintf (stderr, "ITTI trace: %lu spans could not be written\n", g_itti_trace.lost_spans);
+  }
+  close(g_itti_trace.fd);
+  g_itti_trace.fd = -1;
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_save(const uint64_t keyP)
+{
+  itti_trace_saved_context_t *saved = NULL;
+
+  if ((!g_itti_trace.is_open) || (0 == itti_trace_current.trace_id) || (0 == keyP)) {
+    return;
+  }
+  saved = &g_itti_trace.saved[itti_trace_saved_slot(keyP)];
+  pthread_mutex_lock(&g_itti_trace.mutex);
+  saved->context = itti_trace_current;
+  __atomic_store_n(&saved->key, keyP, __ATOMIC_RELEASE);
+  pthread_mutex_unlock(&g_itti_trace.mutex);
+}
+
+/*------------------------------------------------------------------------------*/
+bool itti_trace_restore(const uint64_t keyP, MessageDef * const messageP)
+{
+  itti_trace_saved_context_t *saved = NULL;
+  itti_trace_context_t        context = {0};
+  bool                        found = false;
+
+  if ((!g_itti_trace.is_open) || (0 == keyP)) {
+    return false;
+  }
+  saved = &g_itti_trace.saved[itti_trace_saved_slot(keyP)];
+  // most answers belong to procedures which are not traced, no lock for them
+  if (__atomic_load_n(&saved->key, __ATOMIC_ACQUIRE) != keyP) {
+    return false;
+  }
+  pthread_mutex_lock(&g_itti_trace.mutex);
+  if (saved->key == keyP) {
+    context = saved->context;
+    saved->key = 0;
+    found = true;
+  }
+  pthread_mutex_unlock(&g_itti_trace.mutex);
+  if (found) {
+    if (messageP) {
+      messageP->ittiMsgHeader.trace = context;
+    }
+    if (itti_trace_in_message) {
+      itti_trace_current = context;
+    }
+  }
+  return found;
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_message_alloc(MessageDef * const messageP)
+{
+  if (!g_itti_trace.is_open) {
+    messageP->ittiMsgHeader.trace.trace_id = 0;
+  } else if (itti_trace_in_message) {
+    // sent while processing a message, same procedure
+    messageP->ittiMsgHeader.trace = itti_trace_current;
+  } else if (++itti_trace_roots >= g_itti_trace.sampling) {
+    // sent from a socket, a timer or a thread outside ITTI, new procedure
+    itti_trace_roots = 0;
+    messageP->ittiMsgHeader.trace.trace_id = __sync_add_and_fetch(&g_itti_trace.last_trace_id, 1);
+    messageP->ittiMsgHeader.trace.start_ns = itti_trace_now_ns();
+  } else {
+    messageP->ittiMsgHeader.trace.trace_id = 0;
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_message_send(MessageDef * const messageP)
+{
+  if (messageP->ittiMsgHeader.trace.trace_id) {
+    messageP->ittiMsgHeader.trace.sent_ns = itti_trace_now_ns();
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_task_idle(void)
+{
+  itti_trace_buffer_t *buffer = itti_trace_buffer;
+
+  itti_trace_in_message = false;
+  itti_trace_current.trace_id = 0;
+  if (!itti_trace_in_span) {
+    return;
+  }
+  itti_trace_in_span = false;
+  if (!g_itti_trace.is_open) {
+    return;
+  }
+  itti_trace_span.end_ns = itti_trace_now_ns();
+  if (NULL == buffer) {
+    buffer = calloc(1, sizeof(itti_trace_buffer_t));
+    if (NULL == buffer) {
+      __sync_fetch_and_add(&g_itti_trace.lost_spans, 1);
+      return;
+    }
+    pthread_mutex_lock(&g_itti_trace.mutex);
+    buffer->next = g_itti_trace.buffers;
+    g_itti_trace.buffers = buffer;
+    pthread_mutex_unlock(&g_itti_trace.mutex);
+    itti_trace_buffer = buffer;
+  }
+  if (0 == buffer->count) {
+    buffer->first_ns = itti_trace_span.end_ns;
+  }
+  buffer->spans[buffer->count++] = itti_trace_span;
+  if ((ITTI_TRACE_BUFFER_SPANS == buffer->count) || ((itti_trace_span.end_ns - buffer->first_ns) > ITTI_TRACE_BUFFER_MAX_AGE_NS)) {
+    itti_trace_flush_buffer(buffer);
+  }
+}
+
+/*------------------------------------------------------------------------------*/
+void itti_trace_task_receive(const task_id_t task_idP, const MessageDef * const messageP, const uint64_t message_numberP)
+{
+  itti_trace_task_idle();
+  if (NULL == messageP) {
+    return;
+  }
+  itti_trace_in_message = true;
+  if ((!g_itti_trace.is_open) || (0 == messageP->ittiMsgHeader.trace.trace_id)) {
+    return;
+  }
+  itti_trace_current               = messageP->ittiMsgHeader.trace;
+  itti_trace_span.trace_id         = itti_trace_current.trace_id;
+  itti_trace_span.trace_start_ns   = itti_trace_current.start_ns;
+  itti_trace_span.sent_ns          = itti_trace_current.sent_ns;
+  itti_trace_span.start_ns         = itti_trace_now_ns();
+  itti_trace_span.end_ns           = 0;
+  itti_trace_span.message_number   = message_numberP;
+  itti_trace_span.message_id       = messageP->ittiMsgHeader.messageId;
+  itti_trace_span.origin_task_id   = messageP->ittiMsgHeader.originTaskId;
+  itti_trace_span.task_id          = task_idP;
+  itti_trace_span.reserved         = 0;
+  itti_trace_in_span               = true;
+}
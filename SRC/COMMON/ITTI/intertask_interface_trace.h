@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file intertask_interface_trace.h
+   \brief Cross-task trace of procedures (ITTI_TRACE). A sampled message sent while no message is processed starts a trace, its context
+   (trace id, start of the procedure) is carried in the header of the messages sent by the tasks while they process a message of the
+   trace, so that a whole procedure is followed across tasks without changes in the handlers.
+   A procedure that waits for a peer (HSS, SGW, eNB) leaves the tasks, the context is saved under a key before the request is sent and
+   restored when the answer is received, by itti_trace_save() and itti_trace_restore().
+   Each task records a span per traced message it processes (sent, received, processed), buffered per thread and appended to the trace
+   file without lock, analysed offline by itti_trace_report.
+*/
+#ifndef FILE_INTERTASK_INTERFACE_TRACE_SEEN
+#define FILE_INTERTASK_INTERFACE_TRACE_SEEN
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ITTI_TRACE_MAGIC                0x52545449  /* "ITTR" */
+#define ITTI_TRACE_VERSION                       1
+#define ITTI_TRACE_NAME_LENGTH                  64
+
+/* Keys of the contexts saved while a procedure waits for a peer */
+#define ITTI_TRACE_KEY_S1AP_UE(mME_uE_s1AP_iD)  ((UINT64_C(1) << 56) | (uint64_t)(mME_uE_s1AP_iD))
+#define ITTI_TRACE_KEY_S6A_IMSI(iMSI64)         ((UINT64_C(2) << 56) | ((uint64_t)(iMSI64) & UINT64_C(0x00FFFFFFFFFFFFFF)))
+#define ITTI_TRACE_KEY_S11_TEID(tEID)           ((UINT64_C(3) << 56) | (uint64_t)(tEID))
+
+/*! \struct  itti_trace_file_hdr_t
+* \brief Header of a trace file, followed by the names of the tasks then by the names of the messages, ITTI_TRACE_NAME_LENGTH bytes each,
+* then by the spans.
+*/
+typedef struct itti_trace_file_hdr_s {
+  uint32_t        magic;
+  uint16_t        version;
+  uint16_t        span_size;             /*!< \brief sizeof(itti_trace_span_t) */
+  uint32_t        tasks;
+  uint32_t        messages;
+  uint32_t        sampling;              /*!< \brief One procedure out of sampling is traced */
+  uint32_t        reserved;
+} itti_trace_file_hdr_t;
+
+/*! \struct  itti_trace_span_t
+* \brief A traced message processed by a task, times in ns of CLOCK_MONOTONIC.
+*/
+typedef struct itti_trace_span_s {
+  uint64_t        trace_id;
+  uint64_t        trace_start_ns;        /*!< \brief Start of the procedure */
+  uint64_t        sent_ns;               /*!< \brief Message sent by the origin task */
+  uint64_t        start_ns;              /*!< \brief Message received by the task */
+  uint64_t        end_ns;                /*!< \brief Task back to its queue */
+  uint64_t        message_number;
+  uint16_t        message_id;
+  uint8_t         origin_task_id;
+  uint8_t         task_id;
+  uint32_t        reserved;
+} itti_trace_span_t;
+
+/* Offline tools define ITTI_TRACE_FILE_FORMAT_ONLY, they do not depend on the messages of the build */
+#ifndef ITTI_TRACE_FILE_FORMAT_ONLY
+#include "intertask_interface.h"
+
+#if ITTI_TRACE
+/* Opens the trace file, one procedure out of samplingP is traced, tracing is off if 0 or if the file is NULL */
+int  itti_trace_init(const char * const filenameP, const uint32_t samplingP);
+/* Flushes the spans of the threads and closes the trace file, the tasks are ended */
+void itti_trace_exit(void);
+
+/* Saves the context of the message processed by the calling task under keyP, if traced */
+void itti_trace_save(const uint64_t keyP);
+/* Context saved under keyP given to messageP if not NULL, and to the messages sent next by the calling task while it processes the
+   current message. The context is removed, returns true if it was found */
+bool itti_trace_restore(const uint64_t keyP, MessageDef * const messageP);
+
+/* Hooks of intertask_interface.c */
+void itti_trace_message_alloc(MessageDef * const messageP);
+void itti_trace_message_send(MessageDef * const messageP);
+void itti_trace_task_receive(const task_id_t task_idP, const MessageDef * const messageP, const uint64_t message_numberP);
+void itti_trace_task_idle(void);
+#else
+static inline int  itti_trace_init(const char * const filenameP, const uint32_t samplingP) {return 0;}
+static inline void itti_trace_exit(void) {}
+static inline void itti_trace_save(const uint64_t keyP) {}
+static inline bool itti_trace_restore(const uint64_t keyP, MessageDef * const messageP) {return false;}
+#endif
+#endif /* ITTI_TRACE_FILE_FORMAT_ONLY */
+#endif
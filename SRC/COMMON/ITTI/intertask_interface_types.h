@@ -121,6 +121,15 @@ typedef struct itti_lte_time_s {
   struct timeval time;
 } itti_lte_time_t;
 
+#if ITTI_TRACE
+/* Context of the traced procedure a message belongs to, see intertask_interface_trace.h */
+typedef struct itti_trace_context_s {
+  uint64_t trace_id;              /**< 0 if the procedure is not traced */
+  uint64_t start_ns;              /**< Start of the procedure, CLOCK_MONOTONIC */
+  uint64_t sent_ns;               /**< Message sent, CLOCK_MONOTONIC */
+} itti_trace_context_t;
+#endif
+
 /** @struct MessageHeader
  *  @brief Message Header structure for inter-task communication.
  */
@@ -134,6 +143,9 @@ typedef struct MessageHeader_s {
   MessageHeaderSize ittiMsgSize;         /**< Message size (not including header size) */
 
   itti_lte_time_t lte_time;       /**< Reference LTE time */
+#if ITTI_TRACE
+  itti_trace_context_t trace;     /**< Procedure the message belongs to */
+#endif
 } MessageHeader;
 
 /** @struct MessageDef
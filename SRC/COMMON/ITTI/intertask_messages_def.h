@@ -42,6 +42,9 @@ MESSAGE_DEF(TERMINATE_MESSAGE,  MESSAGE_PRIORITY_MAX, IttiMsgEmpty, terminate_me
 /* Test message used for debug */
 MESSAGE_DEF(MESSAGE_TEST,       MESSAGE_PRIORITY_MED, IttiMsgEmpty, message_test)
 
+/* Statistics requested by the operator (SIGUSR2) */
+MESSAGE_DEF(STATISTICS_MESSAGE, MESSAGE_PRIORITY_MED, IttiMsgEmpty, statistics_message)
+
 /* Error message  */
 MESSAGE_DEF(ERROR_LOG,          MESSAGE_PRIORITY_MAX, IttiMsgEmpty, error_log)
 /* Warning message  */
@@ -0,0 +1,1264 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file itti_query.c
+   \brief Command line queries on ITTI dump files (itti_analyzer format), for dumps too large for itti_analyzer.
+   The dump is mapped, a side index (<dump>.idx) is built at the first query and reused while the dump is unchanged. It holds the
+   message id, tasks, instance, number and time of each message, posting lists by message id and by task, and the UE identifiers
+   found in the messages. The fields holding UE identifiers are found by name (-k) in the XML description of the messages that
+   starts the dump, as well as the layout of the message header, so the tool does not depend on the build of the dumping process.
+   Matching messages are counted, printed one per line (-p), or exported in a new dump file that itti_analyzer can open (-x),
+   by several threads (-j).
+   Usage: itti_query -d /tmp/mme.itti [-i index] [-r] [-k ue_id,mme_ue_s1ap_id,...] [-m message[,message]] [-f task[,task]]
+            [-t task[,task]] [-u [key=]value] [-n first:last] [-T from:to] [-p out.txt|-] [-x out.itti] [-j threads]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <libxml/parser.h>
+#include <libxml/tree.h>
+
+#include "itti_types.h"
+
+#define ITTI_QUERY_INDEX_MAGIC          0x58515449  /* "ITQX" */
+#define ITTI_QUERY_INDEX_VERSION                 1
+#define ITTI_QUERY_MAX_KEYS                     16
+#define ITTI_QUERY_MAX_KEY_LENGTH               32
+#define ITTI_QUERY_MAX_KEY_FIELDS               16  /* per message */
+#define ITTI_QUERY_MAX_DEPTH                     6  /* of nested structures searched for keys */
+#define ITTI_QUERY_MAX_THREADS                  64
+#define ITTI_QUERY_DEFAULT_KEYS         "ue_id,mme_ue_s1ap_id,enb_ue_s1ap_id,teid,context_teid,local_teid"
+#define ITTI_QUERY_RECORD_HEADER_SIZE   (sizeof (itti_socket_header_t) + sizeof (itti_signal_header_t))
+
+//==============================================================================
+// Types of the XML description (gccxml)
+//==============================================================================
+
+typedef enum {
+  ITTI_QUERY_TYPE_NONE = 0,
+  ITTI_QUERY_TYPE_FUNDAMENTAL,
+  ITTI_QUERY_TYPE_ENUMERATION,
+  ITTI_QUERY_TYPE_STRUCT,
+  ITTI_QUERY_TYPE_UNION,
+  ITTI_QUERY_TYPE_TYPEDEF,
+  ITTI_QUERY_TYPE_CV_QUALIFIED,
+  ITTI_QUERY_TYPE_ARRAY,
+  ITTI_QUERY_TYPE_POINTER,
+  ITTI_QUERY_TYPE_FIELD,
+} itti_query_type_kind_t;
+
+typedef struct itti_query_type_s {
+  itti_query_type_kind_t     kind;
+  char                      *name;
+  uint32_t                   type;             /* referenced type */
+  uint32_t                   size;             /* bits */
+  uint32_t                   offset;           /* bits, fields */
+  uint32_t                   bits;             /* bit field width */
+  uint32_t                   num_members;      /* fields of structures and unions, values of enumerations */
+  uint32_t                  *members;
+  char                     **value_names;
+  int64_t                   *values;
+} itti_query_type_t;
+
+/* Integer field of a message: offset and size in bytes from the beginning of the message */
+typedef struct itti_query_field_s {
+  uint32_t                   offset;
+  uint32_t                   size;
+  uint16_t                   key;
+} itti_query_field_t;
+
+typedef struct itti_query_description_s {
+  itti_query_type_t         *types;
+  uint32_t                   num_types;
+  // message header, offsets from the beginning of MessageDef
+  itti_query_field_t         message_id;
+  itti_query_field_t         origin;
+  itti_query_field_t         destination;
+  itti_query_field_t         instance;
+  itti_query_field_t         message_size;
+  itti_query_field_t         tv_sec;
+  itti_query_field_t         tv_usec;
+  uint32_t                   message_offset;   /* of the union of messages */
+  uint32_t                   num_message_ids;
+  char                     **message_names;
+  uint32_t                   num_tasks;
+  char                     **task_names;
+  // key fields of each message, offsets from the beginning of the message
+  uint32_t                  *num_key_fields;
+  itti_query_field_t       (*key_fields)[ITTI_QUERY_MAX_KEY_FIELDS];
+} itti_query_description_t;
+
+//==============================================================================
+// Index file
+//==============================================================================
+
+typedef struct itti_query_index_hdr_s {
+  uint32_t                   magic;
+  uint32_t                   version;
+  uint64_t                   dump_size;
+  int64_t                    dump_mtime;
+  uint32_t                   num_messages;
+  uint32_t                   num_message_ids;
+  uint32_t                   num_tasks;
+  uint32_t                   num_keys;
+  char                       keys[ITTI_QUERY_MAX_KEYS][ITTI_QUERY_MAX_KEY_LENGTH];
+  uint64_t                   num_ue_entries;
+  uint64_t                   messages_offset;        /* itti_query_message_t[num_messages] */
+  uint64_t                   by_id_offset;           /* uint32_t[num_message_ids + 1] starts, then uint32_t[num_messages] */
+  uint64_t                   by_origin_offset;       /* uint32_t[num_tasks + 1] starts, then uint32_t[num_messages] */
+  uint64_t                   by_destination_offset;  /* uint32_t[num_tasks + 1] starts, then uint32_t[num_messages] */
+  uint64_t                   ue_offset;              /* itti_query_ue_entry_t[num_ue_entries], sorted by key, value, message */
+} itti_query_index_hdr_t;
+
+typedef struct itti_query_message_s {
+  uint64_t                   offset;           /* of the record in the dump */
+  uint64_t                   time_us;
+  uint32_t                   message_number;
+  uint32_t                   size;             /* of the record in the dump */
+  uint16_t                   message_id;
+  uint8_t                    origin;
+  uint8_t                    destination;
+  uint16_t                   instance;
+  uint16_t                   reserved;
+} itti_query_message_t;
+
+typedef struct itti_query_ue_entry_s {
+  uint64_t                   value;
+  uint32_t                   message;
+  uint16_t                   key;
+  uint16_t                   reserved;
+} itti_query_ue_entry_t;
+
+typedef struct itti_query_index_s {
+  itti_query_index_hdr_t    *hdr;
+  size_t                     size;
+  const itti_query_message_t *messages;
+  const uint32_t            *by_id;
+  const uint32_t            *by_origin;
+  const uint32_t            *by_destination;
+  const itti_query_ue_entry_t *ue_entries;
+} itti_query_index_t;
+
+//==============================================================================
+// Query
+//==============================================================================
+
+typedef struct itti_query_ue_filter_s {
+  int                        key;              /* -1 for any key */
+  uint64_t                   value;
+} itti_query_ue_filter_t;
+
+typedef struct itti_query_s {
+  bool                      *message_ids;      /* NULL for any */
+  bool                      *origins;
+  bool                      *destinations;
+  itti_query_ue_filter_t    *ue_filters;
+  uint32_t                   num_ue_filters;
+  uint64_t                   first_number;
+  uint64_t                   last_number;
+  uint64_t                   from_us;
+  uint64_t                   to_us;
+} itti_query_t;
+
+typedef struct itti_query_export_s {
+  pthread_t                  thread;
+  const uint32_t            *matches;
+  uint32_t                   num_matches;
+  int                        fd;               /* dump export */
+  uint64_t                   file_offset;
+  char                      *text;             /* text export */
+  size_t                     text_size;
+  int                        rc;
+} itti_query_export_t;
+
+static itti_query_description_t g_description;
+static itti_query_index_t       g_index;
+static const uint8_t           *g_dump = NULL;
+static size_t                   g_dump_size = 0;
+static const uint8_t           *g_xml_record = NULL;
+static uint32_t                 g_xml_record_size = 0;
+static char                    *g_keys[ITTI_QUERY_MAX_KEYS];
+static uint32_t                 g_num_keys = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t itti_query_read_field(const uint8_t * const dataP, const itti_query_field_t * const fieldP)
+{
+  uint64_t                  value = 0;
+
+  // dumps are read on the architecture that wrote them
+  switch (fieldP->size) {
+  case 1: value = dataP[fieldP->offset]; break;
+  case 2: {uint16_t v; memcpy (&v, &dataP[fieldP->offset], 2); value = v;} break;
+  case 4: {uint32_t v; memcpy (&v, &dataP[fieldP->offset], 4); value = v;} break;
+  case 8: memcpy (&value, &dataP[fieldP->offset], 8); break;
+  default:;
+  }
+  return value;
+}
+
+//==============================================================================
+// XML description
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// gccxml ids are "_<n>" with an optional "c" or "v" suffix for qualified types
+static uint32_t itti_query_xml_id(const char * const idP)
+{
+  const char               *p = idP;
+  uint32_t                  id = 0;
+
+  if ((NULL == p) || ('_' != *p)) {
+    return 0;
+  }
+  id = strtoul (p + 1, (char **)&p, 10) * 4;
+  for (; *p; p++) {
+    id |= ('c' == *p) ? 1 : (('v' == *p) ? 2 : 0);
+  }
+  return id;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t itti_query_xml_uint(xmlNode * const nodeP, const char * const nameP)
+{
+  xmlChar                  *value = xmlGetProp (nodeP, (const xmlChar *)nameP);
+  uint32_t                  v = 0;
+
+  if (value) {
+    v = strtoul ((const char *)value, NULL, 0);
+    xmlFree (value);
+  }
+  return v;
+}
+
+//------------------------------------------------------------------------------
+static char *itti_query_xml_string(xmlNode * const nodeP, const char * const nameP)
+{
+  xmlChar                  *value = xmlGetProp (nodeP, (const xmlChar *)nameP);
+  char                     *s = NULL;
+
+  if (value) {
+    s = strdup ((const char *)value);
+    xmlFree (value);
+  }
+  return s;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t itti_query_xml_ref(xmlNode * const nodeP, const char * const nameP)
+{
+  xmlChar                  *value = xmlGetProp (nodeP, (const xmlChar *)nameP);
+  uint32_t                  id = 0;
+
+  if (value) {
+    id = itti_query_xml_id ((const char *)value);
+    xmlFree (value);
+  }
+  return id;
+}
+
+//------------------------------------------------------------------------------
+static void itti_query_xml_members(xmlNode * const nodeP, itti_query_type_t * const typeP)
+{
+  xmlChar                  *value = xmlGetProp (nodeP, (const xmlChar *)"members");
+  char                     *saveptr = NULL;
+  char                     *member = NULL;
+
+  if (NULL == value) {
+    return;
+  }
+  for (member = strtok_r ((char *)value, " ", &saveptr); member; member = strtok_r (NULL, " ", &saveptr)) {
+    typeP->members = realloc (typeP->members, (typeP->num_members + 1) * sizeof (uint32_t));
+    typeP->members[typeP->num_members++] = itti_query_xml_id (member);
+  }
+  xmlFree (value);
+}
+
+//------------------------------------------------------------------------------
+static itti_query_type_kind_t itti_query_xml_kind(const char * const elementP)
+{
+  static const struct {
+    const char              *element;
+    itti_query_type_kind_t   kind;
+  } kinds[] = {
+    {"FundamentalType", ITTI_QUERY_TYPE_FUNDAMENTAL}, {"Enumeration", ITTI_QUERY_TYPE_ENUMERATION},
+    {"Struct", ITTI_QUERY_TYPE_STRUCT}, {"Union", ITTI_QUERY_TYPE_UNION}, {"Typedef", ITTI_QUERY_TYPE_TYPEDEF},
+    {"CvQualifiedType", ITTI_QUERY_TYPE_CV_QUALIFIED}, {"ArrayType", ITTI_QUERY_TYPE_ARRAY},
+    {"PointerType", ITTI_QUERY_TYPE_POINTER}, {"Field", ITTI_QUERY_TYPE_FIELD},
+  };
+  int                       i = 0;
+
+  for (i = 0; i < sizeof (kinds) / sizeof (kinds[0]); i++) {
+    if (0 == strcmp (elementP, kinds[i].element)) {
+      return kinds[i].kind;
+    }
+  }
+  return ITTI_QUERY_TYPE_NONE;
+}
+
+//------------------------------------------------------------------------------
+static int itti_query_xml_load_types(const char * const xmlP, const size_t sizeP)
+{
+  xmlDocPtr                 doc = xmlReadMemory (xmlP, sizeP, NULL, NULL, XML_PARSE_HUGE | XML_PARSE_NOBLANKS);
+  xmlNode                  *node = NULL;
+  xmlNode                  *value_node = NULL;
+  itti_query_type_t        *type_p = NULL;
+  itti_query_type_kind_t    kind = ITTI_QUERY_TYPE_NONE;
+  uint32_t                  id = 0;
+
+  if (NULL == doc) {
+    return -1;
+  }
+  for (node = xmlDocGetRootElement (doc)->children; node; node = node->next) {
+    if ((XML_ELEMENT_NODE != node->type) || (ITTI_QUERY_TYPE_NONE == (kind = itti_query_xml_kind ((const char *)node->name)))) {
+      continue;
+    }
+    id = itti_query_xml_ref (node, "id");
+    if (id >= g_description.num_types) {
+      g_description.types = realloc (g_description.types, 2 * (id + 1) * sizeof (itti_query_type_t));
+      memset (&g_description.types[g_description.num_types], 0, (2 * (id + 1) - g_description.num_types) * sizeof (itti_query_type_t));
+      g_description.num_types = 2 * (id + 1);
+    }
+    type_p = &g_description.types[id];
+    type_p->kind   = kind;
+    type_p->name   = itti_query_xml_string (node, "name");
+    type_p->type   = itti_query_xml_ref (node, "type");
+    type_p->size   = itti_query_xml_uint (node, "size");
+    type_p->offset = itti_query_xml_uint (node, "offset");
+    type_p->bits   = itti_query_xml_uint (node, "bits");
+    itti_query_xml_members (node, type_p);
+    if (ITTI_QUERY_TYPE_ENUMERATION == kind) {
+      for (value_node = node->children; value_node; value_node = value_node->next) {
+        if ((XML_ELEMENT_NODE == value_node->type) && (0 == strcmp ((const char *)value_node->name, "EnumValue"))) {
+          type_p->value_names = realloc (type_p->value_names, (type_p->num_members + 1) * sizeof (char *));
+          type_p->values = realloc (type_p->values, (type_p->num_members + 1) * sizeof (int64_t));
+          type_p->value_names[type_p->num_members] = itti_query_xml_string (value_node, "name");
+          type_p->values[type_p->num_members++] = (int32_t)itti_query_xml_uint (value_node, "init");
+        }
+      }
+    }
+  }
+  xmlFreeDoc (doc);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static const itti_query_type_t *itti_query_type(const uint32_t idP)
+{
+  return (idP < g_description.num_types) ? &g_description.types[idP] : NULL;
+}
+
+//------------------------------------------------------------------------------
+// Through typedefs and qualifiers
+static const itti_query_type_t *itti_query_resolve(const itti_query_type_t * typeP)
+{
+  int                       i = 0;
+
+  for (i = 0; (typeP) && (i < 16) &&
+       ((ITTI_QUERY_TYPE_TYPEDEF == typeP->kind) || (ITTI_QUERY_TYPE_CV_QUALIFIED == typeP->kind)); i++) {
+    typeP = itti_query_type (typeP->type);
+  }
+  return typeP;
+}
+
+//------------------------------------------------------------------------------
+static const itti_query_type_t *itti_query_find_typedef(const char * const nameP)
+{
+  uint32_t                  i = 0;
+
+  for (i = 0; i < g_description.num_types; i++) {
+    if ((ITTI_QUERY_TYPE_TYPEDEF == g_description.types[i].kind) && (g_description.types[i].name) &&
+        (0 == strcmp (g_description.types[i].name, nameP))) {
+      return itti_query_resolve (&g_description.types[i]);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static const itti_query_type_t *itti_query_find_field(const itti_query_type_t * const structP, const char * const nameP)
+{
+  const itti_query_type_t  *field_p = NULL;
+  uint32_t                  i = 0;
+
+  for (i = 0; (structP) && (i < structP->num_members); i++) {
+    field_p = itti_query_type (structP->members[i]);
+    if ((field_p) && (ITTI_QUERY_TYPE_FIELD == field_p->kind) && (field_p->name) && (0 == strcmp (field_p->name, nameP))) {
+      return field_p;
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Integer field of the header, false if it is not described as expected
+static bool itti_query_header_field(const itti_query_type_t * const structP, const uint32_t base_offsetP, const char * const nameP,
+    itti_query_field_t * const fieldP, const itti_query_type_t ** const typeP)
+{
+  const itti_query_type_t  *field_p = itti_query_find_field (structP, nameP);
+  const itti_query_type_t  *type_p = (field_p) ? itti_query_resolve (itti_query_type (field_p->type)) : NULL;
+
+  if ((NULL == type_p) || (field_p->bits) || (field_p->offset & 7) ||
+      ((ITTI_QUERY_TYPE_FUNDAMENTAL != type_p->kind) && (ITTI_QUERY_TYPE_ENUMERATION != type_p->kind)) ||
+      ((8 != type_p->size) && (16 != type_p->size) && (32 != type_p->size) && (64 != type_p->size))) {
+    fprintf (stderr, "Field %s of the message header is not described as expected\n", nameP);
+    return false;
+  }
+  fieldP->offset = base_offsetP + field_p->offset / 8;
+  fieldP->size   = type_p->size / 8;
+  if (typeP) {
+    *typeP = type_p;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static char **itti_query_enum_names(const itti_query_type_t * const enumP, const char * const skipP, uint32_t * const numP)
+{
+  char                    **names = NULL;
+  uint32_t                  num = 0;
+  uint32_t                  i = 0;
+
+  for (i = 0; i < enumP->num_members; i++) {
+    if ((enumP->values[i] >= 0) && (enumP->values[i] + 1 > num)) {
+      num = enumP->values[i] + 1;
+    }
+  }
+  names = calloc (num, sizeof (char *));
+  for (i = 0; i < enumP->num_members; i++) {
+    // aliases as TASK_FIRST do not replace the first name of a value
+    if ((enumP->values[i] >= 0) && (NULL == names[enumP->values[i]]) && (0 != strcmp (enumP->value_names[i], skipP))) {
+      names[enumP->values[i]] = enumP->value_names[i];
+    }
+  }
+  *numP = num;
+  return names;
+}
+
+//------------------------------------------------------------------------------
+// Integer fields named as a key in a message, in nested structures, not in unions, arrays or through pointers
+static void itti_query_find_keys(const uint32_t message_idP, const itti_query_type_t * const typeP, const uint32_t offsetP, const int depthP)
+{
+  const itti_query_type_t  *field_p = NULL;
+  const itti_query_type_t  *type_p = NULL;
+  itti_query_field_t       *key_field_p = NULL;
+  uint32_t                  i = 0;
+  uint32_t                  k = 0;
+
+  if ((NULL == typeP) || (ITTI_QUERY_TYPE_STRUCT != typeP->kind) || (depthP > ITTI_QUERY_MAX_DEPTH)) {
+    return;
+  }
+  for (i = 0; i < typeP->num_members; i++) {
+    field_p = itti_query_type (typeP->members[i]);
+    if ((NULL == field_p) || (ITTI_QUERY_TYPE_FIELD != field_p->kind) || (NULL == field_p->name) || (field_p->bits) || (field_p->offset & 7)) {
+      continue;
+    }
+    type_p = itti_query_resolve (itti_query_type (field_p->type));
+    if (NULL == type_p) {
+      continue;
+    }
+    if (ITTI_QUERY_TYPE_STRUCT == type_p->kind) {
+      itti_query_find_keys (message_idP, type_p, offsetP + field_p->offset / 8, depthP + 1);
+      continue;
+    }
+    if (((ITTI_QUERY_TYPE_FUNDAMENTAL != type_p->kind) && (ITTI_QUERY_TYPE_ENUMERATION != type_p->kind)) ||
+        ((8 != type_p->size) && (16 != type_p->size) && (32 != type_p->size) && (64 != type_p->size))) {
+      continue;
+    }
+    for (k = 0; k < g_num_keys; k++) {
+      if ((0 == strcmp (field_p->name, g_keys[k])) && (ITTI_QUERY_MAX_KEY_FIELDS > g_description.num_key_fields[message_idP])) {
+        key_field_p = &g_description.key_fields[message_idP][g_description.num_key_fields[message_idP]++];
+        key_field_p->offset = offsetP + field_p->offset / 8;
+        key_field_p->size   = type_p->size / 8;
+        key_field_p->key    = k;
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static int itti_query_load_description(const char * const xmlP, const size_t sizeP)
+{
+  const itti_query_type_t  *message_def_p = NULL;
+  const itti_query_type_t  *header_p = NULL;
+  const itti_query_type_t  *messages_p = NULL;
+  const itti_query_type_t  *lte_time_p = NULL;
+  const itti_query_type_t  *timeval_p = NULL;
+  const itti_query_type_t  *field_p = NULL;
+  const itti_query_type_t  *message_ids_p = NULL;
+  const itti_query_type_t  *tasks_p = NULL;
+  uint32_t                  header_offset = 0;
+  uint32_t                  time_offset = 0;
+  uint32_t                  i = 0;
+
+  if (itti_query_xml_load_types (xmlP, sizeP)) {
+    fprintf (stderr, "Could not parse the XML description of the messages\n");
+    return -1;
+  }
+  // same types as itti_analyzer: MessageDef, ittiMsgHeader, ittiMsg
+  message_def_p = itti_query_find_typedef ("MessageDef");
+  if ((NULL == message_def_p) || (NULL == (field_p = itti_query_find_field (message_def_p, "ittiMsgHeader")))) {
+    fprintf (stderr, "MessageDef is not described\n");
+    return -1;
+  }
+  header_offset = field_p->offset / 8;
+  header_p = itti_query_resolve (itti_query_type (field_p->type));
+  if (NULL == (field_p = itti_query_find_field (message_def_p, "ittiMsg"))) {
+    fprintf (stderr, "ittiMsg is not described\n");
+    return -1;
+  }
+  g_description.message_offset = field_p->offset / 8;
+  messages_p = itti_query_resolve (itti_query_type (field_p->type));
+  if ((!itti_query_header_field (header_p, header_offset, "messageId", &g_description.message_id, &message_ids_p)) ||
+      (!itti_query_header_field (header_p, header_offset, "originTaskId", &g_description.origin, &tasks_p)) ||
+      (!itti_query_header_field (header_p, header_offset, "destinationTaskId", &g_description.destination, NULL)) ||
+      (!itti_query_header_field (header_p, header_offset, "instance", &g_description.instance, NULL)) ||
+      (!itti_query_header_field (header_p, header_offset, "ittiMsgSize", &g_description.message_size, NULL)) ||
+      (ITTI_QUERY_TYPE_ENUMERATION != message_ids_p->kind) || (ITTI_QUERY_TYPE_ENUMERATION != tasks_p->kind) ||
+      (NULL == messages_p) || (ITTI_QUERY_TYPE_UNION != messages_p->kind)) {
+    return -1;
+  }
+  g_description.message_names = itti_query_enum_names (message_ids_p, "MESSAGES_ID_MAX", &g_description.num_message_ids);
+  g_description.task_names = itti_query_enum_names (tasks_p, "TASK_FIRST", &g_description.num_tasks);
+  // time of the message, optional
+  if ((NULL != (field_p = itti_query_find_field (header_p, "lte_time"))) &&
+      (NULL != (lte_time_p = itti_query_resolve (itti_query_type (field_p->type))))) {
+    time_offset = header_offset + field_p->offset / 8;
+    if ((NULL != (field_p = itti_query_find_field (lte_time_p, "time"))) &&
+        (NULL != (timeval_p = itti_query_resolve (itti_query_type (field_p->type))))) {
+      time_offset += field_p->offset / 8;
+      itti_query_header_field (timeval_p, time_offset, "tv_sec", &g_description.tv_sec, NULL);
+      itti_query_header_field (timeval_p, time_offset, "tv_usec", &g_description.tv_usec, NULL);
+    }
+  }
+  // members of the union of messages are in the order of the message ids
+  g_description.num_key_fields = calloc (g_description.num_message_ids, sizeof (uint32_t));
+  g_description.key_fields = calloc (g_description.num_message_ids, sizeof (*g_description.key_fields));
+  for (i = 0; (i < messages_p->num_members) && (i < g_description.num_message_ids); i++) {
+    field_p = itti_query_type (messages_p->members[i]);
+    if ((field_p) && (ITTI_QUERY_TYPE_FIELD == field_p->kind)) {
+      itti_query_find_keys (i, itti_query_resolve (itti_query_type (field_p->type)), 0, 0);
+    }
+  }
+  return 0;
+}
+
+//==============================================================================
+// Index
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static int itti_query_compare_ue_entries(const void *aP, const void *bP)
+{
+  const itti_query_ue_entry_t *a = (const itti_query_ue_entry_t *)aP;
+  const itti_query_ue_entry_t *b = (const itti_query_ue_entry_t *)bP;
+
+  if (a->key != b->key) {
+    return (a->key < b->key) ? -1 : 1;
+  }
+  if (a->value != b->value) {
+    return (a->value < b->value) ? -1 : 1;
+  }
+  return (a->message < b->message) ? -1 : (a->message > b->message);
+}
+
+//------------------------------------------------------------------------------
+// Counting sort of the messages by a field, starts[num_values + 1] then the message indexes
+static uint32_t *itti_query_build_postings(const itti_query_message_t * const messagesP, const uint32_t num_messagesP,
+    const uint32_t num_valuesP, const size_t field_offsetP)
+{
+  uint32_t                 *postings = calloc (num_valuesP + 1 + num_messagesP, sizeof (uint32_t));
+  uint32_t                 *next = calloc (num_valuesP + 1, sizeof (uint32_t));
+  uint32_t                  value = 0;
+  uint32_t                  m = 0;
+
+  for (m = 0; m < num_messagesP; m++) {
+    value = (1 == field_offsetP) ? messagesP[m].message_id :
+            (2 == field_offsetP) ? messagesP[m].origin : messagesP[m].destination;
+    postings[value + 1]++;
+  }
+  for (value = 0; value < num_valuesP; value++) {
+    postings[value + 1] += postings[value];
+    next[value] = postings[value];
+  }
+  for (m = 0; m < num_messagesP; m++) {
+    value = (1 == field_offsetP) ? messagesP[m].message_id :
+            (2 == field_offsetP) ? messagesP[m].origin : messagesP[m].destination;
+    postings[num_valuesP + 1 + next[value]++] = m;
+  }
+  free (next);
+  return postings;
+}
+
+//------------------------------------------------------------------------------
+static bool itti_query_write(const int fdP, const void * const dataP, const size_t sizeP)
+{
+  const uint8_t            *p = (const uint8_t *)dataP;
+  size_t                    written = 0;
+  ssize_t                   rv = 0;
+
+  while (written < sizeP) {
+    rv = write (fdP, &p[written], sizeP - written);
+    if (0 >= rv) {
+      if ((0 > rv) && (EINTR == errno)) {
+        continue;
+      }
+      return false;
+    }
+    written += rv;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static int itti_query_build_index(const char * const index_pathP, const struct stat * const dump_statP)
+{
+  itti_query_index_hdr_t    hdr;
+  itti_query_message_t     *messages = NULL;
+  itti_query_message_t     *message_p = NULL;
+  itti_query_ue_entry_t    *ue_entries = NULL;
+  itti_query_ue_entry_t    *ue_entry_p = NULL;
+  uint32_t                 *by_id = NULL;
+  uint32_t                 *by_origin = NULL;
+  uint32_t                 *by_destination = NULL;
+  itti_socket_header_t      socket_header;
+  const uint8_t            *message_def = NULL;
+  char                      tmp_path[PATH_MAX + 16];
+  uint64_t                  size_messages = 0;
+  uint64_t                  size_ue_entries = 0;
+  uint64_t                  offset = g_xml_record_size;
+  uint32_t                  message_size = 0;
+  uint32_t                  message_id = 0;
+  uint32_t                  k = 0;
+  int                       fd = -1;
+
+  memset (&hdr, 0, sizeof (hdr));
+  madvise ((void *)g_dump, g_dump_size, MADV_SEQUENTIAL);
+  while (offset + ITTI_QUERY_RECORD_HEADER_SIZE <= g_dump_size) {
+    memcpy (&socket_header, &g_dump[offset], sizeof (socket_header));
+    if ((socket_header.message_size < ITTI_QUERY_RECORD_HEADER_SIZE + sizeof (itti_message_types_t)) || (offset + socket_header.message_size > g_dump_size)) {
+      fprintf (stderr, "Dump truncated at byte %" PRIu64 "\n", offset);
+      break;
+    }
+    message_def = &g_dump[offset + ITTI_QUERY_RECORD_HEADER_SIZE];
+    if ((ITTI_DUMP_MESSAGE_TYPE != socket_header.message_type) ||
+        (socket_header.message_size < ITTI_QUERY_RECORD_HEADER_SIZE + g_description.message_offset + sizeof (itti_message_types_t)) ||
+        ((message_id = itti_query_read_field (message_def, &g_description.message_id)) >= g_description.num_message_ids)) {
+      offset += socket_header.message_size;
+      continue;
+    }
+    if (hdr.num_messages == size_messages) {
+      size_messages = (size_messages) ? 2 * size_messages : 65536;
+      messages = realloc (messages, size_messages * sizeof (itti_query_message_t));
+    }
+    message_p = &messages[hdr.num_messages];
+    memset (message_p, 0, sizeof (*message_p));
+    message_p->offset         = offset;
+    message_p->size           = socket_header.message_size;
+    message_p->message_number = strtoul ((const char *)&g_dump[offset + sizeof (itti_socket_header_t)], NULL, 10);
+    message_p->message_id     = message_id;
+    message_p->origin         = itti_query_read_field (message_def, &g_description.origin);
+    message_p->destination    = itti_query_read_field (message_def, &g_description.destination);
+    message_p->instance       = itti_query_read_field (message_def, &g_description.instance);
+    message_p->time_us        = itti_query_read_field (message_def, &g_description.tv_sec) * 1000000 +
+                                itti_query_read_field (message_def, &g_description.tv_usec);
+    message_size = itti_query_read_field (message_def, &g_description.message_size);
+    if ((message_p->origin >= g_description.num_tasks) || (message_p->destination >= g_description.num_tasks)) {
+      offset += socket_header.message_size;
+      continue;
+    }
+    // identifiers of the UE, in the message as dumped
+    for (k = 0; k < g_description.num_key_fields[message_id]; k++) {
+      if ((g_description.key_fields[message_id][k].offset + g_description.key_fields[message_id][k].size > message_size) ||
+          (ITTI_QUERY_RECORD_HEADER_SIZE + g_description.message_offset + g_description.key_fields[message_id][k].offset +
+           g_description.key_fields[message_id][k].size > socket_header.message_size)) {
+        continue;
+      }
+      if (hdr.num_ue_entries == size_ue_entries) {
+        size_ue_entries = (size_ue_entries) ? 2 * size_ue_entries : 65536;
+        ue_entries = realloc (ue_entries, size_ue_entries * sizeof (itti_query_ue_entry_t));
+      }
+      ue_entry_p = &ue_entries[hdr.num_ue_entries++];
+      ue_entry_p->value    = itti_query_read_field (&message_def[g_description.message_offset], &g_description.key_fields[message_id][k]);
+      ue_entry_p->message  = hdr.num_messages;
+      ue_entry_p->key      = g_description.key_fields[message_id][k].key;
+      ue_entry_p->reserved = 0;
+    }
+    hdr.num_messages++;
+    offset += socket_header.message_size;
+  }
+  qsort (ue_entries, hdr.num_ue_entries, sizeof (itti_query_ue_entry_t), itti_query_compare_ue_entries);
+  by_id = itti_query_build_postings (messages, hdr.num_messages, g_description.num_message_ids, 1);
+  by_origin = itti_query_build_postings (messages, hdr.num_messages, g_description.num_tasks, 2);
+  by_destination = itti_query_build_postings (messages, hdr.num_messages, g_description.num_tasks, 3);
+
+  hdr.magic                 = ITTI_QUERY_INDEX_MAGIC;
+  hdr.version               = ITTI_QUERY_INDEX_VERSION;
+  hdr.dump_size             = dump_statP->st_size;
+  hdr.dump_mtime            = dump_statP->st_mtime;
+  hdr.num_message_ids       = g_description.num_message_ids;
+  hdr.num_tasks             = g_description.num_tasks;
+  hdr.num_keys              = g_num_keys;
+  for (k = 0; k < g_num_keys; k++) {
+    strncpy (hdr.keys[k], g_keys[k], ITTI_QUERY_MAX_KEY_LENGTH - 1);
+  }
+  hdr.messages_offset       = sizeof (hdr);
+  hdr.by_id_offset          = hdr.messages_offset + (uint64_t)hdr.num_messages * sizeof (itti_query_message_t);
+  hdr.by_origin_offset      = hdr.by_id_offset + (uint64_t)(hdr.num_message_ids + 1 + hdr.num_messages) * sizeof (uint32_t);
+  hdr.by_destination_offset = hdr.by_origin_offset + (uint64_t)(hdr.num_tasks + 1 + hdr.num_messages) * sizeof (uint32_t);
+  hdr.ue_offset             = (hdr.by_destination_offset + (uint64_t)(hdr.num_tasks + 1 + hdr.num_messages) * sizeof (uint32_t) + 7) & ~(uint64_t)7;
+
+  // written aside then renamed, a concurrent query never sees a partial index
+  snprintf (tmp_path, sizeof (tmp_path), "%s.%d", index_pathP, (int)getpid ());
+  fd = open (tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if ((0 > fd) ||
+      (!itti_query_write (fd, &hdr, sizeof (hdr))) ||
+      (!itti_query_write (fd, messages, (size_t)hdr.num_messages * sizeof (itti_query_message_t))) ||
+      (!itti_query_write (fd, by_id, (size_t)(hdr.num_message_ids + 1 + hdr.num_messages) * sizeof (uint32_t))) ||
+      (!itti_query_write (fd, by_origin, (size_t)(hdr.num_tasks + 1 + hdr.num_messages) * sizeof (uint32_t))) ||
+      (!itti_query_write (fd, by_destination, (size_t)(hdr.num_tasks + 1 + hdr.num_messages) * sizeof (uint32_t))) ||
+      (0 > lseek (fd, hdr.ue_offset, SEEK_SET)) ||
+      (!itti_query_write (fd, ue_entries, (size_t)hdr.num_ue_entries * sizeof (itti_query_ue_entry_t))) ||
+      (close (fd)) || (rename (tmp_path, index_pathP))) {
+    fprintf (stderr, "Could not write index %s : %s\n", index_pathP, strerror (errno));
+    if (0 <= fd) {
+      unlink (tmp_path);
+    }
+    return -1;
+  }
+  fprintf (stderr, "Indexed %u messages, %" PRIu64 " UE identifiers in %s\n", hdr.num_messages, hdr.num_ue_entries, index_pathP);
+  free (messages);
+  free (ue_entries);
+  free (by_id);
+  free (by_origin);
+  free (by_destination);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// Returns false if there is no index, or if it does not match the dump and the keys
+static bool itti_query_map_index(const char * const index_pathP, const struct stat * const dump_statP)
+{
+  const itti_query_index_hdr_t *hdr = NULL;
+  struct stat               st;
+  uint32_t                  k = 0;
+  int                       fd = open (index_pathP, O_RDONLY);
+
+  if ((0 > fd) || (fstat (fd, &st)) || (sizeof (itti_query_index_hdr_t) > (size_t)st.st_size)) {
+    if (0 <= fd) {
+      close (fd);
+    }
+    return false;
+  }
+  g_index.size = st.st_size;
+  g_index.hdr = mmap (NULL, g_index.size, PROT_READ, MAP_SHARED, fd, 0);
+  close (fd);
+  if (MAP_FAILED == g_index.hdr) {
+    g_index.hdr = NULL;
+    return false;
+  }
+  hdr = g_index.hdr;
+  if ((ITTI_QUERY_INDEX_MAGIC != hdr->magic) || (ITTI_QUERY_INDEX_VERSION != hdr->version) ||
+      (hdr->dump_size != (uint64_t)dump_statP->st_size) || (hdr->dump_mtime != dump_statP->st_mtime) ||
+      (hdr->num_message_ids != g_description.num_message_ids) || (hdr->num_tasks != g_description.num_tasks) ||
+      (hdr->num_keys != g_num_keys) ||
+      (hdr->ue_offset + hdr->num_ue_entries * sizeof (itti_query_ue_entry_t) > g_index.size)) {
+    munmap (g_index.hdr, g_index.size);
+    g_index.hdr = NULL;
+    return false;
+  }
+  for (k = 0; k < g_num_keys; k++) {
+    if (strncmp (hdr->keys[k], g_keys[k], ITTI_QUERY_MAX_KEY_LENGTH - 1)) {
+      munmap (g_index.hdr, g_index.size);
+      g_index.hdr = NULL;
+      return false;
+    }
+  }
+  g_index.messages       = (const itti_query_message_t *)((const uint8_t *)hdr + hdr->messages_offset);
+  g_index.by_id          = (const uint32_t *)((const uint8_t *)hdr + hdr->by_id_offset);
+  g_index.by_origin      = (const uint32_t *)((const uint8_t *)hdr + hdr->by_origin_offset);
+  g_index.by_destination = (const uint32_t *)((const uint8_t *)hdr + hdr->by_destination_offset);
+  g_index.ue_entries     = (const itti_query_ue_entry_t *)((const uint8_t *)hdr + hdr->ue_offset);
+  return true;
+}
+
+//==============================================================================
+// Query
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static int itti_query_compare_uint32(const void *aP, const void *bP)
+{
+  uint32_t                  a = *(const uint32_t *)aP;
+  uint32_t                  b = *(const uint32_t *)bP;
+
+  return (a < b) ? -1 : (a > b);
+}
+
+//------------------------------------------------------------------------------
+// Messages of a UE identifier, appended to candidates
+static void itti_query_ue_candidates(const uint16_t keyP, const uint64_t valueP, uint32_t ** const candidatesP, uint64_t * const numP)
+{
+  const itti_query_ue_entry_t *entries = g_index.ue_entries;
+  uint64_t                  low = 0;
+  uint64_t                  high = g_index.hdr->num_ue_entries;
+  uint64_t                  middle = 0;
+  uint64_t                  e = 0;
+
+  // first entry not lower than (key, value)
+  while (low < high) {
+    middle = (low + high) / 2;
+    if ((entries[middle].key < keyP) || ((entries[middle].key == keyP) && (entries[middle].value < valueP))) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  for (high = low; (high < g_index.hdr->num_ue_entries) && (entries[high].key == keyP) && (entries[high].value == valueP); high++);
+  *candidatesP = realloc (*candidatesP, (*numP + high - low + 1) * sizeof (uint32_t));
+  for (e = low; e < high; e++) {
+    (*candidatesP)[(*numP)++] = entries[e].message;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Messages of the posting lists of the selected values, appended to candidates
+static void itti_query_posting_candidates(const uint32_t * const postingsP, const uint32_t num_valuesP, const bool * const selectedP,
+    uint32_t ** const candidatesP, uint64_t * const numP)
+{
+  const uint32_t           *messages = &postingsP[num_valuesP + 1];
+  uint32_t                  v = 0;
+
+  for (v = 0; v < num_valuesP; v++) {
+    if ((selectedP[v]) && (postingsP[v + 1] > postingsP[v])) {
+      *candidatesP = realloc (*candidatesP, (*numP + postingsP[v + 1] - postingsP[v]) * sizeof (uint32_t));
+      memcpy (&(*candidatesP)[*numP], &messages[postingsP[v]], (postingsP[v + 1] - postingsP[v]) * sizeof (uint32_t));
+      *numP += postingsP[v + 1] - postingsP[v];
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Matching messages, in the order of the dump
+static uint32_t *itti_query_run(const itti_query_t * const queryP, uint64_t * const num_matchesP)
+{
+  const itti_query_message_t *message_p = NULL;
+  uint32_t                 *candidates = NULL;
+  uint64_t                  num_candidates = 0;
+  uint64_t                  num_matches = 0;
+  uint64_t                  c = 0;
+  uint32_t                  k = 0;
+  uint32_t                  f = 0;
+
+  // the most selective list first, the other criteria are checked on each candidate
+  if (queryP->num_ue_filters) {
+    for (f = 0; f < queryP->num_ue_filters; f++) {
+      for (k = 0; k < g_num_keys; k++) {
+        if ((0 > queryP->ue_filters[f].key) || (k == queryP->ue_filters[f].key)) {
+          itti_query_ue_candidates (k, queryP->ue_filters[f].value, &candidates, &num_candidates);
+        }
+      }
+    }
+  } else if (queryP->message_ids) {
+    itti_query_posting_candidates (g_index.by_id, g_index.hdr->num_message_ids, queryP->message_ids, &candidates, &num_candidates);
+  } else if (queryP->origins) {
+    itti_query_posting_candidates (g_index.by_origin, g_index.hdr->num_tasks, queryP->origins, &candidates, &num_candidates);
+  } else if (queryP->destinations) {
+    itti_query_posting_candidates (g_index.by_destination, g_index.hdr->num_tasks, queryP->destinations, &candidates, &num_candidates);
+  } else {
+    num_candidates = g_index.hdr->num_messages;
+    candidates = malloc ((num_candidates + 1) * sizeof (uint32_t));
+    for (c = 0; c < num_candidates; c++) {
+      candidates[c] = c;
+    }
+  }
+  qsort (candidates, num_candidates, sizeof (uint32_t), itti_query_compare_uint32);
+
+  for (c = 0; c < num_candidates; c++) {
+    if ((c) && (candidates[c] == candidates[c - 1])) {
+      continue;
+    }
+    message_p = &g_index.messages[candidates[c]];
+    if (((queryP->message_ids) && (!queryP->message_ids[message_p->message_id])) ||
+        ((queryP->origins) && (!queryP->origins[message_p->origin])) ||
+        ((queryP->destinations) && (!queryP->destinations[message_p->destination])) ||
+        (message_p->message_number < queryP->first_number) || (message_p->message_number > queryP->last_number) ||
+        (message_p->time_us < queryP->from_us) || (message_p->time_us > queryP->to_us)) {
+      continue;
+    }
+    candidates[num_matches++] = candidates[c];
+  }
+  *num_matchesP = num_matches;
+  return candidates;
+}
+
+//==============================================================================
+// Export
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void itti_query_print_message(const uint32_t messageP, FILE * const outP)
+{
+  const itti_query_message_t *message_p = &g_index.messages[messageP];
+  const uint8_t            *message_def = &g_dump[message_p->offset + ITTI_QUERY_RECORD_HEADER_SIZE];
+  const itti_query_field_t *key_field_p = NULL;
+  const char               *origin = g_description.task_names[message_p->origin];
+  const char               *destination = g_description.task_names[message_p->destination];
+  uint32_t                  message_size = itti_query_read_field (message_def, &g_description.message_size);
+  uint32_t                  k = 0;
+
+  fprintf (outP, "%u %" PRIu64 ".%06" PRIu64 " %s -> %s %s instance %u", message_p->message_number,
+      message_p->time_us / 1000000, message_p->time_us % 1000000, (origin) ? origin : "?", (destination) ? destination : "?",
+      (g_description.message_names[message_p->message_id]) ? g_description.message_names[message_p->message_id] : "?", message_p->instance);
+  for (k = 0; k < g_description.num_key_fields[message_p->message_id]; k++) {
+    key_field_p = &g_description.key_fields[message_p->message_id][k];
+    if ((key_field_p->offset + key_field_p->size <= message_size) &&
+        (ITTI_QUERY_RECORD_HEADER_SIZE + g_description.message_offset + key_field_p->offset + key_field_p->size <= message_p->size)) {
+      fprintf (outP, " %s=%" PRIu64, g_keys[key_field_p->key], itti_query_read_field (&message_def[g_description.message_offset], key_field_p));
+    }
+  }
+  fputc ('\n', outP);
+}
+
+//------------------------------------------------------------------------------
+static void *itti_query_export_thread(void *argsP)
+{
+  itti_query_export_t      *export_p = (itti_query_export_t *)argsP;
+  const itti_query_message_t *message_p = NULL;
+  uint64_t                  offset = export_p->file_offset;
+  FILE                     *text = NULL;
+  ssize_t                   rv = 0;
+  uint32_t                  m = 0;
+
+  if (0 > export_p->fd) {
+    text = open_memstream (&export_p->text, &export_p->text_size);
+    for (m = 0; m < export_p->num_matches; m++) {
+      itti_query_print_message (export_p->matches[m], text);
+    }
+    fclose (text);
+    return NULL;
+  }
+  // records are copied as they are from the dump
+  for (m = 0; m < export_p->num_matches; m++) {
+    message_p = &g_index.messages[export_p->matches[m]];
+    rv = pwrite (export_p->fd, &g_dump[message_p->offset], message_p->size, offset);
+    if (rv != message_p->size) {
+      export_p->rc = -1;
+      break;
+    }
+    offset += message_p->size;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Matches are split in consecutive slices, one per thread, each slice is written at its place in the output
+static int itti_query_export(const uint32_t * const matchesP, const uint64_t num_matchesP, const char * const dump_pathP,
+    FILE * const text_outP, const int num_threadsP)
+{
+  itti_query_export_t       exports[ITTI_QUERY_MAX_THREADS];
+  uint64_t                  file_offset = g_xml_record_size;
+  uint64_t                  first = 0;
+  uint64_t                  m = 0;
+  int                       fd = -1;
+  int                       rc = 0;
+  int                       t = 0;
+
+  if (dump_pathP) {
+    fd = open (dump_pathP, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if ((0 > fd) || (!itti_query_write (fd, g_xml_record, g_xml_record_size))) {
+      fprintf (stderr, "Could not write %s : %s\n", dump_pathP, strerror (errno));
+      return -1;
+    }
+  }
+  memset (exports, 0, sizeof (exports));
+  for (t = 0; t < num_threadsP; t++) {
+    exports[t].matches     = &matchesP[first];
+    exports[t].num_matches = (num_matchesP * (t + 1)) / num_threadsP - first;
+    exports[t].fd          = fd;
+    exports[t].file_offset = file_offset;
+    for (m = first; m < first + exports[t].num_matches; m++) {
+      file_offset += g_index.messages[matchesP[m]].size;
+    }
+    first += exports[t].num_matches;
+    pthread_create (&exports[t].thread, NULL, itti_query_export_thread, &exports[t]);
+  }
+  for (t = 0; t < num_threadsP; t++) {
+    pthread_join (exports[t].thread, NULL);
+    rc |= exports[t].rc;
+    if (exports[t].text) {
+      fwrite (exports[t].text, exports[t].text_size, 1, text_outP);
+      free (exports[t].text);
+    }
+  }
+  if ((0 <= fd) && ((close (fd)) || (rc))) {
+    fprintf (stderr, "Could not write %s : %s\n", dump_pathP, strerror (errno));
+    return -1;
+  }
+  return 0;
+}
+
+//==============================================================================
+// Command line
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Comma separated names, or numbers, of a enumeration
+static bool *itti_query_parse_names(char * const listP, char ** const namesP, const uint32_t num_namesP, const char * const prefixP)
+{
+  bool                     *selected = calloc (num_namesP, sizeof (bool));
+  char                     *saveptr = NULL;
+  char                     *name = NULL;
+  char                     *end = NULL;
+  uint32_t                  value = 0;
+  uint32_t                  i = 0;
+
+  for (name = strtok_r (listP, ",", &saveptr); name; name = strtok_r (NULL, ",", &saveptr)) {
+    value = strtoul (name, &end, 0);
+    if (('\0' == *end) && (value < num_namesP)) {
+      selected[value] = true;
+      continue;
+    }
+    for (i = 0; i < num_namesP; i++) {
+      if ((namesP[i]) && ((0 == strcmp (namesP[i], name)) ||
+          ((0 == strncmp (namesP[i], prefixP, strlen (prefixP))) && (0 == strcmp (namesP[i] + strlen (prefixP), name))))) {
+        selected[i] = true;
+        break;
+      }
+    }
+    if (i == num_namesP) {
+      fprintf (stderr, "Unknown %s\n", name);
+      free (selected);
+      return NULL;
+    }
+  }
+  return selected;
+}
+
+//------------------------------------------------------------------------------
+// [key=]value
+static bool itti_query_parse_ue_filter(const char * const filterP, itti_query_t * const queryP)
+{
+  const char               *equal = strchr (filterP, '=');
+  itti_query_ue_filter_t   *filter_p = NULL;
+  uint32_t                  k = 0;
+
+  queryP->ue_filters = realloc (queryP->ue_filters, (queryP->num_ue_filters + 1) * sizeof (itti_query_ue_filter_t));
+  filter_p = &queryP->ue_filters[queryP->num_ue_filters++];
+  filter_p->key = -1;
+  filter_p->value = strtoull ((equal) ? equal + 1 : filterP, NULL, 0);
+  if (equal) {
+    for (k = 0; k < g_num_keys; k++) {
+      if ((strlen (g_keys[k]) == (size_t)(equal - filterP)) && (0 == strncmp (g_keys[k], filterP, equal - filterP))) {
+        filter_p->key = k;
+      }
+    }
+    if (0 > filter_p->key) {
+      fprintf (stderr, "%.*s is not an indexed key (-k)\n", (int)(equal - filterP), filterP);
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void itti_query_usage(const char * const nameP)
+{
+  fprintf (stderr, "Usage: %s -d /tmp/mme.itti [-i index] [-r] [-k ue_id,mme_ue_s1ap_id,...] [-m message[,message]] [-f task[,task]]\n"
+      "         [-t task[,task]] [-u [key=]value] [-n first:last] [-T from:to] [-p out.txt|-] [-x out.itti] [-j threads]\n"
+      "  -r rebuilds the index, -f and -t filter on the origin and destination tasks, -u on UE identifiers (any key without key=),\n"
+      "  -n on message numbers, -T on times in seconds since the epoch\n", nameP);
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  itti_query_t              query;
+  itti_socket_header_t      socket_header;
+  struct stat               st;
+  char                      default_keys[] = ITTI_QUERY_DEFAULT_KEYS;
+  char                      default_index_path[PATH_MAX];
+  char                     *keys = default_keys;
+  char                     *message_list = NULL;
+  char                     *origin_list = NULL;
+  char                     *destination_list = NULL;
+  char                     *saveptr = NULL;
+  char                     *key = NULL;
+  const char               *dump_path = NULL;
+  const char               *index_path = NULL;
+  const char               *text_path = NULL;
+  const char               *export_path = NULL;
+  FILE                     *text_out = NULL;
+  uint32_t                 *matches = NULL;
+  uint64_t                  num_matches = 0;
+  uint64_t                  m = 0;
+  uint32_t                 *histogram = NULL;
+  bool                      rebuild = false;
+  int                       num_threads = sysconf (_SC_NPROCESSORS_ONLN);
+  int                       fd = -1;
+  int                       c = 0;
+  uint32_t                  i = 0;
+
+  memset (&query, 0, sizeof (query));
+  query.last_number = UINT64_MAX;
+  query.to_us = UINT64_MAX;
+  while ((c = getopt (argc, argv, "d:i:rk:m:f:t:u:n:T:p:x:j:")) != -1) {
+    switch (c) {
+    case 'd': dump_path = optarg; break;
+    case 'i': index_path = optarg; break;
+    case 'r': rebuild = true; break;
+    case 'k': keys = optarg; break;
+    case 'm': message_list = optarg; break;
+    case 'f': origin_list = optarg; break;
+    case 't': destination_list = optarg; break;
+    case 'u':
+      // parsed once the keys are known
+      query.ue_filters = realloc (query.ue_filters, (query.num_ue_filters + 1) * sizeof (itti_query_ue_filter_t));
+      query.ue_filters[query.num_ue_filters].key = -1;
+      query.ue_filters[query.num_ue_filters++].value = (uintptr_t)optarg;
+      break;
+    case 'n':
+      query.first_number = strtoull (optarg, &key, 0);
+      query.last_number = (':' == *key) ? strtoull (key + 1, NULL, 0) : query.first_number;
+      break;
+    case 'T':
+      query.from_us = strtod (optarg, &key) * 1e6;
+      query.to_us = (':' == *key) ? strtod (key + 1, NULL) * 1e6 : UINT64_MAX;
+      break;
+    case 'p': text_path = optarg; break;
+    case 'x': export_path = optarg; break;
+    case 'j': num_threads = atoi (optarg); break;
+    default:
+      itti_query_usage (argv[0]);
+      return -1;
+    }
+  }
+  if (NULL == dump_path) {
+    itti_query_usage (argv[0]);
+    return -1;
+  }
+  num_threads = (num_threads < 1) ? 1 : ((num_threads > ITTI_QUERY_MAX_THREADS) ? ITTI_QUERY_MAX_THREADS : num_threads);
+  for (key = strtok_r (keys, ",", &saveptr); (key) && (g_num_keys < ITTI_QUERY_MAX_KEYS); key = strtok_r (NULL, ",", &saveptr)) {
+    g_keys[g_num_keys++] = key;
+  }
+
+  fd = open (dump_path, O_RDONLY);
+  if ((0 > fd) || (fstat (fd, &st))) {
+    fprintf (stderr, "Could not open %s : %s\n", dump_path, strerror (errno));
+    return -1;
+  }
+  g_dump_size = st.st_size;
+  g_dump = (sizeof (socket_header) <= g_dump_size) ? mmap (NULL, g_dump_size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close (fd);
+  if (MAP_FAILED == g_dump) {
+    fprintf (stderr, "Could not map %s : %s\n", dump_path, strerror (errno));
+    return -1;
+  }
+  // the dump starts with the XML description of the messages
+  memcpy (&socket_header, g_dump, sizeof (socket_header));
+  if ((ITTI_DUMP_XML_DEFINITION != socket_header.message_type) || (socket_header.message_size > g_dump_size) ||
+      (socket_header.message_size < sizeof (socket_header) + sizeof (itti_message_types_t))) {
+    fprintf (stderr, "%s is not an ITTI dump\n", dump_path);
+    return -1;
+  }
+  g_xml_record = g_dump;
+  g_xml_record_size = socket_header.message_size;
+  if (itti_query_load_description ((const char *)&g_dump[sizeof (socket_header)],
+      strnlen ((const char *)&g_dump[sizeof (socket_header)], g_xml_record_size - sizeof (socket_header) - sizeof (itti_message_types_t)))) {
+    return -1;
+  }
+
+  if (NULL == index_path) {
+    snprintf (default_index_path, sizeof (default_index_path), "%s.idx", dump_path);
+    index_path = default_index_path;
+  }
+  if ((rebuild) || (!itti_query_map_index (index_path, &st))) {
+    if ((itti_query_build_index (index_path, &st)) || (!itti_query_map_index (index_path, &st))) {
+      return -1;
+    }
+  }
+
+  if (((message_list) && (NULL == (query.message_ids = itti_query_parse_names (message_list, g_description.message_names, g_description.num_message_ids, "")))) ||
+      ((origin_list) && (NULL == (query.origins = itti_query_parse_names (origin_list, g_description.task_names, g_description.num_tasks, "TASK_")))) ||
+      ((destination_list) && (NULL == (query.destinations = itti_query_parse_names (destination_list, g_description.task_names, g_description.num_tasks, "TASK_"))))) {
+    return -1;
+  }
+  for (i = 0; i < query.num_ue_filters; i++) {
+    key = (char *)(uintptr_t)query.ue_filters[i].value;
+    query.num_ue_filters = i;
+    if (!itti_query_parse_ue_filter (key, &query)) {
+      return -1;
+    }
+  }
+
+  matches = itti_query_run (&query, &num_matches);
+  fprintf (stderr, "%" PRIu64 " messages out of %u\n", num_matches, g_index.hdr->num_messages);
+  if (text_path) {
+    text_out = (0 == strcmp (text_path, "-")) ? stdout : fopen (text_path, "w");
+    if ((NULL == text_out) || (itti_query_export (matches, num_matches, NULL, text_out, num_threads))) {
+      fprintf (stderr, "Could not write %s\n", text_path);
+      return -1;
+    }
+    if (stdout != text_out) {
+      fclose (text_out);
+    }
+  }
+  if ((export_path) && (itti_query_export (matches, num_matches, export_path, NULL, num_threads))) {
+    return -1;
+  }
+  if ((NULL == text_path) && (NULL == export_path)) {
+    histogram = calloc (g_description.num_message_ids, sizeof (uint32_t));
+    for (m = 0; m < num_matches; m++) {
+      histogram[g_index.messages[matches[m]].message_id]++;
+    }
+    for (i = 0; i < g_description.num_message_ids; i++) {
+      if (histogram[i]) {
+        fprintf (stdout, "%-48s %10u\n", (g_description.message_names[i]) ? g_description.message_names[i] : "?", histogram[i]);
+      }
+    }
+    free (histogram);
+  }
+  free (matches);
+  munmap (g_index.hdr, g_index.size);
+  munmap ((void *)g_dump, g_dump_size);
+  return 0;
+}
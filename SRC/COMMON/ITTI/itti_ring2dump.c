@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file itti_ring2dump.c
+   \brief Offline converter of ITTI dump ring files (ITTI_DUMP_RING) to the dump file format read by itti_analyzer. Messages are written
+   in the order they were sent. Messages overwritten in the ring, or in rotated files that were removed, are lost.
+   Usage: itti_ring2dump -o /tmp/mme.itti /tmp/mme.ring [/tmp/mme.ring.1 ...]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "itti_types.h"
+#include "intertask_interface_dump_ring.h"
+
+typedef struct itti_ring2dump_record_s {
+  const itti_dump_ring_record_hdr_t *record;
+  uint64_t                           message_number;
+  uint64_t                           position;
+} itti_ring2dump_record_t;
+
+static itti_ring2dump_record_t *g_records = NULL;
+static uint64_t                 g_num_records = 0;
+static uint64_t                 g_size_records = 0;
+
+//------------------------------------------------------------------------------
+static void itti_ring2dump_add_record(const itti_dump_ring_record_hdr_t * const recordP)
+{
+  if (g_num_records == g_size_records) {
+    g_size_records = (g_size_records) ? 2 * g_size_records : 4096;
+    g_records = realloc(g_records, g_size_records * sizeof(itti_ring2dump_record_t));
+    if (NULL == g_records) {
+      fprintf (stderr, "Could not allocate %" PRIu64 " records\n", g_size_records);
+      exit (-1);
+    }
+  }
+  g_records[g_num_records].record         = recordP;
+  g_records[g_num_records].message_number = recordP->message_number;
+  g_records[g_num_records].position       = recordP->position;
+  g_num_records++;
+}
+
+//------------------------------------------------------------------------------
+// Walk the chunks of the ring from the oldest one not overwritten by the chunk of the head, returns the number of records
+static uint64_t itti_ring2dump_load_ring(const itti_dump_ring_file_hdr_t * const hdrP, const uint8_t * const mapP)
+{
+  const uint8_t                     *ring = mapP + hdrP->ring_offset;
+  const itti_dump_ring_record_hdr_t *record_p = NULL;
+  uint64_t                           head = hdrP->head;
+  uint64_t                           chunk = hdrP->base;
+  uint64_t                           position = 0;
+  uint64_t                           chunk_end = 0;
+  uint64_t                           num_records = 0;
+
+  if (head > chunk + hdrP->ring_size) {
+    chunk = (head - hdrP->ring_size + hdrP->chunk_size - 1) & ~((uint64_t)hdrP->chunk_size - 1);
+  }
+  for (; chunk < head; chunk += hdrP->chunk_size) {
+    chunk_end = chunk + hdrP->chunk_size;
+    position  = chunk;
+    while ((position + sizeof(itti_dump_ring_record_hdr_t)) <= chunk_end) {
+      record_p = (const itti_dump_ring_record_hdr_t *)&ring[position & (hdrP->ring_size - 1)];
+      // end of the records of this chunk, or record not completely written
+      if ((position != record_p->position) || (record_p->size < sizeof(itti_dump_ring_record_hdr_t) + record_p->data_size) ||
+          ((position + record_p->size) > chunk_end)) {
+        break;
+      }
+      itti_ring2dump_add_record(record_p);
+      num_records++;
+      position += record_p->size;
+    }
+  }
+  return num_records;
+}
+
+//------------------------------------------------------------------------------
+static int itti_ring2dump_compare(const void *aP, const void *bP)
+{
+  const itti_ring2dump_record_t *a = (const itti_ring2dump_record_t *)aP;
+  const itti_ring2dump_record_t *b = (const itti_ring2dump_record_t *)bP;
+
+  if (a->message_number != b->message_number) {
+    return (a->message_number < b->message_number) ? -1 : 1;
+  }
+  return (a->position < b->position) ? -1 : (a->position > b->position);
+}
+
+//------------------------------------------------------------------------------
+static void itti_ring2dump_write_xml(const itti_dump_ring_file_hdr_t * const hdrP, const uint8_t * const mapP, FILE * const outP)
+{
+  const itti_message_types_t  end = ITTI_DUMP_XML_DEFINITION_END;
+  itti_socket_header_t        header;
+
+  header.message_size = sizeof (itti_socket_header_t) + hdrP->xml_size + sizeof (itti_message_types_t);
+  header.message_type = ITTI_DUMP_XML_DEFINITION;
+  fwrite (&header, sizeof (itti_socket_header_t), 1, outP);
+  fwrite (mapP + hdrP->xml_offset, hdrP->xml_size, 1, outP);
+  fwrite (&end, sizeof (itti_message_types_t), 1, outP);
+}
+
+//------------------------------------------------------------------------------
+// Same layout as itti_dump_fwrite_message()
+static void itti_ring2dump_write_message(const itti_dump_ring_record_hdr_t * const recordP, FILE * const outP)
+{
+  const itti_message_types_t  end = ITTI_DUMP_MESSAGE_TYPE_END;
+  itti_socket_header_t        header;
+  itti_signal_header_t        signal_header;
+
+  header.message_size = sizeof (itti_socket_header_t) + sizeof (itti_signal_header_t) + recordP->data_size + sizeof (itti_message_types_t);
+  header.message_type = ITTI_DUMP_MESSAGE_TYPE;
+  snprintf (signal_header.message_number_char, sizeof (signal_header.message_number_char), MESSAGE_NUMBER_CHAR_FORMAT, (uint32_t)recordP->message_number);
+  signal_header.message_number_char[sizeof (signal_header.message_number_char) - 1] = '\n';
+  fwrite (&header, sizeof (itti_socket_header_t), 1, outP);
+  fwrite (&signal_header, sizeof (itti_signal_header_t), 1, outP);
+  fwrite (&recordP[1], recordP->data_size, 1, outP);
+  fwrite (&end, sizeof (itti_message_types_t), 1, outP);
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  const char                         *output = NULL;
+  FILE                               *out = NULL;
+  const itti_dump_ring_file_hdr_t    *hdr = NULL;
+  const itti_dump_ring_file_hdr_t    *xml_hdr = NULL;
+  const uint8_t                      *xml_map = NULL;
+  uint8_t                            *map = NULL;
+  struct stat                         st;
+  uint64_t                            num_records = 0;
+  uint64_t                            dropped = 0;
+  uint64_t                            r = 0;
+  int                                 fd = -1;
+  int                                 c = 0;
+  int                                 i = 0;
+
+  while ((c = getopt (argc, argv, "o:")) != -1) {
+    switch (c) {
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      output = NULL;
+      optind = argc;
+    }
+  }
+  if ((NULL == output) || (optind >= argc)) {
+    fprintf (stderr, "Usage: %s -o /tmp/mme.itti /tmp/mme.ring [/tmp/mme.ring.1 ...]\n", argv[0]);
+    return -1;
+  }
+
+  // input files stay mapped until the output is written
+  for (i = optind; i < argc; i++) {
+    fd = open (argv[i], O_RDONLY);
+    if ((0 > fd) || (fstat (fd, &st))) {
+      fprintf (stderr, "Could not open %s : %s\n", argv[i], strerror (errno));
+      return -1;
+    }
+    if (sizeof(itti_dump_ring_file_hdr_t) > (size_t)st.st_size) {
+      fprintf (stderr, "%s is not an ITTI dump ring file\n", argv[i]);
+      return -1;
+    }
+    map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (MAP_FAILED == map) {
+      fprintf (stderr, "Could not map %s : %s\n", argv[i], strerror (errno));
+      return -1;
+    }
+    hdr = (const itti_dump_ring_file_hdr_t *)map;
+    if ((ITTI_DUMP_RING_MAGIC != hdr->magic) || (ITTI_DUMP_RING_VERSION != hdr->version) ||
+        (hdr->ring_offset + hdr->ring_size > (uint64_t)st.st_size) ||
+        ((uint64_t)hdr->xml_offset + hdr->xml_size > (uint64_t)st.st_size) || (0 == hdr->xml_size) ||
+        (0 == hdr->chunk_size) || (hdr->ring_size & (hdr->ring_size - 1)) || (hdr->ring_size % hdr->chunk_size)) {
+      fprintf (stderr, "%s is not an ITTI dump ring file of version %u\n", argv[i], ITTI_DUMP_RING_VERSION);
+      return -1;
+    }
+    if (NULL == xml_hdr) {
+      xml_hdr = hdr;
+      xml_map = map;
+    }
+    if (hdr->dropped > dropped) {
+      dropped = hdr->dropped;
+    }
+    num_records = itti_ring2dump_load_ring(hdr, map);
+    fprintf (stderr, "%s: file %u, %" PRIu64 " messages\n", argv[i], hdr->file_number, num_records);
+  }
+  qsort (g_records, g_num_records, sizeof(itti_ring2dump_record_t), itti_ring2dump_compare);
+
+  out = fopen (output, "wb");
+  if (NULL == out) {
+    fprintf (stderr, "Could not open %s : %s\n", output, strerror (errno));
+    return -1;
+  }
+  itti_ring2dump_write_xml(xml_hdr, xml_map, out);
+  for (r = 0; r < g_num_records; r++) {
+    itti_ring2dump_write_message(g_records[r].record, out);
+  }
+  if (fclose (out)) {
+    fprintf (stderr, "Could not write %s : %s\n", output, strerror (errno));
+    return -1;
+  }
+  fprintf (stderr, "%" PRIu64 " messages written to %s, %" PRIu64 " messages larger than a chunk were not recorded\n", g_num_records, output, dropped);
+  free (g_records);
+  return 0;
+}
@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file itti_trace_report.c
+   \brief Offline analysis of ITTI trace files (ITTI_TRACE). Spans are grouped by procedure, the critical path of each procedure is
+   followed back from its last span through the spans that sent the messages, the time on the path is split per task in queue time
+   (message sent to message received), processing time, and wait time (nothing processed on the path: peer, timer or a task that does
+   not trace its thread).
+   Usage: itti_trace_report [-n <slowest procedures>] [-t <trace id>] /tmp/mme.itti_trace
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <unistd.h>
+
+#define ITTI_TRACE_FILE_FORMAT_ONLY
+#include "intertask_interface_trace.h"
+
+typedef struct itti_trace_report_trace_s {
+  uint64_t                 trace_id;
+  uint32_t                 first;              /*!< \brief First span of the trace in g_spans */
+  uint32_t                 count;
+  uint64_t                 duration_ns;        /*!< \brief Start of the procedure to the end of its last span */
+} itti_trace_report_trace_t;
+
+typedef struct itti_trace_report_task_s {
+  uint64_t                 spans;
+  uint64_t                 queue_ns;
+  uint64_t                 processing_ns;
+  uint64_t                 path_spans;
+  uint64_t                 path_queue_ns;
+  uint64_t                 path_processing_ns;
+  uint64_t                 path_wait_ns;       /*!< \brief Wait on the path before a message of the task is sent */
+} itti_trace_report_task_t;
+
+static itti_trace_file_hdr_t      g_hdr;
+static char                      *g_names = NULL;
+static itti_trace_span_t         *g_spans = NULL;
+static uint32_t                   g_num_spans = 0;
+static itti_trace_report_trace_t *g_traces = NULL;
+static uint32_t                   g_num_traces = 0;
+static itti_trace_report_task_t  *g_tasks = NULL;
+
+//------------------------------------------------------------------------------
+static const char *itti_trace_report_task_name(const uint32_t task_idP)
+{
+  return (task_idP < g_hdr.tasks) ? &g_names[task_idP * ITTI_TRACE_NAME_LENGTH] : "?";
+}
+
+//------------------------------------------------------------------------------
+static const char *itti_trace_report_message_name(const uint32_t message_idP)
+{
+  return (message_idP < g_hdr.messages) ? &g_names[(g_hdr.tasks + message_idP) * ITTI_TRACE_NAME_LENGTH] : "?";
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_report_load(const char * const filenameP)
+{
+  FILE     *file = fopen(filenameP, "r");
+  size_t    names_size = 0;
+  long      size = 0;
+
+  if (NULL == file) {
+    fprintf (stderr, "Could not open ITTI trace file %s : %s\n", filenameP, strerror (errno));
+    return -1;
+  }
+  if ((1 != fread(&g_hdr, sizeof(g_hdr), 1, file)) || (ITTI_TRACE_MAGIC != g_hdr.magic)) {
+    fprintf (stderr, "%s is not an ITTI trace file\n", filenameP);
+    fclose(file);
+    return -1;
+  }
+  if ((ITTI_TRACE_VERSION != g_hdr.version) || (sizeof(itti_trace_span_t) != g_hdr.span_size)) {
+    fprintf (stderr, "%s: version %u span size %u not supported\n", filenameP, g_hdr.version, g_hdr.span_size);
+    fclose(file);
+    return -1;
+  }
+  names_size = (size_t)(g_hdr.tasks + g_hdr.messages) * ITTI_TRACE_NAME_LENGTH;
+  g_names = malloc(names_size);
+  if ((NULL == g_names) || (1 != fread(g_names, names_size, 1, file))) {
+    fprintf (stderr, "%s: truncated names\n", filenameP);
+    fclose(file);
+    return -1;
+  }
+  fseek(file, 0, SEEK_END);
+  size = ftell(file) - (long)(sizeof(g_hdr) + names_size);
+  fseek(file, sizeof(g_hdr) + names_size, SEEK_SET);
+  g_num_spans = size / sizeof(itti_trace_span_t);
+  g_spans = malloc((g_num_spans + 1) * sizeof(itti_trace_span_t));
+  if ((NULL == g_spans) || (g_num_spans != fread(g_spans, sizeof(itti_trace_span_t), g_num_spans, file))) {
+    fprintf (stderr, "%s: could not read %u spans\n", filenameP, g_num_spans);
+    fclose(file);
+    return -1;
+  }
+  fclose(file);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_report_compare_spans(const void *aP, const void *bP)
+{
+  const itti_trace_span_t *a = (const itti_trace_span_t *)aP;
+  const itti_trace_span_t *b = (const itti_trace_span_t *)bP;
+
+  if (a->trace_id != b->trace_id) {
+    return (a->trace_id < b->trace_id) ? -1 : 1;
+  }
+  if (a->start_ns != b->start_ns) {
+    return (a->start_ns < b->start_ns) ? -1 : 1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_report_compare_durations(const void *aP, const void *bP)
+{
+  const itti_trace_report_trace_t *a = (const itti_trace_report_trace_t *)aP;
+  const itti_trace_report_trace_t *b = (const itti_trace_report_trace_t *)bP;
+
+  if (a->duration_ns != b->duration_ns) {
+    return (a->duration_ns > b->duration_ns) ? -1 : 1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static void itti_trace_report_group(void)
+{
+  uint32_t i;
+
+  qsort(g_spans, g_num_spans, sizeof(itti_trace_span_t), itti_trace_report_compare_spans);
+  g_traces = calloc(g_num_spans + 1, sizeof(itti_trace_report_trace_t));
+  for (i = 0; i < g_num_spans; i++) {
+    itti_trace_report_trace_t *trace = &g_traces[g_num_traces ? g_num_traces - 1 : 0];
+
+    if ((0 == g_num_traces) || (trace->trace_id != g_spans[i].trace_id)) {
+      trace = &g_traces[g_num_traces++];
+      trace->trace_id = g_spans[i].trace_id;
+      trace->first = i;
+    }
+    trace->count++;
+    if ((g_spans[i].end_ns - g_spans[i].trace_start_ns) > trace->duration_ns) {
+      trace->duration_ns = g_spans[i].end_ns - g_spans[i].trace_start_ns;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+/* Span of the trace that sent the message of spanP: processed by the origin task when it was sent, else the last one ended before */
+static const itti_trace_span_t *itti_trace_report_predecessor(const itti_trace_report_trace_t * const traceP,
+    const itti_trace_span_t * const spanP, bool * const waitP)
+{
+  const itti_trace_span_t *before = NULL;
+  uint32_t                 i;
+
+  *waitP = false;
+  for (i = traceP->first; i < traceP->first + traceP->count; i++) {
+    const itti_trace_span_t *span = &g_spans[i];
+
+    if (span == spanP) {
+      continue;
+    }
+    if ((span->task_id == spanP->origin_task_id) && (span->start_ns <= spanP->sent_ns) && (span->end_ns >= spanP->sent_ns)) {
+      return span;
+    }
+    if ((span->end_ns <= spanP->sent_ns) && ((NULL == before) || (span->end_ns > before->end_ns))) {
+      before = span;
+    }
+  }
+  *waitP = true;
+  return before;
+}
+
+//------------------------------------------------------------------------------
+/* Follows the critical path back from the last span of the trace, accounted in g_tasks, printed if printP */
+static void itti_trace_report_critical_path(const itti_trace_report_trace_t * const traceP, const bool printP)
+{
+  const itti_trace_span_t *span = NULL;
+  uint32_t                 hops = 0;
+  uint32_t                 i;
+
+  for (i = traceP->first; i < traceP->first + traceP->count; i++) {
+    if ((NULL == span) || (g_spans[i].end_ns > span->end_ns)) {
+      span = &g_spans[i];
+    }
+  }
+  while ((span) && (hops++ < traceP->count)) {
+    itti_trace_report_task_t *task = &g_tasks[span->task_id];
+    const itti_trace_span_t  *predecessor = NULL;
+    bool                      wait = false;
+    uint64_t                  wait_ns = 0;
+
+    task->path_spans++;
+    task->path_queue_ns += span->start_ns - span->sent_ns;
+    task->path_processing_ns += span->end_ns - span->start_ns;
+    predecessor = itti_trace_report_predecessor(traceP, span, &wait);
+    if (wait) {
+      wait_ns = span->sent_ns - (predecessor ? predecessor->end_ns : span->trace_start_ns);
+      g_tasks[span->origin_task_id].path_wait_ns += wait_ns;
+    }
+    if (printP) {
+      printf ("  %10.3f ms %-24s -> %-24s %-40s queue %9.3f ms processing %9.3f ms wait %9.3f ms\n",
+          (span->start_ns - span->trace_start_ns) / 1e6, itti_trace_report_task_name(span->origin_task_id),
+          itti_trace_report_task_name(span->task_id), itti_trace_report_message_name(span->message_id),
+          (span->start_ns - span->sent_ns) / 1e6, (span->end_ns - span->start_ns) / 1e6, wait_ns / 1e6);
+    }
+    span = predecessor;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void itti_trace_report_print_trace(const itti_trace_report_trace_t * const traceP)
+{
+  uint32_t i;
+
+  printf ("Procedure %" PRIu64 ": %u spans, %.3f ms\n", traceP->trace_id, traceP->count, traceP->duration_ns / 1e6);
+  for (i = traceP->first; i < traceP->first + traceP->count; i++) {
+    const itti_trace_span_t *span = &g_spans[i];
+
+    printf ("  %10.3f ms %-24s -> %-24s %-40s #%-10" PRIu64 " queue %9.3f ms processing %9.3f ms\n",
+        (span->start_ns - span->trace_start_ns) / 1e6, itti_trace_report_task_name(span->origin_task_id),
+        itti_trace_report_task_name(span->task_id), itti_trace_report_message_name(span->message_id), span->message_number,
+        (span->start_ns - span->sent_ns) / 1e6, (span->end_ns - span->start_ns) / 1e6);
+  }
+  printf (" Critical path, last span first:\n");
+  itti_trace_report_critical_path(traceP, true);
+}
+
+//------------------------------------------------------------------------------
+static void usage(const char * const nameP)
+{
+  fprintf (stderr, "Usage: %s [-n <slowest procedures>] [-t <trace id>] <itti trace file>\n", nameP);
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+  uint32_t   slowest = 10;
+  uint64_t   trace_id = 0;
+  uint64_t   path_ns = 0;
+  uint32_t   i;
+  int        c;
+
+  while ((c = getopt (argc, argv, "n:t:")) != -1) {
+    switch (c) {
+      case 'n':
+        slowest = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        trace_id = strtoull(optarg, NULL, 0);
+        break;
+      default:
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+  }
+  if (optind != argc - 1) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if (itti_trace_report_load(argv[optind])) {
+    return EXIT_FAILURE;
+  }
+  itti_trace_report_group();
+  g_tasks = calloc(256, sizeof(itti_trace_report_task_t));
+  for (i = 0; i < g_num_spans; i++) {
+    g_tasks[g_spans[i].task_id].spans++;
+    g_tasks[g_spans[i].task_id].queue_ns += g_spans[i].start_ns - g_spans[i].sent_ns;
+    g_tasks[g_spans[i].task_id].processing_ns += g_spans[i].end_ns - g_spans[i].start_ns;
+  }
+  if (trace_id) {
+    for (i = 0; i < g_num_traces; i++) {
+      if (g_traces[i].trace_id == trace_id) {
+        itti_trace_report_print_trace(&g_traces[i]);
+        return EXIT_SUCCESS;
+      }
+    }
+    fprintf (stderr, "Procedure %" PRIu64 " not found\n", trace_id);
+    return EXIT_FAILURE;
+  }
+  for (i = 0; i < g_num_traces; i++) {
+    itti_trace_report_critical_path(&g_traces[i], false);
+  }
+  qsort(g_traces, g_num_traces, sizeof(itti_trace_report_trace_t), itti_trace_report_compare_durations);
+  printf ("%u spans, %u procedures traced, 1 out of %u\n", g_num_spans, g_num_traces, g_hdr.sampling);
+  if (0 == g_num_traces) {
+    return EXIT_SUCCESS;
+  }
+  printf ("Duration: p50 %.3f ms p90 %.3f ms p99 %.3f ms max %.3f ms\n",
+      g_traces[g_num_traces / 2].duration_ns / 1e6, g_traces[g_num_traces / 10].duration_ns / 1e6,
+      g_traces[g_num_traces / 100].duration_ns / 1e6, g_traces[0].duration_ns / 1e6);
+  for (i = 0; i < 256; i++) {
+    path_ns += g_tasks[i].path_queue_ns + g_tasks[i].path_processing_ns + g_tasks[i].path_wait_ns;
+  }
+  printf ("\n%-24s %40s | %s\n", "", "mean per span", "critical path, mean per procedure");
+  printf ("%-24s %10s %14s %14s | %-10s %14s %14s %14s %7s\n", "Task", "spans", "queue(us)", "process(us)",
+      "spans", "queue(us)", "process(us)", "wait(us)", "path%");
+  for (i = 0; i < 256; i++) {
+    const itti_trace_report_task_t *task = &g_tasks[i];
+    uint64_t                        task_path_ns = task->path_queue_ns + task->path_processing_ns + task->path_wait_ns;
+
+    if ((0 == task->spans) && (0 == task->path_wait_ns)) {
+      continue;
+    }
+    printf ("%-24s %10" PRIu64 " %14.1f %14.1f | %-10" PRIu64 " %14.1f %14.1f %14.1f %6.1f%%\n", itti_trace_report_task_name(i),
+        task->spans, task->spans ? task->queue_ns / 1e3 / task->spans : 0, task->spans ? task->processing_ns / 1e3 / task->spans : 0,
+        task->path_spans, task->path_queue_ns / 1e3 / g_num_traces, task->path_processing_ns / 1e3 / g_num_traces,
+        task->path_wait_ns / 1e3 / g_num_traces, path_ns ? 100.0 * task_path_ns / path_ns : 0);
+  }
+  printf ("\nSlowest procedures:\n");
+  for (i = 0; (i < slowest) && (i < g_num_traces); i++) {
+    const itti_trace_span_t *first = &g_spans[g_traces[i].first];
+
+    printf ("  %-20" PRIu64 " %10.3f ms %5u spans, first %s -> %s %s\n", g_traces[i].trace_id, g_traces[i].duration_ns / 1e6,
+        g_traces[i].count, itti_trace_report_task_name(first->origin_task_id), itti_trace_report_task_name(first->task_id),
+        itti_trace_report_message_name(first->message_id));
+  }
+  return EXIT_SUCCESS;
+}
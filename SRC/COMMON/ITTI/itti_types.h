@@ -41,6 +41,11 @@
 
 #define MESSAGE_NUMBER_CHAR_FORMAT      "%11u"
 
+/* In a dumped message, the content of each bstring field of the message (see messages_bstring_def.h) follows the
+ * message: 32 bits length, then the bytes padded to 32 bits. The length of a NULL bstring is ITTI_DUMP_BSTRING_NULL.
+ */
+#define ITTI_DUMP_BSTRING_NULL          UINT32_MAX
+
 /* Intertask message types */
 enum itti_message_types_e {
   ITTI_DUMP_XML_DEFINITION =        CHARS_TO_UINT32 ('\n', 'I', 'x', 'd'),
@@ -27,6 +27,11 @@
  * either expressed or implied, of the FreeBSD Project.
  */
 
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
 #include "assertions.h"
 #include "memory_pools.h"
 #include "dynamic_memory_check.h"
@@ -51,27 +56,11 @@ uint64_t                                vcd_mp_free;
 #define MEMORY_POOL_ITEM_INFO_NUMBER    2
 
 /*------------------------------------------------------------------------------*/
-typedef int32_t                         items_group_position_t;
 typedef int32_t                         items_group_index_t;
-
-typedef union items_group_positions_u {
-  uint64_t                                all;
-  struct {
-    items_group_position_t                  put;
-    items_group_position_t                  get;
-  } ind;
-} items_group_positions_t;
-
-typedef struct items_group_s {
-  items_group_position_t                  number_plus_one;
-  volatile uint32_t                       minimum;
-  volatile items_group_positions_t        positions;
-  volatile items_group_index_t           *indexes;
-} items_group_t;
+typedef int32_t                         chunk_index_t;
 
 /*------------------------------------------------------------------------------*/
-static const items_group_position_t     ITEMS_GROUP_POSITION_INVALID = -1;
-static const items_group_index_t        ITEMS_GROUP_INDEX_INVALID = -1;
+static const chunk_index_t              CHUNK_INDEX_INVALID = -1;
 
 /*------------------------------------------------------------------------------*/
 typedef uint32_t                        pool_item_start_mark_t;
@@ -91,6 +80,7 @@ typedef struct memory_pool_item_start_s {
 
   pool_id_t                               pool_id;
   item_status_t                           item_status;
+  uint16_t                                chunk;
   uint16_t                                info[MEMORY_POOL_ITEM_INFO_NUMBER];
 } memory_pool_item_start_t;
 
@@ -104,14 +94,43 @@ typedef struct memory_pool_item_s {
   memory_pool_item_end_t                  end;
 } memory_pool_item_t;
 
+/*
+ * A chunk is one mapping of pages: its items, then the stack of the indexes of its free items.
+ */
+typedef struct memory_pool_chunk_s {
+  memory_pool_item_t                     *items;        /* NULL while the chunk is not mapped */
+  items_group_index_t                    *free_indexes;
+  uint32_t                                free_number;
+  chunk_index_t                           next_free_chunk;      /* next chunk with free items, by increasing index */
+} memory_pool_chunk_t;
+
 typedef struct memory_pool_s {
   pool_start_mark_t                       start_mark;
 
   pool_id_t                               pool_id;
   uint32_t                                item_data_number;
   uint32_t                                pool_item_size;
-  items_group_t                           items_group_free;
-  memory_pool_item_t                     *items;
+  uint32_t                                chunk_items_number;
+  size_t                                  chunk_size;
+  chunk_index_t                           chunks_initial;
+  chunk_index_t                           chunks_max;
+  int                                     release_idle;
+
+  /*
+   * Protected by mutex
+   */
+  pthread_mutex_t                         mutex;
+  memory_pool_chunk_t                    *chunks;
+  chunk_index_t                           free_chunk;   /* first chunk with free items, allocations are served from the lowest chunks */
+  uint32_t                                chunks_mapped;
+  uint32_t                                chunks_mapped_high_water;
+  uint32_t                                items_free;
+  uint32_t                                items_allocated;
+  uint32_t                                items_allocated_high_water;
+  uint64_t                                grows;
+  uint64_t                                grows_at_release;     /* grows at the previous memory_pools_release_idle () */
+  uint64_t                                releases;
+  uint64_t                                exhausted;
 } memory_pool_t;
 
 
@@ -127,6 +146,10 @@ typedef struct memory_pools_s {
 static const uint32_t                   MAX_POOLS_NUMBER = 20;
 static const uint32_t                   MAX_POOL_ITEMS_NUMBER = 200 * 1000;
 static const uint32_t                   MAX_POOL_ITEM_SIZE = 100 * 1000;
+static const uint32_t                   MAX_POOL_CHUNKS_NUMBER = UINT16_MAX + 1;
+
+/* Chunks hold at least one item and are sized for this many bytes when items are smaller */
+static const size_t                     POOL_CHUNK_SIZE = 64 * 1024;
 
 static const pool_item_start_mark_t     POOL_ITEM_START_MARK = CHARS_TO_UINT32 ('P', 'I', 's', 't');
 static const pool_item_end_mark_t       POOL_ITEM_END_MARK = CHARS_TO_UINT32 ('p', 'i', 'E', 'N');
@@ -138,122 +161,6 @@ static const pool_start_mark_t          POOL_START_MARK = CHARS_TO_UINT32 ('P',
 
 static const pools_start_mark_t         POOLS_START_MARK = CHARS_TO_UINT32 ('P', 'S', 's', 't');
 
-/*------------------------------------------------------------------------------*/
-static inline                           uint32_t
-items_group_number_items (
-  items_group_t * items_group)
-{
-  return items_group->number_plus_one - 1;
-}
-
-//------------------------------------------------------------------------------
-static inline                           uint32_t
-items_group_free_items (
-  items_group_t * items_group)
-{
-  items_group_positions_t                 positions;
-  uint32_t                                free_items;
-
-  positions.all = items_group->positions.all;
-  free_items = items_group->number_plus_one + positions.ind.put - positions.ind.get;
-  free_items %= items_group->number_plus_one;
-  return free_items;
-}
-
-//------------------------------------------------------------------------------
-static inline                           items_group_index_t
-items_group_get_free_item (
-  items_group_t * items_group)
-{
-  items_group_position_t                  get_raw;
-  items_group_position_t                  put;
-  items_group_position_t                  get;
-  items_group_position_t                  free_items;
-  items_group_index_t                     index = ITEMS_GROUP_INDEX_INVALID;
-
-  /*
-   * Get current put position
-   */
-  put = items_group->positions.ind.put % items_group->number_plus_one;
-  /*
-   * Get current get position and increase it
-   */
-  get_raw = __sync_fetch_and_add (&items_group->positions.ind.get, 1);
-  get = get_raw % items_group->number_plus_one;
-
-  if (put == get) {
-    /*
-     * No more item free, restore previous position
-     */
-    __sync_fetch_and_sub (&items_group->positions.ind.get, 1);
-  } else {
-    /*
-     * Get index at current get position
-     */
-    index = items_group->indexes[get];
-
-    if (index <= ITEMS_GROUP_INDEX_INVALID) {
-      /*
-       * Index has not yet been completely freed, restore previous get position
-       */
-      __sync_fetch_and_sub (&items_group->positions.ind.get, 1);
-    } else {
-      if (get_raw == items_group->number_plus_one) {
-        /*
-         * Wrap get position
-         */
-        __sync_fetch_and_sub (&items_group->positions.ind.get, items_group->number_plus_one);
-      }
-
-      free_items = items_group_free_items (items_group);
-
-      /*
-       * Updates minimum free items if needed
-       */
-      while (items_group->minimum > free_items) {
-        items_group->minimum = free_items;
-      }
-
-      /*
-       * Clear index at current get position to indicate that item is free
-       */
-      items_group->indexes[get] = ITEMS_GROUP_INDEX_INVALID;
-    }
-  }
-
-  return (index);
-}
-
-//------------------------------------------------------------------------------
-static inline int
-items_group_put_free_item (
-  items_group_t * items_group,
-  items_group_index_t index)
-{
-  items_group_position_t                  put_raw;
-  items_group_position_t                  put;
-
-  /*
-   * Get current put position and increase it
-   */
-  put_raw = __sync_fetch_and_add (&items_group->positions.ind.put, 1);
-  put = put_raw % items_group->number_plus_one;
-
-  if (put_raw == items_group->number_plus_one) {
-    /*
-     * Wrap position
-     */
-    __sync_fetch_and_sub (&items_group->positions.ind.put, items_group->number_plus_one);
-  }
-
-  AssertError (items_group->indexes[put] <= ITEMS_GROUP_INDEX_INVALID, return (EXIT_FAILURE), "Index at current put position (%d) is not marked as free (%d)!\n", put, items_group->number_plus_one);
-  /*
-   * Save freed item index at current put position
-   */
-  items_group->indexes[put] = index;
-  return (EXIT_SUCCESS);
-}
-
 //------------------------------------------------------------------------------
 static inline memory_pools_t           *
 memory_pools_from_handler (
@@ -297,15 +204,209 @@ memory_pool_item_from_handler (
 static inline memory_pool_item_t       *
 memory_pool_item_from_index (
   memory_pool_t * memory_pool,
+  chunk_index_t chunk,
   items_group_index_t index)
 {
   void                                   *address;
 
-  address = (void *)memory_pool->items;
+  address = (void *)memory_pool->chunks[chunk].items;
   address += index * memory_pool->pool_item_size;
   return (address);
 }
 
+//------------------------------------------------------------------------------
+static inline                           items_group_index_t
+memory_pool_item_index (
+  memory_pool_t * memory_pool,
+  memory_pool_item_t * memory_pool_item)
+{
+  return (((void *)memory_pool_item) - ((void *)memory_pool->chunks[memory_pool_item->start.chunk].items)) / memory_pool->pool_item_size;
+}
+
+//------------------------------------------------------------------------------
+// Inserts a chunk that got free items in the list of chunks with free items, mutex locked
+static void
+memory_pool_link_free_chunk (
+  memory_pool_t * memory_pool,
+  chunk_index_t chunk)
+{
+  chunk_index_t                          *link = &memory_pool->free_chunk;
+
+  while ((*link != CHUNK_INDEX_INVALID) && (*link < chunk)) {
+    link = &memory_pool->chunks[*link].next_free_chunk;
+  }
+
+  memory_pool->chunks[chunk].next_free_chunk = *link;
+  *link = chunk;
+}
+
+//------------------------------------------------------------------------------
+// Removes a chunk from the list of chunks with free items, mutex locked
+static void
+memory_pool_unlink_free_chunk (
+  memory_pool_t * memory_pool,
+  chunk_index_t chunk)
+{
+  chunk_index_t                          *link = &memory_pool->free_chunk;
+
+  while (*link != chunk) {
+    AssertFatal (*link != CHUNK_INDEX_INVALID, "Chunk %d of pool %u is not in the free chunks list!\n", chunk, memory_pool->pool_id);
+    link = &memory_pool->chunks[*link].next_free_chunk;
+  }
+
+  *link = memory_pool->chunks[chunk].next_free_chunk;
+  memory_pool->chunks[chunk].next_free_chunk = CHUNK_INDEX_INVALID;
+}
+
+//------------------------------------------------------------------------------
+// Maps the first chunk not mapped, mutex locked, returns its index or CHUNK_INDEX_INVALID
+static chunk_index_t
+memory_pool_map_chunk (
+  memory_pool_t * memory_pool)
+{
+  memory_pool_chunk_t                    *memory_pool_chunk;
+  memory_pool_item_t                     *memory_pool_item;
+  chunk_index_t                           chunk;
+  items_group_index_t                     item_index;
+  void                                   *address;
+
+  for (chunk = 0; chunk < memory_pool->chunks_max; chunk++) {
+    if (memory_pool->chunks[chunk].items == NULL) {
+      break;
+    }
+  }
+
+  if (chunk == memory_pool->chunks_max) {
+    return (CHUNK_INDEX_INVALID);
+  }
+
+  address = mmap (NULL, memory_pool->chunk_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (address == MAP_FAILED) {
+    return (CHUNK_INDEX_INVALID);
+  }
+
+  memory_pool_chunk = &memory_pool->chunks[chunk];
+  memory_pool_chunk->items = address;
+  memory_pool_chunk->free_indexes = address + (memory_pool->chunk_items_number * memory_pool->pool_item_size);
+
+  /*
+   * Initialize items, the first items of the chunk are allocated first
+   */
+  for (item_index = 0; item_index < memory_pool->chunk_items_number; item_index++) {
+    memory_pool_item = memory_pool_item_from_index (memory_pool, chunk, item_index);
+    memory_pool_item->start.start_mark = POOL_ITEM_START_MARK;
+    memory_pool_item->start.pool_id = memory_pool->pool_id;
+    memory_pool_item->start.item_status = ITEM_STATUS_FREE;
+    memory_pool_item->start.chunk = chunk;
+    memory_pool_item->data[memory_pool->item_data_number] = POOL_ITEM_END_MARK;
+    memory_pool_chunk->free_indexes[item_index] = memory_pool->chunk_items_number - 1 - item_index;
+  }
+
+  memory_pool_chunk->free_number = memory_pool->chunk_items_number;
+  memory_pool_link_free_chunk (memory_pool, chunk);
+  memory_pool->items_free += memory_pool->chunk_items_number;
+  memory_pool->chunks_mapped++;
+
+  if (memory_pool->chunks_mapped > memory_pool->chunks_mapped_high_water) {
+    memory_pool->chunks_mapped_high_water = memory_pool->chunks_mapped;
+  }
+
+  return (chunk);
+}
+
+//------------------------------------------------------------------------------
+// Gives back a chunk whose items are all free, mutex locked
+static void
+memory_pool_unmap_chunk (
+  memory_pool_t * memory_pool,
+  chunk_index_t chunk)
+{
+  memory_pool_chunk_t                    *memory_pool_chunk = &memory_pool->chunks[chunk];
+
+  memory_pool_unlink_free_chunk (memory_pool, chunk);
+  AssertFatal (munmap (memory_pool_chunk->items, memory_pool->chunk_size) == 0, "Unmapping of chunk %d of pool %u failed!\n", chunk, memory_pool->pool_id);
+  memory_pool_chunk->items = NULL;
+  memory_pool_chunk->free_indexes = NULL;
+  memory_pool_chunk->free_number = 0;
+  memory_pool->items_free -= memory_pool->chunk_items_number;
+  memory_pool->chunks_mapped--;
+  memory_pool->releases++;
+}
+
+//------------------------------------------------------------------------------
+static memory_pool_item_t              *
+memory_pool_get_free_item (
+  memory_pool_t * memory_pool)
+{
+  memory_pool_chunk_t                    *memory_pool_chunk;
+  memory_pool_item_t                     *memory_pool_item = NULL;
+  chunk_index_t                           chunk;
+  items_group_index_t                     item_index;
+
+  pthread_mutex_lock (&memory_pool->mutex);
+  chunk = memory_pool->free_chunk;
+
+  if (chunk == CHUNK_INDEX_INVALID) {
+    /*
+     * Pool ran dry, grow it by one chunk
+     */
+    chunk = memory_pool_map_chunk (memory_pool);
+
+    if (chunk == CHUNK_INDEX_INVALID) {
+      memory_pool->exhausted++;
+      pthread_mutex_unlock (&memory_pool->mutex);
+      return (NULL);
+    }
+
+    memory_pool->grows++;
+  }
+
+  memory_pool_chunk = &memory_pool->chunks[chunk];
+  item_index = memory_pool_chunk->free_indexes[--memory_pool_chunk->free_number];
+
+  if (memory_pool_chunk->free_number == 0) {
+    /*
+     * Chunk is the head of the free chunks list
+     */
+    memory_pool->free_chunk = memory_pool_chunk->next_free_chunk;
+    memory_pool_chunk->next_free_chunk = CHUNK_INDEX_INVALID;
+  }
+
+  memory_pool->items_free--;
+  memory_pool->items_allocated++;
+
+  if (memory_pool->items_allocated > memory_pool->items_allocated_high_water) {
+    memory_pool->items_allocated_high_water = memory_pool->items_allocated;
+  }
+
+  memory_pool_item = memory_pool_item_from_index (memory_pool, chunk, item_index);
+  pthread_mutex_unlock (&memory_pool->mutex);
+  return (memory_pool_item);
+}
+
+//------------------------------------------------------------------------------
+static void
+memory_pool_put_free_item (
+  memory_pool_t * memory_pool,
+  memory_pool_item_t * memory_pool_item,
+  items_group_index_t item_index)
+{
+  chunk_index_t                           chunk = memory_pool_item->start.chunk;
+  memory_pool_chunk_t                    *memory_pool_chunk = &memory_pool->chunks[chunk];
+
+  pthread_mutex_lock (&memory_pool->mutex);
+  memory_pool_chunk->free_indexes[memory_pool_chunk->free_number++] = item_index;
+
+  if (memory_pool_chunk->free_number == 1) {
+    memory_pool_link_free_chunk (memory_pool, chunk);
+  }
+
+  memory_pool->items_free++;
+  memory_pool->items_allocated--;
+  pthread_mutex_unlock (&memory_pool->mutex);
+}
+
 //------------------------------------------------------------------------------
 memory_pools_handle_t memory_pools_create (uint32_t pools_number)
 {
@@ -350,48 +451,142 @@ memory_pools_statistics (
   pool_id_t                               pool;
   char                                   *statistics;
   int                                     printed_chars;
-  uint32_t                                allocated_pool_memory;
-  uint32_t                                allocated_pools_memory = 0;
-  items_group_t                          *items_group;
-  uint32_t                                pool_items_size;
+  size_t                                  mapped_pools_memory = 0;
+  memory_pool_stats_t                     stats;
 
   /*
    * Recover memory_pools
    */
   memory_pools = memory_pools_from_handler (memory_pools_handle);
   AssertFatal (memory_pools != NULL, "Failed to retrieve memory pool for handle %p!\n", memory_pools_handle);
-  statistics = malloc (memory_pools->pools_defined * 200);
-  printed_chars = sprintf (&statistics[0], "Pool:   size, number, minimum,   free, address space and memory used in Kbytes\n");
+  statistics = malloc ((memory_pools->pools_defined + 2) * 200);
+  printed_chars = sprintf (&statistics[0], "Pool:   size, maximum, allocated, high water,   free, chunks, chunks high water, grows, releases, exhausted, memory used in Kbytes\n");
 
   for (pool = 0; pool < memory_pools->pools_defined; pool++) {
-    items_group = &memory_pools->pools[pool].items_group_free;
-    allocated_pool_memory = items_group_number_items (items_group) * memory_pools->pools[pool].pool_item_size;
-    allocated_pools_memory += allocated_pool_memory;
-    pool_items_size = memory_pools->pools[pool].item_data_number * sizeof (memory_pool_data_t);
-    printed_chars += sprintf (&statistics[printed_chars], "  %2u: %6u, %6u,  %6u, %6u, [%p-%p] %6u\n",
-                              pool, pool_items_size,
-                              items_group_number_items (items_group),
-                              items_group->minimum, items_group_free_items (items_group), memory_pools->pools[pool].items, ((void *)memory_pools->pools[pool].items) + allocated_pool_memory, allocated_pool_memory / (1024));
+    memory_pools_get_stats (memory_pools_handle, pool, &stats);
+    mapped_pools_memory += stats.chunks_mapped * stats.chunk_size;
+    printed_chars += sprintf (&statistics[printed_chars], "  %2u: %6u,  %6u,    %6u,     %6u, %6u, %6u,            %6u, %5" PRIu64 ",    %5" PRIu64 ",     %5" PRIu64 ", %6zu\n",
+                              pool, stats.item_size, stats.items_max, stats.items_allocated, stats.items_allocated_high_water,
+                              stats.items_mapped - stats.items_allocated, stats.chunks_mapped, stats.chunks_mapped_high_water,
+                              stats.grows, stats.releases, stats.exhausted, (stats.chunks_mapped * stats.chunk_size) / 1024);
   }
 
-  printed_chars = sprintf (&statistics[printed_chars], "Pools memory %u Kbytes\n", allocated_pools_memory / (1024));
+  printed_chars += sprintf (&statistics[printed_chars], "Pools memory %zu Kbytes\n", mapped_pools_memory / (1024));
   return (statistics);
 }
 
+//------------------------------------------------------------------------------
+int
+memory_pools_get_stats (
+  memory_pools_handle_t memory_pools_handle,
+  uint32_t pool,
+  memory_pool_stats_t * stats)
+{
+  memory_pools_t                         *memory_pools;
+  memory_pool_t                          *memory_pool;
+
+  memory_pools = memory_pools_from_handler (memory_pools_handle);
+  AssertError (memory_pools != NULL, return (EXIT_FAILURE), "Failed to retrieve memory pools for handle %p!\n", memory_pools_handle);
+
+  if (pool >= memory_pools->pools_defined) {
+    return (EXIT_FAILURE);
+  }
+
+  memory_pool = &memory_pools->pools[pool];
+  pthread_mutex_lock (&memory_pool->mutex);
+  stats->item_size = memory_pool->item_data_number * sizeof (memory_pool_data_t);
+  stats->items_max = memory_pool->chunks_max * memory_pool->chunk_items_number;
+  stats->items_mapped = memory_pool->chunks_mapped * memory_pool->chunk_items_number;
+  stats->items_allocated = memory_pool->items_allocated;
+  stats->items_allocated_high_water = memory_pool->items_allocated_high_water;
+  stats->chunks_mapped = memory_pool->chunks_mapped;
+  stats->chunks_mapped_high_water = memory_pool->chunks_mapped_high_water;
+  stats->chunk_size = memory_pool->chunk_size;
+  stats->grows = memory_pool->grows;
+  stats->releases = memory_pool->releases;
+  stats->exhausted = memory_pool->exhausted;
+  pthread_mutex_unlock (&memory_pool->mutex);
+  return (EXIT_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+uint32_t
+memory_pools_release_idle (
+  memory_pools_handle_t memory_pools_handle)
+{
+  memory_pools_t                         *memory_pools;
+  memory_pool_t                          *memory_pool;
+  pool_id_t                               pool;
+  chunk_index_t                           chunk;
+  uint32_t                                released = 0;
+
+  memory_pools = memory_pools_from_handler (memory_pools_handle);
+  AssertError (memory_pools != NULL, return (0), "Failed to retrieve memory pools for handle %p!\n", memory_pools_handle);
+
+  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+    memory_pool = &memory_pools->pools[pool];
+
+    if (!memory_pool->release_idle) {
+      continue;
+    }
+
+    pthread_mutex_lock (&memory_pool->mutex);
+
+    /*
+     * A pool that had to grow since the previous call is not idle, its chunks are kept for one more period
+     */
+    if (memory_pool->grows == memory_pool->grows_at_release) {
+      for (chunk = memory_pool->chunks_max - 1; chunk >= memory_pool->chunks_initial; chunk--) {
+        if (memory_pool->items_free < (2 * memory_pool->chunk_items_number)) {
+          /*
+           * Keep a chunk of free items
+           */
+          break;
+        }
+
+        if ((memory_pool->chunks[chunk].items != NULL) && (memory_pool->chunks[chunk].free_number == memory_pool->chunk_items_number)) {
+          memory_pool_unmap_chunk (memory_pool, chunk);
+          released++;
+        }
+      }
+    }
+
+    memory_pool->grows_at_release = memory_pool->grows;
+    pthread_mutex_unlock (&memory_pool->mutex);
+  }
+
+  return (released);
+}
+
 //------------------------------------------------------------------------------
 int
 memory_pools_add_pool (
   memory_pools_handle_t memory_pools_handle,
   uint32_t pool_items_number,
   uint32_t pool_item_size)
+{
+  return memory_pools_add_elastic_pool (memory_pools_handle, pool_items_number, pool_items_number, pool_item_size, 0);
+}
+
+//------------------------------------------------------------------------------
+int
+memory_pools_add_elastic_pool (
+  memory_pools_handle_t memory_pools_handle,
+  uint32_t pool_items_initial,
+  uint32_t pool_items_max,
+  uint32_t pool_item_size,
+  int release_idle)
 {
   memory_pools_t                         *memory_pools;
   memory_pool_t                          *memory_pool;
   pool_id_t                               pool;
-  items_group_index_t                     item_index;
-  memory_pool_item_t                     *memory_pool_item;
+  pthread_mutexattr_t                     mutex_attr;
+  size_t                                  page_size = sysconf (_SC_PAGESIZE);
+  size_t                                  chunk_item_size;
+  chunk_index_t                           chunk;
 
-  AssertFatal (pool_items_number <= MAX_POOL_ITEMS_NUMBER, "Too many items for a memory pool (%u/%d)!\n", pool_items_number, MAX_POOL_ITEMS_NUMBER);    /* Limit to a reasonable number of items */
+  AssertFatal (pool_items_max <= MAX_POOL_ITEMS_NUMBER, "Too many items for a memory pool (%u/%d)!\n", pool_items_max, MAX_POOL_ITEMS_NUMBER);  /* Limit to a reasonable number of items */
+  AssertFatal (pool_items_initial <= pool_items_max, "More initial items than maximum items for a memory pool (%u/%u)!\n", pool_items_initial, pool_items_max);
   AssertFatal (pool_item_size <= MAX_POOL_ITEM_SIZE, "Item size is too big for memory pool items (%u/%d)!\n", pool_item_size, MAX_POOL_ITEM_SIZE);      /* Limit to a reasonable item size */
   /*
    * Recover memory_pools
@@ -417,42 +612,37 @@ memory_pools_add_pool (
      */
     memory_pool->item_data_number = (pool_item_size + sizeof (memory_pool_data_t) - 1) / sizeof (memory_pool_data_t);
     memory_pool->pool_item_size = (memory_pool->item_data_number * sizeof (memory_pool_data_t)) + sizeof (memory_pool_item_t);
-    memory_pool->items_group_free.number_plus_one = pool_items_number + 1;
-    memory_pool->items_group_free.minimum = pool_items_number;
-    memory_pool->items_group_free.positions.ind.put = pool_items_number;
-    memory_pool->items_group_free.positions.ind.get = 0;
     /*
-     * Allocate free indexes
+     * Chunk size in pages by excess, then as many items as the pages can hold
      */
-    memory_pool->items_group_free.indexes = malloc (memory_pool->items_group_free.number_plus_one * sizeof (items_group_index_t));
-    AssertFatal (memory_pool->items_group_free.indexes != NULL, "Memory pool indexes allocation failed!\n");
-
+    chunk_item_size = memory_pool->pool_item_size + sizeof (items_group_index_t);
+    memory_pool->chunk_items_number = (POOL_CHUNK_SIZE > chunk_item_size) ? POOL_CHUNK_SIZE / chunk_item_size : 1;
+    memory_pool->chunk_size = ((memory_pool->chunk_items_number * chunk_item_size) + page_size - 1) & ~(page_size - 1);
+    memory_pool->chunk_items_number = memory_pool->chunk_size / chunk_item_size;
+    memory_pool->chunks_max = (pool_items_max + memory_pool->chunk_items_number - 1) / memory_pool->chunk_items_number;
+    memory_pool->chunks_initial = (pool_items_initial + memory_pool->chunk_items_number - 1) / memory_pool->chunk_items_number;
+    memory_pool->release_idle = release_idle;
+    AssertFatal (memory_pool->chunks_max <= MAX_POOL_CHUNKS_NUMBER, "Too many chunks for a memory pool (%d/%u)!\n", memory_pool->chunks_max, MAX_POOL_CHUNKS_NUMBER);
     /*
-     * Initialize free indexes
+     * Mutex spins a little before sleeping, it is only held to update the free items
      */
-    for (item_index = 0; item_index < pool_items_number; item_index++) {
-      memory_pool->items_group_free.indexes[item_index] = item_index;
-    }
-
+    pthread_mutexattr_init (&mutex_attr);
+    pthread_mutexattr_settype (&mutex_attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+    pthread_mutex_init (&memory_pool->mutex, &mutex_attr);
+    pthread_mutexattr_destroy (&mutex_attr);
     /*
-     * Last index is not allocated
+     * Allocate chunks descriptors, the chunks are mapped later
      */
-    memory_pool->items_group_free.indexes[item_index] = ITEMS_GROUP_INDEX_INVALID;
-    /*
-     * Allocate items
-     */
-    memory_pool->items = calloc (pool_items_number, memory_pool->pool_item_size);
-    AssertFatal (memory_pool->items != NULL, "Memory pool items allocation failed!\n");
+    memory_pool->chunks = calloc (memory_pool->chunks_max, sizeof (memory_pool_chunk_t));
+    AssertFatal ((memory_pool->chunks != NULL) || (memory_pool->chunks_max == 0), "Memory pool chunks allocation failed!\n");
+    memory_pool->free_chunk = CHUNK_INDEX_INVALID;
 
-    /*
-     * Initialize items
-     */
-    for (item_index = 0; item_index < pool_items_number; item_index++) {
-      memory_pool_item = memory_pool_item_from_index (memory_pool, item_index);
-      memory_pool_item->start.start_mark = POOL_ITEM_START_MARK;
-      memory_pool_item->start.pool_id = pool;
-      memory_pool_item->start.item_status = ITEM_STATUS_FREE;
-      memory_pool_item->data[memory_pool->item_data_number] = POOL_ITEM_END_MARK;
+    for (chunk = 0; chunk < memory_pool->chunks_max; chunk++) {
+      memory_pool->chunks[chunk].next_free_chunk = CHUNK_INDEX_INVALID;
+    }
+
+    for (chunk = 0; chunk < memory_pool->chunks_initial; chunk++) {
+      AssertFatal (memory_pool_map_chunk (memory_pool) == chunk, "Memory pool items allocation failed!\n");
     }
   }
   memory_pools->pools_defined++;
@@ -468,10 +658,9 @@ memory_pools_allocate (
   uint16_t info_1)
 {
   memory_pools_t                         *memory_pools;
-  memory_pool_item_t                     *memory_pool_item;
+  memory_pool_item_t                     *memory_pool_item = NULL;
   memory_pool_item_handle_t               memory_pool_item_handle = NULL;
   pool_id_t                               pool;
-  items_group_index_t                     item_index = ITEMS_GROUP_INDEX_INVALID;
 
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_MP_ALLOC, __sync_or_and_fetch (&vcd_mp_alloc, 1L << info_0));
   /*
@@ -490,9 +679,9 @@ memory_pools_allocate (
       continue;
     }
 
-    item_index = items_group_get_free_item (&memory_pools->pools[pool].items_group_free);
+    memory_pool_item = memory_pool_get_free_item (&memory_pools->pools[pool]);
 
-    if (item_index <= ITEMS_GROUP_INDEX_INVALID) {
+    if (memory_pool_item == NULL) {
       /*
        * Allocation failed, skip this pool
        */
@@ -505,23 +694,21 @@ memory_pools_allocate (
     }
   }
 
-  if (item_index > ITEMS_GROUP_INDEX_INVALID) {
-    /*
-     * Convert item index into memory_pool_item address
-     */
-    memory_pool_item = memory_pool_item_from_index (&memory_pools->pools[pool], item_index);
+  if (memory_pool_item != NULL) {
     /*
      * Sanity check on item status, must be free
      */
-    AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_FREE, "Item status is not set to free (%d) in pool %u, item %d!\n", memory_pool_item->start.item_status, pool, item_index);
+    AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_FREE, "Item status is not set to free (%d) in pool %u, item %d!\n",
+                 memory_pool_item->start.item_status, pool, memory_pool_item_index (&memory_pools->pools[pool], memory_pool_item));
     memory_pool_item->start.item_status = ITEM_STATUS_ALLOCATED;
     memory_pool_item->start.info[0] = info_0;
     memory_pool_item->start.info[1] = info_1;
     memory_pool_item_handle = memory_pool_item->data;
-    MP_DEBUG (" Alloc [%2u][%6d]{%6d}, %3u %3u, %6u, %p, %p, %p\n",
-              pool, item_index, items_group_free_items (&memory_pools->pools[pool].items_group_free), info_0, info_1, item_size, memory_pools->pools[pool].items, memory_pool_item, memory_pool_item_handle);
+    MP_DEBUG (" Alloc [%2u][%5u][%6d]{%6d}, %3u %3u, %6u, %p, %p\n",
+              pool, memory_pool_item->start.chunk, memory_pool_item_index (&memory_pools->pools[pool], memory_pool_item), memory_pools->pools[pool].items_free,
+              info_0, info_1, item_size, memory_pool_item, memory_pool_item_handle);
   } else {
-    MP_DEBUG (" Alloc [--][------]{------}, %3u %3u, %6u, failed!\n", info_0, info_1, item_size);
+    MP_DEBUG (" Alloc [--][-----][------]{------}, %3u %3u, %6u, failed!\n", info_0, info_1, item_size);
   }
 
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_MP_ALLOC, __sync_and_and_fetch (&vcd_mp_alloc, ~(1L << info_0)));
@@ -536,13 +723,13 @@ memory_pools_free (
   uint16_t info_0)
 {
   memory_pools_t                         *memory_pools;
+  memory_pool_t                          *memory_pool;
   memory_pool_item_t                     *memory_pool_item;
   pool_id_t                               pool;
+  chunk_index_t                           chunk;
   items_group_index_t                     item_index;
   uint32_t                                item_size;
-  uint32_t                                pool_item_size;
   uint16_t                                info_1;
-  int                                     result;
 
   /*
    * Recover memory_pools
@@ -557,37 +744,35 @@ memory_pools_free (
   info_1 = memory_pool_item->start.info[1];
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_MP_FREE, __sync_or_and_fetch (&vcd_mp_free, 1L << info_1));
   /*
-   * Recover pool index
+   * Recover pool and chunk indexes
    */
   pool = memory_pool_item->start.pool_id;
   AssertFatal (pool < memory_pools->pools_defined, "Pool index is invalid (%u/%u)!\n", pool, memory_pools->pools_defined);
-  item_size = memory_pools->pools[pool].item_data_number;
-  pool_item_size = memory_pools->pools[pool].pool_item_size;
-  item_index = (((void *)memory_pool_item) - ((void *)memory_pools->pools[pool].items)) / pool_item_size;
-  MP_DEBUG (" Free  [%2u][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
-            pool, item_index,
-            items_group_free_items (&memory_pools->pools[pool].items_group_free),
-            memory_pool_item->start.info[0], info_1, memory_pool_item_handle, memory_pool_item, memory_pools->pools[pool].items, ((uint32_t) (item_size * sizeof (memory_pool_data_t))));
+  memory_pool = &memory_pools->pools[pool];
+  chunk = memory_pool_item->start.chunk;
+  AssertFatal ((chunk < memory_pool->chunks_max) && (memory_pool->chunks[chunk].items != NULL), "Chunk index is invalid (%d/%d) in pool %u!\n", chunk, memory_pool->chunks_max, pool);
+  item_size = memory_pool->item_data_number;
+  item_index = memory_pool_item_index (memory_pool, memory_pool_item);
+  MP_DEBUG (" Free  [%2u][%5d][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
+            pool, chunk, item_index, memory_pool->items_free,
+            memory_pool_item->start.info[0], info_1, memory_pool_item_handle, memory_pool_item, memory_pool->chunks[chunk].items, ((uint32_t) (item_size * sizeof (memory_pool_data_t))));
   /*
    * Sanity check on calculated item index
    */
-  AssertFatal (memory_pool_item == memory_pool_item_from_index (&memory_pools->pools[pool], item_index),
-               "Incorrect memory pool item address (%p, %p) for pool %u, item %d!\n", memory_pool_item, memory_pool_item_from_index (&memory_pools->pools[pool], item_index), pool, item_index);
+  AssertFatal ((item_index < memory_pool->chunk_items_number) && (memory_pool_item == memory_pool_item_from_index (memory_pool, chunk, item_index)),
+               "Incorrect memory pool item address (%p, %p) for pool %u, chunk %d, item %d!\n", memory_pool_item, memory_pool_item_from_index (memory_pool, chunk, item_index), pool, chunk, item_index);
   /*
    * Sanity check on end marker, must still be present (no write overflow)
    */
-  AssertFatal (memory_pool_item->data[item_size] == POOL_ITEM_END_MARK, "Memory pool item is corrupted, end mark is not present for pool %u, item %d!\n", pool, item_index);
+  AssertFatal (memory_pool_item->data[item_size] == POOL_ITEM_END_MARK, "Memory pool item is corrupted, end mark is not present for pool %u, chunk %d, item %d!\n", pool, chunk, item_index);
   /*
    * Sanity check on item status, must be allocated
    */
-  AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED, "Trying to free a non allocated (%x) memory pool item (pool %u, item %d)!\n", memory_pool_item->start.item_status, pool, item_index);
+  AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED, "Trying to free a non allocated (%x) memory pool item (pool %u, chunk %d, item %d)!\n", memory_pool_item->start.item_status, pool, chunk, item_index);
   memory_pool_item->start.item_status = ITEM_STATUS_FREE;
-  result = items_group_put_free_item (&memory_pools->pools[pool].items_group_free, item_index);
-  AssertError (result == EXIT_SUCCESS, {
-               }
-               , "Failed to free memory pool item (pool %u, item %d)!\n", pool, item_index);
+  memory_pool_put_free_item (memory_pool, memory_pool_item, item_index);
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME (VCD_SIGNAL_DUMPER_VARIABLE_MP_FREE, __sync_and_and_fetch (&vcd_mp_free, ~(1L << info_1)));
-  return (result);
+  return (EXIT_SUCCESS);
 }
 
 //------------------------------------------------------------------------------
@@ -599,11 +784,12 @@ memory_pools_set_info (
   uint16_t info)
 {
   memory_pools_t                         *memory_pools;
+  memory_pool_t                          *memory_pool;
   memory_pool_item_t                     *memory_pool_item;
   pool_id_t                               pool;
+  chunk_index_t                           chunk;
   items_group_index_t                     item_index;
   uint32_t                                item_size;
-  uint32_t                                pool_item_size;
 
   AssertFatal (index < MEMORY_POOL_ITEM_INFO_NUMBER, "Incorrect info index (%d/%d)!\n", index, MEMORY_POOL_ITEM_INFO_NUMBER);
   /*
@@ -626,29 +812,30 @@ memory_pools_set_info (
     memory_pools = memory_pools_from_handler (memory_pools_handle);
     AssertFatal (memory_pools != NULL, "Failed to retrieve memory pool for handle %p!\n", memory_pools_handle);
     /*
-     * Recover pool index
+     * Recover pool and chunk indexes
      */
     pool = memory_pool_item->start.pool_id;
     AssertFatal (pool < memory_pools->pools_defined, "Pool index is invalid (%u/%u)!\n", pool, memory_pools->pools_defined);
-    item_size = memory_pools->pools[pool].item_data_number;
-    pool_item_size = memory_pools->pools[pool].pool_item_size;
-    item_index = (((void *)memory_pool_item) - ((void *)memory_pools->pools[pool].items)) / pool_item_size;
-    MP_DEBUG (" Info  [%2u][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
-              pool, item_index,
-              items_group_free_items (&memory_pools->pools[pool].items_group_free),
-              memory_pool_item->start.info[0], memory_pool_item->start.info[1], memory_pool_item_handle, memory_pool_item, memory_pools->pools[pool].items, ((uint32_t) (item_size * sizeof (memory_pool_data_t))));
+    memory_pool = &memory_pools->pools[pool];
+    chunk = memory_pool_item->start.chunk;
+    AssertFatal ((chunk < memory_pool->chunks_max) && (memory_pool->chunks[chunk].items != NULL), "Chunk index is invalid (%d/%d) in pool %u!\n", chunk, memory_pool->chunks_max, pool);
+    item_size = memory_pool->item_data_number;
+    item_index = memory_pool_item_index (memory_pool, memory_pool_item);
+    MP_DEBUG (" Info  [%2u][%5d][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
+              pool, chunk, item_index, memory_pool->items_free,
+              memory_pool_item->start.info[0], memory_pool_item->start.info[1], memory_pool_item_handle, memory_pool_item, memory_pool->chunks[chunk].items, ((uint32_t) (item_size * sizeof (memory_pool_data_t))));
     /*
      * Sanity check on calculated item index
      */
-    AssertFatal (memory_pool_item == memory_pool_item_from_index (&memory_pools->pools[pool], item_index),
-                 "Incorrect memory pool item address (%p, %p) for pool %u, item %d!\n", memory_pool_item, memory_pool_item_from_index (&memory_pools->pools[pool], item_index), pool, item_index);
+    AssertFatal ((item_index < memory_pool->chunk_items_number) && (memory_pool_item == memory_pool_item_from_index (memory_pool, chunk, item_index)),
+                 "Incorrect memory pool item address (%p, %p) for pool %u, chunk %d, item %d!\n", memory_pool_item, memory_pool_item_from_index (memory_pool, chunk, item_index), pool, chunk, item_index);
     /*
      * Sanity check on end marker, must still be present (no write overflow)
      */
-    AssertFatal (memory_pool_item->data[item_size] == POOL_ITEM_END_MARK, "Memory pool item is corrupted, end mark is not present for pool %u, item %d!\n", pool, item_index);
+    AssertFatal (memory_pool_item->data[item_size] == POOL_ITEM_END_MARK, "Memory pool item is corrupted, end mark is not present for pool %u, chunk %d, item %d!\n", pool, chunk, item_index);
     /*
      * Sanity check on item status, must be allocated
      */
-    AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED, "Trying to free a non allocated (%x) memory pool item (pool %u, item %d)\n", memory_pool_item->start.item_status, pool, item_index);
+    AssertFatal (memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED, "Trying to free a non allocated (%x) memory pool item (pool %u, chunk %d, item %d)\n", memory_pool_item->start.item_status, pool, chunk, item_index);
   }
 }
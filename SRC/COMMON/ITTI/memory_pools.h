@@ -31,16 +31,45 @@
 #define MEMORY_POOLS_H_
 
 #include <stdint.h>
+#include <stddef.h>
 
 typedef void * memory_pools_handle_t;
 typedef void * memory_pool_item_handle_t;
 
+/* Usage of a pool, the high water marks are never decreased */
+typedef struct memory_pool_stats_s {
+  uint32_t item_size;                   /* usable bytes of an item */
+  uint32_t items_max;                   /* items of the pool when all its chunks are mapped */
+  uint32_t items_mapped;                /* items of the mapped chunks */
+  uint32_t items_allocated;
+  uint32_t items_allocated_high_water;
+  uint32_t chunks_mapped;
+  uint32_t chunks_mapped_high_water;
+  size_t   chunk_size;                  /* bytes of a chunk, multiple of the page size */
+  uint64_t grows;                       /* chunks mapped on demand, after the creation of the pool */
+  uint64_t releases;                    /* idle chunks given back to the system */
+  uint64_t exhausted;                   /* allocations that found the pool at its maximum */
+} memory_pool_stats_t;
+
 memory_pools_handle_t memory_pools_create (uint32_t pools_number);
 
 char *memory_pools_statistics(memory_pools_handle_t memory_pools_handle);
 
+/* Pool with all its items mapped at creation */
 int memory_pools_add_pool (memory_pools_handle_t memory_pools_handle, uint32_t pool_items_number, uint32_t pool_item_size);
 
+/* Pool mapped by chunks of pages: pool_items_initial items at creation, one more chunk each time the pool runs dry,
+ * up to pool_items_max items. Items are allocated from the lowest chunks first. With release_idle, the pool is trimmed by
+ * memory_pools_release_idle (). */
+int memory_pools_add_elastic_pool (memory_pools_handle_t memory_pools_handle, uint32_t pool_items_initial, uint32_t pool_items_max,
+                                   uint32_t pool_item_size, int release_idle);
+
+/* To be called periodically: unmaps the chunks above the initial ones whose items are all free, in the pools with release_idle
+ * that did not grow since the previous call, keeping a chunk of free items. Returns the number of chunks unmapped. */
+uint32_t memory_pools_release_idle (memory_pools_handle_t memory_pools_handle);
+
+int memory_pools_get_stats (memory_pools_handle_t memory_pools_handle, uint32_t pool, memory_pool_stats_t *stats);
+
 memory_pool_item_handle_t memory_pools_allocate (memory_pools_handle_t memory_pools_handle, uint32_t item_size, uint16_t info_0, uint16_t info_1);
 
 int memory_pools_free (memory_pools_handle_t memory_pools_handle, memory_pool_item_handle_t memory_pool_item_handle, uint16_t info_0);
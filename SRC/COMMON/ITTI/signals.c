@@ -75,6 +75,7 @@ signal_mask (
   sigemptyset (&set);
   sigaddset (&set, SIGTIMER);
   sigaddset (&set, SIGUSR1);
+  sigaddset (&set, SIGUSR2);
   sigaddset (&set, SIGABRT);
   sigaddset (&set, SIGSEGV);
   sigaddset (&set, SIGINT);
@@ -97,6 +98,7 @@ signal_handle (
   sigemptyset (&set);
   sigaddset (&set, SIGTIMER);
   sigaddset (&set, SIGUSR1);
+  sigaddset (&set, SIGUSR2);
   sigaddset (&set, SIGABRT);
   sigaddset (&set, SIGSEGV);
   sigaddset (&set, SIGINT);
@@ -133,6 +135,11 @@ signal_handle (
       *end = 1;
       break;
 
+    case SIGUSR2:
+      SIG_DEBUG ("Received SIGUSR2\n");
+      itti_send_statistics_message (TASK_UNKNOWN);
+      break;
+
     case SIGSEGV:              /* Fall through */
     case SIGABRT:
       SIG_DEBUG ("Received SIGABORT\n");
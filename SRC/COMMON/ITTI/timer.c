@@ -43,6 +43,7 @@
 #include "log.h"
 #include "queue.h"
 #include "dynamic_memory_check.h"
+#include "probes.h"
 
 
 int                                     timer_handle_signal (
@@ -94,6 +95,7 @@ timer_handle_signal (
   // TMR_DEBUG("Timer with id 0x%lx has expired", (long)timer_p->timer);
   task_id = timer_p->task_id;
   instance = timer_p->instance;
+  OAI_PROBE4 (timer_fire, (long)timer_p->timer, task_id, instance, timer_p->timer_arg);
   message_p = itti_alloc_new_message (TASK_TIMER, TIMER_HAS_EXPIRED);
   timer_expired_p = &message_p->ittiMsg.timer_has_expired;
   timer_expired_p->timer_id = (long)timer_p->timer;
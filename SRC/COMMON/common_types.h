@@ -373,6 +373,16 @@ typedef struct {
   } choice;
 } s6a_result_t;
 
+/* Overload action of S1AP OVERLOAD START, same values as S1ap-OverloadAction (TS 36.413) */
+typedef enum {
+  OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT = 0,
+  OVERLOAD_ACTION_REJECT_RRC_CR_SIGNALLING,
+  OVERLOAD_ACTION_PERMIT_EMERGENCY_AND_MT_ONLY,
+  OVERLOAD_ACTION_PERMIT_HIGH_PRIORITY_AND_MT_ONLY,
+  OVERLOAD_ACTION_REJECT_DELAY_TOLERANT_ACCESS,
+  OVERLOAD_ACTION_MAX,
+} overload_action_t;
+
 #include "commonDef.h"
 
 #endif /* FILE_COMMON_TYPES_SEEN */
@@ -47,4 +47,19 @@
 #define ITTI_QUEUE_MAX_ELEMENTS  (64 * 1024)
 #define ITTI_DUMP_MAX_CON        (5)    /* Max connections in parallel */
 
+/* Memory mapped ring file of the dump (ITTI_DUMP_RING) */
+#define ITTI_DUMP_RING_SIZE        (1 << 26)  /* bytes, power of 2 */
+#define ITTI_DUMP_RING_CHUNK_SIZE  (1 << 17)  /* bytes, power of 2, reserved at once by a thread */
+
+/* Memory pools of the messages, by increasing item size: POOL (item size in bytes, items mapped at init, maximum items).
+ * Pools grow by chunks of pages when they run dry, up to their maximum. */
+#define ITTI_MEMORY_POOLS(POOL)                           \
+  POOL (50,    1000, 1000 + ITTI_QUEUE_MAX_ELEMENTS)       \
+  POOL (100,   1000, 1000 + (2 * ITTI_QUEUE_MAX_ELEMENTS)) \
+  POOL (1000,  100,  10000)                                \
+  POOL (20050, 4,    400)                                  \
+  POOL (30050, 2,    100)
+
+#define ITTI_MEMORY_POOLS_RELEASE_IDLE  (1)   /* idle chunks above the initial items are given back by itti_release_idle_memory () */
+
 #endif /* FILE_INTERTASK_INTERFACE_CONF_SEEN */
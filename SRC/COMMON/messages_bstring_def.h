@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+// bstring fields of the messages exchanged between tasks: MESSAGE_BSTRING_DEF(message id, field of the message union)
+// Their content is appended to the message in ITTI dumps, so that dumps can be replayed.
+MESSAGE_BSTRING_DEF(SCTP_DATA_REQ,                        sctp_data_req.payload)
+MESSAGE_BSTRING_DEF(SCTP_DATA_IND,                        sctp_data_ind.payload)
+MESSAGE_BSTRING_DEF(S1AP_NAS_DL_DATA_REQ,                 s1ap_nas_dl_data_req.nas_msg)
+MESSAGE_BSTRING_DEF(NAS_PDN_CONNECTIVITY_REQ,             nas_pdn_connectivity_req.apn)
+MESSAGE_BSTRING_DEF(NAS_PDN_CONNECTIVITY_REQ,             nas_pdn_connectivity_req.pdn_addr)
+MESSAGE_BSTRING_DEF(NAS_PDN_CONNECTIVITY_RSP,             nas_pdn_connectivity_rsp.apn)
+MESSAGE_BSTRING_DEF(NAS_PDN_CONNECTIVITY_RSP,             nas_pdn_connectivity_rsp.pdn_addr)
+MESSAGE_BSTRING_DEF(NAS_INITIAL_UE_MESSAGE,               nas_initial_ue_message.nas.initial_nas_msg)
+MESSAGE_BSTRING_DEF(NAS_CONNECTION_ESTABLISHMENT_CNF,     nas_conn_est_cnf.nas_msg)
+MESSAGE_BSTRING_DEF(NAS_UPLINK_DATA_IND,                  nas_ul_data_ind.nas_msg)
+MESSAGE_BSTRING_DEF(NAS_DOWNLINK_DATA_REQ,                nas_dl_data_req.nas_msg)
+MESSAGE_BSTRING_DEF(NAS_DOWNLINK_DATA_REJ,                nas_dl_data_rej.nas_msg)
+MESSAGE_BSTRING_DEF(MME_APP_INITIAL_UE_MESSAGE,           mme_app_initial_ue_message.nas)
+MESSAGE_BSTRING_DEF(MME_APP_CONNECTION_ESTABLISHMENT_CNF, mme_app_connection_establishment_cnf.nas_conn_est_cnf.nas_msg)
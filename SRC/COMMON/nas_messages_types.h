@@ -265,6 +265,10 @@ typedef struct itti_nas_conn_est_cnf_s {
   uint32_t                ul_nas_count;
   uint16_t                encryption_algorithm_capabilities;
   uint16_t                integrity_algorithm_capabilities;
+
+  /* Paging area of the UE, MME_APP does not read the EMM context */
+  tai_t                   last_tai;         /* Last visited registered TAI, or TAI of the attach, may be invalid */
+  tai_list_t              tai_list;         /* TAI list of the UE, may be empty */
 } itti_nas_conn_est_cnf_t;
 
 typedef struct itti_nas_conn_rel_ind_s {
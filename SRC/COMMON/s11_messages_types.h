@@ -39,6 +39,9 @@
 #define S11_DELETE_SESSION_RESPONSE(mSGpTR)        (mSGpTR)->ittiMsg.s11_delete_session_response
 #define S11_RELEASE_ACCESS_BEARERS_REQUEST(mSGpTR) (mSGpTR)->ittiMsg.s11_release_access_bearers_request
 #define S11_RELEASE_ACCESS_BEARERS_RESPONSE(mSGpTR) (mSGpTR)->ittiMsg.s11_release_access_bearers_response
+#define S11_DOWNLINK_DATA_NOTIFICATION(mSGpTR)     (mSGpTR)->ittiMsg.s11_downlink_data_notification
+#define S11_DOWNLINK_DATA_NOTIFICATION_ACKNOWLEDGE(mSGpTR) (mSGpTR)->ittiMsg.s11_downlink_data_notification_acknowledge
+#define S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION(mSGpTR) (mSGpTR)->ittiMsg.s11_downlink_data_notification_failure_indication
 
 //-----------------------------------------------------------------------------
 /** @struct itti_s11_create_session_request_t
@@ -934,4 +937,66 @@ typedef struct itti_s11_release_access_bearers_response_s {
   void       *trxn;
   uint32_t    peer_ip;
 } itti_s11_release_access_bearers_response_t;
+
+
+//-----------------------------------------------------------------------------
+/** @struct itti_s11_downlink_data_notification_t
+ *  @brief Downlink Data Notification
+ *
+ * The Downlink Data Notification message is sent on the S11 interface by the SGW to the MME as part of the S1 paging
+ * procedure, when downlink data arrives for a UE whose S1-U bearers are released.
+ */
+typedef struct itti_s11_downlink_data_notification_s {
+  teid_t      teid;                   ///< Tunnel Endpoint Identifier, MME S11 teid of the UE
+  ebi_t       eps_bearer_id;          ///< Conditional, bearer on which the downlink data arrived
+  // Allocation/Retention Priority    ///< conditional
+  // Private Extension                ///< optional
+  /* GTPv2-C specific parameters */
+  void       *trxn;
+  uint32_t    peer_ip;
+} itti_s11_downlink_data_notification_t;
+
+
+//-----------------------------------------------------------------------------
+/** @struct itti_s11_downlink_data_notification_acknowledge_t
+ *  @brief Downlink Data Notification Acknowledge
+ *
+ * Possible Cause values are specified in Table 8.4-1. Message specific cause values are:
+ * - "Request accepted".
+ * - "Context not found".
+ * - "Unable to page UE".
+ */
+typedef struct itti_s11_downlink_data_notification_acknowledge_s {
+  teid_t      teid;                   ///< Tunnel Endpoint Identifier, SGW S11 teid of the UE
+  SGWCause_t  cause;
+  // Data Notification Delay          ///< optional
+  // Recovery                         ///< optional
+  // Private Extension                ///< optional
+  /* GTPv2-C specific parameters */
+  void       *trxn;
+  uint32_t    peer_ip;
+} itti_s11_downlink_data_notification_acknowledge_t;
+
+
+//-----------------------------------------------------------------------------
+/** @struct itti_s11_downlink_data_notification_failure_indication_t
+ *  @brief Downlink Data Notification Failure Indication
+ *
+ * Sent on the S11 interface by the MME to the SGW when the UE does not answer the paging the Downlink Data
+ * Notification triggered, the SGW discards the buffered downlink data. There is no response.
+ * Possible Cause values are:
+ * - "UE not responding".
+ * - "Service denied".
+ * - "UE already re-attached".
+ */
+typedef struct itti_s11_downlink_data_notification_failure_indication_s {
+  teid_t      teid;                   ///< Tunnel Endpoint Identifier, SGW S11 teid of the UE
+  teid_t      local_teid;             ///< not in specs for inner MME use
+  SGWCause_t  cause;
+  node_type_t originating_node;       ///< Conditional, if ISR is active in the MME
+  // IMSI                             ///< Conditional
+  // Private Extension                ///< optional
+  /* GTPv2-C specific parameters */
+  uint32_t    peer_ip;
+} itti_s11_downlink_data_notification_failure_indication_t;
 #endif /* FILE_S11_MESSAGES_TYPES_SEEN */
@@ -47,3 +47,6 @@ MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_REQ    ,  MESSAGE_PRIORITY_MED, itti_s1ap_ue
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_COMMAND,  MESSAGE_PRIORITY_MED, itti_s1ap_ue_context_release_command_t,  s1ap_ue_context_release_command)
 MESSAGE_DEF(S1AP_UE_CONTEXT_RELEASE_COMPLETE, MESSAGE_PRIORITY_MED, itti_s1ap_ue_context_release_complete_t, s1ap_ue_context_release_complete)
 MESSAGE_DEF(S1AP_NAS_DL_DATA_REQ           ,  MESSAGE_PRIORITY_MED, itti_s1ap_nas_dl_data_req_t           ,  s1ap_nas_dl_data_req)
+MESSAGE_DEF(S1AP_PAGING_REQUEST            ,  MESSAGE_PRIORITY_MED, itti_s1ap_paging_request_t            ,  s1ap_paging_request)
+MESSAGE_DEF(S1AP_OVERLOAD_START            ,  MESSAGE_PRIORITY_MED, itti_s1ap_overload_start_t            ,  s1ap_overload_start)
+MESSAGE_DEF(S1AP_OVERLOAD_STOP             ,  MESSAGE_PRIORITY_MED, itti_s1ap_overload_stop_t             ,  s1ap_overload_stop)
@@ -35,6 +35,9 @@
 #define S1AP_UE_CONTEXT_RELEASE_COMMAND(mSGpTR) (mSGpTR)->ittiMsg.s1ap_ue_context_release_command
 #define S1AP_UE_CONTEXT_RELEASE_COMPLETE(mSGpTR) (mSGpTR)->ittiMsg.s1ap_ue_context_release_complete
 #define S1AP_NAS_DL_DATA_REQ(mSGpTR)        (mSGpTR)->ittiMsg.s1ap_nas_dl_data_req
+#define S1AP_PAGING_REQUEST(mSGpTR)         (mSGpTR)->ittiMsg.s1ap_paging_request
+#define S1AP_OVERLOAD_START(mSGpTR)         (mSGpTR)->ittiMsg.s1ap_overload_start
+#define S1AP_OVERLOAD_STOP(mSGpTR)          (mSGpTR)->ittiMsg.s1ap_overload_stop
 
 typedef struct itti_s1ap_initial_ue_message_s {
   mme_ue_s1ap_id_t     mme_ue_s1ap_id;
@@ -117,4 +120,23 @@ typedef struct itti_s1ap_ue_context_release_complete_s {
   enb_ue_s1ap_id_t  enb_ue_s1ap_id:24;
 } itti_s1ap_ue_context_release_complete_t;
 
+/* Paging of an idle UE with its S-TMSI in the PS domain, sent to every eNB serving one of the TAIs */
+typedef struct itti_s1ap_paging_request_s {
+  mme_ue_s1ap_id_t  mme_ue_s1ap_id;     ///< Only for traces, the UE has no S1 connection
+  mme_code_t        mme_code;           ///< S-TMSI
+  tmsi_t            m_tmsi;
+  uint16_t          ue_identity_index;  ///< IMSI mod 1024 (TS 36.304)
+  tai_list_t        tai_list;           ///< Tracking areas where the UE is paged
+} itti_s1ap_paging_request_t;
+
+/* OVERLOAD START sent to every eNB, the action also applies to the Initial UE Messages until S1AP_OVERLOAD_STOP */
+typedef struct itti_s1ap_overload_start_s {
+  overload_action_t action;
+  uint32_t          load_percent;       ///< Only for traces
+} itti_s1ap_overload_start_t;
+
+typedef struct itti_s1ap_overload_stop_s {
+  uint32_t          load_percent;       ///< Only for traces
+} itti_s1ap_overload_stop_t;
+
 #endif /* FILE_S1AP_MESSAGES_TYPES_SEEN */
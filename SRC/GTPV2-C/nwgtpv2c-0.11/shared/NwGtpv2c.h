@@ -134,6 +134,7 @@ typedef struct NwGtpv2cStackConfigS {
 #define NW_GTPV2C_ULP_API_FLAG_CREATE_LOCAL_TUNNEL                      (0x01 << 24)
 #define NW_GTPV2C_ULP_API_FLAG_DELETE_LOCAL_TUNNEL                      (0x02 << 24)
 #define NW_GTPV2C_ULP_API_FLAG_IS_COMMAND_MESSAGE                       (0x03 << 24)
+#define NW_GTPV2C_ULP_API_FLAG_NO_RSP_EXPECTED                          (0x04 << 24)   /**< Initial message without response, sent once */
 
 /*---------------------------------------------------------------------------
  * Gtpv2c Stack ULP API type definitions
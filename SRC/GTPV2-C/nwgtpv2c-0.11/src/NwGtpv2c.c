@@ -46,6 +46,7 @@
 #include "NwGtpv2cLog.h"
 #include "dynamic_memory_check.h"
 #include "gcc_diag.h"
+#include "oai_clock.h"
 
 #ifdef _NWGTPV2C_HAVE_TIMERADD
 #  define NW_GTPV2C_TIMER_ADD(tvp, uvp, vvp) timeradd((tvp), (uvp), (vvp))
@@ -559,7 +560,13 @@ extern                                  "C" {
 
       rc = nwGtpv2cCreateAndSendMsg (thiz, pTrxn->seqNum, pTrxn->peerIp, pTrxn->peerPort, pTrxn->pMsg);
 
-      if (NW_OK == rc) {
+      if ((NW_OK == rc) && (pUlpReq->apiType & NW_GTPV2C_ULP_API_FLAG_NO_RSP_EXPECTED)) {
+        /*
+         * Nothing to wait for, the transaction only gave a sequence number
+         */
+        rc = nwGtpv2cTrxnDelete (&pTrxn);
+        NW_ASSERT (NW_OK == rc);
+      } else if (NW_OK == rc) {
         /*
          * Start guard timer
          */
@@ -610,7 +617,13 @@ extern                                  "C" {
       pTrxn->pMsg = (NwGtpv2cMsgT *) pUlpReq->hMsg;
       rc = nwGtpv2cCreateAndSendMsg (thiz, pTrxn->seqNum, pTrxn->peerIp, pTrxn->peerPort, pTrxn->pMsg);
 
-      if (NW_OK == rc) {
+      if ((NW_OK == rc) && (pUlpReq->apiType & NW_GTPV2C_ULP_API_FLAG_NO_RSP_EXPECTED)) {
+        /*
+         * Nothing to wait for, the transaction only gave a sequence number
+         */
+        rc = nwGtpv2cTrxnDelete (&pTrxn);
+        NW_ASSERT (NW_OK == rc);
+      } else if (NW_OK == rc) {
         /*
          * Start guard timer
          */
@@ -964,6 +977,8 @@ extern                                  "C" {
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_MODIFY_BEARER_RSP);
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_RELEASE_ACCESS_BEARERS_REQ);
       NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_RELEASE_ACCESS_BEARERS_RSP);
+      NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_DOWNLINK_DATA_NOTIFICATION);
+      NW_GTPV2C_INIT_MSG_IE_PARSE_INFO (thiz, NW_GTP_DOWNLINK_DATA_NOTIFICATION_ACK);
       /*
        * For S10 interface
        */
@@ -1153,6 +1168,7 @@ extern                                  "C" {
     case NW_GTP_UPDATE_BEARER_REQ:
     case NW_GTP_DELETE_BEARER_REQ:
     case NW_GTP_RELEASE_ACCESS_BEARERS_REQ:
+    case NW_GTP_DOWNLINK_DATA_NOTIFICATION:
     case NW_GTP_CREATE_INDIRECT_DATA_FORWARDING_TUNNEL_REQ:
     case NW_GTP_DELETE_INDIRECT_DATA_FORWARDING_TUNNEL_REQ:{
         rc = nwGtpv2cHandleInitialReq (thiz, msgType, udpData, udpDataLen, peerPort, peerIp);
@@ -1167,6 +1183,7 @@ extern                                  "C" {
     case NW_GTP_UPDATE_BEARER_RSP:
     case NW_GTP_DELETE_BEARER_RSP:
     case NW_GTP_RELEASE_ACCESS_BEARERS_RSP:
+    case NW_GTP_DOWNLINK_DATA_NOTIFICATION_ACK:
     case NW_GTP_CREATE_INDIRECT_DATA_FORWARDING_TUNNEL_RSP:
     case NW_GTP_DELETE_INDIRECT_DATA_FORWARDING_TUNNEL_RSP: {
         rc = nwGtpv2cHandleTriggeredRsp (thiz, msgType, udpData, udpDataLen, peerPort, peerIp);
@@ -1271,7 +1288,7 @@ extern                                  "C" {
       OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
     }
 
-    NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+    oai_clock_coarse_monotonic (&tv);
 
     for ((timeoutInfo) = RB_MIN (NwGtpv2cActiveTimerList, &(thiz->activeTimerList)); (timeoutInfo) != NULL;) {
       if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, >))
@@ -1327,7 +1344,7 @@ extern                                  "C" {
       OAILOG_FUNC_RETURN (LOG_GTPV2C, NW_OK);
     }
 
-    NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+    oai_clock_coarse_monotonic (&tv);
     //printf("------ Start -------\n");
     OAI_GCC_DIAG_OFF(int-to-pointer-cast);
     timeoutInfo = nwGtpv2cTmrMinHeapPeek ((NwGtpv2cTmrMinHeapT *)thiz->hTmrMinHeap);
@@ -1401,8 +1418,7 @@ extern                                  "C" {
       timeoutInfo->timeoutArg = timeoutCallbackArg;
       timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
       timeoutInfo->hStack = (NwGtpv2cStackHandleT) thiz;
-      NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-      NW_ASSERT (gettimeofday (&timeoutInfo->tvTimeout, NULL) == 0);
+      oai_clock_coarse_monotonic (&tv);
       timeoutInfo->tvTimeout.tv_sec = timeoutSec;
       timeoutInfo->tvTimeout.tv_usec = timeoutUsec;
       NW_GTPV2C_TIMER_ADD (&tv, &timeoutInfo->tvTimeout, &timeoutInfo->tvTimeout);
@@ -1478,8 +1494,7 @@ extern                                  "C" {
       timeoutInfo->timeoutArg = timeoutCallbackArg;
       timeoutInfo->timeoutCallbackFunc = timeoutCallbackFunc;
       timeoutInfo->hStack = (NwGtpv2cStackHandleT) thiz;
-      NW_ASSERT (gettimeofday (&tv, NULL) == 0);
-      NW_ASSERT (gettimeofday (&timeoutInfo->tvTimeout, NULL) == 0);
+      oai_clock_coarse_monotonic (&tv);
       timeoutInfo->tvTimeout.tv_sec = timeoutSec;
       timeoutInfo->tvTimeout.tv_usec = timeoutUsec;
       NW_GTPV2C_TIMER_ADD (&tv, &timeoutInfo->tvTimeout, &timeoutInfo->tvTimeout);
@@ -1551,7 +1566,7 @@ extern                                  "C" {
       OAI_GCC_DIAG_ON(int-to-pointer-cast);
 
       if (timeoutInfo) {
-        NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+        oai_clock_coarse_monotonic (&tv);
 
         if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, <)) {
           thiz->activeTimerInfo = timeoutInfo;
@@ -1593,7 +1608,7 @@ extern                                  "C" {
       timeoutInfo = RB_MIN (NwGtpv2cActiveTimerList, &(thiz->activeTimerList));
 
       if (timeoutInfo) {
-        NW_ASSERT (gettimeofday (&tv, NULL) == 0);
+        oai_clock_coarse_monotonic (&tv);
 
         if (NW_GTPV2C_TIMER_CMP_P (&timeoutInfo->tvTimeout, &tv, <)) {
           thiz->activeTimerInfo = timeoutInfo;
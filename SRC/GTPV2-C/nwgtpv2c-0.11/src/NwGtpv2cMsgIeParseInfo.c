@@ -224,6 +224,31 @@ extern                                  "C" {
     {0, 0, 0}
   };
 
+  static
+  NwGtpv2cMsgIeInfoT                      downlinkDataNotificationIeInfoTbl[] = {
+    {NW_GTPV2C_IE_CAUSE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+    {NW_GTPV2C_IE_EBI, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
+    {NW_GTPV2C_IE_PRIVATE_EXTENSION, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+
+    /*
+     * Do not add below this
+     */
+    {0, 0, 0}
+  };
+
+  static
+  NwGtpv2cMsgIeInfoT                      downlinkDataNotificationAckIeInfoTbl[] = {
+    {NW_GTPV2C_IE_CAUSE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, NULL},
+    {NW_GTPV2C_IE_DELAY_VALUE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL, NULL},
+    {NW_GTPV2C_IE_RECOVERY, 1, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+    {NW_GTPV2C_IE_PRIVATE_EXTENSION, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_OPTIONAL, NULL},
+
+    /*
+     * Do not add below this
+     */
+    {0, 0, 0}
+  };
+
   static
   NwGtpv2cMsgIeInfoT                      deleteSessionRspIeInfoTbl[] = {
     {NW_GTPV2C_IE_CAUSE, 0, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_MANDATORY, NULL},
@@ -555,6 +580,18 @@ extern                                  "C" {
         }
         break;
 
+      case NW_GTP_DOWNLINK_DATA_NOTIFICATION:{
+          rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, downlinkDataNotificationIeInfoTbl);
+          NW_ASSERT (NW_OK == rc);
+        }
+        break;
+
+      case NW_GTP_DOWNLINK_DATA_NOTIFICATION_ACK:{
+          rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, downlinkDataNotificationAckIeInfoTbl);
+          NW_ASSERT (NW_OK == rc);
+        }
+        break;
+
       case NW_GTP_FORWARD_RELOCATION_REQ:{
           rc = nwGtpv2cMsgIeParseInfoUpdate (thiz, forwardRelocationReqIeInfoTbl);
           NW_ASSERT (NW_OK == rc);
@@ -42,6 +42,7 @@
 #include "mme_config.h"
 #include "emmData.h"
 #include "mme_app_statistics.h"
+#include "mme_app_overload.h"
 #include "timer.h"
 #include "s1ap_mme.h"
 
@@ -75,7 +76,7 @@ mme_app_send_s11_release_access_bearers_req (
 
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_RELEASE_ACCESS_BEARERS_REQUEST teid %u ebi %u",
       release_access_bearers_request_p->teid, release_access_bearers_request_p->list_of_rabs.ebis[0]);
-  rc = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rc = mme_app_overload_send_s11_request (message_p);
   OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
 }
 
@@ -247,7 +248,7 @@ mme_app_send_s11_create_session_req (
   session_request_p->selection_mode = MS_O_N_P_APN_S_V;
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0,
       "0 S11_CREATE_SESSION_REQUEST imsi " IMSI_64_FMT, ue_context_pP->imsi);
-  rc = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rc = mme_app_overload_send_s11_request (message_p);
   OAILOG_FUNC_RETURN (LOG_MME_APP, rc);
 }
 
@@ -355,6 +356,9 @@ mme_app_handle_conn_est_cnf (
     OAILOG_FUNC_OUT (LOG_MME_APP);
   }
 
+  ue_context_p->last_tai = nas_conn_est_cnf_pP->last_tai;
+  ue_context_p->tai_list = nas_conn_est_cnf_pP->tai_list;
+
   message_p = itti_alloc_new_message (TASK_MME_APP, MME_APP_CONNECTION_ESTABLISHMENT_CNF);
   establishment_cnf_p = &message_p->ittiMsg.mme_app_connection_establishment_cnf;
   memset (establishment_cnf_p, 0, sizeof (itti_mme_app_connection_establishment_cnf_t));
@@ -523,6 +527,7 @@ mme_app_handle_initial_ue_message (
   // Initialize timers to INVALID IDs
   ue_context_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
   ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  ue_context_p->paging_timer.id = MME_APP_TIMER_INACTIVE_ID;
 
   message_p = itti_alloc_new_message (TASK_MME_APP, NAS_INITIAL_UE_MESSAGE);
   // do this because of same message types name but not same struct in different .h
@@ -890,7 +895,7 @@ mme_app_handle_initial_context_setup_rsp (
   MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME,  MSC_S11_MME ,
                       NULL, 0, "0 S11_MODIFY_BEARER_REQUEST teid %u ebi %u", s11_modify_bearer_request->teid,
                       s11_modify_bearer_request->bearer_contexts_to_be_modified.bearer_contexts[0].eps_bearer_id);
-  itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  mme_app_overload_send_s11_request (message_p);
 
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
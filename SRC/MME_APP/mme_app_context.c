@@ -42,6 +42,8 @@
 #include "s1ap_mme.h"
 #include "timer.h"
 #include "mme_app_statistics.h"
+#include "mme_app_m_tmsi.h"
+#include "mme_app_ue_handle.h"
 
 
 static void _mme_app_handle_s1ap_ue_context_release (const mme_ue_s1ap_id_t mme_ue_s1ap_id,
@@ -59,6 +61,7 @@ ue_context_t *mme_create_new_ue_context (void)
   // Initialize timers to INVALID IDs
   new_p->mobile_reachability_timer.id = MME_APP_TIMER_INACTIVE_ID;
   new_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  new_p->paging_timer.id = MME_APP_TIMER_INACTIVE_ID;
   return new_p;
 }
 
@@ -113,6 +116,8 @@ void mme_app_ue_context_free_content (ue_context_t * const ue_context_p)
     } 
     ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
   }
+  // Stop Paging timer,if running
+  mme_app_paging_stop (ue_context_p);
   if (ue_context_p->ue_radio_capabilities) {
     free_wrapper((void**) &(ue_context_p->ue_radio_capabilities));
   }
@@ -153,7 +158,20 @@ mme_ue_context_exists_mme_ue_s1ap_id (
 {
   struct ue_context_s                    *ue_context_p = NULL;
 
-  hashtable_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&ue_context_p);
+  ue_context_p = mme_app_ue_handle_ue_context (&mme_ue_context_p->mme_ue_s1ap_id_generation, mme_ue_s1ap_id);
+  if (!ue_context_p) {
+    hashtable_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&ue_context_p);
+    mme_app_ue_handle_probed_ue_context (mme_ue_s1ap_id, ue_context_p);
+  }
+#if DEBUG_IS_ON
+  else {
+    struct ue_context_s                  *probed_p = NULL;
+
+    hashtable_ts_get (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&probed_p);
+    AssertFatal (probed_p == ue_context_p, "UE handle of mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " holds UE context %p, collection %p\n",
+        mme_ue_s1ap_id, ue_context_p, probed_p);
+  }
+#endif
   return ue_context_p;
 
 }
@@ -228,6 +246,7 @@ void mme_app_move_context (ue_context_t *dst, ue_context_t *src)
     dst->ecm_state               = src->ecm_state;
     dst->is_guti_set             = src->is_guti_set;
     dst->guti                    = src->guti;
+    mme_app_m_tmsi_move (src->guti.m_tmsi, src, dst);
     dst->me_identity             = src->me_identity;
     dst->e_utran_cgi             = src->e_utran_cgi;
     dst->cell_age                = src->cell_age;
@@ -299,6 +318,7 @@ mme_ue_context_duplicate_enb_ue_s1ap_id_detected (
          * Insert and remove need to be corrected. mme_ue_s1ap_id is used to point to context ptr and
          * enb_ue_s1ap_id_key is used to point to mme_ue_s1ap_id
          */ 
+        mme_app_ue_handle_forget (&mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_generation, mme_ue_s1ap_id);
         h_rc = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void **)&id);
         h_rc = hashtable_ts_insert (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)(uintptr_t)enb_key);
         h_rc = hashtable_ts_remove (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, (const hash_key_t)old_enb_key, (void **)&old);
@@ -414,6 +434,7 @@ mme_ue_context_update_coll_keys (
 
   if ((INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) && (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
       // new insertion of mme_ue_s1ap_id, not a change in the id
+      mme_app_ue_handle_forget (&mme_ue_context_p->mme_ue_s1ap_id_generation, ue_context_p->mme_ue_s1ap_id);
       h_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->mme_ue_s1ap_id,  (void **)&ue_context_p);
       h_rc = hashtable_ts_insert (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)mme_ue_s1ap_id, (void *)ue_context_p);
 
@@ -445,6 +466,9 @@ mme_ue_context_update_coll_keys (
 
     if (guti_p)
     {
+      if (guti_p->m_tmsi != ue_context_p->guti.m_tmsi) {
+        mme_app_m_tmsi_release (ue_context_p->guti.m_tmsi, ue_context_p);
+      }
       h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, (const void *const)&ue_context_p->guti, sizeof (ue_context_p->guti), (void **)&id);
       h_rc = obj_hashtable_ts_insert (mme_ue_context_p->guti_ue_context_htbl, (const void *const)guti_p, sizeof (*guti_p), (void *)(uintptr_t)mme_ue_s1ap_id);
       if (HASH_TABLE_OK != h_rc) {
@@ -497,6 +521,9 @@ mme_ue_context_update_coll_keys (
       || (guti_p->gummei.plmn.mcc_digit3 != ue_context_p->guti.gummei.plmn.mcc_digit3)
       || (ue_context_p->mme_ue_s1ap_id != mme_ue_s1ap_id)) {
 
+      if (guti_p->m_tmsi != ue_context_p->guti.m_tmsi) {
+        mme_app_m_tmsi_release (ue_context_p->guti.m_tmsi, ue_context_p);
+      }
       // may check guti_p with a kind of instanceof()?
       h_rc = obj_hashtable_ts_remove (mme_ue_context_p->guti_ue_context_htbl, &ue_context_p->guti, sizeof (*guti_p), (void **)&id);
       if (INVALID_MME_UE_S1AP_ID != mme_ue_s1ap_id) {
@@ -687,10 +714,12 @@ void mme_remove_ue_context (
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT ", GUTI  not in GUTI collection",
           ue_context_p->enb_ue_s1ap_id, ue_context_p->mme_ue_s1ap_id);
+    mme_app_m_tmsi_release (ue_context_p->guti.m_tmsi, ue_context_p);
   }
   
   // filled NAS UE ID/ MME UE S1AP ID
   if (INVALID_MME_UE_S1AP_ID != ue_context_p->mme_ue_s1ap_id) {
+    mme_app_ue_handle_forget (&mme_ue_context_p->mme_ue_s1ap_id_generation, ue_context_p->mme_ue_s1ap_id);
     hash_rc = hashtable_ts_remove (mme_ue_context_p->mme_ue_s1ap_id_ue_context_htbl, (const hash_key_t)ue_context_p->mme_ue_s1ap_id, (void **)&ue_context_p);
     if (HASH_TABLE_OK != hash_rc)
       OAILOG_DEBUG(LOG_MME_APP, "UE context enb_ue_s1ap_ue_id "ENB_UE_S1AP_ID_FMT ", mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " not in MME UE S1AP ID collection",
@@ -765,6 +794,8 @@ void mme_ue_context_update_ue_sig_connection_state (
       } 
       ue_context_p->implicit_detach_timer.id = MME_APP_TIMER_INACTIVE_ID;
     }
+    // The UE answered the paging, if any
+    mme_app_paging_stop (ue_context_p);
     // Update Stats
     update_mme_app_stats_connected_ue_add();
   }
@@ -31,6 +31,7 @@
 #define FILE_MME_APP_DEFS_SEEN
 #include "intertask_interface.h"
 #include "mme_app_ue_context.h"
+#include "mme_config.h"
 
 typedef struct {
   /* UE contexts + some statistics variables */
@@ -38,6 +39,12 @@ typedef struct {
 
   long statistic_timer_id;
   uint32_t statistic_timer_period;
+
+  long overload_timer_id;
+
+  /* Task the S11 requests are sent to: TASK_S11, or TASK_SPGW_APP if the
+   * S-GW runs in this process (no SGW S11 address configured) */
+  task_id_t s11_task_id;
   
   /* Reader/writer lock */
   pthread_rwlock_t rw_lock;
@@ -119,6 +126,16 @@ void mme_app_handle_mobile_reachability_timer_expiry (struct ue_context_s *ue_co
 
 void mme_app_handle_implicit_detach_timer_expiry (struct ue_context_s *ue_context_p); 
 
+int mme_app_paging_init (const mme_config_t * mme_config_p);
+
+int mme_app_paging_request (struct ue_context_s *ue_context_p);
+
+void mme_app_paging_stop (struct ue_context_s *ue_context_p);
+
+void mme_app_handle_paging_timer_expiry (struct ue_context_s *ue_context_p);
+
+void mme_app_handle_downlink_data_notification (const itti_s11_downlink_data_notification_t * const notif_pP);
+
 #define mme_stats_read_lock(mMEsTATS)  pthread_rwlock_rdlock(&(mMEsTATS)->rw_lock)
 #define mme_stats_write_lock(mMEsTATS) pthread_rwlock_wrlock(&(mMEsTATS)->rw_lock)
 #define mme_stats_unlock(mMEsTATS)     pthread_rwlock_unlock(&(mMEsTATS)->rw_lock)
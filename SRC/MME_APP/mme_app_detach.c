@@ -38,6 +38,7 @@
 #include "mme_app_ue_context.h"
 #include "mme_app_itti_messaging.h"
 #include "mme_app_defs.h"
+#include "mme_app_overload.h"
 
 //------------------------------------------------------------------------------
 void
@@ -75,7 +76,7 @@ mme_app_send_delete_session_request (
                       S11_DELETE_SESSION_REQUEST  (message_p).teid,
                       S11_DELETE_SESSION_REQUEST  (message_p).lbi);
 
-  itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  mme_app_overload_send_s11_request (message_p);
   OAILOG_FUNC_OUT (LOG_MME_APP);
 }
 
@@ -26,4 +26,6 @@
 
 int mme_app_init(const mme_config_t *mme_config);
 
+void mme_app_set_task_shards(const uint32_t shards);
+
 #endif /* FILE_MME_APP_EXTERN_SEEN */
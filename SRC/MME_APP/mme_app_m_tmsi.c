@@ -0,0 +1,278 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file mme_app_m_tmsi.c
+   \brief M-TMSI allocator.
+   The pool has 2^n slots, each slot holds its last M-TMSI and the UE context owning it (NULL when free).
+   The M-TMSI of a slot is prefix | F(generation << n | slot), F being a keyed Feistel permutation
+   of the (32 - prefix bits) other bits: M-TMSIs of different slots or generations never collide,
+   are not sequential, and the slot of an M-TMSI is found back by the inverse permutation.
+   Free slots are queued in FIFO order and the generation of a slot is incremented on each
+   allocation, a released M-TMSI is given again only after all the generations of its slot have been used.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "common_types.h"
+#include "log.h"
+#include "mme_app_m_tmsi.h"
+
+#define MME_APP_M_TMSI_FEISTEL_ROUNDS   4
+#define MME_APP_M_TMSI_MIN_SLOT_BITS    10
+#define MME_APP_M_TMSI_MIN_GEN_BITS     4
+
+// M-TMSI and owner side by side, a release or an allocation misses one cache line
+typedef struct mme_app_m_tmsi_slot_s {
+  const void            *owner;
+  tmsi_t                 m_tmsi;         // last M-TMSI of the slot
+} mme_app_m_tmsi_slot_t;
+
+typedef struct mme_app_m_tmsi_pool_s {
+  pthread_mutex_t        mutex;
+  int                    prefix_shift;   // 32 - prefix bits
+  tmsi_t                 prefix;         // already shifted
+  int                    half_bits;      // Feistel halves
+  uint32_t               half_mask;
+  int                    slot_bits;
+  uint32_t               slot_mask;
+  uint32_t               gen_mask;       // generation, once shifted by slot_bits
+  uint32_t               key[MME_APP_M_TMSI_FEISTEL_ROUNDS];
+  mme_app_m_tmsi_slot_t *slots;
+  uint32_t              *free_slots;     // FIFO ring
+  uint32_t               free_head;
+  uint32_t               nb_free;
+} mme_app_m_tmsi_pool_t;
+
+static mme_app_m_tmsi_pool_t g_m_tmsi_pool = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+//------------------------------------------------------------------------------
+static inline uint32_t mme_app_m_tmsi_round (const int round, const uint32_t half)
+{
+  // murmur3 finalizer
+  uint32_t                                x = half ^ g_m_tmsi_pool.key[round];
+
+  x ^= x >> 16;
+  x *= 0x85ebca6b;
+  x ^= x >> 13;
+  x *= 0xc2b2ae35;
+  x ^= x >> 16;
+  return x & g_m_tmsi_pool.half_mask;
+}
+
+//------------------------------------------------------------------------------
+static inline tmsi_t mme_app_m_tmsi_encode (const uint32_t value)
+{
+  uint32_t                                l = value >> g_m_tmsi_pool.half_bits;
+  uint32_t                                r = value & g_m_tmsi_pool.half_mask;
+
+  for (int i = 0; i < MME_APP_M_TMSI_FEISTEL_ROUNDS; i++) {
+    uint32_t                              t = r;
+
+    r = l ^ mme_app_m_tmsi_round (i, r);
+    l = t;
+  }
+  return g_m_tmsi_pool.prefix | (l << g_m_tmsi_pool.half_bits) | r;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t mme_app_m_tmsi_decode (const tmsi_t m_tmsi)
+{
+  uint32_t                                l = (m_tmsi >> g_m_tmsi_pool.half_bits) & g_m_tmsi_pool.half_mask;
+  uint32_t                                r = m_tmsi & g_m_tmsi_pool.half_mask;
+
+  for (int i = MME_APP_M_TMSI_FEISTEL_ROUNDS - 1; i >= 0; i--) {
+    uint32_t                              t = l;
+
+    l = r ^ mme_app_m_tmsi_round (i, l);
+    r = t;
+  }
+  return (l << g_m_tmsi_pool.half_bits) | r;
+}
+
+//------------------------------------------------------------------------------
+static void mme_app_m_tmsi_keys (void)
+{
+  FILE                                   *f = fopen ("/dev/urandom", "r");
+
+  if ((NULL == f) || (1 != fread (g_m_tmsi_pool.key, sizeof (g_m_tmsi_pool.key), 1, f))) {
+    OAILOG_WARNING (LOG_MME_APP, "Could not read /dev/urandom, M-TMSI keys derived from time and pid\n");
+    srandom ((unsigned int)time (NULL) ^ (unsigned int)getpid ());
+    for (int i = 0; i < MME_APP_M_TMSI_FEISTEL_ROUNDS; i++) {
+      g_m_tmsi_pool.key[i] = ((uint32_t)random () << 16) ^ (uint32_t)random ();
+    }
+  }
+  if (f) {
+    fclose (f);
+  }
+}
+
+//------------------------------------------------------------------------------
+int mme_app_m_tmsi_pool_init (const uint32_t max_ues, const uint32_t prefix, const int prefix_bits)
+{
+  mme_app_m_tmsi_pool_t                  *pool = &g_m_tmsi_pool;
+  int                                     slot_bits = MME_APP_M_TMSI_MIN_SLOT_BITS;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  if ((0 > prefix_bits) || (8 < prefix_bits) || (prefix_bits & 1) || (prefix >> prefix_bits)) {
+    OAILOG_ERROR (LOG_MME_APP, "Invalid M-TMSI prefix %x on %d bits\n", prefix, prefix_bits);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+  while ((((uint64_t)1) << slot_bits) < max_ues) {
+    slot_bits++;
+  }
+  if (slot_bits > 32 - prefix_bits - MME_APP_M_TMSI_MIN_GEN_BITS) {
+    OAILOG_ERROR (LOG_MME_APP, "Too many UEs (%u) for M-TMSIs with a prefix on %d bits\n", max_ues, prefix_bits);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+  mme_app_m_tmsi_pool_exit ();
+  pthread_mutex_lock (&pool->mutex);
+  pool->prefix_shift = 32 - prefix_bits;
+  pool->prefix = (prefix_bits) ? (prefix << pool->prefix_shift) : 0;
+  pool->half_bits = pool->prefix_shift / 2;
+  pool->half_mask = (((uint32_t)1) << pool->half_bits) - 1;
+  pool->slot_bits = slot_bits;
+  pool->slot_mask = (((uint32_t)1) << slot_bits) - 1;
+  pool->gen_mask = (uint32_t)((((uint64_t)1) << (pool->prefix_shift - slot_bits)) - 1);
+  mme_app_m_tmsi_keys ();
+  pool->slots = calloc (pool->slot_mask + 1, sizeof (mme_app_m_tmsi_slot_t));
+  pool->free_slots = calloc (pool->slot_mask + 1, sizeof (uint32_t));
+  AssertFatal ((pool->slots) && (pool->free_slots), "Out of memory for %u M-TMSI slots", pool->slot_mask + 1);
+  for (uint32_t slot = 0; slot <= pool->slot_mask; slot++) {
+    pool->slots[slot].m_tmsi = mme_app_m_tmsi_encode (slot);
+    pool->free_slots[slot] = slot;
+  }
+  pool->free_head = 0;
+  pool->nb_free = pool->slot_mask + 1;
+  pthread_mutex_unlock (&pool->mutex);
+  OAILOG_DEBUG (LOG_MME_APP, "M-TMSI pool of %u slots, prefix %x on %d bits\n", pool->slot_mask + 1, prefix, prefix_bits);
+  OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_m_tmsi_pool_exit (void)
+{
+  pthread_mutex_lock (&g_m_tmsi_pool.mutex);
+  free_wrapper ((void**)&g_m_tmsi_pool.slots);
+  free_wrapper ((void**)&g_m_tmsi_pool.free_slots);
+  g_m_tmsi_pool.nb_free = 0;
+  pthread_mutex_unlock (&g_m_tmsi_pool.mutex);
+}
+
+//------------------------------------------------------------------------------
+tmsi_t mme_app_m_tmsi_allocate (const void * const owner)
+{
+  mme_app_m_tmsi_pool_t                  *pool = &g_m_tmsi_pool;
+  tmsi_t                                  m_tmsi = INVALID_M_TMSI;
+
+  DevAssert (owner);
+  pthread_mutex_lock (&pool->mutex);
+  if (pool->nb_free) {
+    uint32_t                              slot = pool->free_slots[pool->free_head];
+    uint32_t                              generation = mme_app_m_tmsi_decode (pool->slots[slot].m_tmsi) >> pool->slot_bits;
+
+    pool->free_head = (pool->free_head + 1) & pool->slot_mask;
+    pool->nb_free--;
+    do {
+      generation = (generation + 1) & pool->gen_mask;
+      m_tmsi = mme_app_m_tmsi_encode ((generation << pool->slot_bits) | slot);
+    } while (INVALID_M_TMSI == m_tmsi);
+    pool->slots[slot].m_tmsi = m_tmsi;
+    pool->slots[slot].owner = owner;
+  }
+  pthread_mutex_unlock (&pool->mutex);
+  return m_tmsi;
+}
+
+//------------------------------------------------------------------------------
+static inline uint32_t mme_app_m_tmsi_slot (const tmsi_t m_tmsi, const void * const owner)
+{
+  mme_app_m_tmsi_pool_t                  *pool = &g_m_tmsi_pool;
+  uint32_t                                slot = pool->slot_mask + 1;
+
+  if ((pool->slots) && (INVALID_M_TMSI != m_tmsi) && ((m_tmsi & ~(uint32_t)((((uint64_t)1) << pool->prefix_shift) - 1)) == pool->prefix)) {
+    slot = mme_app_m_tmsi_decode (m_tmsi) & pool->slot_mask;
+    if ((pool->slots[slot].m_tmsi != m_tmsi) || (pool->slots[slot].owner != owner) || (NULL == owner)) {
+      slot = pool->slot_mask + 1;
+    }
+  }
+  return slot;
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_m_tmsi_release (const tmsi_t m_tmsi, const void * const owner)
+{
+  mme_app_m_tmsi_pool_t                  *pool = &g_m_tmsi_pool;
+  uint32_t                                slot = 0;
+  bool                                    released = false;
+
+  pthread_mutex_lock (&pool->mutex);
+  slot = mme_app_m_tmsi_slot (m_tmsi, owner);
+  if (slot <= pool->slot_mask) {
+    pool->slots[slot].owner = NULL;
+    pool->free_slots[(pool->free_head + pool->nb_free) & pool->slot_mask] = slot;
+    pool->nb_free++;
+    released = true;
+  }
+  pthread_mutex_unlock (&pool->mutex);
+  return released;
+}
+
+//------------------------------------------------------------------------------
+bool mme_app_m_tmsi_move (const tmsi_t m_tmsi, const void * const old_owner, const void * const new_owner)
+{
+  mme_app_m_tmsi_pool_t                  *pool = &g_m_tmsi_pool;
+  uint32_t                                slot = 0;
+  bool                                    moved = false;
+
+  DevAssert (new_owner);
+  pthread_mutex_lock (&pool->mutex);
+  slot = mme_app_m_tmsi_slot (m_tmsi, old_owner);
+  if (slot <= pool->slot_mask) {
+    pool->slots[slot].owner = new_owner;
+    moved = true;
+  }
+  pthread_mutex_unlock (&pool->mutex);
+  return moved;
+}
+
+//------------------------------------------------------------------------------
+uint32_t mme_app_m_tmsi_nb_allocated (void)
+{
+  uint32_t                                nb_allocated = 0;
+
+  pthread_mutex_lock (&g_m_tmsi_pool.mutex);
+  if (g_m_tmsi_pool.slots) {
+    nb_allocated = g_m_tmsi_pool.slot_mask + 1 - g_m_tmsi_pool.nb_free;
+  }
+  pthread_mutex_unlock (&g_m_tmsi_pool.mutex);
+  return nb_allocated;
+}
@@ -0,0 +1,57 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_m_tmsi.h
+   \brief M-TMSI allocator: unique among the live UEs, non sequential, allocated and released in O(1).
+*/
+
+#ifndef FILE_MME_APP_M_TMSI_SEEN
+#define FILE_MME_APP_M_TMSI_SEEN
+
+/** \brief Initializes the M-TMSI pool.
+ * \param max_ues       Live UEs, the pool holds the next power of 2 slots.
+ * \param prefix        Value of the most significant prefix_bits of all the allocated M-TMSIs.
+ * \param prefix_bits   Even, 0 to 8.
+ * @returns RETURNok or RETURNerror
+ **/
+int mme_app_m_tmsi_pool_init(const uint32_t max_ues, const uint32_t prefix, const int prefix_bits);
+
+void mme_app_m_tmsi_pool_exit(void);
+
+/** \brief Allocates an M-TMSI to owner (the UE context).
+ * @returns INVALID_M_TMSI if all slots are in use
+ **/
+tmsi_t mme_app_m_tmsi_allocate(const void * const owner);
+
+/** \brief Releases m_tmsi if it is allocated to owner, ignores it otherwise (M-TMSI of another
+ *         MME, or of another UE context after a context move).
+ * @returns true if m_tmsi has been released
+ **/
+bool mme_app_m_tmsi_release(const tmsi_t m_tmsi, const void * const owner);
+
+/** \brief Transfers m_tmsi from old_owner to new_owner.
+ * @returns true if m_tmsi was allocated to old_owner
+ **/
+bool mme_app_m_tmsi_move(const tmsi_t m_tmsi, const void * const old_owner, const void * const new_owner);
+
+uint32_t mme_app_m_tmsi_nb_allocated(void);
+
+#endif /* FILE_MME_APP_M_TMSI_SEEN */
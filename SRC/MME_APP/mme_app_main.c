@@ -31,6 +31,9 @@
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_app_statistics.h"
+#include "mme_app_m_tmsi.h"
+#include "mme_app_ue_handle.h"
+#include "mme_app_overload.h"
 #include "assertions.h"
 #include "msc.h"
 
@@ -38,170 +41,221 @@ mme_app_desc_t                          mme_app_desc = {.rw_lock = PTHREAD_RWLOC
 
 void     *mme_app_thread (void *args);
 
-
-void *mme_app_thread (
-  void *args)
+//------------------------------------------------------------------------------
+static void mme_app_handle_message (
+  MessageDef * received_message_p)
 {
   struct ue_context_s                    *ue_context_p = NULL;
-  itti_mark_task_ready (TASK_MME_APP);
-  MSC_START_USE ();
 
-  while (1) {
-    MessageDef                             *received_message_p = NULL;
+  DevAssert (received_message_p );
+  mme_app_ue_handle_open ();
 
-    /*
-     * Trying to fetch a message from the message queue.
-     * If the queue is empty, this function will block till a
-     * message is sent to the task.
-     */
-    itti_receive_msg (TASK_MME_APP, &received_message_p);
-    DevAssert (received_message_p );
+  switch (ITTI_MSG_ID (received_message_p)) {
 
-    switch (ITTI_MSG_ID (received_message_p)) {
+  case S6A_UPDATE_LOCATION_ANS:{
+      /*
+       * We received the update location answer message from HSS -> Handle it
+       */
+      mme_app_handle_s6a_update_location_ans (&received_message_p->ittiMsg.s6a_update_location_ans);
+    }
+    break;
 
-    case S6A_UPDATE_LOCATION_ANS:{
+  case S11_CREATE_SESSION_RESPONSE:{
+      mme_app_overload_s11_response ();
+      mme_app_handle_create_sess_resp (&received_message_p->ittiMsg.s11_create_session_response);
+    }
+    break;
+
+  case S11_MODIFY_BEARER_RESPONSE:{
+      mme_app_overload_s11_response ();
+      ue_context_p = mme_ue_context_exists_s11_teid (&mme_app_desc.mme_ue_contexts, received_message_p->ittiMsg.s11_modify_bearer_response.teid);
+
+      if (ue_context_p == NULL) {
+        MSC_LOG_RX_DISCARDED_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 MODIFY_BEARER_RESPONSE local S11 teid " TEID_FMT " ",
+          received_message_p->ittiMsg.s11_modify_bearer_response.teid);
+        OAILOG_WARNING (LOG_MME_APP, "We didn't find this teid in list of UE: %08x\n", received_message_p->ittiMsg.s11_modify_bearer_response.teid);
+      } else {
+        MSC_LOG_RX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 MODIFY_BEARER_RESPONSE local S11 teid " TEID_FMT " IMSI " IMSI_64_FMT " ",
+          received_message_p->ittiMsg.s11_modify_bearer_response.teid, ue_context_p->imsi);
         /*
-         * We received the update location answer message from HSS -> Handle it
+         * Updating statistics
          */
-        mme_app_handle_s6a_update_location_ans (&received_message_p->ittiMsg.s6a_update_location_ans);
+        update_mme_app_stats_s1u_bearer_add();
       }
-      break;
-
-    case S11_CREATE_SESSION_RESPONSE:{
-        mme_app_handle_create_sess_resp (&received_message_p->ittiMsg.s11_create_session_response);
-      }
-      break;
-
-    case S11_MODIFY_BEARER_RESPONSE:{
-        ue_context_p = mme_ue_context_exists_s11_teid (&mme_app_desc.mme_ue_contexts, received_message_p->ittiMsg.s11_modify_bearer_response.teid);
+    }
+    break;
 
-        if (ue_context_p == NULL) {
-          MSC_LOG_RX_DISCARDED_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 MODIFY_BEARER_RESPONSE local S11 teid " TEID_FMT " ",
-            received_message_p->ittiMsg.s11_modify_bearer_response.teid);
-          OAILOG_WARNING (LOG_MME_APP, "We didn't find this teid in list of UE: %08x\n", received_message_p->ittiMsg.s11_modify_bearer_response.teid);
-        } else {
-          MSC_LOG_RX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 MODIFY_BEARER_RESPONSE local S11 teid " TEID_FMT " IMSI " IMSI_64_FMT " ",
-            received_message_p->ittiMsg.s11_modify_bearer_response.teid, ue_context_p->imsi);
-          /*
-           * Updating statistics
-           */
-          update_mme_app_stats_s1u_bearer_add();
-        }
-      }
-      break;
+  case S11_RELEASE_ACCESS_BEARERS_RESPONSE:{
+      mme_app_overload_s11_response ();
+      mme_app_handle_release_access_bearers_resp (&received_message_p->ittiMsg.s11_release_access_bearers_response);
+    }
+    break;
 
-    case S11_RELEASE_ACCESS_BEARERS_RESPONSE:{
-        mme_app_handle_release_access_bearers_resp (&received_message_p->ittiMsg.s11_release_access_bearers_response);
-      }
-      break;
+  case S11_DOWNLINK_DATA_NOTIFICATION:{
+      mme_app_handle_downlink_data_notification (&received_message_p->ittiMsg.s11_downlink_data_notification);
+    }
+    break;
 
-    case S11_DELETE_SESSION_RESPONSE: {
-        mme_app_handle_delete_session_rsp (&received_message_p->ittiMsg.s11_delete_session_response);
-      }
-      break;
+  case S11_DELETE_SESSION_RESPONSE: {
+      mme_app_overload_s11_response ();
+      mme_app_handle_delete_session_rsp (&received_message_p->ittiMsg.s11_delete_session_response);
+    }
+    break;
 
-    case NAS_PDN_CONNECTIVITY_REQ:{
-        mme_app_handle_nas_pdn_connectivity_req (&received_message_p->ittiMsg.nas_pdn_connectivity_req);
-      }
-      break;
+  case NAS_PDN_CONNECTIVITY_REQ:{
+      mme_app_handle_nas_pdn_connectivity_req (&received_message_p->ittiMsg.nas_pdn_connectivity_req);
+    }
+    break;
 
-    case NAS_DETACH_REQ: {
-        mme_app_handle_detach_req(&received_message_p->ittiMsg.nas_detach_req);
-      }
-      break;
+  case NAS_DETACH_REQ: {
+      mme_app_handle_detach_req(&received_message_p->ittiMsg.nas_detach_req);
+    }
+    break;
 
-    case NAS_CONNECTION_ESTABLISHMENT_CNF:{
-        mme_app_handle_conn_est_cnf (&NAS_CONNECTION_ESTABLISHMENT_CNF (received_message_p));
-      }
-      break;
+  case NAS_CONNECTION_ESTABLISHMENT_CNF:{
+      mme_app_handle_conn_est_cnf (&NAS_CONNECTION_ESTABLISHMENT_CNF (received_message_p));
+    }
+    break;
 
-      // From S1AP Initiating Message/EMM Attach Request
-    case MME_APP_INITIAL_UE_MESSAGE:{
-        mme_app_handle_initial_ue_message (&MME_APP_INITIAL_UE_MESSAGE (received_message_p));
-      }
-      break;
+    // From S1AP Initiating Message/EMM Attach Request
+  case MME_APP_INITIAL_UE_MESSAGE:{
+      mme_app_handle_initial_ue_message (&MME_APP_INITIAL_UE_MESSAGE (received_message_p));
+    }
+    break;
 
-    case MME_APP_INITIAL_CONTEXT_SETUP_RSP:{
-        mme_app_handle_initial_context_setup_rsp (&MME_APP_INITIAL_CONTEXT_SETUP_RSP (received_message_p));
-      }
-      break;
+  case MME_APP_INITIAL_CONTEXT_SETUP_RSP:{
+      mme_app_handle_initial_context_setup_rsp (&MME_APP_INITIAL_CONTEXT_SETUP_RSP (received_message_p));
+    }
+    break;
 
-    case TIMER_HAS_EXPIRED:{
-        /*
-         * Check statistic timer
-         */
-        if (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.statistic_timer_id) {
-          mme_app_statistics_display ();
-        } else if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
-          mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
-          ue_context_p = mme_ue_context_exists_mme_ue_s1ap_id (&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id);
-          if (ue_context_p == NULL) {
-            OAILOG_WARNING (LOG_MME_APP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
-            break;
-          }
-          if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->mobile_reachability_timer.id) {
-            // Mobile Reachability Timer expiry handler 
-            mme_app_handle_mobile_reachability_timer_expiry (ue_context_p);
-          } else if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->implicit_detach_timer.id) {
-            // Implicit Detach Timer expiry handler 
-            mme_app_handle_implicit_detach_timer_expiry (ue_context_p);
-          }
+  case TIMER_HAS_EXPIRED:{
+      /*
+       * Check statistic timer
+       */
+      if (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.statistic_timer_id) {
+        mme_app_statistics_display ();
+        itti_release_idle_memory ();
+      } else if (received_message_p->ittiMsg.timer_has_expired.timer_id == mme_app_desc.overload_timer_id) {
+        mme_app_overload_evaluate ();
+      } else if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
+        mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
+        ue_context_p = mme_ue_context_exists_mme_ue_s1ap_id (&mme_app_desc.mme_ue_contexts, mme_ue_s1ap_id);
+        if (ue_context_p == NULL) {
+          OAILOG_WARNING (LOG_MME_APP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
+          break;
+        }
+        if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->mobile_reachability_timer.id) {
+          // Mobile Reachability Timer expiry handler 
+          mme_app_handle_mobile_reachability_timer_expiry (ue_context_p);
+        } else if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->implicit_detach_timer.id) {
+          // Implicit Detach Timer expiry handler 
+          mme_app_handle_implicit_detach_timer_expiry (ue_context_p);
+        } else if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_context_p->paging_timer.id) {
+          // Paging Timer expiry handler
+          mme_app_handle_paging_timer_expiry (ue_context_p);
         }
       }
-      break;
+    }
+    break;
 
-    case TERMINATE_MESSAGE:{
-        /*
-         * Termination message received TODO -> release any data allocated
-         */
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl);
-        hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl);
-        obj_hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl);
-        itti_exit_task ();
-      }
-      break;
+  case STATISTICS_MESSAGE:{
+      mme_app_statistics_display ();
+      mme_app_statistics_display_hashtables ();
+    }
+    break;
 
-    case S1AP_UE_CAPABILITIES_IND:{
-        mme_app_handle_s1ap_ue_capabilities_ind (&received_message_p->ittiMsg.s1ap_ue_cap_ind);
-      }
-      break;
+  case TERMINATE_MESSAGE:{
+      /*
+       * Termination message received TODO -> release any data allocated
+       */
+      hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl);
+      hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl);
+      hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl);
+      hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl);
+      obj_hashtable_ts_destroy (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl);
+      itti_exit_task ();
+    }
+    break;
 
-    case S1AP_UE_CONTEXT_RELEASE_REQ:{
-        mme_app_handle_s1ap_ue_context_release_req (&received_message_p->ittiMsg.s1ap_ue_context_release_req);
-      }
-      break;
+  case S1AP_UE_CAPABILITIES_IND:{
+      mme_app_handle_s1ap_ue_capabilities_ind (&received_message_p->ittiMsg.s1ap_ue_cap_ind);
+    }
+    break;
 
-    case S1AP_UE_CONTEXT_RELEASE_COMPLETE:{
-        mme_app_handle_s1ap_ue_context_release_complete (&received_message_p->ittiMsg.s1ap_ue_context_release_complete);
-      }
-      break;
+  case S1AP_UE_CONTEXT_RELEASE_REQ:{
+      mme_app_handle_s1ap_ue_context_release_req (&received_message_p->ittiMsg.s1ap_ue_context_release_req);
+    }
+    break;
 
-    case NAS_DOWNLINK_DATA_REQ: {
-        mme_app_handle_nas_dl_req (&received_message_p->ittiMsg.nas_dl_data_req);
-      }
-      break;
+  case S1AP_UE_CONTEXT_RELEASE_COMPLETE:{
+      mme_app_handle_s1ap_ue_context_release_complete (&received_message_p->ittiMsg.s1ap_ue_context_release_complete);
+    }
+    break;
 
-    case S1AP_ENB_DEREGISTERED_IND: {
-        mme_app_handle_enb_deregister_ind(&received_message_p->ittiMsg.s1ap_eNB_deregistered_ind);
+  case NAS_DOWNLINK_DATA_REQ: {
+      mme_app_handle_nas_dl_req (&received_message_p->ittiMsg.nas_dl_data_req);
     }
     break;
 
-    default:{
-        OAILOG_DEBUG (LOG_MME_APP, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
-        AssertFatal (0, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
-      }
-      break;
+  case S1AP_ENB_DEREGISTERED_IND: {
+      mme_app_handle_enb_deregister_ind(&received_message_p->ittiMsg.s1ap_eNB_deregistered_ind);
+  }
+  break;
+
+  default:{
+      OAILOG_DEBUG (LOG_MME_APP, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+      AssertFatal (0, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
     }
+    break;
+  }
+
+  mme_app_ue_handle_close ();
+  itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+}
+
+//------------------------------------------------------------------------------
+void *mme_app_thread (
+  void *args)
+{
+  itti_mark_task_ready (TASK_MME_APP);
+  MSC_START_USE ();
 
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+  while (1) {
+    MessageDef                             *received_message_p = NULL;
+
+    /*
+     * Trying to fetch a message from the message queue.
+     * If the queue is empty, this function will block till a
+     * message is sent to the task.
+     */
+    itti_receive_msg (TASK_MME_APP, &received_message_p);
+    mme_app_handle_message (received_message_p);
   }
 
   return NULL;
 }
 
+//------------------------------------------------------------------------------
+// Spread the MME tasks of the uplink procedure chain over the shards, to be called before the tasks are created
+void
+mme_app_set_task_shards (
+  const uint32_t shards)
+{
+  static const task_id_t                  mme_tasks[] = {TASK_S1AP, TASK_NAS_MME, TASK_MME_APP, TASK_S6A, TASK_S11};
+  int                                     i = 0;
+
+  if (shards) {
+    OAILOG_WARNING (LOG_MME_APP, "ITTI shards are experimental, not yet compared with one thread per task under an attach storm\n");
+  }
+  for (i = 0; i < sizeof (mme_tasks) / sizeof (mme_tasks[0]); i++) {
+    itti_set_task_shard (mme_tasks[i], (shards) ? (i % shards) + 1 : 0);
+    if (shards) {
+      OAILOG_INFO (LOG_MME_APP, "Task %s runs to completion in shard %u\n", itti_get_task_name (mme_tasks[i]), itti_get_task_shard (mme_tasks[i]));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
 int
 mme_app_init (
   const mme_config_t * mme_config_p)
@@ -226,14 +280,37 @@ mme_app_init (
   mme_app_desc.mme_ue_contexts.guti_ue_context_htbl = obj_hashtable_ts_create (mme_config.max_ues, NULL, hash_free_int_func, hash_free_int_func, b);
   bdestroy(b);
 
+  if (mme_app_m_tmsi_pool_init (mme_config.max_ues, mme_config.m_tmsi.prefix, mme_config.m_tmsi.prefix_bits) < 0) {
+    OAILOG_ERROR (LOG_MME_APP, "MME APP M-TMSI pool init failed\n");
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+
+  if (mme_config_p->ipv4.sgw_s11) {
+    mme_app_desc.s11_task_id = TASK_S11;
+  } else {
+    mme_app_desc.s11_task_id = TASK_SPGW_APP;
+    OAILOG_INFO (LOG_MME_APP, "No SGW S11 address, S11 requests sent to the S-GW task of this process\n");
+  }
+
+  if (mme_app_paging_init (mme_config_p) < 0) {
+    OAILOG_ERROR (LOG_MME_APP, "MME APP paging init failed\n");
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+
+  if (mme_app_overload_init (mme_config_p) < 0) {
+    OAILOG_ERROR (LOG_MME_APP, "MME APP overload control init failed\n");
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+
   /*
    * Create the thread associated with MME applicative layer
    */
-  if (itti_create_task (TASK_MME_APP, &mme_app_thread, NULL) < 0) {
+  if (itti_create_task_handler (TASK_MME_APP, &mme_app_thread, &mme_app_handle_message, NULL) < 0) {
     OAILOG_ERROR (LOG_MME_APP, "MME APP create task failed\n");
     OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
   }
 
+  itti_set_statistics_task (TASK_MME_APP);
   mme_app_desc.statistic_timer_period = mme_config_p->mme_statistic_timer;
 
   /*
@@ -244,6 +321,14 @@ mme_app_init (
     mme_app_desc.statistic_timer_id = 0;
   }
 
+  if (mme_config_p->overload_config.timer_ms) {
+    if (timer_setup (mme_config_p->overload_config.timer_ms / 1000, (mme_config_p->overload_config.timer_ms % 1000) * 1000,
+          TASK_MME_APP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &mme_app_desc.overload_timer_id) < 0) {
+      OAILOG_ERROR (LOG_MME_APP, "Failed to request new timer for overload control with %ums of periodicity\n", mme_config_p->overload_config.timer_ms);
+      mme_app_desc.overload_timer_id = 0;
+    }
+  }
+
   OAILOG_DEBUG (LOG_MME_APP, "Initializing MME applicative layer: DONE\n");
   OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
 }
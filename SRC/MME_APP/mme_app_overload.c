@@ -0,0 +1,209 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file mme_app_overload.c
+   \brief MME overload control, see mme_app_overload.h.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "assertions.h"
+#include "common_types.h"
+#include "log.h"
+#include "msc.h"
+#include "intertask_interface.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_app_overload.h"
+
+/* Tasks on the path of the UE procedures, their queues are watched */
+static const task_id_t mme_app_overload_tasks[] = {TASK_SCTP, TASK_S1AP, TASK_MME_APP, TASK_NAS_MME, TASK_S6A, TASK_S11};
+#define MME_APP_OVERLOAD_NB_TASKS ((int)(sizeof (mme_app_overload_tasks) / sizeof (mme_app_overload_tasks[0])))
+
+static const char * const mme_app_overload_interface2string[MME_APP_OVERLOAD_INTERFACE_MAX] = {"S6a transactions", "S11 transactions"};
+
+typedef struct mme_app_overload_s {
+  // configuration
+  uint32_t                    start_load;
+  uint32_t                    stop_load;
+  uint32_t                    max_transactions[MME_APP_OVERLOAD_INTERFACE_MAX];
+  uint32_t                    max_ues;
+  overload_action_t           action;
+  // state, the transactions are updated by the S6A and S11 tasks, the Initial UE Messages by the S1AP task, the rest by the MME_APP task
+  mme_app_overload_stats_t    stats;
+} mme_app_overload_t;
+
+static mme_app_overload_t              g_mme_app_overload = {0};
+
+//------------------------------------------------------------------------------
+int mme_app_overload_init (const mme_config_t * mme_config_p)
+{
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  memset (&g_mme_app_overload, 0, sizeof (g_mme_app_overload));
+  g_mme_app_overload.start_load = mme_config_p->overload_config.start_load;
+  g_mme_app_overload.stop_load = mme_config_p->overload_config.stop_load;
+  g_mme_app_overload.max_transactions[MME_APP_OVERLOAD_S6A] = mme_config_p->overload_config.max_s6a_transactions;
+  g_mme_app_overload.max_transactions[MME_APP_OVERLOAD_S11] = mme_config_p->overload_config.max_s11_transactions;
+  g_mme_app_overload.max_ues = mme_config_p->max_ues;
+  g_mme_app_overload.action = mme_config_p->overload_config.action;
+  if ((g_mme_app_overload.stop_load >= g_mme_app_overload.start_load) || (0 == g_mme_app_overload.max_ues) ||
+      (0 == g_mme_app_overload.max_transactions[MME_APP_OVERLOAD_S6A]) || (0 == g_mme_app_overload.max_transactions[MME_APP_OVERLOAD_S11])) {
+    OAILOG_ERROR (LOG_MME_APP, "Invalid overload control thresholds\n");
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+  OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_transaction_start (const mme_app_overload_interface_t interface)
+{
+  __atomic_add_fetch (&g_mme_app_overload.stats.transactions[interface], 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_transaction_end (const mme_app_overload_interface_t interface)
+{
+  uint32_t                                transactions = __atomic_load_n (&g_mme_app_overload.stats.transactions[interface], __ATOMIC_RELAXED);
+
+  // an answer to a request sent before the counting started must not wrap the counter
+  while ((transactions) &&
+         (!__atomic_compare_exchange_n (&g_mme_app_overload.stats.transactions[interface], &transactions, transactions - 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)));
+}
+
+//------------------------------------------------------------------------------
+int mme_app_overload_send_s11_request (MessageDef * const message_p)
+{
+  // the S11 task counts the requests it sends to a remote S-GW
+  if (TASK_S11 == mme_app_desc.s11_task_id) {
+    return itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  }
+  // counted before the S-GW task may answer
+  mme_app_overload_transaction_start (MME_APP_OVERLOAD_S11);
+  if (itti_send_msg_to_task (mme_app_desc.s11_task_id, INSTANCE_DEFAULT, message_p) < 0) {
+    mme_app_overload_transaction_end (MME_APP_OVERLOAD_S11);
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_s11_response (void)
+{
+  if (TASK_S11 != mme_app_desc.s11_task_id) {
+    mme_app_overload_transaction_end (MME_APP_OVERLOAD_S11);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint64_t mme_app_overload_initial_ue_message (const bool is_admitted)
+{
+  if (is_admitted) {
+    __atomic_add_fetch (&g_mme_app_overload.stats.nb_admitted, 1, __ATOMIC_RELAXED);
+    return __atomic_load_n (&g_mme_app_overload.stats.nb_dropped, __ATOMIC_RELAXED);
+  }
+  return __atomic_add_fetch (&g_mme_app_overload.stats.nb_dropped, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+uint32_t mme_app_overload_load (const char ** source)
+{
+  const char                             *max_source = "none";
+  uint32_t                                max_load = 0;
+  uint32_t                                load = 0;
+  uint32_t                                size = 0;
+
+  for (int i = 0; i < MME_APP_OVERLOAD_NB_TASKS; i++) {
+    if (0 == (size = itti_get_task_queue_size (mme_app_overload_tasks[i]))) {
+      continue;
+    }
+    load = (uint32_t)(((uint64_t) itti_get_task_queue_depth (mme_app_overload_tasks[i]) * 100) / size);
+    if (load > max_load) {
+      max_load = load;
+      max_source = itti_get_task_name (mme_app_overload_tasks[i]);
+    }
+  }
+  for (int i = 0; i < MME_APP_OVERLOAD_INTERFACE_MAX; i++) {
+    load = (uint32_t)(((uint64_t) __atomic_load_n (&g_mme_app_overload.stats.transactions[i], __ATOMIC_RELAXED) * 100) / g_mme_app_overload.max_transactions[i]);
+    if (load > max_load) {
+      max_load = load;
+      max_source = mme_app_overload_interface2string[i];
+    }
+  }
+  if (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl) {
+    load = (uint32_t)(((uint64_t) mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl->num_elements * 100) / g_mme_app_overload.max_ues);
+    if (load > max_load) {
+      max_load = load;
+      max_source = "UE contexts";
+    }
+  }
+  if (source) {
+    *source = max_source;
+  }
+  return max_load;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_evaluate (void)
+{
+  MessageDef                             *message_p = NULL;
+  const char                             *source = NULL;
+  uint32_t                                load = mme_app_overload_load (&source);
+
+  g_mme_app_overload.stats.load = load;
+  if (load > g_mme_app_overload.stats.peak_load) {
+    g_mme_app_overload.stats.peak_load = load;
+  }
+  if ((!g_mme_app_overload.stats.is_overloaded) && (load >= g_mme_app_overload.start_load)) {
+    g_mme_app_overload.stats.is_overloaded = true;
+    g_mme_app_overload.stats.nb_start++;
+    OAILOG_WARNING (LOG_MME_APP, "Overload start: load %u%% (%s)\n", load, source);
+    message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_OVERLOAD_START);
+    S1AP_OVERLOAD_START (message_p).action = g_mme_app_overload.action;
+    S1AP_OVERLOAD_START (message_p).load_percent = load;
+    MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_OVERLOAD_START load %u%% (%s)", load, source);
+    itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  } else if ((g_mme_app_overload.stats.is_overloaded) && (load <= g_mme_app_overload.stop_load)) {
+    g_mme_app_overload.stats.is_overloaded = false;
+    g_mme_app_overload.stats.nb_stop++;
+    OAILOG_WARNING (LOG_MME_APP, "Overload stop: load %u%% (%s)\n", load, source);
+    message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_OVERLOAD_STOP);
+    S1AP_OVERLOAD_STOP (message_p).load_percent = load;
+    MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_OVERLOAD_STOP load %u%% (%s)", load, source);
+    itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_overload_get_stats (mme_app_overload_stats_t * const stats)
+{
+  *stats = g_mme_app_overload.stats;
+  for (int i = 0; i < MME_APP_OVERLOAD_INTERFACE_MAX; i++) {
+    stats->transactions[i] = __atomic_load_n (&g_mme_app_overload.stats.transactions[i], __ATOMIC_RELAXED);
+  }
+  stats->nb_admitted = __atomic_load_n (&g_mme_app_overload.stats.nb_admitted, __ATOMIC_RELAXED);
+  stats->nb_dropped = __atomic_load_n (&g_mme_app_overload.stats.nb_dropped, __ATOMIC_RELAXED);
+}
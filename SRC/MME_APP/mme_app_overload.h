@@ -0,0 +1,94 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_overload.h
+   \brief MME overload control (TS 23.401 4.3.7.4.1).
+   The load of the MME, in percent, is the highest of:
+   - messages waiting in the ITTI queue of a MME task, over the size of the queue,
+   - S6a and S11 requests without answer, over their configured maximum,
+   - UE contexts, over MAXUE.
+   The MME_APP task evaluates it periodically. When it reaches the start load, S1AP is asked to send
+   OVERLOAD START to all eNBs and to drop the Initial UE Messages the overload action rejects; when it
+   falls back under the stop load, S1AP is asked to send OVERLOAD STOP.
+   The S6A and S11 tasks count their transactions with mme_app_overload_transaction_start/end(). When the S-GW
+   runs in this process, MME_APP counts the S11 transactions itself, with mme_app_overload_send_s11_request()
+   and mme_app_overload_s11_response(). S1AP counts
+   the Initial UE Messages it admits or drops while overloaded with mme_app_overload_initial_ue_message().
+*/
+
+#ifndef FILE_MME_APP_OVERLOAD_SEEN
+#define FILE_MME_APP_OVERLOAD_SEEN
+
+#include "mme_config.h"
+
+typedef enum {
+  MME_APP_OVERLOAD_S6A = 0,
+  MME_APP_OVERLOAD_S11,
+  MME_APP_OVERLOAD_INTERFACE_MAX
+} mme_app_overload_interface_t;
+
+typedef struct mme_app_overload_stats_s {
+  bool                        is_overloaded;
+  uint32_t                    load;             // percent, at the last evaluation
+  uint32_t                    peak_load;        // percent, highest evaluated
+  uint32_t                    transactions[MME_APP_OVERLOAD_INTERFACE_MAX];  // without answer
+  uint32_t                    nb_start;         // OVERLOAD START sent
+  uint32_t                    nb_stop;          // OVERLOAD STOP sent
+  uint64_t                    nb_admitted;      // Initial UE Messages admitted while overloaded
+  uint64_t                    nb_dropped;       // Initial UE Messages dropped while overloaded
+} mme_app_overload_stats_t;
+
+/** \brief Reads the thresholds of the overload control
+ * @returns -1 in case of failure
+ **/
+int mme_app_overload_init(const mme_config_t * mme_config_p);
+
+/** \brief A request is sent on an interface, thread safe */
+void mme_app_overload_transaction_start(const mme_app_overload_interface_t interface);
+
+/** \brief A request is answered, or timed out, on an interface, thread safe */
+void mme_app_overload_transaction_end(const mme_app_overload_interface_t interface);
+
+/** \brief Sends a S11 request of MME_APP to the S11 task, or to the S-GW task of this process, MME_APP task only
+ * @returns -1 in case of failure
+ **/
+int mme_app_overload_send_s11_request(MessageDef * const message_p);
+
+/** \brief MME_APP received the response to a S11 request, MME_APP task only */
+void mme_app_overload_s11_response(void);
+
+/** \brief An Initial UE Message is admitted or dropped while overloaded, thread safe
+ * @returns the number of Initial UE Messages dropped so far
+ **/
+uint64_t mme_app_overload_initial_ue_message(const bool is_admitted);
+
+/** \brief Current load of the MME
+ * \param source Set to the name of the most loaded resource, may be NULL
+ * @returns the load in percent, may exceed 100
+ **/
+uint32_t mme_app_overload_load(const char ** source);
+
+/** \brief Evaluates the load and starts or stops the overload of the eNBs, MME_APP task only */
+void mme_app_overload_evaluate(void);
+
+void mme_app_overload_get_stats(mme_app_overload_stats_t * const stats);
+
+#endif /* FILE_MME_APP_OVERLOAD_SEEN */
@@ -0,0 +1,275 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file mme_app_paging.c
+   \brief Paging of idle UEs on downlink data, with T3413 retransmissions on a widening area:
+          last visited TAI, then the TAI list of the UE, then all TAIs served by the MME.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "assertions.h"
+#include "common_types.h"
+#include "conversions.h"
+#include "msc.h"
+#include "log.h"
+#include "intertask_interface.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_config.h"
+#include "timer.h"
+
+/* Paging areas, one per attempt */
+enum {
+  MME_APP_PAGING_LAST_TAI = 0,
+  MME_APP_PAGING_UE_TAI_LIST,
+  MME_APP_PAGING_SERVED_TAI_LIST,
+  MME_APP_PAGING_MAX_ATTEMPTS
+};
+
+/* All TAIs served by the MME, built from the configuration at init, only read after */
+static tai_list_t                       g_mme_app_paging_served_tai_list = {0};
+
+//------------------------------------------------------------------------------
+int
+mme_app_paging_init (
+  const mme_config_t * mme_config_p)
+{
+  tai_list_t                             *tai_list = &g_mme_app_paging_served_tai_list;
+
+  memset (tai_list, 0, sizeof (*tai_list));
+  if (mme_config_p->served_tai.nb_tai > TAI_LIST_MAX_SIZE) {
+    OAILOG_WARNING (LOG_MME_APP, "Paging on the first %d of the %u served TAIs\n", TAI_LIST_MAX_SIZE, mme_config_p->served_tai.nb_tai);
+  }
+  for (int i = 0; (i < mme_config_p->served_tai.nb_tai) && (i < TAI_LIST_MAX_SIZE); i++) {
+    tai_t                                *tai = &tai_list->tai[tai_list->n_tais];
+
+    tai->plmn.mcc_digit1 = (mme_config_p->served_tai.plmn_mcc[i] / 100) % 10;
+    tai->plmn.mcc_digit2 = (mme_config_p->served_tai.plmn_mcc[i] / 10) % 10;
+    tai->plmn.mcc_digit3 = mme_config_p->served_tai.plmn_mcc[i] % 10;
+    if (mme_config_p->served_tai.plmn_mnc_len[i] == 2) {
+      tai->plmn.mnc_digit1 = (mme_config_p->served_tai.plmn_mnc[i] / 10) % 10;
+      tai->plmn.mnc_digit2 = mme_config_p->served_tai.plmn_mnc[i] % 10;
+      tai->plmn.mnc_digit3 = 0xf;
+    } else if (mme_config_p->served_tai.plmn_mnc_len[i] == 3) {
+      tai->plmn.mnc_digit1 = (mme_config_p->served_tai.plmn_mnc[i] / 100) % 10;
+      tai->plmn.mnc_digit2 = (mme_config_p->served_tai.plmn_mnc[i] / 10) % 10;
+      tai->plmn.mnc_digit3 = mme_config_p->served_tai.plmn_mnc[i] % 10;
+    } else {
+      OAILOG_ERROR (LOG_MME_APP, "Bad MNC length %u of served TAI %d\n", mme_config_p->served_tai.plmn_mnc_len[i], i);
+      return RETURNerror;
+    }
+    tai->tac = mme_config_p->served_tai.tac[i];
+    tai_list->n_tais++;
+  }
+  tai_list->list_type = mme_config_p->served_tai.list_type;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+// Returns the paging area actually used, a narrower one may be skipped when unknown
+static int
+mme_app_paging_tai_list (
+  const struct ue_context_s * const ue_context_p,
+  const int attempt,
+  tai_list_t * const tai_list)
+{
+  memset (tai_list, 0, sizeof (*tai_list));
+  switch (attempt) {
+  case MME_APP_PAGING_LAST_TAI:
+    if (TAI_IS_VALID (ue_context_p->last_tai)) {
+      tai_list->tai[tai_list->n_tais++] = ue_context_p->last_tai;
+      return MME_APP_PAGING_LAST_TAI;
+    }
+    // no break
+
+  case MME_APP_PAGING_UE_TAI_LIST:
+    if (ue_context_p->tai_list.n_tais) {
+      *tai_list = ue_context_p->tai_list;
+      return MME_APP_PAGING_UE_TAI_LIST;
+    }
+    // no break
+
+  case MME_APP_PAGING_SERVED_TAI_LIST:
+  default:
+    *tai_list = g_mme_app_paging_served_tai_list;
+    return MME_APP_PAGING_SERVED_TAI_LIST;
+  }
+}
+
+//------------------------------------------------------------------------------
+// No response expected (TS 29.274 7.2.11.3), the S-GW discards the downlink data buffered for the UE
+static void
+mme_app_paging_send_ddn_failure_indication (
+  const struct ue_context_s * const ue_context_p,
+  const SGWCause_t cause)
+{
+  MessageDef                             *message_p = NULL;
+  itti_s11_downlink_data_notification_failure_indication_t *failure_ind_p = NULL;
+
+  message_p = itti_alloc_new_message (TASK_MME_APP, S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION);
+  failure_ind_p = &S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION (message_p);
+  failure_ind_p->teid = ue_context_p->sgw_s11_teid;
+  failure_ind_p->local_teid = ue_context_p->mme_s11_teid;
+  failure_ind_p->cause = cause;
+  failure_ind_p->originating_node = NODE_TYPE_MME;
+  failure_ind_p->peer_ip = mme_config.ipv4.sgw_s11;
+  MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION teid " TEID_FMT " cause %u",
+      failure_ind_p->teid, failure_ind_p->cause);
+  itti_send_msg_to_task (mme_app_desc.s11_task_id, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static int
+mme_app_paging_send (
+  struct ue_context_s *ue_context_p)
+{
+  MessageDef                             *message_p = NULL;
+  itti_s1ap_paging_request_t             *paging_p = NULL;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  message_p = itti_alloc_new_message (TASK_MME_APP, S1AP_PAGING_REQUEST);
+  paging_p = &S1AP_PAGING_REQUEST (message_p);
+  paging_p->mme_ue_s1ap_id = ue_context_p->mme_ue_s1ap_id;
+  paging_p->mme_code = ue_context_p->guti.gummei.mme_code;
+  paging_p->m_tmsi = ue_context_p->guti.m_tmsi;
+  // UE_ID = IMSI mod 1024 (TS 36.304 7.1)
+  paging_p->ue_identity_index = (uint16_t)(ue_context_p->imsi % 1024);
+  ue_context_p->paging_attempt = (uint8_t) mme_app_paging_tai_list (ue_context_p, ue_context_p->paging_attempt, &paging_p->tai_list);
+  if (0 == paging_p->tai_list.n_tais) {
+    OAILOG_WARNING (LOG_MME_APP, "No TAI to page UE id " MME_UE_S1AP_ID_FMT "\n", ue_context_p->mme_ue_s1ap_id);
+    itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+  OAILOG_INFO (LOG_MME_APP, "Paging UE id " MME_UE_S1AP_ID_FMT " attempt %u on %u TAIs\n",
+      ue_context_p->mme_ue_s1ap_id, ue_context_p->paging_attempt, paging_p->tai_list.n_tais);
+  MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S1AP_MME, NULL, 0, "0 S1AP_PAGING_REQUEST ue id " MME_UE_S1AP_ID_FMT " attempt %u ",
+      ue_context_p->mme_ue_s1ap_id, ue_context_p->paging_attempt);
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+
+  ue_context_p->paging_timer.sec = mme_config.nas_config.t3413_sec;
+  if (timer_setup (ue_context_p->paging_timer.sec, 0, TASK_MME_APP, INSTANCE_DEFAULT, TIMER_ONE_SHOT, (void *)&(ue_context_p->mme_ue_s1ap_id), &(ue_context_p->paging_timer.id)) < 0) {
+    OAILOG_ERROR (LOG_MME_APP, "Failed to start Paging timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
+    ue_context_p->paging_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  }
+  OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+int
+mme_app_paging_request (
+  struct ue_context_s *ue_context_p)
+{
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  DevAssert (ue_context_p != NULL);
+  if (ECM_CONNECTED == ue_context_p->ecm_state) {
+    OAILOG_DEBUG (LOG_MME_APP, "UE id " MME_UE_S1AP_ID_FMT " is connected, no paging\n", ue_context_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+  }
+  if (MME_APP_TIMER_INACTIVE_ID != ue_context_p->paging_timer.id) {
+    OAILOG_DEBUG (LOG_MME_APP, "UE id " MME_UE_S1AP_ID_FMT " is already paged\n", ue_context_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNok);
+  }
+  if (!ue_context_p->is_guti_set) {
+    OAILOG_WARNING (LOG_MME_APP, "UE id " MME_UE_S1AP_ID_FMT " has no GUTI, cannot be paged\n", ue_context_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_MME_APP, RETURNerror);
+  }
+  ue_context_p->paging_attempt = MME_APP_PAGING_LAST_TAI;
+  OAILOG_FUNC_RETURN (LOG_MME_APP, mme_app_paging_send (ue_context_p));
+}
+
+//------------------------------------------------------------------------------
+void
+mme_app_paging_stop (
+  struct ue_context_s *ue_context_p)
+{
+  DevAssert (ue_context_p != NULL);
+  if (ue_context_p->paging_timer.id != MME_APP_TIMER_INACTIVE_ID) {
+    if (timer_remove (ue_context_p->paging_timer.id)) {
+      OAILOG_ERROR (LOG_MME_APP, "Failed to stop Paging timer for UE id  %d \n", ue_context_p->mme_ue_s1ap_id);
+    }
+    ue_context_p->paging_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  }
+  ue_context_p->paging_attempt = MME_APP_PAGING_LAST_TAI;
+}
+
+//------------------------------------------------------------------------------
+void
+mme_app_handle_paging_timer_expiry (
+  struct ue_context_s *ue_context_p)
+{
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  DevAssert (ue_context_p != NULL);
+  ue_context_p->paging_timer.id = MME_APP_TIMER_INACTIVE_ID;
+  OAILOG_DEBUG (LOG_MME_APP, "Expired- Paging timer for UE id  %d attempt %u\n", ue_context_p->mme_ue_s1ap_id, ue_context_p->paging_attempt);
+  if (ECM_CONNECTED == ue_context_p->ecm_state) {
+    ue_context_p->paging_attempt = MME_APP_PAGING_LAST_TAI;
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
+  if (ue_context_p->paging_attempt + 1 >= MME_APP_PAGING_MAX_ATTEMPTS) {
+    OAILOG_WARNING (LOG_MME_APP, "UE id " MME_UE_S1AP_ID_FMT " did not answer paging\n", ue_context_p->mme_ue_s1ap_id);
+    ue_context_p->paging_attempt = MME_APP_PAGING_LAST_TAI;
+    mme_app_paging_send_ddn_failure_indication (ue_context_p, UE_NOT_RESPONDING);
+    OAILOG_FUNC_OUT (LOG_MME_APP);
+  }
+  ue_context_p->paging_attempt++;
+  mme_app_paging_send (ue_context_p);
+  OAILOG_FUNC_OUT (LOG_MME_APP);
+}
+
+//------------------------------------------------------------------------------
+void
+mme_app_handle_downlink_data_notification (
+  const itti_s11_downlink_data_notification_t * const notif_pP)
+{
+  struct ue_context_s                    *ue_context_p = NULL;
+  MessageDef                             *message_p = NULL;
+  itti_s11_downlink_data_notification_acknowledge_t *ack_p = NULL;
+
+  OAILOG_FUNC_IN (LOG_MME_APP);
+  DevAssert (notif_pP != NULL);
+  message_p = itti_alloc_new_message (TASK_MME_APP, S11_DOWNLINK_DATA_NOTIFICATION_ACKNOWLEDGE);
+  ack_p = &message_p->ittiMsg.s11_downlink_data_notification_acknowledge;
+  ack_p->trxn = notif_pP->trxn;
+  ack_p->peer_ip = notif_pP->peer_ip;
+  ack_p->cause = REQUEST_ACCEPTED;
+
+  ue_context_p = mme_ue_context_exists_s11_teid (&mme_app_desc.mme_ue_contexts, notif_pP->teid);
+  if (ue_context_p == NULL) {
+    OAILOG_WARNING (LOG_MME_APP, "DOWNLINK_DATA_NOTIFICATION for unknown local S11 teid " TEID_FMT "\n", notif_pP->teid);
+    ack_p->teid = 0;
+    ack_p->cause = CONTEXT_NOT_FOUND;
+  } else {
+    ack_p->teid = ue_context_p->sgw_s11_teid;
+    OAILOG_DEBUG (LOG_MME_APP, "DOWNLINK_DATA_NOTIFICATION for UE id " MME_UE_S1AP_ID_FMT " ebi %u\n", ue_context_p->mme_ue_s1ap_id, notif_pP->eps_bearer_id);
+    if (mme_app_paging_request (ue_context_p) < 0) {
+      ack_p->cause = UNABLE_TO_PAGE_UE;
+    }
+  }
+  MSC_LOG_TX_MESSAGE (MSC_MMEAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_DOWNLINK_DATA_NOTIFICATION_ACKNOWLEDGE teid " TEID_FMT " cause %u",
+      ack_p->teid, ack_p->cause);
+  itti_send_msg_to_task (mme_app_desc.s11_task_id, INSTANCE_DEFAULT, message_p);
+  OAILOG_FUNC_OUT (LOG_MME_APP);
+}
@@ -21,15 +21,29 @@
 
 
 #include <stdio.h>
+#include <inttypes.h>
 
 #include "intertask_interface.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
 #include "mme_app_statistics.h"
+#include "mme_app_ue_handle.h"
+#include "mme_app_overload.h"
+#include "nas_pdu_copy.h"
+#include "emmData.h"
 
 int mme_app_statistics_display (
   void)
 {
+  mme_app_ue_handle_stats_t               ue_handle_stats = {0};
+  mme_app_overload_stats_t                overload_stats = {0};
+  nas_pdu_copy_stats_t                    nas_pdu_copy_stats = {0};
+  memory_pool_stats_t                     memory_pool_stats = {0};
+  uint32_t                                pool = 0;
+
+  mme_app_ue_handle_get_stats (&ue_handle_stats);
+  mme_app_overload_get_stats (&overload_stats);
+  nas_pdu_copy_get_stats (&nas_pdu_copy_stats);
   OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
   OAILOG_DEBUG (LOG_MME_APP, "               |   Current Status| Added since last display|  Removed since last display |\n");
   OAILOG_DEBUG (LOG_MME_APP, "Connected eNBs | %10u      |     %10u              |    %10u               |\n",mme_app_desc.nb_enb_connected,
@@ -42,6 +56,24 @@ int mme_app_statistics_display (
                                           mme_app_desc.nb_eps_bearers_established_since_last_stat,mme_app_desc.nb_eps_bearers_released_since_last_stat);
   OAILOG_DEBUG (LOG_MME_APP, "S1-U Bearers   | %10u      |     %10u              |    %10u               |\n\n",mme_app_desc.nb_s1u_bearers,
                                           mme_app_desc.nb_s1u_bearers_established_since_last_stat,mme_app_desc.nb_s1u_bearers_released_since_last_stat);
+  OAILOG_DEBUG (LOG_MME_APP, "UE lookups     |   MME_APP %10" PRIu64 " (probed %10" PRIu64 ") | EMM %10" PRIu64 " (probed %10" PRIu64 ")   |\n\n",
+                                          ue_handle_stats.mme_app_lookups, ue_handle_stats.mme_app_probes, ue_handle_stats.emm_lookups, ue_handle_stats.emm_probes);
+  OAILOG_DEBUG (LOG_MME_APP, "Load           | %10u%%     | peak %3u%% S6a %5u S11 %5u | %s start %5u stop %5u |\n",
+                                          overload_stats.load, overload_stats.peak_load, overload_stats.transactions[MME_APP_OVERLOAD_S6A],
+                                          overload_stats.transactions[MME_APP_OVERLOAD_S11], (overload_stats.is_overloaded) ? "OVERLOAD" : "normal  ",
+                                          overload_stats.nb_start, overload_stats.nb_stop);
+  OAILOG_DEBUG (LOG_MME_APP, "Overload UEs   | admitted %10" PRIu64 " | dropped Initial UE Messages %10" PRIu64 "               |\n\n",
+                                          overload_stats.nb_admitted, overload_stats.nb_dropped);
+  OAILOG_DEBUG (LOG_MME_APP, "Uplink NAS     | %10" PRIu64 "      | copied S1AP %10" PRIu64 " B  |    NAS %10" PRIu64 " B (%6.1f B/msg) |\n\n",
+                                          nas_pdu_copy_stats.uplink_messages, nas_pdu_copy_stats.bytes[NAS_PDU_COPY_S1AP],
+                                          nas_pdu_copy_stats.bytes[NAS_PDU_COPY_NAS], nas_pdu_copy_bytes_per_message (&nas_pdu_copy_stats));
+  for (pool = 0; 0 == itti_get_memory_pool_stats (pool, &memory_pool_stats); pool++) {
+    OAILOG_DEBUG (LOG_MME_APP, "ITTI pool %5u B| %6u/%6u items| high water %6u items  | %5u chunks %6zu KB peak %5u |\n",
+                                          memory_pool_stats.item_size, memory_pool_stats.items_allocated, memory_pool_stats.items_mapped,
+                                          memory_pool_stats.items_allocated_high_water, memory_pool_stats.chunks_mapped,
+                                          (memory_pool_stats.chunks_mapped * memory_pool_stats.chunk_size) / 1024, memory_pool_stats.chunks_mapped_high_water);
+  }
+  OAILOG_DEBUG (LOG_MME_APP, "\n");
   OAILOG_DEBUG (LOG_MME_APP, "======================================= STATISTICS ============================================\n\n");
   
   mme_stats_write_lock (&mme_app_desc);
@@ -63,6 +95,48 @@ int mme_app_statistics_display (
   return 0;
 }
 
+//------------------------------------------------------------------------------
+static void mme_app_statistics_display_hashtable (const char * const name, const hashtable_rc_t rc, const hashtable_stats_t * const stats)
+{
+  if (HASH_TABLE_OK != rc) {
+    return;
+  }
+  OAILOG_DEBUG (LOG_MME_APP, "%-24s| %8zu/%8zu load %5.2f | max chain %3zu | chains %zu %zu %zu %zu %zu %zu %zu %zu+ | resizes %3" PRIu64 " | lock waits %8" PRIu64 " %10.1f us |\n",
+      name, stats->num_elements, stats->size, (stats->size) ? (double)stats->num_elements / (double)stats->size : 0.0, stats->max_chain,
+      stats->chains[0], stats->chains[1], stats->chains[2], stats->chains[3], stats->chains[4], stats->chains[5], stats->chains[6], stats->chains[7],
+      stats->resizes, stats->lock_contentions, (double)stats->lock_wait_ns / 1e3);
+}
+
+//------------------------------------------------------------------------------
+// Walks through all the buckets of the UE collections, only on demand (SIGUSR2)
+int mme_app_statistics_display_hashtables (
+  void)
+{
+  hashtable_stats_t                       stats = {0};
+  hashtable_rc_t                          rc = HASH_TABLE_OK;
+
+  OAILOG_DEBUG (LOG_MME_APP, "======================================= HASHTABLES ============================================\n\n");
+  OAILOG_DEBUG (LOG_MME_APP, "Chains: number of buckets by length of their chain, from 0 to %d and longer\n", HASH_TABLE_STATS_CHAIN_LENGTHS - 1);
+  rc = hashtable_ts_get_stats (mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl, &stats);
+  mme_app_statistics_display_hashtable ("MME_APP IMSI", rc, &stats);
+  rc = hashtable_ts_get_stats (mme_app_desc.mme_ue_contexts.tun11_ue_context_htbl, &stats);
+  mme_app_statistics_display_hashtable ("MME_APP S11 TEID", rc, &stats);
+  rc = hashtable_ts_get_stats (mme_app_desc.mme_ue_contexts.mme_ue_s1ap_id_ue_context_htbl, &stats);
+  mme_app_statistics_display_hashtable ("MME_APP mme_ue_s1ap_id", rc, &stats);
+  rc = hashtable_ts_get_stats (mme_app_desc.mme_ue_contexts.enb_ue_s1ap_id_ue_context_htbl, &stats);
+  mme_app_statistics_display_hashtable ("MME_APP enb_ue_s1ap_id", rc, &stats);
+  rc = obj_hashtable_ts_get_stats (mme_app_desc.mme_ue_contexts.guti_ue_context_htbl, &stats);
+  mme_app_statistics_display_hashtable ("MME_APP GUTI", rc, &stats);
+  rc = hashtable_ts_get_stats (_emm_data.ctx_coll_ue_id, &stats);
+  mme_app_statistics_display_hashtable ("EMM ue_id", rc, &stats);
+  rc = hashtable_ts_get_stats (_emm_data.ctx_coll_imsi, &stats);
+  mme_app_statistics_display_hashtable ("EMM IMSI", rc, &stats);
+  rc = obj_hashtable_ts_get_stats (_emm_data.ctx_coll_guti, &stats);
+  mme_app_statistics_display_hashtable ("EMM GUTI", rc, &stats);
+  OAILOG_DEBUG (LOG_MME_APP, "======================================= HASHTABLES ============================================\n\n");
+  return 0;
+}
+
 /*********************************** Utility Functions to update Statistics**************************************/
 
 // Number of Connected eNBs 
@@ -25,6 +25,8 @@
 
 int mme_app_statistics_display(void);
 
+int mme_app_statistics_display_hashtables(void);
+
 /*********************************** Utility Functions to update Statistics**************************************/
 void update_mme_app_stats_connected_enb_add(void);
 void update_mme_app_stats_connected_enb_sub(void);
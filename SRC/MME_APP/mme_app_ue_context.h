@@ -156,7 +156,9 @@ typedef struct ue_context_s {
   // read by S6A UPDATE LOCATION REQUEST
   me_identity_t          me_identity;                 // not set/read except read by display utility
 
-  /* TODO: Add TAI list */
+  /* Paging area */
+  tai_t                  last_tai;                    // set by NAS_CONNECTION_ESTABLISHMENT_CNF, may be invalid
+  tai_list_t             tai_list;                    // set by NAS_CONNECTION_ESTABLISHMENT_CNF, may be empty
 
   /* Last known cell identity */
   ecgi_t                  e_utran_cgi;                 // set by nas_attach_req_t
@@ -212,6 +214,9 @@ typedef struct ue_context_s {
   struct mme_app_timer_t       mobile_reachability_timer; 
   // Implicit Detach Timer-Start at the expiry of Mobile Reachability timer. Stop when UE moves to connected state
   struct mme_app_timer_t       implicit_detach_timer; 
+  // Paging Timer (T3413)-Start when PAGING is sent. Stop when UE moves to connected state
+  struct mme_app_timer_t       paging_timer;
+  uint8_t                      paging_attempt;  // paging area widens at each attempt, see mme_app_paging.c
 
 } ue_context_t;
 
@@ -222,6 +227,7 @@ typedef struct mme_ue_context_s {
   hash_table_ts_t       *mme_ue_s1ap_id_ue_context_htbl;
   hash_table_ts_t       *enb_ue_s1ap_id_ue_context_htbl;
   obj_hash_table_t      *guti_ue_context_htbl;
+  uint64_t               mme_ue_s1ap_id_generation; // bumped on removal or re-keying in mme_ue_s1ap_id_ue_context_htbl, see mme_app_ue_handle.h
 } mme_ue_context_t;
 
 
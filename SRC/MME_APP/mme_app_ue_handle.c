@@ -0,0 +1,203 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file mme_app_ue_handle.c
+   \brief Per thread handle on the contexts of the UE an ITTI message is about, see mme_app_ue_handle.h.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "assertions.h"
+#include "common_types.h"
+#include "log.h"
+#include "mme_app_ue_context.h"
+#include "emmData.h"
+#include "mme_app_ue_handle.h"
+
+typedef struct mme_app_ue_handle_s {
+  bool                        is_open;          // an ITTI message is processed
+  mme_ue_s1ap_id_t            ue_id;            // UE of the contexts below
+  struct ue_context_s        *ue_context;       // NULL if not probed yet
+  struct emm_data_context_s  *emm_context;      // NULL if not probed yet
+  uint64_t                    ue_context_generation;  // of the MME_APP UE collection when ue_context was probed
+  uint64_t                    emm_context_generation; // of the EMM UE collection when emm_context was probed
+  uint64_t                    probe_generation;       // of the collection probed after the last miss
+} mme_app_ue_handle_t;
+
+// counters of one thread, on their own cache line, written by their thread only and summed by mme_app_ue_handle_get_stats()
+typedef struct mme_app_ue_handle_thread_stats_s {
+  mme_app_ue_handle_stats_t                 stats;
+  struct mme_app_ue_handle_thread_stats_s  *next;
+} __attribute__ ((aligned (64))) mme_app_ue_handle_thread_stats_t;
+
+static __thread mme_app_ue_handle_t                 mme_app_ue_handle = {.is_open = false, .ue_id = INVALID_MME_UE_S1AP_ID};
+static __thread mme_app_ue_handle_thread_stats_t   *mme_app_ue_handle_thread_stats_p = NULL;
+static pthread_mutex_t                              mme_app_ue_handle_thread_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static mme_app_ue_handle_thread_stats_t            *mme_app_ue_handle_thread_stats = NULL;  // never freed, the counts of exited threads remain
+
+//------------------------------------------------------------------------------
+static mme_app_ue_handle_stats_t * mme_app_ue_handle_new_thread_stats (void)
+{
+  mme_app_ue_handle_thread_stats_t       *thread_stats = NULL;
+
+  AssertFatal (0 == posix_memalign ((void **)&thread_stats, 64, sizeof (*thread_stats)), "Could not allocate the UE handle counters of the thread\n");
+  memset (thread_stats, 0, sizeof (*thread_stats));
+  pthread_mutex_lock (&mme_app_ue_handle_thread_stats_mutex);
+  thread_stats->next = mme_app_ue_handle_thread_stats;
+  mme_app_ue_handle_thread_stats = thread_stats;
+  pthread_mutex_unlock (&mme_app_ue_handle_thread_stats_mutex);
+  mme_app_ue_handle_thread_stats_p = thread_stats;
+  return &thread_stats->stats;
+}
+
+//------------------------------------------------------------------------------
+static inline mme_app_ue_handle_stats_t * mme_app_ue_handle_get_thread_stats (void)
+{
+  if (NULL == mme_app_ue_handle_thread_stats_p) {
+    return mme_app_ue_handle_new_thread_stats ();
+  }
+  return &mme_app_ue_handle_thread_stats_p->stats;
+}
+
+//------------------------------------------------------------------------------
+// Single writer, a plain increment that mme_app_ue_handle_get_stats() may read at any time
+static inline void mme_app_ue_handle_count (uint64_t * const counterP)
+{
+  __atomic_store_n (counterP, *counterP + 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static inline void mme_app_ue_handle_clear (void)
+{
+  mme_app_ue_handle.ue_id = INVALID_MME_UE_S1AP_ID;
+  mme_app_ue_handle.ue_context = NULL;
+  mme_app_ue_handle.emm_context = NULL;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_open (void)
+{
+  mme_app_ue_handle_clear ();
+  mme_app_ue_handle.is_open = true;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_close (void)
+{
+  mme_app_ue_handle_clear ();
+  mme_app_ue_handle.is_open = false;
+}
+
+//------------------------------------------------------------------------------
+struct ue_context_s *mme_app_ue_handle_ue_context (const uint64_t * const generationP, const mme_ue_s1ap_id_t ue_id)
+{
+  // never read through the held pointer before the generation check, the context may have been freed by another task
+  const uint64_t                          generation = __atomic_load_n (generationP, __ATOMIC_ACQUIRE);
+
+  mme_app_ue_handle_count (&mme_app_ue_handle_get_thread_stats ()->mme_app_lookups);
+  if ((mme_app_ue_handle.ue_id == ue_id) && (mme_app_ue_handle.ue_context)) {
+    if (mme_app_ue_handle.ue_context_generation == generation) {
+      return mme_app_ue_handle.ue_context;
+    }
+    // removed or re-keyed in its collection, may be by another task
+    mme_app_ue_handle.ue_context = NULL;
+  }
+  mme_app_ue_handle.probe_generation = generation;
+  mme_app_ue_handle_count (&mme_app_ue_handle_get_thread_stats ()->mme_app_probes);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_probed_ue_context (const mme_ue_s1ap_id_t ue_id, struct ue_context_s * const ue_context)
+{
+  if ((!mme_app_ue_handle.is_open) || (NULL == ue_context) || (INVALID_MME_UE_S1AP_ID == ue_id)) {
+    return;
+  }
+  if (mme_app_ue_handle.ue_id != ue_id) {
+    mme_app_ue_handle_clear ();
+    mme_app_ue_handle.ue_id = ue_id;
+  }
+  mme_app_ue_handle.ue_context = ue_context;
+  mme_app_ue_handle.ue_context_generation = mme_app_ue_handle.probe_generation;
+}
+
+//------------------------------------------------------------------------------
+struct emm_data_context_s *mme_app_ue_handle_emm_context (const uint64_t * const generationP, const mme_ue_s1ap_id_t ue_id)
+{
+  const uint64_t                          generation = __atomic_load_n (generationP, __ATOMIC_ACQUIRE);
+
+  mme_app_ue_handle_count (&mme_app_ue_handle_get_thread_stats ()->emm_lookups);
+  if ((mme_app_ue_handle.ue_id == ue_id) && (mme_app_ue_handle.emm_context)) {
+    if (mme_app_ue_handle.emm_context_generation == generation) {
+      return mme_app_ue_handle.emm_context;
+    }
+    mme_app_ue_handle.emm_context = NULL;
+  }
+  mme_app_ue_handle.probe_generation = generation;
+  mme_app_ue_handle_count (&mme_app_ue_handle_get_thread_stats ()->emm_probes);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_probed_emm_context (const mme_ue_s1ap_id_t ue_id, struct emm_data_context_s * const emm_context)
+{
+  if ((!mme_app_ue_handle.is_open) || (NULL == emm_context) || (INVALID_MME_UE_S1AP_ID == ue_id)) {
+    return;
+  }
+  if (mme_app_ue_handle.ue_id != ue_id) {
+    mme_app_ue_handle_clear ();
+    mme_app_ue_handle.ue_id = ue_id;
+  }
+  mme_app_ue_handle.emm_context = emm_context;
+  mme_app_ue_handle.emm_context_generation = mme_app_ue_handle.probe_generation;
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_forget (uint64_t * const generationP, const mme_ue_s1ap_id_t ue_id)
+{
+  // invalidates the contexts held by the handles of all threads
+  __atomic_fetch_add (generationP, 1, __ATOMIC_ACQ_REL);
+  if (mme_app_ue_handle.ue_id == ue_id) {
+    mme_app_ue_handle_clear ();
+  }
+}
+
+//------------------------------------------------------------------------------
+void mme_app_ue_handle_get_stats (mme_app_ue_handle_stats_t * const stats)
+{
+  mme_app_ue_handle_thread_stats_t       *thread_stats = NULL;
+
+  memset (stats, 0, sizeof (*stats));
+  pthread_mutex_lock (&mme_app_ue_handle_thread_stats_mutex);
+  for (thread_stats = mme_app_ue_handle_thread_stats; thread_stats; thread_stats = thread_stats->next) {
+    stats->mme_app_lookups += __atomic_load_n (&thread_stats->stats.mme_app_lookups, __ATOMIC_RELAXED);
+    stats->mme_app_probes  += __atomic_load_n (&thread_stats->stats.mme_app_probes, __ATOMIC_RELAXED);
+    stats->emm_lookups     += __atomic_load_n (&thread_stats->stats.emm_lookups, __ATOMIC_RELAXED);
+    stats->emm_probes      += __atomic_load_n (&thread_stats->stats.emm_probes, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock (&mme_app_ue_handle_thread_stats_mutex);
+}
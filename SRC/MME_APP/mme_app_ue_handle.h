@@ -0,0 +1,70 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file mme_app_ue_handle.h
+   \brief Handle on the contexts of the UE an ITTI message is about: MME_APP context and EMM context, the
+          EMM context carrying the ESM context.
+   The NAS and MME_APP tasks open the handle of their thread when they start processing an ITTI message and
+   close it when done. In between, a context of the UE is probed at most once in its collection, the following
+   emm_data_context_get() or mme_ue_context_exists_mme_ue_s1ap_id() of the same UE are served by the handle.
+   Lifetime rules:
+   - a handle belongs to its thread and does not outlive the ITTI message,
+   - a context removed from, or re-keyed in, its collection is forgotten: the generation of the collection is
+     bumped, so the handles of all threads drop it without reading through it,
+   - a context served by the handle was probed under the current generation of its collection, and in debug
+     builds must still be the one of its collection (AssertFatal otherwise).
+*/
+
+#ifndef FILE_MME_APP_UE_HANDLE_SEEN
+#define FILE_MME_APP_UE_HANDLE_SEEN
+
+struct ue_context_s;
+struct emm_data_context_s;
+
+typedef struct mme_app_ue_handle_stats_s {
+  uint64_t                    mme_app_lookups;  // mme_ue_context_exists_mme_ue_s1ap_id()
+  uint64_t                    mme_app_probes;   // of them, served by the MME_APP UE collection
+  uint64_t                    emm_lookups;      // emm_data_context_get()
+  uint64_t                    emm_probes;       // of them, served by the EMM UE collection
+} mme_app_ue_handle_stats_t;
+
+void mme_app_ue_handle_open(void);
+
+void mme_app_ue_handle_close(void);
+
+/** \brief MME_APP context of ue_id if held by the handle and generation unchanged, NULL if it has to be probed. */
+struct ue_context_s *mme_app_ue_handle_ue_context(const uint64_t * const generation, const mme_ue_s1ap_id_t ue_id);
+
+/** \brief Records ue_context, just probed for ue_id. */
+void mme_app_ue_handle_probed_ue_context(const mme_ue_s1ap_id_t ue_id, struct ue_context_s * const ue_context);
+
+/** \brief EMM context of ue_id if held by the handle and generation unchanged, NULL if it has to be probed. */
+struct emm_data_context_s *mme_app_ue_handle_emm_context(const uint64_t * const generation, const mme_ue_s1ap_id_t ue_id);
+
+/** \brief Records emm_context, just probed for ue_id. */
+void mme_app_ue_handle_probed_emm_context(const mme_ue_s1ap_id_t ue_id, struct emm_data_context_s * const emm_context);
+
+/** \brief Bumps generation, the one of the collection, before a context of ue_id is removed from it or re-keyed. */
+void mme_app_ue_handle_forget(uint64_t * const generation, const mme_ue_s1ap_id_t ue_id);
+
+void mme_app_ue_handle_get_stats(mme_app_ue_handle_stats_t * const stats);
+
+#endif /* FILE_MME_APP_UE_HANDLE_SEEN */
@@ -86,6 +86,14 @@ int mme_config_find_mnc_length (
 }
 
 
+static const char * const overload_action2string[OVERLOAD_ACTION_MAX] = {
+  "REJECT_NON_EMERGENCY_MO_DT",
+  "REJECT_RRC_CR_SIGNALLING",
+  "PERMIT_EMERGENCY_AND_MT_ONLY",
+  "PERMIT_HIGH_PRIORITY_AND_MT_ONLY",
+  "REJECT_DELAY_TOLERANT_ACCESS"
+};
+
 //------------------------------------------------------------------------------
 static void mme_config_init (mme_config_t * config_pP)
 {
@@ -93,6 +101,7 @@ static void mme_config_init (mme_config_t * config_pP)
   pthread_rwlock_init (&config_pP->rw_lock, NULL);
   config_pP->log_config.output             = NULL;
   config_pP->log_config.is_output_thread_safe = false;
+  config_pP->log_config.is_output_binary   = false;
   config_pP->log_config.color              = false;
   config_pP->log_config.udp_log_level      = MAX_LOG_LEVEL; // Means invalid
   config_pP->log_config.gtpv1u_log_level   = MAX_LOG_LEVEL; // will not overwrite existing log levels if MME and S-GW bundled in same executable
@@ -134,10 +143,16 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->s6a_config.conf_file = bfromcstr(S6A_CONF_FILE);
   config_pP->itti_config.queue_size = ITTI_QUEUE_MAX_ELEMENTS;
   config_pP->itti_config.log_file = NULL;
+  config_pP->itti_config.trace_file = NULL;
+  config_pP->itti_config.trace_sampling = 0;
+  config_pP->itti_config.shards = 0;
   config_pP->sctp_config.in_streams = SCTP_IN_STREAMS;
   config_pP->sctp_config.out_streams = SCTP_OUT_STREAMS;
   config_pP->relative_capacity = RELATIVE_CAPACITY;
+  config_pP->m_tmsi.prefix = M_TMSI_PREFIX;
+  config_pP->m_tmsi.prefix_bits = M_TMSI_PREFIX_BITS;
   config_pP->mme_statistic_timer = MME_STATISTIC_TIMER_S;
+  config_pP->nas_config.t3413_sec = MME_T3413_TIMER_S;
   config_pP->gummei.nb = 1;
   config_pP->gummei.gummei[0].mme_code = MMEC;
   config_pP->gummei.gummei[0].mme_gid = MMEGID;
@@ -161,6 +176,12 @@ static void mme_config_init (mme_config_t * config_pP)
   config_pP->served_tai.plmn_mnc_len[0] = PLMN_MNC_LEN;
   config_pP->served_tai.tac[0] = PLMN_TAC;
   config_pP->s1ap_config.outcome_drop_timer_sec = S1AP_OUTCOME_TIMER_DEFAULT;
+  config_pP->overload_config.timer_ms = MME_OVERLOAD_TIMER_MS;
+  config_pP->overload_config.start_load = MME_OVERLOAD_START_LOAD;
+  config_pP->overload_config.stop_load = MME_OVERLOAD_STOP_LOAD;
+  config_pP->overload_config.max_s6a_transactions = MME_OVERLOAD_MAX_S6A_TRANSACTIONS;
+  config_pP->overload_config.max_s11_transactions = MME_OVERLOAD_MAX_S11_TRANSACTIONS;
+  config_pP->overload_config.action = OVERLOAD_ACTION_PERMIT_EMERGENCY_AND_MT_ONLY;
 }
 
 
@@ -236,6 +257,16 @@ static int mme_config_parse_file (mme_config_t * config_pP)
         }
       }
 
+      if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_OUTPUT_BINARY, (const char **)&astring)) {
+        if (astring != NULL) {
+          if (strcasecmp (astring, "yes") == 0) {
+            config_pP->log_config.is_output_binary = true;
+          } else {
+            config_pP->log_config.is_output_binary = false;
+          }
+        }
+      }
+
       if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_COLOR, (const char **)&astring)) {
         if (0 == strcasecmp("true", astring)) config_pP->log_config.color = true;
         else config_pP->log_config.color = false;
@@ -274,6 +305,8 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if (config_setting_lookup_string (setting, LOG_CONFIG_STRING_ITTI_LOG_LEVEL, (const char **)&astring))
         config_pP->log_config.itti_log_level = OAILOG_LEVEL_STR2INT (astring);
 
+      OAILOG_CONFIG_PARSE (setting, &config_pP->log_config);
+
       if ((config_setting_lookup_string (setting_mme, MME_CONFIG_STRING_ASN1_VERBOSITY, (const char **)&astring))) {
         if (strcasecmp (astring, MME_CONFIG_STRING_ASN1_VERBOSITY_NONE) == 0)
           config_pP->log_config.asn1_verbosity_level = 0;
@@ -316,6 +349,14 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       config_pP->relative_capacity = (uint8_t) aint;
     }
 
+    if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_M_TMSI_PREFIX_BITS, &aint))) {
+      config_pP->m_tmsi.prefix_bits = aint;
+    }
+
+    if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_M_TMSI_PREFIX, &aint))) {
+      config_pP->m_tmsi.prefix = (uint32_t) aint;
+    }
+
     if ((config_setting_lookup_int (setting_mme, MME_CONFIG_STRING_STATISTIC_TIMER, &aint))) {
       config_pP->mme_statistic_timer = (uint32_t) aint;
     }
@@ -359,6 +400,17 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE, &aint))) {
         config_pP->itti_config.queue_size = (uint32_t) aint;
       }
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_FILE, (const char **)&astring))) {
+        if (astring != NULL) {
+          config_pP->itti_config.trace_file = bfromcstr (astring);
+        }
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_SAMPLING, &aint))) {
+        config_pP->itti_config.trace_sampling = (uint32_t) aint;
+      }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_INTERTASK_INTERFACE_SHARDS, &aint))) {
+        config_pP->itti_config.shards = (uint32_t) aint;
+      }
     }
     // S6A SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_S6A_CONFIG);
@@ -385,6 +437,42 @@ static int mme_config_parse_file (mme_config_t * config_pP)
           AssertFatal (1 == 0, "You have to provide a valid HSS hostname %s=...\n", MME_CONFIG_STRING_S6A_HSS_HOSTNAME);
       }
     }
+    // OVERLOAD SETTING
+    setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_OVERLOAD_CONFIG);
+
+    if (setting != NULL) {
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_TIMER, &aint))) {
+        config_pP->overload_config.timer_ms = (uint32_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_START_LOAD, &aint))) {
+        config_pP->overload_config.start_load = (uint8_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_STOP_LOAD, &aint))) {
+        config_pP->overload_config.stop_load = (uint8_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_MAX_S6A_TRANSACTIONS, &aint))) {
+        config_pP->overload_config.max_s6a_transactions = (uint32_t) aint;
+      }
+
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_OVERLOAD_MAX_S11_TRANSACTIONS, &aint))) {
+        config_pP->overload_config.max_s11_transactions = (uint32_t) aint;
+      }
+
+      if ((config_setting_lookup_string (setting, MME_CONFIG_STRING_OVERLOAD_ACTION, (const char **)&astring))) {
+        int action = 0;
+
+        for (action = 0; (action < OVERLOAD_ACTION_MAX) && strcasecmp (astring, overload_action2string[action]); action++);
+        AssertFatal (action < OVERLOAD_ACTION_MAX, "Unknown %s %s\n", MME_CONFIG_STRING_OVERLOAD_ACTION, astring);
+        config_pP->overload_config.action = (overload_action_t) action;
+      }
+      AssertFatal ((config_pP->overload_config.stop_load < config_pP->overload_config.start_load) &&
+          (config_pP->overload_config.max_s6a_transactions) && (config_pP->overload_config.max_s11_transactions),
+          "%s must be lower than %s, the maximum numbers of transactions must not be 0\n",
+          MME_CONFIG_STRING_OVERLOAD_STOP_LOAD, MME_CONFIG_STRING_OVERLOAD_START_LOAD);
+    }
     // SCTP SETTING
     setting = config_setting_get_member (setting_mme, MME_CONFIG_STRING_SCTP_CONFIG);
 
@@ -654,6 +742,9 @@ static int mme_config_parse_file (mme_config_t * config_pP)
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_NAS_T3412_TIMER, &aint))) {
         config_pP->nas_config.t3412_min = (uint8_t) aint;
       }
+      if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_NAS_T3413_TIMER, &aint))) {
+        config_pP->nas_config.t3413_sec = (uint8_t) aint;
+      }
       if ((config_setting_lookup_int (setting, MME_CONFIG_STRING_NAS_T3485_TIMER, &aint))) {
         config_pP->nas_config.t3485_sec = (uint8_t) aint;
       }
@@ -675,15 +766,19 @@ static int mme_config_parse_file (mme_config_t * config_pP)
     if ((config_setting_lookup_string (setting, SGW_CONFIG_STRING_SGW_IPV4_ADDRESS_FOR_S11, (const char **)&sgw_ip_address_for_s11)
         )
       ) {
-
-      cidr = bfromcstr (sgw_ip_address_for_s11);
-      struct bstrList *list = bsplit (cidr, '/');
-      AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
-      address = list->entry[0];
-      IPV4_STR_ADDR_TO_INT_NWBO (bdata(address), config_pP->ipv4.sgw_s11, "BAD IP ADDRESS FORMAT FOR SGW S11 !\n");
-      bstrListDestroy(list);
-      in_addr_var.s_addr = config_pP->ipv4.sgw_s11;
-      OAILOG_INFO (LOG_SPGW_APP, "Parsing configuration file found S-GW S11: %s\n", inet_ntoa (in_addr_var));
+      if (strcasecmp (sgw_ip_address_for_s11, "none") == 0) {
+        config_pP->ipv4.sgw_s11 = 0;
+        OAILOG_INFO (LOG_SPGW_APP, "Parsing configuration file found no S-GW S11, ITTI message interface used\n");
+      } else {
+        cidr = bfromcstr (sgw_ip_address_for_s11);
+        struct bstrList *list = bsplit (cidr, '/');
+        AssertFatal(2 == list->qty, "Bad CIDR address %s", bdata(cidr));
+        address = list->entry[0];
+        IPV4_STR_ADDR_TO_INT_NWBO (bdata(address), config_pP->ipv4.sgw_s11, "BAD IP ADDRESS FORMAT FOR SGW S11 !\n");
+        bstrListDestroy(list);
+        in_addr_var.s_addr = config_pP->ipv4.sgw_s11;
+        OAILOG_INFO (LOG_SPGW_APP, "Parsing configuration file found S-GW S11: %s\n", inet_ntoa (in_addr_var));
+      }
     }
   }
 
@@ -711,6 +806,7 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- Extended service request .............: %s\n", config_pP->eps_network_feature_support.extended_service_request == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Unauth IMSI support ..................: %s\n", config_pP->unauthenticated_imsi_supported == 0 ? "false" : "true");
   OAILOG_INFO (LOG_CONFIG, "- Relative capa ........................: %u\n", config_pP->relative_capacity);
+  OAILOG_INFO (LOG_CONFIG, "- M-TMSI prefix ........................: %x on %d bits\n", config_pP->m_tmsi.prefix, config_pP->m_tmsi.prefix_bits);
   OAILOG_INFO (LOG_CONFIG, "- Statistics timer .....................: %u (seconds)\n\n", config_pP->mme_statistic_timer);
   OAILOG_INFO (LOG_CONFIG, "- S1-MME:\n");
   OAILOG_INFO (LOG_CONFIG, "    port number ......: %d\n", config_pP->s1ap_config.port_number);
@@ -723,6 +819,9 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "- ITTI:\n");
   OAILOG_INFO (LOG_CONFIG, "    queue size .......: %u (bytes)\n", config_pP->itti_config.queue_size);
   OAILOG_INFO (LOG_CONFIG, "    log file .........: %s\n", bdata(config_pP->itti_config.log_file));
+  OAILOG_INFO (LOG_CONFIG, "    trace file .......: %s\n", bdata(config_pP->itti_config.trace_file));
+  OAILOG_INFO (LOG_CONFIG, "    trace sampling ...: 1/%u\n", config_pP->itti_config.trace_sampling);
+  OAILOG_INFO (LOG_CONFIG, "    shards ...........: %u (0: one thread per task)\n", config_pP->itti_config.shards);
   OAILOG_INFO (LOG_CONFIG, "- SCTP:\n");
   OAILOG_INFO (LOG_CONFIG, "    in streams .......: %u\n", config_pP->sctp_config.in_streams);
   OAILOG_INFO (LOG_CONFIG, "    out streams ......: %u\n", config_pP->sctp_config.out_streams);
@@ -753,11 +852,17 @@ static void mme_config_display (mme_config_t * config_pP)
     }
   }
 
+  OAILOG_INFO (LOG_CONFIG, "- Overload control:\n");
+  OAILOG_INFO (LOG_CONFIG, "    timer ............: %u (ms)\n", config_pP->overload_config.timer_ms);
+  OAILOG_INFO (LOG_CONFIG, "    start/stop load ..: %u%%/%u%%\n", config_pP->overload_config.start_load, config_pP->overload_config.stop_load);
+  OAILOG_INFO (LOG_CONFIG, "    max S6a/S11 trxn .: %u/%u\n", config_pP->overload_config.max_s6a_transactions, config_pP->overload_config.max_s11_transactions);
+  OAILOG_INFO (LOG_CONFIG, "    action ...........: %s\n", overload_action2string[config_pP->overload_config.action]);
   OAILOG_INFO (LOG_CONFIG, "- S6A:\n");
   OAILOG_INFO (LOG_CONFIG, "    conf file ........: %s\n", bdata(config_pP->s6a_config.conf_file));
   OAILOG_INFO (LOG_CONFIG, "- Logging:\n");
   OAILOG_INFO (LOG_CONFIG, "    Output ..............: %s\n", bdata(config_pP->log_config.output));
   OAILOG_INFO (LOG_CONFIG, "    Output thread safe ..: %s\n", (config_pP->log_config.is_output_thread_safe) ? "true":"false");
+  OAILOG_INFO (LOG_CONFIG, "    Output binary .......: %s\n", (config_pP->log_config.is_output_binary) ? "true":"false");
   OAILOG_INFO (LOG_CONFIG, "    UDP log level........: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.udp_log_level));
   OAILOG_INFO (LOG_CONFIG, "    GTPV1-U log level....: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.gtpv1u_log_level));
   OAILOG_INFO (LOG_CONFIG, "    GTPV2-C log level....: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.gtpv2c_log_level));
@@ -772,6 +877,10 @@ static void mme_config_display (mme_config_t * config_pP)
   OAILOG_INFO (LOG_CONFIG, "    UTIL log level.......: %s\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.util_log_level));
   OAILOG_INFO (LOG_CONFIG, "    MSC log level........: %s (MeSsage Chart)\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.msc_log_level));
   OAILOG_INFO (LOG_CONFIG, "    ITTI log level.......: %s (InTer-Task Interface)\n", OAILOG_LEVEL_INT2STR(config_pP->log_config.itti_log_level));
+  for (int i = 0; i < config_pP->log_config.num_call_site_rules; i++) {
+    OAILOG_INFO (LOG_CONFIG, "    Call site %-11s: %s\n", (config_pP->log_config.call_site_rule[i].is_enabled) ? "enabled":"disabled",
+        bdata(config_pP->log_config.call_site_rule[i].location));
+  }
 }
 
 //------------------------------------------------------------------------------
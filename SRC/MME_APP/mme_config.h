@@ -48,6 +48,8 @@
 #define MME_CONFIG_STRING_MAXENB                         "MAXENB"
 #define MME_CONFIG_STRING_MAXUE                          "MAXUE"
 #define MME_CONFIG_STRING_RELATIVE_CAPACITY              "RELATIVE_CAPACITY"
+#define MME_CONFIG_STRING_M_TMSI_PREFIX                  "M_TMSI_PREFIX"
+#define MME_CONFIG_STRING_M_TMSI_PREFIX_BITS             "M_TMSI_PREFIX_BITS"
 #define MME_CONFIG_STRING_STATISTIC_TIMER                "MME_STATISTIC_TIMER"
 
 #define MME_CONFIG_STRING_EMERGENCY_ATTACH_SUPPORTED     "EMERGENCY_ATTACH_SUPPORTED"
@@ -61,6 +63,9 @@
 
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG     "INTERTASK_INTERFACE"
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE "ITTI_QUEUE_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_FILE "ITTI_TRACE_FILE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_SAMPLING "ITTI_TRACE_SAMPLING"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_SHARDS     "ITTI_SHARDS"
 
 #define MME_CONFIG_STRING_S6A_CONFIG                     "S6A"
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH             "S6A_CONF"
@@ -97,11 +102,20 @@
 
 #define MME_CONFIG_STRING_NAS_T3402_TIMER                "T3402"
 #define MME_CONFIG_STRING_NAS_T3412_TIMER                "T3412"
+#define MME_CONFIG_STRING_NAS_T3413_TIMER                "T3413"
 #define MME_CONFIG_STRING_NAS_T3485_TIMER                "T3485"
 #define MME_CONFIG_STRING_NAS_T3486_TIMER                "T3486"
 #define MME_CONFIG_STRING_NAS_T3489_TIMER                "T3489"
 #define MME_CONFIG_STRING_NAS_T3495_TIMER                "T3495"
 
+#define MME_CONFIG_STRING_OVERLOAD_CONFIG                "OVERLOAD"
+#define MME_CONFIG_STRING_OVERLOAD_TIMER                 "OVERLOAD_TIMER"
+#define MME_CONFIG_STRING_OVERLOAD_START_LOAD            "START_LOAD"
+#define MME_CONFIG_STRING_OVERLOAD_STOP_LOAD             "STOP_LOAD"
+#define MME_CONFIG_STRING_OVERLOAD_MAX_S6A_TRANSACTIONS  "MAX_S6A_TRANSACTIONS"
+#define MME_CONFIG_STRING_OVERLOAD_MAX_S11_TRANSACTIONS  "MAX_S11_TRANSACTIONS"
+#define MME_CONFIG_STRING_OVERLOAD_ACTION                "OVERLOAD_ACTION"
+
 #define MME_CONFIG_STRING_ASN1_VERBOSITY                 "ASN1_VERBOSITY"
 #define MME_CONFIG_STRING_ASN1_VERBOSITY_NONE            "none"
 #define MME_CONFIG_STRING_ASN1_VERBOSITY_ANNOYING        "annoying"
@@ -128,6 +142,11 @@ typedef struct mme_config_s {
 
   uint8_t relative_capacity;
 
+  struct {
+    uint32_t prefix;        // most significant bits of all the allocated M-TMSIs
+    int      prefix_bits;   // even, 0 to 8
+  } m_tmsi;
+
   uint32_t mme_statistic_timer;
 
   uint8_t unauthenticated_imsi_supported;
@@ -183,9 +202,20 @@ typedef struct mme_config_s {
     bstring conf_file;
     bstring hss_host_name;
   } s6a_config;
+  struct {
+    uint32_t          timer_ms;              // period of the load evaluation, 0 disables overload control
+    uint8_t           start_load;            // percent
+    uint8_t           stop_load;             // percent
+    uint32_t          max_s6a_transactions;
+    uint32_t          max_s11_transactions;
+    overload_action_t action;
+  } overload_config;
   struct {
     uint32_t  queue_size;
     bstring   log_file;
+    bstring   trace_file;      // ITTI_TRACE build only
+    uint32_t  trace_sampling;  // one procedure out of trace_sampling traced, 0: none
+    uint32_t  shards;          // threads running the MME tasks to completion, 0: one thread per task
   } itti_config;
 
   struct {
@@ -193,6 +223,7 @@ typedef struct mme_config_s {
     uint8_t  prefered_ciphering_algorithm[8];
     uint32_t t3402_min;
     uint32_t t3412_min;
+    uint32_t t3413_sec;
     uint32_t t3485_sec;
     uint32_t t3486_sec;
     uint32_t t3489_sec;
@@ -46,6 +46,7 @@
 #include "sgw_ie_defs.h"
 #include "mme_app_ue_context.h"
 #include "mme_app_defs.h"
+#include "mme_app_m_tmsi.h"
 #include "mme_config.h"
 #include <string.h>             // memcpy
 
@@ -356,7 +357,8 @@ mme_api_new_guti (
     if (RUN_MODE_TEST == mme_config.run_mode) {
       guti->m_tmsi = __sync_fetch_and_add (&mme_m_tmsi_generator, 0x00000001);
     } else {
-      guti->m_tmsi                 = (tmsi_t)(uintptr_t)ue_context;
+      // the M-TMSI of the old GUTI is released when the new GUTI is notified
+      guti->m_tmsi                 = mme_app_m_tmsi_allocate (ue_context);
     }
     if (guti->m_tmsi == INVALID_M_TMSI) {
       OAILOG_FUNC_RETURN (LOG_NAS, RETURNerror);
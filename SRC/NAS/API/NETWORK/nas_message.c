@@ -53,6 +53,7 @@
 #include "secu_defs.h"
 #include "emmData.h"
 #include "dynamic_memory_check.h"
+#include "nas_pdu_copy.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -254,6 +255,8 @@ int nas_message_encrypt (
  **    Others:  None                                       **
  **                                                                        **
  ** Outputs:   outbuf:  Output buffer containing plain NAS message **
+ **       or inbuf, the plain NAS message is then    **
+ **       deciphered in place and ends the buffer    **
  **    header:  Security protected header applied          **
  **      Return:  The number of bytes in the output buffer   **
  **       if the input buffer has been successfully  **
@@ -323,7 +326,7 @@ int nas_message_decrypt (
      * Decrypt the security protected NAS message
      */
     //OAI_GCC_DIAG_OFF(discarded-qualifiers);
-    header->protocol_discriminator = _nas_message_decrypt (outbuf,
+    header->protocol_discriminator = _nas_message_decrypt ((outbuf == inbuf) ? outbuf + size : outbuf,
         (unsigned char * const)(inbuf + size),
         header->security_header_type,
         header->message_authentication_code,
@@ -339,7 +342,10 @@ int nas_message_decrypt (
     /*
      * The input buffer contains a plain NAS message
      */
-    memcpy (outbuf, inbuf, length);
+    if (outbuf != inbuf) {
+      memcpy (outbuf, inbuf, length);
+      nas_pdu_copy_count (NAS_PDU_COPY_NAS, length);
+    }
   }
 
   OAILOG_FUNC_RETURN (LOG_NAS, bytes);
@@ -795,7 +801,25 @@ static int _nas_message_protected_decode (
 {
   OAILOG_FUNC_IN (LOG_NAS);
   int                                     bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char                    *const plain_msg = (unsigned char *)calloc (1, length);
+  unsigned char                          *plain_msg = NULL;
+
+  switch (header->security_header_type) {
+  case SECURITY_HEADER_TYPE_NOT_PROTECTED:
+  case SECURITY_HEADER_TYPE_SERVICE_REQUEST:
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED:
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_NEW:
+    /*
+     * Not ciphered, decode the message in place
+     */
+    header->protocol_discriminator = _nas_message_decrypt (buffer, buffer, header->security_header_type, header->message_authentication_code,
+        header->sequence_number, length, emm_security_context, status);
+    bytes = _nas_message_plain_decode (buffer, header, msg, length);
+    OAILOG_FUNC_RETURN (LOG_NAS, bytes);
+    break;
+
+  default:
+    plain_msg = (unsigned char *)calloc (1, length);
+  }
 
   if (plain_msg) {
     /*
@@ -813,6 +837,7 @@ static int _nas_message_protected_decode (
      * Decode the decrypted message as plain NAS message
      */
     bytes = _nas_message_plain_decode (plain_msg, header, msg, length);
+    nas_pdu_copy_count (NAS_PDU_COPY_NAS, length);
     free_wrapper ((void**) &plain_msg);
   }
 
@@ -1006,7 +1031,8 @@ static int _nas_message_protected_encode (
  **    length:  Maximal capacity of the output buffer      **
  **    Others:  None                                       **
  **                                                                        **
- ** Outputs:   dest:    Pointer to the decrypted data buffer       **
+ ** Outputs:   dest:    Pointer to the decrypted data buffer, may  **
+ **       be src (decrypted in place)                **
  **      Return:  The protocol discriminator of the message  **
  **       that has been decrypted;                   **
  **    Others:  None                                       **
@@ -1038,7 +1064,9 @@ static int _nas_message_decrypt (
   case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED:
   case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_NEW:
     OAILOG_DEBUG (LOG_NAS, "No decryption of message length %lu according to security header type 0x%02x\n", length, security_header_type);
-    memcpy (dest, src, length);
+    if (dest != src) {
+      memcpy (dest, src, length);
+    }
     DECODE_U8 (dest, *(uint8_t *) (&header), size);
     OAILOG_FUNC_RETURN (LOG_NAS, header.protocol_discriminator);
     //LOG_FUNC_RETURN (LOG_NAS, length);
@@ -1120,7 +1148,9 @@ static int _nas_message_decrypt (
 
         case NAS_SECURITY_ALGORITHMS_EEA0:
           OAILOG_DEBUG (LOG_NAS, "NAS_SECURITY_ALGORITHMS_EEA0 dir %d ul_count.seq_num %d dl_count.seq_num %d\n", direction, emm_security_context->ul_count.seq_num, emm_security_context->dl_count.seq_num);
-          memcpy (dest, src, length);
+          if (dest != src) {
+            memcpy (dest, src, length);
+          }
           /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -1131,7 +1161,9 @@ static int _nas_message_decrypt (
 
         default:
           OAILOG_ERROR(LOG_NAS, "Unknown Cyphering protection algorithm %d\n", emm_security_context->selected_algorithms.encryption);
-          memcpy (dest, src, length);
+          if (dest != src) {
+            memcpy (dest, src, length);
+          }
           /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -43,6 +43,7 @@
 
 #include "dynamic_memory_check.h"
 #include "log.h"
+#include "probes.h"
 #include "msc.h"
 #include "3gpp_requirements_24.301.h"
 #include "emm_as.h"
@@ -58,6 +59,7 @@
 #include "nas_itti_messaging.h"
 #include "emm_proc.h"
 #include "nas_proc.h"
+#include "nas_pdu_copy.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -114,9 +116,9 @@ static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause);
 */
 static EMM_msg *_emm_as_set_header (nas_message_t * msg, const emm_as_security_data_t * security);
 
-static int _emm_as_encode (bstring *info, nas_message_t * msg, size_t length, emm_security_context_t * emm_security_context);
+static int _emm_as_encode (mme_ue_s1ap_id_t ue_id, bstring *info, nas_message_t * msg, size_t length, emm_security_context_t * emm_security_context);
 
-static int _emm_as_encrypt (bstring *info, const nas_message_security_header_t * header, const unsigned char *buffer,
+static int _emm_as_encrypt (mme_ue_s1ap_id_t ue_id, bstring *info, const nas_message_security_header_t * header, const unsigned char *buffer,
     size_t length, emm_security_context_t * emm_security_context);
 
 static int _emm_as_send (const emm_as_t * msg);
@@ -313,7 +315,9 @@ static int _emm_as_recv (
   /*
    * Decode the received message
    */
+  OAI_PROBE2 (nas_decode_start, ue_id, len);
   decoder_rc = nas_message_decode (msg->data, &nas_msg, len, emm_security_context, decode_status);
+  OAI_PROBE3 (nas_decode_done, ue_id, nas_msg.plain.emm.header.message_type, decoder_rc);
 
   if (decoder_rc < 0) {
     OAILOG_WARNING (LOG_NAS_EMM, "EMMAS-SAP - Failed to decode NAS message " "(err=%d)\n", decoder_rc);
@@ -462,65 +466,67 @@ static int _emm_as_data_ind (const emm_as_data_t * msg, int *emm_cause)
   if ( EMM_AS_DATA_DELIVERED_TRUE == msg->delivered) {
     if (blength(msg->nas_msg) > 0) {
       /*
-       * Process the received NAS message
+       * Process the received NAS message, deciphered in place
        */
-      bstring                                   plain_msg = bstrcpy(msg->nas_msg);
+      struct tagbstring                       plain_msg;
+      nas_message_security_header_t           header = {0};
+      emm_security_context_t                 *security = NULL;        /* Current EPS NAS security context     */
+      nas_message_decode_status_t             decode_status = {0};
 
-      if (plain_msg) {
-        nas_message_security_header_t           header = {0};
-        emm_security_context_t                 *security = NULL;        /* Current EPS NAS security context     */
-        nas_message_decode_status_t             decode_status = {0};
+      /*
+       * Decrypt the received security protected message
+       */
+      emm_data_context_t                     *emm_ctx = NULL;
 
-        /*
-         * Decrypt the received security protected message
-         */
-        emm_data_context_t                     *emm_ctx = NULL;
-
-        if (msg->ue_id > INVALID_MME_UE_S1AP_ID) {
-          emm_ctx = emm_data_context_get (&_emm_data, msg->ue_id);
-          if (emm_ctx) {
-            if (IS_EMM_CTXT_PRESENT_SECURITY(emm_ctx)) {
-              security = &emm_ctx->_security;
-            }
+      if (msg->ue_id > INVALID_MME_UE_S1AP_ID) {
+        emm_ctx = emm_data_context_get (&_emm_data, msg->ue_id);
+        if (emm_ctx) {
+          if (IS_EMM_CTXT_PRESENT_SECURITY(emm_ctx)) {
+            security = &emm_ctx->_security;
           }
         }
+      }
 
-        int  bytes = nas_message_decrypt (msg->nas_msg->data,
-            plain_msg->data,
-            &header,
-            blength(msg->nas_msg),
-            security,
-            &decode_status);
+      nas_pdu_copy_uplink_message ();
+      int  bytes = nas_message_decrypt (msg->nas_msg->data,
+          msg->nas_msg->data,
+          &header,
+          blength(msg->nas_msg),
+          security,
+          &decode_status);
 
-        if ((bytes < 0) &&
-            (bytes != TLV_MAC_MISMATCH)) { // not in spec, (case identity response for attach with unknown GUTI)
-          /*
-           * Failed to decrypt the message
-           */
-          *emm_cause = EMM_CAUSE_PROTOCOL_ERROR;
-          OAILOG_FUNC_RETURN (LOG_NAS_EMM, bytes);
-        } else if (header.protocol_discriminator == EPS_MOBILITY_MANAGEMENT_MESSAGE) {
-          /*
-           * Process EMM data
-           */
-          tai_t                                   originating_tai = {.plmn = {0}, .tac = INVALID_TAC_0000}; // originating TAI
-          originating_tai.tac = msg->tac;
-          originating_tai.plmn.mcc_digit1 = msg->plmn_id->mcc_digit1;
-          originating_tai.plmn.mcc_digit2 = msg->plmn_id->mcc_digit2;
-          originating_tai.plmn.mcc_digit3 = msg->plmn_id->mcc_digit3;
-          originating_tai.plmn.mnc_digit1 = msg->plmn_id->mnc_digit1;
-          originating_tai.plmn.mnc_digit2 = msg->plmn_id->mnc_digit2;
-          originating_tai.plmn.mnc_digit3 = msg->plmn_id->mnc_digit3;
-
-          rc = _emm_as_recv (msg->ue_id, &originating_tai, &msg->ecgi, plain_msg, bytes, emm_cause, &decode_status);
-        } else if (header.protocol_discriminator == EPS_SESSION_MANAGEMENT_MESSAGE) {
-          /*
-           * Foward ESM data to EPS session management
-           */
-          rc = lowerlayer_data_ind (msg->ue_id, plain_msg);
-        }
+      if ((bytes < 0) &&
+          (bytes != TLV_MAC_MISMATCH)) { // not in spec, (case identity response for attach with unknown GUTI)
+        /*
+         * Failed to decrypt the message
+         */
+        *emm_cause = EMM_CAUSE_PROTOCOL_ERROR;
+        OAILOG_FUNC_RETURN (LOG_NAS_EMM, bytes);
+      }
+      /*
+       * The plain NAS message ends the received one
+       */
+      bmid2tbstr (plain_msg, msg->nas_msg, blength(msg->nas_msg) - bytes, bytes);
 
-        bdestroy (plain_msg);
+      if (header.protocol_discriminator == EPS_MOBILITY_MANAGEMENT_MESSAGE) {
+        /*
+         * Process EMM data
+         */
+        tai_t                                   originating_tai = {.plmn = {0}, .tac = INVALID_TAC_0000}; // originating TAI
+        originating_tai.tac = msg->tac;
+        originating_tai.plmn.mcc_digit1 = msg->plmn_id->mcc_digit1;
+        originating_tai.plmn.mcc_digit2 = msg->plmn_id->mcc_digit2;
+        originating_tai.plmn.mcc_digit3 = msg->plmn_id->mcc_digit3;
+        originating_tai.plmn.mnc_digit1 = msg->plmn_id->mnc_digit1;
+        originating_tai.plmn.mnc_digit2 = msg->plmn_id->mnc_digit2;
+        originating_tai.plmn.mnc_digit3 = msg->plmn_id->mnc_digit3;
+
+        rc = _emm_as_recv (msg->ue_id, &originating_tai, &msg->ecgi, &plain_msg, blength(&plain_msg), emm_cause, &decode_status);
+      } else if (header.protocol_discriminator == EPS_SESSION_MANAGEMENT_MESSAGE) {
+        /*
+         * Foward ESM data to EPS session management
+         */
+        rc = lowerlayer_data_ind (msg->ue_id, &plain_msg);
       }
     } else {
       /*
@@ -588,7 +594,10 @@ static int _emm_as_establish_req (const emm_as_establish_t * msg, int *emm_cause
   /*
    * Decode initial NAS message
    */
+  nas_pdu_copy_uplink_message ();
+  OAI_PROBE2 (nas_decode_start, msg->ue_id, blength(msg->nas_msg));
   decoder_rc = nas_message_decode (msg->nas_msg->data, &nas_msg, blength(msg->nas_msg), emm_security_context, &decode_status);
+  OAI_PROBE3 (nas_decode_done, msg->ue_id, nas_msg.plain.emm.header.message_type, decoder_rc);
   bdestroy(msg->nas_msg);
 
   if (decoder_rc < TLV_FATAL_ERROR) {
@@ -799,7 +808,8 @@ static EMM_msg *_emm_as_set_header (nas_message_t * msg, const emm_as_security_d
  **                                                                        **
  ** Description: Encodes NAS message into NAS information container        **
  **                                                                        **
- ** Inputs:  msg:       The NAS message to encode                  **
+ ** Inputs:  ue_id:     UE identifier, for tracing                 **
+ **      msg:       The NAS message to encode                  **
  **      length:    The maximum length of the NAS message      **
  **      Others:    None                                       **
  **                                                                        **
@@ -809,7 +819,7 @@ static EMM_msg *_emm_as_set_header (nas_message_t * msg, const emm_as_security_d
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int _emm_as_encode (bstring *info, nas_message_t * msg,
+static int _emm_as_encode (mme_ue_s1ap_id_t ue_id, bstring *info, nas_message_t * msg,
   size_t length, emm_security_context_t * emm_security_context)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
@@ -838,7 +848,9 @@ static int _emm_as_encode (bstring *info, nas_message_t * msg,
     /*
      * Encode the NAS message
      */
+    OAI_PROBE2 (nas_encrypt_start, ue_id, (uint8_t)msg->header.security_header_type);
     bytes = nas_message_encode ((*info)->data, msg, length, emm_security_context);
+    OAI_PROBE3 (nas_encrypt_done, ue_id, (uint8_t)msg->header.security_header_type, bytes);
 
     if (bytes > 0) {
       (*info)->slen = bytes;
@@ -857,7 +869,8 @@ static int _emm_as_encode (bstring *info, nas_message_t * msg,
  **                                                                        **
  ** Description: Encryts NAS message into NAS information container        **
  **                                                                        **
- ** Inputs:  header:    The Security header in used                **
+ ** Inputs:  ue_id:     UE identifier, for tracing                 **
+ **      header:    The Security header in used                **
  **      msg:       The NAS message to encrypt                 **
  **      length:    The maximum length of the NAS message      **
  **      Others:    None                                       **
@@ -867,7 +880,7 @@ static int _emm_as_encode (bstring *info, nas_message_t * msg,
  **      Others:    None                                       **
  **                                                                        **
  ***************************************************************************/
-static int _emm_as_encrypt (bstring *info, const nas_message_security_header_t * header,
+static int _emm_as_encrypt (mme_ue_s1ap_id_t ue_id, bstring *info, const nas_message_security_header_t * header,
   const unsigned char *msg, size_t length, emm_security_context_t * emm_security_context)
 {
   OAILOG_FUNC_IN (LOG_NAS_EMM);
@@ -889,7 +902,9 @@ static int _emm_as_encrypt (bstring *info, const nas_message_security_header_t *
     /*
      * Encrypt the NAS information message
      */
+    OAI_PROBE2 (nas_encrypt_start, ue_id, (uint8_t)header->security_header_type);
     bytes = nas_message_encrypt (msg, (*info)->data, header, length, emm_security_context);
+    OAI_PROBE3 (nas_encrypt_done, ue_id, (uint8_t)header->security_header_type, bytes);
 
     if (bytes > 0) {
       (*info)->slen = bytes;
@@ -1101,12 +1116,12 @@ static int _emm_as_data_req (const emm_as_data_t * msg, dl_info_transfer_req_t *
       /*
        * Encode the NAS information message
        */
-      bytes = _emm_as_encode (&as_msg->nas_msg, &nas_msg, size, emm_security_context);
+      bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg, &nas_msg, size, emm_security_context);
     } else {
       /*
        * Encrypt the NAS information message
        */
-      bytes = _emm_as_encrypt (&as_msg->nas_msg, &nas_msg.header, msg->nas_msg->data, size, emm_security_context);
+      bytes = _emm_as_encrypt (as_msg->ue_id, &as_msg->nas_msg, &nas_msg.header, msg->nas_msg->data, size, emm_security_context);
     }
 
     if (bytes > 0) {
@@ -1190,7 +1205,7 @@ static int _emm_as_status_ind (const emm_as_status_t * msg, dl_info_transfer_req
     /*
      * Encode the NAS information message
      */
-    int                                     bytes = _emm_as_encode (&as_msg->nas_msg,
+    int                                     bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg,
                                                                     &nas_msg,
                                                                     size,
                                                                     emm_security_context);
@@ -1343,7 +1358,7 @@ static int _emm_as_security_req (const emm_as_security_t * msg, dl_info_transfer
     /*
      * Encode the NAS security message
      */
-    int                                     bytes = _emm_as_encode (&as_msg->nas_msg,
+    int                                     bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg,
                                                                     &nas_msg,
                                                                     size,
                                                                     emm_security_context);
@@ -1437,7 +1452,7 @@ static int _emm_as_security_rej (const emm_as_security_t * msg, dl_info_transfer
     /*
      * Encode the NAS security message
      */
-    int                                     bytes = _emm_as_encode (&as_msg->nas_msg,
+    int                                     bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg,
                                                                     &nas_msg,
                                                                     size,
                                                                     emm_security_context);
@@ -1551,7 +1566,7 @@ static int _emm_as_establish_cnf (const emm_as_establish_t * msg, nas_establish_
   /*
    * Encode the initial NAS information message
    */
-  int bytes = _emm_as_encode (&as_msg->nas_msg, &nas_msg, size, emm_security_context);
+  int bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg, &nas_msg, size, emm_security_context);
 
   if (bytes > 0) {
     as_msg->err_code = AS_SUCCESS;
@@ -1660,7 +1675,7 @@ static int _emm_as_establish_rej (const emm_as_establish_t * msg, nas_establish_
     /*
      * Encode the initial NAS information message
      */
-    int bytes = _emm_as_encode (&as_msg->nas_msg,
+    int bytes = _emm_as_encode (as_msg->ue_id, &as_msg->nas_msg,
                                                &nas_msg,
                                                size,
                                                emm_security_context);
@@ -315,6 +315,7 @@ typedef struct emm_data_s {
   hash_table_ts_t    *ctx_coll_ue_id; // key is emm ue id, data is struct emm_data_context_s
   hash_table_ts_t    *ctx_coll_imsi;  // key is imsi_t, data is emm ue id (unsigned int)
   obj_hash_table_t   *ctx_coll_guti;  // key is guti, data is emm ue id (unsigned int)
+  uint64_t            ctx_coll_ue_id_generation; // bumped on removal in ctx_coll_ue_id, see mme_app_ue_handle.h
 } emm_data_t;
 
 mme_ue_s1ap_id_t emm_ctx_get_new_ue_id(emm_data_context_t *ctxt) __attribute__((nonnull));
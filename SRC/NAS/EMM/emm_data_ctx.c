@@ -35,6 +35,7 @@
 #include "conversions.h"
 #include "emmData.h"
 #include "EmmCommon.h"
+#include "mme_app_ue_handle.h"
 
 static mme_ue_s1ap_id_t mme_ue_s1ap_id_generator = 1;
 
@@ -530,7 +531,20 @@ emm_data_context_get (
 
   DevAssert (emm_data );
   if (INVALID_MME_UE_S1AP_ID != ue_id) {
-    hashtable_ts_get (emm_data->ctx_coll_ue_id, (const hash_key_t)(ue_id), (void **)&emm_data_context_p);
+    emm_data_context_p = mme_app_ue_handle_emm_context (&emm_data->ctx_coll_ue_id_generation, ue_id);
+    if (!emm_data_context_p) {
+      hashtable_ts_get (emm_data->ctx_coll_ue_id, (const hash_key_t)(ue_id), (void **)&emm_data_context_p);
+      mme_app_ue_handle_probed_emm_context (ue_id, emm_data_context_p);
+    }
+#if DEBUG_IS_ON
+    else {
+      struct emm_data_context_s          *probed_p = NULL;
+
+      hashtable_ts_get (emm_data->ctx_coll_ue_id, (const hash_key_t)(ue_id), (void **)&probed_p);
+      AssertFatal (probed_p == emm_data_context_p, "UE handle of UE id " MME_UE_S1AP_ID_FMT " holds EMM context %p, collection %p\n",
+          ue_id, emm_data_context_p, probed_p);
+    }
+#endif
     OAILOG_INFO (LOG_NAS_EMM, "EMM-CTX - get UE id " MME_UE_S1AP_ID_FMT " context %p\n", ue_id, emm_data_context_p);
   }
   return emm_data_context_p;
@@ -623,6 +637,7 @@ emm_data_context_remove (
     emm_ctx_clear_imsi(elm);
   }
 
+  mme_app_ue_handle_forget (&emm_data->ctx_coll_ue_id_generation, elm->ue_id);
   hashtable_ts_remove (emm_data->ctx_coll_ue_id, (const hash_key_t)(elm->ue_id), (void **)&emm_data_context_p);
   return emm_data_context_p;
 }
@@ -422,6 +422,15 @@ void nas_itti_establish_cnf(
         emm_ctx->_security.ul_count.seq_num | (emm_ctx->_security.ul_count.overflow << 8),
         NAS_CONNECTION_ESTABLISHMENT_CNF(message_p).kenb);
 
+    if (IS_EMM_CTXT_VALID_LVR_TAI (emm_ctx)) {
+      NAS_CONNECTION_ESTABLISHMENT_CNF(message_p).last_tai = emm_ctx->_lvr_tai;
+    } else {
+      NAS_CONNECTION_ESTABLISHMENT_CNF(message_p).last_tai = emm_ctx->originating_tai;
+    }
+    if (IS_EMM_CTXT_VALID_TAI_LIST (emm_ctx)) {
+      NAS_CONNECTION_ESTABLISHMENT_CNF(message_p).tai_list = emm_ctx->_tai_list;
+    }
+
     MSC_LOG_TX_MESSAGE(
         MSC_NAS_MME,
         MSC_MMEAPP_MME,
@@ -41,6 +41,7 @@
 #include "mme_config.h"
 
 #include "intertask_interface_init.h"
+#include "intertask_interface_trace.h"
 
 #include "sctp_primitives_server.h"
 #include "udp_primitives_server.h"
@@ -57,6 +58,7 @@
 
 #include "oai_mme.h"
 #include "pid_file.h"
+#include "oai_clock.h"
 
 int
 main (
@@ -71,6 +73,7 @@ main (
    * Parse the command line for options and set the mme_config accordingly.
    */
   CHECK_INIT_RETURN (mme_config_parse_opt_line (argc, argv, &mme_config));
+  AssertFatal (mme_config.ipv4.sgw_s11, "No S-GW S11 address configured, the S-GW linked in the same process is only available in the epc executable\n");
 
   pid_dir = bstr2cstr(mme_config.pid_dir, 1);
   pid_dir = pid_dir ? pid_dir : "/var/run";
@@ -123,6 +126,9 @@ main (
   }
 #endif
 
+  // after the fork of DAEMONIZE, only the calling thread survives it
+  CHECK_INIT_RETURN (oai_clock_init (OAI_CLOCK_TICK_US));
+
   /*
    * Calling each layer init function
    */
@@ -134,7 +140,9 @@ main (
           NULL,
 #endif
           NULL));
+  CHECK_INIT_RETURN (itti_trace_init (bdata(mme_config.itti_config.trace_file), mme_config.itti_config.trace_sampling));
   MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
+  mme_app_set_task_shards (mme_config.itti_config.shards);
   CHECK_INIT_RETURN (nas_init (&mme_config));
   CHECK_INIT_RETURN (sctp_init (&mme_config));
   CHECK_INIT_RETURN (udp_init ());
@@ -53,6 +53,7 @@
 #include "gtpv1u_sgw_defs.h"
 #include "oai_sgw.h"
 #include "pid_file.h"
+#include "oai_clock.h"
 #include "timer.h"
 
 
@@ -113,6 +114,7 @@ main (
 #endif
 
 
+  CHECK_INIT_RETURN (oai_clock_init (OAI_CLOCK_TICK_US));
   CHECK_INIT_RETURN (OAILOG_INIT (LOG_SPGW_ENV, OAILOG_LEVEL_NOTICE, MAX_LOG_PROTOS));
   /*
    * Parse the command line for options and set the mme_config accordingly.
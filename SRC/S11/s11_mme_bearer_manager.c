@@ -270,3 +270,139 @@ s11_mme_handle_modify_bearer_response (
   DevAssert (NW_OK == rc);
   return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
 }
+
+//------------------------------------------------------------------------------
+int
+s11_mme_handle_downlink_data_notification (
+  NwGtpv2cStackHandleT * stack_p,
+  NwGtpv2cUlpApiT * pUlpApi)
+{
+  NwRcT                                   rc = NW_OK;
+  uint8_t                                 offendingIeType,
+                                          offendingIeInstance;
+  uint16_t                                offendingIeLength;
+  itti_s11_downlink_data_notification_t  *notif_p = NULL;
+  MessageDef                             *message_p = NULL;
+  NwGtpv2cMsgParserT                     *pMsgParser = NULL;
+
+  DevAssert (stack_p );
+  message_p = itti_alloc_new_message (TASK_S11, S11_DOWNLINK_DATA_NOTIFICATION);
+  notif_p = &message_p->ittiMsg.s11_downlink_data_notification;
+  memset((void*)notif_p, 0, sizeof(*notif_p));
+
+  notif_p->trxn = (void *)pUlpApi->apiInfo.initialReqIndInfo.hTrxn;
+  notif_p->peer_ip = pUlpApi->apiInfo.initialReqIndInfo.peerIp;
+  notif_p->teid = nwGtpv2cMsgGetTeid (pUlpApi->hMsg);
+  /*
+   * Create a new message parser
+   */
+  rc = nwGtpv2cMsgParserNew (*stack_p, NW_GTP_DOWNLINK_DATA_NOTIFICATION, s11_ie_indication_generic, NULL, &pMsgParser);
+  DevAssert (NW_OK == rc);
+  /*
+   * EPS Bearer ID IE
+   */
+  rc = nwGtpv2cMsgParserAddIe (pMsgParser, NW_GTPV2C_IE_EBI, NW_GTPV2C_IE_INSTANCE_ZERO, NW_GTPV2C_IE_PRESENCE_CONDITIONAL,
+      s11_ebi_ie_get, &notif_p->eps_bearer_id);
+  DevAssert (NW_OK == rc);
+
+  rc = nwGtpv2cMsgParserRun (pMsgParser, pUlpApi->hMsg, &offendingIeType, &offendingIeInstance, &offendingIeLength);
+
+  if (rc != NW_OK) {
+    MSC_LOG_RX_DISCARDED_MESSAGE (MSC_S11_MME, MSC_SGW, NULL, 0, "0 DOWNLINK_DATA_NOTIFICATION local S11 teid " TEID_FMT " ", notif_p->teid);
+    OAILOG_WARNING (LOG_S11, "Failed to parse DOWNLINK_DATA_NOTIFICATION for local S11 teid " TEID_FMT ", offending IE type %u instance %u\n",
+        notif_p->teid, offendingIeType, offendingIeInstance);
+    itti_free (ITTI_MSG_ORIGIN_ID (message_p), message_p);
+    message_p = NULL;
+    rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
+    DevAssert (NW_OK == rc);
+    rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+    DevAssert (NW_OK == rc);
+    return RETURNerror;
+  }
+
+  MSC_LOG_RX_MESSAGE (MSC_S11_MME, MSC_SGW, NULL, 0, "0 DOWNLINK_DATA_NOTIFICATION local S11 teid " TEID_FMT " ebi %u",
+    notif_p->teid, notif_p->eps_bearer_id);
+
+  rc = nwGtpv2cMsgParserDelete (*stack_p, pMsgParser);
+  DevAssert (NW_OK == rc);
+  rc = nwGtpv2cMsgDelete (*stack_p, (pUlpApi->hMsg));
+  DevAssert (NW_OK == rc);
+  return itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+int
+s11_mme_downlink_data_notification_acknowledge (
+  NwGtpv2cStackHandleT * stack_p,
+  itti_s11_downlink_data_notification_acknowledge_t * ack_p)
+{
+  gtp_cause_t                             cause;
+  NwRcT                                   rc;
+  NwGtpv2cUlpApiT                         ulp_req;
+
+  DevAssert (stack_p );
+  DevAssert (ack_p );
+  /*
+   * Prepare a downlink data notification acknowledge to send to S-GW.
+   */
+  memset (&ulp_req, 0, sizeof (NwGtpv2cUlpApiT));
+  memset (&cause, 0, sizeof (gtp_cause_t));
+  ulp_req.apiType = NW_GTPV2C_ULP_API_TRIGGERED_RSP;
+  ulp_req.apiInfo.triggeredRspInfo.hTrxn = (NwGtpv2cTrxnHandleT) ack_p->trxn;
+  rc = nwGtpv2cMsgNew (*stack_p, NW_TRUE, NW_GTP_DOWNLINK_DATA_NOTIFICATION_ACK, 0, 0, &(ulp_req.hMsg));
+  DevAssert (NW_OK == rc);
+  /*
+   * Set the remote TEID
+   */
+  rc = nwGtpv2cMsgSetTeid (ulp_req.hMsg, ack_p->teid);
+  DevAssert (NW_OK == rc);
+  cause.cause_value = (uint8_t) ack_p->cause;
+  s11_cause_ie_set (&(ulp_req.hMsg), &cause);
+  MSC_LOG_TX_MESSAGE (MSC_S11_MME, MSC_SGW, NULL, 0, "0 DOWNLINK_DATA_NOTIFICATION_ACKNOWLEDGE S11 teid " TEID_FMT " cause %u",
+    ack_p->teid, ack_p->cause);
+  rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+  DevAssert (NW_OK == rc);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+s11_mme_downlink_data_notification_failure_indication (
+  NwGtpv2cStackHandleT * stack_p,
+  itti_s11_downlink_data_notification_failure_indication_t * ind_p)
+{
+  gtp_cause_t                             cause;
+  NwRcT                                   rc;
+  NwGtpv2cUlpApiT                         ulp_req;
+
+  DevAssert (stack_p );
+  DevAssert (ind_p );
+  /*
+   * Prepare a downlink data notification failure indication to send to S-GW, no response is expected.
+   */
+  memset (&ulp_req, 0, sizeof (NwGtpv2cUlpApiT));
+  memset (&cause, 0, sizeof (gtp_cause_t));
+  ulp_req.apiType = NW_GTPV2C_ULP_API_INITIAL_REQ | NW_GTPV2C_ULP_API_FLAG_NO_RSP_EXPECTED;
+  rc = nwGtpv2cMsgNew (*stack_p, NW_TRUE, NW_GTP_DOWNLINK_DATA_NOTIFICATION_FAILURE_IND, ind_p->teid, 0, &(ulp_req.hMsg));
+  DevAssert (NW_OK == rc);
+  ulp_req.apiInfo.initialReqInfo.peerIp = ind_p->peer_ip;
+  ulp_req.apiInfo.initialReqInfo.teidLocal = ind_p->local_teid;
+
+  hashtable_rc_t hash_rc = hashtable_ts_get(s11_mme_teid_2_gtv2c_teid_handle,
+      (hash_key_t) ulp_req.apiInfo.initialReqInfo.teidLocal, (void **)(uintptr_t)&ulp_req.apiInfo.initialReqInfo.hTunnel);
+
+  if (HASH_TABLE_OK != hash_rc) {
+    OAILOG_WARNING (LOG_S11, "Could not get GTPv2-C hTunnel for local teid %X\n", ulp_req.apiInfo.initialReqInfo.teidLocal);
+    rc = nwGtpv2cMsgDelete (*stack_p, ulp_req.hMsg);
+    DevAssert (NW_OK == rc);
+    return RETURNerror;
+  }
+
+  cause.cause_value = (uint8_t) ind_p->cause;
+  s11_cause_ie_set (&(ulp_req.hMsg), &cause);
+  MSC_LOG_TX_MESSAGE (MSC_S11_MME, MSC_SGW, NULL, 0, "0 DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION S11 teid " TEID_FMT " cause %u",
+    ind_p->teid, ind_p->cause);
+  rc = nwGtpv2cProcessUlpReq (*stack_p, &ulp_req);
+  DevAssert (NW_OK == rc);
+  return RETURNok;
+}
@@ -33,4 +33,13 @@ int s11_mme_handle_release_access_bearer_response (NwGtpv2cStackHandleT * stack_
 /* @brief Handle a Modify Bearer Response received from S-GW. */
 int s11_mme_handle_modify_bearer_response (NwGtpv2cStackHandleT * stack_p, NwGtpv2cUlpApiT * pUlpApi);
 
+/* @brief Handle a Downlink Data Notification received from S-GW. */
+int s11_mme_handle_downlink_data_notification (NwGtpv2cStackHandleT * stack_p, NwGtpv2cUlpApiT * pUlpApi);
+
+/* @brief Acknowledge a Downlink Data Notification to S-GW. */
+int s11_mme_downlink_data_notification_acknowledge (NwGtpv2cStackHandleT * stack_p, itti_s11_downlink_data_notification_acknowledge_t * ack_p);
+
+/* @brief Tell S-GW that the UE did not answer the paging of a Downlink Data Notification. */
+int s11_mme_downlink_data_notification_failure_indication (NwGtpv2cStackHandleT * stack_p, itti_s11_downlink_data_notification_failure_indication_t * ind_p);
+
 #endif /* FILE_S11_MME_BEARER_MANAGER_SEEN */
@@ -28,9 +28,11 @@
 #include "assertions.h"
 #include "hashtable.h"
 #include "log.h"
+#include "probes.h"
 #include "msc.h"
 #include "mme_config.h"
 #include "intertask_interface.h"
+#include "intertask_interface_trace.h"
 #include "timer.h"
 #include "NwLog.h"
 #include "NwGtpv2c.h"
@@ -38,6 +40,7 @@
 #include "s11_mme.h"
 #include "s11_mme_session_manager.h"
 #include "s11_mme_bearer_manager.h"
+#include "mme_app_overload.h"
 
 static NwGtpv2cStackHandleT             s11_mme_stack_handle = 0;
 // Store the GTPv2-C teid handle
@@ -69,6 +72,10 @@ s11_mme_ulp_process_stack_req_cb (
   switch (pUlpApi->apiType) {
   case NW_GTPV2C_ULP_API_TRIGGERED_RSP_IND:
     OAILOG_DEBUG (LOG_S11, "Received triggered response indication\n");
+    OAI_PROBE2 (s11_response, pUlpApi->apiInfo.triggeredRspIndInfo.msgType, nwGtpv2cMsgGetTeid (pUlpApi->hMsg));
+    // messages sent by the handler belong to the procedure of the request
+    itti_trace_restore (ITTI_TRACE_KEY_S11_TEID (nwGtpv2cMsgGetTeid (pUlpApi->hMsg)), NULL);
+    mme_app_overload_transaction_end (MME_APP_OVERLOAD_S11);
 
     switch (pUlpApi->apiInfo.triggeredRspIndInfo.msgType) {
     case NW_GTP_CREATE_SESSION_RSP:
@@ -94,6 +101,27 @@ s11_mme_ulp_process_stack_req_cb (
 
     break;
 
+  case NW_GTPV2C_ULP_API_INITIAL_REQ_IND:
+    OAILOG_DEBUG (LOG_S11, "Received initial req indication\n");
+
+    switch (pUlpApi->apiInfo.initialReqIndInfo.msgType) {
+    case NW_GTP_DOWNLINK_DATA_NOTIFICATION:
+      ret = s11_mme_handle_downlink_data_notification (&s11_mme_stack_handle, pUlpApi);
+      break;
+
+    default:
+      OAILOG_WARNING (LOG_S11, "Received unhandled message type %d\n", pUlpApi->apiInfo.initialReqIndInfo.msgType);
+      break;
+    }
+
+    break;
+
+  case NW_GTPV2C_ULP_API_RSP_FAILURE_IND:
+    // N3 retransmissions without response, the request is given up
+    OAILOG_WARNING (LOG_S11, "Received response failure indication, no response from the SGW\n");
+    mme_app_overload_transaction_end (MME_APP_OVERLOAD_S11);
+    break;
+
   default:
     break;
   }
@@ -160,69 +188,106 @@ s11_mme_stop_timer_wrapper (
   return ((timer_remove (timer_id) == 0) ? NW_OK : NW_FAILURE);
 }
 
-static void                            *
-s11_mme_thread (
-  void *args)
+static void
+s11_mme_handle_message (
+  MessageDef * received_message_p)
 {
-  itti_mark_task_ready (TASK_S11);
-  OAILOG_START_USE ();
-  MSC_START_USE ();
-
-  while (1) {
-    MessageDef                             *received_message_p = NULL;
-
-    itti_receive_msg (TASK_S11, &received_message_p);
-    assert (received_message_p );
-
-    switch (ITTI_MSG_ID (received_message_p)) {
-    case S11_CREATE_SESSION_REQUEST:{
-        s11_mme_create_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_create_session_request);
+  assert (received_message_p );
+
+  switch (ITTI_MSG_ID (received_message_p)) {
+  case S11_CREATE_SESSION_REQUEST:{
+      OAI_PROBE3 (s11_request, NW_GTP_CREATE_SESSION_REQ, received_message_p->ittiMsg.s11_create_session_request.sender_fteid_for_cp.teid,
+          received_message_p->ittiMsg.s11_create_session_request.teid);
+      itti_trace_save (ITTI_TRACE_KEY_S11_TEID (received_message_p->ittiMsg.s11_create_session_request.sender_fteid_for_cp.teid));
+      if (RETURNok == s11_mme_create_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_create_session_request)) {
+        mme_app_overload_transaction_start (MME_APP_OVERLOAD_S11);
       }
-      break;
+    }
+    break;
 
-    case S11_MODIFY_BEARER_REQUEST:{
-        s11_mme_modify_bearer_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_request);
+  case S11_MODIFY_BEARER_REQUEST:{
+      OAI_PROBE3 (s11_request, NW_GTP_MODIFY_BEARER_REQ, received_message_p->ittiMsg.s11_modify_bearer_request.local_teid,
+          received_message_p->ittiMsg.s11_modify_bearer_request.teid);
+      itti_trace_save (ITTI_TRACE_KEY_S11_TEID (received_message_p->ittiMsg.s11_modify_bearer_request.local_teid));
+      if (RETURNok == s11_mme_modify_bearer_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_modify_bearer_request)) {
+        mme_app_overload_transaction_start (MME_APP_OVERLOAD_S11);
       }
-      break;
+    }
+    break;
 
 
-    case S11_DELETE_SESSION_REQUEST:{
-        s11_mme_delete_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_delete_session_request);
+  case S11_DELETE_SESSION_REQUEST:{
+      OAI_PROBE3 (s11_request, NW_GTP_DELETE_SESSION_REQ, received_message_p->ittiMsg.s11_delete_session_request.local_teid,
+          received_message_p->ittiMsg.s11_delete_session_request.teid);
+      itti_trace_save (ITTI_TRACE_KEY_S11_TEID (received_message_p->ittiMsg.s11_delete_session_request.local_teid));
+      if (RETURNok == s11_mme_delete_session_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_delete_session_request)) {
+        mme_app_overload_transaction_start (MME_APP_OVERLOAD_S11);
       }
-      break;
+    }
+    break;
 
-    case S11_RELEASE_ACCESS_BEARERS_REQUEST:{
-        s11_mme_release_access_bearers_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_request);
+  case S11_RELEASE_ACCESS_BEARERS_REQUEST:{
+      OAI_PROBE3 (s11_request, NW_GTP_RELEASE_ACCESS_BEARERS_REQ, received_message_p->ittiMsg.s11_release_access_bearers_request.local_teid,
+          received_message_p->ittiMsg.s11_release_access_bearers_request.teid);
+      itti_trace_save (ITTI_TRACE_KEY_S11_TEID (received_message_p->ittiMsg.s11_release_access_bearers_request.local_teid));
+      if (RETURNok == s11_mme_release_access_bearers_request (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_release_access_bearers_request)) {
+        mme_app_overload_transaction_start (MME_APP_OVERLOAD_S11);
       }
-      break;
+    }
+    break;
 
-    case UDP_DATA_IND:{
-        /*
-         * We received new data to handle from the UDP layer
-         */
-        NwRcT                                   rc;
-        udp_data_ind_t                         *udp_data_ind;
+  case S11_DOWNLINK_DATA_NOTIFICATION_ACKNOWLEDGE:{
+      s11_mme_downlink_data_notification_acknowledge (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_downlink_data_notification_acknowledge);
+    }
+    break;
 
-        udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
-        rc = nwGtpv2cProcessUdpReq (s11_mme_stack_handle, udp_data_ind->buffer, udp_data_ind->buffer_length, udp_data_ind->peer_port, udp_data_ind->peer_address);
-        DevAssert (rc == NW_OK);
-      }
-      break;
+  case S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION:{
+      s11_mme_downlink_data_notification_failure_indication (&s11_mme_stack_handle, &received_message_p->ittiMsg.s11_downlink_data_notification_failure_indication);
+    }
+    break;
 
-    case TIMER_HAS_EXPIRED:{
-        OAILOG_DEBUG (LOG_S11, "Processing timeout for timer_id 0x%lx and arg %p\n", received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
-        DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
-      }
-      break;
+  case UDP_DATA_IND:{
+      /*
+       * We received new data to handle from the UDP layer
+       */
+      NwRcT                                   rc;
+      udp_data_ind_t                         *udp_data_ind;
 
-    default:{
-        OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
-      }
-      break;
+      udp_data_ind = &received_message_p->ittiMsg.udp_data_ind;
+      rc = nwGtpv2cProcessUdpReq (s11_mme_stack_handle, udp_data_ind->buffer, udp_data_ind->buffer_length, udp_data_ind->peer_port, udp_data_ind->peer_address);
+      DevAssert (rc == NW_OK);
+    }
+    break;
+
+  case TIMER_HAS_EXPIRED:{
+      OAILOG_DEBUG (LOG_S11, "Processing timeout for timer_id 0x%lx and arg %p\n", received_message_p->ittiMsg.timer_has_expired.timer_id, received_message_p->ittiMsg.timer_has_expired.arg);
+      DevAssert (nwGtpv2cProcessTimeout (received_message_p->ittiMsg.timer_has_expired.arg) == NW_OK);
+    }
+    break;
+
+  default:{
+      OAILOG_ERROR (LOG_S11, "Unkwnon message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
     }
+    break;
+  }
 
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+  itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+}
+
+//------------------------------------------------------------------------------
+static void                            *
+s11_mme_thread (
+  void *args)
+{
+  itti_mark_task_ready (TASK_S11);
+  OAILOG_START_USE ();
+  MSC_START_USE ();
+
+  while (1) {
+    MessageDef                             *received_message_p = NULL;
+
+    itti_receive_msg (TASK_S11, &received_message_p);
+    s11_mme_handle_message (received_message_p);
   }
 
   return NULL;
@@ -287,7 +352,7 @@ s11_mme_init (
   logMgr.logReqCallback = s11_mme_log_wrapper;
   DevAssert (NW_OK == nwGtpv2cSetLogMgrEntity (s11_mme_stack_handle, &logMgr));
 
-  if (itti_create_task (TASK_S11, &s11_mme_thread, NULL) < 0) {
+  if (itti_create_task_handler (TASK_S11, &s11_mme_thread, &s11_mme_handle_message, NULL) < 0) {
     OAILOG_ERROR (LOG_S11, "gtpv1u phtread_create: %s\n", strerror (errno));
     goto fail;
   }
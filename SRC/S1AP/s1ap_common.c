@@ -32,6 +32,7 @@
 #include "s1ap_common.h"
 #include "dynamic_memory_check.h"
 #include "log.h"
+#include "nas_pdu_copy.h"
 
 int                                     asn_debug = 0;
 int                                     asn1_xer_print = 0;
@@ -178,6 +179,39 @@ s1ap_new_ie (
   return buff;
 }
 
+bstring
+s1ap_take_nas_pdu (
+  S1ap_NAS_PDU_t * const nas_pdu)
+{
+  bstring                                 b = NULL;
+  uint8_t                                *buf = NULL;
+
+  /*
+   * The decoded S1AP message does not free its IEs, the buffer of the NAS-PDU can become the NAS message.
+   * A bstring needs room for its terminating '\0' (mlen > slen): the buffer grows by one byte, in place
+   * unless the allocator has no room left after it.
+   */
+  if ((nas_pdu->buf) && (0 < nas_pdu->size)) {
+    b = calloc (1, sizeof (*b));
+    buf = (b) ? realloc (nas_pdu->buf, nas_pdu->size + 1) : NULL;
+    if (buf) {
+      if (buf != nas_pdu->buf) {
+        nas_pdu_copy_count (NAS_PDU_COPY_S1AP, nas_pdu->size);
+      }
+      buf[nas_pdu->size] = '\0';
+      b->mlen = nas_pdu->size + 1;
+      b->slen = nas_pdu->size;
+      b->data = buf;
+      nas_pdu->buf = NULL;
+      nas_pdu->size = 0;
+      return b;
+    }
+    free_wrapper ((void**)&b);
+  }
+  nas_pdu_copy_count (NAS_PDU_COPY_S1AP, nas_pdu->size);
+  return blk2bstr (nas_pdu->buf, nas_pdu->size);
+}
+
 // TODO: (amar) Unused function check with OAI
 void
 s1ap_handle_criticality (
@@ -462,6 +462,12 @@ S1ap_IE_t *s1ap_new_ie(S1ap_ProtocolIE_ID_t   id,
                        asn_TYPE_descriptor_t *type,
                        void                  *sptr);
 
+/** \brief NAS message of a NAS-PDU decoded by the ASN.1 codec, its buffer is taken over
+ \param nas_pdu NAS-PDU IE of the decoded message, left empty
+ @returns the NAS message, a copy of the NAS-PDU only if its buffer could not be taken over
+ **/
+bstring s1ap_take_nas_pdu(S1ap_NAS_PDU_t * const nas_pdu);
+
 /** \brief Handle criticality
  \param criticality Criticality of the IE
  @returns void
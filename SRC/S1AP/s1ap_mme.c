@@ -29,6 +29,7 @@
 #include <stdbool.h>
 
 #include "dynamic_memory_check.h"
+#include "bstr_pool.h"
 #include "intertask_interface.h"
 #include "assertions.h"
 #include "mme_app_statistics.h"
@@ -37,7 +38,10 @@
 #include "s1ap_mme_handlers.h"
 #include "s1ap_mme_nas_procedures.h"
 #include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme_paging.h"
+#include "s1ap_mme_overload.h"
 #include "timer.h"
+#include "probes.h"
 
 #if S1AP_DEBUG_LIST
 #  define eNB_LIST_OUT(x, args...) OAILOG_DEBUG (LOG_S1AP, "[eNB]%*s"x"\n", 4*indent, "", ##args)
@@ -80,136 +84,163 @@ static int s1ap_send_init_sctp (void)
 }
 
 //------------------------------------------------------------------------------
-void                                   *
-s1ap_mme_thread (
-  __attribute__((unused)) void *args)
+static void s1ap_mme_handle_itti_message (
+  MessageDef * received_message_p)
 {
-  itti_mark_task_ready (TASK_S1AP);
-  OAILOG_START_USE ();
-  MSC_START_USE ();
+  DevAssert (received_message_p != NULL);
 
-  while (1) {
-    MessageDef                             *received_message_p = NULL;
-    /*
-     * Trying to fetch a message from the message queue.
-     * * * * If the queue is empty, this function will block till a
-     * * * * message is sent to the task.
-     */
-    itti_receive_msg (TASK_S1AP, &received_message_p);
-    DevAssert (received_message_p != NULL);
+  switch (ITTI_MSG_ID (received_message_p)) {
+  case ACTIVATE_MESSAGE:{
+      hss_associated = true;
+    }
+    break;
 
-    switch (ITTI_MSG_ID (received_message_p)) {
-    case ACTIVATE_MESSAGE:{
-        hss_associated = true;
-      }
-      break;
-
-    case SCTP_DATA_IND:{
-        /*
-         * New message received from SCTP layer.
-         * * * * Decode and handle it.
-         */
-        s1ap_message                            message = {0};
-
-        /*
-         * Invoke S1AP message decoder
-         */
-        if (s1ap_mme_decode_pdu (&message, SCTP_DATA_IND (received_message_p).payload) < 0) {
-          // TODO: Notify eNB of failure with right cause
-          OAILOG_ERROR (LOG_S1AP, "Failed to decode new buffer\n");
-        } else {
-          s1ap_mme_handle_message (SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream, &message);
-        }
+  case SCTP_DATA_IND:{
+      /*
+       * New message received from SCTP layer.
+       * * * * Decode and handle it.
+       */
+      s1ap_message                            message = {0};
+      int                                     rc = 0;
 
-        /*
-         * Free received PDU array
-         */
-        bdestroy (SCTP_DATA_IND (received_message_p).payload);
+      /*
+       * Invoke S1AP message decoder
+       */
+      OAI_PROBE3 (s1ap_decode_start, SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream,
+          blength (SCTP_DATA_IND (received_message_p).payload));
+      rc = s1ap_mme_decode_pdu (&message, SCTP_DATA_IND (received_message_p).payload);
+      OAI_PROBE5 (s1ap_decode_done, SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream,
+          message.procedureCode, message.direction, rc);
+      if (rc < 0) {
+        // TODO: Notify eNB of failure with right cause
+        OAILOG_ERROR (LOG_S1AP, "Failed to decode new buffer\n");
+      } else {
+        s1ap_mme_handle_message (SCTP_DATA_IND (received_message_p).assoc_id, SCTP_DATA_IND (received_message_p).stream, &message);
       }
-      break;
 
-    case SCTP_DATA_CNF:
-      s1ap_mme_itti_nas_downlink_cnf(SCTP_DATA_CNF (received_message_p).mme_ue_s1ap_id, SCTP_DATA_CNF (received_message_p).is_success);
-      break;
       /*
-       * SCTP layer notifies S1AP of disconnection of a peer.
+       * Give back the receive buffer, the decoded message does not point into it
        */
-    case SCTP_CLOSE_ASSOCIATION:{
-      s1ap_handle_sctp_disconnection(SCTP_CLOSE_ASSOCIATION (received_message_p).assoc_id,
-                                     SCTP_CLOSE_ASSOCIATION (received_message_p).reset);
-      }
-      break;
+      bstr_pool_release (&SCTP_DATA_IND (received_message_p).payload);
+    }
+    break;
 
-    case SCTP_NEW_ASSOCIATION:{
-        s1ap_handle_new_association (&received_message_p->ittiMsg.sctp_new_peer);
-      }
-      break;
-
-    case S1AP_NAS_DL_DATA_REQ:{
-        /*
-         * New message received from NAS task.
-         * * * * This corresponds to a S1AP downlink nas transport message.
-         */
-        s1ap_generate_downlink_nas_transport (S1AP_NAS_DL_DATA_REQ (received_message_p).enb_ue_s1ap_id,
-            S1AP_NAS_DL_DATA_REQ (received_message_p).mme_ue_s1ap_id,
-            &S1AP_NAS_DL_DATA_REQ (received_message_p).nas_msg);
-      }
-      break;
+  case SCTP_DATA_CNF:
+    s1ap_mme_itti_nas_downlink_cnf(SCTP_DATA_CNF (received_message_p).mme_ue_s1ap_id, SCTP_DATA_CNF (received_message_p).is_success);
+    break;
+    /*
+     * SCTP layer notifies S1AP of disconnection of a peer.
+     */
+  case SCTP_CLOSE_ASSOCIATION:{
+    s1ap_handle_sctp_disconnection(SCTP_CLOSE_ASSOCIATION (received_message_p).assoc_id,
+                                   SCTP_CLOSE_ASSOCIATION (received_message_p).reset);
+    }
+    break;
 
-    case S1AP_UE_CONTEXT_RELEASE_COMMAND:{
-        s1ap_handle_ue_context_release_command (&received_message_p->ittiMsg.s1ap_ue_context_release_command);
-      }
-      break;
+  case SCTP_NEW_ASSOCIATION:{
+      s1ap_handle_new_association (&received_message_p->ittiMsg.sctp_new_peer);
+    }
+    break;
 
-    case MME_APP_CONNECTION_ESTABLISHMENT_CNF:{
-        s1ap_handle_conn_est_cnf (&MME_APP_CONNECTION_ESTABLISHMENT_CNF (received_message_p));
-      }
-      break;
-    
-    case MME_APP_S1AP_MME_UE_ID_NOTIFICATION:{
-        s1ap_handle_mme_ue_id_notification (&MME_APP_S1AP_MME_UE_ID_NOTIFICATION (received_message_p));
-      }
-      break;
-
-    case TIMER_HAS_EXPIRED:{
-        ue_description_t                       *ue_ref_p = NULL;
-        if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
-          mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
-          if ((ue_ref_p = s1ap_is_ue_mme_id_in_list (mme_ue_s1ap_id)) == NULL) {
-            OAILOG_WARNING (LOG_S1AP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
-            break;
-          }
-          if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_ref_p->s1ap_ue_context_rel_timer.id) {
-            // UE context release complete timer expiry handler 
-            s1ap_mme_handle_ue_context_rel_comp_timer_expiry (ue_ref_p);
-          } 
-        }
-        
-        /* TODO - Commenting out below function as it is not used as of now. 
-         * Need to handle it when we support other timers in S1AP
-         */
+  case S1AP_NAS_DL_DATA_REQ:{
+      /*
+       * New message received from NAS task.
+       * * * * This corresponds to a S1AP downlink nas transport message.
+       */
+      s1ap_generate_downlink_nas_transport (S1AP_NAS_DL_DATA_REQ (received_message_p).enb_ue_s1ap_id,
+          S1AP_NAS_DL_DATA_REQ (received_message_p).mme_ue_s1ap_id,
+          &S1AP_NAS_DL_DATA_REQ (received_message_p).nas_msg);
+    }
+    break;
 
-        //s1ap_handle_timer_expiry (&received_message_p->ittiMsg.timer_has_expired);
-      }
-      break;
+  case S1AP_PAGING_REQUEST:{
+      s1ap_mme_handle_paging_request (&S1AP_PAGING_REQUEST (received_message_p));
+    }
+    break;
 
-    case TERMINATE_MESSAGE:{
-        itti_exit_task ();
-      }
-      break;
+  case S1AP_OVERLOAD_START:{
+      s1ap_mme_handle_overload_start (&S1AP_OVERLOAD_START (received_message_p));
+    }
+    break;
 
-    case MESSAGE_TEST:
-      OAILOG_DEBUG (LOG_S1AP, "Received MESSAGE_TEST\n");
-      break;
+  case S1AP_OVERLOAD_STOP:{
+      s1ap_mme_handle_overload_stop (&S1AP_OVERLOAD_STOP (received_message_p));
+    }
+    break;
+
+  case S1AP_UE_CONTEXT_RELEASE_COMMAND:{
+      s1ap_handle_ue_context_release_command (&received_message_p->ittiMsg.s1ap_ue_context_release_command);
+    }
+    break;
 
-    default:{
-        OAILOG_ERROR (LOG_S1AP, "Unknown message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+  case MME_APP_CONNECTION_ESTABLISHMENT_CNF:{
+      s1ap_handle_conn_est_cnf (&MME_APP_CONNECTION_ESTABLISHMENT_CNF (received_message_p));
+    }
+    break;
+  
+  case MME_APP_S1AP_MME_UE_ID_NOTIFICATION:{
+      s1ap_handle_mme_ue_id_notification (&MME_APP_S1AP_MME_UE_ID_NOTIFICATION (received_message_p));
+    }
+    break;
+
+  case TIMER_HAS_EXPIRED:{
+      ue_description_t                       *ue_ref_p = NULL;
+      if (received_message_p->ittiMsg.timer_has_expired.arg != NULL) { 
+        mme_ue_s1ap_id_t mme_ue_s1ap_id = *((mme_ue_s1ap_id_t *)(received_message_p->ittiMsg.timer_has_expired.arg));
+        if ((ue_ref_p = s1ap_is_ue_mme_id_in_list (mme_ue_s1ap_id)) == NULL) {
+          OAILOG_WARNING (LOG_S1AP, "Timer expired but no assoicated UE context for UE id %d\n",mme_ue_s1ap_id);
+          break;
+        }
+        if (received_message_p->ittiMsg.timer_has_expired.timer_id == ue_ref_p->s1ap_ue_context_rel_timer.id) {
+          // UE context release complete timer expiry handler 
+          s1ap_mme_handle_ue_context_rel_comp_timer_expiry (ue_ref_p);
+        } 
       }
-      break;
+      
+      /* TODO - Commenting out below function as it is not used as of now. 
+       * Need to handle it when we support other timers in S1AP
+       */
+
+      //s1ap_handle_timer_expiry (&received_message_p->ittiMsg.timer_has_expired);
+    }
+    break;
+
+  case TERMINATE_MESSAGE:{
+      itti_exit_task ();
     }
+    break;
 
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+  case MESSAGE_TEST:
+    OAILOG_DEBUG (LOG_S1AP, "Received MESSAGE_TEST\n");
+    break;
+
+  default:{
+      OAILOG_ERROR (LOG_S1AP, "Unknown message ID %d:%s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+    }
+    break;
+  }
+
+  itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+}
+
+//------------------------------------------------------------------------------
+void                                   *
+s1ap_mme_thread (
+  __attribute__((unused)) void *args)
+{
+  itti_mark_task_ready (TASK_S1AP);
+  OAILOG_START_USE ();
+  MSC_START_USE ();
+
+  while (1) {
+    MessageDef                             *received_message_p = NULL;
+    /*
+     * Trying to fetch a message from the message queue.
+     * * * * If the queue is empty, this function will block till a
+     * * * * message is sent to the task.
+     */
+    itti_receive_msg (TASK_S1AP, &received_message_p);
+    s1ap_mme_handle_itti_message (received_message_p);
   }
 
   return NULL;
@@ -240,7 +271,9 @@ s1ap_mme_init(void)
   bdestroy(bs2);
   if (!h) return RETURNerror;
 
-  if (itti_create_task (TASK_S1AP, &s1ap_mme_thread, NULL) < 0) {
+  if (s1ap_mme_paging_init () < 0) return RETURNerror;
+
+  if (itti_create_task_handler (TASK_S1AP, &s1ap_mme_thread, &s1ap_mme_handle_itti_message, NULL) < 0) {
     OAILOG_ERROR (LOG_S1AP, "Error while creating S1AP task\n");
     return RETURNerror;
   }
@@ -604,6 +637,7 @@ s1ap_remove_enb (
 {
   if (enb_ref == NULL)
     return;
+  s1ap_mme_paging_remove_enb(enb_ref);
   hashtable_ts_destroy(&enb_ref->ue_coll);
   hashtable_ts_free (&g_s1ap_enb_coll, enb_ref->sctp_assoc_id);
   nb_enb_associated--;
@@ -104,6 +104,13 @@ typedef struct enb_description_s {
   uint8_t  default_paging_drx; ///< Default paging DRX interval for eNB
   /*@}*/
 
+  /** Paging **/
+  /*@{*/
+  int      nb_supported_tai;   ///< Number of tracking areas supported by the eNB
+  tai_t   *supported_tai;      ///< Tracking areas of the S1 SETUP REQUEST, the eNB is indexed under each of them
+  uint32_t paging_round;       ///< Last paging that selected this eNB
+  /*@}*/
+
   /** UE list for this eNB **/
   /*@{*/
   uint32_t nb_ue_associated; ///< Number of NAS associated UE on this eNB
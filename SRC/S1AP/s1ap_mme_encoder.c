@@ -33,6 +33,7 @@
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_encoder.h"
 #include "assertions.h"
+#include "probes.h"
 
 static inline int                       s1ap_mme_encode_initial_context_setup_request (
   s1ap_message * message_p,
@@ -54,6 +55,18 @@ static inline int                       s1ap_mme_encode_downlink_nas_transport (
   s1ap_message * message_p,
   uint8_t ** buffer,
   uint32_t * length);
+static inline int                       s1ap_mme_encode_paging (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_overload_start (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
+static inline int                       s1ap_mme_encode_overload_stop (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length);
 
 static inline int                       s1ap_mme_encode_initiating (
   s1ap_message * message_p,
@@ -92,26 +105,33 @@ s1ap_mme_encode_pdu (
   uint8_t ** buffer,
   uint32_t * length)
 {
+  int                                     rc = -1;
+
   DevAssert (message_p != NULL);
   DevAssert (buffer != NULL);
   DevAssert (length != NULL);
+  OAI_PROBE2 (s1ap_encode_start, message_p->procedureCode, message_p->direction);
 
   switch (message_p->direction) {
   case S1AP_PDU_PR_initiatingMessage:
-    return s1ap_mme_encode_initiating (message_p, buffer, length);
+    rc = s1ap_mme_encode_initiating (message_p, buffer, length);
+    break;
 
   case S1AP_PDU_PR_successfulOutcome:
-    return s1ap_mme_encode_successfull_outcome (message_p, buffer, length);
+    rc = s1ap_mme_encode_successfull_outcome (message_p, buffer, length);
+    break;
 
   case S1AP_PDU_PR_unsuccessfulOutcome:
-    return s1ap_mme_encode_unsuccessfull_outcome (message_p, buffer, length);
+    rc = s1ap_mme_encode_unsuccessfull_outcome (message_p, buffer, length);
+    break;
 
   default:
     OAILOG_DEBUG (LOG_S1AP, "Unknown message outcome (%d) or not implemented", (int)message_p->direction);
     break;
   }
 
-  return -1;
+  OAI_PROBE4 (s1ap_encode_done, message_p->procedureCode, message_p->direction, (0 > rc) ? 0 : *length, rc);
+  return rc;
 }
 
 static inline int
@@ -130,6 +150,15 @@ s1ap_mme_encode_initiating (
   case S1ap_ProcedureCode_id_UEContextRelease:
     return s1ap_mme_encode_ue_context_release_command (message_p, buffer, length);
 
+  case S1ap_ProcedureCode_id_Paging:
+    return s1ap_mme_encode_paging (message_p, buffer, length);
+
+  case S1ap_ProcedureCode_id_OverloadStart:
+    return s1ap_mme_encode_overload_start (message_p, buffer, length);
+
+  case S1ap_ProcedureCode_id_OverloadStop:
+    return s1ap_mme_encode_overload_stop (message_p, buffer, length);
+
   default:
     OAILOG_DEBUG (LOG_S1AP, "Unknown procedure ID (%d) for initiating message_p\n", (int)message_p->procedureCode);
     break;
@@ -234,6 +263,69 @@ s1ap_mme_encode_downlink_nas_transport (
   return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_downlinkNASTransport, message_p->criticality, &asn_DEF_S1ap_DownlinkNASTransport, downlinkNasTransport_p);
 }
 
+static inline int
+s1ap_mme_encode_paging (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_Paging_t                           paging;
+  S1ap_Paging_t                          *paging_p = &paging;
+
+  memset (paging_p, 0, sizeof (S1ap_Paging_t));
+
+  /*
+   * Convert IE structure into asn1 message_p
+   */
+  if (s1ap_encode_s1ap_pagingies (paging_p, &message_p->msg.s1ap_PagingIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_Paging, message_p->criticality, &asn_DEF_S1ap_Paging, paging_p);
+}
+
+static inline int
+s1ap_mme_encode_overload_start (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_OverloadStart_t                    overloadStart;
+  S1ap_OverloadStart_t                   *overloadStart_p = &overloadStart;
+
+  memset (overloadStart_p, 0, sizeof (S1ap_OverloadStart_t));
+
+  /*
+   * Convert IE structure into asn1 message_p
+   */
+  if (s1ap_encode_s1ap_overloadstarties (overloadStart_p, &message_p->msg.s1ap_OverloadStartIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_OverloadStart, message_p->criticality, &asn_DEF_S1ap_OverloadStart, overloadStart_p);
+}
+
+static inline int
+s1ap_mme_encode_overload_stop (
+  s1ap_message * message_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_OverloadStop_t                     overloadStop;
+  S1ap_OverloadStop_t                    *overloadStop_p = &overloadStop;
+
+  memset (overloadStop_p, 0, sizeof (S1ap_OverloadStop_t));
+
+  /*
+   * Convert IE structure into asn1 message_p
+   */
+  if (s1ap_encode_s1ap_overloadstopies (overloadStop_p, &message_p->msg.s1ap_OverloadStopIEs) < 0) {
+    return -1;
+  }
+
+  return s1ap_generate_initiating_message (buffer, length, S1ap_ProcedureCode_id_OverloadStop, message_p->criticality, &asn_DEF_S1ap_OverloadStop, overloadStop_p);
+}
+
 static inline int
 s1ap_mme_encode_ue_context_release_command (
   s1ap_message * message_p,
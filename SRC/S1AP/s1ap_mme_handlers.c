@@ -39,8 +39,11 @@
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_ta.h"
+#include "s1ap_mme_paging.h"
+#include "s1ap_mme_overload.h"
 #include "mme_app_statistics.h"
 #include "timer.h"
+#include "intertask_interface_trace.h"
 
 
 extern hash_table_ts_t g_s1ap_enb_coll; // contains eNB_description_s, key is eNB_description_s.assoc_id
@@ -390,10 +393,12 @@ s1ap_mme_handle_s1_setup_request (
     enb_association->enb_name[s1SetupRequest_p->eNBname.size] = '\0';
   }
 
+  s1ap_mme_paging_add_enb_supported_tas(enb_association, &s1SetupRequest_p->supportedTAs);
   s1ap_dump_enb(enb_association);
   rc = s1ap_generate_s1_setup_response(enb_association);
   if (rc == RETURNok) {
     update_mme_app_stats_connected_enb_add();
+    s1ap_mme_overload_enb_ready(enb_association);
   }
   OAILOG_FUNC_RETURN (LOG_S1AP, rc);
 }
@@ -609,6 +614,7 @@ s1ap_mme_handle_initial_context_setup_response (
   }
 
   ue_ref_p->s1_ue_state = S1AP_UE_CONNECTED;
+  itti_trace_restore (ITTI_TRACE_KEY_S1AP_UE (ue_ref_p->mme_ue_s1ap_id), NULL);
   message_p = itti_alloc_new_message (TASK_S1AP, MME_APP_INITIAL_CONTEXT_SETUP_RSP);
   AssertFatal (message_p != NULL, "itti_alloc_new_message Failed");
   memset ((void *)&message_p->ittiMsg.mme_app_initial_context_setup_rsp, 0, sizeof (itti_mme_app_initial_context_setup_rsp_t));
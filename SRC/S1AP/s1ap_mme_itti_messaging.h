@@ -53,8 +53,7 @@ static inline void s1ap_mme_itti_mme_app_initial_ue_message(
   const uint32_t          enb_id,
   const enb_ue_s1ap_id_t  enb_ue_s1ap_id,
   const mme_ue_s1ap_id_t  mme_ue_s1ap_id,
-  const uint8_t * const   nas_msg,
-  const size_t            nas_msg_length,
+  STOLEN_REF bstring     *nas_msg,
   const tai_t      const* tai,
   const ecgi_t     const* cgi,
   const long              rrc_cause,
@@ -68,7 +67,7 @@ static inline void s1ap_mme_itti_mme_app_initial_ue_message(
   MessageDef  *message_p = NULL;
 
   OAILOG_FUNC_IN (LOG_S1AP);
-  AssertFatal((nas_msg_length < 1000), "Bad length for NAS message %lu", nas_msg_length);
+  AssertFatal((blength(*nas_msg) < 1000), "Bad length for NAS message %d", blength(*nas_msg));
   message_p = itti_alloc_new_message(TASK_S1AP, MME_APP_INITIAL_UE_MESSAGE);
 
   MME_APP_INITIAL_UE_MESSAGE(message_p).sctp_assoc_id          = assoc_id;
@@ -76,7 +75,8 @@ static inline void s1ap_mme_itti_mme_app_initial_ue_message(
   MME_APP_INITIAL_UE_MESSAGE(message_p).enb_ue_s1ap_id         = enb_ue_s1ap_id;
   MME_APP_INITIAL_UE_MESSAGE(message_p).mme_ue_s1ap_id         = mme_ue_s1ap_id;
 
-  MME_APP_INITIAL_UE_MESSAGE(message_p).nas                    = blk2bstr(nas_msg, nas_msg_length);
+  MME_APP_INITIAL_UE_MESSAGE(message_p).nas                    = *nas_msg;
+  *nas_msg = NULL;
 
   MME_APP_INITIAL_UE_MESSAGE(message_p).tai                    = *tai;
   MME_APP_INITIAL_UE_MESSAGE(message_p).cgi                    = *cgi;
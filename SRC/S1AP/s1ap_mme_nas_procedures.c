@@ -27,15 +27,18 @@
 #include "assertions.h"
 #include "hashtable.h"
 #include "log.h"
+#include "probes.h"
 #include "msc.h"
 #include "conversions.h"
 #include "intertask_interface.h"
+#include "intertask_interface_trace.h"
 #include "asn1_conversions.h"
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_encoder.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
+#include "s1ap_mme_overload.h"
 
 /* Every time a new UE is associated, increment this variable.
    But care if it wraps to increment also the mme_ue_s1ap_id_has_wrapped
@@ -74,6 +77,7 @@ s1ap_mme_handle_initial_ue_message (
   }
   // eNB UE S1AP ID is limited to 24 bits
   enb_ue_s1ap_id = (enb_ue_s1ap_id_t) (initialUEMessage_p->eNB_UE_S1AP_ID & 0x00ffffff);
+  OAI_PROBE4 (s1ap_ue_rx, message->procedureCode, assoc_id, enb_ue_s1ap_id, INVALID_MME_UE_S1AP_ID);
   OAILOG_INFO (LOG_S1AP, "New Initial UE message received with eNB UE S1AP ID: " ENB_UE_S1AP_ID_FMT "\n", enb_ue_s1ap_id);
   ue_ref = s1ap_is_ue_enb_id_in_list (eNB_ref, enb_ue_s1ap_id);
 
@@ -90,6 +94,11 @@ s1ap_mme_handle_initial_ue_message (
      * * * * Update eNB UE list.
      * * * * Forward message to NAS.
      */
+    if (!s1ap_mme_overload_admit (enb_ue_s1ap_id, initialUEMessage_p->rrC_Establishment_Cause)) {
+      // MME overloaded, no UE context is created: the eNB releases the RRC connection on its own
+      MSC_LOG_EVENT (MSC_S1AP_MME, "0 initialUEMessage dropped overload " ENB_UE_S1AP_ID_FMT " cause %ld", enb_ue_s1ap_id, initialUEMessage_p->rrC_Establishment_Cause);
+      OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+    }
     if ((ue_ref = s1ap_new_ue (assoc_id, enb_ue_s1ap_id)) == NULL) {
       // If we failed to allocate a new UE return -1
       OAILOG_ERROR (LOG_S1AP, "S1AP:Initial UE Message- Failed to allocate S1AP UE Context, eNBUeS1APId:" ENB_UE_S1AP_ID_FMT "\n", enb_ue_s1ap_id);
@@ -166,12 +175,13 @@ s1ap_mme_handle_initial_ue_message (
         initialUEMessage_p->rrC_Establishment_Cause,
         &tai, &cgi, &s_tmsi, &gummei);
 #else
+    bstring nas = s1ap_take_nas_pdu (&initialUEMessage_p->nas_pdu);
+
     s1ap_mme_itti_mme_app_initial_ue_message (assoc_id,
         ue_ref->enb->enb_id,
         ue_ref->enb_ue_s1ap_id,
         ue_ref->mme_ue_s1ap_id,
-        initialUEMessage_p->nas_pdu.buf,
-        initialUEMessage_p->nas_pdu.size,
+        &nas,
         &tai,
         &ecgi,
         initialUEMessage_p->rrC_Establishment_Cause,
@@ -231,6 +241,10 @@ s1ap_mme_handle_uplink_nas_transport (
 
 
 
+  OAI_PROBE4 (s1ap_ue_rx, message->procedureCode, assoc_id, ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
+  // the NAS message answers the last downlink one
+  itti_trace_restore (ITTI_TRACE_KEY_S1AP_UE (ue_ref->mme_ue_s1ap_id), NULL);
+
   if (S1AP_UE_CONNECTED != ue_ref->s1_ue_state) {
     OAILOG_WARNING (LOG_S1AP, "Received S1AP UPLINK_NAS_TRANSPORT while UE in state != S1AP_UE_CONNECTED\n");
     MSC_LOG_RX_DISCARDED_MESSAGE (MSC_S1AP_MME,
@@ -267,7 +281,7 @@ s1ap_mme_handle_uplink_nas_transport (
                       (enb_ue_s1ap_id_t)uplinkNASTransport_p->eNB_UE_S1AP_ID,
                       uplinkNASTransport_p->nas_pdu.size);
 
-  bstring b = blk2bstr(uplinkNASTransport_p->nas_pdu.buf, uplinkNASTransport_p->nas_pdu.size);
+  bstring b = s1ap_take_nas_pdu (&uplinkNASTransport_p->nas_pdu);
   s1ap_mme_itti_nas_uplink_ind (uplinkNASTransport_p->mme_ue_s1ap_id,
                                 &b,
                                 &tai,
@@ -401,6 +415,8 @@ s1ap_generate_downlink_nas_transport (
                         NULL, 0,
                         "0 downlinkNASTransport/initiatingMessage ue_id " MME_UE_S1AP_ID_FMT " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " enb_ue_s1ap_id" ENB_UE_S1AP_ID_FMT " nas length %u",
                         ue_id, (mme_ue_s1ap_id_t)downlinkNasTransport->mme_ue_s1ap_id, (enb_ue_s1ap_id_t)downlinkNasTransport->eNB_UE_S1AP_ID, length);
+    OAI_PROBE4 (s1ap_ue_tx, message.procedureCode, ue_ref->enb->sctp_assoc_id, ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
+    itti_trace_save (ITTI_TRACE_KEY_S1AP_UE (ue_ref->mme_ue_s1ap_id));
     bstring b = blk2bstr(buffer_p, length);
     s1ap_mme_itti_send_sctp_request (&b , ue_ref->enb->sctp_assoc_id, ue_ref->sctp_stream_send, ue_ref->mme_ue_s1ap_id);
   }
@@ -571,6 +587,8 @@ s1ap_handle_conn_est_cnf (
                       "0 InitialContextSetup/initiatingMessage mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT " nas length %u",
                       (mme_ue_s1ap_id_t)initialContextSetupRequest_p->mme_ue_s1ap_id,
                       (enb_ue_s1ap_id_t)initialContextSetupRequest_p->eNB_UE_S1AP_ID, nas_pdu.size);
+  OAI_PROBE4 (s1ap_ue_tx, message.procedureCode, ue_ref->enb->sctp_assoc_id, ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
+  itti_trace_save (ITTI_TRACE_KEY_S1AP_UE (ue_ref->mme_ue_s1ap_id));
   bstring b = blk2bstr(buffer_p, length);
   s1ap_mme_itti_send_sctp_request (&b, ue_ref->enb->sctp_assoc_id, ue_ref->sctp_stream_send, ue_ref->mme_ue_s1ap_id);
   OAILOG_FUNC_OUT (LOG_S1AP);
@@ -0,0 +1,261 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+
+/*! \file s1ap_mme_overload.c
+  \brief S1AP overload procedures towards the eNBs and admission of new UE signalling connections
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "log.h"
+#include "msc.h"
+#include "intertask_interface.h"
+#include "mme_config.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_overload.h"
+#include "mme_app_overload.h"
+
+extern hash_table_ts_t g_s1ap_enb_coll; // contains eNB_description_s, key is eNB_description_s.assoc_id
+
+/* Only accessed by the S1AP task: overload requests of MME_APP and INITIAL UE MESSAGEs */
+static bool               g_s1ap_is_overloaded = false;
+static overload_action_t  g_s1ap_overload_action = OVERLOAD_ACTION_PERMIT_EMERGENCY_AND_MT_ONLY;
+static uint64_t           g_s1ap_overload_nb_admitted = 0;
+static uint64_t           g_s1ap_overload_nb_rejected = 0;
+
+static const char * const overload_message_str[] = {"OverloadStop", "OverloadStart"};
+
+typedef struct s1ap_overload_pdu_s {
+  uint8_t     *buffer;
+  uint32_t     length;
+  bool         is_start;
+  int          nb_enb;
+} s1ap_overload_pdu_t;
+
+//------------------------------------------------------------------------------
+bool
+s1ap_mme_overload_is_admitted (
+  const overload_action_t action,
+  const long rrc_cause)
+{
+  if ((S1ap_RRC_Establishment_Cause_emergency == rrc_cause) || (S1ap_RRC_Establishment_Cause_mt_Access == rrc_cause)) {
+    return true;
+  }
+  switch (action) {
+  case OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT:
+    return (S1ap_RRC_Establishment_Cause_mo_Data != rrc_cause) && (S1ap_RRC_Establishment_Cause_delay_TolerantAccess != rrc_cause);
+
+  case OVERLOAD_ACTION_REJECT_RRC_CR_SIGNALLING:
+    return (S1ap_RRC_Establishment_Cause_mo_Data != rrc_cause) && (S1ap_RRC_Establishment_Cause_mo_Signalling != rrc_cause) &&
+      (S1ap_RRC_Establishment_Cause_delay_TolerantAccess != rrc_cause);
+
+  case OVERLOAD_ACTION_PERMIT_HIGH_PRIORITY_AND_MT_ONLY:
+    return S1ap_RRC_Establishment_Cause_highPriorityAccess == rrc_cause;
+
+  case OVERLOAD_ACTION_REJECT_DELAY_TOLERANT_ACCESS:
+    return S1ap_RRC_Establishment_Cause_delay_TolerantAccess != rrc_cause;
+
+  case OVERLOAD_ACTION_PERMIT_EMERGENCY_AND_MT_ONLY:
+  default:
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+bool
+s1ap_mme_overload_admit (
+  const enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const long rrc_cause)
+{
+  uint64_t                                nb_dropped = 0;
+
+  if (!g_s1ap_is_overloaded) {
+    return true;
+  }
+  // eNBs not honouring OVERLOAD START are throttled here
+  if (s1ap_mme_overload_is_admitted (g_s1ap_overload_action, rrc_cause)) {
+    g_s1ap_overload_nb_admitted++;
+    mme_app_overload_initial_ue_message (true);
+    return true;
+  }
+  g_s1ap_overload_nb_rejected++;
+  nb_dropped = mme_app_overload_initial_ue_message (false);
+  OAILOG_WARNING (LOG_S1AP, "MME overloaded, dropped Initial UE Message eNBUeS1APId:" ENB_UE_S1AP_ID_FMT " RRC establishment cause %ld, %" PRIu64
+      " dropped since OVERLOAD START, %" PRIu64 " in total\n", enb_ue_s1ap_id, rrc_cause, g_s1ap_overload_nb_rejected, nb_dropped);
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_overload_encode_start (
+  const overload_action_t action,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_OverloadStartIEs_t                *overload_start_ies = NULL;
+  s1ap_message                            message = {0};
+
+  DevAssert (action < OVERLOAD_ACTION_MAX);
+  message.procedureCode = S1ap_ProcedureCode_id_OverloadStart;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_ignore;
+  overload_start_ies = &message.msg.s1ap_OverloadStartIEs;
+  // overload_action_t follows the order of S1ap-OverloadAction, no GUMMEI list: all the GUMMEIs of the MME are overloaded
+  overload_start_ies->overloadResponse.present = S1ap_OverloadResponse_PR_overloadAction;
+  overload_start_ies->overloadResponse.choice.overloadAction = (long)action;
+
+  if (s1ap_mme_encode_pdu (&message, buffer, length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode OVERLOAD START\n");
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_overload_encode_stop (
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  s1ap_message                            message = {0};
+
+  message.procedureCode = S1ap_ProcedureCode_id_OverloadStop;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_ignore;
+
+  if (s1ap_mme_encode_pdu (&message, buffer, length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode OVERLOAD STOP\n");
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void
+s1ap_overload_send_to_enb (
+  const s1ap_overload_pdu_t * const pdu,
+  const enb_description_t * const enb_ref)
+{
+  MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 %s/initiatingMessage assoc_id %u",
+      overload_message_str[pdu->is_start], enb_ref->sctp_assoc_id);
+  // non UE-associated signalling uses stream 0
+  bstring b = blk2bstr(pdu->buffer, pdu->length);
+  s1ap_mme_itti_send_sctp_request (&b, enb_ref->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+}
+
+//------------------------------------------------------------------------------
+static bool
+s1ap_overload_send_to_enb_cb (
+  __attribute__((unused)) const hash_key_t keyP,
+  void * const elementP,
+  void * parameterP,
+  __attribute__((unused)) void **resultP)
+{
+  const enb_description_t                *enb_ref = (const enb_description_t *)elementP;
+  s1ap_overload_pdu_t                    *pdu = (s1ap_overload_pdu_t *)parameterP;
+
+  if (S1AP_READY == enb_ref->s1_state) {
+    s1ap_overload_send_to_enb (pdu, enb_ref);
+    pdu->nb_enb++;
+  }
+  // go through all the eNBs
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_handle_overload_start (
+  const itti_s1ap_overload_start_t * const overload_start_p)
+{
+  s1ap_overload_pdu_t                     pdu = {.buffer = NULL, .length = 0, .is_start = true, .nb_enb = 0};
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (overload_start_p != NULL);
+  // Same PDU for all eNBs, encoded once
+  if (s1ap_mme_overload_encode_start (overload_start_p->action, &pdu.buffer, &pdu.length) < 0) {
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  if (!g_s1ap_is_overloaded) {
+    g_s1ap_overload_nb_admitted = 0;
+    g_s1ap_overload_nb_rejected = 0;
+  }
+  g_s1ap_is_overloaded = true;
+  g_s1ap_overload_action = overload_start_p->action;
+  hashtable_ts_apply_callback_on_elements (&g_s1ap_enb_coll, s1ap_overload_send_to_enb_cb, (void *)&pdu, NULL);
+  OAILOG_WARNING (LOG_S1AP, "Send S1AP OVERLOAD START action %d load %u%% to %d eNBs\n", overload_start_p->action, overload_start_p->load_percent, pdu.nb_enb);
+  free_wrapper ((void**)&pdu.buffer);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_handle_overload_stop (
+  const itti_s1ap_overload_stop_t * const overload_stop_p)
+{
+  s1ap_overload_pdu_t                     pdu = {.buffer = NULL, .length = 0, .is_start = false, .nb_enb = 0};
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (overload_stop_p != NULL);
+  if (s1ap_mme_overload_encode_stop (&pdu.buffer, &pdu.length) < 0) {
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  g_s1ap_is_overloaded = false;
+  hashtable_ts_apply_callback_on_elements (&g_s1ap_enb_coll, s1ap_overload_send_to_enb_cb, (void *)&pdu, NULL);
+  OAILOG_WARNING (LOG_S1AP, "Send S1AP OVERLOAD STOP load %u%% to %d eNBs, during overload %" PRIu64 " UE connections admitted %" PRIu64 " dropped\n",
+      overload_stop_p->load_percent, pdu.nb_enb, g_s1ap_overload_nb_admitted, g_s1ap_overload_nb_rejected);
+  free_wrapper ((void**)&pdu.buffer);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_overload_enb_ready (
+  const enb_description_t * const enb_ref)
+{
+  s1ap_overload_pdu_t                     pdu = {.buffer = NULL, .length = 0, .is_start = true, .nb_enb = 0};
+
+  DevAssert (enb_ref != NULL);
+  if (!g_s1ap_is_overloaded) {
+    return;
+  }
+  if (s1ap_mme_overload_encode_start (g_s1ap_overload_action, &pdu.buffer, &pdu.length) < 0) {
+    return;
+  }
+  OAILOG_INFO (LOG_S1AP, "Send S1AP OVERLOAD START action %d to new eNB assoc_id %u\n", g_s1ap_overload_action, enb_ref->sctp_assoc_id);
+  s1ap_overload_send_to_enb (&pdu, enb_ref);
+  free_wrapper ((void**)&pdu.buffer);
+}
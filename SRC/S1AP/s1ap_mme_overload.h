@@ -0,0 +1,73 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+
+/*! \file s1ap_mme_overload.h
+  \brief S1AP overload procedures towards the eNBs and admission of new UE signalling connections
+*/
+
+#ifndef FILE_S1AP_MME_OVERLOAD_SEEN
+#define FILE_S1AP_MME_OVERLOAD_SEEN
+
+/** \brief Tell if a RRC establishment cause is admitted under an overload action, TS 36.413 8.7.6:
+ *  emergency and mobile terminated accesses are always admitted
+ * \param action    Overload action sent to the eNBs
+ * \param rrc_cause RRC establishment cause of the INITIAL UE MESSAGE
+ **/
+bool s1ap_mme_overload_is_admitted(const overload_action_t action, const long rrc_cause);
+
+/** \brief Admission of an INITIAL UE MESSAGE, counted while the MME is overloaded, dropped ones are logged
+ * \param enb_ue_s1ap_id eNB UE S1AP ID of the INITIAL UE MESSAGE
+ * \param rrc_cause      RRC establishment cause of the INITIAL UE MESSAGE
+ * @returns false if the UE signalling connection has to be dropped
+ **/
+bool s1ap_mme_overload_admit(const enb_ue_s1ap_id_t enb_ue_s1ap_id, const long rrc_cause);
+
+/** \brief Encode an OVERLOAD START message
+ * \param action Overload action requested to the eNBs
+ * \param buffer Encoded PDU, to be freed by the caller
+ * \param length Length of the encoded PDU
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_overload_encode_start(const overload_action_t action, uint8_t ** buffer, uint32_t * length);
+
+/** \brief Encode an OVERLOAD STOP message
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_overload_encode_stop(uint8_t ** buffer, uint32_t * length);
+
+/** \brief Enter overload: OVERLOAD START is sent to every eNB in S1AP_READY state
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_handle_overload_start(const itti_s1ap_overload_start_t * const overload_start_p);
+
+/** \brief Leave overload: OVERLOAD STOP is sent to every eNB in S1AP_READY state
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_handle_overload_stop(const itti_s1ap_overload_stop_t * const overload_stop_p);
+
+/** \brief An eNB has just been answered a S1 SETUP RESPONSE,
+ *  it is sent OVERLOAD START if the MME is overloaded
+ **/
+void s1ap_mme_overload_enb_ready(const enb_description_t * const enb_ref);
+
+#endif /* FILE_S1AP_MME_OVERLOAD_SEEN */
@@ -0,0 +1,364 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file s1ap_mme_paging.c
+  \brief S1AP paging of idle UEs, eNBs indexed by the tracking areas they support
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include "bstrlib.h"
+
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "hashtable.h"
+#include "log.h"
+#include "msc.h"
+#include "conversions.h"
+#include "intertask_interface.h"
+#include "mme_config.h"
+#include "asn_SEQUENCE_OF.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_itti_messaging.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
+
+/* eNBs supporting a tracking area */
+typedef struct s1ap_paging_tai_enbs_s {
+  int                  nb_enb;
+  int                  size;
+  enb_description_t  **enb;
+} s1ap_paging_tai_enbs_t;
+
+/* Only accessed by the S1AP task: S1 SETUP, eNB removal and paging requests */
+static hash_table_t  g_s1ap_tai2enb_coll = {0}; // contains s1ap_paging_tai_enbs_t, key is the TAI (PLMN << 16 | TAC)
+static uint32_t      g_s1ap_paging_round = 0;   // an eNB already selected for the current paging has this round
+
+//------------------------------------------------------------------------------
+static inline hash_key_t
+s1ap_paging_tai_key (
+  const tai_t * const tai)
+{
+  const uint8_t                          *plmn = (const uint8_t *)&tai->plmn;
+
+  return ((hash_key_t)plmn[0] << 32) | ((hash_key_t)plmn[1] << 24) | ((hash_key_t)plmn[2] << 16) | (hash_key_t)tai->tac;
+}
+
+//------------------------------------------------------------------------------
+static void
+s1ap_paging_free_tai_enbs (
+  void **tai_enbs_pp)
+{
+  s1ap_paging_tai_enbs_t                 *tai_enbs = (s1ap_paging_tai_enbs_t *)*tai_enbs_pp;
+
+  if (tai_enbs) {
+    free_wrapper ((void**)&tai_enbs->enb);
+  }
+  free_wrapper (tai_enbs_pp);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_init (
+  void)
+{
+  bstring bs = bfromcstr("s1ap_tai2enb_coll");
+  hash_table_t* h = hashtable_init (&g_s1ap_tai2enb_coll, mme_config.max_enbs, NULL, s1ap_paging_free_tai_enbs, bs);
+  bdestroy(bs);
+  if (!h) return RETURNerror;
+  g_s1ap_paging_round = 0;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_paging_exit (
+  void)
+{
+  hashtable_destroy (&g_s1ap_tai2enb_coll);
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_add_enb (
+  enb_description_t * const enb_ref,
+  const tai_t * const tai,
+  const int nb_tai)
+{
+  s1ap_paging_tai_enbs_t                 *tai_enbs = NULL;
+  hash_key_t                              key = 0;
+
+  DevAssert (enb_ref != NULL);
+  DevAssert ((tai != NULL) || (nb_tai == 0));
+  // A new S1 SETUP replaces the tracking areas of the eNB
+  s1ap_mme_paging_remove_enb (enb_ref);
+  if (nb_tai <= 0) {
+    return RETURNok;
+  }
+  enb_ref->supported_tai = calloc (nb_tai, sizeof (tai_t));
+  DevAssert (enb_ref->supported_tai != NULL);
+
+  for (int i = 0; i < nb_tai; i++) {
+    bool                                  duplicate = false;
+
+    for (int j = 0; j < enb_ref->nb_supported_tai; j++) {
+      if (TAIS_ARE_EQUAL (tai[i], enb_ref->supported_tai[j])) {
+        duplicate = true;
+        break;
+      }
+    }
+    if (duplicate) {
+      continue;
+    }
+
+    key = s1ap_paging_tai_key (&tai[i]);
+    if (HASH_TABLE_OK != hashtable_get (&g_s1ap_tai2enb_coll, key, (void **)&tai_enbs)) {
+      tai_enbs = calloc (1, sizeof (s1ap_paging_tai_enbs_t));
+      DevAssert (tai_enbs != NULL);
+      hashtable_rc_t h_rc = hashtable_insert (&g_s1ap_tai2enb_coll, key, tai_enbs);
+      if (HASH_TABLE_OK != h_rc) {
+        OAILOG_ERROR (LOG_S1AP, "Could not index eNB id %u under TAI " TAI_FMT ": %s\n",
+            enb_ref->enb_id, TAI_ARG(&tai[i]), hashtable_rc_code2string(h_rc));
+        free_wrapper ((void**)&tai_enbs);
+        continue;
+      }
+    }
+    if (tai_enbs->nb_enb == tai_enbs->size) {
+      int new_size = (tai_enbs->size) ? 2 * tai_enbs->size : 4;
+      enb_description_t **new_enb = realloc (tai_enbs->enb, new_size * sizeof (enb_description_t *));
+      DevAssert (new_enb != NULL);
+      tai_enbs->enb = new_enb;
+      tai_enbs->size = new_size;
+    }
+    tai_enbs->enb[tai_enbs->nb_enb++] = enb_ref;
+    enb_ref->supported_tai[enb_ref->nb_supported_tai++] = tai[i];
+    OAILOG_DEBUG (LOG_S1AP, "eNB id %u indexed under TAI " TAI_FMT " (%d eNBs)\n", enb_ref->enb_id, TAI_ARG(&tai[i]), tai_enbs->nb_enb);
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_add_enb_supported_tas (
+  enb_description_t * const enb_ref,
+  const S1ap_SupportedTAs_t * const supported_tas)
+{
+  tai_t                                  *tai = NULL;
+  int                                     nb_tai = 0;
+  int                                     rc = RETURNok;
+
+  DevAssert (supported_tas != NULL);
+  for (int i = 0; i < supported_tas->list.count; i++) {
+    nb_tai += supported_tas->list.array[i]->broadcastPLMNs.list.count;
+  }
+  if (nb_tai) {
+    tai = calloc (nb_tai, sizeof (tai_t));
+    DevAssert (tai != NULL);
+  }
+  nb_tai = 0;
+  for (int i = 0; i < supported_tas->list.count; i++) {
+    S1ap_SupportedTAs_Item_t             *ta = supported_tas->list.array[i];
+    tac_t                                 tac = 0;
+
+    OCTET_STRING_TO_TAC (&ta->tAC, tac);
+    for (int j = 0; j < ta->broadcastPLMNs.list.count; j++) {
+      TBCD_TO_PLMN_T (ta->broadcastPLMNs.list.array[j], &tai[nb_tai].plmn);
+      tai[nb_tai].tac = tac;
+      nb_tai++;
+    }
+  }
+  rc = s1ap_mme_paging_add_enb (enb_ref, tai, nb_tai);
+  free_wrapper ((void**)&tai);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+void
+s1ap_mme_paging_remove_enb (
+  enb_description_t * const enb_ref)
+{
+  s1ap_paging_tai_enbs_t                 *tai_enbs = NULL;
+  hash_key_t                              key = 0;
+
+  DevAssert (enb_ref != NULL);
+  for (int i = 0; i < enb_ref->nb_supported_tai; i++) {
+    key = s1ap_paging_tai_key (&enb_ref->supported_tai[i]);
+    if (HASH_TABLE_OK != hashtable_get (&g_s1ap_tai2enb_coll, key, (void **)&tai_enbs)) {
+      continue;
+    }
+    for (int j = 0; j < tai_enbs->nb_enb; j++) {
+      if (tai_enbs->enb[j] == enb_ref) {
+        tai_enbs->enb[j] = tai_enbs->enb[--tai_enbs->nb_enb];
+        break;
+      }
+    }
+    if (0 == tai_enbs->nb_enb) {
+      hashtable_free (&g_s1ap_tai2enb_coll, key);
+    }
+  }
+  free_wrapper ((void**)&enb_ref->supported_tai);
+  enb_ref->nb_supported_tai = 0;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_select_enbs (
+  const tai_list_t * const tai_list,
+  enb_description_t ** enbs,
+  const int max_enbs)
+{
+  s1ap_paging_tai_enbs_t                 *tai_enbs = NULL;
+  int                                     nb_enb = 0;
+
+  DevAssert (tai_list != NULL);
+  DevAssert (enbs != NULL);
+  // 0 is the round of eNBs never selected
+  if (0 == ++g_s1ap_paging_round) {
+    g_s1ap_paging_round = 1;
+  }
+  for (int i = 0; i < tai_list->n_tais; i++) {
+    if (HASH_TABLE_OK != hashtable_get (&g_s1ap_tai2enb_coll, s1ap_paging_tai_key (&tai_list->tai[i]), (void **)&tai_enbs)) {
+      OAILOG_DEBUG (LOG_S1AP, "No eNB serving TAI " TAI_FMT "\n", TAI_ARG(&tai_list->tai[i]));
+      continue;
+    }
+    for (int j = 0; j < tai_enbs->nb_enb; j++) {
+      enb_description_t                  *enb_ref = tai_enbs->enb[j];
+
+      if ((enb_ref->paging_round == g_s1ap_paging_round) || (S1AP_READY != enb_ref->s1_state)) {
+        continue;
+      }
+      if (nb_enb == max_enbs) {
+        OAILOG_WARNING (LOG_S1AP, "Paging limited to %d eNBs\n", max_enbs);
+        return nb_enb;
+      }
+      enb_ref->paging_round = g_s1ap_paging_round;
+      enbs[nb_enb++] = enb_ref;
+    }
+  }
+  return nb_enb;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_paging_encode (
+  const itti_s1ap_paging_request_t * const paging_p,
+  uint8_t ** buffer,
+  uint32_t * length)
+{
+  S1ap_PagingIEs_t                       *paging_ies = NULL;
+  s1ap_message                            message = {0};
+  S1ap_TAIItem_t                          tai_item[TAI_LIST_MAX_SIZE];
+  uint8_t                                 plmn_buf[TAI_LIST_MAX_SIZE][3];
+  uint8_t                                 tac_buf[TAI_LIST_MAX_SIZE][2];
+  uint8_t                                 ue_identity_index_buf[2];
+  uint8_t                                 mme_code_buf[1];
+  uint8_t                                 m_tmsi_buf[4];
+  int                                     rc = RETURNok;
+
+  DevAssert (paging_p != NULL);
+  DevAssert ((paging_p->tai_list.n_tais > 0) && (paging_p->tai_list.n_tais <= TAI_LIST_MAX_SIZE));
+  message.procedureCode = S1ap_ProcedureCode_id_Paging;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  message.criticality = S1ap_Criticality_ignore;
+  paging_ies = &message.msg.s1ap_PagingIEs;
+  /*
+   * The IEs are encoded by value, stack buffers are enough
+   */
+  ue_identity_index_buf[0] = (uint8_t)(paging_p->ue_identity_index >> 2);
+  ue_identity_index_buf[1] = (uint8_t)((paging_p->ue_identity_index & 0x03) << 6);
+  paging_ies->ueIdentityIndexValue.buf = ue_identity_index_buf;
+  paging_ies->ueIdentityIndexValue.size = 2;
+  paging_ies->ueIdentityIndexValue.bits_unused = 6;
+
+  paging_ies->uePagingID.present = S1ap_UEPagingID_PR_s_TMSI;
+  INT8_TO_BUFFER (paging_p->mme_code, mme_code_buf);
+  paging_ies->uePagingID.choice.s_TMSI.mMEC.buf = mme_code_buf;
+  paging_ies->uePagingID.choice.s_TMSI.mMEC.size = 1;
+  INT32_TO_BUFFER (paging_p->m_tmsi, m_tmsi_buf);
+  paging_ies->uePagingID.choice.s_TMSI.m_TMSI.buf = m_tmsi_buf;
+  paging_ies->uePagingID.choice.s_TMSI.m_TMSI.size = 4;
+
+  paging_ies->cnDomain = S1ap_CNDomain_ps;
+
+  memset (tai_item, 0, sizeof (tai_item));
+  for (int i = 0; i < paging_p->tai_list.n_tais; i++) {
+    const tai_t                          *tai = &paging_p->tai_list.tai[i];
+    int                                   mnc_length = (tai->plmn.mnc_digit3 == 0x0F) ? 2 : 3;
+
+    PLMN_T_TO_TBCD (tai->plmn, plmn_buf[i], mnc_length);
+    tai_item[i].tAI.pLMNidentity.buf = plmn_buf[i];
+    tai_item[i].tAI.pLMNidentity.size = 3;
+    INT16_TO_BUFFER (tai->tac, tac_buf[i]);
+    tai_item[i].tAI.tAC.buf = tac_buf[i];
+    tai_item[i].tAI.tAC.size = 2;
+    ASN_SEQUENCE_ADD (&paging_ies->taiList, &tai_item[i]);
+  }
+
+  if (s1ap_mme_encode_pdu (&message, buffer, length) < 0) {
+    OAILOG_ERROR (LOG_S1AP, "Failed to encode PAGING for ue_id " MME_UE_S1AP_ID_FMT "\n", paging_p->mme_ue_s1ap_id);
+    rc = RETURNerror;
+  }
+  // The items are on the stack, only the array of pointers is freed
+  asn_sequence_empty (&paging_ies->taiList);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int
+s1ap_mme_handle_paging_request (
+  const itti_s1ap_paging_request_t * const paging_p)
+{
+  static enb_description_t               *enbs[S1AP_PAGING_MAX_ENBS];
+  uint8_t                                *buffer = NULL;
+  uint32_t                                length = 0;
+  int                                     nb_enb = 0;
+
+  OAILOG_FUNC_IN (LOG_S1AP);
+  DevAssert (paging_p != NULL);
+  nb_enb = s1ap_mme_paging_select_enbs (&paging_p->tai_list, enbs, S1AP_PAGING_MAX_ENBS);
+  if (0 == nb_enb) {
+    OAILOG_WARNING (LOG_S1AP, "No eNB in S1AP_READY state serving the %d TAIs of the paging of ue_id " MME_UE_S1AP_ID_FMT "\n",
+        paging_p->tai_list.n_tais, paging_p->mme_ue_s1ap_id);
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  // Same PDU for all eNBs, encoded once
+  if (s1ap_mme_paging_encode (paging_p, &buffer, &length) < 0) {
+    OAILOG_FUNC_RETURN (LOG_S1AP, RETURNerror);
+  }
+  OAILOG_INFO (LOG_S1AP, "Send S1AP PAGING ue_id " MME_UE_S1AP_ID_FMT " S-TMSI %02x.%08x to %d eNBs\n",
+      paging_p->mme_ue_s1ap_id, paging_p->mme_code, paging_p->m_tmsi, nb_enb);
+  for (int i = 0; i < nb_enb; i++) {
+    MSC_LOG_TX_MESSAGE (MSC_S1AP_MME, MSC_S1AP_ENB, NULL, 0, "0 Paging/initiatingMessage ue_id " MME_UE_S1AP_ID_FMT " assoc_id %u",
+        paging_p->mme_ue_s1ap_id, enbs[i]->sctp_assoc_id);
+    // non UE-associated signalling uses stream 0
+    bstring b = blk2bstr(buffer, length);
+    s1ap_mme_itti_send_sctp_request (&b, enbs[i]->sctp_assoc_id, 0, INVALID_MME_UE_S1AP_ID);
+  }
+  free_wrapper ((void**)&buffer);
+  OAILOG_FUNC_RETURN (LOG_S1AP, RETURNok);
+}
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file s1ap_mme_paging.h
+  \brief S1AP paging of idle UEs, eNBs indexed by the tracking areas they support
+*/
+
+#ifndef FILE_S1AP_MME_PAGING_SEEN
+#define FILE_S1AP_MME_PAGING_SEEN
+
+/* Upper bound of eNBs a single paging request can reach */
+#define S1AP_PAGING_MAX_ENBS 1024
+
+/** \brief Create the TAI to eNB index, must be called once before any eNB is added
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_paging_init(void);
+
+/** \brief Destroy the TAI to eNB index
+ **/
+void s1ap_mme_paging_exit(void);
+
+/** \brief Index an eNB under the tracking areas it supports
+ * \param enb_ref The eNB, already in the eNB list
+ * \param tai     Tracking areas supported by the eNB
+ * \param nb_tai  Number of elements of tai
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_paging_add_enb(enb_description_t * const enb_ref, const tai_t * const tai, const int nb_tai);
+
+/** \brief Index an eNB under the Supported TAs of its S1 SETUP REQUEST,
+ *  one tracking area per TAC and broadcast PLMN
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_paging_add_enb_supported_tas(enb_description_t * const enb_ref, const S1ap_SupportedTAs_t * const supported_tas);
+
+/** \brief Remove an eNB from the index, must be called before the eNB is freed
+ **/
+void s1ap_mme_paging_remove_enb(enb_description_t * const enb_ref);
+
+/** \brief Select the eNBs in S1AP_READY state serving at least one of the tracking areas,
+ *  each eNB is returned once
+ * \param tai_list   Tracking areas of the paging
+ * \param enbs       Array receiving the selected eNBs
+ * \param max_enbs   Size of enbs
+ * @returns the number of selected eNBs
+ **/
+int s1ap_mme_paging_select_enbs(const tai_list_t * const tai_list, enb_description_t ** enbs, const int max_enbs);
+
+/** \brief Encode the PAGING message of a paging request
+ * \param paging_p The paging request
+ * \param buffer   Encoded PDU, to be freed by the caller
+ * \param length   Length of the encoded PDU
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_paging_encode(const itti_s1ap_paging_request_t * const paging_p, uint8_t ** buffer, uint32_t * length);
+
+/** \brief Page an idle UE: the PAGING message is encoded once and sent
+ *  to every eNB serving one of the tracking areas of the request
+ * @returns -1 in case of failure
+ **/
+int s1ap_mme_handle_paging_request(const itti_s1ap_paging_request_t * const paging_p);
+
+#endif /* FILE_S1AP_MME_PAGING_SEEN */
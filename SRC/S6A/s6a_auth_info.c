@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 #include "mme_config.h"
 
@@ -29,9 +30,12 @@
 #include "conversions.h"
 
 #include "intertask_interface.h"
+#include "intertask_interface_trace.h"
 #include "s6a_defs.h"
 #include "s6a_messages.h"
 #include "msc.h"
+#include "probes.h"
+#include "mme_app_overload.h"
 
 static
   int
@@ -206,6 +210,7 @@ s6a_aia_cb (
   int                                     skip_auth_res = 0;
 
   DevAssert (msg );
+  mme_app_overload_transaction_end (MME_APP_OVERLOAD_S6A);
   ans = *msg;
   /*
    * Retrieve the original query associated with the asnwer
@@ -281,6 +286,9 @@ s6a_aia_cb (
     }
   }
 
+  itti_trace_restore (ITTI_TRACE_KEY_S6A_IMSI (strtoull (s6a_auth_info_ans_p->imsi, NULL, 10)), message_p);
+  OAI_PROBE2 (s6a_aia, (const char *)s6a_auth_info_ans_p->imsi, (S6A_RESULT_BASE == s6a_auth_info_ans_p->result.present) ?
+      s6a_auth_info_ans_p->result.choice.base : s6a_auth_info_ans_p->result.choice.experimental);
   itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
 err:
   return RETURNok;
@@ -415,6 +423,10 @@ s6a_generate_authentication_info_req (
 
     CHECK_FCT (fd_msg_avp_add (msg, MSG_BRW_LAST_CHILD, avp));
   }
-  CHECK_FCT (fd_msg_send (&msg, NULL, NULL));
+  OAI_PROBE1 (s6a_air, (const char *)air_p->imsi);
+  itti_trace_save (ITTI_TRACE_KEY_S6A_IMSI (strtoull (air_p->imsi, NULL, 10)));
+  // counted before the answer callback, run by a freeDiameter thread, may end it
+  mme_app_overload_transaction_start (MME_APP_OVERLOAD_S6A);
+  CHECK_FCT_DO (fd_msg_send (&msg, NULL, NULL), { mme_app_overload_transaction_end (MME_APP_OVERLOAD_S6A); return RETURNerror; });
   return RETURNok;
 }
@@ -79,6 +79,53 @@ static void oai_fd_logger(int loglevel, const char * format, va_list args)
   OAILOG_EXTERNAL (loglevel, LOG_S6A, "%s\n", buffer);
 }
 
+//------------------------------------------------------------------------------
+static void s6a_handle_message (
+  MessageDef * received_message_p)
+{
+  DevAssert (received_message_p );
+
+  switch (ITTI_MSG_ID (received_message_p)) {
+  case S6A_UPDATE_LOCATION_REQ:{
+      s6a_generate_update_location (&received_message_p->ittiMsg.s6a_update_location_req);
+    }
+    break;
+  case S6A_AUTH_INFO_REQ:{
+      s6a_generate_authentication_info_req (&received_message_p->ittiMsg.s6a_auth_info_req);
+    }
+    break;
+  case TIMER_HAS_EXPIRED:{
+      /*
+       * Trying to connect to peers
+       */
+      if (s6a_fd_new_peer() != RETURNok) {
+        /*
+         * On failure, reschedule timer.
+         * * Preferred over TIMER_PERIODIC because if s6a_fd_new_peer takes
+         * * longer to return than the period, the timer will schedule while
+         * * the previous one is active, causing a seg fault.
+         */
+        OAILOG_ERROR(LOG_S6A, "s6a_fd_new_peer has failed (%s:%d)\n",
+                     __FILE__, __LINE__);
+        timer_setup(S6A_PEER_CONNECT_TIMEOUT_SEC,
+                    S6A_PEER_CONNECT_TIMEOUT_MICRO_SEC, TASK_S6A,
+                    INSTANCE_DEFAULT, TIMER_ONE_SHOT, NULL, &timer_id);
+      }
+    }
+    break;
+  case TERMINATE_MESSAGE:{
+      s6a_exit();
+      itti_exit_task ();
+    }
+    break;
+  default:{
+      OAILOG_DEBUG (LOG_S6A, "Unkwnon message ID %d: %s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
+    }
+    break;
+  }
+  itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+}
+
 //------------------------------------------------------------------------------
 void *s6a_thread (void *args)
 {
@@ -95,48 +142,7 @@ void *s6a_thread (void *args)
      * * message is sent to the task.
      */
     itti_receive_msg (TASK_S6A, &received_message_p);
-    DevAssert (received_message_p );
-
-    switch (ITTI_MSG_ID (received_message_p)) {
-    case S6A_UPDATE_LOCATION_REQ:{
-        s6a_generate_update_location (&received_message_p->ittiMsg.s6a_update_location_req);
-      }
-      break;
-    case S6A_AUTH_INFO_REQ:{
-        s6a_generate_authentication_info_req (&received_message_p->ittiMsg.s6a_auth_info_req);
-      }
-      break;
-    case TIMER_HAS_EXPIRED:{
-        /*
-         * Trying to connect to peers
-         */
-        if (s6a_fd_new_peer() != RETURNok) {
-          /*
-           * On failure, reschedule timer.
-           * * Preferred over TIMER_PERIODIC because if s6a_fd_new_peer takes
-           * * longer to return than the period, the timer will schedule while
-           * * the previous one is active, causing a seg fault.
-           */
-          OAILOG_ERROR(LOG_S6A, "s6a_fd_new_peer has failed (%s:%d)\n",
-                       __FILE__, __LINE__);
-          timer_setup(S6A_PEER_CONNECT_TIMEOUT_SEC,
-                      S6A_PEER_CONNECT_TIMEOUT_MICRO_SEC, TASK_S6A,
-                      INSTANCE_DEFAULT, TIMER_ONE_SHOT, NULL, &timer_id);
-        }
-      }
-      break;
-    case TERMINATE_MESSAGE:{
-        s6a_exit();
-        itti_exit_task ();
-      }
-      break;
-    default:{
-        OAILOG_DEBUG (LOG_S6A, "Unkwnon message ID %d: %s\n", ITTI_MSG_ID (received_message_p), ITTI_MSG_NAME (received_message_p));
-      }
-      break;
-    }
-    itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
-    received_message_p = NULL;
+    s6a_handle_message (received_message_p);
   }
   return NULL;
 }
@@ -234,7 +240,7 @@ int s6a_init (
     OAILOG_DEBUG (LOG_S6A, "s6a_fd_init_dict_objs done\n");
   }
 
-  if (itti_create_task (TASK_S6A, &s6a_thread, NULL) < 0) {
+  if (itti_create_task_handler (TASK_S6A, &s6a_thread, &s6a_handle_message, NULL) < 0) {
     OAILOG_ERROR (LOG_S6A, "s6a create task\n");
     return RETURNerror;
   }
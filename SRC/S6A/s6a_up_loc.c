@@ -22,15 +22,19 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 
 #include "mme_config.h"
 #include "assertions.h"
 #include "conversions.h"
 #include "intertask_interface.h"
+#include "intertask_interface_trace.h"
 #include "s6a_defs.h"
 #include "s6a_messages.h"
 #include "msc.h"
 #include "log.h"
+#include "probes.h"
+#include "mme_app_overload.h"
 
 
 int
@@ -49,6 +53,7 @@ s6a_ula_cb (
   s6a_update_location_ans_t              *s6a_update_location_ans_p = NULL;
 
   DevAssert (msg_pP );
+  mme_app_overload_transaction_end (MME_APP_OVERLOAD_S6A);
   ans_p = *msg_pP;
   /*
    * Retrieve the original query associated with the asnwer
@@ -146,6 +151,9 @@ s6a_ula_cb (
 
 err:
   ans_p = NULL;
+  itti_trace_restore (ITTI_TRACE_KEY_S6A_IMSI (strtoull (s6a_update_location_ans_p->imsi, NULL, 10)), message_p);
+  OAI_PROBE2 (s6a_ula, (const char *)s6a_update_location_ans_p->imsi, (S6A_RESULT_BASE == s6a_update_location_ans_p->result.present) ?
+      s6a_update_location_ans_p->result.choice.base : s6a_update_location_ans_p->result.choice.experimental);
   itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
   OAILOG_DEBUG (LOG_S6A, "Sending S6A_UPDATE_LOCATION_ANS to task MME_APP\n");
   return RETURNok;
@@ -276,7 +284,11 @@ s6a_generate_update_location (
 
   CHECK_FCT (fd_msg_avp_setvalue (avp_p, &value));
   CHECK_FCT (fd_msg_avp_add (msg_p, MSG_BRW_LAST_CHILD, avp_p));
-  CHECK_FCT (fd_msg_send (&msg_p, NULL, NULL));
+  OAI_PROBE1 (s6a_ulr, (const char *)ulr_pP->imsi);
+  itti_trace_save (ITTI_TRACE_KEY_S6A_IMSI (strtoull (ulr_pP->imsi, NULL, 10)));
+  // counted before the answer callback, run by a freeDiameter thread, may end it
+  mme_app_overload_transaction_start (MME_APP_OVERLOAD_S6A);
+  CHECK_FCT_DO (fd_msg_send (&msg_p, NULL, NULL), { mme_app_overload_transaction_end (MME_APP_OVERLOAD_S6A); return RETURNerror; });
   OAILOG_DEBUG (LOG_S6A, "Sending s6a ulr for imsi=%s\n", ulr_pP->imsi);
   return RETURNok;
 }
@@ -32,6 +32,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
@@ -40,9 +41,11 @@
 #include <netinet/sctp.h>
 
 #include "dynamic_memory_check.h"
+#include "bstr_pool.h"
 #include "common_defs.h"
 #include "assertions.h"
 #include "log.h"
+#include "probes.h"
 #include "msc.h"
 #include "intertask_interface.h"
 #include "sctp_primitives_server.h"
@@ -276,6 +279,7 @@ static int sctp_send_msg (
   OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
       assoc_desc->sd, sctp_assoc_id, bdata(*payload), blength(*payload), stream, assoc_desc->ppid);
 
+  OAI_PROBE3 (sctp_tx, sctp_assoc_id, stream, blength(*payload));
   /*
    * Send message_p on specified stream of the sd association
    */
@@ -404,6 +408,14 @@ err:
   return -1;
 }
 
+//------------------------------------------------------------------------------
+// Receive buffers: a data payload is read in a buffer of the pool that becomes the payload of SCTP_DATA_IND, given back by
+// S1AP once decoded. Notifications, and data payloads when all the buffers of the pool are in flight, are read in the
+// buffer of the receiver thread, a data payload is then copied out of it.
+static bstr_pool_t                     *sctp_recv_pool = NULL;
+static uint8_t                          sctp_recv_buffer[SCTP_RECV_BUFFER_SIZE] __attribute__ ((aligned (8)));
+static uint64_t                         sctp_recv_copies = 0;
+
 //------------------------------------------------------------------------------
 static inline int sctp_read_from_socket (int sd, uint32_t ppid)
 {
@@ -412,9 +424,11 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
   socklen_t                               from_len = 0;
   struct sctp_sndrcvinfo                  sinfo = {0};
   struct sockaddr_in6                     addr = {0};
-  uint8_t                                 buffer[SCTP_RECV_BUFFER_SIZE];
+  bstring                                 payload = (sctp_recv_pool) ? bstr_pool_get (sctp_recv_pool) : NULL;
+  uint8_t                                *buffer = (payload) ? payload->data : sctp_recv_buffer;
 
   if (sd < 0) {
+    bstr_pool_release (&payload);
     return -1;
   }
 
@@ -424,6 +438,7 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
   n = sctp_recvmsg (sd, (void *)buffer, SCTP_RECV_BUFFER_SIZE, (struct sockaddr *)&addr, &from_len, &sinfo, &flags);
 
   if (n < 0) {
+    bstr_pool_release (&payload);
     OAILOG_DEBUG (LOG_SCTP, "An error occured during read\n");
     OAILOG_ERROR (LOG_SCTP, "sctp_recvmsg: %s:%d\n", strerror (errno), errno);
     return SCTP_RC_ERROR;
@@ -431,21 +446,27 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
 
   if (flags & MSG_NOTIFICATION) {
     union sctp_notification                *snp = (union sctp_notification *)buffer;
+    int                                     rc = SCTP_RC_NORMAL_READ;
 
     switch (snp->sn_header.sn_type) {
     case SCTP_SHUTDOWN_EVENT: {
       OAILOG_DEBUG (LOG_SCTP, "SCTP_SHUTDOWN_EVENT received\n");
-      return sctp_handle_com_down((sctp_assoc_id_t) snp->sn_shutdown_event.sse_assoc_id);
+      rc = sctp_handle_com_down((sctp_assoc_id_t) snp->sn_shutdown_event.sse_assoc_id);
+      break;
     }
     case SCTP_ASSOC_CHANGE: {
       OAILOG_DEBUG(LOG_SCTP, "SCTP association change event received\n");
-      return handle_assoc_change(sd, ppid, &snp->sn_assoc_change);
+      rc = handle_assoc_change(sd, ppid, &snp->sn_assoc_change);
+      break;
     }
     default: {
       OAILOG_WARNING(LOG_SCTP, "Unhandled notification type %u\n", snp->sn_header.sn_type);
       break;
     }
     }
+    // only data payloads are handed over
+    bstr_pool_release (&payload);
+    return rc;
   } else {
     /*
      * Data payload received
@@ -454,6 +475,7 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
 
     if ((association = sctp_is_assoc_in_list ((sctp_assoc_id_t) sinfo.sinfo_assoc_id)) == NULL) {
       // TODO: handle this case
+      bstr_pool_release (&payload);
       return SCTP_RC_ERROR;
     }
 
@@ -465,11 +487,22 @@ static inline int sctp_read_from_socket (int sd, uint32_t ppid)
        * * * * may be we received unsollicited traffic from stack other than S1AP.
        */
       OAILOG_ERROR (LOG_SCTP, "Received data from peer with unsollicited PPID %d, expecting %d\n", ntohl (sinfo.sinfo_ppid), association->ppid);
+      bstr_pool_release (&payload);
       return SCTP_RC_ERROR;
     }
 
     OAILOG_DEBUG (LOG_SCTP, "[%d][%d] Msg of length %d received from port %u, on stream %d, PPID %d\n", sinfo.sinfo_assoc_id, sd, n, ntohs (addr.sin6_port), sinfo.sinfo_stream, ntohl (sinfo.sinfo_ppid));
-    bstring payload = blk2bstr(buffer, n);
+    OAI_PROBE3 (sctp_rx, sinfo.sinfo_assoc_id, sinfo.sinfo_stream, n);
+    if (payload) {
+      payload->slen = n;
+    } else {
+      sctp_recv_copies++;
+      payload = blk2bstr (buffer, n);
+      if (!payload) {
+        OAILOG_ERROR (LOG_SCTP, "Could not allocate a payload of %d bytes\n", n);
+        return SCTP_RC_ERROR;
+      }
+    }
     sctp_itti_send_new_message_ind (&payload,
                                     (sctp_assoc_id_t) sinfo.sinfo_assoc_id, sinfo.sinfo_stream, association->instreams, association->outstreams);
   }
@@ -756,6 +789,10 @@ int sctp_init (const mme_config_t * mme_config_p)
    */
   sctp_desc.nb_instreams = mme_config_p->sctp_config.in_streams;
   sctp_desc.nb_outstreams = mme_config_p->sctp_config.out_streams;
+  sctp_recv_pool = bstr_pool_create (SCTP_RECV_BUFFER_POOL_ITEMS, SCTP_RECV_BUFFER_SIZE);
+  if (NULL == sctp_recv_pool) {
+    OAILOG_WARNING (LOG_SCTP, "No pool of receive buffers, data payloads are copied out of the receive buffer\n");
+  }
 
   if (itti_create_task (TASK_SCTP, &sctp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR (LOG_SCTP, "create task failed\n");
@@ -786,4 +823,12 @@ static void sctp_exit (void)
     free_wrapper ((void**) &sctp_assoc_p);
     sctp_desc.number_of_connections--;
   }
+  if (sctp_recv_pool) {
+    bstr_pool_stats_t               stats = {0};
+
+    // S1AP may still hold receive buffers, the pool lives until the end of the process
+    bstr_pool_get_stats (sctp_recv_pool, &stats);
+    OAILOG_INFO (LOG_SCTP, "Receive buffers: %u in pool, peak %u in flight, %" PRIu64 " payloads copied when the pool was exhausted\n",
+        stats.items, stats.peak_used, sctp_recv_copies);
+  }
 }
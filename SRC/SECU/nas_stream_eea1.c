@@ -41,10 +41,10 @@ nas_stream_encrypt_eea1 (
   uint8_t * const out)
 {
   snow_3g_context_t                       snow_3g_context;
-  int                                     n;
-  int                                     i = 0;
+  uint32_t                                n;
+  uint32_t                                i = 0;
   uint32_t                                zero_bit = 0;
-  //uint32_t                                byte_length;
+  uint32_t                                byte_length = 0;
   uint32_t                               *KS;
   uint32_t                                K[4],
                                           IV[4];
@@ -55,7 +55,6 @@ nas_stream_encrypt_eea1 (
   DevAssert (out != NULL);
   n = (stream_cipher->blength + 31) / 32;
   zero_bit = stream_cipher->blength & 0x7;
-  //byte_length = stream_cipher->blength >> 3;
   memset (&snow_3g_context, 0, sizeof (snow_3g_context));
   /*
    * Initialisation
@@ -101,25 +100,19 @@ nas_stream_encrypt_eea1 (
 
   /*
    * Exclusive-OR the input data with keystream to generate the output bit
-   * stream
+   * stream, out may be the input message (in place)
    */
-  for (i = 0; i < n * 4; i++) {
-    stream_cipher->message[i] ^= *(((uint8_t *) KS) + i);
-  }
+  byte_length = (stream_cipher->blength + 7) >> 3;
 
-  int                                     ceil_index = 0;
+  for (i = 0; i < byte_length; i++) {
+    out[i] = stream_cipher->message[i] ^ *(((uint8_t *) KS) + i);
+  }
 
   if (zero_bit > 0) {
-    ceil_index = (stream_cipher->blength + 7) >> 3;
-    stream_cipher->message[ceil_index - 1] = stream_cipher->message[ceil_index - 1] & (uint8_t) (0xFF << (8 - zero_bit));
+    out[byte_length - 1] = out[byte_length - 1] & (uint8_t) (0xFF << (8 - zero_bit));
   }
 
   free_wrapper ((void**) &KS);
-  memcpy (out, stream_cipher->message, n * 4);
-
-  if (zero_bit > 0) {
-    out[ceil_index - 1] = stream_cipher->message[ceil_index - 1];
-  }
 
   return 0;
 }
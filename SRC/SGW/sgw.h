@@ -37,6 +37,7 @@
 #include "common_types.h"
 #include "sgw_context_manager.h"
 #include "gtpv1u_sgw_defs.h"
+#include "intertask_interface_types.h"
 
 typedef struct sgw_app_s {
 
@@ -58,6 +59,9 @@ typedef struct sgw_app_s {
   hash_table_ts_t *s11_bearer_context_information_hashtable;
 
   gtpv1u_data_t    gtpv1u_data;
+
+  // task the S11 responses are sent to: TASK_S11, or TASK_MME_APP if linked in the MME process
+  task_id_t        s11_task_id;
 } sgw_app_t;
 
 
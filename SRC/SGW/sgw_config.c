@@ -149,6 +149,16 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
         }
       }
 
+      if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_OUTPUT_BINARY, (const char **)&astring)) {
+        if (astring != NULL) {
+          if (strcasecmp (astring, "yes") == 0) {
+            config_pP->log_config.is_output_binary = true;
+          } else {
+            config_pP->log_config.is_output_binary = false;
+          }
+        }
+      }
+
       if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_COLOR, (const char **)&astring)) {
         if (!strcasecmp("true", astring)) config_pP->log_config.color = true;
         else config_pP->log_config.color = false;
@@ -184,6 +194,8 @@ int sgw_config_parse_file (sgw_config_t * config_pP)
       if (config_setting_lookup_string (subsetting, LOG_CONFIG_STRING_ITTI_LOG_LEVEL, (const char **)&astring)) {
         config_pP->log_config.itti_log_level = OAILOG_LEVEL_STR2INT (astring);
       }
+
+      OAILOG_CONFIG_PARSE (subsetting, &config_pP->log_config);
     }
     OAILOG_SET_CONFIG(&config_pP->log_config);
 
@@ -73,6 +73,7 @@ typedef struct sgw_config_s {
   uint16_t     udp_port_S1u_S12_S4_up;
 
   bool         local_to_eNB;
+  bool         local_to_mme;    ///< S-GW linked in the MME process, S11 messages exchanged with TASK_MME_APP
 
   log_config_t log_config;
 
@@ -327,7 +327,7 @@ sgw_handle_sgi_endpoint_created (
                       create_session_response_p->bearer_contexts_created.bearer_contexts[0].s1u_sgw_fteid.ipv4_address,
                       create_session_response_p->bearer_contexts_created.bearer_contexts[0].eps_bearer_id,
                       create_session_response_p->bearer_contexts_created.bearer_contexts[0].cause);
-  rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
 }
 
@@ -495,7 +495,7 @@ sgw_handle_gtpv1uCreateTunnelResp (
     create_session_response_p->trxn = new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.trxn;
     create_session_response_p->peer_ip = new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.peer_ip;
   }
-  rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+  rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
   OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
 }
 //------------------------------------------------------------------------------
@@ -534,7 +534,7 @@ sgw_handle_gtpv1uUpdateTunnelResp (
       modify_response_p->bearer_contexts_marked_for_removal.num_bearer_context += 1;
       modify_response_p->cause = CONTEXT_NOT_FOUND;
       modify_response_p->trxn = new_bearer_ctxt_info_p->sgw_eps_bearer_context_information.trxn;
-      rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+      rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
     } else if (HASH_TABLE_OK == hash_rc) {
       message_p = itti_alloc_new_message (TASK_SPGW_APP, SGI_UPDATE_ENDPOINT_REQUEST);
@@ -571,7 +571,7 @@ sgw_handle_gtpv1uUpdateTunnelResp (
                         NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u CONTEXT_NOT_FOUND trxn %u",
                         modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0].eps_bearer_id,
                         modify_response_p->trxn);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   }
 
@@ -625,7 +625,7 @@ sgw_handle_sgi_endpoint_updated (
                           NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u CONTEXT_NOT_FOUND trxn %u",
                           modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0].eps_bearer_id,
                           modify_response_p->trxn);
-      rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+      rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
     } else if (HASH_TABLE_OK == hash_rc) {
       OAILOG_DEBUG (LOG_SPGW_APP, "Rx SGI_UPDATE_ENDPOINT_RESPONSE: REQUEST_ACCEPTED\n");
@@ -662,7 +662,7 @@ sgw_handle_sgi_endpoint_updated (
 
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u  trxn %u",
         modify_response_p->bearer_contexts_modified.bearer_contexts[0].eps_bearer_id, modify_response_p->trxn);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   } else {
     if (HASH_TABLE_OK != hash_rc2) {
@@ -676,7 +676,7 @@ sgw_handle_sgi_endpoint_updated (
       MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME,  MSC_S11_MME,
                         NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u CONTEXT_NOT_FOUND trxn %u",
                         modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0].eps_bearer_id, modify_response_p->trxn);
-      rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+      rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
     } else {
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNerror);
@@ -783,7 +783,7 @@ sgw_handle_modify_bearer_request (
       MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME,
                           NULL, 0, "0 S11_MODIFY_BEARER_RESPONSE ebi %u CONTEXT_NOT_FOUND trxn %u",
                           modify_response_p->bearer_contexts_marked_for_removal.bearer_contexts[0].eps_bearer_id, modify_response_p->trxn);
-      rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+      rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
       OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
     } else if (HASH_TABLE_OK == hash_rc) {
       // TO DO
@@ -817,7 +817,7 @@ sgw_handle_modify_bearer_request (
     modify_response_p->cause = CONTEXT_NOT_FOUND;
     modify_response_p->trxn = modify_bearer_pP->trxn;
     OAILOG_DEBUG (LOG_SPGW_APP, "Rx MODIFY_BEARER_REQUEST, teid %u CONTEXT_NOT_FOUND\n", modify_bearer_pP->teid);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   }
 
@@ -892,7 +892,7 @@ sgw_handle_delete_session_request (
     delete_session_resp_p->trxn = delete_session_req_pP->trxn;
     delete_session_resp_p->peer_ip = delete_session_req_pP->peer_ip;
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_DELETE_SESSION_RESPONSE teid %u cause %u trxn %u", delete_session_resp_p->teid, delete_session_resp_p->cause, delete_session_resp_p->trxn);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
 
   } else {
@@ -911,7 +911,7 @@ sgw_handle_delete_session_request (
     delete_session_resp_p->trxn = delete_session_req_pP->trxn;
     delete_session_resp_p->peer_ip = delete_session_req_pP->peer_ip;
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_DELETE_SESSION_RESPONSE CONTEXT_NOT_FOUND trxn %u", delete_session_resp_p->trxn);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   }
 
@@ -981,7 +981,7 @@ sgw_handle_release_access_bearers_request (
     // TODO The S-GW starts buffering downlink packets received for the UE
     // (set target on GTPUSP to order the buffering)
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_RELEASE_ACCESS_BEARERS_RESPONSE S11 MME teid %u cause REQUEST_ACCEPTED", release_access_bearers_resp_p->teid);
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
 
     OAILOG_DEBUG (LOG_SPGW_APP, "Release Access Bearer Respone sent to SGW\n");
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
@@ -989,7 +989,7 @@ sgw_handle_release_access_bearers_request (
     release_access_bearers_resp_p->cause = CONTEXT_NOT_FOUND;
     release_access_bearers_resp_p->teid = 0;
     MSC_LOG_TX_MESSAGE (MSC_SP_GWAPP_MME, MSC_S11_MME, NULL, 0, "0 S11_RELEASE_ACCESS_BEARERS_RESPONSE cause CONTEXT_NOT_FOUND");
-    rv = itti_send_msg_to_task (TASK_S11, INSTANCE_DEFAULT, message_p);
+    rv = itti_send_msg_to_task (sgw_app.s11_task_id, INSTANCE_DEFAULT, message_p);
     OAILOG_FUNC_RETURN(LOG_SPGW_APP, rv);
   }
 }
@@ -98,6 +98,14 @@ static void *sgw_intertask_interface (void *args_p)
       }
       break;
 
+    case S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION:{
+        // no downlink data is buffered by this S-GW
+        OAILOG_DEBUG (LOG_SPGW_APP, "Received S11_DOWNLINK_DATA_NOTIFICATION_FAILURE_INDICATION S11 teid " TEID_FMT " cause %u\n",
+            received_message_p->ittiMsg.s11_downlink_data_notification_failure_indication.teid,
+            received_message_p->ittiMsg.s11_downlink_data_notification_failure_indication.cause);
+      }
+      break;
+
     case GTPV1U_CREATE_TUNNEL_RESP:{
         OAILOG_DEBUG (LOG_SPGW_APP, "Received teid for S1-U: %u and status: %s\n", received_message_p->ittiMsg.gtpv1uCreateTunnelResp.S1u_teid, received_message_p->ittiMsg.gtpv1uCreateTunnelResp.status == 0 ? "Success" : "Failure");
         sgw_handle_gtpv1uCreateTunnelResp (&received_message_p->ittiMsg.gtpv1uCreateTunnelResp);
@@ -190,6 +198,7 @@ int sgw_init (spgw_config_t *spgw_config_pP)
   sgw_app.sgw_ip_address_S11_S4        = spgw_config_pP->sgw_config.ipv4.S11;
 
   sgw_app.sgw_ip_address_S5_S8_up      = spgw_config_pP->sgw_config.ipv4.S5_S8_up;
+  sgw_app.s11_task_id                  = (spgw_config_pP->sgw_config.local_to_mme) ? TASK_MME_APP : TASK_S11;
 
   if (itti_create_task (TASK_SPGW_APP, &sgw_intertask_interface, NULL) < 0) {
     perror ("pthread_create");
@@ -183,6 +183,22 @@ static void usage (char *target)
   OAILOG_INFO (LOG_CONFIG, "        Output intertask messages to provided file\n");
   OAILOG_INFO (LOG_CONFIG, "-V      Print %s version and return\n", PACKAGE_NAME);
 }
+//------------------------------------------------------------------------------
+int spgw_config_parse_config_file (
+  const char * const config_file_pP,
+  spgw_config_t * spgw_config_p)
+{
+  spgw_config_init (spgw_config_p);
+  spgw_config_p->config_file            = bfromcstr(config_file_pP);
+  spgw_config_p->pgw_config.config_file = bfromcstr(config_file_pP);
+  spgw_config_p->sgw_config.config_file = bfromcstr(config_file_pP);
+
+  if (spgw_config_parse_file (spgw_config_p) != 0) {
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
 //------------------------------------------------------------------------------
 int spgw_config_parse_opt_line (
   int argc,
@@ -48,6 +48,10 @@ int spgw_system (
   const char *const file_nameP,
   const int line_numberP);
 
+int spgw_config_parse_config_file (
+  const char * const config_file_pP,
+  spgw_config_t * spgw_config_p);
+
 int spgw_config_parse_opt_line (
   int argc,
   char *argv[],
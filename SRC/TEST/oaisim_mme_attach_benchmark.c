@@ -0,0 +1,1231 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_attach_benchmark.c
+   \brief Attach storm through the S1AP, NAS and MME_APP tasks of the MME, in one process, without SCTP, HSS or S+P-GW.
+   TASK_SCTP is replaced by one simulated eNB that injects S1AP PDUs of N simulated UEs into TASK_S1AP,
+   TASK_S6A answers AIR/ULR with a fixed authentication vector, TASK_SPGW_APP answers CSR/MBR as a S+P-GW would do.
+   With "-s itti" (default) the S+P-GW is linked in the MME process as in the epc executable, MME_APP and
+   TASK_SPGW_APP exchange the S11 messages through ITTI. With "-s gtp" the S11 task and the UDP task of the MME
+   encode the requests in GTPv2-C towards TASK_SPGW_APP listening on the S-GW S11 address of the configuration
+   file, so the context-setup and modify-bearer phases of both runs give the cost of the S11 interface.
+   UEs are plain IMSI attaches (EEA0/EIA2) in the first served TAI of the configuration file, at most "window" UEs
+   are attaching at the same time. An attach is completed when TASK_SPGW_APP receives its Modify Bearer Request.
+   Log levels and outputs are the ones of the configuration file, so the same run with two files gives the
+   cost of the logs on attaches.
+   With "-r N" the S1AP, NAS, MME_APP, S6A (the HSS) and S11 tasks run to completion in N shards instead of a
+   thread per task, "-C N" pins the benchmark on the CPUs 0 to N-1, so threads per task against run to completion
+   is compared by running, for N in 1 2 4 8, "-C N -r 0" then "-C N -r 1" (or "-r N").
+   Usage: oaisim_mme_attach_benchmark -c /path/to/mme.conf [-n UEs] [-w window] [-s itti|gtp] [-r shards] [-C cores]
+          [-o /path/to/results.json]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "bstrlib.h"
+#include "assertions.h"
+#include "log.h"
+#include "msc.h"
+#include "conversions.h"
+#include "common_types.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "mme_config.h"
+#include "intertask_interface_init.h"
+#include "timer.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme.h"
+#include "nas_defs.h"
+#include "mme_app_extern.h"
+#include "udp_primitives_server.h"
+#include "s11_mme.h"
+#include "NwGtpv2cMsg.h"
+#include "NwGtpv2cIe.h"
+#include "mme_app_ue_handle.h"
+#include "oai_clock.h"
+#include "secu_defs.h"
+#include "securityDef.h"
+#include "NasSecurityAlgorithms.h"
+
+#define ATTACH_BENCHMARK_DEFAULT_UES           10000
+#define ATTACH_BENCHMARK_DEFAULT_WINDOW           64
+#define ATTACH_BENCHMARK_STALL_SEC                 5   /* no attach completed during this time: abort */
+#define ATTACH_BENCHMARK_ASSOC_ID                  1
+#define ATTACH_BENCHMARK_STREAMS                   2
+#define ATTACH_BENCHMARK_UE_STREAM                 1
+#define ATTACH_BENCHMARK_MACRO_ENB_ID            0xe00
+#define ATTACH_BENCHMARK_CELL_ID                   1
+#define ATTACH_BENCHMARK_ENB_S1U_ADDRESS   0x0a000001  /* 10.0.0.1 */
+#define ATTACH_BENCHMARK_SGW_S1U_ADDRESS   0x0a000002  /* 10.0.0.2 */
+#define ATTACH_BENCHMARK_NAS_MAX_LENGTH           64
+#define ATTACH_BENCHMARK_GTPV2C_PORT            2123
+#define ATTACH_BENCHMARK_GTPV2C_MAX_LENGTH      1024
+
+typedef enum {
+  ATTACH_PHASE_AUTHENTICATION = 0,  /* Initial UE Message -> Authentication Request, AIR */
+  ATTACH_PHASE_SECURITY_MODE,       /* Authentication Response -> Security Mode Command */
+  ATTACH_PHASE_CONTEXT_SETUP,       /* Security Mode Complete -> Initial Context Setup Request, ULR, CSR */
+  ATTACH_PHASE_MODIFY_BEARER,       /* Initial Context Setup Response -> Modify Bearer Request */
+  ATTACH_PHASE_ATTACH,              /* Initial UE Message -> Modify Bearer Request */
+  ATTACH_PHASE_MAX
+} attach_phase_t;
+
+typedef enum {
+  ATTACH_S11_ITTI = 0,              /* S+P-GW linked in the MME process */
+  ATTACH_S11_GTP,                   /* GTPv2-C through TASK_S11 and TASK_UDP */
+  ATTACH_S11_MAX
+} attach_s11_mode_t;
+
+typedef enum {
+  ATTACH_UE_IDLE = 0,
+  ATTACH_UE_ATTACHING,
+  ATTACH_UE_ATTACHED,
+} attach_ue_state_t;
+
+typedef struct attach_ue_s {
+  char                       imsi[IMSI_BCD_DIGITS_MAX + 1];
+  attach_ue_state_t          state;
+  S1ap_MME_UE_S1AP_ID_t      mme_ue_s1ap_id;
+  uint64_t                   start_ns;         /* Initial UE Message */
+  uint64_t                   last_tx_ns;       /* last uplink message of the UE */
+} attach_ue_t;
+
+/* Payload of MESSAGE_TEST from TASK_SPGW_APP to TASK_SCTP, an attach is completed */
+typedef struct attach_completed_s {
+  uint64_t                   modify_bearer_ns;
+  uint32_t                   ue_index;
+} attach_completed_t;
+
+#define ATTACH_COMPLETED(mSGpTR)   ((attach_completed_t *)((uint8_t *)(mSGpTR) + sizeof (MessageHeader)))
+
+typedef struct attach_benchmark_run_s {
+  uint32_t                   num_ues;
+  uint32_t                   window;
+  const char                *output;
+  attach_s11_mode_t          s11_mode;
+  uint32_t                   shards;               /* 0: thread per task */
+  uint32_t                   cores;                /* 0: not pinned */
+  int                        sgw_sd;               /* GTPv2-C socket of the S+P-GW */
+  uint32_t                  *mme_s11_teids;        /* GTPv2-C, S11 MME TEID of each UE */
+  attach_ue_t               *ues;
+  uint64_t                  *latencies_ns[ATTACH_PHASE_MAX];
+  uint32_t                   num_started;
+  uint32_t                   num_completed;
+  uint32_t                   imsi_prefix_length;   /* MCC + MNC */
+  S1ap_TAI_t                 tai;
+  S1ap_EUTRAN_CGI_t          cgi;
+  uint8_t                    knas_int[AUTH_KNAS_INT_SIZE];
+  long                       timer_id;
+  uint32_t                   last_completed;
+  uint32_t                   stalled_sec;
+  uint64_t                   start_ns;
+  uint64_t                   end_ns;
+  uint64_t                   cpu_start_ns[TASK_MAX];
+  oai_clock_stats_t          clock_start;
+  int                        exit_status;
+} attach_benchmark_run_t;
+
+static const char * const   phase2str[ATTACH_PHASE_MAX] = {"authentication", "security-mode", "context-setup", "modify-bearer", "attach"};
+static const char * const   s11mode2str[ATTACH_S11_MAX] = {"itti", "gtp"};
+/* tasks of the MME, then stubs, then tasks of the GTPv2-C S11 interface */
+static const task_id_t      cpu_tasks[] = {TASK_S1AP, TASK_NAS_MME, TASK_MME_APP, TASK_SCTP, TASK_S6A, TASK_SPGW_APP, TASK_S11, TASK_UDP};
+/* same authentication vector for all UEs, RES = XRES */
+static const uint8_t        vector_rand[RAND_LENGTH_OCTETS] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+static const uint8_t        vector_autn[AUTN_LENGTH_OCTETS] = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x80, 0x00, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e};
+static const uint8_t        vector_xres[8] = {0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28};
+static const uint8_t        vector_kasme[KASME_LENGTH_OCTETS] = {
+  0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f, 0x40,
+  0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, 0x50};
+static attach_benchmark_run_t g_run;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  uint64_t  va = *(const uint64_t *)a;
+  uint64_t  vb = *(const uint64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t percentile (const uint64_t * const sorted, const uint64_t num, const double p)
+{
+  uint64_t  index = (uint64_t)(p * (double)num);
+
+  return sorted[(index >= num) ? num - 1 : index];
+}
+
+//==============================================================================
+// NAS of the UEs
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Plain Attach Request, IMSI identity, EEA0/EIA2 only, with a PDN Connectivity Request for the default APN
+static size_t nas_encode_attach_request (const char * const imsi, uint8_t * const nas)
+{
+  size_t    digits = strlen (imsi);
+  size_t    length = 0;
+  size_t    i = 0;
+
+  nas[length++] = (SECURITY_HEADER_TYPE_NOT_PROTECTED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[length++] = ATTACH_REQUEST;
+  nas[length++] = 0x71;                  /* NAS key set identifier 7 (no key available), EPS attach */
+  nas[length++] = (uint8_t)((digits / 2) + 1);
+  nas[length++] = (uint8_t)(((imsi[0] - '0') << 4) | ((digits & 1) << 3) | 0x01 /* IMSI */);
+  for (i = 1; i < digits; i += 2) {
+    nas[length++] = (uint8_t)(((((i + 1) < digits) ? (imsi[i + 1] - '0') : 0x0f) << 4) | (imsi[i] - '0'));
+  }
+  nas[length++] = 2;                     /* UE network capability */
+  nas[length++] = UE_NETWORK_CAPABILITY_EEA0;
+  nas[length++] = UE_NETWORK_CAPABILITY_EIA2;
+  nas[length++] = 0;                     /* ESM message container */
+  nas[length++] = 4;
+  nas[length++] = EPS_SESSION_MANAGEMENT_MESSAGE;
+  nas[length++] = 1;                     /* PTI */
+  nas[length++] = PDN_CONNECTIVITY_REQUEST;
+  nas[length++] = 0x11;                  /* PDN type IPv4, initial request */
+  return length;
+}
+
+//------------------------------------------------------------------------------
+static size_t nas_encode_authentication_response (uint8_t * const nas)
+{
+  size_t    length = 0;
+
+  nas[length++] = (SECURITY_HEADER_TYPE_NOT_PROTECTED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[length++] = AUTHENTICATION_RESPONSE;
+  nas[length++] = sizeof (vector_xres);
+  memcpy (&nas[length], vector_xres, sizeof (vector_xres));
+  return length + sizeof (vector_xres);
+}
+
+//------------------------------------------------------------------------------
+// Security protected NAS message with EIA2, the uplink NAS count of a UE never overflows during an attach
+static size_t nas_protect (const uint8_t security_header_type, const uint8_t sequence, const uint8_t * const plain, const size_t plain_length, uint8_t * const nas)
+{
+  nas_stream_cipher_t       stream_cipher = {0};
+  uint8_t                   mac[4] = {0};
+
+  nas[0] = (security_header_type << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[5] = sequence;
+  memcpy (&nas[6], plain, plain_length);
+  stream_cipher.key        = g_run.knas_int;
+  stream_cipher.key_length = AUTH_KNAS_INT_SIZE;
+  stream_cipher.count      = sequence;
+  stream_cipher.bearer     = 0x00;
+  stream_cipher.direction  = SECU_DIRECTION_UPLINK;
+  stream_cipher.message    = &nas[5];
+  stream_cipher.blength    = (plain_length + 1) << 3;
+  nas_stream_encrypt_eia2 (&stream_cipher, mac);
+  memcpy (&nas[1], mac, sizeof (mac));
+  return plain_length + 6;
+}
+
+//------------------------------------------------------------------------------
+static size_t nas_encode_security_mode_complete (uint8_t * const nas)
+{
+  const uint8_t             plain[] = {EPS_MOBILITY_MANAGEMENT_MESSAGE, SECURITY_MODE_COMPLETE};
+
+  return nas_protect (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW, 0, plain, sizeof (plain), nas);
+}
+
+//------------------------------------------------------------------------------
+static size_t nas_encode_attach_complete (const uint8_t ebi, uint8_t * const nas)
+{
+  const uint8_t             plain[] = {EPS_MOBILITY_MANAGEMENT_MESSAGE, ATTACH_COMPLETE, 0, 3,
+                                       (uint8_t)((ebi << 4) | EPS_SESSION_MANAGEMENT_MESSAGE), 0, ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT};
+
+  return nas_protect (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, 1, plain, sizeof (plain), nas);
+}
+
+//------------------------------------------------------------------------------
+static uint8_t nas_message_type (const uint8_t * const nas, const size_t length)
+{
+  if ((2 <= length) && (SECURITY_HEADER_TYPE_NOT_PROTECTED == (nas[0] >> 4))) {
+    return nas[1];
+  } else if (8 <= length) {
+    // EEA0 only, the plain message follows the MAC and the sequence number
+    return nas[7];
+  }
+  return 0;
+}
+
+//==============================================================================
+// Simulated eNB in place of TASK_SCTP
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void enb_send_s1ap (const sctp_stream_id_t stream, uint8_t * const buffer, const uint32_t length)
+{
+  MessageDef               *message_p = itti_alloc_new_message (TASK_SCTP, SCTP_DATA_IND);
+
+  SCTP_DATA_IND (message_p).payload    = blk2bstr (buffer, length);
+  SCTP_DATA_IND (message_p).assoc_id   = ATTACH_BENCHMARK_ASSOC_ID;
+  SCTP_DATA_IND (message_p).stream     = stream;
+  SCTP_DATA_IND (message_p).instreams  = ATTACH_BENCHMARK_STREAMS;
+  SCTP_DATA_IND (message_p).outstreams = ATTACH_BENCHMARK_STREAMS;
+  free (buffer);
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+// SCTP_INIT_MSG of TASK_S1AP: the HSS is reachable, the eNB connects and sends S1 Setup Request with all served TAIs
+static void enb_setup (void)
+{
+  S1ap_S1SetupRequestIEs_t  ies = {0};
+  S1ap_S1SetupRequest_t     s1_setup_request = {0};
+  S1ap_SupportedTAs_Item_t *ta_p = NULL;
+  S1ap_PLMNidentity_t      *plmn_p = NULL;
+  MessageDef               *message_p = NULL;
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+  int                       i = 0;
+
+  message_p = itti_alloc_new_message (TASK_S6A, ACTIVATE_MESSAGE);
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+
+  message_p = itti_alloc_new_message (TASK_SCTP, SCTP_NEW_ASSOCIATION);
+  message_p->ittiMsg.sctp_new_peer.assoc_id   = ATTACH_BENCHMARK_ASSOC_ID;
+  message_p->ittiMsg.sctp_new_peer.instreams  = ATTACH_BENCHMARK_STREAMS;
+  message_p->ittiMsg.sctp_new_peer.outstreams = ATTACH_BENCHMARK_STREAMS;
+  itti_send_msg_to_task (TASK_S1AP, INSTANCE_DEFAULT, message_p);
+
+  MCC_MNC_TO_PLMNID (mme_config.served_tai.plmn_mcc[0], mme_config.served_tai.plmn_mnc[0], mme_config.served_tai.plmn_mnc_len[0],
+      &ies.global_ENB_ID.pLMNidentity);
+  ies.global_ENB_ID.eNB_ID.present = S1ap_ENB_ID_PR_macroENB_ID;
+  MACRO_ENB_ID_TO_BIT_STRING (ATTACH_BENCHMARK_MACRO_ENB_ID, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
+    ta_p = calloc (1, sizeof (S1ap_SupportedTAs_Item_t));
+    plmn_p = calloc (1, sizeof (S1ap_PLMNidentity_t));
+    TAC_TO_ASN1 (mme_config.served_tai.tac[i], &ta_p->tAC);
+    MCC_MNC_TO_TBCD (mme_config.served_tai.plmn_mcc[i], mme_config.served_tai.plmn_mnc[i], mme_config.served_tai.plmn_mnc_len[i], plmn_p);
+    ASN_SEQUENCE_ADD (&ta_p->broadcastPLMNs.list, plmn_p);
+    ASN_SEQUENCE_ADD (&ies.supportedTAs.list, ta_p);
+  }
+  ies.defaultPagingDRX = S1ap_PagingDRX_v64;
+  AssertFatal (s1ap_encode_s1ap_s1setuprequesties (&s1_setup_request, &ies) >= 0, "Encoding of S1 Setup Request IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_S1Setup, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_S1SetupRequest, &s1_setup_request) >= 0, "Encoding of S1 Setup Request failed");
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_Global_ENB_ID, &ies.global_ENB_ID);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_SupportedTAs, &ies.supportedTAs);
+  enb_send_s1ap (0, buffer, length);
+
+  // TAI and CGI of all UE messages
+  TAC_TO_ASN1 (mme_config.served_tai.tac[0], &g_run.tai.tAC);
+  MCC_MNC_TO_TBCD (mme_config.served_tai.plmn_mcc[0], mme_config.served_tai.plmn_mnc[0], mme_config.served_tai.plmn_mnc_len[0], &g_run.tai.pLMNidentity);
+  MCC_MNC_TO_TBCD (mme_config.served_tai.plmn_mcc[0], mme_config.served_tai.plmn_mnc[0], mme_config.served_tai.plmn_mnc_len[0], &g_run.cgi.pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (ATTACH_BENCHMARK_MACRO_ENB_ID, ATTACH_BENCHMARK_CELL_ID, &g_run.cgi.cell_ID);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_initial_ue_message (const uint32_t ue_index)
+{
+  S1ap_InitialUEMessageIEs_t ies = {0};
+  S1ap_InitialUEMessage_t    initial_ue_message = {0};
+  attach_ue_t               *ue_p = &g_run.ues[ue_index];
+  uint8_t                    nas[ATTACH_BENCHMARK_NAS_MAX_LENGTH];
+  uint8_t                   *buffer = NULL;
+  uint32_t                   length = 0;
+
+  ies.eNB_UE_S1AP_ID          = ue_index + 1;
+  ies.nas_pdu.buf             = nas;
+  ies.nas_pdu.size            = nas_encode_attach_request (ue_p->imsi, nas);
+  ies.tai                     = g_run.tai;
+  ies.eutran_cgi              = g_run.cgi;
+  ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Signalling;
+  AssertFatal (s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) >= 0, "Encoding of Initial UE Message IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) >= 0, "Encoding of Initial UE Message failed");
+  ue_p->state      = ATTACH_UE_ATTACHING;
+  ue_p->start_ns   = now_ns ();
+  ue_p->last_tx_ns = ue_p->start_ns;
+  enb_send_s1ap (ATTACH_BENCHMARK_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_uplink_nas (const uint32_t ue_index, uint8_t * const nas, const size_t nas_length)
+{
+  S1ap_UplinkNASTransportIEs_t ies = {0};
+  S1ap_UplinkNASTransport_t    uplink_nas_transport = {0};
+  attach_ue_t                 *ue_p = &g_run.ues[ue_index];
+  uint8_t                     *buffer = NULL;
+  uint32_t                     length = 0;
+
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_index + 1;
+  ies.nas_pdu.buf    = nas;
+  ies.nas_pdu.size   = nas_length;
+  ies.eutran_cgi     = g_run.cgi;
+  ies.tai            = g_run.tai;
+  AssertFatal (s1ap_encode_s1ap_uplinknastransporties (&uplink_nas_transport, &ies) >= 0, "Encoding of Uplink NAS Transport IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_uplinkNASTransport, S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UplinkNASTransport, &uplink_nas_transport) >= 0, "Encoding of Uplink NAS Transport failed");
+  ue_p->last_tx_ns = now_ns ();
+  enb_send_s1ap (ATTACH_BENCHMARK_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_initial_context_setup_response (const uint32_t ue_index, const S1ap_E_RAB_ID_t e_rab_id)
+{
+  S1ap_InitialContextSetupResponseIEs_t ies = {0};
+  S1ap_InitialContextSetupResponse_t    initial_context_setup_response = {0};
+  S1ap_E_RABSetupItemCtxtSURes_t       *e_rab_p = calloc (1, sizeof (S1ap_E_RABSetupItemCtxtSURes_t));
+  uint32_t                              enb_s1u_address = htonl (ATTACH_BENCHMARK_ENB_S1U_ADDRESS);
+  attach_ue_t                          *ue_p = &g_run.ues[ue_index];
+  uint8_t                              *buffer = NULL;
+  uint32_t                              length = 0;
+
+  e_rab_p->e_RAB_ID = e_rab_id;
+  e_rab_p->transportLayerAddress.buf = calloc (4, sizeof (uint8_t));
+  memcpy (e_rab_p->transportLayerAddress.buf, &enb_s1u_address, 4);
+  e_rab_p->transportLayerAddress.size = 4;
+  e_rab_p->transportLayerAddress.bits_unused = 0;
+  GTP_TEID_TO_ASN1 (ue_index + 1, &e_rab_p->gTP_TEID);
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_index + 1;
+  ASN_SEQUENCE_ADD (&ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes, e_rab_p);
+  AssertFatal (s1ap_encode_s1ap_initialcontextsetupresponseies (&initial_context_setup_response, &ies) >= 0,
+      "Encoding of Initial Context Setup Response IEs failed");
+  AssertFatal (s1ap_generate_successfull_outcome (&buffer, &length, S1ap_ProcedureCode_id_InitialContextSetup, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_InitialContextSetupResponse, &initial_context_setup_response) >= 0, "Encoding of Initial Context Setup Response failed");
+  ASN_STRUCT_FREE (asn_DEF_S1ap_E_RABSetupItemCtxtSURes, e_rab_p);
+  asn_sequence_empty (&ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes);
+  ue_p->last_tx_ns = now_ns ();
+  enb_send_s1ap (ATTACH_BENCHMARK_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void enb_record (const attach_phase_t phase, const uint32_t ue_index, const uint64_t received_ns)
+{
+  g_run.latencies_ns[phase][ue_index] = received_ns - g_run.ues[ue_index].last_tx_ns;
+}
+
+//------------------------------------------------------------------------------
+static bool enb_ue_index (const S1ap_ENB_UE_S1AP_ID_t enb_ue_s1ap_id, uint32_t * const ue_index)
+{
+  if ((1 > enb_ue_s1ap_id) || (g_run.num_ues < enb_ue_s1ap_id) || (ATTACH_UE_ATTACHING != g_run.ues[enb_ue_s1ap_id - 1].state)) {
+    OAILOG_WARNING (LOG_UTIL, "Message for unknown eNB UE S1AP ID %ld\n", (long)enb_ue_s1ap_id);
+    return false;
+  }
+  *ue_index = enb_ue_s1ap_id - 1;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_downlink_nas_transport (ANY_t * const value, const uint64_t received_ns)
+{
+  S1ap_DownlinkNASTransportIEs_t ies = {0};
+  uint8_t                        nas[ATTACH_BENCHMARK_NAS_MAX_LENGTH];
+  uint32_t                       ue_index = 0;
+
+  if ((0 > s1ap_decode_s1ap_downlinknastransporties (&ies, value)) || (!enb_ue_index (ies.eNB_UE_S1AP_ID, &ue_index))) {
+    return;
+  }
+  g_run.ues[ue_index].mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+  switch (nas_message_type (ies.nas_pdu.buf, ies.nas_pdu.size)) {
+  case AUTHENTICATION_REQUEST:
+    enb_record (ATTACH_PHASE_AUTHENTICATION, ue_index, received_ns);
+    ue_send_uplink_nas (ue_index, nas, nas_encode_authentication_response (nas));
+    break;
+
+  case SECURITY_MODE_COMMAND:
+    enb_record (ATTACH_PHASE_SECURITY_MODE, ue_index, received_ns);
+    ue_send_uplink_nas (ue_index, nas, nas_encode_security_mode_complete (nas));
+    break;
+
+  default:
+    // EMM information, rejects: the attach does not complete and the run stalls
+    OAILOG_WARNING (LOG_UTIL, "Unexpected downlink NAS message 0x%x for IMSI %s\n",
+        nas_message_type (ies.nas_pdu.buf, ies.nas_pdu.size), g_run.ues[ue_index].imsi);
+    break;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+}
+
+//------------------------------------------------------------------------------
+// The Attach Accept is in the E-RAB to be setup, the eNB answers then the UE sends Attach Complete
+static void enb_handle_initial_context_setup_request (ANY_t * const value, const uint64_t received_ns)
+{
+  S1ap_InitialContextSetupRequestIEs_t ies = {0};
+  S1ap_E_RABToBeSetupItemCtxtSUReq_t  *e_rab_p = NULL;
+  uint8_t                              nas[ATTACH_BENCHMARK_NAS_MAX_LENGTH];
+  uint32_t                             ue_index = 0;
+
+  if ((0 > s1ap_decode_s1ap_initialcontextsetuprequesties (&ies, value)) || (!enb_ue_index (ies.eNB_UE_S1AP_ID, &ue_index))) {
+    return;
+  }
+  AssertFatal (0 < ies.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.count, "No E-RAB to be setup");
+  e_rab_p = ies.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.array[0];
+  enb_record (ATTACH_PHASE_CONTEXT_SETUP, ue_index, received_ns);
+  ue_send_initial_context_setup_response (ue_index, e_rab_p->e_RAB_ID);
+  if ((e_rab_p->nAS_PDU) && (ATTACH_ACCEPT == nas_message_type (e_rab_p->nAS_PDU->buf, e_rab_p->nAS_PDU->size))) {
+    // keep the time of Initial Context Setup Response for ATTACH_PHASE_MODIFY_BEARER
+    uint64_t last_tx_ns = g_run.ues[ue_index].last_tx_ns;
+
+    ue_send_uplink_nas (ue_index, nas, nas_encode_attach_complete (e_rab_p->e_RAB_ID, nas));
+    g_run.ues[ue_index].last_tx_ns = last_tx_ns;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void enb_report (void)
+{
+  uint64_t                  cpu_ns[sizeof (cpu_tasks) / sizeof (cpu_tasks[0])];
+  double                    attaches_per_sec = 0;
+  FILE                     *json = NULL;
+  uint32_t                  num = g_run.num_completed;
+  uint64_t                  cpu_total_ns = 0;
+  mme_app_ue_handle_stats_t lookups = {0};
+  oai_clock_stats_t         clock = {0};
+  int                       p = 0;
+  int                       t = 0;
+  int                       u = 0;
+
+  for (t = 0; t < sizeof (cpu_tasks) / sizeof (cpu_tasks[0]); t++) {
+    cpu_ns[t] = itti_get_task_cpu_time_ns (cpu_tasks[t]) - g_run.cpu_start_ns[cpu_tasks[t]];
+    // tasks of a shard report the CPU time of the shard thread, counted once
+    for (u = 0; (u < t) && ((0 == itti_get_task_shard (cpu_tasks[t])) || (itti_get_task_shard (cpu_tasks[u]) != itti_get_task_shard (cpu_tasks[t]))); u++);
+    cpu_total_ns += (u == t) ? cpu_ns[t] : 0;
+  }
+  attaches_per_sec = (double)num * 1e9 / (double)(g_run.end_ns - g_run.start_ns);
+  if (g_run.output) {
+    json = fopen (g_run.output, "w");
+    AssertFatal (NULL != json, "Could not open %s", g_run.output);
+    fprintf (json, "{\"benchmark\": \"attach\", \"s11\": \"%s\", \"shards\": %u, \"cores\": %u, \"ues\": %u, \"window\": %u, \"attached\": %u, "
+        "\"attaches_per_sec\": %.0f, \"cpu_ns\": %" PRIu64 ", \"phases\": [\n",
+        s11mode2str[g_run.s11_mode], g_run.shards, g_run.cores, g_run.num_ues, g_run.window, num, attaches_per_sec, cpu_total_ns);
+  }
+  fprintf (stdout, "%u/%u UEs attached, S11 %s, %u shards, %u cores, window %u, %.3f s, %.0f attaches/s\n",
+      num, g_run.num_ues, s11mode2str[g_run.s11_mode], g_run.shards, g_run.cores, g_run.window, (double)(g_run.end_ns - g_run.start_ns) / 1e9, attaches_per_sec);
+  if (num) {
+    fprintf (stdout, "%-16s %10s %10s %10s\n", "phase", "p50 us", "p99 us", "p999 us");
+    for (p = 0; p < ATTACH_PHASE_MAX; p++) {
+      // only the UEs that completed, their index is not ordered by completion
+      uint32_t  n = 0;
+      uint32_t  i = 0;
+
+      for (i = 0; i < g_run.num_ues; i++) {
+        if (ATTACH_UE_ATTACHED == g_run.ues[i].state) {
+          g_run.latencies_ns[p][n++] = g_run.latencies_ns[p][i];
+        }
+      }
+      qsort (g_run.latencies_ns[p], n, sizeof (uint64_t), compare_uint64);
+      uint64_t p50  = percentile (g_run.latencies_ns[p], n, 0.50);
+      uint64_t p99  = percentile (g_run.latencies_ns[p], n, 0.99);
+      uint64_t p999 = percentile (g_run.latencies_ns[p], n, 0.999);
+
+      fprintf (stdout, "%-16s %10.1f %10.1f %10.1f\n", phase2str[p], (double)p50 / 1e3, (double)p99 / 1e3, (double)p999 / 1e3);
+      if (json) {
+        fprintf (json, "%s  {\"phase\": \"%s\", \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 "}",
+            (p) ? ",\n" : "", phase2str[p], p50, p99, p999);
+      }
+    }
+  }
+  fprintf (stdout, "%-16s %6s %12s %14s\n", "task", "shard", "cpu ms", "cpu us/attach");
+  if (json) {
+    fprintf (json, "\n], \"tasks\": [\n");
+  }
+  for (t = 0; t < sizeof (cpu_tasks) / sizeof (cpu_tasks[0]); t++) {
+    fprintf (stdout, "%-16s %6u %12.1f %14.1f\n", itti_get_task_name (cpu_tasks[t]), itti_get_task_shard (cpu_tasks[t]),
+        (double)cpu_ns[t] / 1e6, (num) ? (double)cpu_ns[t] / 1e3 / num : 0.0);
+    if (json) {
+      fprintf (json, "%s  {\"task\": \"%s\", \"shard\": %u, \"cpu_ns\": %" PRIu64 "}", (t) ? ",\n" : "",
+          itti_get_task_name (cpu_tasks[t]), itti_get_task_shard (cpu_tasks[t]), cpu_ns[t]);
+    }
+  }
+  fprintf (stdout, "%-16s %6s %12.1f %14.1f\n", "total", "", (double)cpu_total_ns / 1e6, (num) ? (double)cpu_total_ns / 1e3 / num : 0.0);
+  // without the UE handle, each lookup would be a probe of the UE collection
+  mme_app_ue_handle_get_stats (&lookups);
+  fprintf (stdout, "%-16s %12s %14s\n", "UE lookups", "per attach", "probed");
+  fprintf (stdout, "%-16s %12.1f %14.1f\n", "MME_APP", (num) ? (double)lookups.mme_app_lookups / num : 0.0, (num) ? (double)lookups.mme_app_probes / num : 0.0);
+  fprintf (stdout, "%-16s %12.1f %14.1f\n", "EMM", (num) ? (double)lookups.emm_lookups / num : 0.0, (num) ? (double)lookups.emm_probes / num : 0.0);
+  // time stamps of the logs, MSC and ITTI trace and of the GTPv2-C timers
+  oai_clock_get_stats (&clock);
+  clock.coarse_reads  -= g_run.clock_start.coarse_reads;
+  clock.precise_reads -= g_run.clock_start.precise_reads;
+  fprintf (stdout, "%-16s %12s\n", "clock reads", "per attach");
+  fprintf (stdout, "%-16s %12.1f\n", "coarse", (num) ? (double)clock.coarse_reads / num : 0.0);
+  fprintf (stdout, "%-16s %12.1f\n", "precise", (num) ? (double)clock.precise_reads / num : 0.0);
+  if (json) {
+    fprintf (json, "\n], \"ue_lookups\": {\"mme_app\": %" PRIu64 ", \"mme_app_probed\": %" PRIu64 ", \"emm\": %" PRIu64 ", \"emm_probed\": %" PRIu64 "}, "
+        "\"clock_reads\": {\"coarse\": %" PRIu64 ", \"precise\": %" PRIu64 "}}\n",
+        lookups.mme_app_lookups, lookups.mme_app_probes, lookups.emm_lookups, lookups.emm_probes, clock.coarse_reads, clock.precise_reads);
+    fclose (json);
+  }
+  fflush (stdout);
+}
+
+//------------------------------------------------------------------------------
+static void enb_finish (void)
+{
+  g_run.end_ns = now_ns ();
+  timer_remove (g_run.timer_id);
+  enb_report ();
+  itti_terminate_tasks (TASK_SCTP);
+}
+
+//------------------------------------------------------------------------------
+static void enb_start_next_ue (void)
+{
+  if (g_run.num_started < g_run.num_ues) {
+    ue_send_initial_ue_message (g_run.num_started++);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_s1ap (bstring payload)
+{
+  S1AP_PDU_t               *pdu_p = NULL;
+  asn_dec_rval_t            dec_ret = {0};
+  uint64_t                  received_ns = now_ns ();
+  int                       t = 0;
+  int                       i = 0;
+
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, bdata (payload), blength (payload), 0, 0);
+  AssertFatal (RC_OK == dec_ret.code, "Decoding of S1AP PDU from MME failed");
+  switch (pdu_p->present) {
+  case S1AP_PDU_PR_initiatingMessage:
+    switch (pdu_p->choice.initiatingMessage.procedureCode) {
+    case S1ap_ProcedureCode_id_downlinkNASTransport:
+      enb_handle_downlink_nas_transport (&pdu_p->choice.initiatingMessage.value, received_ns);
+      break;
+
+    case S1ap_ProcedureCode_id_InitialContextSetup:
+      enb_handle_initial_context_setup_request (&pdu_p->choice.initiatingMessage.value, received_ns);
+      break;
+
+    default:
+      OAILOG_WARNING (LOG_UTIL, "Ignoring S1AP procedure %ld from MME\n", (long)pdu_p->choice.initiatingMessage.procedureCode);
+      break;
+    }
+    break;
+
+  case S1AP_PDU_PR_successfulOutcome:
+    AssertFatal (S1ap_ProcedureCode_id_S1Setup == pdu_p->choice.successfulOutcome.procedureCode,
+        "Unexpected successful outcome of S1AP procedure %ld", (long)pdu_p->choice.successfulOutcome.procedureCode);
+    for (t = 0; t < sizeof (cpu_tasks) / sizeof (cpu_tasks[0]); t++) {
+      g_run.cpu_start_ns[cpu_tasks[t]] = itti_get_task_cpu_time_ns (cpu_tasks[t]);
+    }
+    oai_clock_get_stats (&g_run.clock_start);
+    timer_setup (1, 0, TASK_SCTP, INSTANCE_DEFAULT, TIMER_PERIODIC, NULL, &g_run.timer_id);
+    g_run.start_ns = now_ns ();
+    for (i = 0; i < g_run.window; i++) {
+      enb_start_next_ue ();
+    }
+    break;
+
+  default:
+    AssertFatal (0, "S1 Setup or procedure of UE failed (S1AP PDU %d), check the served TAIs and GUMMEI of the configuration", pdu_p->present);
+    break;
+  }
+  ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+}
+
+//------------------------------------------------------------------------------
+static void *enb_task (__attribute__ ((unused)) void *args_p)
+{
+  MessageDef               *received_message_p = NULL;
+  attach_completed_t       *completed_p = NULL;
+  int                       rc = 0;
+
+  itti_mark_task_ready (TASK_SCTP);
+  while (1) {
+    itti_receive_msg (TASK_SCTP, &received_message_p);
+    switch (ITTI_MSG_ID (received_message_p)) {
+    case SCTP_INIT_MSG:
+      enb_setup ();
+      break;
+
+    case SCTP_DATA_REQ:
+      enb_handle_s1ap (SCTP_DATA_REQ (received_message_p).payload);
+      bdestroy (SCTP_DATA_REQ (received_message_p).payload);
+      break;
+
+    case MESSAGE_TEST:
+      completed_p = ATTACH_COMPLETED (received_message_p);
+      if (ATTACH_UE_ATTACHING == g_run.ues[completed_p->ue_index].state) {
+        enb_record (ATTACH_PHASE_MODIFY_BEARER, completed_p->ue_index, completed_p->modify_bearer_ns);
+        g_run.latencies_ns[ATTACH_PHASE_ATTACH][completed_p->ue_index] = completed_p->modify_bearer_ns - g_run.ues[completed_p->ue_index].start_ns;
+        g_run.ues[completed_p->ue_index].state = ATTACH_UE_ATTACHED;
+        if (++g_run.num_completed == g_run.num_ues) {
+          enb_finish ();
+        }
+        enb_start_next_ue ();
+      }
+      break;
+
+    case TIMER_HAS_EXPIRED:
+      g_run.stalled_sec = (g_run.last_completed == g_run.num_completed) ? g_run.stalled_sec + 1 : 0;
+      g_run.last_completed = g_run.num_completed;
+      if (ATTACH_BENCHMARK_STALL_SEC <= g_run.stalled_sec) {
+        fprintf (stderr, "No attach completed for %d s, %u UEs attaching\n", ATTACH_BENCHMARK_STALL_SEC, g_run.num_started - g_run.num_completed);
+        g_run.exit_status = -1;
+        enb_finish ();
+      }
+      break;
+
+    case TERMINATE_MESSAGE:
+      itti_exit_task ();
+      break;
+
+    default:
+      break;
+    }
+    rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+    AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+    received_message_p = NULL;
+  }
+  return NULL;
+}
+
+//==============================================================================
+// HSS in place of TASK_S6A
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void hss_handle_auth_info_req (const s6a_auth_info_req_t * const air_p)
+{
+  MessageDef               *message_p = itti_alloc_new_message (TASK_S6A, S6A_AUTH_INFO_ANS);
+  s6a_auth_info_ans_t      *aia_p = &message_p->ittiMsg.s6a_auth_info_ans;
+  eutran_vector_t          *vector_p = &aia_p->auth_info.eutran_vector[0];
+
+  memcpy (aia_p->imsi, air_p->imsi, air_p->imsi_length);
+  aia_p->imsi_length = air_p->imsi_length;
+  aia_p->result.present = S6A_RESULT_BASE;
+  aia_p->result.choice.base = DIAMETER_SUCCESS;
+  aia_p->auth_info.nb_of_vectors = 1;
+  memcpy (vector_p->rand, vector_rand, sizeof (vector_rand));
+  memcpy (vector_p->autn, vector_autn, sizeof (vector_autn));
+  memcpy (vector_p->kasme, vector_kasme, sizeof (vector_kasme));
+  memcpy (vector_p->xres.data, vector_xres, sizeof (vector_xres));
+  vector_p->xres.size = sizeof (vector_xres);
+  itti_send_msg_to_task (TASK_NAS_MME, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void hss_handle_update_location_req (const s6a_update_location_req_t * const ulr_p)
+{
+  MessageDef                *message_p = itti_alloc_new_message (TASK_S6A, S6A_UPDATE_LOCATION_ANS);
+  s6a_update_location_ans_t *ula_p = &message_p->ittiMsg.s6a_update_location_ans;
+  subscription_data_t       *subscription_data_p = &ula_p->subscription_data;
+  apn_configuration_t       *apn_p = &subscription_data_p->apn_config_profile.apn_configuration[0];
+
+  memcpy (ula_p->imsi, ulr_p->imsi, ulr_p->imsi_length);
+  ula_p->imsi_length = ulr_p->imsi_length;
+  ula_p->result.present = S6A_RESULT_BASE;
+  ula_p->result.choice.base = DIAMETER_SUCCESS;
+  subscription_data_p->subscriber_status = SS_SERVICE_GRANTED;
+  subscription_data_p->msisdn_length = snprintf (subscription_data_p->msisdn, sizeof (subscription_data_p->msisdn), "33611111111");
+  subscription_data_p->access_mode = NAM_ONLY_PACKET;
+  subscription_data_p->subscribed_ambr.br_ul = 50000000;
+  subscription_data_p->subscribed_ambr.br_dl = 100000000;
+  subscription_data_p->rau_tau_timer = 120;
+  subscription_data_p->apn_config_profile.context_identifier = 1;
+  subscription_data_p->apn_config_profile.all_apn_conf_ind = ALL_APN_CONFIGURATIONS_INCLUDED;
+  subscription_data_p->apn_config_profile.nb_apns = 1;
+  apn_p->context_identifier = 1;
+  apn_p->pdn_type = IPv4;
+  apn_p->service_selection_length = snprintf (apn_p->service_selection, sizeof (apn_p->service_selection), "oai.ipv4");
+  apn_p->subscribed_qos.qci = QCI_9;
+  apn_p->subscribed_qos.allocation_retention_priority.priority_level = 15;
+  apn_p->subscribed_qos.allocation_retention_priority.pre_emp_capability = PRE_EMPTION_CAPABILITY_DISABLED;
+  apn_p->subscribed_qos.allocation_retention_priority.pre_emp_vulnerability = PRE_EMPTION_VULNERABILITY_ENABLED;
+  apn_p->ambr.br_ul = 50000000;
+  apn_p->ambr.br_dl = 100000000;
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void hss_handle_message (MessageDef * received_message_p)
+{
+  int                       rc = 0;
+
+  switch (ITTI_MSG_ID (received_message_p)) {
+  case S6A_AUTH_INFO_REQ:
+    hss_handle_auth_info_req (&received_message_p->ittiMsg.s6a_auth_info_req);
+    break;
+
+  case S6A_UPDATE_LOCATION_REQ:
+    hss_handle_update_location_req (&received_message_p->ittiMsg.s6a_update_location_req);
+    break;
+
+  case TERMINATE_MESSAGE:
+    itti_exit_task ();
+    break;
+
+  default:
+    break;
+  }
+  rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+  AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+}
+
+//------------------------------------------------------------------------------
+static void *hss_task (__attribute__ ((unused)) void *args_p)
+{
+  MessageDef               *received_message_p = NULL;
+
+  itti_mark_task_ready (TASK_S6A);
+  while (1) {
+    itti_receive_msg (TASK_S6A, &received_message_p);
+    hss_handle_message (received_message_p);
+  }
+  return NULL;
+}
+
+//==============================================================================
+// S+P-GW as TASK_SPGW_APP, S11 TEID of a UE is its index + 1
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void sgw_attach_completed (const uint32_t ue_index, const uint64_t received_ns)
+{
+  MessageDef                         *message_p = itti_alloc_new_message_sized (TASK_SPGW_APP, MESSAGE_TEST, sizeof (attach_completed_t));
+  attach_completed_t                 *completed_p = ATTACH_COMPLETED (message_p);
+
+  completed_p->ue_index = ue_index;
+  completed_p->modify_bearer_ns = received_ns;
+  itti_send_msg_to_task (TASK_SCTP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void sgw_handle_create_session_request (const itti_s11_create_session_request_t * const csr_p)
+{
+  MessageDef                         *message_p = itti_alloc_new_message (TASK_SPGW_APP, S11_CREATE_SESSION_RESPONSE);
+  itti_s11_create_session_response_t *csr_rsp_p = &message_p->ittiMsg.s11_create_session_response;
+  bearer_context_created_t           *bearer_p = &csr_rsp_p->bearer_contexts_created.bearer_contexts[0];
+  uint32_t                            ue_index = strtoul ((const char *)&csr_p->imsi.digit[g_run.imsi_prefix_length], NULL, 10) - 1;
+
+  csr_rsp_p->teid = csr_p->sender_fteid_for_cp.teid;
+  csr_rsp_p->cause = REQUEST_ACCEPTED;
+  csr_rsp_p->s11_sgw_teid.interface_type = S11_SGW_GTP_C;
+  csr_rsp_p->s11_sgw_teid.teid = ue_index + 1;
+  csr_rsp_p->paa.pdn_type = IPv4;
+  csr_rsp_p->paa.ipv4_address[0] = 172;
+  csr_rsp_p->paa.ipv4_address[1] = 16 + ((ue_index >> 16) & 0x0f);
+  csr_rsp_p->paa.ipv4_address[2] = (ue_index >> 8) & 0xff;
+  csr_rsp_p->paa.ipv4_address[3] = ue_index & 0xff;
+  csr_rsp_p->bearer_contexts_created.num_bearer_context = 1;
+  bearer_p->eps_bearer_id = csr_p->bearer_contexts_to_be_created.bearer_contexts[0].eps_bearer_id;
+  bearer_p->cause = REQUEST_ACCEPTED;
+  bearer_p->s1u_sgw_fteid.interface_type = S1_U_SGW_GTP_U;
+  bearer_p->s1u_sgw_fteid.ipv4 = 1;
+  bearer_p->s1u_sgw_fteid.ipv4_address = htonl (ATTACH_BENCHMARK_SGW_S1U_ADDRESS);
+  bearer_p->s1u_sgw_fteid.teid = ue_index + 1;
+  bearer_p->bearer_level_qos = NULL;
+  csr_rsp_p->trxn = csr_p->trxn;
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void sgw_handle_modify_bearer_request (const itti_s11_modify_bearer_request_t * const mbr_p, const uint64_t received_ns)
+{
+  MessageDef                         *message_p = itti_alloc_new_message (TASK_SPGW_APP, S11_MODIFY_BEARER_RESPONSE);
+  itti_s11_modify_bearer_response_t  *mbr_rsp_p = &message_p->ittiMsg.s11_modify_bearer_response;
+
+  mbr_rsp_p->teid = mbr_p->local_teid;
+  mbr_rsp_p->cause = REQUEST_ACCEPTED;
+  mbr_rsp_p->bearer_contexts_modified.bearer_contexts[0].eps_bearer_id = mbr_p->bearer_contexts_to_be_modified.bearer_contexts[0].eps_bearer_id;
+  mbr_rsp_p->bearer_contexts_modified.bearer_contexts[0].cause = REQUEST_ACCEPTED;
+  mbr_rsp_p->bearer_contexts_modified.num_bearer_context = 1;
+  mbr_rsp_p->trxn = mbr_p->trxn;
+  itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+  sgw_attach_completed (mbr_p->teid - 1, received_ns);
+}
+
+//------------------------------------------------------------------------------
+// GTPv2-C IE, 3GPP TS 29.274 8.2
+static size_t sgw_gtp_put_ie (uint8_t * const ie, const uint8_t type, const uint8_t instance, const uint8_t * const value, const uint16_t length)
+{
+  ie[0] = type;
+  ie[1] = length >> 8;
+  ie[2] = length & 0xff;
+  ie[3] = instance & 0x0f;
+  memcpy (&ie[4], value, length);
+  return length + 4;
+}
+
+//------------------------------------------------------------------------------
+static size_t sgw_gtp_put_fteid (uint8_t * const ie, const uint8_t instance, const uint8_t interface_type, const uint32_t teid, const uint32_t ipv4_nbo)
+{
+  uint8_t                   value[9] = {0};
+
+  value[0] = 0x80 | interface_type;      /* IPv4 only */
+  value[1] = teid >> 24;
+  value[2] = teid >> 16;
+  value[3] = teid >> 8;
+  value[4] = teid;
+  memcpy (&value[5], &ipv4_nbo, sizeof (ipv4_nbo));
+  return sgw_gtp_put_ie (ie, NW_GTPV2C_IE_FTEID, instance, value, sizeof (value));
+}
+
+//------------------------------------------------------------------------------
+// GTPv2-C header with TEID, 3GPP TS 29.274 5.1, then the message is sent back to the MME
+static void sgw_gtp_send (uint8_t * const msg, const size_t length, const uint8_t type, const uint32_t teid,
+    const uint8_t * const sequence, const struct sockaddr_in * const peer_p)
+{
+  msg[0] = 0x48;                         /* version 2, TEID present */
+  msg[1] = type;
+  msg[2] = (length - 4) >> 8;
+  msg[3] = (length - 4) & 0xff;
+  msg[4] = teid >> 24;
+  msg[5] = teid >> 16;
+  msg[6] = teid >> 8;
+  msg[7] = teid;
+  memcpy (&msg[8], sequence, 3);
+  msg[11] = 0;
+  AssertFatal (sendto (g_run.sgw_sd, msg, length, 0, (const struct sockaddr *)peer_p, sizeof (*peer_p)) == (ssize_t)length,
+      "GTPv2-C send failed: %s", strerror (errno));
+}
+
+//------------------------------------------------------------------------------
+// Create Session Request as encoded by the S11 task of the MME: IMSI, Sender F-TEID and the bearer context are read
+static void sgw_gtp_handle_create_session_request (const uint8_t * const msg, const size_t length, const struct sockaddr_in * const peer_p)
+{
+  uint8_t                   rsp[ATTACH_BENCHMARK_GTPV2C_MAX_LENGTH] = {0};
+  uint8_t                   bearer[64] = {0};
+  uint8_t                   value[5] = {0};
+  char                      imsi[IMSI_BCD_DIGITS_MAX + 1] = {0};
+  uint32_t                  mme_teid = 0;
+  uint32_t                  ue_index = 0;
+  uint8_t                   ebi = 0;
+  size_t                    offset = NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE;
+  size_t                    rsp_length = NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE;
+  size_t                    bearer_length = 0;
+  size_t                    i = 0;
+  size_t                    j = 0;
+
+  while (offset + 4 <= length) {
+    const uint8_t  *ie = &msg[offset];
+    const uint16_t  ie_length = (ie[1] << 8) | ie[2];
+
+    if (offset + 4 + ie_length > length) {
+      break;
+    }
+    if (NW_GTPV2C_IE_IMSI == ie[0]) {
+      for (i = 0, j = 0; (i < ie_length) && (j < IMSI_BCD_DIGITS_MAX); i++) {
+        imsi[j++] = '0' + (ie[4 + i] & 0x0f);
+        if (((ie[4 + i] >> 4) != 0x0f) && (j < IMSI_BCD_DIGITS_MAX)) {
+          imsi[j++] = '0' + (ie[4 + i] >> 4);
+        }
+      }
+    } else if ((NW_GTPV2C_IE_FTEID == ie[0]) && (0 == (ie[3] & 0x0f))) {
+      mme_teid = ((uint32_t)ie[5] << 24) | ((uint32_t)ie[6] << 16) | ((uint32_t)ie[7] << 8) | ie[8];
+    } else if (NW_GTPV2C_IE_BEARER_CONTEXT == ie[0]) {
+      for (i = 0; i + 4 < ie_length; i += 4 + ((ie[4 + i + 1] << 8) | ie[4 + i + 2])) {
+        if (NW_GTPV2C_IE_EBI == ie[4 + i]) {
+          ebi = ie[4 + i + 4] & 0x0f;
+        }
+      }
+    }
+    offset += 4 + ie_length;
+  }
+  ue_index = strtoul (&imsi[g_run.imsi_prefix_length], NULL, 10) - 1;
+  AssertFatal (ue_index < g_run.num_ues, "Create Session Request of unknown IMSI %s", imsi);
+  g_run.mme_s11_teids[ue_index] = mme_teid;
+
+  value[0] = REQUEST_ACCEPTED;
+  rsp_length += sgw_gtp_put_ie (&rsp[rsp_length], NW_GTPV2C_IE_CAUSE, 0, value, 2);
+  rsp_length += sgw_gtp_put_fteid (&rsp[rsp_length], 0, S11_SGW_GTP_C, ue_index + 1, mme_config.ipv4.sgw_s11);
+  value[0] = 0x01;                       /* IPv4 */
+  value[1] = 172;
+  value[2] = 16 + ((ue_index >> 16) & 0x0f);
+  value[3] = (ue_index >> 8) & 0xff;
+  value[4] = ue_index & 0xff;
+  rsp_length += sgw_gtp_put_ie (&rsp[rsp_length], NW_GTPV2C_IE_PAA, 0, value, 5);
+  value[0] = ebi;
+  bearer_length += sgw_gtp_put_ie (&bearer[bearer_length], NW_GTPV2C_IE_EBI, 0, value, 1);
+  value[0] = REQUEST_ACCEPTED;
+  bearer_length += sgw_gtp_put_ie (&bearer[bearer_length], NW_GTPV2C_IE_CAUSE, 0, value, 2);
+  bearer_length += sgw_gtp_put_fteid (&bearer[bearer_length], 0, S1_U_SGW_GTP_U, ue_index + 1, htonl (ATTACH_BENCHMARK_SGW_S1U_ADDRESS));
+  rsp_length += sgw_gtp_put_ie (&rsp[rsp_length], NW_GTPV2C_IE_BEARER_CONTEXT, 0, bearer, bearer_length);
+  sgw_gtp_send (rsp, rsp_length, NW_GTP_CREATE_SESSION_RSP, mme_teid, &msg[8], peer_p);
+}
+
+//------------------------------------------------------------------------------
+static void sgw_gtp_handle_modify_bearer_request (const uint32_t teid, const uint8_t * const sequence, const struct sockaddr_in * const peer_p,
+    const uint64_t received_ns)
+{
+  uint8_t                   rsp[NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE + 6] = {0};
+  uint8_t                   cause[2] = {REQUEST_ACCEPTED, 0};
+  uint32_t                  ue_index = teid - 1;
+
+  AssertFatal (ue_index < g_run.num_ues, "Modify Bearer Request of unknown S11 S-GW TEID %u", teid);
+  sgw_gtp_put_ie (&rsp[NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE], NW_GTPV2C_IE_CAUSE, 0, cause, sizeof (cause));
+  sgw_gtp_send (rsp, sizeof (rsp), NW_GTP_MODIFY_BEARER_RSP, g_run.mme_s11_teids[ue_index], sequence, peer_p);
+  sgw_attach_completed (ue_index, received_ns);
+}
+
+//------------------------------------------------------------------------------
+// GTPv2-C requests pending on the S11 socket, only the ones of an attach are answered
+static void sgw_gtp_flush (void)
+{
+  uint8_t                   msg[ATTACH_BENCHMARK_GTPV2C_MAX_LENGTH];
+  struct sockaddr_in        peer = {0};
+  socklen_t                 peer_length = sizeof (peer);
+  ssize_t                   length = 0;
+
+  while ((length = recvfrom (g_run.sgw_sd, msg, sizeof (msg), MSG_DONTWAIT, (struct sockaddr *)&peer, &peer_length)) > 0) {
+    if ((NW_GTPV2C_EPC_SPECIFIC_HEADER_SIZE <= length) && (0x48 == (msg[0] & 0xe8))) {
+      switch (msg[1]) {
+      case NW_GTP_CREATE_SESSION_REQ:
+        sgw_gtp_handle_create_session_request (msg, length, &peer);
+        break;
+
+      case NW_GTP_MODIFY_BEARER_REQ:
+        sgw_gtp_handle_modify_bearer_request (((uint32_t)msg[4] << 24) | ((uint32_t)msg[5] << 16) | ((uint32_t)msg[6] << 8) | msg[7],
+            &msg[8], &peer, now_ns ());
+        break;
+
+      default:
+        break;
+      }
+    }
+    peer_length = sizeof (peer);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int sgw_gtp_open (void)
+{
+  struct sockaddr_in        addr = {0};
+  int                       sd = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+  AssertFatal (0 <= sd, "GTPv2-C socket failed: %s", strerror (errno));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (ATTACH_BENCHMARK_GTPV2C_PORT);
+  addr.sin_addr.s_addr = mme_config.ipv4.sgw_s11;
+  AssertFatal (0 == bind (sd, (struct sockaddr *)&addr, sizeof (addr)), "GTPv2-C bind to the S-GW S11 address failed: %s", strerror (errno));
+  return sd;
+}
+
+//------------------------------------------------------------------------------
+static void *sgw_task (__attribute__ ((unused)) void *args_p)
+{
+  MessageDef               *received_message_p = NULL;
+  MessageDef               *message_p = NULL;
+  struct epoll_event       *events = NULL;
+  int                       nb_events = 0;
+  int                       rc = 0;
+  int                       i = 0;
+
+  itti_mark_task_ready (TASK_SPGW_APP);
+  if (ATTACH_S11_GTP == g_run.s11_mode) {
+    itti_subscribe_event_fd (TASK_SPGW_APP, g_run.sgw_sd);
+  }
+  while (1) {
+    itti_receive_msg (TASK_SPGW_APP, &received_message_p);
+    if (received_message_p != NULL) {
+      switch (ITTI_MSG_ID (received_message_p)) {
+      case S11_CREATE_SESSION_REQUEST:
+        sgw_handle_create_session_request (&received_message_p->ittiMsg.s11_create_session_request);
+        break;
+
+      case S11_MODIFY_BEARER_REQUEST:
+        sgw_handle_modify_bearer_request (&received_message_p->ittiMsg.s11_modify_bearer_request, now_ns ());
+        break;
+
+      case S11_RELEASE_ACCESS_BEARERS_REQUEST:
+        message_p = itti_alloc_new_message (TASK_SPGW_APP, S11_RELEASE_ACCESS_BEARERS_RESPONSE);
+        message_p->ittiMsg.s11_release_access_bearers_response.teid = received_message_p->ittiMsg.s11_release_access_bearers_request.local_teid;
+        message_p->ittiMsg.s11_release_access_bearers_response.cause = REQUEST_ACCEPTED;
+        itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+        break;
+
+      case S11_DELETE_SESSION_REQUEST:
+        message_p = itti_alloc_new_message (TASK_SPGW_APP, S11_DELETE_SESSION_RESPONSE);
+        message_p->ittiMsg.s11_delete_session_response.teid = received_message_p->ittiMsg.s11_delete_session_request.local_teid;
+        message_p->ittiMsg.s11_delete_session_response.cause = REQUEST_ACCEPTED;
+        itti_send_msg_to_task (TASK_MME_APP, INSTANCE_DEFAULT, message_p);
+        break;
+
+      case TERMINATE_MESSAGE:
+        itti_exit_task ();
+        break;
+
+      default:
+        break;
+      }
+      rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+      AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+      received_message_p = NULL;
+    }
+
+    nb_events = itti_get_events (TASK_SPGW_APP, &events);
+    for (i = 0; (i < nb_events) && (events != NULL); i++) {
+      if ((events[i].data.fd == g_run.sgw_sd) && (events[i].events & EPOLLIN)) {
+        sgw_gtp_flush ();
+      }
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  char                     *config_argv[] = {argv[0], "-c", NULL, NULL};
+  cpu_set_t                 cpu_set;
+  uint8_t                   mnc_length = 0;
+  uint32_t                  i = 0;
+  int                       p = 0;
+  int                       c = 0;
+
+  g_run.num_ues = ATTACH_BENCHMARK_DEFAULT_UES;
+  g_run.window  = ATTACH_BENCHMARK_DEFAULT_WINDOW;
+  g_run.sgw_sd  = -1;
+  while ((c = getopt (argc, argv, "c:n:w:s:r:C:o:")) != -1) {
+    switch (c) {
+    case 'c':
+      config_argv[2] = optarg;
+      break;
+    case 'n':
+      g_run.num_ues = strtoul (optarg, NULL, 0);
+      break;
+    case 'w':
+      g_run.window = strtoul (optarg, NULL, 0);
+      break;
+    case 's':
+      for (g_run.s11_mode = 0; (g_run.s11_mode < ATTACH_S11_MAX) && strcmp (optarg, s11mode2str[g_run.s11_mode]); g_run.s11_mode++);
+      break;
+    case 'r':
+      g_run.shards = strtoul (optarg, NULL, 0);
+      break;
+    case 'C':
+      g_run.cores = strtoul (optarg, NULL, 0);
+      break;
+    case 'o':
+      g_run.output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s -c /path/to/mme.conf [-n UEs] [-w window] [-s itti|gtp] [-r shards] [-C cores] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if (ATTACH_S11_MAX <= g_run.s11_mode) {
+    fprintf (stderr, "Invalid S11 mode, itti or gtp\n");
+    return -1;
+  }
+  if ((NULL == config_argv[2]) || (0 == g_run.num_ues) || (0 == g_run.window)) {
+    fprintf (stderr, "Missing configuration file, or invalid number of UEs or window\n");
+    return -1;
+  }
+  if (g_run.cores) {
+    // the threads of the tasks inherit the CPUs of the main thread
+    CPU_ZERO (&cpu_set);
+    for (i = 0; i < g_run.cores; i++) {
+      CPU_SET (i, &cpu_set);
+    }
+    if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set)) {
+      fprintf (stderr, "Could not pin the benchmark on CPUs 0 to %u\n", g_run.cores - 1);
+      return -1;
+    }
+  }
+
+  CHECK_INIT_RETURN (oai_clock_init (OAI_CLOCK_TICK_US));
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  optind = 1;
+  CHECK_INIT_RETURN (mme_config_parse_opt_line (3, config_argv, &mme_config));
+  AssertFatal (0 < mme_config.served_tai.nb_tai, "No served TAI in the configuration file");
+  if (ATTACH_S11_ITTI == g_run.s11_mode) {
+    // as SGW_IPV4_ADDRESS_FOR_S11 = "none", MME_APP sends its S11 requests to TASK_SPGW_APP
+    mme_config.ipv4.sgw_s11 = 0;
+  } else {
+    AssertFatal (0 != mme_config.ipv4.sgw_s11, "No S-GW S11 address in the configuration file");
+    g_run.sgw_sd = sgw_gtp_open ();
+  }
+
+  // UEs, IMSI is MCC MNC of the first served TAI then the index of the UE + 1
+  mnc_length = mme_config.served_tai.plmn_mnc_len[0];
+  g_run.imsi_prefix_length = 3 + mnc_length;
+  g_run.ues = calloc (g_run.num_ues, sizeof (attach_ue_t));
+  AssertFatal (NULL != g_run.ues, "Allocation of UEs failed");
+  for (i = 0; i < g_run.num_ues; i++) {
+    snprintf (g_run.ues[i].imsi, sizeof (g_run.ues[i].imsi), "%03u%0*u%0*u", mme_config.served_tai.plmn_mcc[0],
+        mnc_length, mme_config.served_tai.plmn_mnc[0], 15 - g_run.imsi_prefix_length, i + 1);
+  }
+  for (p = 0; p < ATTACH_PHASE_MAX; p++) {
+    g_run.latencies_ns[p] = calloc (g_run.num_ues, sizeof (uint64_t));
+    AssertFatal (NULL != g_run.latencies_ns[p], "Allocation of latencies failed");
+  }
+  g_run.mme_s11_teids = calloc (g_run.num_ues, sizeof (uint32_t));
+  AssertFatal (NULL != g_run.mme_s11_teids, "Allocation of S11 TEIDs failed");
+  derive_key_nas (NAS_INT_ALG, NAS_SECURITY_ALGORITHMS_EIA2, vector_kasme, g_run.knas_int);
+
+  CHECK_INIT_RETURN (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+#if ENABLE_ITTI_ANALYZER
+          messages_definition_xml,
+#else
+          NULL,
+#endif
+          NULL));
+  MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
+  mme_app_set_task_shards (g_run.shards);
+  // stubs first, TASK_S1AP sends SCTP_INIT_MSG at its start, the HSS runs in the shard of TASK_S6A
+  CHECK_INIT_RETURN (itti_create_task (TASK_SCTP, enb_task, NULL));
+  CHECK_INIT_RETURN (itti_create_task_handler (TASK_S6A, hss_task, hss_handle_message, NULL));
+  CHECK_INIT_RETURN (itti_create_task (TASK_SPGW_APP, sgw_task, NULL));
+  if (ATTACH_S11_GTP == g_run.s11_mode) {
+    CHECK_INIT_RETURN (udp_init ());
+    CHECK_INIT_RETURN (s11_mme_init (&mme_config));
+  }
+  CHECK_INIT_RETURN (nas_init (&mme_config));
+  CHECK_INIT_RETURN (s1ap_mme_init ());
+  CHECK_INIT_RETURN (mme_app_init (&mme_config));
+  itti_wait_tasks_end ();
+
+  for (p = 0; p < ATTACH_PHASE_MAX; p++) {
+    free (g_run.latencies_ns[p]);
+  }
+  free (g_run.mme_s11_teids);
+  free (g_run.ues);
+  if (0 <= g_run.sgw_sd) {
+    close (g_run.sgw_sd);
+  }
+  OAILOG_EXIT ();
+  return g_run.exit_status;
+}
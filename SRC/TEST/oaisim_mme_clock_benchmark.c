@@ -0,0 +1,194 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_clock_benchmark.c
+   \brief Cost in ns of one time stamp, for each clock read by the MME, on 1 to N threads reading concurrently.
+   "syscall" forces the clock_gettime() system call, it is the cost of the other kernel clocks when the clock source of
+   the kernel has no vDSO support (clock source printed first).
+   Usage: oaisim_mme_clock_benchmark [-n iterations] [-t max threads]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/syscall.h>
+
+#include "oai_clock.h"
+
+#define CLOCK_BENCHMARK_DEFAULT_ITERATIONS  10000000
+#define CLOCK_BENCHMARK_DEFAULT_THREADS            4
+#define CLOCK_BENCHMARK_CLOCKSOURCE  "/sys/devices/system/clocksource/clocksource0/current_clocksource"
+
+typedef uint64_t (*clock_benchmark_read_t) (void);
+
+typedef struct clock_benchmark_mode_s {
+  const char                 *name;
+  clock_benchmark_read_t      read;
+} clock_benchmark_mode_t;
+
+typedef struct clock_benchmark_thread_s {
+  pthread_t                   tid;
+  clock_benchmark_read_t      read;
+  uint64_t                    iterations;
+  uint64_t                    elapsed_ns;
+  uint64_t                    sum;          // keeps the reads
+} clock_benchmark_thread_t;
+
+//------------------------------------------------------------------------------
+static uint64_t read_gettimeofday (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t read_monotonic (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t read_monotonic_coarse (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC_COARSE, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t read_syscall (void)
+{
+  struct timespec ts;
+
+  syscall (SYS_clock_gettime, CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static const clock_benchmark_mode_t     modes[] = {
+  {"gettimeofday",     read_gettimeofday},
+  {"monotonic",        read_monotonic},
+  {"monotonic-coarse", read_monotonic_coarse},
+  {"syscall",          read_syscall},
+  {"oai-coarse",       oai_clock_coarse_ns},
+  {"oai-precise",      oai_clock_precise_ns},
+};
+
+//------------------------------------------------------------------------------
+static void *reader_thread (void *args_p)
+{
+  clock_benchmark_thread_t               *thread = (clock_benchmark_thread_t *) args_p;
+  uint64_t                                start = 0;
+  uint64_t                                i = 0;
+
+  start = read_monotonic ();
+  for (i = 0; i < thread->iterations; i++) {
+    thread->sum += thread->read ();
+  }
+  thread->elapsed_ns = read_monotonic () - start;
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  clock_benchmark_thread_t               *threads = NULL;
+  oai_clock_stats_t                       stats = {0};
+  uint64_t                                iterations = CLOCK_BENCHMARK_DEFAULT_ITERATIONS;
+  uint64_t                                elapsed = 0;
+  uint32_t                                max_threads = CLOCK_BENCHMARK_DEFAULT_THREADS;
+  uint32_t                                n = 0;
+  uint32_t                                t = 0;
+  char                                    clocksource[64] = "unknown";
+  FILE                                   *fp = NULL;
+  int                                     m = 0;
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "n:t:")) != -1) {
+    switch (c) {
+    case 'n':
+      iterations = strtoull (optarg, NULL, 0);
+      break;
+    case 't':
+      max_threads = strtoul (optarg, NULL, 0);
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n iterations] [-t max threads]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((0 == iterations) || (0 == max_threads)) {
+    fprintf (stderr, "Invalid number of iterations or threads\n");
+    return -1;
+  }
+
+  if ((fp = fopen (CLOCK_BENCHMARK_CLOCKSOURCE, "r"))) {
+    if (fgets (clocksource, sizeof (clocksource), fp)) {
+      clocksource[strcspn (clocksource, "\n")] = '\0';
+    }
+    fclose (fp);
+  }
+  if (oai_clock_init (OAI_CLOCK_TICK_US)) {
+    fprintf (stderr, "Could not start the ticker of the coarse clock\n");
+    return -1;
+  }
+  threads = calloc (max_threads, sizeof (clock_benchmark_thread_t));
+
+  fprintf (stdout, "clock source %s, %u us tick, %" PRIu64 " reads per thread\n", clocksource, OAI_CLOCK_TICK_US, iterations);
+  fprintf (stdout, "%-18s %8s %12s\n", "clock", "threads", "ns/call");
+  for (m = 0; m < sizeof (modes) / sizeof (modes[0]); m++) {
+    // 1, 2, 4... threads, then max threads
+    for (n = 1; n <= max_threads; n = ((n < max_threads) && (2 * n > max_threads)) ? max_threads : 2 * n) {
+      elapsed = 0;
+      for (t = 0; t < n; t++) {
+        memset (&threads[t], 0, sizeof (threads[t]));
+        threads[t].read       = modes[m].read;
+        threads[t].iterations = iterations;
+        pthread_create (&threads[t].tid, NULL, reader_thread, &threads[t]);
+      }
+      for (t = 0; t < n; t++) {
+        pthread_join (threads[t].tid, NULL);
+        elapsed += threads[t].elapsed_ns;
+      }
+      // mean over the threads of the time of one read on one thread
+      fprintf (stdout, "%-18s %8u %12.1f\n", modes[m].name, n, (double)elapsed / (double)n / (double)iterations);
+    }
+  }
+  oai_clock_get_stats (&stats);
+  fprintf (stdout, "%" PRIu64 " ticks, %" PRIu64 " coarse reads, %" PRIu64 " precise reads\n", stats.ticks, stats.coarse_reads, stats.precise_reads);
+  oai_clock_exit ();
+  free (threads);
+  return 0;
+}
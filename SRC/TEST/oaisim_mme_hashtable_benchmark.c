@@ -0,0 +1,449 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file oaisim_mme_hashtable_benchmark.c
+   \brief Thread safe hashtables of the MME over the keys of the UE collections, on 1 to N threads.
+   Keys: sequential mme_ue_s1ap_ids, IMSI64s of a batch of SIMs, S11 TEIDs (truncated UE context address as MME_APP
+   allocates them) and GUTIs (M-TMSI from the M-TMSI pool) in an obj_hashtable, all with the default hash functions.
+   Each thread works on its own slice of the keys, reported in ns per operation of all the threads (wall time / operations):
+   - insert: the keys of the slice,
+   - lookup: random keys of the slice,
+   - mixed:  random keys of the slice, 80% lookups and 20% remove + insert (a detach then an attach),
+   - remove: the keys of the slice,
+   and resize, single threaded, in ns per element: the table resized to twice its size then back.
+   The chain lengths are taken on the full table, the lock contention over all the phases.
+   Usage: oaisim_mme_hashtable_benchmark [-n keys] [-s table size] [-t max threads] [-o /path/to/results.json]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "assertions.h"
+#include "log.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_m_tmsi.h"
+#include "hashtable.h"
+#include "obj_hashtable.h"
+
+#define HASHTABLE_BENCHMARK_DEFAULT_KEYS      100000
+#define HASHTABLE_BENCHMARK_DEFAULT_THREADS   4
+#define HASHTABLE_BENCHMARK_FIRST_IMSI64      208950000000001ULL
+#define HASHTABLE_BENCHMARK_MAX_STEPS         34      // numbers of threads from 1 to UINT32_MAX
+
+typedef enum {
+  HASHTABLE_KEYS_MME_UE_S1AP_ID = 0,
+  HASHTABLE_KEYS_IMSI64,
+  HASHTABLE_KEYS_TEID,
+  HASHTABLE_KEYS_GUTI,
+  HASHTABLE_KEYS_MAX
+} hashtable_keys_t;
+
+typedef enum {
+  HASHTABLE_PHASE_INSERT = 0,
+  HASHTABLE_PHASE_LOOKUP,
+  HASHTABLE_PHASE_MIXED,
+  HASHTABLE_PHASE_REMOVE,
+  HASHTABLE_PHASE_MAX
+} hashtable_phase_t;
+
+static const char * const keys2str[HASHTABLE_KEYS_MAX] = {"mme_ue_s1ap_id", "imsi64", "teid", "guti"};
+static const char * const phase2str[HASHTABLE_PHASE_MAX] = {"insert", "lookup", "mixed", "remove"};
+
+typedef struct hashtable_benchmark_thread_s {
+  pthread_t                  tid;
+  hashtable_phase_t          phase;
+  uint64_t                   begin;        // slice of the keys
+  uint64_t                   end;
+  uint64_t                   operations;
+  uint64_t                   rng;
+} hashtable_benchmark_thread_t;
+
+typedef struct hashtable_benchmark_result_s {
+  hashtable_keys_t           keys;
+  uint32_t                   threads;
+  double                     phase_ns[HASHTABLE_PHASE_MAX];  // per operation
+  double                     resize_ns;                      // per element
+  hashtable_stats_t          full;                           // chains of the full table
+  hashtable_stats_t          end;                            // contention and resizes
+} hashtable_benchmark_result_t;
+
+typedef struct hashtable_benchmark_run_s {
+  hashtable_keys_t           keys;
+  uint64_t                   nb_keys;
+  hash_key_t                *int_keys;
+  guti_t                    *guti_keys;
+  hash_table_ts_t           *htbl;
+  obj_hash_table_t          *obj_htbl;
+} hashtable_benchmark_run_t;
+
+static hashtable_benchmark_run_t g_run = {0};
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t xorshift64 (uint64_t * const state)
+{
+  uint64_t                  x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+//------------------------------------------------------------------------------
+// data of a key is its index + 1, never NULL
+static inline void key_insert (const uint64_t i)
+{
+  hashtable_rc_t            rc = HASH_TABLE_OK;
+
+  if (HASHTABLE_KEYS_GUTI == g_run.keys) {
+    rc = obj_hashtable_ts_insert (g_run.obj_htbl, &g_run.guti_keys[i], sizeof (guti_t), (void *)(uintptr_t)(i + 1));
+  } else {
+    rc = hashtable_ts_insert (g_run.htbl, g_run.int_keys[i], (void *)(uintptr_t)(i + 1));
+  }
+  AssertFatal (HASH_TABLE_OK == rc, "Insert of key %" PRIu64 " failed: %s", i, hashtable_rc_code2string (rc));
+}
+
+//------------------------------------------------------------------------------
+static inline void key_lookup (const uint64_t i)
+{
+  hashtable_rc_t            rc = HASH_TABLE_OK;
+  void                     *data = NULL;
+
+  if (HASHTABLE_KEYS_GUTI == g_run.keys) {
+    rc = obj_hashtable_ts_get (g_run.obj_htbl, &g_run.guti_keys[i], sizeof (guti_t), &data);
+  } else {
+    rc = hashtable_ts_get (g_run.htbl, g_run.int_keys[i], &data);
+  }
+  AssertFatal ((HASH_TABLE_OK == rc) && ((uintptr_t)(i + 1) == (uintptr_t)data), "Lookup of key %" PRIu64 " failed: %s", i, hashtable_rc_code2string (rc));
+}
+
+//------------------------------------------------------------------------------
+static inline void key_remove (const uint64_t i)
+{
+  hashtable_rc_t            rc = HASH_TABLE_OK;
+  void                     *data = NULL;
+
+  if (HASHTABLE_KEYS_GUTI == g_run.keys) {
+    rc = obj_hashtable_ts_remove (g_run.obj_htbl, &g_run.guti_keys[i], sizeof (guti_t), &data);
+  } else {
+    rc = hashtable_ts_remove (g_run.htbl, g_run.int_keys[i], &data);
+  }
+  AssertFatal (HASH_TABLE_OK == rc, "Remove of key %" PRIu64 " failed: %s", i, hashtable_rc_code2string (rc));
+}
+
+//------------------------------------------------------------------------------
+static void *worker_thread (void *args_p)
+{
+  hashtable_benchmark_thread_t *thread = (hashtable_benchmark_thread_t *) args_p;
+  const uint64_t            slice = thread->end - thread->begin;
+  uint64_t                  i = 0;
+  uint64_t                  r = 0;
+
+  for (i = thread->begin; i < thread->end; i++) {
+    switch (thread->phase) {
+    case HASHTABLE_PHASE_INSERT:
+      key_insert (i);
+      break;
+    case HASHTABLE_PHASE_LOOKUP:
+      key_lookup (thread->begin + xorshift64 (&thread->rng) % slice);
+      break;
+    case HASHTABLE_PHASE_MIXED:
+      r = xorshift64 (&thread->rng);
+      if (((r >> 32) % 10) < 8) {
+        key_lookup (thread->begin + r % slice);
+      } else {
+        key_remove (thread->begin + r % slice);
+        key_insert (thread->begin + r % slice);
+      }
+      break;
+    case HASHTABLE_PHASE_REMOVE:
+      key_remove (i);
+      break;
+    default:
+      break;
+    }
+  }
+  thread->operations = slice;
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// one phase on nb_threads threads, returns ns per operation of all the threads
+static double run_phase (const hashtable_phase_t phase, hashtable_benchmark_thread_t * const threads, const uint32_t nb_threads)
+{
+  uint64_t                  start = 0;
+  uint64_t                  operations = 0;
+  uint32_t                  t = 0;
+
+  start = now_ns ();
+  for (t = 0; t < nb_threads; t++) {
+    threads[t].phase      = phase;
+    threads[t].begin      = (g_run.nb_keys * t) / nb_threads;
+    threads[t].end        = (g_run.nb_keys * (t + 1)) / nb_threads;
+    threads[t].operations = 0;
+    threads[t].rng        = 0x9E3779B97F4A7C15ULL * (t + 1);
+    pthread_create (&threads[t].tid, NULL, worker_thread, &threads[t]);
+  }
+  for (t = 0; t < nb_threads; t++) {
+    pthread_join (threads[t].tid, NULL);
+    operations += threads[t].operations;
+  }
+  return (double)(now_ns () - start) / (double)operations;
+}
+
+//------------------------------------------------------------------------------
+static void get_stats (hashtable_stats_t * const stats)
+{
+  if (HASHTABLE_KEYS_GUTI == g_run.keys) {
+    obj_hashtable_ts_get_stats (g_run.obj_htbl, stats);
+  } else {
+    hashtable_ts_get_stats (g_run.htbl, stats);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void measure (const hashtable_keys_t keys, const hash_size_t table_size, const uint32_t nb_threads, hashtable_benchmark_result_t * const result)
+{
+  hashtable_benchmark_thread_t *threads = calloc (nb_threads, sizeof (hashtable_benchmark_thread_t));
+  bstring                   name = bformat ("benchmark_%s_htbl", keys2str[keys]);
+  hash_size_t               size = 0;
+  uint64_t                  start = 0;
+
+  AssertFatal (NULL != threads, "Out of memory");
+  memset (result, 0, sizeof (*result));
+  result->keys    = keys;
+  result->threads = nb_threads;
+  g_run.keys = keys;
+  if (HASHTABLE_KEYS_GUTI == keys) {
+    g_run.obj_htbl = obj_hashtable_ts_create (table_size, NULL, NULL, hash_free_int_func, name);
+    AssertFatal (NULL != g_run.obj_htbl, "Could not create the obj_hashtable");
+    size = g_run.obj_htbl->size;
+  } else {
+    g_run.htbl = hashtable_ts_create (table_size, NULL, hash_free_int_func, name);
+    AssertFatal (NULL != g_run.htbl, "Could not create the hashtable");
+    size = g_run.htbl->size;
+  }
+
+  result->phase_ns[HASHTABLE_PHASE_INSERT] = run_phase (HASHTABLE_PHASE_INSERT, threads, nb_threads);
+  get_stats (&result->full);
+  result->phase_ns[HASHTABLE_PHASE_LOOKUP] = run_phase (HASHTABLE_PHASE_LOOKUP, threads, nb_threads);
+  start = now_ns ();
+  if (HASHTABLE_KEYS_GUTI == keys) {
+    AssertFatal (HASH_TABLE_OK == obj_hashtable_ts_resize (g_run.obj_htbl, 2 * size), "Resize failed");
+    AssertFatal (HASH_TABLE_OK == obj_hashtable_ts_resize (g_run.obj_htbl, size), "Resize failed");
+  } else {
+    AssertFatal (HASH_TABLE_OK == hashtable_ts_resize (g_run.htbl, 2 * size), "Resize failed");
+    AssertFatal (HASH_TABLE_OK == hashtable_ts_resize (g_run.htbl, size), "Resize failed");
+  }
+  result->resize_ns = (double)(now_ns () - start) / (double)(2 * g_run.nb_keys);
+  result->phase_ns[HASHTABLE_PHASE_MIXED]  = run_phase (HASHTABLE_PHASE_MIXED, threads, nb_threads);
+  result->phase_ns[HASHTABLE_PHASE_REMOVE] = run_phase (HASHTABLE_PHASE_REMOVE, threads, nb_threads);
+  get_stats (&result->end);
+  AssertFatal (0 == result->end.num_elements, "%zu keys left after the remove phase", result->end.num_elements);
+
+  if (HASHTABLE_KEYS_GUTI == keys) {
+    obj_hashtable_ts_destroy (g_run.obj_htbl);
+    g_run.obj_htbl = NULL;
+  } else {
+    hashtable_ts_destroy (g_run.htbl);
+    g_run.htbl = NULL;
+  }
+  bdestroy (name);
+  free (threads);
+}
+
+//------------------------------------------------------------------------------
+static void generate_keys (const hashtable_keys_t keys, void ** const contexts)
+{
+  uint64_t                  i = 0;
+
+  for (i = 0; i < g_run.nb_keys; i++) {
+    switch (keys) {
+    case HASHTABLE_KEYS_MME_UE_S1AP_ID:
+      g_run.int_keys[i] = (mme_ue_s1ap_id_t)(i + 1);
+      break;
+    case HASHTABLE_KEYS_IMSI64:
+      g_run.int_keys[i] = HASHTABLE_BENCHMARK_FIRST_IMSI64 + i;
+      break;
+    case HASHTABLE_KEYS_TEID:
+      // as mme_app_send_s11_create_session_req
+      g_run.int_keys[i] = (teid_t)(uintptr_t)contexts[i];
+      break;
+    case HASHTABLE_KEYS_GUTI:
+      // padding included in the key, as the GUTIs of the UE contexts
+      memset (&g_run.guti_keys[i], 0, sizeof (guti_t));
+      g_run.guti_keys[i].gummei.plmn.mcc_digit1 = 2;
+      g_run.guti_keys[i].gummei.plmn.mcc_digit2 = 0;
+      g_run.guti_keys[i].gummei.plmn.mcc_digit3 = 8;
+      g_run.guti_keys[i].gummei.plmn.mnc_digit1 = 9;
+      g_run.guti_keys[i].gummei.plmn.mnc_digit2 = 5;
+      g_run.guti_keys[i].gummei.plmn.mnc_digit3 = 0xF;
+      g_run.guti_keys[i].gummei.mme_gid         = MMEGID;
+      g_run.guti_keys[i].gummei.mme_code        = MMEC;
+      g_run.guti_keys[i].m_tmsi                 = mme_app_m_tmsi_allocate (contexts[i]);
+      AssertFatal (INVALID_M_TMSI != g_run.guti_keys[i].m_tmsi, "M-TMSI pool exhausted");
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  hashtable_benchmark_result_t *results = NULL;
+  void                    **contexts = NULL;
+  uint64_t                  nb_keys = HASHTABLE_BENCHMARK_DEFAULT_KEYS;
+  uint64_t                  table_size = 0;
+  uint32_t                  max_threads = HASHTABLE_BENCHMARK_DEFAULT_THREADS;
+  uint32_t                  nb_results = 0;
+  uint32_t                  n = 0;
+  uint64_t                  i = 0;
+  const char               *output = NULL;
+  FILE                     *json = NULL;
+  int                       k = 0;
+  int                       p = 0;
+  int                       c = 0;
+
+  while ((c = getopt (argc, argv, "n:s:t:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      nb_keys = strtoull (optarg, NULL, 0);
+      break;
+    case 's':
+      table_size = strtoull (optarg, NULL, 0);
+      break;
+    case 't':
+      max_threads = strtoul (optarg, NULL, 0);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n keys] [-s table size] [-t max threads] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((0 == nb_keys) || (UINT32_MAX < nb_keys) || (0 == max_threads) || (nb_keys < max_threads)) {
+    fprintf (stderr, "Invalid number of keys or threads\n");
+    return -1;
+  }
+  // as the UE collections, sized by max_ues
+  if (0 == table_size) {
+    table_size = nb_keys;
+  }
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  CHECK_INIT_RETURN (mme_app_m_tmsi_pool_init ((uint32_t)nb_keys, M_TMSI_PREFIX, M_TMSI_PREFIX_BITS));
+
+  g_run.nb_keys   = nb_keys;
+  g_run.int_keys  = calloc (nb_keys, sizeof (hash_key_t));
+  g_run.guti_keys = calloc (nb_keys, sizeof (guti_t));
+  contexts        = calloc (nb_keys, sizeof (void *));
+  results         = calloc (HASHTABLE_KEYS_MAX * HASHTABLE_BENCHMARK_MAX_STEPS, sizeof (hashtable_benchmark_result_t));
+  AssertFatal ((NULL != g_run.int_keys) && (NULL != g_run.guti_keys) && (NULL != contexts) && (NULL != results), "Out of memory");
+  for (i = 0; i < nb_keys; i++) {
+    contexts[i] = calloc (1, sizeof (ue_context_t));
+    AssertFatal (NULL != contexts[i], "Out of memory");
+  }
+
+  for (k = 0; k < HASHTABLE_KEYS_MAX; k++) {
+    generate_keys (k, contexts);
+    // 1, 2, 4... threads, then max threads
+    for (n = 1; n <= max_threads; n = ((n < max_threads) && (2 * n > max_threads)) ? max_threads : 2 * n) {
+      measure (k, table_size, n, &results[nb_results++]);
+    }
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    if (NULL == json) {
+      fprintf (stderr, "Could not open %s\n", output);
+      return -1;
+    }
+    fprintf (json, "{\"benchmark\": \"hashtable\", \"keys\": %" PRIu64 ", \"table_size\": %zu, \"results\": [\n", nb_keys, results[0].full.size);
+  }
+  fprintf (stdout, "%" PRIu64 " keys, table of %zu buckets, ns per operation\n", nb_keys, results[0].full.size);
+  fprintf (stdout, "%-15s %7s %8s %8s %8s %8s %8s %9s %-40s %12s %10s\n", "keys", "threads", "insert", "lookup", "mixed", "remove", "resize",
+      "max chain", "buckets by chain length 0..7+", "contentions", "wait us");
+  for (i = 0; i < nb_results; i++) {
+    const hashtable_benchmark_result_t *r = &results[i];
+    char                    chains[128];
+    int                     len = 0;
+
+    for (p = 0; p < HASH_TABLE_STATS_CHAIN_LENGTHS; p++) {
+      len += snprintf (&chains[len], sizeof (chains) - len, "%s%zu", (p) ? "/" : "", r->full.chains[p]);
+    }
+    fprintf (stdout, "%-15s %7u %8.1f %8.1f %8.1f %8.1f %8.1f %9zu %-40s %12" PRIu64 " %10.1f\n", keys2str[r->keys], r->threads,
+        r->phase_ns[HASHTABLE_PHASE_INSERT], r->phase_ns[HASHTABLE_PHASE_LOOKUP], r->phase_ns[HASHTABLE_PHASE_MIXED], r->phase_ns[HASHTABLE_PHASE_REMOVE],
+        r->resize_ns, r->full.max_chain, chains, r->end.lock_contentions, (double)r->end.lock_wait_ns / 1e3);
+    if (json) {
+      fprintf (json, "%s  {\"keys\": \"%s\", \"threads\": %u", (i) ? ",\n" : "", keys2str[r->keys], r->threads);
+      for (p = 0; p < HASHTABLE_PHASE_MAX; p++) {
+        fprintf (json, ", \"%s_ns\": %.1f", phase2str[p], r->phase_ns[p]);
+      }
+      fprintf (json, ", \"resize_ns\": %.1f, \"max_chain\": %zu, \"chains\": [", r->resize_ns, r->full.max_chain);
+      for (p = 0; p < HASH_TABLE_STATS_CHAIN_LENGTHS; p++) {
+        fprintf (json, "%s%zu", (p) ? ", " : "", r->full.chains[p]);
+      }
+      fprintf (json, "], \"resizes\": %" PRIu64 ", \"lock_contentions\": %" PRIu64 ", \"lock_wait_ns\": %" PRIu64 "}",
+          r->end.resizes, r->end.lock_contentions, r->end.lock_wait_ns);
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+
+  for (i = 0; i < nb_keys; i++) {
+    free (contexts[i]);
+  }
+  free (contexts);
+  free (results);
+  free (g_run.guti_keys);
+  free (g_run.int_keys);
+  mme_app_m_tmsi_pool_exit ();
+  OAILOG_EXIT ();
+  return 0;
+}
@@ -0,0 +1,318 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_itti_benchmark.c
+   \brief Throughput and hop latency of the ITTI messaging core, with synthetic tasks (existing task ids, no layer is initialized).
+   Patterns: "1:1" one task sends to another one, "N:1" N tasks send to the same task, "ping-pong" two tasks bounce one message.
+   Latency of a hop is from just before itti_send_msg_to_task() to the return of itti_receive_msg() in the destination task.
+   Senders keep at most ITTI_BENCHMARK_WINDOW messages in flight, lfds611 queues of tasks drop messages when full.
+   Usage: oaisim_mme_itti_benchmark [-n messages] [-p producers] [-o /path/to/results.json]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <pthread.h>
+
+#include "assertions.h"
+#include "log.h"
+#include "intertask_interface_init.h"
+
+#define ITTI_BENCHMARK_DEFAULT_MESSAGES   200000
+#define ITTI_BENCHMARK_DEFAULT_PRODUCERS       4
+#define ITTI_BENCHMARK_WINDOW                128   /* less than the queue size of the tasks */
+
+typedef enum {
+  ITTI_BENCHMARK_ONE_TO_ONE = 0,
+  ITTI_BENCHMARK_N_TO_ONE,
+  ITTI_BENCHMARK_PING_PONG,
+  ITTI_BENCHMARK_MAX_PATTERNS
+} itti_benchmark_pattern_t;
+
+typedef enum {
+  ITTI_BENCHMARK_MSG_START = 0,     /* from main thread, start sending */
+  ITTI_BENCHMARK_MSG_DATA,
+} itti_benchmark_msg_kind_t;
+
+/* Payload of MESSAGE_TEST, followed by padding up to the message size */
+typedef struct itti_benchmark_msg_s {
+  uint64_t                   send_ns;
+  uint32_t                   kind;
+  uint32_t                   sequence;
+} itti_benchmark_msg_t;
+
+#define ITTI_BENCHMARK_MSG(mSGpTR)   ((itti_benchmark_msg_t *)((uint8_t *)(mSGpTR) + sizeof (MessageHeader)))
+
+typedef struct itti_benchmark_run_s {
+  itti_benchmark_pattern_t   pattern;
+  int                        num_producers;
+  uint32_t                   payload_size;
+  uint64_t                   num_messages;     /* hops to measure */
+  task_id_t                  consumer;
+  task_id_t                  producers[ITTI_BENCHMARK_DEFAULT_PRODUCERS * 2];
+  uint64_t                   in_flight;
+  uint64_t                   num_received;
+  uint64_t                  *latencies_ns;
+  uint64_t                   start_ns;
+  uint64_t                   end_ns;
+  sem_t                      done;
+} itti_benchmark_run_t;
+
+static const char * const   pattern2str[ITTI_BENCHMARK_MAX_PATTERNS] = {"1:1", "N:1", "ping-pong"};
+static const uint32_t       payload_sizes[] = {16, 256, 900};   /* header + payload fit in the 1000 bytes pool */
+/* synthetic tasks, only their ids and queues are used */
+static const task_id_t      benchmark_tasks[] = {TASK_MME_APP, TASK_S1AP, TASK_NAS_MME, TASK_S11, TASK_S6A, TASK_SCTP, TASK_UDP, TASK_GTPV1_U, TASK_SPGW_APP};
+static itti_benchmark_run_t g_run;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void send_data (const task_id_t origin, const task_id_t destination, const uint32_t sequence)
+{
+  MessageDef           *message_p = itti_alloc_new_message_sized (origin, MESSAGE_TEST, g_run.payload_size);
+  itti_benchmark_msg_t *msg_p = ITTI_BENCHMARK_MSG (message_p);
+
+  msg_p->kind     = ITTI_BENCHMARK_MSG_DATA;
+  msg_p->sequence = sequence;
+  msg_p->send_ns  = now_ns ();
+  itti_send_msg_to_task (destination, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void receive_data (const task_id_t task_id, const itti_benchmark_msg_t * const msg_p, const uint64_t received_ns)
+{
+  uint64_t  index = __atomic_fetch_add (&g_run.num_received, 1, __ATOMIC_RELAXED);
+
+  if (index < g_run.num_messages) {
+    g_run.latencies_ns[index] = received_ns - msg_p->send_ns;
+  }
+  if ((index + 1) == g_run.num_messages) {
+    g_run.end_ns = received_ns;
+    sem_post (&g_run.done);
+    return;
+  }
+  if (ITTI_BENCHMARK_PING_PONG == g_run.pattern) {
+    send_data (task_id, (task_id == g_run.consumer) ? g_run.producers[0] : g_run.consumer, msg_p->sequence + 1);
+  } else {
+    __atomic_fetch_sub (&g_run.in_flight, 1, __ATOMIC_RELEASE);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Producer side of 1:1 and N:1, run in the task that received the start message
+static void produce (const task_id_t task_id)
+{
+  uint64_t  quota = g_run.num_messages / g_run.num_producers;
+  uint64_t  i = 0;
+
+  if (task_id == g_run.producers[0]) {
+    quota += g_run.num_messages % g_run.num_producers;
+  }
+  for (i = 0; i < quota; i++) {
+    while (__atomic_load_n (&g_run.in_flight, __ATOMIC_ACQUIRE) >= ITTI_BENCHMARK_WINDOW) {
+      sched_yield ();
+    }
+    __atomic_fetch_add (&g_run.in_flight, 1, __ATOMIC_RELAXED);
+    send_data (task_id, g_run.consumer, i);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void *benchmark_task (void *args_p)
+{
+  task_id_t             task_id = (task_id_t)(uintptr_t)args_p;
+  MessageDef           *received_message_p = NULL;
+  itti_benchmark_msg_t *msg_p = NULL;
+  uint64_t              received_ns = 0;
+  int                   rc = 0;
+
+  itti_mark_task_ready (task_id);
+  while (1) {
+    itti_receive_msg (task_id, &received_message_p);
+    received_ns = now_ns ();
+    if (MESSAGE_TEST == ITTI_MSG_ID (received_message_p)) {
+      msg_p = ITTI_BENCHMARK_MSG (received_message_p);
+      if (ITTI_BENCHMARK_MSG_START == msg_p->kind) {
+        if (ITTI_BENCHMARK_PING_PONG == g_run.pattern) {
+          send_data (task_id, g_run.consumer, 0);
+        } else {
+          produce (task_id);
+        }
+      } else {
+        receive_data (task_id, msg_p, received_ns);
+      }
+    }
+    rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+    AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+    received_message_p = NULL;
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  uint64_t  va = *(const uint64_t *)a;
+  uint64_t  vb = *(const uint64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t percentile (const uint64_t * const sorted, const uint64_t num, const double p)
+{
+  uint64_t  index = (uint64_t)(p * (double)num);
+
+  return sorted[(index >= num) ? num - 1 : index];
+}
+
+//------------------------------------------------------------------------------
+static void run (const itti_benchmark_pattern_t pattern, const int num_producers, const uint32_t payload_size, const uint64_t num_messages)
+{
+  MessageDef           *message_p = NULL;
+  itti_benchmark_msg_t *msg_p = NULL;
+  int                   i = 0;
+
+  g_run.pattern       = pattern;
+  g_run.num_producers = num_producers;
+  g_run.payload_size  = payload_size;
+  g_run.num_messages  = num_messages;
+  g_run.consumer      = benchmark_tasks[0];
+  for (i = 0; i < num_producers; i++) {
+    g_run.producers[i] = benchmark_tasks[1 + i];
+  }
+  g_run.in_flight     = 0;
+  g_run.num_received  = 0;
+  g_run.start_ns      = now_ns ();
+
+  for (i = 0; i < num_producers; i++) {
+    message_p = itti_alloc_new_message_sized (TASK_UNKNOWN, MESSAGE_TEST, sizeof (itti_benchmark_msg_t));
+    msg_p = ITTI_BENCHMARK_MSG (message_p);
+    msg_p->kind = ITTI_BENCHMARK_MSG_START;
+    itti_send_msg_to_task (g_run.producers[i], INSTANCE_DEFAULT, message_p);
+  }
+  sem_wait (&g_run.done);
+  // let the last messages in flight of other tasks be consumed before the next run
+  usleep (10000);
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  uint64_t              num_messages = ITTI_BENCHMARK_DEFAULT_MESSAGES;
+  int                   max_producers = ITTI_BENCHMARK_DEFAULT_PRODUCERS;
+  const char           *output = NULL;
+  FILE                 *json = NULL;
+  bool                  is_first_result = true;
+  int                   pattern = 0;
+  int                   num_producers = 0;
+  int                   s = 0;
+  int                   c = 0;
+  int                   i = 0;
+
+  while ((c = getopt (argc, argv, "n:p:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      num_messages = strtoull (optarg, NULL, 0);
+      break;
+    case 'p':
+      max_producers = atoi (optarg);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n messages] [-p producers] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((1 > max_producers) || ((sizeof (benchmark_tasks) / sizeof (benchmark_tasks[0])) <= max_producers) ||
+      ((sizeof (g_run.producers) / sizeof (g_run.producers[0])) < max_producers) || (0 == num_messages)) {
+    fprintf (stderr, "Invalid number of producers or of messages\n");
+    return -1;
+  }
+
+  OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, 4);
+  CHECK_INIT_RETURN (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+#if ENABLE_ITTI_ANALYZER
+          messages_definition_xml,
+#else
+          NULL,
+#endif
+          NULL));
+  sem_init (&g_run.done, 0, 0);
+  g_run.latencies_ns = calloc (num_messages, sizeof (uint64_t));
+  AssertFatal (NULL != g_run.latencies_ns, "Allocation of latencies failed");
+  for (i = 0; i <= max_producers; i++) {
+    itti_create_task (benchmark_tasks[i], benchmark_task, (void *)(uintptr_t)benchmark_tasks[i]);
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    AssertFatal (NULL != json, "Could not open %s", output);
+    fprintf (json, "{\"benchmark\": \"itti\", \"window\": %d, \"results\": [\n", ITTI_BENCHMARK_WINDOW);
+  }
+  fprintf (stdout, "%-10s %9s %8s %10s %12s %10s %10s %10s\n", "pattern", "producers", "payload", "messages", "msgs/s", "p50 ns", "p99 ns", "p999 ns");
+  for (pattern = 0; pattern < ITTI_BENCHMARK_MAX_PATTERNS; pattern++) {
+    num_producers = (ITTI_BENCHMARK_N_TO_ONE == pattern) ? max_producers : 1;
+    for (s = 0; s < sizeof (payload_sizes) / sizeof (payload_sizes[0]); s++) {
+      run (pattern, num_producers, payload_sizes[s], num_messages);
+
+      double   msgs_per_sec = (double)num_messages * 1e9 / (double)(g_run.end_ns - g_run.start_ns);
+      qsort (g_run.latencies_ns, num_messages, sizeof (uint64_t), compare_uint64);
+      uint64_t p50  = percentile (g_run.latencies_ns, num_messages, 0.50);
+      uint64_t p99  = percentile (g_run.latencies_ns, num_messages, 0.99);
+      uint64_t p999 = percentile (g_run.latencies_ns, num_messages, 0.999);
+
+      fprintf (stdout, "%-10s %9d %8u %10" PRIu64 " %12.0f %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
+          pattern2str[pattern], num_producers, payload_sizes[s], num_messages, msgs_per_sec, p50, p99, p999);
+      if (json) {
+        fprintf (json, "%s  {\"pattern\": \"%s\", \"producers\": %d, \"payload_bytes\": %u, \"messages\": %" PRIu64 ", "
+            "\"msgs_per_sec\": %.0f, \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 "}",
+            (is_first_result) ? "" : ",\n", pattern2str[pattern], num_producers, payload_sizes[s], num_messages, msgs_per_sec, p50, p99, p999);
+        is_first_result = false;
+      }
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  free (g_run.latencies_ns);
+  OAILOG_EXIT ();
+  return 0;
+}
@@ -0,0 +1,543 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_itti_replay.c
+   \brief Replay of an ITTI dump (ENABLE_ITTI_ANALYZER) into some tasks of the MME, the other tasks are stubs.
+   The tasks under test (S1AP, NAS_MME, MME_APP, all of them by default) run as in the MME. The messages that
+   were sent to them by the other tasks are sent again, as recorded, in the order of the dump. Messages exchanged
+   between tasks under test, and timer expiries, are not replayed: the tasks under test produce them again.
+   The other tasks (SCTP, S6A, S11 and the tasks not under test) are stubs that drop what they receive.
+   Replay is causal: a recorded message is sent when the tasks under test have sent to the stubs as many messages
+   as they did before it in the dump, a replay where they do not is reported as diverging. On top of this, the
+   time between messages of the dump can be kept (-s 1), or shortened (-s 10 for ten times faster), the default
+   (-s 0) sends each message as soon as causality allows.
+   bstring fields of the messages (messages_bstring_def.h) are replayed with their recorded content, messages of
+   a dump without this content are not replayed.
+   Usage: oaisim_mme_itti_replay -c /path/to/mme.conf -d /path/to/dump [-t S1AP,NAS_MME,MME_APP] [-s speed]
+            [-x timeout s] [-o /path/to/results.json]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bstrlib.h"
+#include "assertions.h"
+#include "log.h"
+#include "msc.h"
+#include "mme_config.h"
+#include "intertask_interface_init.h"
+#include "s1ap_mme.h"
+#include "nas_defs.h"
+#include "mme_app_extern.h"
+
+#define ITTI_REPLAY_DEFAULT_TIMEOUT_SEC           5
+#define ITTI_REPLAY_STARTUP_SEC                   5
+
+typedef struct itti_replay_record_s {
+  const uint8_t             *data;             /* MessageDef then content of its bstrings, in the mapped dump */
+  uint64_t                   time_us;          /* time the message was sent */
+  uint64_t                   outputs;          /* messages sent by the tasks under test to the stubs before this one */
+} itti_replay_record_t;
+
+typedef struct itti_replay_run_s {
+  // configuration
+  const char                *dump;
+  double                     speed;
+  uint64_t                   timeout_ns;
+  const char                *output;
+  bool                       is_tested[TASK_MAX];
+  bool                       is_stub[TASK_MAX];
+  // dump
+  uint8_t                   *map;
+  size_t                     map_size;
+  itti_replay_record_t      *records;
+  uint32_t                   num_records;
+  uint32_t                   num_messages;
+  uint32_t                   num_incompatible; /* not the same message definitions, or no content of bstrings */
+  uint64_t                   expected_outputs;
+  // replay
+  pthread_mutex_t            lock;
+  pthread_cond_t             cond;
+  uint64_t                   outputs;          /* messages received by the stubs from the tasks under test */
+  uint64_t                   output_offset;    /* outputs missing after divergences */
+  uint32_t                   num_divergences;
+  uint32_t                   injected[MESSAGES_ID_MAX];
+  uint64_t                   stub_received[TASK_MAX];
+  uint64_t                   cpu_start_ns[TASK_MAX];
+  uint64_t                   start_ns;
+  uint64_t                   end_ns;
+} itti_replay_run_t;
+
+typedef struct itti_replay_bstring_field_s {
+  MessagesIds                message_id;
+  size_t                     offset;
+} itti_replay_bstring_field_t;
+
+/* tasks of the MME that can be under test, then the ones that are always stubs */
+static const task_id_t      replay_tasks[] = {TASK_S1AP, TASK_NAS_MME, TASK_MME_APP, TASK_SCTP, TASK_S6A, TASK_S11};
+#define ITTI_REPLAY_TESTABLE_TASKS                3
+static const itti_replay_bstring_field_t replay_bstring_fields[] = {
+#define MESSAGE_BSTRING_DEF(iD, fIELD) {iD, offsetof (MessageDef, ittiMsg.fIELD)},
+#include <messages_bstring_def.h>
+#undef MESSAGE_BSTRING_DEF
+};
+static itti_replay_run_t    g_replay;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//==============================================================================
+// Dump
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Size of the content of the bstrings following a dumped message, 0 if it is not in the dump
+static size_t replay_bstrings_size (const MessagesIds message_id, const uint8_t * const data, const size_t size)
+{
+  uint32_t                  length = 0;
+  size_t                    offset = 0;
+  int                       i = 0;
+
+  for (i = 0; i < sizeof (replay_bstring_fields) / sizeof (replay_bstring_fields[0]); i++) {
+    if (replay_bstring_fields[i].message_id == message_id) {
+      if (offset + sizeof (length) > size) {
+        return 0;
+      }
+      memcpy (&length, &data[offset], sizeof (length));
+      offset += sizeof (length) + ((ITTI_DUMP_BSTRING_NULL == length) ? 0 : ((length + 3) & ~3));
+    }
+  }
+  return (offset <= size) ? ((offset) ? offset : 1) : 0;
+}
+
+//------------------------------------------------------------------------------
+static void replay_restore_bstrings (MessageDef * const message_p, const uint8_t * data)
+{
+  bstring                   b = NULL;
+  uint32_t                  length = 0;
+  int                       i = 0;
+
+  for (i = 0; i < sizeof (replay_bstring_fields) / sizeof (replay_bstring_fields[0]); i++) {
+    if (replay_bstring_fields[i].message_id == ITTI_MSG_ID (message_p)) {
+      memcpy (&length, data, sizeof (length));
+      data += sizeof (length);
+      b = NULL;
+      if (ITTI_DUMP_BSTRING_NULL != length) {
+        b = blk2bstr (data, length);
+        data += (length + 3) & ~3;
+      }
+      memcpy ((uint8_t *)message_p + replay_bstring_fields[i].offset, &b, sizeof (b));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_destroy_bstrings (MessageDef * const message_p)
+{
+  bstring                   b = NULL;
+  int                       i = 0;
+
+  for (i = 0; i < sizeof (replay_bstring_fields) / sizeof (replay_bstring_fields[0]); i++) {
+    if (replay_bstring_fields[i].message_id == ITTI_MSG_ID (message_p)) {
+      memcpy (&b, (uint8_t *)message_p + replay_bstring_fields[i].offset, sizeof (b));
+      bdestroy (b);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_load_message (const uint8_t * const data, const size_t size)
+{
+  MessageHeader             header;
+  itti_replay_record_t     *record_p = NULL;
+
+  g_replay.num_messages++;
+  memcpy (&header, data, sizeof (header));
+  if ((MESSAGES_ID_MAX <= header.messageId) || (TASK_MAX <= header.originTaskId) || (TASK_MAX <= header.destinationTaskId)) {
+    g_replay.num_incompatible++;
+    return;
+  }
+  if ((g_replay.is_tested[header.originTaskId]) && (g_replay.is_stub[header.destinationTaskId])) {
+    g_replay.expected_outputs++;
+    return;
+  }
+  if ((!g_replay.is_tested[header.destinationTaskId]) || (g_replay.is_tested[header.originTaskId]) ||
+      (TASK_TIMER == header.originTaskId) || (TERMINATE_MESSAGE == header.messageId)) {
+    return;
+  }
+  if ((messages_info[header.messageId].size != header.ittiMsgSize) || (sizeof (MessageHeader) + header.ittiMsgSize > size) ||
+      (0 == replay_bstrings_size (header.messageId, &data[sizeof (MessageHeader) + header.ittiMsgSize], size - sizeof (MessageHeader) - header.ittiMsgSize))) {
+    g_replay.num_incompatible++;
+    return;
+  }
+  if (0 == (g_replay.num_records & (g_replay.num_records + 1)) ) {
+    g_replay.records = realloc (g_replay.records, 2 * (g_replay.num_records + 1) * sizeof (itti_replay_record_t));
+    AssertFatal (NULL != g_replay.records, "Allocation of records failed");
+  }
+  record_p = &g_replay.records[g_replay.num_records++];
+  record_p->data = data;
+  record_p->time_us = (uint64_t)header.lte_time.time.tv_sec * 1000000 + header.lte_time.time.tv_usec;
+  record_p->outputs = g_replay.expected_outputs;
+}
+
+//------------------------------------------------------------------------------
+static bool replay_load_dump (const char * const path)
+{
+  itti_socket_header_t      header;
+  struct stat               st;
+  size_t                    offset = 0;
+  int                       fd = -1;
+
+  if ((0 > (fd = open (path, O_RDONLY))) || (0 > fstat (fd, &st)) ||
+      (MAP_FAILED == (g_replay.map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)))) {
+    fprintf (stderr, "Could not map %s: %s\n", path, strerror (errno));
+    if (0 <= fd) {
+      close (fd);
+    }
+    g_replay.map = NULL;
+    return false;
+  }
+  close (fd);
+  g_replay.map_size = st.st_size;
+  madvise (g_replay.map, g_replay.map_size, MADV_SEQUENTIAL);
+  while (offset + sizeof (header) <= g_replay.map_size) {
+    memcpy (&header, &g_replay.map[offset], sizeof (header));
+    if ((sizeof (header) + sizeof (itti_message_types_t) > header.message_size) || (offset + header.message_size > g_replay.map_size)) {
+      fprintf (stderr, "%s: truncated at byte %zu\n", path, offset);
+      break;
+    }
+    if ((ITTI_DUMP_MESSAGE_TYPE == header.message_type) &&
+        (sizeof (header) + sizeof (itti_signal_header_t) + sizeof (MessageHeader) + sizeof (itti_message_types_t) <= header.message_size)) {
+      replay_load_message (&g_replay.map[offset + sizeof (header) + sizeof (itti_signal_header_t)],
+          header.message_size - sizeof (header) - sizeof (itti_signal_header_t) - sizeof (itti_message_types_t));
+    }
+    offset += header.message_size;
+  }
+  return true;
+}
+
+//==============================================================================
+// Stubs
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void *replay_stub_task (void *args_p)
+{
+  task_id_t                 task_id = (task_id_t)(intptr_t) args_p;
+  MessageDef               *received_message_p = NULL;
+  int                       rc = 0;
+
+  itti_mark_task_ready (task_id);
+  while (1) {
+    itti_receive_msg (task_id, &received_message_p);
+    if (TERMINATE_MESSAGE == ITTI_MSG_ID (received_message_p)) {
+      itti_exit_task ();
+    }
+    replay_destroy_bstrings (received_message_p);
+    if (g_replay.is_tested[ITTI_MSG_ORIGIN_ID (received_message_p)]) {
+      pthread_mutex_lock (&g_replay.lock);
+      g_replay.outputs++;
+      g_replay.stub_received[task_id]++;
+      pthread_cond_signal (&g_replay.cond);
+      pthread_mutex_unlock (&g_replay.lock);
+    }
+    rc = itti_free (ITTI_MSG_ORIGIN_ID (received_message_p), received_message_p);
+    AssertFatal (rc == EXIT_SUCCESS, "Failed to free memory (%d)!\n", rc);
+    received_message_p = NULL;
+  }
+  return NULL;
+}
+
+//==============================================================================
+// Replay
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Wait for the tasks under test to send what they sent before the record, false if they did not in time
+static bool replay_wait_outputs (const uint64_t outputs)
+{
+  struct timespec           deadline;
+  bool                      is_caught_up = true;
+
+  clock_gettime (CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += g_replay.timeout_ns / 1000000000;
+  deadline.tv_nsec += g_replay.timeout_ns % 1000000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+  pthread_mutex_lock (&g_replay.lock);
+  while (g_replay.outputs + g_replay.output_offset < outputs) {
+    if (ETIMEDOUT == pthread_cond_timedwait (&g_replay.cond, &g_replay.lock, &deadline)) {
+      // resynchronize on this record, what is missing will not come
+      g_replay.output_offset = outputs - g_replay.outputs;
+      is_caught_up = false;
+      break;
+    }
+  }
+  pthread_mutex_unlock (&g_replay.lock);
+  return is_caught_up;
+}
+
+//------------------------------------------------------------------------------
+static void replay_inject (const itti_replay_record_t * const record_p)
+{
+  MessageHeader             header;
+  MessageDef               *message_p = NULL;
+
+  memcpy (&header, record_p->data, sizeof (header));
+  message_p = itti_alloc_new_message_sized (header.originTaskId, header.messageId, header.ittiMsgSize);
+  memcpy ((uint8_t *)message_p + sizeof (MessageHeader), &record_p->data[sizeof (MessageHeader)], header.ittiMsgSize);
+  replay_restore_bstrings (message_p, &record_p->data[sizeof (MessageHeader) + header.ittiMsgSize]);
+  g_replay.injected[header.messageId]++;
+  itti_send_msg_to_task (header.destinationTaskId, header.instance, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void replay_report (void)
+{
+  FILE                     *json = NULL;
+  double                    elapsed_s = (double)(g_replay.end_ns - g_replay.start_ns) / 1e9;
+  uint64_t                  cpu_ns = 0;
+  uint32_t                  num_injected = 0;
+  int                       first = 1;
+  int                       i = 0;
+
+  for (i = 0; i < MESSAGES_ID_MAX; i++) {
+    num_injected += g_replay.injected[i];
+  }
+  if (g_replay.output) {
+    json = fopen (g_replay.output, "w");
+    AssertFatal (NULL != json, "Could not open %s", g_replay.output);
+    fprintf (json, "{\"benchmark\": \"itti_replay\", \"speed\": %.3f, \"messages\": %u, \"injected\": %u, \"incompatible\": %u,"
+        " \"expected_outputs\": %" PRIu64 ", \"outputs\": %" PRIu64 ", \"divergences\": %u, \"duration_ns\": %" PRIu64 ", \"tasks\": [\n",
+        g_replay.speed, g_replay.num_messages, num_injected, g_replay.num_incompatible, g_replay.expected_outputs,
+        g_replay.outputs, g_replay.num_divergences, g_replay.end_ns - g_replay.start_ns);
+  }
+  fprintf (stdout, "%u messages in the dump, %u injected in %.3f s (%.0f messages/s), %u not replayable\n",
+      g_replay.num_messages, num_injected, elapsed_s, (elapsed_s > 0) ? (double)num_injected / elapsed_s : 0.0, g_replay.num_incompatible);
+  fprintf (stdout, "%" PRIu64 "/%" PRIu64 " messages sent to the stubs, %u divergences\n",
+      g_replay.outputs, g_replay.expected_outputs, g_replay.num_divergences);
+  fprintf (stdout, "%-16s %12s %16s %14s\n", "task", "cpu ms", "cpu us/message", "stub received");
+  for (i = 0; i < sizeof (replay_tasks) / sizeof (replay_tasks[0]); i++) {
+    cpu_ns = (g_replay.is_tested[replay_tasks[i]]) ? itti_get_task_cpu_time_ns (replay_tasks[i]) - g_replay.cpu_start_ns[replay_tasks[i]] : 0;
+    fprintf (stdout, "%-16s %12.1f %16.2f %14" PRIu64 "\n", itti_get_task_name (replay_tasks[i]), (double)cpu_ns / 1e6,
+        (num_injected) ? (double)cpu_ns / 1e3 / num_injected : 0.0, g_replay.stub_received[replay_tasks[i]]);
+    if (json) {
+      fprintf (json, "%s  {\"task\": \"%s\", \"under_test\": %s, \"cpu_ns\": %" PRIu64 ", \"stub_received\": %" PRIu64 "}",
+          (i) ? ",\n" : "", itti_get_task_name (replay_tasks[i]), (g_replay.is_tested[replay_tasks[i]]) ? "true" : "false",
+          cpu_ns, g_replay.stub_received[replay_tasks[i]]);
+    }
+  }
+  fprintf (stdout, "%-48s %10s\n", "message", "injected");
+  if (json) {
+    fprintf (json, "\n], \"messages\": [\n");
+  }
+  for (i = 0; i < MESSAGES_ID_MAX; i++) {
+    if (g_replay.injected[i]) {
+      fprintf (stdout, "%-48s %10u\n", itti_get_message_name (i), g_replay.injected[i]);
+      if (json) {
+        fprintf (json, "%s  {\"message\": \"%s\", \"injected\": %u}", (first) ? "" : ",\n", itti_get_message_name (i), g_replay.injected[i]);
+      }
+      first = 0;
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  fflush (stdout);
+}
+
+//------------------------------------------------------------------------------
+static void *replay_driver (__attribute__ ((unused)) void *args_p)
+{
+  const itti_replay_record_t *record_p = NULL;
+  struct timespec           ts;
+  uint64_t                  deadline_ns = now_ns () + (uint64_t)ITTI_REPLAY_STARTUP_SEC * 1000000000;
+  uint64_t                  target_ns = 0;
+  uint32_t                  r = 0;
+  int                       i = 0;
+
+  // tasks under test are started
+  for (i = 0; i < ITTI_REPLAY_TESTABLE_TASKS; i++) {
+    while ((g_replay.is_tested[replay_tasks[i]]) && (0 == (g_replay.cpu_start_ns[replay_tasks[i]] = itti_get_task_cpu_time_ns (replay_tasks[i])))) {
+      AssertFatal (now_ns () < deadline_ns, "%s not started", itti_get_task_name (replay_tasks[i]));
+      usleep (1000);
+    }
+  }
+  g_replay.start_ns = now_ns ();
+  for (r = 0; r < g_replay.num_records; r++) {
+    record_p = &g_replay.records[r];
+    if (g_replay.speed > 0) {
+      target_ns = g_replay.start_ns + (uint64_t)((double)(record_p->time_us - g_replay.records[0].time_us) * 1000 / g_replay.speed);
+      ts.tv_sec = target_ns / 1000000000;
+      ts.tv_nsec = target_ns % 1000000000;
+      while (EINTR == clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL));
+    }
+    if (!replay_wait_outputs (record_p->outputs)) {
+      if (0 == g_replay.num_divergences++) {
+        fprintf (stderr, "Replay diverges before message %u: %" PRIu64 " messages sent to the stubs, %" PRIu64 " in the dump\n",
+            r, g_replay.outputs, record_p->outputs);
+      }
+    }
+    replay_inject (record_p);
+  }
+  if (!replay_wait_outputs (g_replay.expected_outputs)) {
+    g_replay.num_divergences++;
+  }
+  g_replay.end_ns = now_ns ();
+  replay_report ();
+  itti_terminate_tasks (TASK_UNKNOWN);
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static bool replay_parse_tasks (char * const tasks)
+{
+  char                     *saveptr = NULL;
+  char                     *name = NULL;
+  int                       i = 0;
+
+  for (name = strtok_r (tasks, ",", &saveptr); name; name = strtok_r (NULL, ",", &saveptr)) {
+    for (i = 0; i < ITTI_REPLAY_TESTABLE_TASKS; i++) {
+      if ((0 == strcmp (name, tasks_info[replay_tasks[i]].name)) || (0 == strcmp (name, tasks_info[replay_tasks[i]].name + strlen ("TASK_")))) {
+        g_replay.is_tested[replay_tasks[i]] = true;
+        break;
+      }
+    }
+    if (ITTI_REPLAY_TESTABLE_TASKS == i) {
+      fprintf (stderr, "Task %s can not be under test, only S1AP, NAS_MME and MME_APP can\n", name);
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  char                     *config_argv[] = {argv[0], "-c", NULL, NULL};
+  char                      default_tasks[] = "S1AP,NAS_MME,MME_APP";
+  char                     *tasks = default_tasks;
+  pthread_t                 driver;
+  int                       i = 0;
+  int                       c = 0;
+
+  g_replay.timeout_ns = (uint64_t)ITTI_REPLAY_DEFAULT_TIMEOUT_SEC * 1000000000;
+  while ((c = getopt (argc, argv, "c:d:t:s:x:o:")) != -1) {
+    switch (c) {
+    case 'c':
+      config_argv[2] = optarg;
+      break;
+    case 'd':
+      g_replay.dump = optarg;
+      break;
+    case 't':
+      tasks = optarg;
+      break;
+    case 's':
+      g_replay.speed = strtod (optarg, NULL);
+      break;
+    case 'x':
+      g_replay.timeout_ns = strtoull (optarg, NULL, 0) * 1000000000;
+      break;
+    case 'o':
+      g_replay.output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s -c /path/to/mme.conf -d /path/to/dump [-t S1AP,NAS_MME,MME_APP] [-s speed, 0 for no timing]"
+          " [-x timeout s] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((NULL == config_argv[2]) || (NULL == g_replay.dump) || (0 > g_replay.speed) || (!replay_parse_tasks (tasks))) {
+    fprintf (stderr, "Missing configuration file or dump, or invalid speed or tasks\n");
+    return -1;
+  }
+  for (i = 0; i < sizeof (replay_tasks) / sizeof (replay_tasks[0]); i++) {
+    g_replay.is_stub[replay_tasks[i]] = !g_replay.is_tested[replay_tasks[i]];
+  }
+
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  optind = 1;
+  CHECK_INIT_RETURN (mme_config_parse_opt_line (3, config_argv, &mme_config));
+  if (!replay_load_dump (g_replay.dump)) {
+    return -1;
+  }
+  fprintf (stdout, "%s: %u messages, %u to replay, %" PRIu64 " expected from the tasks under test, %u not replayable\n",
+      g_replay.dump, g_replay.num_messages, g_replay.num_records, g_replay.expected_outputs, g_replay.num_incompatible);
+  if (0 == g_replay.num_records) {
+    return -1;
+  }
+  pthread_mutex_init (&g_replay.lock, NULL);
+  pthread_cond_init (&g_replay.cond, NULL);
+
+  CHECK_INIT_RETURN (itti_init (TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info,
+#if ENABLE_ITTI_ANALYZER
+          messages_definition_xml,
+#else
+          NULL,
+#endif
+          NULL));
+  MSC_INIT (MSC_MME, THREAD_MAX + TASK_MAX);
+  // stubs first, TASK_S1AP sends SCTP_INIT_MSG at its start
+  for (i = 0; i < sizeof (replay_tasks) / sizeof (replay_tasks[0]); i++) {
+    if (g_replay.is_stub[replay_tasks[i]]) {
+      CHECK_INIT_RETURN (itti_create_task (replay_tasks[i], replay_stub_task, (void *)(intptr_t) replay_tasks[i]));
+    }
+  }
+  if (g_replay.is_tested[TASK_NAS_MME]) {
+    CHECK_INIT_RETURN (nas_init (&mme_config));
+  }
+  if (g_replay.is_tested[TASK_S1AP]) {
+    CHECK_INIT_RETURN (s1ap_mme_init ());
+  }
+  if (g_replay.is_tested[TASK_MME_APP]) {
+    CHECK_INIT_RETURN (mme_app_init (&mme_config));
+  }
+  AssertFatal (0 == pthread_create (&driver, NULL, replay_driver, NULL), "Creation of the replay thread failed");
+  itti_wait_tasks_end ();
+
+  free (g_replay.records);
+  munmap (g_replay.map, g_replay.map_size);
+  OAILOG_EXIT ();
+  return (g_replay.num_divergences) ? -1 : 0;
+}
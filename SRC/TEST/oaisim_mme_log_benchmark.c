@@ -0,0 +1,177 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_log_benchmark.c
+   \brief Cost in ns of one OAILOG_DEBUG() on the calling thread, for each output mode of the logging utility.
+   "filtered" is a call site disabled by its cached filter, "filtered-fn" is the same log filtered inside log.c
+   after the evaluation of its arguments (expansion of OAILOG_DEBUG() before call site filtering).
+   Usage: oaisim_mme_log_benchmark [-n iterations] [-o /path/to/output/file]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "log.h"
+
+#define LOG_BENCHMARK_DEFAULT_ITERATIONS  1000000
+#define LOG_BENCHMARK_DRAIN_PERIOD_USEC      1000
+
+typedef struct log_benchmark_mode_s {
+  const char  *name;
+  bool         is_output_thread_safe;
+  bool         is_output_binary;
+  log_level_t  util_log_level;
+  bool         is_call_site;         /* OAILOG_DEBUG() or log_message() */
+  const char  *call_site_rule;       /* enable rule, whatever util_log_level is */
+  uint32_t     call_site_messages_per_sec; /* rate limit of LOG_UTIL call sites */
+} log_benchmark_mode_t;
+
+static const log_benchmark_mode_t       modes[] = {
+  {"filtered",    true,  false, OAILOG_LEVEL_INFO,  true,  NULL, 0},
+  {"filtered-fn", true,  false, OAILOG_LEVEL_INFO,  false, NULL, 0},
+  {"direct",      false, false, OAILOG_LEVEL_DEBUG, true,  NULL, 0},
+  {"queued",      true,  false, OAILOG_LEVEL_DEBUG, true,  NULL, 0},
+  {"binary",      true,  true,  OAILOG_LEVEL_DEBUG, true,  NULL, 0},
+  {"site-rule",   true,  false, OAILOG_LEVEL_INFO,  true,  "oaisim_mme_log_benchmark.c", 0},
+  {"rate-limit",  true,  false, OAILOG_LEVEL_DEBUG, true,  NULL, 1000},
+};
+
+static volatile bool                    drain_running = false;
+
+//------------------------------------------------------------------------------
+// Stand-in for the ITTI log task
+static void *drain_thread (__attribute__ ((unused)) void *args_p)
+{
+  while (drain_running) {
+    log_flush_messages ();
+    usleep (LOG_BENCHMARK_DRAIN_PERIOD_USEC);
+  }
+  log_flush_messages ();
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  log_config_t                            config = {0};
+  pthread_t                               drain_tid;
+  uint64_t                                iterations = LOG_BENCHMARK_DEFAULT_ITERATIONS;
+  uint64_t                                start = 0;
+  uint64_t                                elapsed = 0;
+  uint64_t                                i = 0;
+  uint64_t                                imsi64 = 208950000000001;
+  const char                             *output = "/dev/null";
+  int                                     m = 0;
+  int                                     c = 0;
+
+  while ((c = getopt (argc, argv, "n:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      iterations = strtoull (optarg, NULL, 0);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n iterations] [-o /path/to/output/file]\n", argv[0]);
+      return -1;
+    }
+  }
+
+  OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, 4);
+  config.udp_log_level      = MAX_LOG_LEVEL;
+  config.gtpv1u_log_level   = MAX_LOG_LEVEL;
+  config.gtpv2c_log_level   = MAX_LOG_LEVEL;
+  config.sctp_log_level     = MAX_LOG_LEVEL;
+  config.s1ap_log_level     = MAX_LOG_LEVEL;
+  config.nas_log_level      = MAX_LOG_LEVEL;
+  config.mme_app_log_level  = MAX_LOG_LEVEL;
+  config.spgw_app_log_level = MAX_LOG_LEVEL;
+  config.s11_log_level      = MAX_LOG_LEVEL;
+  config.s6a_log_level      = MAX_LOG_LEVEL;
+  config.msc_log_level      = MAX_LOG_LEVEL;
+  config.itti_log_level     = MAX_LOG_LEVEL;
+  config.output             = bfromcstr (output);
+  config.suppressed_summary_period_sec = 1;
+
+  fprintf (stdout, "%-12s %12s %12s\n", "mode", "iterations", "ns/call");
+  for (m = 0; m < sizeof (modes) / sizeof (modes[0]); m++) {
+    config.util_log_level        = modes[m].util_log_level;
+    config.is_output_thread_safe = modes[m].is_output_thread_safe;
+    config.is_output_binary      = modes[m].is_output_binary;
+    config.rate_limit[LOG_UTIL].call_site_messages_per_sec = modes[m].call_site_messages_per_sec;
+    config.rate_limit[LOG_UTIL].call_site_burst            = modes[m].call_site_messages_per_sec;
+    OAILOG_SET_CONFIG (&config);
+    // open the output only once
+    if (config.output) {
+      bdestroy (config.output);
+      config.output = NULL;
+    }
+
+    if (modes[m].call_site_rule) {
+      log_call_site_set_rule (modes[m].call_site_rule, true);
+    }
+    if (config.is_output_thread_safe) {
+      drain_running = true;
+      pthread_create (&drain_tid, NULL, drain_thread, NULL);
+    }
+
+    start = now_ns ();
+    if (modes[m].is_call_site) {
+      for (i = 0; i < iterations; i++) {
+        OAILOG_DEBUG (LOG_UTIL, "Benchmark message %" PRIu64 " IMSI " "%" PRIu64 " ue id %u procedure %s\n", i, imsi64, (uint32_t) i & 0xFFFF, "attach");
+      }
+    } else {
+      for (i = 0; i < iterations; i++) {
+        log_message (NULL, OAILOG_LEVEL_DEBUG, LOG_UTIL, __FILE__, __LINE__, "Benchmark message %" PRIu64 " IMSI " "%" PRIu64 " ue id %u procedure %s\n", i, imsi64, (uint32_t) i & 0xFFFF, "attach");
+      }
+    }
+    elapsed = now_ns () - start;
+
+    if (config.is_output_thread_safe) {
+      drain_running = false;
+      pthread_join (drain_tid, NULL);
+    }
+    log_call_site_clear_rules ();
+    fprintf (stdout, "%-12s %12" PRIu64 " %12.1f\n", modes[m].name, iterations, (double)elapsed / (double)iterations);
+  }
+  OAILOG_EXIT ();
+  return 0;
+}
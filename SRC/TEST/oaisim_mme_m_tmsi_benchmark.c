@@ -0,0 +1,318 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file oaisim_mme_m_tmsi_benchmark.c
+   \brief M-TMSI allocation, the M-TMSI pool against the truncation of the UE context address to 32 bits.
+   For each number of live UEs, reported as the median of several runs:
+   - fill:  allocation of the M-TMSIs of all the live UEs (with the malloc of the UE context for the truncation),
+   - churn: release of the M-TMSI of a random live UE then allocation of a new one (a detach then an attach),
+   and over the last run, the collisions among the live M-TMSIs and the M-TMSIs reused by the very next allocation.
+   The truncation allocates live UEs x context size bytes, reduce the size with -s on small hosts.
+   Usage: oaisim_mme_m_tmsi_benchmark [-n live UEs, may be repeated] [-s UE context size] [-k churn operations] [-r runs] [-c cpu] [-o /path/to/results.json]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+
+#include "assertions.h"
+#include "log.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_m_tmsi.h"
+
+#define M_TMSI_BENCHMARK_MAX_SIZES        8
+#define M_TMSI_BENCHMARK_DEFAULT_CHURN    1000000
+#define M_TMSI_BENCHMARK_DEFAULT_RUNS     3
+#define M_TMSI_BENCHMARK_MAX_RUNS         31
+
+typedef enum {
+  M_TMSI_SCHEME_POOL = 0,
+  M_TMSI_SCHEME_ADDRESS,
+  M_TMSI_SCHEME_MAX
+} m_tmsi_scheme_t;
+
+static const char * const m_tmsi_scheme_str[M_TMSI_SCHEME_MAX] = {"pool", "address"};
+
+typedef struct m_tmsi_benchmark_result_s {
+  m_tmsi_scheme_t            scheme;
+  uint64_t                   live_ues;
+  double                     fill_ns;         // per allocation
+  double                     churn_ns;        // per release + allocation
+  uint64_t                   collisions;      // live UEs sharing their M-TMSI with another one
+  uint64_t                   reused;          // churn allocations giving back the M-TMSI just released
+  uint64_t                   failures;        // allocations failed
+} m_tmsi_benchmark_result_t;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  const uint64_t            x = *(const uint64_t *)a;
+  const uint64_t            y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+static int compare_tmsi (const void *a, const void *b)
+{
+  const tmsi_t              x = *(const tmsi_t *)a;
+  const tmsi_t              y = *(const tmsi_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t xorshift64 (uint64_t * const state)
+{
+  uint64_t                  x = *state;
+
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+//------------------------------------------------------------------------------
+// mme_api_new_guti as before the M-TMSI pool
+static inline tmsi_t address_allocate (void ** const context, const size_t context_size)
+{
+  *context = malloc (context_size);
+  AssertFatal (*context != NULL, "Out of memory, reduce the UE context size");
+  // touch the context, as mme_create_new_ue_context
+  memset (*context, 0, 64);
+  return (tmsi_t)(uintptr_t)*context;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t count_collisions (const tmsi_t * const m_tmsi, const uint64_t nb, tmsi_t * const sorted)
+{
+  uint64_t                  collisions = 0;
+
+  memcpy (sorted, m_tmsi, nb * sizeof (tmsi_t));
+  qsort (sorted, nb, sizeof (tmsi_t), compare_tmsi);
+  for (uint64_t i = 1; i < nb; i++) {
+    if (sorted[i] == sorted[i - 1]) {
+      collisions++;
+    }
+  }
+  return collisions;
+}
+
+//------------------------------------------------------------------------------
+// one run, returns fill and churn durations
+static void run (const m_tmsi_scheme_t scheme, const uint64_t nb_ues, const size_t context_size, const uint64_t nb_churn,
+    tmsi_t * const m_tmsi, void ** const context, tmsi_t * const sorted, uint64_t * const fill_ns, uint64_t * const churn_ns,
+    m_tmsi_benchmark_result_t * const result)
+{
+  uint64_t                  seed = 0x9E3779B97F4A7C15;
+  uint64_t                  start_ns = 0;
+
+  result->reused = 0;
+  result->failures = 0;
+  if (M_TMSI_SCHEME_POOL == scheme) {
+    AssertFatal (0 == mme_app_m_tmsi_pool_init ((uint32_t)nb_ues, M_TMSI_PREFIX, M_TMSI_PREFIX_BITS), "M-TMSI pool init failed");
+  }
+
+  start_ns = now_ns ();
+  for (uint64_t i = 0; i < nb_ues; i++) {
+    if (M_TMSI_SCHEME_POOL == scheme) {
+      context[i] = (void *)(uintptr_t)(i + 1);
+      m_tmsi[i] = mme_app_m_tmsi_allocate (context[i]);
+    } else {
+      m_tmsi[i] = address_allocate (&context[i], context_size);
+    }
+  }
+  *fill_ns = now_ns () - start_ns;
+  for (uint64_t i = 0; i < nb_ues; i++) {
+    result->failures += (INVALID_M_TMSI == m_tmsi[i]);
+  }
+
+  start_ns = now_ns ();
+  for (uint64_t k = 0; k < nb_churn; k++) {
+    uint64_t                i = xorshift64 (&seed) % nb_ues;
+    tmsi_t                  released = m_tmsi[i];
+
+    if (M_TMSI_SCHEME_POOL == scheme) {
+      mme_app_m_tmsi_release (released, context[i]);
+      m_tmsi[i] = mme_app_m_tmsi_allocate (context[i]);
+    } else {
+      free (context[i]);
+      m_tmsi[i] = address_allocate (&context[i], context_size);
+    }
+    result->reused += (released == m_tmsi[i]);
+  }
+  *churn_ns = now_ns () - start_ns;
+
+  result->collisions = count_collisions (m_tmsi, nb_ues, sorted);
+  if (M_TMSI_SCHEME_POOL == scheme) {
+    mme_app_m_tmsi_pool_exit ();
+  } else {
+    for (uint64_t i = 0; i < nb_ues; i++) {
+      free (context[i]);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void measure (const m_tmsi_scheme_t scheme, const uint64_t nb_ues, const size_t context_size, const uint64_t nb_churn,
+    const int runs, m_tmsi_benchmark_result_t * const result)
+{
+  uint64_t                  fill_ns[M_TMSI_BENCHMARK_MAX_RUNS];
+  uint64_t                  churn_ns[M_TMSI_BENCHMARK_MAX_RUNS];
+  tmsi_t                   *m_tmsi = calloc (nb_ues, sizeof (tmsi_t));
+  tmsi_t                   *sorted = calloc (nb_ues, sizeof (tmsi_t));
+  void                    **context = calloc (nb_ues, sizeof (void *));
+
+  AssertFatal ((m_tmsi) && (sorted) && (context), "Out of memory");
+  result->scheme = scheme;
+  result->live_ues = nb_ues;
+  for (int r = 0; r < runs; r++) {
+    run (scheme, nb_ues, context_size, nb_churn, m_tmsi, context, sorted, &fill_ns[r], &churn_ns[r], result);
+  }
+  qsort (fill_ns, runs, sizeof (uint64_t), compare_uint64);
+  qsort (churn_ns, runs, sizeof (uint64_t), compare_uint64);
+  result->fill_ns = (double)fill_ns[runs / 2] / (double)nb_ues;
+  result->churn_ns = (nb_churn) ? (double)churn_ns[runs / 2] / (double)nb_churn : 0;
+  free (m_tmsi);
+  free (sorted);
+  free (context);
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  uint64_t                  sizes[M_TMSI_BENCHMARK_MAX_SIZES] = {1000000, 10000000};
+  int                       nb_sizes = 0;
+  size_t                    context_size = sizeof (ue_context_t);
+  uint64_t                  nb_churn = M_TMSI_BENCHMARK_DEFAULT_CHURN;
+  int                       runs = M_TMSI_BENCHMARK_DEFAULT_RUNS;
+  int                       cpu = -1;
+  const char               *output = NULL;
+  FILE                     *json = NULL;
+  cpu_set_t                 cpu_set;
+  m_tmsi_benchmark_result_t results[M_TMSI_BENCHMARK_MAX_SIZES * M_TMSI_SCHEME_MAX];
+  int                       c = 0;
+
+  while ((c = getopt (argc, argv, "n:s:k:r:c:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      if (M_TMSI_BENCHMARK_MAX_SIZES > nb_sizes) {
+        sizes[nb_sizes++] = strtoull (optarg, NULL, 0);
+      }
+      break;
+    case 's':
+      context_size = strtoul (optarg, NULL, 0);
+      break;
+    case 'k':
+      nb_churn = strtoull (optarg, NULL, 0);
+      break;
+    case 'r':
+      runs = atoi (optarg);
+      break;
+    case 'c':
+      cpu = atoi (optarg);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n live UEs, may be repeated] [-s UE context size] [-k churn operations] [-r runs] [-c cpu] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if (0 == nb_sizes) {
+    nb_sizes = 2;
+  }
+  for (int s = 0; s < nb_sizes; s++) {
+    if ((0 == sizes[s]) || (UINT32_MAX < sizes[s])) {
+      fprintf (stderr, "Invalid number of live UEs %" PRIu64 "\n", sizes[s]);
+      return -1;
+    }
+  }
+  if ((64 > context_size) || (1 > runs) || (M_TMSI_BENCHMARK_MAX_RUNS < runs)) {
+    fprintf (stderr, "Invalid parameters: UE context of at least 64 bytes, 1 to %d runs\n", M_TMSI_BENCHMARK_MAX_RUNS);
+    return -1;
+  }
+  if (0 > cpu) {
+    cpu = sched_getcpu ();
+  }
+  CPU_ZERO (&cpu_set);
+  CPU_SET (cpu, &cpu_set);
+  if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set)) {
+    fprintf (stderr, "Could not pin the benchmark on CPU %d\n", cpu);
+    return -1;
+  }
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+
+  for (int s = 0; s < nb_sizes; s++) {
+    for (int scheme = 0; scheme < M_TMSI_SCHEME_MAX; scheme++) {
+      measure (scheme, sizes[s], context_size, nb_churn, runs, &results[s * M_TMSI_SCHEME_MAX + scheme]);
+    }
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    if (NULL == json) {
+      fprintf (stderr, "Could not open %s\n", output);
+      return -1;
+    }
+    fprintf (json, "{\"benchmark\": \"m_tmsi\", \"cpu\": %d, \"context_size\": %zu, \"churn\": %" PRIu64 ", \"runs\": %d, \"results\": [\n",
+        cpu, context_size, nb_churn, runs);
+  }
+  fprintf (stdout, "%-8s %10s %12s %12s %12s %12s %10s\n", "scheme", "live UEs", "fill ns", "churn ns", "collisions", "reused", "failures");
+  for (int k = 0; k < nb_sizes * M_TMSI_SCHEME_MAX; k++) {
+    const m_tmsi_benchmark_result_t *r = &results[k];
+
+    fprintf (stdout, "%-8s %10" PRIu64 " %12.1f %12.1f %12" PRIu64 " %12" PRIu64 " %10" PRIu64 "\n",
+        m_tmsi_scheme_str[r->scheme], r->live_ues, r->fill_ns, r->churn_ns, r->collisions, r->reused, r->failures);
+    if (json) {
+      fprintf (json, "%s  {\"scheme\": \"%s\", \"live_ues\": %" PRIu64 ", \"fill_ns\": %.1f, \"churn_ns\": %.1f, \"collisions\": %" PRIu64 ", \"reused\": %" PRIu64 ", \"failures\": %" PRIu64 "}",
+          (k) ? ",\n" : "", m_tmsi_scheme_str[r->scheme], r->live_ues, r->fill_ns, r->churn_ns, r->collisions, r->reused, r->failures);
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  return 0;
+}
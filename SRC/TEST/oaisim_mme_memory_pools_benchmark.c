@@ -0,0 +1,328 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_memory_pools_benchmark.c
+   \brief Memory pools of ITTI with the layout of ITTI_MEMORY_POOLS, all items mapped at startup ("fixed") or grown by chunks ("elastic").
+   Each layout runs in its own process: resident memory after the pools creation, a burst of small items allocated by one
+   thread with the resident memory at the peak of the burst and after the burst items are freed and two periods of
+   memory_pools_release_idle () (the pools grew during the first one), then the allocation latency of threads that keep a
+   window of live items of mixed sizes.
+   Usage: oaisim_mme_memory_pools_benchmark [-t threads] [-n allocations per thread] [-b burst items] [-o /path/to/results.json]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "assertions.h"
+#include "memory_pools.h"
+#include "intertask_interface_conf.h"
+
+#define MP_BENCHMARK_DEFAULT_THREADS             4
+#define MP_BENCHMARK_DEFAULT_ALLOCATIONS    500000
+#define MP_BENCHMARK_DEFAULT_BURST          100000
+#define MP_BENCHMARK_WINDOW                     64   /* live items per thread */
+#define MP_BENCHMARK_BURST_ITEM_SIZE            80
+#define MP_BENCHMARK_MAX_THREADS                16
+
+typedef enum {
+  MP_BENCHMARK_FIXED = 0,
+  MP_BENCHMARK_ELASTIC,
+  MP_BENCHMARK_MAX_LAYOUTS
+} mp_benchmark_layout_t;
+
+typedef struct mp_benchmark_thread_s {
+  pthread_t                  thread;
+  unsigned int               seed;
+  uint64_t                  *latencies_ns;
+} mp_benchmark_thread_t;
+
+static const char * const   layout2str[MP_BENCHMARK_MAX_LAYOUTS] = {"fixed", "elastic"};
+/* message list elements, small messages, NAS PDUs and S1AP containers, large messages */
+static const uint32_t       item_sizes[] = {24, 24, 80, 80, 80, 600, 900, 15000};
+static memory_pools_handle_t g_pools;
+static uint64_t             g_num_allocations;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static size_t rss_kbytes (void)
+{
+  FILE     *statm = fopen ("/proc/self/statm", "r");
+  unsigned long size = 0;
+  unsigned long resident = 0;
+  int       rc = 0;
+
+  AssertFatal (NULL != statm, "Could not open /proc/self/statm");
+  rc = fscanf (statm, "%lu %lu", &size, &resident);
+  AssertFatal (2 == rc, "Could not read /proc/self/statm");
+  fclose (statm);
+  return (resident * sysconf (_SC_PAGESIZE)) / 1024;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  uint64_t  va = *(const uint64_t *)a;
+  uint64_t  vb = *(const uint64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t percentile (const uint64_t * const sorted, const uint64_t num, const double p)
+{
+  uint64_t  index = (uint64_t)(p * (double)num);
+
+  return sorted[(index >= num) ? num - 1 : index];
+}
+
+//------------------------------------------------------------------------------
+static void create_pools (const mp_benchmark_layout_t layout)
+{
+#define MP_BENCHMARK_POOL_COUNT(iTEMsIZE, iNITIALiTEMS, mAXiTEMS) + 1
+#define MP_BENCHMARK_POOL_ADD(iTEMsIZE, iNITIALiTEMS, mAXiTEMS)                                                 \
+  if (MP_BENCHMARK_FIXED == layout) {                                                                           \
+    memory_pools_add_pool (g_pools, mAXiTEMS, iTEMsIZE);                                                        \
+  } else {                                                                                                      \
+    memory_pools_add_elastic_pool (g_pools, iNITIALiTEMS, mAXiTEMS, iTEMsIZE, ITTI_MEMORY_POOLS_RELEASE_IDLE);  \
+  }
+  g_pools = memory_pools_create (0 ITTI_MEMORY_POOLS (MP_BENCHMARK_POOL_COUNT));
+  ITTI_MEMORY_POOLS (MP_BENCHMARK_POOL_ADD)
+#undef MP_BENCHMARK_POOL_ADD
+#undef MP_BENCHMARK_POOL_COUNT
+}
+
+//------------------------------------------------------------------------------
+// Steady state: the oldest live item is freed before each allocation
+static void *steady_thread (void *args_p)
+{
+  mp_benchmark_thread_t *thread_p = (mp_benchmark_thread_t *)args_p;
+  void                  *live[MP_BENCHMARK_WINDOW] = {NULL};
+  void                  *item_p = NULL;
+  uint32_t               item_size = 0;
+  uint64_t               start_ns = 0;
+  uint64_t               i = 0;
+
+  for (i = 0; i < g_num_allocations; i++) {
+    if (live[i % MP_BENCHMARK_WINDOW]) {
+      memory_pools_free (g_pools, live[i % MP_BENCHMARK_WINDOW], 0);
+    }
+    item_size = item_sizes[rand_r (&thread_p->seed) % (sizeof (item_sizes) / sizeof (item_sizes[0]))];
+    start_ns = now_ns ();
+    item_p = memory_pools_allocate (g_pools, item_size, 0, 0);
+    thread_p->latencies_ns[i] = now_ns () - start_ns;
+    AssertFatal (NULL != item_p, "Allocation of %u bytes failed", item_size);
+    memset (item_p, 0x5A, item_size);
+    live[i % MP_BENCHMARK_WINDOW] = item_p;
+  }
+  for (i = 0; i < MP_BENCHMARK_WINDOW; i++) {
+    if (live[i]) {
+      memory_pools_free (g_pools, live[i], 0);
+    }
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void run (const mp_benchmark_layout_t layout, const int num_threads, const uint64_t num_burst, FILE *json)
+{
+  mp_benchmark_thread_t  threads[MP_BENCHMARK_MAX_THREADS];
+  uint64_t              *latencies_ns = calloc (num_threads * g_num_allocations, sizeof (uint64_t));
+  uint64_t              *burst_latencies_ns = calloc (num_burst, sizeof (uint64_t));
+  void                 **burst_items = calloc (num_burst, sizeof (void *));
+  memory_pool_stats_t    stats;
+  size_t                 rss_before_kb = 0;
+  size_t                 startup_kb = 0;
+  size_t                 burst_peak_kb = 0;
+  size_t                 burst_after_kb = 0;
+  uint64_t               burst_failed = 0;
+  uint64_t               burst_ns = 0;
+  uint64_t               start_ns = 0;
+  uint64_t               steady_ns = 0;
+  uint64_t               num_latencies = num_threads * g_num_allocations;
+  uint64_t               grows = 0;
+  uint64_t               releases = 0;
+  uint64_t               i = 0;
+  uint32_t               pool = 0;
+
+  AssertFatal ((NULL != latencies_ns) && (NULL != burst_latencies_ns) && (NULL != burst_items), "Allocation of samples failed");
+  // samples are resident before the pools are created, they do not count in the memory of the pools
+  memset (latencies_ns, 0, num_threads * g_num_allocations * sizeof (uint64_t));
+  memset (burst_latencies_ns, 0, num_burst * sizeof (uint64_t));
+  memset (burst_items, 0, num_burst * sizeof (void *));
+  rss_before_kb = rss_kbytes ();
+  create_pools (layout);
+  startup_kb = rss_kbytes () - rss_before_kb;
+
+  start_ns = now_ns ();
+  for (i = 0; i < num_burst; i++) {
+    uint64_t item_start_ns = now_ns ();
+
+    burst_items[i] = memory_pools_allocate (g_pools, MP_BENCHMARK_BURST_ITEM_SIZE, 0, 0);
+    burst_latencies_ns[i] = now_ns () - item_start_ns;
+    if (NULL == burst_items[i]) {
+      burst_failed++;
+    }
+  }
+  burst_ns = now_ns () - start_ns;
+  burst_peak_kb = rss_kbytes () - rss_before_kb;
+  for (i = 0; i < num_burst; i++) {
+    if (burst_items[i]) {
+      memory_pools_free (g_pools, burst_items[i], 0);
+    }
+  }
+  memory_pools_release_idle (g_pools);
+  memory_pools_release_idle (g_pools);
+  burst_after_kb = rss_kbytes () - rss_before_kb;
+
+  // the stacks of the threads stay resident, the burst is measured first
+  start_ns = now_ns ();
+  for (i = 0; i < num_threads; i++) {
+    threads[i].seed = i + 1;
+    threads[i].latencies_ns = &latencies_ns[i * g_num_allocations];
+    pthread_create (&threads[i].thread, NULL, steady_thread, &threads[i]);
+  }
+  for (i = 0; i < num_threads; i++) {
+    pthread_join (threads[i].thread, NULL);
+  }
+  steady_ns = now_ns () - start_ns;
+  // qsort() allocates a copy of the samples, sort them once the resident memory is measured
+  qsort (latencies_ns, num_latencies, sizeof (uint64_t), compare_uint64);
+  qsort (burst_latencies_ns, num_burst, sizeof (uint64_t), compare_uint64);
+
+  for (pool = 0; EXIT_SUCCESS == memory_pools_get_stats (g_pools, pool, &stats); pool++) {
+    grows += stats.grows;
+    releases += stats.releases;
+  }
+
+  fprintf (stdout, "%-8s %11zu %12.0f %8" PRIu64 " %8" PRIu64 " %8" PRIu64 " %10" PRIu64 " %9" PRIu64 " %9" PRIu64 " %8" PRIu64 " %8zu %9zu %6" PRIu64 " %8" PRIu64 "\n",
+      layout2str[layout], startup_kb, (double)num_latencies * 1e9 / (double)steady_ns,
+      percentile (latencies_ns, num_latencies, 0.50), percentile (latencies_ns, num_latencies, 0.99), percentile (latencies_ns, num_latencies, 0.999),
+      burst_ns / 1000, percentile (burst_latencies_ns, num_burst, 0.99), burst_latencies_ns[num_burst - 1], burst_failed,
+      burst_peak_kb, burst_after_kb, grows, releases);
+  if (json) {
+    fprintf (json, "%s  {\"layout\": \"%s\", \"startup_rss_kb\": %zu, \"steady_allocs_per_sec\": %.0f, "
+        "\"steady_p50_ns\": %" PRIu64 ", \"steady_p99_ns\": %" PRIu64 ", \"steady_p999_ns\": %" PRIu64 ", "
+        "\"burst_us\": %" PRIu64 ", \"burst_p99_ns\": %" PRIu64 ", \"burst_max_ns\": %" PRIu64 ", \"burst_failed\": %" PRIu64 ", "
+        "\"burst_peak_rss_kb\": %zu, \"burst_after_rss_kb\": %zu, \"grows\": %" PRIu64 ", \"releases\": %" PRIu64 ", \"pools\": [",
+        (MP_BENCHMARK_FIXED == layout) ? "" : ",\n", layout2str[layout], startup_kb, (double)num_latencies * 1e9 / (double)steady_ns,
+        percentile (latencies_ns, num_latencies, 0.50), percentile (latencies_ns, num_latencies, 0.99), percentile (latencies_ns, num_latencies, 0.999),
+        burst_ns / 1000, percentile (burst_latencies_ns, num_burst, 0.99), burst_latencies_ns[num_burst - 1], burst_failed,
+        burst_peak_kb, burst_after_kb, grows, releases);
+    for (pool = 0; EXIT_SUCCESS == memory_pools_get_stats (g_pools, pool, &stats); pool++) {
+      fprintf (json, "%s{\"item_size\": %u, \"items_max\": %u, \"items_high_water\": %u, \"chunks_high_water\": %u, \"chunk_size\": %zu, \"exhausted\": %" PRIu64 "}",
+          (0 == pool) ? "" : ", ", stats.item_size, stats.items_max, stats.items_allocated_high_water, stats.chunks_mapped_high_water, stats.chunk_size, stats.exhausted);
+    }
+    fprintf (json, "]}");
+    fflush (json);
+  }
+  free (latencies_ns);
+  free (burst_latencies_ns);
+  free (burst_items);
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  int                   num_threads = MP_BENCHMARK_DEFAULT_THREADS;
+  uint64_t              num_burst = MP_BENCHMARK_DEFAULT_BURST;
+  const char           *output = NULL;
+  FILE                 *json = NULL;
+  pid_t                 pid = 0;
+  int                   status = 0;
+  int                   layout = 0;
+  int                   c = 0;
+
+  g_num_allocations = MP_BENCHMARK_DEFAULT_ALLOCATIONS;
+  while ((c = getopt (argc, argv, "t:n:b:o:")) != -1) {
+    switch (c) {
+    case 't':
+      num_threads = atoi (optarg);
+      break;
+    case 'n':
+      g_num_allocations = strtoull (optarg, NULL, 0);
+      break;
+    case 'b':
+      num_burst = strtoull (optarg, NULL, 0);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-t threads] [-n allocations per thread] [-b burst items] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((1 > num_threads) || (MP_BENCHMARK_MAX_THREADS < num_threads) || (0 == g_num_allocations) || (0 == num_burst)) {
+    fprintf (stderr, "Invalid number of threads, of allocations or of burst items\n");
+    return -1;
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    AssertFatal (NULL != json, "Could not open %s", output);
+    fprintf (json, "{\"benchmark\": \"memory_pools\", \"threads\": %d, \"allocations_per_thread\": %" PRIu64 ", \"window\": %d, "
+        "\"burst_items\": %" PRIu64 ", \"burst_item_size\": %d, \"results\": [\n",
+        num_threads, g_num_allocations, MP_BENCHMARK_WINDOW, num_burst, MP_BENCHMARK_BURST_ITEM_SIZE);
+  }
+  fprintf (stdout, "%-8s %11s %12s %8s %8s %8s %10s %9s %9s %8s %8s %9s %6s %8s\n", "layout", "startup KB", "allocs/s", "p50 ns", "p99 ns", "p999 ns",
+      "burst us", "b p99 ns", "b max ns", "b failed", "peak KB", "after KB", "grows", "releases");
+  for (layout = 0; layout < MP_BENCHMARK_MAX_LAYOUTS; layout++) {
+    // a process per layout, the resident memory of the previous layout is not given back by free()
+    fflush (stdout);
+    if (json) {
+      fflush (json);
+    }
+    pid = fork ();
+    AssertFatal (0 <= pid, "fork failed");
+    if (0 == pid) {
+      run (layout, num_threads, num_burst, json);
+      fflush (stdout);
+      _exit (0);
+    }
+    waitpid (pid, &status, 0);
+    AssertFatal (WIFEXITED (status) && (0 == WEXITSTATUS (status)), "Layout %s failed", layout2str[layout]);
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  return 0;
+}
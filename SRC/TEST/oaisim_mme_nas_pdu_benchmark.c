@@ -0,0 +1,592 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file oaisim_mme_nas_pdu_benchmark.c
+   \brief Throughput of the uplink NAS PDU path of the MME, from the SCTP receive buffer to the NAS decoder, on a replayed
+   mix of attaches (Attach Request, Authentication Response, Security Mode Complete, Attach Complete), periodic TAUs and
+   Service Requests of one UE (EEA2/EIA2). S1AP PDUs are encoded once, then replayed in one thread through:
+     sctp     the S1AP PDU is received in the SCTP_DATA_IND payload,
+     s1ap     APER decoding of the S1AP PDU and of its IEs (without the XER log of s1ap_mme_decode_pdu()),
+              the NAS-PDU becomes the NAS message of the ITTI message,
+     nas      Initial UE Messages: nas_message_decode() of the NAS message (_emm_as_establish_req()),
+              Uplink NAS Transports: nas_message_decrypt() then nas_message_decode() (_emm_as_data_ind()).
+   The "copy" path is the one with a copy at each step (blk2bstr() of the receive buffer, of the NAS-PDU, bstrcpy() of the
+   NAS message before deciphering), the "zero-copy" path is the one of the MME (the payload is a receive buffer of a
+   bstr_pool.h pool, no copy after it). The median run of each path is reported in
+   messages per second, and the bytes copied per uplink NAS message at each step (counters of nas_pdu_copy.h for the MME).
+   Usage: oaisim_mme_nas_pdu_benchmark [-n messages] [-w warm-up messages] [-r runs] [-a attaches] [-t TAUs] [-s service requests]
+            [-c cpu] [-o /path/to/results.json]
+     -a -t -s are the weights of the procedures in the replayed mix.
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+
+#include "bstrlib.h"
+#include "assertions.h"
+#include "log.h"
+#include "conversions.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "nas_message.h"
+#include "emmData.h"
+#include "NasSecurityAlgorithms.h"
+#include "EpsUpdateType.h"
+#include "bstr_pool.h"
+#include "nas_pdu_copy.h"
+#include "oaisim_mme_test_ue.h"
+
+#define NAS_PDU_BENCHMARK_DEFAULT_MESSAGES   100000
+#define NAS_PDU_BENCHMARK_DEFAULT_WARM_UP     10000
+#define NAS_PDU_BENCHMARK_DEFAULT_RUNS            5
+#define NAS_PDU_BENCHMARK_MAX_RUNS               31
+#define NAS_PDU_BENCHMARK_DEFAULT_ATTACHES        1
+#define NAS_PDU_BENCHMARK_DEFAULT_TAUS            2
+#define NAS_PDU_BENCHMARK_DEFAULT_SERVICES        4
+#define NAS_PDU_BENCHMARK_MAX_WEIGHT             64
+#define NAS_PDU_BENCHMARK_MAX_MIX    (NAS_PDU_BENCHMARK_MAX_WEIGHT * (4 + 1 + 1))
+#define NAS_PDU_BENCHMARK_IMSI    "208930000000001"
+#define NAS_PDU_BENCHMARK_MCC                   208
+#define NAS_PDU_BENCHMARK_MNC                    93
+#define NAS_PDU_BENCHMARK_MNC_LENGTH              2
+#define NAS_PDU_BENCHMARK_TAC                     1
+#define NAS_PDU_BENCHMARK_MACRO_ENB_ID        0x100
+#define NAS_PDU_BENCHMARK_CELL_ID                 1
+
+typedef enum nas_pdu_benchmark_step_e {
+  NAS_PDU_BENCHMARK_SCTP = 0,
+  NAS_PDU_BENCHMARK_S1AP,
+  NAS_PDU_BENCHMARK_NAS,
+  NAS_PDU_BENCHMARK_STEPS
+} nas_pdu_benchmark_step_t;
+
+static const char * const               step_names[NAS_PDU_BENCHMARK_STEPS] = {"sctp", "s1ap", "nas"};
+
+typedef struct nas_pdu_benchmark_pdu_s {
+  const char                *name;
+  bool                       is_initial;       /* Initial UE Message, Uplink NAS Transport otherwise */
+  bool                       is_protected;     /* decoded with the security context of the UE */
+  uint8_t                    message_type;     /* of the plain NAS message */
+  uint8_t                   *s1ap;
+  uint32_t                   length;
+} nas_pdu_benchmark_pdu_t;
+
+typedef struct nas_pdu_benchmark_result_s {
+  double                     ns_per_message;
+  double                     bytes[NAS_PDU_BENCHMARK_STEPS];   /* copied per uplink NAS message */
+} nas_pdu_benchmark_result_t;
+
+static nas_pdu_benchmark_pdu_t          g_pdus[6];
+static const nas_pdu_benchmark_pdu_t   *g_mix[NAS_PDU_BENCHMARK_MAX_MIX];
+static uint32_t                         g_mix_length = 0;
+static emm_security_context_t           g_security;
+static uint64_t                         g_copied[NAS_PDU_BENCHMARK_STEPS];
+static uint8_t                          g_recv_buffer[SCTP_RECV_BUFFER_SIZE];
+static bstr_pool_t                     *g_recv_pool = NULL;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  const uint64_t            x = *(const uint64_t *)a;
+  const uint64_t            y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+//==============================================================================
+// S1AP PDUs of the mix
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void pdu_encode (nas_pdu_benchmark_pdu_t * const pdu_p, uint8_t * const nas, const size_t nas_length)
+{
+  S1ap_TAI_t                tai = {{0}};
+  S1ap_EUTRAN_CGI_t         cgi = {{0}};
+
+  TAC_TO_ASN1 (NAS_PDU_BENCHMARK_TAC, &tai.tAC);
+  MCC_MNC_TO_TBCD (NAS_PDU_BENCHMARK_MCC, NAS_PDU_BENCHMARK_MNC, NAS_PDU_BENCHMARK_MNC_LENGTH, &tai.pLMNidentity);
+  MCC_MNC_TO_TBCD (NAS_PDU_BENCHMARK_MCC, NAS_PDU_BENCHMARK_MNC, NAS_PDU_BENCHMARK_MNC_LENGTH, &cgi.pLMNidentity);
+  MACRO_ENB_ID_TO_CELL_IDENTITY (NAS_PDU_BENCHMARK_MACRO_ENB_ID, NAS_PDU_BENCHMARK_CELL_ID, &cgi.cell_ID);
+  if (pdu_p->is_initial) {
+    S1ap_InitialUEMessageIEs_t ies = {0};
+    S1ap_InitialUEMessage_t    initial_ue_message = {0};
+
+    ies.eNB_UE_S1AP_ID          = 1;
+    ies.nas_pdu.buf             = nas;
+    ies.nas_pdu.size            = nas_length;
+    ies.tai                     = tai;
+    ies.eutran_cgi              = cgi;
+    ies.rrC_Establishment_Cause = S1ap_RRC_Establishment_Cause_mo_Signalling;
+    AssertFatal (s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) >= 0, "Encoding of Initial UE Message IEs failed");
+    AssertFatal (s1ap_generate_initiating_message (&pdu_p->s1ap, &pdu_p->length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+        &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) >= 0, "Encoding of Initial UE Message failed");
+  } else {
+    S1ap_UplinkNASTransportIEs_t ies = {0};
+    S1ap_UplinkNASTransport_t    uplink_nas_transport = {0};
+
+    ies.mme_ue_s1ap_id = 1;
+    ies.eNB_UE_S1AP_ID = 1;
+    ies.nas_pdu.buf    = nas;
+    ies.nas_pdu.size   = nas_length;
+    ies.eutran_cgi     = cgi;
+    ies.tai            = tai;
+    AssertFatal (s1ap_encode_s1ap_uplinknastransporties (&uplink_nas_transport, &ies) >= 0, "Encoding of Uplink NAS Transport IEs failed");
+    AssertFatal (s1ap_generate_initiating_message (&pdu_p->s1ap, &pdu_p->length, S1ap_ProcedureCode_id_uplinkNASTransport, S1ap_Criticality_ignore,
+        &asn_DEF_S1ap_UplinkNASTransport, &uplink_nas_transport) >= 0, "Encoding of Uplink NAS Transport failed");
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &tai);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &cgi);
+}
+
+//------------------------------------------------------------------------------
+// NAS PDUs of the UE, protected ones with the uplink count 1 (the MME security context is reset before each message)
+static void pdus_init (void)
+{
+  test_ue_security_t        ue = {0};
+  const char               *imsi = NAS_PDU_BENCHMARK_IMSI;
+  const size_t              digits = strlen (imsi);
+  const uint8_t             guti[TEST_UE_GUTI_LENGTH] = {0x02, 0xf8, 0x39, 0x00, 0x04, 0x01, 0x01, 0x00, 0x00, 0x00, 0x2a};
+  uint8_t                   plain[TEST_UE_NAS_MAX_LENGTH];
+  uint8_t                   nas[TEST_UE_NAS_MAX_LENGTH];
+  size_t                    length = 0;
+  size_t                    i = 0;
+
+  ue.ksi = 1;
+  ue.eea = NAS_SECURITY_ALGORITHMS_EEA2;
+  for (i = 0; i < AUTH_KNAS_INT_SIZE; i++) {
+    ue.knas_int[i] = (uint8_t)(0x11 * i + 1);
+  }
+  for (i = 0; i < AUTH_KNAS_ENC_SIZE; i++) {
+    ue.knas_enc[i] = (uint8_t)(0x0d * i + 7);
+  }
+  memset (&g_security, 0, sizeof (g_security));
+  g_security.sc_type = SECURITY_CTX_TYPE_FULL_NATIVE;
+  g_security.eksi = ue.ksi;
+  memcpy (g_security.knas_int, ue.knas_int, AUTH_KNAS_INT_SIZE);
+  memcpy (g_security.knas_enc, ue.knas_enc, AUTH_KNAS_ENC_SIZE);
+  g_security.selected_algorithms.encryption = NAS_SECURITY_ALGORITHMS_EEA2;
+  g_security.selected_algorithms.integrity = NAS_SECURITY_ALGORITHMS_EIA2;
+  g_security.activated = 1;
+
+  // IMSI attach with a PDN Connectivity Request
+  length = 0;
+  nas[length++] = (SECURITY_HEADER_TYPE_NOT_PROTECTED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[length++] = ATTACH_REQUEST;
+  nas[length++] = 0x71;                  /* NAS key set identifier 7 (no key available), EPS attach */
+  nas[length++] = (uint8_t)((digits / 2) + 1);
+  nas[length++] = (uint8_t)(((imsi[0] - '0') << 4) | ((digits & 1) << 3) | 0x01 /* IMSI */);
+  for (i = 1; i < digits; i += 2) {
+    nas[length++] = (uint8_t)(((((i + 1) < digits) ? (imsi[i + 1] - '0') : 0x0f) << 4) | (imsi[i] - '0'));
+  }
+  nas[length++] = 2;                     /* UE network capability */
+  nas[length++] = UE_NETWORK_CAPABILITY_EEA0 | UE_NETWORK_CAPABILITY_EEA2;
+  nas[length++] = UE_NETWORK_CAPABILITY_EIA2;
+  nas[length++] = 0;                     /* ESM message container */
+  nas[length++] = 4;
+  nas[length++] = EPS_SESSION_MANAGEMENT_MESSAGE;
+  nas[length++] = 1;                     /* PTI */
+  nas[length++] = PDN_CONNECTIVITY_REQUEST;
+  nas[length++] = 0x11;                  /* PDN type IPv4, initial request */
+  g_pdus[0] = (nas_pdu_benchmark_pdu_t) {"attach request", true, false, ATTACH_REQUEST};
+  pdu_encode (&g_pdus[0], nas, length);
+
+  // Authentication Response, RES of 8 bytes
+  length = 0;
+  nas[length++] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[length++] = AUTHENTICATION_RESPONSE;
+  nas[length++] = 8;
+  for (i = 0; i < 8; i++) {
+    nas[length++] = (uint8_t)(0xa0 + i);
+  }
+  g_pdus[1] = (nas_pdu_benchmark_pdu_t) {"authentication response", false, false, AUTHENTICATION_RESPONSE};
+  pdu_encode (&g_pdus[1], nas, length);
+
+  // Security Mode Complete, ciphered with the new security context
+  plain[0] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  plain[1] = SECURITY_MODE_COMPLETE;
+  ue.ul_count = 1;
+  length = test_ue_nas_protect (&ue, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW, plain, 2, nas);
+  g_pdus[2] = (nas_pdu_benchmark_pdu_t) {"security mode complete", false, true, SECURITY_MODE_COMPLETE};
+  pdu_encode (&g_pdus[2], nas, length);
+
+  // Attach Complete with an Activate Default EPS Bearer Context Accept, ciphered
+  plain[0] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  plain[1] = ATTACH_COMPLETE;
+  plain[2] = 0;
+  plain[3] = 3;
+  plain[4] = (5 << 4) | EPS_SESSION_MANAGEMENT_MESSAGE;
+  plain[5] = 0;
+  plain[6] = ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT;
+  ue.ul_count = 1;
+  length = test_ue_nas_protect (&ue, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, plain, 7, nas);
+  g_pdus[3] = (nas_pdu_benchmark_pdu_t) {"attach complete", false, true, ATTACH_COMPLETE};
+  pdu_encode (&g_pdus[3], nas, length);
+
+  // periodic TAU, initial NAS message integrity protected only
+  plain[0] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  plain[1] = TRACKING_AREA_UPDATE_REQUEST;
+  plain[2] = (ue.ksi << 4) | EPS_UPDATE_TYPE_PERIODIC_UPDATING;
+  plain[3] = TEST_UE_GUTI_LENGTH;
+  memcpy (&plain[4], guti, TEST_UE_GUTI_LENGTH);
+  ue.ul_count = 1;
+  length = test_ue_nas_protect (&ue, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED, plain, 4 + TEST_UE_GUTI_LENGTH, nas);
+  g_pdus[4] = (nas_pdu_benchmark_pdu_t) {"tracking area update request", true, true, TRACKING_AREA_UPDATE_REQUEST};
+  pdu_encode (&g_pdus[4], nas, length);
+
+  ue.ul_count = 1;
+  length = test_ue_nas_encode_service_request (&ue, nas);
+  g_pdus[5] = (nas_pdu_benchmark_pdu_t) {"service request", true, true, SERVICE_REQUEST};
+  pdu_encode (&g_pdus[5], nas, length);
+}
+
+//------------------------------------------------------------------------------
+// Procedures interleaved as evenly as their weights allow
+static bool mix_init (const uint32_t attaches, const uint32_t taus, const uint32_t services)
+{
+  const uint32_t            weights[3] = {attaches, taus, services};
+  uint32_t                  credits[3] = {0, 0, 0};
+  const uint32_t            total = attaches + taus + services;
+  uint32_t                  p = 0;
+  uint32_t                  k = 0;
+  uint32_t                  best = 0;
+
+  if ((0 == total) || (NAS_PDU_BENCHMARK_MAX_WEIGHT < attaches) || (NAS_PDU_BENCHMARK_MAX_WEIGHT < taus) ||
+      (NAS_PDU_BENCHMARK_MAX_WEIGHT < services)) {
+    return false;
+  }
+  g_mix_length = 0;
+  for (p = 0; p < total; p++) {
+    for (k = 0; k < 3; k++) {
+      credits[k] += weights[k];
+    }
+    best = 0;
+    for (k = 1; k < 3; k++) {
+      if (credits[k] > credits[best]) {
+        best = k;
+      }
+    }
+    credits[best] -= total;
+    if (0 == best) {
+      for (k = 0; k < 4; k++) {
+        g_mix[g_mix_length++] = &g_pdus[k];
+      }
+    } else {
+      g_mix[g_mix_length++] = &g_pdus[3 + best];
+    }
+  }
+  return true;
+}
+
+//==============================================================================
+// Uplink NAS PDU path
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void nas_message_free (nas_message_t * const nas_msg_p)
+{
+  switch (nas_msg_p->plain.emm.header.message_type) {
+  case ATTACH_REQUEST:
+    bdestroy (nas_msg_p->plain.emm.attach_request.esmmessagecontainer);
+    break;
+
+  case ATTACH_COMPLETE:
+    bdestroy (nas_msg_p->plain.emm.attach_complete.esmmessagecontainer);
+    break;
+
+  case AUTHENTICATION_RESPONSE:
+    bdestroy (nas_msg_p->plain.emm.authentication_response.authenticationresponseparameter);
+    break;
+
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// returns false if the NAS message is not the one of the PDU
+static bool replay (const nas_pdu_benchmark_pdu_t * const pdu_p, const bool is_zero_copy)
+{
+  S1AP_PDU_t                pdu = {0};
+  S1AP_PDU_t               *pdu_ptr = &pdu;
+  S1ap_InitialUEMessageIEs_t initial_ies = {0};
+  S1ap_UplinkNASTransportIEs_t uplink_ies = {0};
+  S1ap_NAS_PDU_t           *nas_pdu_p = NULL;
+  asn_dec_rval_t            dec_ret = {0};
+  bstring                   payload = NULL;
+  bstring                   nas = NULL;
+  bstring                   copy = NULL;
+  struct tagbstring         plain_msg;
+  nas_message_t             nas_msg = {.security_protected.header = {0}};
+  nas_message_security_header_t header = {0};
+  nas_message_decode_status_t status = {0};
+  emm_security_context_t   *security = (pdu_p->is_protected) ? &g_security : NULL;
+  int                       bytes = 0;
+  int                       rc = 0;
+
+  /*
+   * SCTP, the memcpy stands for sctp_recvmsg()
+   */
+  if (is_zero_copy) {
+    payload = bstr_pool_get (g_recv_pool);
+    AssertFatal (payload != NULL, "No free receive buffer");
+    memcpy (payload->data, pdu_p->s1ap, pdu_p->length);
+    payload->slen = pdu_p->length;
+  } else {
+    memcpy (g_recv_buffer, pdu_p->s1ap, pdu_p->length);
+    payload = blk2bstr (g_recv_buffer, pdu_p->length);
+    g_copied[NAS_PDU_BENCHMARK_SCTP] += pdu_p->length;
+  }
+
+  /*
+   * S1AP
+   */
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_ptr, bdata (payload), blength (payload), 0, 0);
+  AssertFatal (RC_OK == dec_ret.code, "Decoding of the S1AP PDU of the %s failed", pdu_p->name);
+  if (pdu_p->is_initial) {
+    AssertFatal (0 <= s1ap_decode_s1ap_initialuemessageies (&initial_ies, &pdu.choice.initiatingMessage.value), "Decoding of the %s IEs failed", pdu_p->name);
+    nas_pdu_p = &initial_ies.nas_pdu;
+  } else {
+    AssertFatal (0 <= s1ap_decode_s1ap_uplinknastransporties (&uplink_ies, &pdu.choice.initiatingMessage.value), "Decoding of the %s IEs failed", pdu_p->name);
+    nas_pdu_p = &uplink_ies.nas_pdu;
+  }
+  if (is_zero_copy) {
+    nas = s1ap_take_nas_pdu (nas_pdu_p);
+  } else {
+    nas = blk2bstr (nas_pdu_p->buf, nas_pdu_p->size);
+    g_copied[NAS_PDU_BENCHMARK_S1AP] += nas_pdu_p->size;
+  }
+  bstr_pool_release (&payload);
+
+  /*
+   * NAS
+   */
+  nas_pdu_copy_uplink_message ();
+  g_security.ul_count.overflow = 0;
+  g_security.ul_count.seq_num = 0;
+  if (pdu_p->is_initial) {
+    rc = nas_message_decode (nas->data, &nas_msg, blength (nas), security, &status);
+  } else {
+    if (is_zero_copy) {
+      bytes = nas_message_decrypt (nas->data, nas->data, &header, blength (nas), security, &status);
+      bmid2tbstr (plain_msg, nas, blength (nas) - bytes, bytes);
+    } else {
+      copy = bstrcpy (nas);
+      g_copied[NAS_PDU_BENCHMARK_NAS] += blength (nas);
+      bytes = nas_message_decrypt (nas->data, copy->data, &header, blength (nas), security, &status);
+      blk2tbstr (plain_msg, copy->data, bytes);
+    }
+    rc = nas_message_decode (plain_msg.data, &nas_msg, blength (&plain_msg), security, &status);
+    bdestroy (copy);
+  }
+  bdestroy (nas);
+  nas_message_free (&nas_msg);
+
+  /*
+   * The decoded S1AP PDU is not freed by the MME, it is here to replay many messages
+   */
+  if (pdu_p->is_initial) {
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &initial_ies.nas_pdu);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &initial_ies.tai);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &initial_ies.eutran_cgi);
+  } else {
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &uplink_ies.nas_pdu);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &uplink_ies.tai);
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &uplink_ies.eutran_cgi);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1AP_PDU, &pdu);
+
+  return ((0 <= rc) && (pdu_p->message_type == nas_msg.plain.emm.header.message_type) && ((!pdu_p->is_protected) || (status.mac_matched)));
+}
+
+//------------------------------------------------------------------------------
+// median of the runs of num messages, after warm_up messages
+static void measure (const bool is_zero_copy, const uint64_t num, const uint64_t warm_up, const int runs, nas_pdu_benchmark_result_t * const result_p)
+{
+  uint64_t                  ns[NAS_PDU_BENCHMARK_MAX_RUNS];
+  nas_pdu_copy_stats_t      start_stats = {0};
+  nas_pdu_copy_stats_t      end_stats = {0};
+  uint64_t                  start_ns = 0;
+  uint64_t                  m = 0;
+  uint64_t                  i = 0;
+  int                       r = 0;
+
+  for (i = 0; i < warm_up; i++) {
+    replay (g_mix[m], is_zero_copy);
+    m = (m + 1 < g_mix_length) ? m + 1 : 0;
+  }
+  memset (g_copied, 0, sizeof (g_copied));
+  nas_pdu_copy_get_stats (&start_stats);
+  for (r = 0; r < runs; r++) {
+    start_ns = now_ns ();
+    for (i = 0; i < num; i++) {
+      replay (g_mix[m], is_zero_copy);
+      m = (m + 1 < g_mix_length) ? m + 1 : 0;
+    }
+    ns[r] = now_ns () - start_ns;
+  }
+  nas_pdu_copy_get_stats (&end_stats);
+  g_copied[NAS_PDU_BENCHMARK_S1AP] += end_stats.bytes[NAS_PDU_COPY_S1AP] - start_stats.bytes[NAS_PDU_COPY_S1AP];
+  g_copied[NAS_PDU_BENCHMARK_NAS]  += end_stats.bytes[NAS_PDU_COPY_NAS] - start_stats.bytes[NAS_PDU_COPY_NAS];
+  qsort (ns, runs, sizeof (uint64_t), compare_uint64);
+  result_p->ns_per_message = (double)ns[runs / 2] / (double)num;
+  for (i = 0; i < NAS_PDU_BENCHMARK_STEPS; i++) {
+    result_p->bytes[i] = (double)g_copied[i] / (double)(num * runs);
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  uint64_t                  num = NAS_PDU_BENCHMARK_DEFAULT_MESSAGES;
+  uint64_t                  warm_up = NAS_PDU_BENCHMARK_DEFAULT_WARM_UP;
+  int                       runs = NAS_PDU_BENCHMARK_DEFAULT_RUNS;
+  uint32_t                  attaches = NAS_PDU_BENCHMARK_DEFAULT_ATTACHES;
+  uint32_t                  taus = NAS_PDU_BENCHMARK_DEFAULT_TAUS;
+  uint32_t                  services = NAS_PDU_BENCHMARK_DEFAULT_SERVICES;
+  int                       cpu = -1;
+  const char               *output = NULL;
+  FILE                     *json = NULL;
+  cpu_set_t                 cpu_set;
+  nas_pdu_benchmark_result_t results[2];
+  uint32_t                  i = 0;
+  int                       p = 0;
+  int                       c = 0;
+
+  while ((c = getopt (argc, argv, "n:w:r:a:t:s:c:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      num = strtoull (optarg, NULL, 0);
+      break;
+    case 'w':
+      warm_up = strtoull (optarg, NULL, 0);
+      break;
+    case 'r':
+      runs = atoi (optarg);
+      break;
+    case 'a':
+      attaches = strtoul (optarg, NULL, 0);
+      break;
+    case 't':
+      taus = strtoul (optarg, NULL, 0);
+      break;
+    case 's':
+      services = strtoul (optarg, NULL, 0);
+      break;
+    case 'c':
+      cpu = atoi (optarg);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n messages] [-w warm-up messages] [-r runs] [-a attaches] [-t TAUs] [-s service requests] [-c cpu] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((0 == num) || (1 > runs) || (NAS_PDU_BENCHMARK_MAX_RUNS < runs)) {
+    fprintf (stderr, "Invalid number of messages or of runs (1 to %d)\n", NAS_PDU_BENCHMARK_MAX_RUNS);
+    return -1;
+  }
+  if (!mix_init (attaches, taus, services)) {
+    fprintf (stderr, "Invalid weights of the procedures (0 to %d, not all 0)\n", NAS_PDU_BENCHMARK_MAX_WEIGHT);
+    return -1;
+  }
+  if (0 > cpu) {
+    cpu = sched_getcpu ();
+  }
+  CPU_ZERO (&cpu_set);
+  CPU_SET (cpu, &cpu_set);
+  if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set)) {
+    fprintf (stderr, "Could not pin the benchmark on CPU %d\n", cpu);
+    return -1;
+  }
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  g_recv_pool = bstr_pool_create (1, SCTP_RECV_BUFFER_SIZE);
+  AssertFatal (g_recv_pool != NULL, "Could not create the pool of receive buffers");
+  pdus_init ();
+
+  // both paths must decode every message of the mix
+  for (p = 0; p < 2; p++) {
+    for (i = 0; i < sizeof (g_pdus) / sizeof (g_pdus[0]); i++) {
+      if (!replay (&g_pdus[i], (1 == p))) {
+        fprintf (stderr, "The %s path does not decode the %s\n", (1 == p) ? "zero-copy" : "copy", g_pdus[i].name);
+        return -1;
+      }
+    }
+  }
+
+  fprintf (stdout, "%-10s %12s %12s %10s %10s %10s\n", "path", "ns/msg", "msg/s", "sctp B", "s1ap B", "nas B");
+  for (p = 0; p < 2; p++) {
+    measure ((1 == p), num, warm_up, runs, &results[p]);
+    fprintf (stdout, "%-10s %12.1f %12.0f %10.1f %10.1f %10.1f\n", (1 == p) ? "zero-copy" : "copy", results[p].ns_per_message,
+        1e9 / results[p].ns_per_message, results[p].bytes[NAS_PDU_BENCHMARK_SCTP], results[p].bytes[NAS_PDU_BENCHMARK_S1AP],
+        results[p].bytes[NAS_PDU_BENCHMARK_NAS]);
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    if (NULL == json) {
+      fprintf (stderr, "Could not open %s\n", output);
+      return -1;
+    }
+    fprintf (json, "{\"benchmark\": \"nas_pdu\", \"cpu\": %d, \"messages\": %" PRIu64 ", \"warm_up\": %" PRIu64 ", \"runs\": %d, "
+        "\"attaches\": %u, \"taus\": %u, \"service_requests\": %u, \"results\": [\n", cpu, num, warm_up, runs, attaches, taus, services);
+    for (p = 0; p < 2; p++) {
+      fprintf (json, "  {\"path\": \"%s\", \"ns_per_message\": %.1f, \"messages_per_s\": %.0f, \"copied_bytes_per_message\": {",
+          (1 == p) ? "zero-copy" : "copy", results[p].ns_per_message, 1e9 / results[p].ns_per_message);
+      for (i = 0; i < NAS_PDU_BENCHMARK_STEPS; i++) {
+        fprintf (json, "%s\"%s\": %.1f", (i) ? ", " : "", step_names[i], results[p].bytes[i]);
+      }
+      fprintf (json, "}}%s\n", (0 == p) ? "," : "");
+    }
+    fprintf (json, "]}\n");
+    fclose (json);
+  }
+  for (i = 0; i < sizeof (g_pdus) / sizeof (g_pdus[0]); i++) {
+    free (g_pdus[i].s1ap);
+  }
+  bstr_pool_destroy (g_recv_pool);
+  return 0;
+}
@@ -0,0 +1,323 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file oaisim_mme_paging_benchmark.c
+   \brief Cost of the S1AP paging of idle UEs, in one thread, without SCTP and without the other MME tasks.
+   N emulated eNBs in S1AP_READY state are indexed by their TAC (eNB i serves TAC 1 + i mod T), each UE is paged
+   on L consecutive TACs. Reported per phase, as the median of several runs over all UEs:
+   - select: eNBs serving the TAI list of the paging, from the TAI index, deduplicated,
+   - encode: PAGING PDU of the paging, encoded once,
+   - fanout: select, encode once, then one copy of the PDU per eNB as queued to TASK_SCTP (the SCTP send is excluded),
+   - naive:  select, then one encoding per eNB, on a subset of the UEs.
+   Usage: oaisim_mme_paging_benchmark [-u UEs] [-e eNBs] [-t TACs] [-l TAIs per paging] [-r runs] [-c cpu] [-o /path/to/results.json]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "assertions.h"
+#include "log.h"
+#include "common_types.h"
+#include "mme_config.h"
+#include "intertask_interface.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
+
+#define PAGING_BENCHMARK_DEFAULT_UES      100000
+#define PAGING_BENCHMARK_DEFAULT_ENBS       1000
+#define PAGING_BENCHMARK_DEFAULT_TACS        100
+#define PAGING_BENCHMARK_DEFAULT_TAIS          1
+#define PAGING_BENCHMARK_DEFAULT_RUNS          5
+#define PAGING_BENCHMARK_MAX_RUNS             31
+#define PAGING_BENCHMARK_NAIVE_DIVIDER        10   /* naive phase on 1 UE out of 10 */
+
+typedef struct paging_benchmark_result_s {
+  const char                *phase;
+  uint64_t                   pagings;
+  uint64_t                   enbs;             /* eNB messages of the pagings */
+  double                     ns_per_paging;
+} paging_benchmark_result_t;
+
+static itti_s1ap_paging_request_t      *g_pagings = NULL;
+static enb_description_t               *g_enbs[S1AP_PAGING_MAX_ENBS];
+static volatile uint32_t                g_sink = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  const uint64_t            x = *(const uint64_t *)a;
+  const uint64_t            y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+// TAI of TAC tac in PLMN 208.93
+static void tai_init (tai_t * const tai, const tac_t tac)
+{
+  tai->plmn.mcc_digit1 = 2;
+  tai->plmn.mcc_digit2 = 0;
+  tai->plmn.mcc_digit3 = 8;
+  tai->plmn.mnc_digit1 = 9;
+  tai->plmn.mnc_digit2 = 3;
+  tai->plmn.mnc_digit3 = 0x0F;
+  tai->tac = tac;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t phase_select (const uint64_t first, const uint64_t last, const uint64_t step)
+{
+  uint64_t                  enbs = 0;
+
+  for (uint64_t u = first; u < last; u += step) {
+    enbs += s1ap_mme_paging_select_enbs (&g_pagings[u].tai_list, g_enbs, S1AP_PAGING_MAX_ENBS);
+  }
+  return enbs;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t phase_encode (const uint64_t first, const uint64_t last, const uint64_t step)
+{
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+
+  for (uint64_t u = first; u < last; u += step) {
+    AssertFatal (0 <= s1ap_mme_paging_encode (&g_pagings[u], &buffer, &length), "PAGING encoding failed");
+    g_sink ^= buffer[length - 1];
+    free_wrapper ((void**)&buffer);
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+// as s1ap_mme_handle_paging_request, the copies are destroyed instead of being sent
+static uint64_t phase_fanout (const uint64_t first, const uint64_t last, const uint64_t step)
+{
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+  uint64_t                  enbs = 0;
+
+  for (uint64_t u = first; u < last; u += step) {
+    int                     nb_enb = s1ap_mme_paging_select_enbs (&g_pagings[u].tai_list, g_enbs, S1AP_PAGING_MAX_ENBS);
+
+    AssertFatal (0 <= s1ap_mme_paging_encode (&g_pagings[u], &buffer, &length), "PAGING encoding failed");
+    for (int i = 0; i < nb_enb; i++) {
+      bstring               b = blk2bstr (buffer, length);
+
+      g_sink ^= g_enbs[i]->sctp_assoc_id ^ b->data[0];
+      bdestroy (b);
+    }
+    free_wrapper ((void**)&buffer);
+    enbs += nb_enb;
+  }
+  return enbs;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t phase_naive (const uint64_t first, const uint64_t last, const uint64_t step)
+{
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+  uint64_t                  enbs = 0;
+
+  for (uint64_t u = first; u < last; u += step) {
+    int                     nb_enb = s1ap_mme_paging_select_enbs (&g_pagings[u].tai_list, g_enbs, S1AP_PAGING_MAX_ENBS);
+
+    for (int i = 0; i < nb_enb; i++) {
+      AssertFatal (0 <= s1ap_mme_paging_encode (&g_pagings[u], &buffer, &length), "PAGING encoding failed");
+      bstring               b = blk2bstr (buffer, length);
+
+      g_sink ^= g_enbs[i]->sctp_assoc_id ^ b->data[0];
+      bdestroy (b);
+      free_wrapper ((void**)&buffer);
+    }
+    enbs += nb_enb;
+  }
+  return enbs;
+}
+
+//------------------------------------------------------------------------------
+// median of the runs over UEs first, first + step, ... < last
+static void measure (uint64_t (*phase) (const uint64_t, const uint64_t, const uint64_t), const uint64_t nb_ues, const uint64_t step,
+    const int runs, paging_benchmark_result_t * const result)
+{
+  uint64_t                  ns[PAGING_BENCHMARK_MAX_RUNS];
+  uint64_t                  start_ns = 0;
+
+  // warm-up on the first 1% of the UEs
+  phase (0, nb_ues / 100, step);
+  for (int r = 0; r < runs; r++) {
+    start_ns = now_ns ();
+    result->enbs = phase (0, nb_ues, step);
+    ns[r] = now_ns () - start_ns;
+  }
+  qsort (ns, runs, sizeof (uint64_t), compare_uint64);
+  result->pagings = (nb_ues + step - 1) / step;
+  result->ns_per_paging = (double)ns[runs / 2] / (double)result->pagings;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  uint64_t                  nb_ues = PAGING_BENCHMARK_DEFAULT_UES;
+  uint32_t                  nb_enbs = PAGING_BENCHMARK_DEFAULT_ENBS;
+  uint32_t                  nb_tacs = PAGING_BENCHMARK_DEFAULT_TACS;
+  uint32_t                  nb_tais = PAGING_BENCHMARK_DEFAULT_TAIS;
+  int                       runs = PAGING_BENCHMARK_DEFAULT_RUNS;
+  int                       cpu = -1;
+  const char               *output = NULL;
+  FILE                     *json = NULL;
+  cpu_set_t                 cpu_set;
+  paging_benchmark_result_t results[4] = {{"select", 0, 0, 0}, {"encode", 0, 0, 0}, {"fanout", 0, 0, 0}, {"naive", 0, 0, 0}};
+  int                       c = 0;
+
+  while ((c = getopt (argc, argv, "u:e:t:l:r:c:o:")) != -1) {
+    switch (c) {
+    case 'u':
+      nb_ues = strtoull (optarg, NULL, 0);
+      break;
+    case 'e':
+      nb_enbs = strtoul (optarg, NULL, 0);
+      break;
+    case 't':
+      nb_tacs = strtoul (optarg, NULL, 0);
+      break;
+    case 'l':
+      nb_tais = strtoul (optarg, NULL, 0);
+      break;
+    case 'r':
+      runs = atoi (optarg);
+      break;
+    case 'c':
+      cpu = atoi (optarg);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-u UEs] [-e eNBs] [-t TACs] [-l TAIs per paging] [-r runs] [-c cpu] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((100 > nb_ues) || (0 == nb_enbs) || (0 == nb_tacs) || (nb_tacs > 0xFFF0) || (0 == nb_tais) || (TAI_LIST_MAX_SIZE < nb_tais) ||
+      (1 > runs) || (PAGING_BENCHMARK_MAX_RUNS < runs)) {
+    fprintf (stderr, "Invalid parameters: at least 100 UEs, 1 to %d TAIs per paging, 1 to %d runs\n", TAI_LIST_MAX_SIZE, PAGING_BENCHMARK_MAX_RUNS);
+    return -1;
+  }
+  if (0 > cpu) {
+    cpu = sched_getcpu ();
+  }
+  CPU_ZERO (&cpu_set);
+  CPU_SET (cpu, &cpu_set);
+  if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set)) {
+    fprintf (stderr, "Could not pin the benchmark on CPU %d\n", cpu);
+    return -1;
+  }
+
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  mme_config.max_enbs = nb_enbs;
+  mme_config.max_ues = 2;       // UE collections of the eNBs stay empty
+  CHECK_INIT_RETURN (s1ap_mme_paging_init ());
+
+  // eNB i serves TAC 1 + i mod nb_tacs
+  for (uint32_t i = 0; i < nb_enbs; i++) {
+    enb_description_t      *enb_ref = s1ap_new_enb ();
+    tai_t                   tai;
+
+    enb_ref->enb_id = i + 1;
+    enb_ref->sctp_assoc_id = i + 1;
+    enb_ref->s1_state = S1AP_READY;
+    tai_init (&tai, (tac_t)(1 + (i % nb_tacs)));
+    CHECK_INIT_RETURN (s1ap_mme_paging_add_enb (enb_ref, &tai, 1));
+  }
+  // UE u is paged on TACs 1 + (u + k) mod nb_tacs, k < nb_tais
+  g_pagings = calloc (nb_ues, sizeof (itti_s1ap_paging_request_t));
+  AssertFatal (g_pagings != NULL, "Out of memory");
+  for (uint64_t u = 0; u < nb_ues; u++) {
+    g_pagings[u].mme_ue_s1ap_id = (mme_ue_s1ap_id_t)(u + 1);
+    g_pagings[u].mme_code = 1;
+    g_pagings[u].m_tmsi = (tmsi_t)(0xC0000000 | u);
+    g_pagings[u].ue_identity_index = (uint16_t)(u % 1024);
+    g_pagings[u].tai_list.n_tais = nb_tais;
+    for (uint32_t k = 0; k < nb_tais; k++) {
+      tai_init (&g_pagings[u].tai_list.tai[k], (tac_t)(1 + ((u + k) % nb_tacs)));
+    }
+  }
+
+  measure (phase_select, nb_ues, 1, runs, &results[0]);
+  measure (phase_encode, nb_ues, 1, runs, &results[1]);
+  measure (phase_fanout, nb_ues, 1, runs, &results[2]);
+  measure (phase_naive, nb_ues, PAGING_BENCHMARK_NAIVE_DIVIDER, runs, &results[3]);
+
+  if (output) {
+    json = fopen (output, "w");
+    if (NULL == json) {
+      fprintf (stderr, "Could not open %s\n", output);
+      return -1;
+    }
+    fprintf (json, "{\"benchmark\": \"paging\", \"cpu\": %d, \"ues\": %" PRIu64 ", \"enbs\": %u, \"tacs\": %u, \"tais_per_paging\": %u, \"runs\": %d, \"results\": [\n",
+        cpu, nb_ues, nb_enbs, nb_tacs, nb_tais, runs);
+  }
+  fprintf (stdout, "%-8s %10s %12s %14s %14s %12s\n", "phase", "pagings", "eNBs/paging", "ns/paging", "pagings/s", "ns/eNB");
+  for (int k = 0; k < 4; k++) {
+    const paging_benchmark_result_t *r = &results[k];
+    double                  enbs_per_paging = (double)r->enbs / (double)r->pagings;
+    double                  ns_per_enb = (r->enbs) ? r->ns_per_paging / enbs_per_paging : 0;
+
+    fprintf (stdout, "%-8s %10" PRIu64 " %12.1f %14.1f %14.0f %12.1f\n", r->phase, r->pagings, enbs_per_paging, r->ns_per_paging,
+        1e9 / r->ns_per_paging, ns_per_enb);
+    if (json) {
+      fprintf (json, "%s  {\"phase\": \"%s\", \"pagings\": %" PRIu64 ", \"enbs_per_paging\": %.1f, \"ns_per_paging\": %.1f, \"pagings_per_s\": %.0f, \"ns_per_enb\": %.1f}",
+          (k) ? ",\n" : "", r->phase, r->pagings, enbs_per_paging, r->ns_per_paging, 1e9 / r->ns_per_paging, ns_per_enb);
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  s1ap_mme_paging_exit ();
+  free_wrapper ((void**)&g_pagings);
+  return 0;
+}
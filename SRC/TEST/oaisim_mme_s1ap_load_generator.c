@@ -0,0 +1,1267 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_s1ap_load_generator.c
+   \brief S1AP load generator: emulates eNBs and their UEs towards a running MME over SCTP.
+   Each eNB has its own SCTP association and does S1 Setup, then its UEs run a script of procedures:
+     attach   IMSI attach from EMM-DEREGISTERED, ends when Attach Complete is sent,
+     idle     S1 release requested by the eNB (user inactivity), ends on UE Context Release Command,
+     tau      periodic TAU from ECM-IDLE, ends on the S1 release that follows TAU Accept,
+     service  Service Request from ECM-IDLE, ends on Initial Context Setup Request,
+     detach   UE originating detach, ends on UE Context Release Command.
+   UEs run MILENAGE with K and OP (or OPc) of all UEs, so the HSS must be provisioned with IMSIs
+   first_imsi .. first_imsi + eNBs * UEs - 1 and these keys. NAS is protected with EIA2, ciphered with EEA2
+   or not ciphered (EEA0), as selected by the MME.
+   Procedures start at a global rate (optionally increased every second, to find the saturation point of the
+   MME), within a window of outstanding procedures, and a UE waits for a think time between two procedures.
+   A UE that fails or times out a procedure is stopped. A line of statistics is printed every second,
+   latencies of each procedure at the end.
+   Past the saturation of the MME, eNBs receive OVERLOAD START and, as TS 36.413 8.7.6, hold back the
+   RRC connections with an establishment cause the overload action rejects: such a procedure is deferred,
+   not failed, and the UE retries after a backoff. A share of the service requests is mobile terminated
+   (mt-Access, as in a paging response), which is never held back, nor are emergency calls: their latencies
+   should stay bounded while the others are deferred. With -O the eNBs ignore OVERLOAD START, the MME then
+   drops the rejected Initial UE Messages itself and these procedures time out.
+   Usage: oaisim_mme_s1ap_load_generator [-m MME IPv4] [-e eNBs] [-u UEs per eNB] [-I first IMSI]
+            [-M MCC] [-N MNC] [-T TAC] [-k K] [-P OP | -C OPc] [-s script] [-r repetitions]
+            [-d duration s] [-R procedures/s] [-g procedures/s added every second] [-w window]
+            [-i think time ms] [-x procedure timeout s] [-p percent of mt-Access service requests]
+            [-b overload backoff ms] [-O] [-o /path/to/results.json]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+#include <arpa/inet.h>
+
+#include "assertions.h"
+#include "log.h"
+#include "conversions.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "sctp_common.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "EpsUpdateType.h"
+#include "oaisim_mme_test_ue.h"
+
+#define LOAD_DEFAULT_MME_ADDRESS         "127.0.0.1"
+#define LOAD_DEFAULT_ENBS                         1
+#define LOAD_DEFAULT_UES_PER_ENB                100
+#define LOAD_DEFAULT_FIRST_IMSI   "208930000000001"
+#define LOAD_DEFAULT_MCC                      "208"
+#define LOAD_DEFAULT_MNC                       "93"
+#define LOAD_DEFAULT_TAC                          1
+#define LOAD_DEFAULT_K   "8baf473f2f8fd09487cccbd7097c6862"
+#define LOAD_DEFAULT_OP  "1006020f0a478bf6b699f15c062e42b3"   /* OPERATOR_key of ETC/hss.conf */
+#define LOAD_DEFAULT_SCRIPT  "attach,idle,service,idle,tau,detach"
+#define LOAD_DEFAULT_REPETITIONS                  1
+#define LOAD_DEFAULT_WINDOW                    1000
+#define LOAD_DEFAULT_THINK_MS                   100
+#define LOAD_DEFAULT_TIMEOUT_SEC                 10
+#define LOAD_FIRST_MACRO_ENB_ID               0x100
+#define LOAD_CELL_ID                              1
+#define LOAD_ENB_S1U_ADDRESS             0x7f000001   /* 127.0.0.1, no user plane */
+#define LOAD_STREAMS                              2
+#define LOAD_UE_STREAM                            1
+#define LOAD_NAS_MAX_LENGTH          TEST_UE_NAS_MAX_LENGTH
+#define LOAD_SCTP_RECV_BUFFER_SIZE             8192
+#define LOAD_MAX_EVENTS                          64
+#define LOAD_MAX_SCRIPT_STEPS                    32
+#define LOAD_DEFAULT_BACKOFF_MS                1000
+#define LOAD_NO_INITIAL_UE_MESSAGE               -1   /* procedure started on an existing S1 connection */
+
+typedef enum {
+  LOAD_PROC_ATTACH = 0,
+  LOAD_PROC_IDLE,
+  LOAD_PROC_TAU,
+  LOAD_PROC_SERVICE,
+  LOAD_PROC_DETACH,
+  LOAD_PROC_MAX
+} load_proc_t;
+
+typedef enum {
+  LOAD_UE_DEREGISTERED = 0,
+  LOAD_UE_CONNECTED,
+  LOAD_UE_IDLE,
+} load_ue_state_t;
+
+typedef enum {
+  LOAD_ENB_CONNECTING = 0,
+  LOAD_ENB_SETUP,
+  LOAD_ENB_READY,
+  LOAD_ENB_FAILED,
+} load_enb_state_t;
+
+typedef struct load_enb_s {
+  int                        fd;
+  load_enb_state_t           state;
+  uint32_t                   macro_enb_id;
+  uint32_t                   first_ue;
+  S1ap_EUTRAN_CGI_t          cgi;
+  bool                       is_overloaded;    /* OVERLOAD START received, and honoured */
+  long                       overload_action;  /* S1ap_OverloadAction_t */
+} load_enb_t;
+
+typedef struct load_ue_s {
+  char                       imsi[IMSI_BCD_DIGITS_MAX + 1];
+  uint32_t                   enb_index;
+  S1ap_ENB_UE_S1AP_ID_t      enb_ue_s1ap_id;   /* index of the UE in its eNB + 1 */
+  S1ap_MME_UE_S1AP_ID_t      mme_ue_s1ap_id;
+  load_ue_state_t            state;
+  bool                       is_running;       /* a procedure is running */
+  bool                       is_stopped;       /* failed, or all repetitions done */
+  load_proc_t                proc;
+  long                       cause;            /* RRC establishment cause of the next procedure */
+  uint32_t                   script_step;
+  uint32_t                   repetitions;
+  uint64_t                   start_ns;
+  test_ue_security_t         security;
+  bool                       has_guti;
+  uint8_t                    guti[TEST_UE_GUTI_LENGTH];
+} load_ue_t;
+
+typedef struct load_ready_s {
+  uint32_t                   ue_index;
+  uint64_t                   ready_ns;
+} load_ready_t;
+
+typedef struct load_latencies_s {
+  uint64_t                  *ns;
+  uint32_t                   num;
+  uint32_t                   size;
+  uint32_t                   failed;
+  uint32_t                   deferred;
+} load_latencies_t;
+
+typedef struct load_second_s {
+  uint32_t                   second;
+  double                     rate;
+  uint32_t                   started;
+  uint32_t                   completed;
+  uint32_t                   failed;
+  uint32_t                   outstanding;
+  uint32_t                   deferred;
+  uint32_t                   enbs_overloaded;
+  uint64_t                   latency_sum_ns;
+} load_second_t;
+
+typedef struct load_run_s {
+  // configuration
+  const char                *mme_address;
+  uint32_t                   num_enbs;
+  uint32_t                   ues_per_enb;
+  const char                *first_imsi;
+  uint16_t                   mcc;
+  uint16_t                   mnc;
+  uint16_t                   mnc_length;
+  uint16_t                   tac;
+  load_proc_t                script[LOAD_MAX_SCRIPT_STEPS];
+  uint32_t                   script_length;
+  uint32_t                   repetitions;
+  uint32_t                   duration_sec;
+  double                     rate;
+  double                     rate_step;
+  uint32_t                   window;
+  uint64_t                   think_ns;
+  uint64_t                   timeout_ns;
+  uint32_t                   mt_percent;
+  uint64_t                   backoff_ns;
+  bool                       ignore_overload;
+  const char                *output;
+  // state
+  test_usim_t                usim;             /* K and OPc of all UEs */
+  S1ap_TAI_t                 tai;
+  load_enb_t                *enbs;
+  load_ue_t                 *ues;
+  uint32_t                   num_ues;
+  load_ready_t              *ready;            /* FIFO of UEs waiting for their next procedure */
+  uint32_t                   ready_head;
+  uint32_t                   ready_num;
+  load_ready_t              *deferred;         /* FIFO of UEs held back by an overloaded eNB */
+  uint32_t                   deferred_head;
+  uint32_t                   deferred_num;
+  uint32_t                   num_services;
+  uint32_t                   num_enbs_overloaded;
+  uint32_t                   num_overload_start;
+  uint32_t                   num_overload_stop;
+  double                     tokens;
+  uint32_t                   outstanding;
+  uint32_t                   num_stopped;
+  uint32_t                   num_enbs_failed;
+  load_latencies_t           latencies[LOAD_PROC_MAX];
+  load_second_t              current;
+  load_second_t             *seconds;
+  uint32_t                   num_seconds;
+  uint64_t                   start_ns;
+  uint64_t                   last_tick_ns;
+  uint64_t                   next_second_ns;
+  volatile sig_atomic_t      is_running;
+} load_run_t;
+
+static const char * const   proc2str[LOAD_PROC_MAX] = {"attach", "idle", "tau", "service", "detach"};
+static load_run_t           g_load;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  uint64_t  va = *(const uint64_t *)a;
+  uint64_t  vb = *(const uint64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t percentile (const uint64_t * const sorted, const uint64_t num, const double p)
+{
+  uint64_t  index = (uint64_t)(p * (double)num);
+
+  return (num) ? sorted[(index >= num) ? num - 1 : index] : 0;
+}
+
+//------------------------------------------------------------------------------
+static void sigint_handler (__attribute__ ((unused)) int signal_number)
+{
+  g_load.is_running = false;
+}
+
+//==============================================================================
+// NAS of the UEs
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// IMSI attach, EEA0/EEA2 and EIA2, with a PDN Connectivity Request for the default APN
+static size_t ue_nas_encode_attach_request (const load_ue_t * const ue_p, uint8_t * const nas)
+{
+  size_t    digits = strlen (ue_p->imsi);
+  size_t    length = 0;
+  size_t    i = 0;
+
+  nas[length++] = (SECURITY_HEADER_TYPE_NOT_PROTECTED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[length++] = ATTACH_REQUEST;
+  nas[length++] = 0x71;                  /* NAS key set identifier 7 (no key available), EPS attach */
+  nas[length++] = (uint8_t)((digits / 2) + 1);
+  nas[length++] = (uint8_t)(((ue_p->imsi[0] - '0') << 4) | ((digits & 1) << 3) | 0x01 /* IMSI */);
+  for (i = 1; i < digits; i += 2) {
+    nas[length++] = (uint8_t)(((((i + 1) < digits) ? (ue_p->imsi[i + 1] - '0') : 0x0f) << 4) | (ue_p->imsi[i] - '0'));
+  }
+  nas[length++] = 2;                     /* UE network capability */
+  nas[length++] = UE_NETWORK_CAPABILITY_EEA0 | UE_NETWORK_CAPABILITY_EEA2;
+  nas[length++] = UE_NETWORK_CAPABILITY_EIA2;
+  nas[length++] = 0;                     /* ESM message container */
+  nas[length++] = 4;
+  nas[length++] = EPS_SESSION_MANAGEMENT_MESSAGE;
+  nas[length++] = 1;                     /* PTI */
+  nas[length++] = PDN_CONNECTIVITY_REQUEST;
+  nas[length++] = 0x11;                  /* PDN type IPv4, initial request */
+  return length;
+}
+
+//------------------------------------------------------------------------------
+// Attach Accept, keeps the GUTI, returns the length of the Attach Complete
+static size_t ue_nas_attach_complete (load_ue_t * const ue_p, const uint8_t * const plain, const size_t plain_length, const uint8_t ebi, uint8_t * const nas)
+{
+  const uint8_t             complete[] = {EPS_MOBILITY_MANAGEMENT_MESSAGE, ATTACH_COMPLETE, 0, 3,
+                                          (uint8_t)((ebi << 4) | EPS_SESSION_MANAGEMENT_MESSAGE), 0, ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT};
+
+  ue_p->has_guti = test_ue_nas_decode_attach_accept_guti (plain, plain_length, ue_p->guti);
+  return test_ue_nas_protect (&ue_p->security, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED, complete, sizeof (complete), nas);
+}
+
+//------------------------------------------------------------------------------
+static size_t ue_nas_encode_tracking_area_update_request (load_ue_t * const ue_p, uint8_t * const nas)
+{
+  uint8_t                   plain[3 + 1 + TEST_UE_GUTI_LENGTH];
+
+  plain[0] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  plain[1] = TRACKING_AREA_UPDATE_REQUEST;
+  plain[2] = (ue_p->security.ksi << 4) | EPS_UPDATE_TYPE_PERIODIC_UPDATING;
+  plain[3] = TEST_UE_GUTI_LENGTH;
+  memcpy (&plain[4], ue_p->guti, TEST_UE_GUTI_LENGTH);
+  // initial NAS message, not ciphered
+  return test_ue_nas_protect (&ue_p->security, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED, plain, sizeof (plain), nas);
+}
+
+//------------------------------------------------------------------------------
+static size_t ue_nas_encode_detach_request (load_ue_t * const ue_p, uint8_t * const nas)
+{
+  uint8_t                   plain[3 + 1 + TEST_UE_GUTI_LENGTH];
+
+  plain[0] = EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  plain[1] = DETACH_REQUEST;
+  plain[2] = (ue_p->security.ksi << 4) | 0x01;    /* normal detach, EPS detach */
+  plain[3] = TEST_UE_GUTI_LENGTH;
+  memcpy (&plain[4], ue_p->guti, TEST_UE_GUTI_LENGTH);
+  return test_ue_nas_protect (&ue_p->security, (LOAD_UE_CONNECTED == ue_p->state) ? SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED : SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED,
+      plain, sizeof (plain), nas);
+}
+
+//==============================================================================
+// S1AP of the eNBs
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void enb_send (const uint32_t enb_index, const sctp_stream_id_t stream, uint8_t * const buffer, const uint32_t length)
+{
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+
+  if ((LOAD_ENB_FAILED != enb_p->state) &&
+      (0 > sctp_sendmsg (enb_p->fd, buffer, length, NULL, 0, htonl (S1AP_SCTP_PPID), 0, stream, 0, 0))) {
+    fprintf (stderr, "eNB %u: sctp_sendmsg failed: %s\n", enb_index, strerror (errno));
+  }
+  free (buffer);
+}
+
+//------------------------------------------------------------------------------
+static void enb_send_s1_setup_request (const uint32_t enb_index)
+{
+  S1ap_S1SetupRequestIEs_t  ies = {0};
+  S1ap_S1SetupRequest_t     s1_setup_request = {0};
+  S1ap_SupportedTAs_Item_t *ta_p = calloc (1, sizeof (S1ap_SupportedTAs_Item_t));
+  S1ap_PLMNidentity_t      *plmn_p = calloc (1, sizeof (S1ap_PLMNidentity_t));
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+
+  MCC_MNC_TO_PLMNID (g_load.mcc, g_load.mnc, g_load.mnc_length, &ies.global_ENB_ID.pLMNidentity);
+  ies.global_ENB_ID.eNB_ID.present = S1ap_ENB_ID_PR_macroENB_ID;
+  MACRO_ENB_ID_TO_BIT_STRING (g_load.enbs[enb_index].macro_enb_id, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+  TAC_TO_ASN1 (g_load.tac, &ta_p->tAC);
+  MCC_MNC_TO_TBCD (g_load.mcc, g_load.mnc, g_load.mnc_length, plmn_p);
+  ASN_SEQUENCE_ADD (&ta_p->broadcastPLMNs.list, plmn_p);
+  ASN_SEQUENCE_ADD (&ies.supportedTAs.list, ta_p);
+  ies.defaultPagingDRX = S1ap_PagingDRX_v64;
+  AssertFatal (s1ap_encode_s1ap_s1setuprequesties (&s1_setup_request, &ies) >= 0, "Encoding of S1 Setup Request IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_S1Setup, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_S1SetupRequest, &s1_setup_request) >= 0, "Encoding of S1 Setup Request failed");
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_Global_ENB_ID, &ies.global_ENB_ID);
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_SupportedTAs, &ies.supportedTAs);
+  g_load.enbs[enb_index].state = LOAD_ENB_SETUP;
+  enb_send (enb_index, 0, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+// S-TMSI is present for procedures from ECM-IDLE
+static void ue_send_initial_ue_message (load_ue_t * const ue_p, uint8_t * const nas, const size_t nas_length, const S1ap_RRC_Establishment_Cause_t cause)
+{
+  S1ap_InitialUEMessageIEs_t ies = {0};
+  S1ap_InitialUEMessage_t    initial_ue_message = {0};
+  uint8_t                   *buffer = NULL;
+  uint32_t                   length = 0;
+
+  ies.eNB_UE_S1AP_ID          = ue_p->enb_ue_s1ap_id;
+  ies.nas_pdu.buf             = nas;
+  ies.nas_pdu.size            = nas_length;
+  ies.tai                     = g_load.tai;
+  ies.eutran_cgi              = g_load.enbs[ue_p->enb_index].cgi;
+  ies.rrC_Establishment_Cause = cause;
+  if (LOAD_UE_IDLE == ue_p->state) {
+    ies.presenceMask |= S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT;
+    MME_CODE_TO_OCTET_STRING (ue_p->guti[6], &ies.s_tmsi.mMEC);
+    M_TMSI_TO_OCTET_STRING ((ue_p->guti[7] << 24) | (ue_p->guti[8] << 16) | (ue_p->guti[9] << 8) | ue_p->guti[10], &ies.s_tmsi.m_TMSI);
+  }
+  AssertFatal (s1ap_encode_s1ap_initialuemessageies (&initial_ue_message, &ies) >= 0, "Encoding of Initial UE Message IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_initialUEMessage, S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_InitialUEMessage, &initial_ue_message) >= 0, "Encoding of Initial UE Message failed");
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_S_TMSI, &ies.s_tmsi);
+  ue_p->state = LOAD_UE_CONNECTED;
+  enb_send (ue_p->enb_index, LOAD_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_uplink_nas (const load_ue_t * const ue_p, uint8_t * const nas, const size_t nas_length)
+{
+  S1ap_UplinkNASTransportIEs_t ies = {0};
+  S1ap_UplinkNASTransport_t    uplink_nas_transport = {0};
+  uint8_t                     *buffer = NULL;
+  uint32_t                     length = 0;
+
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_p->enb_ue_s1ap_id;
+  ies.nas_pdu.buf    = nas;
+  ies.nas_pdu.size   = nas_length;
+  ies.eutran_cgi     = g_load.enbs[ue_p->enb_index].cgi;
+  ies.tai            = g_load.tai;
+  AssertFatal (s1ap_encode_s1ap_uplinknastransporties (&uplink_nas_transport, &ies) >= 0, "Encoding of Uplink NAS Transport IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_uplinkNASTransport, S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UplinkNASTransport, &uplink_nas_transport) >= 0, "Encoding of Uplink NAS Transport failed");
+  enb_send (ue_p->enb_index, LOAD_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_initial_context_setup_response (const load_ue_t * const ue_p, const S1ap_E_RABSetupItemCtxtSUReq_t * const e_rab_req_p)
+{
+  S1ap_InitialContextSetupResponseIEs_t ies = {0};
+  S1ap_InitialContextSetupResponse_t    initial_context_setup_response = {0};
+  S1ap_E_RABSetupItemCtxtSURes_t       *e_rab_p = calloc (1, sizeof (S1ap_E_RABSetupItemCtxtSURes_t));
+  uint32_t                              enb_s1u_address = htonl (LOAD_ENB_S1U_ADDRESS);
+  uint8_t                              *buffer = NULL;
+  uint32_t                              length = 0;
+
+  e_rab_p->e_RAB_ID = e_rab_req_p->e_RAB_ID;
+  e_rab_p->transportLayerAddress.buf = calloc (4, sizeof (uint8_t));
+  memcpy (e_rab_p->transportLayerAddress.buf, &enb_s1u_address, 4);
+  e_rab_p->transportLayerAddress.size = 4;
+  e_rab_p->transportLayerAddress.bits_unused = 0;
+  GTP_TEID_TO_ASN1 ((uint32_t)(ue_p - g_load.ues) + 1, &e_rab_p->gTP_TEID);
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_p->enb_ue_s1ap_id;
+  ASN_SEQUENCE_ADD (&ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes, e_rab_p);
+  AssertFatal (s1ap_encode_s1ap_initialcontextsetupresponseies (&initial_context_setup_response, &ies) >= 0,
+      "Encoding of Initial Context Setup Response IEs failed");
+  AssertFatal (s1ap_generate_successfull_outcome (&buffer, &length, S1ap_ProcedureCode_id_InitialContextSetup, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_InitialContextSetupResponse, &initial_context_setup_response) >= 0, "Encoding of Initial Context Setup Response failed");
+  ASN_STRUCT_FREE (asn_DEF_S1ap_E_RABSetupItemCtxtSURes, e_rab_p);
+  asn_sequence_empty (&ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes);
+  enb_send (ue_p->enb_index, LOAD_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_ue_context_release_request (const load_ue_t * const ue_p)
+{
+  S1ap_UEContextReleaseRequestIEs_t ies = {0};
+  S1ap_UEContextReleaseRequest_t    ue_context_release_request = {0};
+  uint8_t                          *buffer = NULL;
+  uint32_t                          length = 0;
+
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_p->enb_ue_s1ap_id;
+  ies.cause.present = S1ap_Cause_PR_radioNetwork;
+  ies.cause.choice.radioNetwork = S1ap_CauseRadioNetwork_user_inactivity;
+  AssertFatal (s1ap_encode_s1ap_uecontextreleaserequesties (&ue_context_release_request, &ies) >= 0,
+      "Encoding of UE Context Release Request IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_UEContextReleaseRequest, S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UEContextReleaseRequest, &ue_context_release_request) >= 0, "Encoding of UE Context Release Request failed");
+  enb_send (ue_p->enb_index, LOAD_UE_STREAM, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+static void ue_send_ue_context_release_complete (const load_ue_t * const ue_p)
+{
+  S1ap_UEContextReleaseCompleteIEs_t ies = {0};
+  S1ap_UEContextReleaseComplete_t    ue_context_release_complete = {0};
+  uint8_t                           *buffer = NULL;
+  uint32_t                           length = 0;
+
+  ies.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = ue_p->enb_ue_s1ap_id;
+  AssertFatal (s1ap_encode_s1ap_uecontextreleasecompleteies (&ue_context_release_complete, &ies) >= 0,
+      "Encoding of UE Context Release Complete IEs failed");
+  AssertFatal (s1ap_generate_successfull_outcome (&buffer, &length, S1ap_ProcedureCode_id_UEContextRelease, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_UEContextReleaseComplete, &ue_context_release_complete) >= 0, "Encoding of UE Context Release Complete failed");
+  enb_send (ue_p->enb_index, LOAD_UE_STREAM, buffer, length);
+}
+
+//==============================================================================
+// Procedures of the UEs
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void load_ready (const uint32_t ue_index, const uint64_t ready_ns)
+{
+  load_ready_t             *ready_p = &g_load.ready[(g_load.ready_head + g_load.ready_num) % g_load.num_ues];
+
+  ready_p->ue_index = ue_index;
+  ready_p->ready_ns = ready_ns;
+  g_load.ready_num++;
+}
+
+//------------------------------------------------------------------------------
+static void load_record (const load_proc_t proc, const uint64_t latency_ns)
+{
+  load_latencies_t         *latencies_p = &g_load.latencies[proc];
+
+  if (latencies_p->num == latencies_p->size) {
+    latencies_p->size = (latencies_p->size) ? 2 * latencies_p->size : 1024;
+    latencies_p->ns = realloc (latencies_p->ns, latencies_p->size * sizeof (uint64_t));
+    AssertFatal (NULL != latencies_p->ns, "Allocation of latencies failed");
+  }
+  latencies_p->ns[latencies_p->num++] = latency_ns;
+}
+
+//------------------------------------------------------------------------------
+static void ue_end_procedure (load_ue_t * const ue_p, const bool is_success, const char * const reason)
+{
+  uint64_t                  now = now_ns ();
+
+  if (!ue_p->is_running) {
+    return;
+  }
+  ue_p->is_running = false;
+  g_load.outstanding--;
+  if (!is_success) {
+    fprintf (stderr, "IMSI %s: %s failed: %s\n", ue_p->imsi, proc2str[ue_p->proc], reason);
+    g_load.latencies[ue_p->proc].failed++;
+    g_load.current.failed++;
+    ue_p->is_stopped = true;
+    g_load.num_stopped++;
+    return;
+  }
+  load_record (ue_p->proc, now - ue_p->start_ns);
+  g_load.current.completed++;
+  g_load.current.latency_sum_ns += now - ue_p->start_ns;
+  if (++ue_p->script_step == g_load.script_length) {
+    ue_p->script_step = 0;
+    if (++ue_p->repetitions == g_load.repetitions) {
+      ue_p->is_stopped = true;
+      g_load.num_stopped++;
+      return;
+    }
+  }
+  load_ready ((uint32_t)(ue_p - g_load.ues), now + g_load.think_ns);
+}
+
+//------------------------------------------------------------------------------
+// RRC establishment cause of the Initial UE Message starting the next procedure of a UE
+static long ue_select_cause (const load_ue_t * const ue_p)
+{
+  switch (g_load.script[ue_p->script_step]) {
+  case LOAD_PROC_ATTACH:
+  case LOAD_PROC_TAU:
+    return S1ap_RRC_Establishment_Cause_mo_Signalling;
+
+  case LOAD_PROC_SERVICE:
+    // mt_percent of the service requests answer a paging
+    return ((g_load.num_services++ % 100) < g_load.mt_percent) ? S1ap_RRC_Establishment_Cause_mt_Access : S1ap_RRC_Establishment_Cause_mo_Data;
+
+  case LOAD_PROC_DETACH:
+    return (LOAD_UE_CONNECTED == ue_p->state) ? LOAD_NO_INITIAL_UE_MESSAGE : S1ap_RRC_Establishment_Cause_mo_Signalling;
+
+  default:
+    return LOAD_NO_INITIAL_UE_MESSAGE;
+  }
+}
+
+//------------------------------------------------------------------------------
+// RRC connections an eNB accepts under an overload action, TS 36.413 8.7.6
+static bool enb_is_admitted (const long action, const long cause)
+{
+  if ((S1ap_RRC_Establishment_Cause_emergency == cause) || (S1ap_RRC_Establishment_Cause_mt_Access == cause)) {
+    return true;
+  }
+  switch (action) {
+  case S1ap_OverloadAction_reject_non_emergency_mo_dt:
+    return (S1ap_RRC_Establishment_Cause_mo_Data != cause) && (S1ap_RRC_Establishment_Cause_delay_TolerantAccess != cause);
+
+  case S1ap_OverloadAction_reject_rrc_cr_signalling:
+    return (S1ap_RRC_Establishment_Cause_mo_Data != cause) && (S1ap_RRC_Establishment_Cause_mo_Signalling != cause) &&
+      (S1ap_RRC_Establishment_Cause_delay_TolerantAccess != cause);
+
+  case S1ap_OverloadAction_permit_high_priority_sessions_and_mobile_terminated_services_only:
+    return S1ap_RRC_Establishment_Cause_highPriorityAccess == cause;
+
+  case S1ap_OverloadAction_reject_delay_tolerant_access:
+    return S1ap_RRC_Establishment_Cause_delay_TolerantAccess != cause;
+
+  default:
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// The eNB of the UE is overloaded and holds back the RRC connection, the UE retries after the backoff
+static bool ue_defer_procedure (load_ue_t * const ue_p, const uint64_t now)
+{
+  load_enb_t               *enb_p = &g_load.enbs[ue_p->enb_index];
+  load_ready_t             *deferred_p = NULL;
+
+  ue_p->cause = ue_select_cause (ue_p);
+  if ((!enb_p->is_overloaded) || (LOAD_NO_INITIAL_UE_MESSAGE == ue_p->cause) || (enb_is_admitted (enb_p->overload_action, ue_p->cause))) {
+    return false;
+  }
+  g_load.latencies[g_load.script[ue_p->script_step]].deferred++;
+  g_load.current.deferred++;
+  deferred_p = &g_load.deferred[(g_load.deferred_head + g_load.deferred_num) % g_load.num_ues];
+  deferred_p->ue_index = (uint32_t)(ue_p - g_load.ues);
+  deferred_p->ready_ns = now + g_load.backoff_ns;
+  g_load.deferred_num++;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void ue_start_procedure (load_ue_t * const ue_p, const uint64_t now)
+{
+  uint8_t                   nas[LOAD_NAS_MAX_LENGTH];
+
+  ue_p->proc = g_load.script[ue_p->script_step];
+  ue_p->is_running = true;
+  ue_p->start_ns = now;
+  g_load.outstanding++;
+  g_load.current.started++;
+  switch (ue_p->proc) {
+  case LOAD_PROC_ATTACH:
+    ue_send_initial_ue_message (ue_p, nas, ue_nas_encode_attach_request (ue_p, nas), ue_p->cause);
+    break;
+
+  case LOAD_PROC_IDLE:
+    ue_send_ue_context_release_request (ue_p);
+    break;
+
+  case LOAD_PROC_TAU:
+    ue_send_initial_ue_message (ue_p, nas, ue_nas_encode_tracking_area_update_request (ue_p, nas), ue_p->cause);
+    break;
+
+  case LOAD_PROC_SERVICE:
+    ue_send_initial_ue_message (ue_p, nas, test_ue_nas_encode_service_request (&ue_p->security, nas), ue_p->cause);
+    break;
+
+  case LOAD_PROC_DETACH:
+    if (LOAD_UE_CONNECTED == ue_p->state) {
+      ue_send_uplink_nas (ue_p, nas, ue_nas_encode_detach_request (ue_p, nas));
+    } else {
+      ue_send_initial_ue_message (ue_p, nas, ue_nas_encode_detach_request (ue_p, nas), ue_p->cause);
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+static load_ue_t *enb_find_ue (const uint32_t enb_index, const S1ap_ENB_UE_S1AP_ID_t enb_ue_s1ap_id)
+{
+  if ((1 > enb_ue_s1ap_id) || (g_load.ues_per_enb < enb_ue_s1ap_id)) {
+    return NULL;
+  }
+  return &g_load.ues[g_load.enbs[enb_index].first_ue + enb_ue_s1ap_id - 1];
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_downlink_nas_transport (const uint32_t enb_index, ANY_t * const value)
+{
+  S1ap_DownlinkNASTransportIEs_t ies = {0};
+  load_ue_t                     *ue_p = NULL;
+  uint8_t                        nas[LOAD_NAS_MAX_LENGTH];
+  uint8_t                       *plain = NULL;
+  size_t                         plain_length = 0;
+  size_t                         length = 0;
+
+  if ((0 > s1ap_decode_s1ap_downlinknastransporties (&ies, value)) || (NULL == (ue_p = enb_find_ue (enb_index, ies.eNB_UE_S1AP_ID)))) {
+    return;
+  }
+  ue_p->mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+  plain = test_ue_nas_unprotect (&ue_p->security, ies.nas_pdu.buf, ies.nas_pdu.size, &plain_length);
+  if (NULL == plain) {
+    ue_end_procedure (ue_p, false, "unreadable downlink NAS PDU");
+  } else {
+    switch (plain[1]) {
+    case AUTHENTICATION_REQUEST:
+      if (0 == (length = test_ue_authenticate (&g_load.usim, &ue_p->security, plain, plain_length, nas))) {
+        ue_end_procedure (ue_p, false, "MAC failure, check K and OP");
+      } else {
+        ue_send_uplink_nas (ue_p, nas, length);
+      }
+      break;
+
+    case SECURITY_MODE_COMMAND:
+      if (0 == (length = test_ue_security_mode (&ue_p->security, plain, plain_length, nas))) {
+        ue_end_procedure (ue_p, false, "NAS security algorithms not supported");
+      } else {
+        ue_send_uplink_nas (ue_p, nas, length);
+      }
+      break;
+
+    case TRACKING_AREA_UPDATE_ACCEPT:
+      // the eNB releases the UE if the MME does not
+      ue_send_ue_context_release_request (ue_p);
+      break;
+
+    case DETACH_ACCEPT:
+    case EMM_INFORMATION:
+      break;
+
+    default:
+      ue_end_procedure (ue_p, false, "unexpected downlink NAS message");
+      break;
+    }
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, &ies.nas_pdu);
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_initial_context_setup_request (const uint32_t enb_index, ANY_t * const value)
+{
+  S1ap_InitialContextSetupRequestIEs_t ies = {0};
+  S1ap_E_RABToBeSetupItemCtxtSUReq_t  *e_rab_p = NULL;
+  load_ue_t                           *ue_p = NULL;
+  uint8_t                              nas[LOAD_NAS_MAX_LENGTH];
+  uint8_t                             *plain = NULL;
+  size_t                               plain_length = 0;
+
+  if ((0 > s1ap_decode_s1ap_initialcontextsetuprequesties (&ies, value)) || (NULL == (ue_p = enb_find_ue (enb_index, ies.eNB_UE_S1AP_ID)))) {
+    return;
+  }
+  ue_p->mme_ue_s1ap_id = ies.mme_ue_s1ap_id;
+  if (0 == ies.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.count) {
+    ue_end_procedure (ue_p, false, "no E-RAB to be setup");
+    return;
+  }
+  e_rab_p = ies.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.array[0];
+  ue_send_initial_context_setup_response (ue_p, e_rab_p);
+  if ((LOAD_PROC_ATTACH == ue_p->proc) && (e_rab_p->nAS_PDU)) {
+    plain = test_ue_nas_unprotect (&ue_p->security, e_rab_p->nAS_PDU->buf, e_rab_p->nAS_PDU->size, &plain_length);
+    if ((NULL == plain) || (ATTACH_ACCEPT != plain[1])) {
+      ue_end_procedure (ue_p, false, "no Attach Accept");
+      return;
+    }
+    ue_send_uplink_nas (ue_p, nas, ue_nas_attach_complete (ue_p, plain, plain_length, e_rab_p->e_RAB_ID, nas));
+    if (!ue_p->has_guti) {
+      ue_end_procedure (ue_p, false, "no GUTI in Attach Accept");
+      return;
+    }
+  }
+  if ((LOAD_PROC_ATTACH == ue_p->proc) || (LOAD_PROC_SERVICE == ue_p->proc)) {
+    ue_end_procedure (ue_p, true, NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_ue_context_release_command (const uint32_t enb_index, ANY_t * const value)
+{
+  S1ap_UEContextReleaseCommandIEs_t ies = {0};
+  load_ue_t                        *ue_p = NULL;
+  uint32_t                          i = 0;
+
+  if (0 > s1ap_decode_s1ap_uecontextreleasecommandies (&ies, value)) {
+    return;
+  }
+  if (S1ap_UE_S1AP_IDs_PR_uE_S1AP_ID_pair == ies.uE_S1AP_IDs.present) {
+    ue_p = enb_find_ue (enb_index, ies.uE_S1AP_IDs.choice.uE_S1AP_ID_pair.eNB_UE_S1AP_ID);
+  } else {
+    for (i = 0; i < g_load.ues_per_enb; i++) {
+      if ((LOAD_UE_CONNECTED == g_load.ues[g_load.enbs[enb_index].first_ue + i].state) &&
+          (ies.uE_S1AP_IDs.choice.mME_UE_S1AP_ID == g_load.ues[g_load.enbs[enb_index].first_ue + i].mme_ue_s1ap_id)) {
+        ue_p = &g_load.ues[g_load.enbs[enb_index].first_ue + i];
+        break;
+      }
+    }
+  }
+  if (NULL == ue_p) {
+    return;
+  }
+  ue_send_ue_context_release_complete (ue_p);
+  ue_p->state = (LOAD_PROC_DETACH == ue_p->proc) ? LOAD_UE_DEREGISTERED : LOAD_UE_IDLE;
+  if ((LOAD_PROC_IDLE == ue_p->proc) || (LOAD_PROC_TAU == ue_p->proc) || (LOAD_PROC_DETACH == ue_p->proc)) {
+    ue_end_procedure (ue_p, true, NULL);
+  } else {
+    ue_end_procedure (ue_p, false, "released by the MME");
+  }
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_overload_start (const uint32_t enb_index, ANY_t * const value)
+{
+  S1ap_OverloadStartIEs_t   ies = {0};
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+
+  if (0 > s1ap_decode_s1ap_overloadstarties (&ies, value)) {
+    return;
+  }
+  g_load.num_overload_start++;
+  if ((!g_load.ignore_overload) && (S1ap_OverloadResponse_PR_overloadAction == ies.overloadResponse.present)) {
+    if (!enb_p->is_overloaded) {
+      g_load.num_enbs_overloaded++;
+    }
+    enb_p->is_overloaded = true;
+    enb_p->overload_action = ies.overloadResponse.choice.overloadAction;
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_GUMMEIList, &ies.gummeiList);
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_overload_stop (const uint32_t enb_index)
+{
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+
+  g_load.num_overload_stop++;
+  if (enb_p->is_overloaded) {
+    g_load.num_enbs_overloaded--;
+  }
+  enb_p->is_overloaded = false;
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_s1ap (const uint32_t enb_index, const uint8_t * const buffer, const size_t length)
+{
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+  S1AP_PDU_t               *pdu_p = NULL;
+  asn_dec_rval_t            dec_ret = {0};
+  uint32_t                  i = 0;
+
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, buffer, length, 0, 0);
+  if (RC_OK != dec_ret.code) {
+    fprintf (stderr, "eNB %u: decoding of S1AP PDU failed\n", enb_index);
+    ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+    return;
+  }
+  switch (pdu_p->present) {
+  case S1AP_PDU_PR_initiatingMessage:
+    switch (pdu_p->choice.initiatingMessage.procedureCode) {
+    case S1ap_ProcedureCode_id_downlinkNASTransport:
+      enb_handle_downlink_nas_transport (enb_index, &pdu_p->choice.initiatingMessage.value);
+      break;
+
+    case S1ap_ProcedureCode_id_InitialContextSetup:
+      enb_handle_initial_context_setup_request (enb_index, &pdu_p->choice.initiatingMessage.value);
+      break;
+
+    case S1ap_ProcedureCode_id_UEContextRelease:
+      enb_handle_ue_context_release_command (enb_index, &pdu_p->choice.initiatingMessage.value);
+      break;
+
+    case S1ap_ProcedureCode_id_OverloadStart:
+      enb_handle_overload_start (enb_index, &pdu_p->choice.initiatingMessage.value);
+      break;
+
+    case S1ap_ProcedureCode_id_OverloadStop:
+      enb_handle_overload_stop (enb_index);
+      break;
+
+    default:
+      break;
+    }
+    break;
+
+  case S1AP_PDU_PR_successfulOutcome:
+    if ((S1ap_ProcedureCode_id_S1Setup == pdu_p->choice.successfulOutcome.procedureCode) && (LOAD_ENB_SETUP == enb_p->state)) {
+      enb_p->state = LOAD_ENB_READY;
+      for (i = 0; i < g_load.ues_per_enb; i++) {
+        load_ready (enb_p->first_ue + i, now_ns ());
+      }
+    }
+    break;
+
+  default:
+    if (S1ap_ProcedureCode_id_S1Setup == pdu_p->choice.unsuccessfulOutcome.procedureCode) {
+      fprintf (stderr, "eNB %u: S1 Setup failed, check MCC, MNC and TAC\n", enb_index);
+      enb_p->state = LOAD_ENB_FAILED;
+      g_load.num_enbs_failed++;
+    }
+    break;
+  }
+  ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+}
+
+//------------------------------------------------------------------------------
+static int enb_connect (const uint32_t enb_index, const int epoll_fd)
+{
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+  struct sockaddr_in        addr = {0};
+  struct epoll_event        event = {0};
+
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (S1AP_PORT_NUMBER);
+  if (1 != inet_pton (AF_INET, g_load.mme_address, &addr.sin_addr)) {
+    fprintf (stderr, "Invalid MME address %s\n", g_load.mme_address);
+    return -1;
+  }
+  if ((0 > (enb_p->fd = socket (AF_INET, SOCK_STREAM, IPPROTO_SCTP))) ||
+      (0 > sctp_set_init_opt (enb_p->fd, LOAD_STREAMS, LOAD_STREAMS, 0, 0))) {
+    fprintf (stderr, "eNB %u: SCTP socket failed: %s\n", enb_index, strerror (errno));
+    return -1;
+  }
+  fcntl (enb_p->fd, F_SETFL, fcntl (enb_p->fd, F_GETFL) | O_NONBLOCK);
+  if ((0 > connect (enb_p->fd, (struct sockaddr *)&addr, sizeof (addr))) && (EINPROGRESS != errno)) {
+    fprintf (stderr, "eNB %u: connect failed: %s\n", enb_index, strerror (errno));
+    return -1;
+  }
+  enb_p->state = LOAD_ENB_CONNECTING;
+  event.events = EPOLLOUT;
+  event.data.u32 = enb_index;
+  return epoll_ctl (epoll_fd, EPOLL_CTL_ADD, enb_p->fd, &event);
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_event (const uint32_t enb_index, const uint32_t events, const int epoll_fd)
+{
+  load_enb_t               *enb_p = &g_load.enbs[enb_index];
+  struct epoll_event        event = {0};
+  struct sctp_sndrcvinfo    sinfo = {0};
+  uint8_t                   buffer[LOAD_SCTP_RECV_BUFFER_SIZE];
+  int                       error = 0;
+  socklen_t                 error_length = sizeof (error);
+  int                       flags = 0;
+  int                       n = 0;
+
+  if (LOAD_ENB_FAILED == enb_p->state) {
+    return;
+  }
+  if (LOAD_ENB_CONNECTING == enb_p->state) {
+    getsockopt (enb_p->fd, SOL_SOCKET, SO_ERROR, &error, &error_length);
+    if (error) {
+      fprintf (stderr, "eNB %u: SCTP association failed: %s\n", enb_index, strerror (error));
+      enb_p->state = LOAD_ENB_FAILED;
+      g_load.num_enbs_failed++;
+      epoll_ctl (epoll_fd, EPOLL_CTL_DEL, enb_p->fd, NULL);
+      return;
+    }
+    // blocking sends from now on, receptions are driven by epoll
+    fcntl (enb_p->fd, F_SETFL, fcntl (enb_p->fd, F_GETFL) & ~O_NONBLOCK);
+    event.events = EPOLLIN;
+    event.data.u32 = enb_index;
+    epoll_ctl (epoll_fd, EPOLL_CTL_MOD, enb_p->fd, &event);
+    enb_send_s1_setup_request (enb_index);
+    return;
+  }
+  n = sctp_recvmsg (enb_p->fd, buffer, sizeof (buffer), NULL, NULL, &sinfo, &flags);
+  if (0 >= n) {
+    fprintf (stderr, "eNB %u: SCTP association lost: %s\n", enb_index, (n) ? strerror (errno) : "shutdown by the MME");
+    enb_p->state = LOAD_ENB_FAILED;
+    g_load.num_enbs_failed++;
+    epoll_ctl (epoll_fd, EPOLL_CTL_DEL, enb_p->fd, NULL);
+  } else if (flags & MSG_NOTIFICATION) {
+    return;
+  } else if (!(flags & MSG_EOR)) {
+    fprintf (stderr, "eNB %u: S1AP PDU larger than %d bytes dropped\n", enb_index, LOAD_SCTP_RECV_BUFFER_SIZE);
+  } else {
+    enb_handle_s1ap (enb_index, buffer, n);
+  }
+}
+
+//==============================================================================
+// Scheduling, statistics
+//==============================================================================
+
+//------------------------------------------------------------------------------
+// Start procedures of ready UEs as long as the rate and the window allow it
+static void load_schedule (const uint64_t now)
+{
+  load_ready_t             *ready_p = NULL;
+  load_ue_t                *ue_p = NULL;
+  double                    burst = (g_load.rate > 10) ? g_load.rate / 10 : 1;
+
+  if (g_load.rate > 0) {
+    g_load.tokens += g_load.rate * (double)(now - g_load.last_tick_ns) / 1e9;
+    if (g_load.tokens > burst) {
+      g_load.tokens = burst;
+    }
+  }
+  g_load.last_tick_ns = now;
+  // deferred UEs whose backoff is over are ready again
+  while (g_load.deferred_num && (g_load.deferred[g_load.deferred_head].ready_ns <= now)) {
+    load_ready (g_load.deferred[g_load.deferred_head].ue_index, now);
+    g_load.deferred_head = (g_load.deferred_head + 1) % g_load.num_ues;
+    g_load.deferred_num--;
+  }
+  while (g_load.ready_num && (g_load.outstanding < g_load.window) && ((0 == g_load.rate) || (1 <= g_load.tokens))) {
+    ready_p = &g_load.ready[g_load.ready_head];
+    if (ready_p->ready_ns > now) {
+      break;
+    }
+    g_load.ready_head = (g_load.ready_head + 1) % g_load.num_ues;
+    g_load.ready_num--;
+    ue_p = &g_load.ues[ready_p->ue_index];
+    // held back by the eNB, nothing is sent to the MME
+    if (ue_defer_procedure (ue_p, now)) {
+      continue;
+    }
+    if (g_load.rate > 0) {
+      g_load.tokens -= 1;
+    }
+    ue_start_procedure (ue_p, now);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void load_second (const uint64_t now)
+{
+  load_second_t            *second_p = NULL;
+  uint32_t                  i = 0;
+
+  // procedures that timed out
+  for (i = 0; i < g_load.num_ues; i++) {
+    if ((g_load.ues[i].is_running) && (now - g_load.ues[i].start_ns > g_load.timeout_ns)) {
+      ue_end_procedure (&g_load.ues[i], false, "timeout");
+    }
+  }
+  g_load.current.second = ++g_load.num_seconds;
+  g_load.current.rate = g_load.rate;
+  g_load.current.outstanding = g_load.outstanding;
+  g_load.current.enbs_overloaded = g_load.num_enbs_overloaded;
+  g_load.seconds = realloc (g_load.seconds, g_load.num_seconds * sizeof (load_second_t));
+  AssertFatal (NULL != g_load.seconds, "Allocation of statistics failed");
+  second_p = &g_load.seconds[g_load.num_seconds - 1];
+  *second_p = g_load.current;
+  fprintf (stdout, "%6us rate %8.0f/s started %7u completed %7u failed %5u deferred %6u outstanding %6u mean latency %9.3f ms overloaded eNBs %u\n",
+      second_p->second, second_p->rate, second_p->started, second_p->completed, second_p->failed, second_p->deferred, second_p->outstanding,
+      (second_p->completed) ? (double)second_p->latency_sum_ns / 1e6 / second_p->completed : 0.0, second_p->enbs_overloaded);
+  fflush (stdout);
+  memset (&g_load.current, 0, sizeof (g_load.current));
+  if (g_load.rate > 0) {
+    g_load.rate += g_load.rate_step;
+  }
+  if (((g_load.duration_sec) && (g_load.num_seconds >= g_load.duration_sec)) ||
+      (g_load.num_stopped == g_load.num_ues) || (g_load.num_enbs_failed == g_load.num_enbs)) {
+    g_load.is_running = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void load_report (void)
+{
+  FILE                     *json = NULL;
+  load_latencies_t         *latencies_p = NULL;
+  uint64_t                  p50 = 0;
+  uint64_t                  p99 = 0;
+  uint64_t                  p999 = 0;
+  uint32_t                  s = 0;
+  int                       p = 0;
+
+  if (g_load.output) {
+    json = fopen (g_load.output, "w");
+    AssertFatal (NULL != json, "Could not open %s", g_load.output);
+    fprintf (json, "{\"benchmark\": \"s1ap_load\", \"enbs\": %u, \"ues\": %u, \"enbs_failed\": %u, \"mt_percent\": %u, \"ignore_overload\": %s,"
+        " \"overload_start\": %u, \"overload_stop\": %u, \"procedures\": [\n",
+        g_load.num_enbs, g_load.num_ues, g_load.num_enbs_failed, g_load.mt_percent, (g_load.ignore_overload) ? "true" : "false",
+        g_load.num_overload_start, g_load.num_overload_stop);
+  }
+  fprintf (stdout, "OVERLOAD START received %u, OVERLOAD STOP received %u%s\n", g_load.num_overload_start, g_load.num_overload_stop,
+      (g_load.ignore_overload) ? " (ignored)" : "");
+  fprintf (stdout, "%-10s %10s %8s %10s %10s %10s %10s\n", "procedure", "completed", "failed", "deferred", "p50 ms", "p99 ms", "p999 ms");
+  for (p = 0; p < LOAD_PROC_MAX; p++) {
+    latencies_p = &g_load.latencies[p];
+    qsort (latencies_p->ns, latencies_p->num, sizeof (uint64_t), compare_uint64);
+    p50  = percentile (latencies_p->ns, latencies_p->num, 0.50);
+    p99  = percentile (latencies_p->ns, latencies_p->num, 0.99);
+    p999 = percentile (latencies_p->ns, latencies_p->num, 0.999);
+    fprintf (stdout, "%-10s %10u %8u %10u %10.3f %10.3f %10.3f\n", proc2str[p], latencies_p->num, latencies_p->failed, latencies_p->deferred,
+        (double)p50 / 1e6, (double)p99 / 1e6, (double)p999 / 1e6);
+    if (json) {
+      fprintf (json, "%s  {\"procedure\": \"%s\", \"completed\": %u, \"failed\": %u, \"deferred\": %u, \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 "}",
+          (p) ? ",\n" : "", proc2str[p], latencies_p->num, latencies_p->failed, latencies_p->deferred, p50, p99, p999);
+    }
+  }
+  if (json) {
+    fprintf (json, "\n], \"seconds\": [\n");
+    for (s = 0; s < g_load.num_seconds; s++) {
+      fprintf (json, "%s  {\"second\": %u, \"rate\": %.0f, \"started\": %u, \"completed\": %u, \"failed\": %u, \"deferred\": %u, \"outstanding\": %u,"
+          " \"enbs_overloaded\": %u, \"latency_sum_ns\": %" PRIu64 "}",
+          (s) ? ",\n" : "", g_load.seconds[s].second, g_load.seconds[s].rate, g_load.seconds[s].started, g_load.seconds[s].completed,
+          g_load.seconds[s].failed, g_load.seconds[s].deferred, g_load.seconds[s].outstanding, g_load.seconds[s].enbs_overloaded,
+          g_load.seconds[s].latency_sum_ns);
+    }
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+}
+
+//------------------------------------------------------------------------------
+// A script starts from EMM-DEREGISTERED, it must end there to be repeated
+static bool load_parse_script (char * const script)
+{
+  load_ue_state_t           state = LOAD_UE_DEREGISTERED;
+  char                     *saveptr = NULL;
+  char                     *step = NULL;
+  int                       p = 0;
+
+  g_load.script_length = 0;
+  for (step = strtok_r (script, ",", &saveptr); step; step = strtok_r (NULL, ",", &saveptr)) {
+    for (p = 0; (p < LOAD_PROC_MAX) && strcmp (step, proc2str[p]); p++);
+    if ((LOAD_PROC_MAX == p) || (LOAD_MAX_SCRIPT_STEPS == g_load.script_length)) {
+      fprintf (stderr, "Unknown procedure %s, or more than %d procedures\n", step, LOAD_MAX_SCRIPT_STEPS);
+      return false;
+    }
+    if (((LOAD_PROC_ATTACH == p) && (LOAD_UE_DEREGISTERED != state)) ||
+        ((LOAD_PROC_IDLE == p) && (LOAD_UE_CONNECTED != state)) ||
+        (((LOAD_PROC_TAU == p) || (LOAD_PROC_SERVICE == p)) && (LOAD_UE_IDLE != state)) ||
+        ((LOAD_PROC_DETACH == p) && (LOAD_UE_DEREGISTERED == state))) {
+      fprintf (stderr, "Procedure %s is not possible at step %u of the script\n", step, g_load.script_length + 1);
+      return false;
+    }
+    state = (LOAD_PROC_IDLE == p) || (LOAD_PROC_TAU == p) ? LOAD_UE_IDLE : (LOAD_PROC_DETACH == p) ? LOAD_UE_DEREGISTERED : LOAD_UE_CONNECTED;
+    g_load.script[g_load.script_length++] = p;
+  }
+  if ((0 == g_load.script_length) || ((1 != g_load.repetitions) && (LOAD_UE_DEREGISTERED != state))) {
+    fprintf (stderr, "Empty script, or script repeated without detach at its end\n");
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  struct epoll_event        events[LOAD_MAX_EVENTS];
+  char                      script[256] = LOAD_DEFAULT_SCRIPT;
+  const char               *mcc = LOAD_DEFAULT_MCC;
+  const char               *mnc = LOAD_DEFAULT_MNC;
+  const char               *k = LOAD_DEFAULT_K;
+  const char               *op = LOAD_DEFAULT_OP;
+  const char               *opc = NULL;
+  uint64_t                  imsi64 = 0;
+  uint64_t                  now = 0;
+  uint32_t                  i = 0;
+  int                       epoll_fd = -1;
+  int                       n = 0;
+  int                       c = 0;
+
+  g_load.mme_address  = LOAD_DEFAULT_MME_ADDRESS;
+  g_load.num_enbs     = LOAD_DEFAULT_ENBS;
+  g_load.ues_per_enb  = LOAD_DEFAULT_UES_PER_ENB;
+  g_load.first_imsi   = LOAD_DEFAULT_FIRST_IMSI;
+  g_load.tac          = LOAD_DEFAULT_TAC;
+  g_load.repetitions  = LOAD_DEFAULT_REPETITIONS;
+  g_load.window       = LOAD_DEFAULT_WINDOW;
+  g_load.think_ns     = (uint64_t)LOAD_DEFAULT_THINK_MS * 1000000;
+  g_load.timeout_ns   = (uint64_t)LOAD_DEFAULT_TIMEOUT_SEC * 1000000000;
+  g_load.backoff_ns   = (uint64_t)LOAD_DEFAULT_BACKOFF_MS * 1000000;
+  while ((c = getopt (argc, argv, "m:e:u:I:M:N:T:k:P:C:s:r:d:R:g:w:i:x:p:b:Oo:")) != -1) {
+    switch (c) {
+    case 'm': g_load.mme_address = optarg; break;
+    case 'e': g_load.num_enbs = strtoul (optarg, NULL, 0); break;
+    case 'u': g_load.ues_per_enb = strtoul (optarg, NULL, 0); break;
+    case 'I': g_load.first_imsi = optarg; break;
+    case 'M': mcc = optarg; break;
+    case 'N': mnc = optarg; break;
+    case 'T': g_load.tac = strtoul (optarg, NULL, 0); break;
+    case 'k': k = optarg; break;
+    case 'P': op = optarg; break;
+    case 'C': opc = optarg; break;
+    case 's': snprintf (script, sizeof (script), "%s", optarg); break;
+    case 'r': g_load.repetitions = strtoul (optarg, NULL, 0); break;
+    case 'd': g_load.duration_sec = strtoul (optarg, NULL, 0); break;
+    case 'R': g_load.rate = strtod (optarg, NULL); break;
+    case 'g': g_load.rate_step = strtod (optarg, NULL); break;
+    case 'w': g_load.window = strtoul (optarg, NULL, 0); break;
+    case 'i': g_load.think_ns = strtoull (optarg, NULL, 0) * 1000000; break;
+    case 'x': g_load.timeout_ns = strtoull (optarg, NULL, 0) * 1000000000; break;
+    case 'p': g_load.mt_percent = strtoul (optarg, NULL, 0); break;
+    case 'b': g_load.backoff_ns = strtoull (optarg, NULL, 0) * 1000000; break;
+    case 'O': g_load.ignore_overload = true; break;
+    case 'o': g_load.output = optarg; break;
+    default:
+      fprintf (stderr, "Usage: %s [-m MME IPv4] [-e eNBs] [-u UEs per eNB] [-I first IMSI] [-M MCC] [-N MNC] [-T TAC]"
+          " [-k K] [-P OP | -C OPc] [-s script] [-r repetitions, 0 for ever] [-d duration s] [-R procedures/s, 0 for no limit]"
+          " [-g procedures/s added every second] [-w window] [-i think time ms] [-x procedure timeout s] [-p percent of mt-Access service requests]"
+          " [-b overload backoff ms] [-O ignore OVERLOAD START] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  g_load.num_ues = g_load.num_enbs * g_load.ues_per_enb;
+  g_load.mcc = strtoul (mcc, NULL, 10);
+  g_load.mnc = strtoul (mnc, NULL, 10);
+  g_load.mnc_length = strlen (mnc);
+  if ((0 == g_load.num_ues) || (0 == g_load.window) || (g_load.ues_per_enb > 0xffffff) || (100 < g_load.mt_percent) ||
+      (3 != strlen (mcc)) || ((2 != g_load.mnc_length) && (3 != g_load.mnc_length)) ||
+      (1 != sscanf (g_load.first_imsi, "%" SCNu64, &imsi64)) || (15 != strlen (g_load.first_imsi)) ||
+      (!load_parse_script (script))) {
+    fprintf (stderr, "Invalid arguments\n");
+    return -1;
+  }
+
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  TAC_TO_ASN1 (g_load.tac, &g_load.tai.tAC);
+  MCC_MNC_TO_TBCD (g_load.mcc, g_load.mnc, g_load.mnc_length, &g_load.tai.pLMNidentity);
+  if (!test_usim_init (&g_load.usim, k, op, opc, g_load.tai.pLMNidentity.buf)) {
+    fprintf (stderr, "Invalid K, OP or OPc\n");
+    return -1;
+  }
+  g_load.enbs  = calloc (g_load.num_enbs, sizeof (load_enb_t));
+  g_load.ues   = calloc (g_load.num_ues, sizeof (load_ue_t));
+  g_load.ready = calloc (g_load.num_ues, sizeof (load_ready_t));
+  g_load.deferred = calloc (g_load.num_ues, sizeof (load_ready_t));
+  AssertFatal ((NULL != g_load.enbs) && (NULL != g_load.ues) && (NULL != g_load.ready) && (NULL != g_load.deferred), "Allocation of eNBs and UEs failed");
+  for (i = 0; i < g_load.num_enbs; i++) {
+    g_load.enbs[i].fd = -1;
+    g_load.enbs[i].macro_enb_id = LOAD_FIRST_MACRO_ENB_ID + i;
+    g_load.enbs[i].first_ue = i * g_load.ues_per_enb;
+    MCC_MNC_TO_TBCD (g_load.mcc, g_load.mnc, g_load.mnc_length, &g_load.enbs[i].cgi.pLMNidentity);
+    MACRO_ENB_ID_TO_CELL_IDENTITY (g_load.enbs[i].macro_enb_id, LOAD_CELL_ID, &g_load.enbs[i].cgi.cell_ID);
+  }
+  for (i = 0; i < g_load.num_ues; i++) {
+    snprintf (g_load.ues[i].imsi, sizeof (g_load.ues[i].imsi), "%015" PRIu64, imsi64 + i);
+    g_load.ues[i].enb_index = i / g_load.ues_per_enb;
+    g_load.ues[i].enb_ue_s1ap_id = (i % g_load.ues_per_enb) + 1;
+  }
+
+  signal (SIGINT, sigint_handler);
+  signal (SIGPIPE, SIG_IGN);
+  epoll_fd = epoll_create1 (0);
+  AssertFatal (0 <= epoll_fd, "epoll_create1 failed: %s", strerror (errno));
+  for (i = 0; i < g_load.num_enbs; i++) {
+    if (0 > enb_connect (i, epoll_fd)) {
+      return -1;
+    }
+  }
+  g_load.is_running = true;
+  g_load.start_ns = now_ns ();
+  g_load.last_tick_ns = g_load.start_ns;
+  g_load.next_second_ns = g_load.start_ns + 1000000000;
+  while (g_load.is_running) {
+    n = epoll_wait (epoll_fd, events, LOAD_MAX_EVENTS, 1);
+    for (c = 0; c < n; c++) {
+      enb_handle_event (events[c].data.u32, events[c].events, epoll_fd);
+    }
+    now = now_ns ();
+    load_schedule (now);
+    if (now >= g_load.next_second_ns) {
+      g_load.next_second_ns += 1000000000;
+      load_second (now);
+    }
+  }
+  load_report ();
+
+  for (i = 0; i < g_load.num_enbs; i++) {
+    if (0 <= g_load.enbs[i].fd) {
+      close (g_load.enbs[i].fd);
+    }
+    ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_EUTRAN_CGI, &g_load.enbs[i].cgi);
+  }
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_TAI, &g_load.tai);
+  close (epoll_fd);
+  for (i = 0; i < LOAD_PROC_MAX; i++) {
+    free (g_load.latencies[i].ns);
+  }
+  free (g_load.seconds);
+  free (g_load.deferred);
+  free (g_load.ready);
+  free (g_load.ues);
+  free (g_load.enbs);
+  test_usim_free (&g_load.usim);
+  OAILOG_EXIT ();
+  return (g_load.num_stopped == g_load.num_ues) ? 0 : -1;
+}
@@ -0,0 +1,1548 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_s1ap_replay.c
+   \brief Replay of the S1AP traffic of a capture towards a running MME, scaled to many UEs.
+   The capture (pcap, not pcapng) is loaded and decoded once: its S1 Setup Request, and the UE associated messages
+   of each UE (one flow per eNB UE S1AP ID of each eNB). Each flow is replayed by N copies of the UE over E
+   eNB associations, a copy sends the uplink messages of its flow and waits for each downlink message of its flow
+   (procedure, and EMM message type if readable) before sending the next uplink messages.
+   UE identifiers are rewritten for each copy: eNB UE S1AP ID, MME UE S1AP ID learnt from the MME, IMSI in NAS
+   (capture IMSI + copy * IMSI stride), GUTI and S-TMSI allocated by the MME, macro eNB ID of the associations.
+   The copies run MILENAGE with K and OP (or OPc): Authentication Response and Security Mode Complete are
+   computed again, protected uplink NAS messages are protected again with the keys of the copy. An uplink NAS
+   message ciphered (not EEA0) in the capture can not be read, it is sent as captured.
+   Copies start at a paced rate or as fast as possible within a window of running copies. The latency between an
+   uplink message and the downlink message that answers it is measured for each pair of procedures.
+   Usage: oaisim_mme_s1ap_replay -p capture.pcap [-m MME IPv4] [-e eNBs] [-n copies of each UE] [-S IMSI stride]
+            [-k K] [-P OP | -C OPc] [-R copies/s, 0 for no limit] [-w window] [-x timeout s] [-o /path/to/results.json]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netinet/in.h>
+#include <netinet/sctp.h>
+#include <arpa/inet.h>
+
+#include "assertions.h"
+#include "log.h"
+#include "conversions.h"
+#include "common_types.h"
+#include "mme_default_values.h"
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "sctp_common.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "oaisim_mme_test_ue.h"
+
+#define REPLAY_DEFAULT_MME_ADDRESS       "127.0.0.1"
+#define REPLAY_DEFAULT_ENBS                       1
+#define REPLAY_DEFAULT_COPIES                     1
+#define REPLAY_DEFAULT_K   "8baf473f2f8fd09487cccbd7097c6862"
+#define REPLAY_DEFAULT_OP  "1006020f0a478bf6b699f15c062e42b3"   /* OPERATOR_key of ETC/hss.conf */
+#define REPLAY_DEFAULT_WINDOW                  1000
+#define REPLAY_DEFAULT_TIMEOUT_SEC               10
+#define REPLAY_STREAMS                            2
+#define REPLAY_UE_STREAM                          1
+#define REPLAY_NAS_MAX_LENGTH    TEST_UE_NAS_MAX_LENGTH
+#define REPLAY_SCTP_RECV_BUFFER_SIZE           8192
+#define REPLAY_MAX_EVENTS                        64
+#define REPLAY_MAX_REASSEMBLIES                  64
+#define REPLAY_MAX_PROCEDURES                   256
+#define REPLAY_MAX_IMSI_DIGITS                   15
+
+// pcap file format
+#define PCAP_MAGIC                       0xa1b2c3d4
+#define PCAP_MAGIC_NS                    0xa1b23c4d
+#define PCAP_GLOBAL_HEADER_LENGTH                24
+#define PCAP_RECORD_HEADER_LENGTH                16
+#define PCAP_LINKTYPE_NULL                        0
+#define PCAP_LINKTYPE_ETHERNET                    1
+#define PCAP_LINKTYPE_RAW                       101
+#define PCAP_LINKTYPE_LINUX_SLL                 113
+#define PCAP_LINKTYPE_IPV4                      228
+#define PCAP_LINKTYPE_IPV6                      229
+#define PCAP_LINKTYPE_LINUX_SLL2                276
+#define ETHERTYPE_IPV4                       0x0800
+#define ETHERTYPE_IPV6                       0x86dd
+#define ETHERTYPE_VLAN                       0x8100
+#define ETHERTYPE_QINQ                       0x88a8
+#define IP_PROTOCOL_SCTP                        132
+#define SCTP_COMMON_HEADER_LENGTH                12
+#define SCTP_CHUNK_DATA                           0
+#define SCTP_DATA_HEADER_LENGTH                  16
+#define SCTP_DATA_FLAG_BEGIN                   0x02
+#define SCTP_DATA_FLAG_END                     0x01
+
+/* Messages of a flow, the uplink ones are decoded once and encoded again for each copy */
+typedef union replay_ies_u {
+  S1ap_InitialUEMessageIEs_t               initial_ue_message;
+  S1ap_UplinkNASTransportIEs_t             uplink_nas_transport;
+  S1ap_UECapabilityInfoIndicationIEs_t     ue_capability_info_indication;
+  S1ap_UEContextReleaseRequestIEs_t        ue_context_release_request;
+  S1ap_InitialContextSetupResponseIEs_t    initial_context_setup_response;
+  S1ap_InitialContextSetupFailureIEs_t     initial_context_setup_failure;
+  S1ap_UEContextReleaseCompleteIEs_t       ue_context_release_complete;
+  S1ap_UEContextModificationResponseIEs_t  ue_context_modification_response;
+  S1ap_E_RABSetupResponseIEs_t             e_rab_setup_response;
+  S1ap_E_RABModifyResponseIEs_t            e_rab_modify_response;
+  S1ap_E_RABReleaseResponseIEs_t           e_rab_release_response;
+  S1ap_DownlinkNASTransportIEs_t           downlink_nas_transport;
+  S1ap_InitialContextSetupRequestIEs_t     initial_context_setup_request;
+  S1ap_UEContextReleaseCommandIEs_t        ue_context_release_command;
+  S1ap_UEContextModificationRequestIEs_t   ue_context_modification_request;
+  S1ap_E_RABSetupRequestIEs_t              e_rab_setup_request;
+  S1ap_E_RABModifyRequestIEs_t             e_rab_modify_request;
+  S1ap_E_RABReleaseCommandIEs_t            e_rab_release_command;
+} replay_ies_t;
+
+typedef struct replay_message_s {
+  bool                       is_uplink;
+  S1AP_PDU_PR                present;
+  S1ap_ProcedureCode_t       procedure_code;
+  S1ap_Criticality_t         criticality;
+  uint8_t                    nas_type;         /* downlink: EMM message type to wait for, 0 if any */
+  replay_ies_t               ies;              /* uplink only */
+} replay_message_t;
+
+/* UE IDs found in a message */
+typedef struct replay_ids_s {
+  bool                       has_enb_ue_s1ap_id;
+  bool                       has_mme_ue_s1ap_id;
+  S1ap_ENB_UE_S1AP_ID_t      enb_ue_s1ap_id;
+  S1ap_MME_UE_S1AP_ID_t      mme_ue_s1ap_id;
+  S1ap_NAS_PDU_t            *nas_pdu_p;
+} replay_ids_t;
+
+typedef struct replay_flow_s {
+  uint64_t                   enb_key;          /* eNB address and port in the capture */
+  S1ap_ENB_UE_S1AP_ID_t      enb_ue_s1ap_id;
+  S1ap_MME_UE_S1AP_ID_t      mme_ue_s1ap_id;
+  bool                       has_mme_ue_s1ap_id;
+  bool                       is_complete;      /* no more message after UE Context Release Complete */
+  uint8_t                    eea;              /* ciphering algorithm in the capture */
+  replay_message_t          *messages;
+  uint32_t                   num_messages;
+  uint32_t                   size;
+} replay_flow_t;
+
+typedef enum {
+  REPLAY_ENB_CONNECTING = 0,
+  REPLAY_ENB_SETUP,
+  REPLAY_ENB_READY,
+  REPLAY_ENB_FAILED,
+} replay_enb_state_t;
+
+typedef struct replay_enb_s {
+  int                        fd;
+  replay_enb_state_t         state;
+} replay_enb_t;
+
+/* Copy of a flow, unit u is on eNB u % eNBs with the eNB UE S1AP ID u / eNBs + 1 */
+typedef struct replay_ue_s {
+  uint32_t                   flow_index;
+  uint32_t                   copy;
+  uint32_t                   enb_index;
+  S1ap_ENB_UE_S1AP_ID_t      enb_ue_s1ap_id;
+  S1ap_MME_UE_S1AP_ID_t      mme_ue_s1ap_id;
+  bool                       is_running;
+  uint32_t                   cursor;           /* next message of the flow */
+  uint64_t                   start_ns;
+  uint64_t                   uplink_ns;        /* last uplink message sent */
+  S1ap_ProcedureCode_t       uplink_procedure_code;
+  bool                       has_security;
+  test_ue_security_t         security;
+  bool                       has_guti;
+  uint8_t                    guti[TEST_UE_GUTI_LENGTH];
+  uint8_t                    pending_nas[REPLAY_NAS_MAX_LENGTH]; /* Authentication Response or Security Mode Complete */
+  size_t                     pending_nas_length;
+} replay_ue_t;
+
+typedef struct replay_latencies_s {
+  S1ap_ProcedureCode_t       uplink_procedure_code;
+  S1ap_ProcedureCode_t       downlink_procedure_code;
+  uint8_t                    nas_type;
+  uint64_t                  *ns;
+  uint32_t                   num;
+  uint32_t                   size;
+} replay_latencies_t;
+
+typedef struct replay_reassembly_s {
+  uint64_t                   key;
+  uint8_t                   *buffer;
+  size_t                     length;
+} replay_reassembly_t;
+
+typedef struct replay_run_s {
+  // configuration
+  const char                *pcap;
+  const char                *mme_address;
+  uint32_t                   num_enbs;
+  uint32_t                   copies;
+  uint64_t                   imsi_stride;
+  double                     rate;
+  uint32_t                   window;
+  uint64_t                   timeout_ns;
+  const char                *output;
+  // capture
+  bool                       has_s1_setup;
+  S1ap_S1SetupRequestIEs_t   s1_setup;
+  bool                       has_plmn;
+  uint8_t                    plmn[3];
+  replay_flow_t             *flows;
+  uint32_t                   num_flows;
+  replay_reassembly_t        reassemblies[REPLAY_MAX_REASSEMBLIES];
+  uint32_t                   num_packets;
+  uint32_t                   num_pdus;
+  uint32_t                   num_skipped;      /* not UE associated, or not supported */
+  // replay
+  test_usim_t                usim;
+  replay_enb_t              *enbs;
+  replay_ue_t               *ues;
+  uint32_t                   num_ues;
+  uint32_t                  *ready;            /* FIFO of copies waiting for their start */
+  uint32_t                   ready_head;
+  uint32_t                   ready_num;
+  double                     tokens;
+  uint32_t                   running;
+  uint32_t                   num_completed;
+  uint32_t                   num_failed;
+  uint32_t                   num_unexpected;
+  uint32_t                   num_verbatim;     /* uplink NAS messages sent as captured */
+  uint32_t                   num_enbs_failed;
+  uint64_t                  *flow_ns;
+  uint32_t                   num_flow_ns;
+  uint32_t                   size_flow_ns;
+  replay_latencies_t        *latencies;
+  uint32_t                   num_latencies;
+  uint64_t                   start_ns;
+  uint64_t                   last_tick_ns;
+  volatile sig_atomic_t      is_running;
+} replay_run_t;
+
+/* TS 36.413 procedure codes */
+static const char * const   procedure2str[] = {
+  "HandoverPreparation", "HandoverResourceAllocation", "HandoverNotification", "PathSwitchRequest", "HandoverCancel",
+  "E-RABSetup", "E-RABModify", "E-RABRelease", "E-RABReleaseIndication", "InitialContextSetup", "Paging",
+  "downlinkNASTransport", "initialUEMessage", "uplinkNASTransport", "Reset", "ErrorIndication", "NASNonDeliveryIndication",
+  "S1Setup", "UEContextReleaseRequest", "DownlinkS1cdma2000tunneling", "UplinkS1cdma2000tunneling", "UEContextModification",
+  "UECapabilityInfoIndication", "UEContextRelease", "eNBStatusTransfer", "MMEStatusTransfer", "DeactivateTrace", "TraceStart",
+  "TraceFailureIndication", "ENBConfigurationUpdate", "MMEConfigurationUpdate", "LocationReportingControl",
+  "LocationReportingFailureIndication", "LocationReport", "OverloadStart", "OverloadStop", "WriteReplaceWarning",
+  "eNBDirectInformationTransfer", "MMEDirectInformationTransfer", "PrivateMessage", "eNBConfigurationTransfer",
+  "MMEConfigurationTransfer", "CellTrafficTrace", "Kill",
+};
+static replay_run_t         g_replay;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  uint64_t  va = *(const uint64_t *)a;
+  uint64_t  vb = *(const uint64_t *)b;
+
+  return (va > vb) - (va < vb);
+}
+
+//------------------------------------------------------------------------------
+static uint64_t percentile (const uint64_t * const sorted, const uint64_t num, const double p)
+{
+  uint64_t  index = (uint64_t)(p * (double)num);
+
+  return (num) ? sorted[(index >= num) ? num - 1 : index] : 0;
+}
+
+//------------------------------------------------------------------------------
+static const char *procedure_name (const S1ap_ProcedureCode_t procedure_code)
+{
+  return ((0 <= procedure_code) && (procedure_code < (S1ap_ProcedureCode_t)(sizeof (procedure2str) / sizeof (procedure2str[0])))) ?
+      procedure2str[procedure_code] : "unknown";
+}
+
+//------------------------------------------------------------------------------
+static void sigint_handler (__attribute__ ((unused)) int signal_number)
+{
+  g_replay.is_running = false;
+}
+
+//------------------------------------------------------------------------------
+static void replay_record (uint64_t ** const ns_p, uint32_t * const num_p, uint32_t * const size_p, const uint64_t latency_ns)
+{
+  if (*num_p == *size_p) {
+    *size_p = (*size_p) ? 2 * *size_p : 1024;
+    *ns_p = realloc (*ns_p, *size_p * sizeof (uint64_t));
+    AssertFatal (NULL != *ns_p, "Allocation of latencies failed");
+  }
+  (*ns_p)[(*num_p)++] = latency_ns;
+}
+
+//==============================================================================
+// S1AP messages
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void replay_pdu_header (S1AP_PDU_t * const pdu_p, S1ap_ProcedureCode_t * const procedure_code_p, S1ap_Criticality_t * const criticality_p, ANY_t ** const value_p)
+{
+  switch (pdu_p->present) {
+  case S1AP_PDU_PR_initiatingMessage:
+    *procedure_code_p = pdu_p->choice.initiatingMessage.procedureCode;
+    *criticality_p = pdu_p->choice.initiatingMessage.criticality;
+    *value_p = &pdu_p->choice.initiatingMessage.value;
+    break;
+
+  case S1AP_PDU_PR_successfulOutcome:
+    *procedure_code_p = pdu_p->choice.successfulOutcome.procedureCode;
+    *criticality_p = pdu_p->choice.successfulOutcome.criticality;
+    *value_p = &pdu_p->choice.successfulOutcome.value;
+    break;
+
+  default:
+    *procedure_code_p = pdu_p->choice.unsuccessfulOutcome.procedureCode;
+    *criticality_p = pdu_p->choice.unsuccessfulOutcome.criticality;
+    *value_p = &pdu_p->choice.unsuccessfulOutcome.value;
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// UE associated messages handled by the replay, false if the message is not one of them
+#define REPLAY_DECODE(dEcOdE, fIeLd, hAsMmEiD) do {                                                 \
+    if (0 > dEcOdE (&ies_p->fIeLd, value_p)) return false;                                            \
+    ids_p->has_enb_ue_s1ap_id = true;                                                                 \
+    ids_p->enb_ue_s1ap_id = ies_p->fIeLd.eNB_UE_S1AP_ID;                                              \
+    ids_p->has_mme_ue_s1ap_id = hAsMmEiD;                                                             \
+  } while (0)
+
+static bool replay_decode_ies (const bool is_uplink, const S1AP_PDU_PR present, const S1ap_ProcedureCode_t procedure_code,
+    ANY_t * const value_p, replay_ies_t * const ies_p, replay_ids_t * const ids_p)
+{
+  S1ap_E_RABToBeSetupItemCtxtSUReq_t *e_rab_p = NULL;
+
+  memset (ies_p, 0, sizeof (*ies_p));
+  memset (ids_p, 0, sizeof (*ids_p));
+  if ((is_uplink) && (S1AP_PDU_PR_initiatingMessage == present)) {
+    switch (procedure_code) {
+    case S1ap_ProcedureCode_id_initialUEMessage:
+      REPLAY_DECODE (s1ap_decode_s1ap_initialuemessageies, initial_ue_message, false);
+      ids_p->nas_pdu_p = &ies_p->initial_ue_message.nas_pdu;
+      return true;
+
+    case S1ap_ProcedureCode_id_uplinkNASTransport:
+      REPLAY_DECODE (s1ap_decode_s1ap_uplinknastransporties, uplink_nas_transport, true);
+      ids_p->mme_ue_s1ap_id = ies_p->uplink_nas_transport.mme_ue_s1ap_id;
+      ids_p->nas_pdu_p = &ies_p->uplink_nas_transport.nas_pdu;
+      return true;
+
+    case S1ap_ProcedureCode_id_UECapabilityInfoIndication:
+      REPLAY_DECODE (s1ap_decode_s1ap_uecapabilityinfoindicationies, ue_capability_info_indication, true);
+      ids_p->mme_ue_s1ap_id = ies_p->ue_capability_info_indication.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_UEContextReleaseRequest:
+      REPLAY_DECODE (s1ap_decode_s1ap_uecontextreleaserequesties, ue_context_release_request, true);
+      ids_p->mme_ue_s1ap_id = ies_p->ue_context_release_request.mme_ue_s1ap_id;
+      return true;
+
+    default:
+      return false;
+    }
+  } else if ((is_uplink) && (S1AP_PDU_PR_successfulOutcome == present)) {
+    switch (procedure_code) {
+    case S1ap_ProcedureCode_id_InitialContextSetup:
+      REPLAY_DECODE (s1ap_decode_s1ap_initialcontextsetupresponseies, initial_context_setup_response, true);
+      ids_p->mme_ue_s1ap_id = ies_p->initial_context_setup_response.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_UEContextRelease:
+      REPLAY_DECODE (s1ap_decode_s1ap_uecontextreleasecompleteies, ue_context_release_complete, true);
+      ids_p->mme_ue_s1ap_id = ies_p->ue_context_release_complete.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_UEContextModification:
+      REPLAY_DECODE (s1ap_decode_s1ap_uecontextmodificationresponseies, ue_context_modification_response, true);
+      ids_p->mme_ue_s1ap_id = ies_p->ue_context_modification_response.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABSetup:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabsetupresponseies, e_rab_setup_response, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_setup_response.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABModify:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabmodifyresponseies, e_rab_modify_response, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_modify_response.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABRelease:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabreleaseresponseies, e_rab_release_response, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_release_response.mme_ue_s1ap_id;
+      return true;
+
+    default:
+      return false;
+    }
+  } else if (is_uplink) {
+    if (S1ap_ProcedureCode_id_InitialContextSetup != procedure_code) {
+      return false;
+    }
+    REPLAY_DECODE (s1ap_decode_s1ap_initialcontextsetupfailureies, initial_context_setup_failure, true);
+    ids_p->mme_ue_s1ap_id = ies_p->initial_context_setup_failure.mme_ue_s1ap_id;
+    return true;
+  } else if (S1AP_PDU_PR_initiatingMessage == present) {
+    switch (procedure_code) {
+    case S1ap_ProcedureCode_id_downlinkNASTransport:
+      REPLAY_DECODE (s1ap_decode_s1ap_downlinknastransporties, downlink_nas_transport, true);
+      ids_p->mme_ue_s1ap_id = ies_p->downlink_nas_transport.mme_ue_s1ap_id;
+      ids_p->nas_pdu_p = &ies_p->downlink_nas_transport.nas_pdu;
+      return true;
+
+    case S1ap_ProcedureCode_id_InitialContextSetup:
+      REPLAY_DECODE (s1ap_decode_s1ap_initialcontextsetuprequesties, initial_context_setup_request, true);
+      ids_p->mme_ue_s1ap_id = ies_p->initial_context_setup_request.mme_ue_s1ap_id;
+      if (ies_p->initial_context_setup_request.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.count) {
+        e_rab_p = ies_p->initial_context_setup_request.e_RABToBeSetupListCtxtSUReq.s1ap_E_RABToBeSetupItemCtxtSUReq.array[0];
+        ids_p->nas_pdu_p = e_rab_p->nAS_PDU;
+      }
+      return true;
+
+    case S1ap_ProcedureCode_id_UEContextRelease:
+      if (0 > s1ap_decode_s1ap_uecontextreleasecommandies (&ies_p->ue_context_release_command, value_p)) {
+        return false;
+      }
+      ids_p->has_mme_ue_s1ap_id = true;
+      if (S1ap_UE_S1AP_IDs_PR_uE_S1AP_ID_pair == ies_p->ue_context_release_command.uE_S1AP_IDs.present) {
+        ids_p->has_enb_ue_s1ap_id = true;
+        ids_p->enb_ue_s1ap_id = ies_p->ue_context_release_command.uE_S1AP_IDs.choice.uE_S1AP_ID_pair.eNB_UE_S1AP_ID;
+        ids_p->mme_ue_s1ap_id = ies_p->ue_context_release_command.uE_S1AP_IDs.choice.uE_S1AP_ID_pair.mME_UE_S1AP_ID;
+      } else {
+        ids_p->mme_ue_s1ap_id = ies_p->ue_context_release_command.uE_S1AP_IDs.choice.mME_UE_S1AP_ID;
+      }
+      return true;
+
+    case S1ap_ProcedureCode_id_UEContextModification:
+      REPLAY_DECODE (s1ap_decode_s1ap_uecontextmodificationrequesties, ue_context_modification_request, true);
+      ids_p->mme_ue_s1ap_id = ies_p->ue_context_modification_request.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABSetup:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabsetuprequesties, e_rab_setup_request, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_setup_request.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABModify:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabmodifyrequesties, e_rab_modify_request, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_modify_request.mme_ue_s1ap_id;
+      return true;
+
+    case S1ap_ProcedureCode_id_E_RABRelease:
+      REPLAY_DECODE (s1ap_decode_s1ap_e_rabreleasecommandies, e_rab_release_command, true);
+      ids_p->mme_ue_s1ap_id = ies_p->e_rab_release_command.mme_ue_s1ap_id;
+      return true;
+
+    default:
+      return false;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// EMM message type of a downlink NAS PDU as seen without keys, 0 if ciphered
+static uint8_t replay_nas_type (const S1ap_NAS_PDU_t * const nas_pdu_p, const uint8_t eea)
+{
+  uint8_t                   security_header_type = 0;
+
+  if ((NULL == nas_pdu_p) || (2 > nas_pdu_p->size) || (EPS_MOBILITY_MANAGEMENT_MESSAGE != (nas_pdu_p->buf[0] & 0x0f))) {
+    return 0;
+  }
+  security_header_type = nas_pdu_p->buf[0] >> 4;
+  if (SECURITY_HEADER_TYPE_NOT_PROTECTED == security_header_type) {
+    return nas_pdu_p->buf[1];
+  }
+  if ((8 > nas_pdu_p->size) ||
+      (((SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED == security_header_type) ||
+        (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW == security_header_type)) && (eea))) {
+    return 0;
+  }
+  return nas_pdu_p->buf[7];
+}
+
+//==============================================================================
+// Capture
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static uint64_t replay_endpoint_key (const uint8_t * const address, const size_t address_length, const uint16_t port)
+{
+  uint64_t                  key = 0xcbf29ce484222325;   /* FNV-1a */
+  size_t                    i = 0;
+
+  for (i = 0; i < address_length; i++) {
+    key = (key ^ address[i]) * 0x100000001b3;
+  }
+  key = (key ^ (port >> 8)) * 0x100000001b3;
+  return (key ^ (port & 0xff)) * 0x100000001b3;
+}
+
+//------------------------------------------------------------------------------
+static replay_flow_t *replay_find_flow (const uint64_t enb_key, const replay_ids_t * const ids_p, const bool is_uplink)
+{
+  replay_flow_t            *flow_p = NULL;
+  uint32_t                  f = 0;
+
+  // latest flow first: eNB UE S1AP IDs are reused after a release
+  for (f = g_replay.num_flows; f > 0; f--) {
+    flow_p = &g_replay.flows[f - 1];
+    if ((flow_p->enb_key != enb_key) || (flow_p->is_complete)) {
+      continue;
+    }
+    if ((ids_p->has_enb_ue_s1ap_id) ? (flow_p->enb_ue_s1ap_id == ids_p->enb_ue_s1ap_id) :
+        ((flow_p->has_mme_ue_s1ap_id) && (flow_p->mme_ue_s1ap_id == ids_p->mme_ue_s1ap_id))) {
+      return flow_p;
+    }
+  }
+  if ((!is_uplink) || (!ids_p->has_enb_ue_s1ap_id)) {
+    return NULL;
+  }
+  g_replay.flows = realloc (g_replay.flows, (g_replay.num_flows + 1) * sizeof (replay_flow_t));
+  AssertFatal (NULL != g_replay.flows, "Allocation of flows failed");
+  flow_p = &g_replay.flows[g_replay.num_flows++];
+  memset (flow_p, 0, sizeof (*flow_p));
+  flow_p->enb_key = enb_key;
+  flow_p->enb_ue_s1ap_id = ids_p->enb_ue_s1ap_id;
+  return flow_p;
+}
+
+//------------------------------------------------------------------------------
+static void replay_load_pdu (const bool is_uplink, const uint64_t enb_key, const uint8_t * const buffer, const size_t length)
+{
+  S1AP_PDU_t               *pdu_p = NULL;
+  asn_dec_rval_t            dec_ret = {0};
+  replay_message_t          message = {0};
+  replay_ids_t              ids = {0};
+  replay_flow_t            *flow_p = NULL;
+  ANY_t                    *value_p = NULL;
+
+  g_replay.num_pdus++;
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, buffer, length, 0, 0);
+  if (RC_OK != dec_ret.code) {
+    g_replay.num_skipped++;
+    ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+    return;
+  }
+  message.is_uplink = is_uplink;
+  message.present = pdu_p->present;
+  replay_pdu_header (pdu_p, &message.procedure_code, &message.criticality, &value_p);
+  if ((is_uplink) && (S1AP_PDU_PR_initiatingMessage == message.present) && (S1ap_ProcedureCode_id_S1Setup == message.procedure_code)) {
+    if (!g_replay.has_s1_setup) {
+      g_replay.has_s1_setup = (0 <= s1ap_decode_s1ap_s1setuprequesties (&g_replay.s1_setup, value_p));
+    }
+  } else if ((!replay_decode_ies (is_uplink, message.present, message.procedure_code, value_p, &message.ies, &ids)) ||
+             (NULL == (flow_p = replay_find_flow (enb_key, &ids, is_uplink)))) {
+    g_replay.num_skipped++;
+  } else {
+    if ((ids.has_mme_ue_s1ap_id) && (!flow_p->has_mme_ue_s1ap_id)) {
+      flow_p->mme_ue_s1ap_id = ids.mme_ue_s1ap_id;
+      flow_p->has_mme_ue_s1ap_id = true;
+    }
+    if ((is_uplink) && (S1ap_ProcedureCode_id_initialUEMessage == message.procedure_code) && (!g_replay.has_plmn) &&
+        (3 == message.ies.initial_ue_message.tai.pLMNidentity.size)) {
+      memcpy (g_replay.plmn, message.ies.initial_ue_message.tai.pLMNidentity.buf, 3);
+      g_replay.has_plmn = true;
+    }
+    if (!is_uplink) {
+      message.nas_type = replay_nas_type (ids.nas_pdu_p, flow_p->eea);
+      if ((SECURITY_MODE_COMMAND == message.nas_type) && (9 <= ids.nas_pdu_p->size)) {
+        flow_p->eea = (ids.nas_pdu_p->buf[8] >> 4) & 0x07;
+      }
+      memset (&message.ies, 0, sizeof (message.ies));
+    }
+    // EMM Information depends on the MME configuration, it is not waited for
+    if (EMM_INFORMATION != message.nas_type) {
+      if (flow_p->num_messages == flow_p->size) {
+        flow_p->size = (flow_p->size) ? 2 * flow_p->size : 16;
+        flow_p->messages = realloc (flow_p->messages, flow_p->size * sizeof (replay_message_t));
+        AssertFatal (NULL != flow_p->messages, "Allocation of messages failed");
+      }
+      flow_p->messages[flow_p->num_messages++] = message;
+    }
+    flow_p->is_complete = (is_uplink) && (S1AP_PDU_PR_successfulOutcome == message.present) &&
+        (S1ap_ProcedureCode_id_UEContextRelease == message.procedure_code);
+  }
+  ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+}
+
+//------------------------------------------------------------------------------
+// DATA chunk, S1AP PDUs fragmented by SCTP are reassembled
+static void replay_load_sctp_data (const bool is_uplink, const uint64_t enb_key, const uint64_t association_key,
+    const uint8_t flags, const uint16_t stream, const uint8_t * const data, const size_t length)
+{
+  replay_reassembly_t      *reassembly_p = NULL;
+  uint64_t                  key = association_key ^ ((uint64_t)stream << 48) ^ is_uplink;
+  uint32_t                  i = 0;
+
+  if ((flags & (SCTP_DATA_FLAG_BEGIN | SCTP_DATA_FLAG_END)) == (SCTP_DATA_FLAG_BEGIN | SCTP_DATA_FLAG_END)) {
+    replay_load_pdu (is_uplink, enb_key, data, length);
+    return;
+  }
+  for (i = 0; i < REPLAY_MAX_REASSEMBLIES; i++) {
+    if (((g_replay.reassemblies[i].buffer) && (g_replay.reassemblies[i].key == key)) ||
+        ((NULL == reassembly_p) && (NULL == g_replay.reassemblies[i].buffer))) {
+      reassembly_p = &g_replay.reassemblies[i];
+      if (reassembly_p->buffer) {
+        break;
+      }
+    }
+  }
+  if (NULL == reassembly_p) {
+    g_replay.num_skipped++;
+    return;
+  }
+  if (flags & SCTP_DATA_FLAG_BEGIN) {
+    reassembly_p->length = 0;
+  } else if (NULL == reassembly_p->buffer) {
+    return;                                     /* middle of a PDU that started before the capture */
+  }
+  reassembly_p->key = key;
+  reassembly_p->buffer = realloc (reassembly_p->buffer, reassembly_p->length + length);
+  AssertFatal (NULL != reassembly_p->buffer, "Allocation of reassembly buffer failed");
+  memcpy (&reassembly_p->buffer[reassembly_p->length], data, length);
+  reassembly_p->length += length;
+  if (flags & SCTP_DATA_FLAG_END) {
+    replay_load_pdu (is_uplink, enb_key, reassembly_p->buffer, reassembly_p->length);
+    free (reassembly_p->buffer);
+    reassembly_p->buffer = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_load_sctp (const uint8_t * const src, const uint8_t * const dst, const size_t address_length,
+    const uint8_t * const sctp, const size_t length)
+{
+  uint16_t                  src_port = 0;
+  uint16_t                  dst_port = 0;
+  uint16_t                  chunk_length = 0;
+  uint64_t                  enb_key = 0;
+  uint64_t                  association_key = 0;
+  size_t                    offset = SCTP_COMMON_HEADER_LENGTH;
+  bool                      is_uplink = false;
+
+  if (SCTP_COMMON_HEADER_LENGTH > length) {
+    return;
+  }
+  src_port = (sctp[0] << 8) | sctp[1];
+  dst_port = (sctp[2] << 8) | sctp[3];
+  if (S1AP_PORT_NUMBER == dst_port) {
+    is_uplink = true;
+    enb_key = replay_endpoint_key (src, address_length, src_port);
+    association_key = enb_key ^ replay_endpoint_key (dst, address_length, dst_port);
+  } else if (S1AP_PORT_NUMBER == src_port) {
+    enb_key = replay_endpoint_key (dst, address_length, dst_port);
+    association_key = enb_key ^ replay_endpoint_key (src, address_length, src_port);
+  } else {
+    return;
+  }
+  while (offset + 4 <= length) {
+    chunk_length = (sctp[offset + 2] << 8) | sctp[offset + 3];
+    if ((4 > chunk_length) || (offset + chunk_length > length)) {
+      return;
+    }
+    if ((SCTP_CHUNK_DATA == sctp[offset]) && (SCTP_DATA_HEADER_LENGTH < chunk_length) &&
+        (S1AP_SCTP_PPID == ((sctp[offset + 12] << 24) | (sctp[offset + 13] << 16) | (sctp[offset + 14] << 8) | sctp[offset + 15]))) {
+      replay_load_sctp_data (is_uplink, enb_key, association_key, sctp[offset + 1], (sctp[offset + 8] << 8) | sctp[offset + 9],
+          &sctp[offset + SCTP_DATA_HEADER_LENGTH], chunk_length - SCTP_DATA_HEADER_LENGTH);
+    }
+    offset += (chunk_length + 3) & ~3;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_load_ip (const uint8_t * const ip, const size_t length)
+{
+  size_t                    header_length = 0;
+  size_t                    total_length = 0;
+
+  if ((20 <= length) && (4 == (ip[0] >> 4))) {
+    header_length = (ip[0] & 0x0f) * 4;
+    total_length = (ip[2] << 8) | ip[3];
+    // IP fragments are not reassembled
+    if ((IP_PROTOCOL_SCTP == ip[9]) && (header_length <= total_length) && (total_length <= length) &&
+        (0 == (((ip[6] << 8) | ip[7]) & 0x3fff))) {
+      replay_load_sctp (&ip[12], &ip[16], 4, &ip[header_length], total_length - header_length);
+    }
+  } else if ((40 <= length) && (6 == (ip[0] >> 4))) {
+    total_length = 40 + ((ip[4] << 8) | ip[5]);
+    // no extension header
+    if ((IP_PROTOCOL_SCTP == ip[6]) && (total_length <= length)) {
+      replay_load_sctp (&ip[8], &ip[24], 16, &ip[40], total_length - 40);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_load_packet (const uint32_t linktype, const uint8_t * const packet, const size_t length)
+{
+  uint16_t                  ethertype = 0;
+  size_t                    offset = 0;
+
+  switch (linktype) {
+  case PCAP_LINKTYPE_NULL:
+    offset = 4;
+    break;
+
+  case PCAP_LINKTYPE_ETHERNET:
+    offset = 14;
+    if (offset > length) {
+      return;
+    }
+    ethertype = (packet[12] << 8) | packet[13];
+    while (((ETHERTYPE_VLAN == ethertype) || (ETHERTYPE_QINQ == ethertype)) && (offset + 4 <= length)) {
+      ethertype = (packet[offset + 2] << 8) | packet[offset + 3];
+      offset += 4;
+    }
+    if ((ETHERTYPE_IPV4 != ethertype) && (ETHERTYPE_IPV6 != ethertype)) {
+      return;
+    }
+    break;
+
+  case PCAP_LINKTYPE_LINUX_SLL:
+    offset = 16;
+    break;
+
+  case PCAP_LINKTYPE_LINUX_SLL2:
+    offset = 20;
+    break;
+
+  default:
+    offset = 0;
+    break;
+  }
+  if (offset < length) {
+    replay_load_ip (&packet[offset], length - offset);
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool replay_load_pcap (const char * const path)
+{
+  FILE                     *file = NULL;
+  uint8_t                  *pcap = NULL;
+  long                      size = 0;
+  size_t                    offset = PCAP_GLOBAL_HEADER_LENGTH;
+  uint32_t                  magic = 0;
+  uint32_t                  linktype = 0;
+  uint32_t                  captured_length = 0;
+  bool                      is_swapped = false;
+
+  if ((NULL == (file = fopen (path, "rb"))) || (0 != fseek (file, 0, SEEK_END)) || (0 > (size = ftell (file)))) {
+    fprintf (stderr, "Could not read %s: %s\n", path, strerror (errno));
+    if (file) {
+      fclose (file);
+    }
+    return false;
+  }
+  rewind (file);
+  pcap = malloc (size);
+  AssertFatal (NULL != pcap, "Allocation of %ld bytes for %s failed", size, path);
+  if ((PCAP_GLOBAL_HEADER_LENGTH > size) || (1 != fread (pcap, size, 1, file))) {
+    fprintf (stderr, "Could not read %s\n", path);
+    fclose (file);
+    free (pcap);
+    return false;
+  }
+  fclose (file);
+  memcpy (&magic, pcap, sizeof (magic));
+  is_swapped = (__builtin_bswap32 (PCAP_MAGIC) == magic) || (__builtin_bswap32 (PCAP_MAGIC_NS) == magic);
+  if ((PCAP_MAGIC != magic) && (PCAP_MAGIC_NS != magic) && (!is_swapped)) {
+    fprintf (stderr, "%s is not a pcap file (pcapng can be converted with editcap -F pcap)\n", path);
+    free (pcap);
+    return false;
+  }
+  memcpy (&linktype, &pcap[20], sizeof (linktype));
+  linktype = ((is_swapped) ? __builtin_bswap32 (linktype) : linktype) & 0xffff;
+  while (offset + PCAP_RECORD_HEADER_LENGTH <= (size_t)size) {
+    memcpy (&captured_length, &pcap[offset + 8], sizeof (captured_length));
+    captured_length = (is_swapped) ? __builtin_bswap32 (captured_length) : captured_length;
+    offset += PCAP_RECORD_HEADER_LENGTH;
+    if (offset + captured_length > (size_t)size) {
+      break;
+    }
+    replay_load_packet (linktype, &pcap[offset], captured_length);
+    g_replay.num_packets++;
+    offset += captured_length;
+  }
+  free (pcap);
+  return true;
+}
+
+//==============================================================================
+// Uplink
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void enb_send (const uint32_t enb_index, const sctp_stream_id_t stream, uint8_t * const buffer, const uint32_t length)
+{
+  replay_enb_t             *enb_p = &g_replay.enbs[enb_index];
+
+  if ((REPLAY_ENB_FAILED != enb_p->state) &&
+      (0 > sctp_sendmsg (enb_p->fd, buffer, length, NULL, 0, htonl (S1AP_SCTP_PPID), 0, stream, 0, 0))) {
+    fprintf (stderr, "eNB %u: sctp_sendmsg failed: %s\n", enb_index, strerror (errno));
+  }
+  free (buffer);
+}
+
+//------------------------------------------------------------------------------
+static void enb_send_s1_setup_request (const uint32_t enb_index)
+{
+  S1ap_S1SetupRequestIEs_t  ies = g_replay.s1_setup;
+  S1ap_S1SetupRequest_t     s1_setup_request = {0};
+  const uint8_t            *enb_id_buf = g_replay.s1_setup.global_ENB_ID.eNB_ID.choice.macroENB_ID.buf;
+  uint32_t                  macro_enb_id = 0;
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+
+  // macro eNB ID of the capture + index of the association
+  macro_enb_id = (enb_id_buf[0] << 12) + (enb_id_buf[1] << 4) + ((enb_id_buf[2] & 0xf0) >> 4);
+  memset (&ies.global_ENB_ID.eNB_ID.choice.macroENB_ID, 0, sizeof (ies.global_ENB_ID.eNB_ID.choice.macroENB_ID));
+  MACRO_ENB_ID_TO_BIT_STRING ((macro_enb_id + enb_index) & 0xfffff, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+  AssertFatal (s1ap_encode_s1ap_s1setuprequesties (&s1_setup_request, &ies) >= 0, "Encoding of S1 Setup Request IEs failed");
+  AssertFatal (s1ap_generate_initiating_message (&buffer, &length, S1ap_ProcedureCode_id_S1Setup, S1ap_Criticality_reject,
+      &asn_DEF_S1ap_S1SetupRequest, &s1_setup_request) >= 0, "Encoding of S1 Setup Request failed");
+  ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_BIT_STRING, &ies.global_ENB_ID.eNB_ID.choice.macroENB_ID);
+  g_replay.enbs[enb_index].state = REPLAY_ENB_SETUP;
+  enb_send (enb_index, 0, buffer, length);
+}
+
+//------------------------------------------------------------------------------
+// Mobile identity (length, then value) of an uplink NAS message: IMSI of the copy, GUTI allocated to the copy
+static void replay_rewrite_identity (const replay_ue_t * const ue_p, uint8_t * const identity, const size_t length)
+{
+  char                      digits[REPLAY_MAX_IMSI_DIGITS + 1];
+  uint64_t                  imsi64 = 0;
+  uint64_t                  modulo = 1;
+  size_t                    num_digits = 0;
+  size_t                    i = 0;
+
+  if ((2 > length) || (identity[0] + 1 > length)) {
+    return;
+  }
+  if ((0x06 == (identity[1] & 0x07)) && (TEST_UE_GUTI_LENGTH == identity[0]) && (ue_p->has_guti)) {
+    memcpy (&identity[1], ue_p->guti, TEST_UE_GUTI_LENGTH);
+  } else if ((0x01 == (identity[1] & 0x07)) && (ue_p->copy) && (g_replay.imsi_stride)) {
+    num_digits = 2 * identity[0] - ((identity[1] & 0x08) ? 1 : 2);
+    if (REPLAY_MAX_IMSI_DIGITS < num_digits) {
+      return;
+    }
+    for (i = 0; i < num_digits; i++) {
+      digits[i] = '0' + (((i + 1) & 1) ? (identity[1 + (i + 1) / 2] >> 4) : (identity[1 + (i + 1) / 2] & 0x0f));
+      modulo *= 10;
+    }
+    digits[num_digits] = '\0';
+    imsi64 = (strtoull (digits, NULL, 10) + ue_p->copy * g_replay.imsi_stride) % modulo;
+    snprintf (digits, sizeof (digits), "%0*" PRIu64, (int)num_digits, imsi64);
+    for (i = 0; i < num_digits; i++) {
+      if ((i + 1) & 1) {
+        identity[1 + (i + 1) / 2] = (identity[1 + (i + 1) / 2] & 0x0f) | ((digits[i] - '0') << 4);
+      } else {
+        identity[1 + (i + 1) / 2] = (identity[1 + (i + 1) / 2] & 0xf0) | (digits[i] - '0');
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_rewrite_plain (const replay_ue_t * const ue_p, uint8_t * const plain, const size_t plain_length)
+{
+  if ((3 > plain_length) || (EPS_MOBILITY_MANAGEMENT_MESSAGE != (plain[0] & 0x0f))) {
+    return;
+  }
+  switch (plain[1]) {
+  case ATTACH_REQUEST:
+  case DETACH_REQUEST:
+  case TRACKING_AREA_UPDATE_REQUEST:
+    replay_rewrite_identity (ue_p, &plain[3], plain_length - 3);
+    break;
+
+  case IDENTITY_RESPONSE:
+    replay_rewrite_identity (ue_p, &plain[2], plain_length - 2);
+    break;
+
+  default:
+    break;
+  }
+}
+
+//------------------------------------------------------------------------------
+// NAS PDU of an uplink message of the capture for a copy
+static size_t replay_rewrite_nas (replay_ue_t * const ue_p, const S1ap_NAS_PDU_t * const captured_p, uint8_t * const nas)
+{
+  const replay_flow_t      *flow_p = &g_replay.flows[ue_p->flow_index];
+  uint8_t                   plain[REPLAY_NAS_MAX_LENGTH];
+  uint8_t                   security_header_type = 0;
+  size_t                    length = captured_p->size;
+
+  if ((2 > length) || (REPLAY_NAS_MAX_LENGTH < length)) {
+    g_replay.num_verbatim++;
+    memcpy (nas, captured_p->buf, (REPLAY_NAS_MAX_LENGTH < length) ? REPLAY_NAS_MAX_LENGTH : length);
+    return (REPLAY_NAS_MAX_LENGTH < length) ? REPLAY_NAS_MAX_LENGTH : length;
+  }
+  memcpy (nas, captured_p->buf, length);
+  if (EPS_MOBILITY_MANAGEMENT_MESSAGE != (nas[0] & 0x0f)) {
+    return length;
+  }
+  security_header_type = nas[0] >> 4;
+  switch (security_header_type) {
+  case SECURITY_HEADER_TYPE_NOT_PROTECTED:
+    if ((AUTHENTICATION_RESPONSE == nas[1]) && (ue_p->pending_nas_length)) {
+      length = ue_p->pending_nas_length;
+      memcpy (nas, ue_p->pending_nas, length);
+      ue_p->pending_nas_length = 0;
+    } else {
+      replay_rewrite_plain (ue_p, nas, length);
+    }
+    return length;
+
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_NEW:
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW:
+    // Security Mode Complete
+    if (ue_p->pending_nas_length) {
+      length = ue_p->pending_nas_length;
+      memcpy (nas, ue_p->pending_nas, length);
+      ue_p->pending_nas_length = 0;
+      return length;
+    }
+    break;
+
+  case SECURITY_HEADER_TYPE_SERVICE_REQUEST:
+    if (ue_p->has_security) {
+      return test_ue_nas_encode_service_request (&ue_p->security, nas);
+    }
+    break;
+
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED:
+  case SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED:
+    if ((ue_p->has_security) && (6 < length) &&
+        ((SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED == security_header_type) || (0 == flow_p->eea))) {
+      memcpy (plain, &nas[6], length - 6);
+      replay_rewrite_plain (ue_p, plain, length - 6);
+      return test_ue_nas_protect (&ue_p->security, security_header_type, plain, length - 6, nas);
+    }
+    break;
+
+  default:
+    break;
+  }
+  g_replay.num_verbatim++;
+  return length;
+}
+
+//------------------------------------------------------------------------------
+#define REPLAY_ENCODE(gEnErAtE, eNcOdE, tYpE, fIeLd) do {                                                 \
+    tYpE##_t                  pdu;                                                                          \
+    ies.fIeLd.eNB_UE_S1AP_ID = ue_p->enb_ue_s1ap_id;                                                        \
+    memset (&pdu, 0, sizeof (pdu));                                                                         \
+    AssertFatal (eNcOdE (&pdu, &ies.fIeLd) >= 0, "Encoding of " #tYpE " IEs failed");                       \
+    AssertFatal (gEnErAtE (&buffer, &length, message_p->procedure_code, message_p->criticality,             \
+        &asn_DEF_##tYpE, &pdu) >= 0, "Encoding of " #tYpE " failed");                                       \
+  } while (0)
+
+#define REPLAY_ENCODE_MME_UE(gEnErAtE, eNcOdE, tYpE, fIeLd) do {                                          \
+    ies.fIeLd.mme_ue_s1ap_id = ue_p->mme_ue_s1ap_id;                                                        \
+    REPLAY_ENCODE (gEnErAtE, eNcOdE, tYpE, fIeLd);                                                          \
+  } while (0)
+
+static void replay_send_uplink (replay_ue_t * const ue_p, const replay_message_t * const message_p)
+{
+  replay_ies_t              ies = message_p->ies;
+  uint8_t                   nas[REPLAY_NAS_MAX_LENGTH];
+  uint8_t                  *buffer = NULL;
+  uint32_t                  length = 0;
+  bool                      has_s_tmsi = false;
+
+  if (S1AP_PDU_PR_initiatingMessage == message_p->present) {
+    switch (message_p->procedure_code) {
+    case S1ap_ProcedureCode_id_initialUEMessage:
+      ies.initial_ue_message.nas_pdu.size = replay_rewrite_nas (ue_p, &message_p->ies.initial_ue_message.nas_pdu, nas);
+      ies.initial_ue_message.nas_pdu.buf = nas;
+      if ((ies.initial_ue_message.presenceMask & S1AP_INITIALUEMESSAGEIES_S_TMSI_PRESENT) && (ue_p->has_guti)) {
+        memset (&ies.initial_ue_message.s_tmsi, 0, sizeof (ies.initial_ue_message.s_tmsi));
+        MME_CODE_TO_OCTET_STRING (ue_p->guti[6], &ies.initial_ue_message.s_tmsi.mMEC);
+        M_TMSI_TO_OCTET_STRING ((ue_p->guti[7] << 24) | (ue_p->guti[8] << 16) | (ue_p->guti[9] << 8) | ue_p->guti[10], &ies.initial_ue_message.s_tmsi.m_TMSI);
+        has_s_tmsi = true;
+      }
+      REPLAY_ENCODE (s1ap_generate_initiating_message, s1ap_encode_s1ap_initialuemessageies, S1ap_InitialUEMessage, initial_ue_message);
+      if (has_s_tmsi) {
+        ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_S_TMSI, &ies.initial_ue_message.s_tmsi);
+      }
+      break;
+
+    case S1ap_ProcedureCode_id_uplinkNASTransport:
+      ies.uplink_nas_transport.nas_pdu.size = replay_rewrite_nas (ue_p, &message_p->ies.uplink_nas_transport.nas_pdu, nas);
+      ies.uplink_nas_transport.nas_pdu.buf = nas;
+      REPLAY_ENCODE_MME_UE (s1ap_generate_initiating_message, s1ap_encode_s1ap_uplinknastransporties, S1ap_UplinkNASTransport, uplink_nas_transport);
+      break;
+
+    case S1ap_ProcedureCode_id_UECapabilityInfoIndication:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_initiating_message, s1ap_encode_s1ap_uecapabilityinfoindicationies, S1ap_UECapabilityInfoIndication,
+          ue_capability_info_indication);
+      break;
+
+    default:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_initiating_message, s1ap_encode_s1ap_uecontextreleaserequesties, S1ap_UEContextReleaseRequest,
+          ue_context_release_request);
+      break;
+    }
+  } else if (S1AP_PDU_PR_successfulOutcome == message_p->present) {
+    switch (message_p->procedure_code) {
+    case S1ap_ProcedureCode_id_InitialContextSetup:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_initialcontextsetupresponseies, S1ap_InitialContextSetupResponse,
+          initial_context_setup_response);
+      break;
+
+    case S1ap_ProcedureCode_id_UEContextRelease:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_uecontextreleasecompleteies, S1ap_UEContextReleaseComplete,
+          ue_context_release_complete);
+      break;
+
+    case S1ap_ProcedureCode_id_UEContextModification:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_uecontextmodificationresponseies, S1ap_UEContextModificationResponse,
+          ue_context_modification_response);
+      break;
+
+    case S1ap_ProcedureCode_id_E_RABSetup:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_e_rabsetupresponseies, S1ap_E_RABSetupResponse, e_rab_setup_response);
+      break;
+
+    case S1ap_ProcedureCode_id_E_RABModify:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_e_rabmodifyresponseies, S1ap_E_RABModifyResponse, e_rab_modify_response);
+      break;
+
+    default:
+      REPLAY_ENCODE_MME_UE (s1ap_generate_successfull_outcome, s1ap_encode_s1ap_e_rabreleaseresponseies, S1ap_E_RABReleaseResponse, e_rab_release_response);
+      break;
+    }
+  } else {
+    REPLAY_ENCODE_MME_UE (s1ap_generate_unsuccessfull_outcome, s1ap_encode_s1ap_initialcontextsetupfailureies, S1ap_InitialContextSetupFailure,
+        initial_context_setup_failure);
+  }
+  ue_p->uplink_ns = now_ns ();
+  ue_p->uplink_procedure_code = message_p->procedure_code;
+  enb_send (ue_p->enb_index, REPLAY_UE_STREAM, buffer, length);
+}
+
+//==============================================================================
+// Copies of the flows
+//==============================================================================
+
+//------------------------------------------------------------------------------
+static void replay_ue_end (replay_ue_t * const ue_p, const bool is_success, const char * const reason)
+{
+  if (!ue_p->is_running) {
+    return;
+  }
+  ue_p->is_running = false;
+  g_replay.running--;
+  if (is_success) {
+    g_replay.num_completed++;
+    replay_record (&g_replay.flow_ns, &g_replay.num_flow_ns, &g_replay.size_flow_ns, now_ns () - ue_p->start_ns);
+  } else {
+    g_replay.num_failed++;
+    fprintf (stderr, "Copy %u of flow %u: failed at message %u: %s\n", ue_p->copy, ue_p->flow_index, ue_p->cursor, reason);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Send the uplink messages up to the next downlink message of the flow
+static void replay_ue_advance (replay_ue_t * const ue_p)
+{
+  const replay_flow_t      *flow_p = &g_replay.flows[ue_p->flow_index];
+
+  while ((ue_p->cursor < flow_p->num_messages) && (flow_p->messages[ue_p->cursor].is_uplink)) {
+    replay_send_uplink (ue_p, &flow_p->messages[ue_p->cursor]);
+    ue_p->cursor++;
+  }
+  if (ue_p->cursor == flow_p->num_messages) {
+    replay_ue_end (ue_p, true, NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_record_response (const replay_ue_t * const ue_p, const S1ap_ProcedureCode_t procedure_code, const uint8_t nas_type)
+{
+  replay_latencies_t       *latencies_p = NULL;
+  uint32_t                  i = 0;
+
+  for (i = 0; i < g_replay.num_latencies; i++) {
+    latencies_p = &g_replay.latencies[i];
+    if ((latencies_p->uplink_procedure_code == ue_p->uplink_procedure_code) &&
+        (latencies_p->downlink_procedure_code == procedure_code) && (latencies_p->nas_type == nas_type)) {
+      break;
+    }
+  }
+  if (i == g_replay.num_latencies) {
+    g_replay.latencies = realloc (g_replay.latencies, (g_replay.num_latencies + 1) * sizeof (replay_latencies_t));
+    AssertFatal (NULL != g_replay.latencies, "Allocation of latencies failed");
+    latencies_p = &g_replay.latencies[g_replay.num_latencies++];
+    memset (latencies_p, 0, sizeof (*latencies_p));
+    latencies_p->uplink_procedure_code = ue_p->uplink_procedure_code;
+    latencies_p->downlink_procedure_code = procedure_code;
+    latencies_p->nas_type = nas_type;
+  }
+  replay_record (&latencies_p->ns, &latencies_p->num, &latencies_p->size, now_ns () - ue_p->uplink_ns);
+}
+
+//------------------------------------------------------------------------------
+// NAS of a downlink message for a copy, returns its EMM message type, 0 if it can not be read
+static uint8_t replay_ue_nas (replay_ue_t * const ue_p, S1ap_NAS_PDU_t * const nas_pdu_p)
+{
+  uint8_t                  *plain = NULL;
+  size_t                    plain_length = 0;
+
+  if ((NULL == nas_pdu_p) || (NULL == (plain = test_ue_nas_unprotect (&ue_p->security, nas_pdu_p->buf, nas_pdu_p->size, &plain_length))) ||
+      (EPS_MOBILITY_MANAGEMENT_MESSAGE != (plain[0] & 0x0f))) {
+    return 0;
+  }
+  switch (plain[1]) {
+  case AUTHENTICATION_REQUEST:
+    ue_p->pending_nas_length = test_ue_authenticate (&g_replay.usim, &ue_p->security, plain, plain_length, ue_p->pending_nas);
+    if (0 == ue_p->pending_nas_length) {
+      replay_ue_end (ue_p, false, "MAC failure, check K and OP");
+    }
+    break;
+
+  case SECURITY_MODE_COMMAND:
+    ue_p->pending_nas_length = test_ue_security_mode (&ue_p->security, plain, plain_length, ue_p->pending_nas);
+    ue_p->has_security = (0 < ue_p->pending_nas_length);
+    if (!ue_p->has_security) {
+      replay_ue_end (ue_p, false, "NAS security algorithms not supported");
+    }
+    break;
+
+  case ATTACH_ACCEPT:
+    ue_p->has_guti = test_ue_nas_decode_attach_accept_guti (plain, plain_length, ue_p->guti);
+    break;
+
+  default:
+    break;
+  }
+  return plain[1];
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_s1ap (const uint32_t enb_index, const uint8_t * const buffer, const size_t length)
+{
+  replay_enb_t             *enb_p = &g_replay.enbs[enb_index];
+  S1AP_PDU_t               *pdu_p = NULL;
+  asn_dec_rval_t            dec_ret = {0};
+  const replay_message_t   *expected_p = NULL;
+  replay_ue_t              *ue_p = NULL;
+  replay_ies_t              ies;
+  replay_ids_t              ids = {0};
+  ANY_t                    *value_p = NULL;
+  S1ap_ProcedureCode_t      procedure_code = 0;
+  S1ap_Criticality_t        criticality = 0;
+  uint8_t                   nas_type = 0;
+  uint32_t                  u = 0;
+
+  dec_ret = aper_decode (NULL, &asn_DEF_S1AP_PDU, (void **)&pdu_p, buffer, length, 0, 0);
+  if (RC_OK != dec_ret.code) {
+    fprintf (stderr, "eNB %u: decoding of S1AP PDU failed\n", enb_index);
+    ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+    return;
+  }
+  replay_pdu_header (pdu_p, &procedure_code, &criticality, &value_p);
+  if (S1ap_ProcedureCode_id_S1Setup == procedure_code) {
+    if ((S1AP_PDU_PR_successfulOutcome == pdu_p->present) && (REPLAY_ENB_SETUP == enb_p->state)) {
+      enb_p->state = REPLAY_ENB_READY;
+      for (u = enb_index; u < g_replay.num_ues; u += g_replay.num_enbs) {
+        g_replay.ready[(g_replay.ready_head + g_replay.ready_num++) % g_replay.num_ues] = u;
+      }
+    } else if (S1AP_PDU_PR_unsuccessfulOutcome == pdu_p->present) {
+      fprintf (stderr, "eNB %u: S1 Setup failed, check the PLMN and TAC of the capture against the MME configuration\n", enb_index);
+      enb_p->state = REPLAY_ENB_FAILED;
+      g_replay.num_enbs_failed++;
+    }
+  } else if (replay_decode_ies (false, pdu_p->present, procedure_code, value_p, &ies, &ids)) {
+    if ((ids.has_enb_ue_s1ap_id) && (0 < ids.enb_ue_s1ap_id)) {
+      u = (ids.enb_ue_s1ap_id - 1) * g_replay.num_enbs + enb_index;
+      ue_p = (u < g_replay.num_ues) ? &g_replay.ues[u] : NULL;
+    } else {
+      for (u = enb_index; u < g_replay.num_ues; u += g_replay.num_enbs) {
+        if ((g_replay.ues[u].is_running) && (g_replay.ues[u].mme_ue_s1ap_id == ids.mme_ue_s1ap_id)) {
+          ue_p = &g_replay.ues[u];
+          break;
+        }
+      }
+    }
+    if ((NULL == ue_p) || (!ue_p->is_running)) {
+      g_replay.num_unexpected++;
+    } else {
+      if (ids.has_mme_ue_s1ap_id) {
+        ue_p->mme_ue_s1ap_id = ids.mme_ue_s1ap_id;
+      }
+      nas_type = replay_ue_nas (ue_p, ids.nas_pdu_p);
+      expected_p = &g_replay.flows[ue_p->flow_index].messages[ue_p->cursor];
+      if (!ue_p->is_running) {
+        // failed on its NAS
+      } else if ((expected_p->present == pdu_p->present) && (expected_p->procedure_code == procedure_code) &&
+          ((0 == expected_p->nas_type) || (0 == nas_type) || (expected_p->nas_type == nas_type))) {
+        replay_record_response (ue_p, procedure_code, nas_type);
+        ue_p->cursor++;
+        replay_ue_advance (ue_p);
+      } else if (EMM_INFORMATION != nas_type) {
+        g_replay.num_unexpected++;
+      }
+    }
+    if (ids.nas_pdu_p) {
+      ASN_STRUCT_FREE_CONTENTS_ONLY (asn_DEF_S1ap_NAS_PDU, ids.nas_pdu_p);
+    }
+  } else {
+    g_replay.num_unexpected++;
+  }
+  ASN_STRUCT_FREE (asn_DEF_S1AP_PDU, pdu_p);
+}
+
+//------------------------------------------------------------------------------
+static int enb_connect (const uint32_t enb_index, const int epoll_fd)
+{
+  replay_enb_t             *enb_p = &g_replay.enbs[enb_index];
+  struct sockaddr_in        addr = {0};
+  struct epoll_event        event = {0};
+
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (S1AP_PORT_NUMBER);
+  if (1 != inet_pton (AF_INET, g_replay.mme_address, &addr.sin_addr)) {
+    fprintf (stderr, "Invalid MME address %s\n", g_replay.mme_address);
+    return -1;
+  }
+  if ((0 > (enb_p->fd = socket (AF_INET, SOCK_STREAM, IPPROTO_SCTP))) ||
+      (0 > sctp_set_init_opt (enb_p->fd, REPLAY_STREAMS, REPLAY_STREAMS, 0, 0))) {
+    fprintf (stderr, "eNB %u: SCTP socket failed: %s\n", enb_index, strerror (errno));
+    return -1;
+  }
+  fcntl (enb_p->fd, F_SETFL, fcntl (enb_p->fd, F_GETFL) | O_NONBLOCK);
+  if ((0 > connect (enb_p->fd, (struct sockaddr *)&addr, sizeof (addr))) && (EINPROGRESS != errno)) {
+    fprintf (stderr, "eNB %u: connect failed: %s\n", enb_index, strerror (errno));
+    return -1;
+  }
+  enb_p->state = REPLAY_ENB_CONNECTING;
+  event.events = EPOLLOUT;
+  event.data.u32 = enb_index;
+  return epoll_ctl (epoll_fd, EPOLL_CTL_ADD, enb_p->fd, &event);
+}
+
+//------------------------------------------------------------------------------
+static void enb_handle_event (const uint32_t enb_index, const int epoll_fd)
+{
+  replay_enb_t             *enb_p = &g_replay.enbs[enb_index];
+  struct epoll_event        event = {0};
+  struct sctp_sndrcvinfo    sinfo = {0};
+  uint8_t                   buffer[REPLAY_SCTP_RECV_BUFFER_SIZE];
+  int                       error = 0;
+  socklen_t                 error_length = sizeof (error);
+  int                       flags = 0;
+  int                       n = 0;
+
+  if (REPLAY_ENB_FAILED == enb_p->state) {
+    return;
+  }
+  if (REPLAY_ENB_CONNECTING == enb_p->state) {
+    getsockopt (enb_p->fd, SOL_SOCKET, SO_ERROR, &error, &error_length);
+    if (error) {
+      fprintf (stderr, "eNB %u: SCTP association failed: %s\n", enb_index, strerror (error));
+      enb_p->state = REPLAY_ENB_FAILED;
+      g_replay.num_enbs_failed++;
+      epoll_ctl (epoll_fd, EPOLL_CTL_DEL, enb_p->fd, NULL);
+      return;
+    }
+    // blocking sends from now on, receptions are driven by epoll
+    fcntl (enb_p->fd, F_SETFL, fcntl (enb_p->fd, F_GETFL) & ~O_NONBLOCK);
+    event.events = EPOLLIN;
+    event.data.u32 = enb_index;
+    epoll_ctl (epoll_fd, EPOLL_CTL_MOD, enb_p->fd, &event);
+    enb_send_s1_setup_request (enb_index);
+    return;
+  }
+  n = sctp_recvmsg (enb_p->fd, buffer, sizeof (buffer), NULL, NULL, &sinfo, &flags);
+  if (0 >= n) {
+    fprintf (stderr, "eNB %u: SCTP association lost: %s\n", enb_index, (n) ? strerror (errno) : "shutdown by the MME");
+    enb_p->state = REPLAY_ENB_FAILED;
+    g_replay.num_enbs_failed++;
+    epoll_ctl (epoll_fd, EPOLL_CTL_DEL, enb_p->fd, NULL);
+  } else if (flags & MSG_NOTIFICATION) {
+    return;
+  } else if (!(flags & MSG_EOR)) {
+    fprintf (stderr, "eNB %u: S1AP PDU larger than %d bytes dropped\n", enb_index, REPLAY_SCTP_RECV_BUFFER_SIZE);
+  } else {
+    enb_handle_s1ap (enb_index, buffer, n);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Start copies as long as the rate and the window allow it
+static void replay_schedule (const uint64_t now)
+{
+  replay_ue_t              *ue_p = NULL;
+  double                    burst = (g_replay.rate > 10) ? g_replay.rate / 10 : 1;
+
+  if (g_replay.rate > 0) {
+    g_replay.tokens += g_replay.rate * (double)(now - g_replay.last_tick_ns) / 1e9;
+    if (g_replay.tokens > burst) {
+      g_replay.tokens = burst;
+    }
+  }
+  g_replay.last_tick_ns = now;
+  while ((g_replay.ready_num) && (g_replay.running < g_replay.window) && ((0 == g_replay.rate) || (1 <= g_replay.tokens))) {
+    ue_p = &g_replay.ues[g_replay.ready[g_replay.ready_head]];
+    g_replay.ready_head = (g_replay.ready_head + 1) % g_replay.num_ues;
+    g_replay.ready_num--;
+    if (g_replay.rate > 0) {
+      g_replay.tokens -= 1;
+    }
+    ue_p->is_running = true;
+    ue_p->start_ns = now;
+    ue_p->uplink_ns = now;
+    g_replay.running++;
+    replay_ue_advance (ue_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_second (const uint64_t now, const uint32_t second)
+{
+  uint32_t                  u = 0;
+
+  for (u = 0; u < g_replay.num_ues; u++) {
+    if ((g_replay.ues[u].is_running) && (now - g_replay.ues[u].uplink_ns > g_replay.timeout_ns)) {
+      replay_ue_end (&g_replay.ues[u], false, "timeout");
+    }
+  }
+  fprintf (stdout, "%6us completed %8u failed %6u running %6u unexpected %6u verbatim NAS %6u\n",
+      second, g_replay.num_completed, g_replay.num_failed, g_replay.running, g_replay.num_unexpected, g_replay.num_verbatim);
+  fflush (stdout);
+  if ((g_replay.num_completed + g_replay.num_failed == g_replay.num_ues) || (g_replay.num_enbs_failed == g_replay.num_enbs)) {
+    g_replay.is_running = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void replay_report (const uint64_t elapsed_ns)
+{
+  FILE                     *json = NULL;
+  replay_latencies_t       *latencies_p = NULL;
+  char                      name[128];
+  uint64_t                  p50 = 0;
+  uint64_t                  p99 = 0;
+  uint64_t                  p999 = 0;
+  uint32_t                  i = 0;
+
+  if (g_replay.output) {
+    json = fopen (g_replay.output, "w");
+    AssertFatal (NULL != json, "Could not open %s", g_replay.output);
+    fprintf (json, "{\"benchmark\": \"s1ap_replay\", \"flows\": %u, \"copies\": %u, \"enbs\": %u, \"completed\": %u, \"failed\": %u,"
+        " \"unexpected\": %u, \"verbatim_nas\": %u, \"duration_ns\": %" PRIu64 ", \"responses\": [\n",
+        g_replay.num_flows, g_replay.copies, g_replay.num_enbs, g_replay.num_completed, g_replay.num_failed,
+        g_replay.num_unexpected, g_replay.num_verbatim, elapsed_ns);
+  }
+  fprintf (stdout, "%u flows x %u copies in %.3f s: %.1f flows/s\n", g_replay.num_flows, g_replay.copies,
+      (double)elapsed_ns / 1e9, (elapsed_ns) ? (double)g_replay.num_completed * 1e9 / (double)elapsed_ns : 0.0);
+  fprintf (stdout, "%-64s %10s %10s %10s %10s\n", "request -> response", "count", "p50 ms", "p99 ms", "p999 ms");
+  qsort (g_replay.flow_ns, g_replay.num_flow_ns, sizeof (uint64_t), compare_uint64);
+  for (i = 0; i <= g_replay.num_latencies; i++) {
+    if (i < g_replay.num_latencies) {
+      latencies_p = &g_replay.latencies[i];
+      qsort (latencies_p->ns, latencies_p->num, sizeof (uint64_t), compare_uint64);
+      snprintf (name, sizeof (name), "%s -> %s", procedure_name (latencies_p->uplink_procedure_code), procedure_name (latencies_p->downlink_procedure_code));
+      if (latencies_p->nas_type) {
+        snprintf (&name[strlen (name)], sizeof (name) - strlen (name), " (EMM 0x%02x)", latencies_p->nas_type);
+      }
+      p50  = percentile (latencies_p->ns, latencies_p->num, 0.50);
+      p99  = percentile (latencies_p->ns, latencies_p->num, 0.99);
+      p999 = percentile (latencies_p->ns, latencies_p->num, 0.999);
+    } else {
+      snprintf (name, sizeof (name), "flow");
+      p50  = percentile (g_replay.flow_ns, g_replay.num_flow_ns, 0.50);
+      p99  = percentile (g_replay.flow_ns, g_replay.num_flow_ns, 0.99);
+      p999 = percentile (g_replay.flow_ns, g_replay.num_flow_ns, 0.999);
+    }
+    fprintf (stdout, "%-64s %10u %10.3f %10.3f %10.3f\n", name, (i < g_replay.num_latencies) ? latencies_p->num : g_replay.num_flow_ns,
+        (double)p50 / 1e6, (double)p99 / 1e6, (double)p999 / 1e6);
+    if (json) {
+      fprintf (json, "%s  {\"name\": \"%s\", \"count\": %u, \"p50_ns\": %" PRIu64 ", \"p99_ns\": %" PRIu64 ", \"p999_ns\": %" PRIu64 "}",
+          (i) ? ",\n" : "", name, (i < g_replay.num_latencies) ? latencies_p->num : g_replay.num_flow_ns, p50, p99, p999);
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  struct epoll_event        events[REPLAY_MAX_EVENTS];
+  const char               *k = REPLAY_DEFAULT_K;
+  const char               *op = REPLAY_DEFAULT_OP;
+  const char               *opc = NULL;
+  uint64_t                  now = 0;
+  uint64_t                  next_second_ns = 0;
+  uint32_t                  second = 0;
+  uint32_t                  u = 0;
+  int                       epoll_fd = -1;
+  int                       n = 0;
+  int                       c = 0;
+
+  g_replay.mme_address = REPLAY_DEFAULT_MME_ADDRESS;
+  g_replay.num_enbs    = REPLAY_DEFAULT_ENBS;
+  g_replay.copies      = REPLAY_DEFAULT_COPIES;
+  g_replay.window      = REPLAY_DEFAULT_WINDOW;
+  g_replay.timeout_ns  = (uint64_t)REPLAY_DEFAULT_TIMEOUT_SEC * 1000000000;
+  while ((c = getopt (argc, argv, "p:m:e:n:S:k:P:C:R:w:x:o:")) != -1) {
+    switch (c) {
+    case 'p': g_replay.pcap = optarg; break;
+    case 'm': g_replay.mme_address = optarg; break;
+    case 'e': g_replay.num_enbs = strtoul (optarg, NULL, 0); break;
+    case 'n': g_replay.copies = strtoul (optarg, NULL, 0); break;
+    case 'S': g_replay.imsi_stride = strtoull (optarg, NULL, 0); break;
+    case 'k': k = optarg; break;
+    case 'P': op = optarg; break;
+    case 'C': opc = optarg; break;
+    case 'R': g_replay.rate = strtod (optarg, NULL); break;
+    case 'w': g_replay.window = strtoul (optarg, NULL, 0); break;
+    case 'x': g_replay.timeout_ns = strtoull (optarg, NULL, 0) * 1000000000; break;
+    case 'o': g_replay.output = optarg; break;
+    default:
+      fprintf (stderr, "Usage: %s -p capture.pcap [-m MME IPv4] [-e eNBs] [-n copies of each UE] [-S IMSI stride]"
+          " [-k K] [-P OP | -C OPc] [-R copies/s, 0 for no limit] [-w window] [-x timeout s] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((NULL == g_replay.pcap) || (0 == g_replay.num_enbs) || (0 == g_replay.copies) || (0 == g_replay.window)) {
+    fprintf (stderr, "Invalid arguments\n");
+    return -1;
+  }
+
+  CHECK_INIT_RETURN (OAILOG_INIT (LOG_MME_ENV, OAILOG_LEVEL_ERROR, MAX_LOG_PROTOS));
+  if (!replay_load_pcap (g_replay.pcap)) {
+    return -1;
+  }
+  fprintf (stdout, "%s: %u packets, %u S1AP PDUs, %u flows, %u PDUs skipped\n", g_replay.pcap, g_replay.num_packets,
+      g_replay.num_pdus, g_replay.num_flows, g_replay.num_skipped);
+  if ((!g_replay.has_s1_setup) || (0 == g_replay.num_flows) || (!g_replay.has_plmn) ||
+      (S1ap_ENB_ID_PR_macroENB_ID != g_replay.s1_setup.global_ENB_ID.eNB_ID.present)) {
+    fprintf (stderr, "The capture needs the S1 Setup Request of a macro eNB and at least one Initial UE Message\n");
+    return -1;
+  }
+  // one IMSI range per copy by default
+  if (0 == g_replay.imsi_stride) {
+    g_replay.imsi_stride = g_replay.num_flows;
+  }
+  if (!test_usim_init (&g_replay.usim, k, op, opc, g_replay.plmn)) {
+    fprintf (stderr, "Invalid K, OP or OPc\n");
+    return -1;
+  }
+  g_replay.num_ues = g_replay.num_flows * g_replay.copies;
+  AssertFatal ((g_replay.num_ues / g_replay.num_enbs) < 0xffffff, "More than 2^24 UEs per eNB");
+  g_replay.enbs  = calloc (g_replay.num_enbs, sizeof (replay_enb_t));
+  g_replay.ues   = calloc (g_replay.num_ues, sizeof (replay_ue_t));
+  g_replay.ready = calloc (g_replay.num_ues, sizeof (uint32_t));
+  AssertFatal ((NULL != g_replay.enbs) && (NULL != g_replay.ues) && (NULL != g_replay.ready), "Allocation of eNBs and UEs failed");
+  for (u = 0; u < g_replay.num_ues; u++) {
+    g_replay.ues[u].flow_index = u % g_replay.num_flows;
+    g_replay.ues[u].copy = u / g_replay.num_flows;
+    g_replay.ues[u].enb_index = u % g_replay.num_enbs;
+    g_replay.ues[u].enb_ue_s1ap_id = u / g_replay.num_enbs + 1;
+  }
+
+  signal (SIGINT, sigint_handler);
+  signal (SIGPIPE, SIG_IGN);
+  epoll_fd = epoll_create1 (0);
+  AssertFatal (0 <= epoll_fd, "epoll_create1 failed: %s", strerror (errno));
+  for (u = 0; u < g_replay.num_enbs; u++) {
+    g_replay.enbs[u].fd = -1;
+    if (0 > enb_connect (u, epoll_fd)) {
+      return -1;
+    }
+  }
+  g_replay.is_running = true;
+  g_replay.start_ns = now_ns ();
+  g_replay.last_tick_ns = g_replay.start_ns;
+  next_second_ns = g_replay.start_ns + 1000000000;
+  while (g_replay.is_running) {
+    n = epoll_wait (epoll_fd, events, REPLAY_MAX_EVENTS, 1);
+    for (c = 0; c < n; c++) {
+      enb_handle_event (events[c].data.u32, epoll_fd);
+    }
+    now = now_ns ();
+    replay_schedule (now);
+    if (now >= next_second_ns) {
+      next_second_ns += 1000000000;
+      replay_second (now, ++second);
+    }
+  }
+  replay_report (now_ns () - g_replay.start_ns);
+
+  for (u = 0; u < g_replay.num_enbs; u++) {
+    if (0 <= g_replay.enbs[u].fd) {
+      close (g_replay.enbs[u].fd);
+    }
+  }
+  close (epoll_fd);
+  for (u = 0; u < g_replay.num_latencies; u++) {
+    free (g_replay.latencies[u].ns);
+  }
+  for (u = 0; u < g_replay.num_flows; u++) {
+    free (g_replay.flows[u].messages);
+  }
+  free (g_replay.latencies);
+  free (g_replay.flow_ns);
+  free (g_replay.flows);
+  free (g_replay.ready);
+  free (g_replay.ues);
+  free (g_replay.enbs);
+  test_usim_free (&g_replay.usim);
+  OAILOG_EXIT ();
+  return (g_replay.num_completed == g_replay.num_ues) ? 0 : -1;
+}
@@ -0,0 +1,333 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+
+/*! \file oaisim_mme_secu_benchmark.c
+   \brief Cost of the NAS security primitives of SRC/SECU: EEA1, EEA2, EIA1, EIA2 over NAS PDU sizes, KDF, KeNB and KNAS derivations,
+   and Milenage of the test UE. The thread is pinned to one CPU, each case runs warm-up iterations then several runs, the median run
+   is reported in ns and in TSC cycles per message, and per byte for the ciphering and integrity algorithms.
+   Usage: oaisim_mme_secu_benchmark [-n iterations] [-w warm-up iterations] [-r runs] [-c cpu] [-o /path/to/results.json]
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#if defined(__x86_64__) || defined(__i386__)
+#  include <x86intrin.h>
+#endif
+
+#include "3gpp_33.401.h"
+#include "secu_defs.h"
+#include "oaisim_mme_test_ue.h"
+
+#define SECU_BENCHMARK_DEFAULT_ITERATIONS  20000
+#define SECU_BENCHMARK_DEFAULT_WARM_UP      2000
+#define SECU_BENCHMARK_DEFAULT_RUNS            5
+#define SECU_BENCHMARK_MAX_RUNS               31
+#define SECU_BENCHMARK_MAX_PDU_SIZE         1500
+
+/* NAS PDU sizes in bytes, from a Service Request to a large ESM container */
+static const uint32_t                   pdu_sizes[] = {16, 64, 128, 256, 512, 1024, SECU_BENCHMARK_MAX_PDU_SIZE};
+
+typedef struct secu_benchmark_case_s {
+  const char                *name;
+  bool                       is_per_byte;      /* run over pdu_sizes */
+  void                     (*operation) (const uint32_t length);
+} secu_benchmark_case_t;
+
+static uint8_t                          g_key[32] = {
+  0xd3, 0xc5, 0xd5, 0x92, 0x32, 0x7f, 0xb1, 0x1c, 0x40, 0x35, 0xc6, 0x68, 0x0a, 0xf8, 0xc6, 0xd1,
+  0x48, 0x45, 0x83, 0xd5, 0xaf, 0xe0, 0x82, 0xae, 0xb9, 0x37, 0x87, 0xe6, 0x39, 0x8a, 0x59, 0xb4};
+static uint8_t                          g_pdu[SECU_BENCHMARK_MAX_PDU_SIZE];
+static uint8_t                          g_out[SECU_BENCHMARK_MAX_PDU_SIZE];
+static uint32_t                         g_count = 0;
+static test_usim_t                      g_usim;
+static volatile uint8_t                 g_sink = 0;
+
+//------------------------------------------------------------------------------
+static uint64_t now_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t now_cycles (void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc ();
+#else
+  return 0;
+#endif
+}
+
+//------------------------------------------------------------------------------
+static void stream_cipher_init (nas_stream_cipher_t * const stream_cipher_p, const uint32_t length)
+{
+  stream_cipher_p->key        = g_key;
+  stream_cipher_p->key_length = 16;
+  stream_cipher_p->count      = g_count++;
+  stream_cipher_p->bearer     = 0;
+  stream_cipher_p->direction  = SECU_DIRECTION_DOWNLINK;
+  stream_cipher_p->message    = g_pdu;
+  stream_cipher_p->blength    = length << 3;
+}
+
+//------------------------------------------------------------------------------
+static void operation_eea1 (const uint32_t length)
+{
+  nas_stream_cipher_t       stream_cipher;
+
+  stream_cipher_init (&stream_cipher, length);
+  nas_stream_encrypt_eea1 (&stream_cipher, g_out);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+static void operation_eea2 (const uint32_t length)
+{
+  nas_stream_cipher_t       stream_cipher;
+
+  stream_cipher_init (&stream_cipher, length);
+  nas_stream_encrypt_eea2 (&stream_cipher, g_out);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+static void operation_eia1 (const uint32_t length)
+{
+  nas_stream_cipher_t       stream_cipher;
+
+  stream_cipher_init (&stream_cipher, length);
+  nas_stream_encrypt_eia1 (&stream_cipher, g_out);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+static void operation_eia2 (const uint32_t length)
+{
+  nas_stream_cipher_t       stream_cipher;
+
+  stream_cipher_init (&stream_cipher, length);
+  nas_stream_encrypt_eia2 (&stream_cipher, g_out);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+// KASME from CK || IK (TS 33.401 A.2), the KDF of an authentication
+static void operation_kdf (__attribute__ ((unused)) const uint32_t length)
+{
+  uint8_t                   s[14] = {0x10, 0x02, 0xf8, 0x59, 0x00, 0x03, 0, 0, 0, 0, 0, 0, 0x00, 0x06};
+
+  s[6] = (uint8_t)g_count++;
+  kdf (g_key, sizeof (g_key), s, sizeof (s), g_out, 32);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+static void operation_kenb (__attribute__ ((unused)) const uint32_t length)
+{
+  derive_keNB (g_key, g_count++, g_out);
+  g_sink ^= g_out[0];
+}
+
+//------------------------------------------------------------------------------
+// KNASenc and KNASint of a Security Mode Command
+static void operation_knas (__attribute__ ((unused)) const uint32_t length)
+{
+  derive_key_nas_enc (EEA2_128_ALG_ID, g_key, g_out);
+  derive_key_nas_int (EIA2_128_ALG_ID, g_key, &g_out[32]);
+  g_sink ^= g_out[0] ^ g_out[32];
+}
+
+//------------------------------------------------------------------------------
+// f1 to f5 of one authentication vector
+static void operation_milenage (__attribute__ ((unused)) const uint32_t length)
+{
+  uint8_t                   sqn[6] = {0, 0, 0, 0, 0, 0};
+  uint8_t                   amf[2] = {0x80, 0x00};
+
+  sqn[5] = (uint8_t)g_count++;
+  test_usim_milenage (&g_usim, g_pdu, sqn, amf, g_out, &g_out[8], &g_out[24], &g_out[40], &g_out[48]);
+  g_sink ^= g_out[0];
+}
+
+static const secu_benchmark_case_t      cases[] = {
+  {"eea1",     true,  operation_eea1},
+  {"eea2",     true,  operation_eea2},
+  {"eia1",     true,  operation_eia1},
+  {"eia2",     true,  operation_eia2},
+  {"kdf",      false, operation_kdf},
+  {"kenb",     false, operation_kenb},
+  {"knas",     false, operation_knas},
+  {"milenage", false, operation_milenage},
+};
+
+//------------------------------------------------------------------------------
+static int compare_uint64 (const void *a, const void *b)
+{
+  const uint64_t            x = *(const uint64_t *)a;
+  const uint64_t            y = *(const uint64_t *)b;
+
+  return (x > y) - (x < y);
+}
+
+//------------------------------------------------------------------------------
+// median of the runs of iterations operations, after warm_up operations
+static void measure (const secu_benchmark_case_t * const case_p, const uint32_t length, const uint64_t iterations, const uint64_t warm_up,
+    const int runs, double * const ns_per_op, double * const cycles_per_op)
+{
+  uint64_t                  ns[SECU_BENCHMARK_MAX_RUNS];
+  uint64_t                  cycles[SECU_BENCHMARK_MAX_RUNS];
+  uint64_t                  start_ns = 0;
+  uint64_t                  start_cycles = 0;
+  uint64_t                  i = 0;
+  int                       r = 0;
+
+  for (i = 0; i < warm_up; i++) {
+    case_p->operation (length);
+  }
+  for (r = 0; r < runs; r++) {
+    start_ns = now_ns ();
+    start_cycles = now_cycles ();
+    for (i = 0; i < iterations; i++) {
+      case_p->operation (length);
+    }
+    cycles[r] = now_cycles () - start_cycles;
+    ns[r] = now_ns () - start_ns;
+  }
+  qsort (ns, runs, sizeof (uint64_t), compare_uint64);
+  qsort (cycles, runs, sizeof (uint64_t), compare_uint64);
+  *ns_per_op = (double)ns[runs / 2] / (double)iterations;
+  *cycles_per_op = (double)cycles[runs / 2] / (double)iterations;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  const uint8_t             plmn[3] = {0x02, 0xf8, 0x59};
+  uint64_t                  iterations = SECU_BENCHMARK_DEFAULT_ITERATIONS;
+  uint64_t                  warm_up = SECU_BENCHMARK_DEFAULT_WARM_UP;
+  int                       runs = SECU_BENCHMARK_DEFAULT_RUNS;
+  int                       cpu = -1;
+  const char               *output = NULL;
+  FILE                     *json = NULL;
+  bool                      is_first_result = true;
+  cpu_set_t                 cpu_set;
+  double                    ns_per_op = 0;
+  double                    cycles_per_op = 0;
+  size_t                    k = 0;
+  size_t                    s = 0;
+  int                       c = 0;
+
+  while ((c = getopt (argc, argv, "n:w:r:c:o:")) != -1) {
+    switch (c) {
+    case 'n':
+      iterations = strtoull (optarg, NULL, 0);
+      break;
+    case 'w':
+      warm_up = strtoull (optarg, NULL, 0);
+      break;
+    case 'r':
+      runs = atoi (optarg);
+      break;
+    case 'c':
+      cpu = atoi (optarg);
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-n iterations] [-w warm-up iterations] [-r runs] [-c cpu] [-o /path/to/results.json]\n", argv[0]);
+      return -1;
+    }
+  }
+  if ((0 == iterations) || (1 > runs) || (SECU_BENCHMARK_MAX_RUNS < runs)) {
+    fprintf (stderr, "Invalid number of iterations or of runs (1 to %d)\n", SECU_BENCHMARK_MAX_RUNS);
+    return -1;
+  }
+  // stay on the CPU we start on if none is given, the TSC and the caches are those of one core
+  if (0 > cpu) {
+    cpu = sched_getcpu ();
+  }
+  CPU_ZERO (&cpu_set);
+  CPU_SET (cpu, &cpu_set);
+  if (sched_setaffinity (0, sizeof (cpu_set), &cpu_set)) {
+    fprintf (stderr, "Could not pin the benchmark on CPU %d\n", cpu);
+    return -1;
+  }
+  for (s = 0; s < sizeof (g_pdu); s++) {
+    g_pdu[s] = (uint8_t)(s * 7 + 1);
+  }
+  if (!test_usim_init (&g_usim, "8baf473f2f8fd09487cccbd7097c6862", NULL, "8e27b6af0e692e750f32667a3b14605d", plmn)) {
+    fprintf (stderr, "Could not initialize the USIM\n");
+    return -1;
+  }
+
+  if (output) {
+    json = fopen (output, "w");
+    if (NULL == json) {
+      fprintf (stderr, "Could not open %s\n", output);
+      return -1;
+    }
+    fprintf (json, "{\"benchmark\": \"secu\", \"cpu\": %d, \"iterations\": %" PRIu64 ", \"warm_up\": %" PRIu64 ", \"runs\": %d, \"results\": [\n",
+        cpu, iterations, warm_up, runs);
+  }
+  fprintf (stdout, "%-10s %8s %12s %14s %14s\n", "primitive", "bytes", "ns/op", "cycles/op", "cycles/byte");
+  for (k = 0; k < sizeof (cases) / sizeof (cases[0]); k++) {
+    for (s = 0; s < ((cases[k].is_per_byte) ? sizeof (pdu_sizes) / sizeof (pdu_sizes[0]) : 1); s++) {
+      const uint32_t          length = (cases[k].is_per_byte) ? pdu_sizes[s] : 0;
+
+      measure (&cases[k], length, iterations, warm_up, runs, &ns_per_op, &cycles_per_op);
+      if (length) {
+        fprintf (stdout, "%-10s %8u %12.1f %14.0f %14.2f\n", cases[k].name, length, ns_per_op, cycles_per_op, cycles_per_op / length);
+      } else {
+        fprintf (stdout, "%-10s %8s %12.1f %14.0f %14s\n", cases[k].name, "-", ns_per_op, cycles_per_op, "-");
+      }
+      if (json) {
+        fprintf (json, "%s  {\"primitive\": \"%s\", \"bytes\": %u, \"ns_per_op\": %.1f, \"cycles_per_op\": %.0f",
+            (is_first_result) ? "" : ",\n", cases[k].name, length, ns_per_op, cycles_per_op);
+        if (length) {
+          fprintf (json, ", \"cycles_per_byte\": %.2f", cycles_per_op / length);
+        }
+        fprintf (json, "}");
+        is_first_result = false;
+      }
+    }
+  }
+  if (json) {
+    fprintf (json, "\n]}\n");
+    fclose (json);
+  }
+  test_usim_free (&g_usim);
+  return 0;
+}
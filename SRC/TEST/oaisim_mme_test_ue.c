@@ -0,0 +1,362 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_test_ue.c
+   \brief USIM and NAS security of the UEs emulated by the S1AP test tools.
+   The HSS MILENAGE code depends on the HSS configuration, MILENAGE (3GPP TS 35.206) is redone here on nettle AES-128.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <nettle/nettle-meta.h>
+#include <nettle/aes.h>
+
+#include "3gpp_24.007.h"
+#include "3gpp_24.301.h"
+#include "secu_defs.h"
+#include "NasSecurityAlgorithms.h"
+#include "oaisim_mme_test_ue.h"
+
+#define TEST_UE_GUTI_IEI               0x50   /* Attach Accept */
+
+//------------------------------------------------------------------------------
+bool test_hex_to_bytes (const char * const hex, uint8_t * const bytes, const size_t length)
+{
+  unsigned int  byte = 0;
+  size_t        i = 0;
+
+  if (strlen (hex) != 2 * length) {
+    return false;
+  }
+  for (i = 0; i < length; i++) {
+    if (1 != sscanf (&hex[2 * i], "%2x", &byte)) {
+      return false;
+    }
+    bytes[i] = (uint8_t)byte;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void milenage_encrypt (const test_usim_t * const usim_p, const uint8_t in[16], uint8_t out[16])
+{
+  nettle_aes128.encrypt (usim_p->aes_ctx, 16, out, in);
+}
+
+//------------------------------------------------------------------------------
+// out = E[rotate(temp ^ OPc, r) ^ c]K ^ OPc, c is all zeroes except its last byte
+static void milenage_out (const test_usim_t * const usim_p, const uint8_t temp[16], const int r, const uint8_t c, uint8_t out[16])
+{
+  uint8_t         in[16];
+  int             i = 0;
+
+  for (i = 0; i < 16; i++) {
+    in[(i + 16 - r) % 16] = temp[i] ^ usim_p->opc[i];
+  }
+  in[15] ^= c;
+  milenage_encrypt (usim_p, in, out);
+  for (i = 0; i < 16; i++) {
+    out[i] ^= usim_p->opc[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+static void milenage_f1 (const test_usim_t * const usim_p, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2], uint8_t mac_a[8])
+{
+  const uint8_t  *opc = usim_p->opc;
+  uint8_t         temp[16];
+  uint8_t         in[16];
+  uint8_t         out[16];
+  int             i = 0;
+
+  for (i = 0; i < 16; i++) {
+    in[i] = rand[i] ^ opc[i];
+  }
+  milenage_encrypt (usim_p, in, temp);
+  // IN1 = SQN || AMF || SQN || AMF, rotated by r1 = 64
+  for (i = 0; i < 6; i++) {
+    in[i] = sqn[i];
+    in[i + 8] = sqn[i];
+  }
+  for (i = 0; i < 2; i++) {
+    in[i + 6] = amf[i];
+    in[i + 14] = amf[i];
+  }
+  for (i = 0; i < 16; i++) {
+    out[(i + 8) % 16] = in[i] ^ opc[i];
+  }
+  for (i = 0; i < 16; i++) {
+    out[i] ^= temp[i];
+  }
+  milenage_encrypt (usim_p, out, in);
+  for (i = 0; i < 8; i++) {
+    mac_a[i] = in[i] ^ opc[i];
+  }
+}
+
+//------------------------------------------------------------------------------
+static void milenage_f2345 (const test_usim_t * const usim_p, const uint8_t rand[16], uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6])
+{
+  uint8_t         temp[16];
+  uint8_t         in[16];
+  uint8_t         out[16];
+  int             i = 0;
+
+  for (i = 0; i < 16; i++) {
+    in[i] = rand[i] ^ usim_p->opc[i];
+  }
+  milenage_encrypt (usim_p, in, temp);
+  milenage_out (usim_p, temp, 0, 1, out);
+  memcpy (res, &out[8], 8);
+  memcpy (ak, out, 6);
+  milenage_out (usim_p, temp, 4, 2, ck);
+  milenage_out (usim_p, temp, 8, 4, ik);
+}
+
+//------------------------------------------------------------------------------
+bool test_usim_init (test_usim_t * const usim_p, const char * const k, const char * const op, const char * const opc, const uint8_t plmn[3])
+{
+  uint8_t                   k_bytes[TEST_UE_KEY_LENGTH];
+  uint8_t                   op_bytes[TEST_UE_KEY_LENGTH];
+  int                       i = 0;
+
+  memset (usim_p, 0, sizeof (*usim_p));
+  if ((!test_hex_to_bytes (k, k_bytes, sizeof (k_bytes))) ||
+      ((opc) ? !test_hex_to_bytes (opc, usim_p->opc, sizeof (usim_p->opc)) : !test_hex_to_bytes (op, op_bytes, sizeof (op_bytes)))) {
+    return false;
+  }
+  memcpy (usim_p->plmn, plmn, sizeof (usim_p->plmn));
+  usim_p->aes_ctx = malloc (nettle_aes128.context_size);
+  if (NULL == usim_p->aes_ctx) {
+    return false;
+  }
+  nettle_aes128.set_encrypt_key (usim_p->aes_ctx, sizeof (k_bytes), k_bytes);
+  if (NULL == opc) {
+    // OPc = E[OP]K ^ OP
+    milenage_encrypt (usim_p, op_bytes, usim_p->opc);
+    for (i = 0; i < TEST_UE_KEY_LENGTH; i++) {
+      usim_p->opc[i] ^= op_bytes[i];
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void test_usim_milenage (const test_usim_t * const usim_p, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2],
+    uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6], uint8_t mac_a[8])
+{
+  milenage_f2345 (usim_p, rand, res, ck, ik, ak);
+  milenage_f1 (usim_p, rand, sqn, amf, mac_a);
+}
+
+//------------------------------------------------------------------------------
+void test_usim_free (test_usim_t * const usim_p)
+{
+  free (usim_p->aes_ctx);
+  usim_p->aes_ctx = NULL;
+}
+
+//------------------------------------------------------------------------------
+static void test_ue_nas_cipher (const test_ue_security_t * const security_p, const uint32_t count, const uint8_t direction, uint8_t * const data, const size_t length)
+{
+  nas_stream_cipher_t       stream_cipher = {0};
+  uint8_t                   out[TEST_UE_NAS_MAX_LENGTH];
+
+  if ((NAS_SECURITY_ALGORITHMS_EEA0 == security_p->eea) || (0 == length) || (sizeof (out) < length)) {
+    return;
+  }
+  stream_cipher.key        = (uint8_t *)security_p->knas_enc;
+  stream_cipher.key_length = AUTH_KNAS_ENC_SIZE;
+  stream_cipher.count      = count;
+  stream_cipher.bearer     = 0x00;
+  stream_cipher.direction  = direction;
+  stream_cipher.message    = data;
+  stream_cipher.blength    = length << 3;
+  nas_stream_encrypt_eea2 (&stream_cipher, out);
+  memcpy (data, out, length);
+}
+
+//------------------------------------------------------------------------------
+static void test_ue_nas_mac (const test_ue_security_t * const security_p, const uint32_t count, uint8_t * const data, const size_t length, uint8_t mac[4])
+{
+  nas_stream_cipher_t       stream_cipher = {0};
+
+  stream_cipher.key        = (uint8_t *)security_p->knas_int;
+  stream_cipher.key_length = AUTH_KNAS_INT_SIZE;
+  stream_cipher.count      = count;
+  stream_cipher.bearer     = 0x00;
+  stream_cipher.direction  = SECU_DIRECTION_UPLINK;
+  stream_cipher.message    = data;
+  stream_cipher.blength    = length << 3;
+  nas_stream_encrypt_eia2 (&stream_cipher, mac);
+}
+
+//------------------------------------------------------------------------------
+size_t test_ue_nas_protect (test_ue_security_t * const security_p, const uint8_t security_header_type,
+    const uint8_t * const plain, const size_t plain_length, uint8_t * const nas)
+{
+  nas[0] = (security_header_type << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[5] = (uint8_t)security_p->ul_count;
+  memcpy (&nas[6], plain, plain_length);
+  if ((SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED == security_header_type) ||
+      (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW == security_header_type)) {
+    test_ue_nas_cipher (security_p, security_p->ul_count, SECU_DIRECTION_UPLINK, &nas[6], plain_length);
+  }
+  test_ue_nas_mac (security_p, security_p->ul_count, &nas[5], plain_length + 1, &nas[1]);
+  security_p->ul_count++;
+  return plain_length + 6;
+}
+
+//------------------------------------------------------------------------------
+uint8_t *test_ue_nas_unprotect (test_ue_security_t * const security_p, uint8_t * const nas, const size_t length, size_t * const plain_length)
+{
+  uint8_t                   security_header_type = 0;
+  uint8_t                   sequence = 0;
+
+  if (2 > length) {
+    return NULL;
+  }
+  security_header_type = nas[0] >> 4;
+  if ((SECURITY_HEADER_TYPE_NOT_PROTECTED == security_header_type) || (EPS_MOBILITY_MANAGEMENT_MESSAGE != (nas[0] & 0x0f))) {
+    *plain_length = length;
+    return nas;
+  }
+  if (8 > length) {
+    return NULL;
+  }
+  sequence = nas[5];
+  if ((SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_NEW == security_header_type) ||
+      (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW == security_header_type)) {
+    security_p->dl_count = 0;
+  } else if (sequence < (security_p->dl_count & 0xff)) {
+    security_p->dl_count += 0x100;
+  }
+  security_p->dl_count = (security_p->dl_count & 0xffffff00) | sequence;
+  *plain_length = length - 6;
+  if ((SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED == security_header_type) ||
+      (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW == security_header_type)) {
+    test_ue_nas_cipher (security_p, security_p->dl_count, SECU_DIRECTION_DOWNLINK, &nas[6], *plain_length);
+  }
+  return &nas[6];
+}
+
+//------------------------------------------------------------------------------
+size_t test_ue_authenticate (const test_usim_t * const usim_p, test_ue_security_t * const security_p,
+    const uint8_t * const plain, const size_t plain_length, uint8_t * const nas)
+{
+  const uint8_t            *rand = &plain[3];
+  const uint8_t            *autn = &plain[20];
+  uint8_t                   res[8];
+  uint8_t                   ck[16];
+  uint8_t                   ik[16];
+  uint8_t                   ak[6];
+  uint8_t                   sqn[6];
+  uint8_t                   mac_a[8];
+  uint8_t                   key[32];
+  uint8_t                   s[14];
+  int                       i = 0;
+
+  if ((36 > plain_length) || (16 != plain[19])) {
+    return 0;
+  }
+  security_p->ksi = plain[2] & 0x07;
+  milenage_f2345 (usim_p, rand, res, ck, ik, ak);
+  for (i = 0; i < 6; i++) {
+    sqn[i] = autn[i] ^ ak[i];
+  }
+  milenage_f1 (usim_p, rand, sqn, &autn[6], mac_a);
+  if (memcmp (mac_a, &autn[8], sizeof (mac_a))) {
+    return 0;
+  }
+  // KASME (TS 33.401 A.2), SQN is not checked
+  memcpy (key, ck, sizeof (ck));
+  memcpy (&key[16], ik, sizeof (ik));
+  s[0] = 0x10;
+  memcpy (&s[1], usim_p->plmn, 3);
+  s[4] = 0x00;
+  s[5] = 0x03;
+  memcpy (&s[6], autn, 6);
+  s[12] = 0x00;
+  s[13] = 0x06;
+  kdf (key, sizeof (key), s, sizeof (s), security_p->kasme, AUTH_KASME_SIZE);
+
+  nas[0] = (SECURITY_HEADER_TYPE_NOT_PROTECTED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[1] = AUTHENTICATION_RESPONSE;
+  nas[2] = sizeof (res);
+  memcpy (&nas[3], res, sizeof (res));
+  return 3 + sizeof (res);
+}
+
+//------------------------------------------------------------------------------
+size_t test_ue_security_mode (test_ue_security_t * const security_p, const uint8_t * const plain, const size_t plain_length, uint8_t * const nas)
+{
+  const uint8_t             complete[] = {EPS_MOBILITY_MANAGEMENT_MESSAGE, SECURITY_MODE_COMPLETE};
+  uint8_t                   eia = 0;
+
+  if (3 > plain_length) {
+    return 0;
+  }
+  security_p->eea = (plain[2] >> 4) & 0x07;
+  eia = plain[2] & 0x07;
+  if (((NAS_SECURITY_ALGORITHMS_EEA0 != security_p->eea) && (NAS_SECURITY_ALGORITHMS_EEA2 != security_p->eea)) || (NAS_SECURITY_ALGORITHMS_EIA2 != eia)) {
+    return 0;
+  }
+  derive_key_nas (NAS_INT_ALG, eia, security_p->kasme, security_p->knas_int);
+  derive_key_nas (NAS_ENC_ALG, security_p->eea, security_p->kasme, security_p->knas_enc);
+  security_p->ul_count = 0;
+  return test_ue_nas_protect (security_p, SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED_NEW, complete, sizeof (complete), nas);
+}
+
+//------------------------------------------------------------------------------
+bool test_ue_nas_decode_attach_accept_guti (const uint8_t * const plain, const size_t plain_length, uint8_t guti[TEST_UE_GUTI_LENGTH])
+{
+  size_t                    offset = 4;
+
+  // EPS attach result, T3412 value, TAI list, ESM message container, then the GUTI is the first optional IE
+  if (offset < plain_length) {
+    offset += 1 + plain[offset];
+  }
+  if ((offset + 1) < plain_length) {
+    offset += 2 + ((plain[offset] << 8) | plain[offset + 1]);
+  }
+  if (((offset + 2 + TEST_UE_GUTI_LENGTH) <= plain_length) && (TEST_UE_GUTI_IEI == plain[offset]) && (TEST_UE_GUTI_LENGTH == plain[offset + 1])) {
+    memcpy (guti, &plain[offset + 2], TEST_UE_GUTI_LENGTH);
+    return true;
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+size_t test_ue_nas_encode_service_request (test_ue_security_t * const security_p, uint8_t * const nas)
+{
+  uint8_t                   mac[4];
+
+  nas[0] = (SECURITY_HEADER_TYPE_SERVICE_REQUEST << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+  nas[1] = (security_p->ksi << 5) | (security_p->ul_count & 0x1f);
+  test_ue_nas_mac (security_p, security_p->ul_count, nas, 2, mac);
+  nas[2] = mac[2];
+  nas[3] = mac[3];
+  security_p->ul_count++;
+  return 4;
+}
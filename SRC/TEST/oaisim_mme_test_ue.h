@@ -0,0 +1,85 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file oaisim_mme_test_ue.h
+   \brief USIM and NAS security of the UEs emulated by the S1AP test tools.
+   MILENAGE with one K and OP (or OPc) for all UEs, EIA2 integrity, EEA0 or EEA2 ciphering.
+*/
+#ifndef FILE_OAISIM_MME_TEST_UE_SEEN
+#define FILE_OAISIM_MME_TEST_UE_SEEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "securityDef.h"
+
+#define TEST_UE_KEY_LENGTH               16
+#define TEST_UE_NAS_MAX_LENGTH          256
+#define TEST_UE_GUTI_LENGTH              11   /* EPS mobile identity GUTI, without length */
+
+typedef struct test_usim_s {
+  void                      *aes_ctx;          /* K */
+  uint8_t                    opc[TEST_UE_KEY_LENGTH];
+  uint8_t                    plmn[3];          /* serving network identity of KASME, TBCD */
+} test_usim_t;
+
+typedef struct test_ue_security_s {
+  uint8_t                    ksi;
+  uint8_t                    kasme[AUTH_KASME_SIZE];
+  uint8_t                    knas_int[AUTH_KNAS_INT_SIZE];
+  uint8_t                    knas_enc[AUTH_KNAS_ENC_SIZE];
+  uint8_t                    eea;
+  uint32_t                   ul_count;
+  uint32_t                   dl_count;
+} test_ue_security_t;
+
+bool test_hex_to_bytes (const char * const hex, uint8_t * const bytes, const size_t length);
+
+/* K and OP, or K and OPc if opc is not NULL, as hexadecimal strings */
+bool test_usim_init (test_usim_t * const usim_p, const char * const k, const char * const op, const char * const opc, const uint8_t plmn[3]);
+
+void test_usim_free (test_usim_t * const usim_p);
+
+/* Milenage f1 to f5 of an authentication vector (TS 35.206) */
+void test_usim_milenage (const test_usim_t * const usim_p, const uint8_t rand[16], const uint8_t sqn[6], const uint8_t amf[2],
+    uint8_t res[8], uint8_t ck[16], uint8_t ik[16], uint8_t ak[6], uint8_t mac_a[8]);
+
+/* Authentication Request, returns the length of the Authentication Response, 0 if the network is not authenticated */
+size_t test_ue_authenticate (const test_usim_t * const usim_p, test_ue_security_t * const security_p,
+    const uint8_t * const plain, const size_t plain_length, uint8_t * const nas);
+
+/* Security Mode Command, returns the length of the Security Mode Complete, 0 if algorithms are not supported */
+size_t test_ue_security_mode (test_ue_security_t * const security_p, const uint8_t * const plain, const size_t plain_length, uint8_t * const nas);
+
+/* Security protected NAS message, ciphered if the security header type says so */
+size_t test_ue_nas_protect (test_ue_security_t * const security_p, const uint8_t security_header_type,
+    const uint8_t * const plain, const size_t plain_length, uint8_t * const nas);
+
+/* Plain NAS message of a downlink NAS PDU, deciphered in place, NULL if it can not be read */
+uint8_t *test_ue_nas_unprotect (test_ue_security_t * const security_p, uint8_t * const nas, const size_t length, size_t * const plain_length);
+
+/* GUTI of an Attach Accept, false if there is none */
+bool test_ue_nas_decode_attach_accept_guti (const uint8_t * const plain, const size_t plain_length, uint8_t guti[TEST_UE_GUTI_LENGTH]);
+
+size_t test_ue_nas_encode_service_request (test_ue_security_t * const security_p, uint8_t * const nas);
+
+#endif /* FILE_OAISIM_MME_TEST_UE_SEEN */
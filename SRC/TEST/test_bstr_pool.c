@@ -0,0 +1,122 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bstrlib.h"
+#include "bstr_pool.h"
+
+#define TEST_BSTR_POOL_ITEMS      3
+#define TEST_BSTR_POOL_CAPACITY   100
+
+static bstr_pool_t *pool = NULL;
+
+static void bstr_pool_setup(void)
+{
+    pool = bstr_pool_create(TEST_BSTR_POOL_ITEMS, TEST_BSTR_POOL_CAPACITY);
+    ck_assert(pool != NULL);
+}
+
+static void bstr_pool_teardown(void)
+{
+    bstr_pool_destroy(pool);
+    pool = NULL;
+}
+
+START_TEST(bstr_pool_get_release_test)
+{
+    bstring b[TEST_BSTR_POOL_ITEMS];
+    bstr_pool_stats_t stats;
+
+    ck_assert_uint_eq(bstr_pool_capacity(pool), TEST_BSTR_POOL_CAPACITY);
+    for (int i = 0; i < TEST_BSTR_POOL_ITEMS; i++) {
+        b[i] = bstr_pool_get(pool);
+        ck_assert(b[i] != NULL);
+        ck_assert_int_eq(blength(b[i]), 0);
+        /* The whole capacity can be written */
+        memset(b[i]->data, i, TEST_BSTR_POOL_CAPACITY);
+        b[i]->slen = TEST_BSTR_POOL_CAPACITY;
+    }
+    for (int i = 0; i < TEST_BSTR_POOL_ITEMS; i++) {
+        ck_assert_int_eq(b[i]->data[0], i);
+        ck_assert_int_eq(b[i]->data[TEST_BSTR_POOL_CAPACITY - 1], i);
+    }
+
+    /* Exhausted */
+    ck_assert(bstr_pool_get(pool) == NULL);
+    bstr_pool_get_stats(pool, &stats);
+    ck_assert_uint_eq(stats.used, TEST_BSTR_POOL_ITEMS);
+    ck_assert_uint_eq(stats.exhausted, 1);
+
+    /* The last item given back is the next taken */
+    bstr_pool_release(&b[1]);
+    ck_assert(b[1] == NULL);
+    b[1] = bstr_pool_get(pool);
+    ck_assert(b[1] != NULL);
+    ck_assert_int_eq(blength(b[1]), 0);
+
+    for (int i = 0; i < TEST_BSTR_POOL_ITEMS; i++) {
+        bstr_pool_release(&b[i]);
+    }
+    bstr_pool_get_stats(pool, &stats);
+    ck_assert_uint_eq(stats.used, 0);
+    ck_assert_uint_eq(stats.peak_used, TEST_BSTR_POOL_ITEMS);
+    ck_assert_uint_eq(stats.gets, TEST_BSTR_POOL_ITEMS + 1);
+}
+END_TEST
+
+START_TEST(bstr_pool_not_owned_test)
+{
+    bstring b = bstr_pool_get(pool);
+    bstring other = bfromcstr("not from a pool");
+    bstr_pool_stats_t stats;
+
+    /* bstrlib neither frees nor resizes a bstring of a pool */
+    ck_assert_int_eq(bdestroy(b), BSTR_ERR);
+    ck_assert_int_eq(bconchar(b, 'x'), BSTR_ERR);
+    bstr_pool_release(&b);
+
+    /* Other bstrings are destroyed */
+    bstr_pool_release(&other);
+    ck_assert(other == NULL);
+    bstr_pool_release(&other);
+
+    bstr_pool_get_stats(pool, &stats);
+    ck_assert_uint_eq(stats.used, 0);
+}
+END_TEST
+
+Suite * bstr_pool_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("bstring pool tests");
+
+    /* Core test case */
+    tc_core = tcase_create("bstring pool test");
+    tcase_add_checked_fixture(tc_core, bstr_pool_setup, bstr_pool_teardown);
+    tcase_add_test(tc_core, bstr_pool_get_release_test);
+    tcase_add_test(tc_core, bstr_pool_not_owned_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create bstring pool Test Suite */
+    s = bstr_pool_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
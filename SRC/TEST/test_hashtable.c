@@ -0,0 +1,178 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+#include "hashtable.h"
+
+#define TEST_HASHTABLE_INITIAL_SIZE  64
+#define TEST_HASHTABLE_KEYS          1000    /* inserted before and after the resize, many times the initial size */
+
+/* Spread keys, data is the key index (pointer = value) */
+static hash_key_t test_key(const int i)
+{
+    return ((hash_key_t)i * 0x9E3779B97F4A7C15ULL) ^ 0x5555;
+}
+
+START_TEST(hashtable_resize_test)
+{
+    hash_table_t *htbl;
+    hashtable_stats_t stats;
+    void *data;
+    int i;
+
+    htbl = hashtable_create(TEST_HASHTABLE_INITIAL_SIZE, NULL, hash_free_int_func, NULL);
+    ck_assert(htbl != NULL);
+    for (i = 0; i < TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_insert(htbl, test_key(i), (void *)(uintptr_t)i), HASH_TABLE_OK);
+    }
+
+    /* Grow, then insert as many keys again */
+    ck_assert_int_eq(hashtable_resize(htbl, 4 * TEST_HASHTABLE_KEYS), HASH_TABLE_OK);
+    for (i = TEST_HASHTABLE_KEYS; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_insert(htbl, test_key(i), (void *)(uintptr_t)i), HASH_TABLE_OK);
+    }
+
+    /* Check every key is found with its data and the count is right */
+    for (i = 0; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_get(htbl, test_key(i), &data), HASH_TABLE_OK);
+        ck_assert_uint_eq((uintptr_t)data, i);
+    }
+    ck_assert_int_eq(hashtable_is_key_exists(htbl, test_key(2 * TEST_HASHTABLE_KEYS)), HASH_TABLE_KEY_NOT_EXISTS);
+    ck_assert_uint_eq(htbl->num_elements, 2 * TEST_HASHTABLE_KEYS);
+    ck_assert_int_eq(hashtable_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.num_elements, 2 * TEST_HASHTABLE_KEYS);
+    ck_assert_uint_eq(stats.size, 4096);
+    ck_assert_uint_eq(stats.resizes, 1);
+
+    /* Shrink below the number of keys, then remove them all */
+    ck_assert_int_eq(hashtable_resize(htbl, TEST_HASHTABLE_INITIAL_SIZE), HASH_TABLE_OK);
+    for (i = 0; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_remove(htbl, test_key(i), &data), HASH_TABLE_OK);
+        ck_assert_uint_eq((uintptr_t)data, i);
+    }
+    ck_assert_uint_eq(htbl->num_elements, 0);
+    ck_assert_int_eq(hashtable_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.num_elements, 0);
+    ck_assert_uint_eq(stats.resizes, 2);
+    hashtable_destroy(htbl);
+}
+END_TEST
+
+START_TEST(hashtable_ts_resize_test)
+{
+    hash_table_ts_t *htbl;
+    hashtable_stats_t stats;
+    void *data;
+    int i;
+
+    htbl = hashtable_ts_create(TEST_HASHTABLE_INITIAL_SIZE, NULL, hash_free_int_func, NULL);
+    ck_assert(htbl != NULL);
+    for (i = 0; i < TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_ts_insert(htbl, test_key(i), (void *)(uintptr_t)i), HASH_TABLE_OK);
+    }
+
+    /* Grow, then insert as many keys again */
+    ck_assert_int_eq(hashtable_ts_resize(htbl, 4 * TEST_HASHTABLE_KEYS), HASH_TABLE_OK);
+    for (i = TEST_HASHTABLE_KEYS; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_ts_insert(htbl, test_key(i), (void *)(uintptr_t)i), HASH_TABLE_OK);
+    }
+
+    /* Check every key is found with its data and the count is right */
+    for (i = 0; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_ts_get(htbl, test_key(i), &data), HASH_TABLE_OK);
+        ck_assert_uint_eq((uintptr_t)data, i);
+    }
+    ck_assert_int_eq(hashtable_ts_is_key_exists(htbl, test_key(2 * TEST_HASHTABLE_KEYS)), HASH_TABLE_KEY_NOT_EXISTS);
+    ck_assert_uint_eq(htbl->num_elements, 2 * TEST_HASHTABLE_KEYS);
+    ck_assert_int_eq(hashtable_ts_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.num_elements, 2 * TEST_HASHTABLE_KEYS);
+    ck_assert_uint_eq(stats.size, 4096);
+    ck_assert_uint_eq(stats.resizes, 1);
+
+    /* Shrink below the number of keys, then remove them all */
+    ck_assert_int_eq(hashtable_ts_resize(htbl, TEST_HASHTABLE_INITIAL_SIZE), HASH_TABLE_OK);
+    for (i = 0; i < 2 * TEST_HASHTABLE_KEYS; i++) {
+        ck_assert_int_eq(hashtable_ts_remove(htbl, test_key(i), &data), HASH_TABLE_OK);
+        ck_assert_uint_eq((uintptr_t)data, i);
+    }
+    ck_assert_uint_eq(htbl->num_elements, 0);
+    ck_assert_int_eq(hashtable_ts_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.num_elements, 0);
+    ck_assert_uint_eq(stats.resizes, 2);
+    hashtable_ts_destroy(htbl);
+}
+END_TEST
+
+static void *lookup_thread(void *arg)
+{
+    const hash_table_ts_t *const_htbl = arg;
+
+    return (void *)(uintptr_t)hashtable_ts_is_key_exists(const_htbl, test_key(1));
+}
+
+START_TEST(hashtable_ts_lock_stats_test)
+{
+    hash_table_ts_t *htbl;
+    hashtable_stats_t stats;
+    hash_size_t hash;
+    pthread_t thread;
+    void *rc;
+
+    htbl = hashtable_ts_create(TEST_HASHTABLE_INITIAL_SIZE, NULL, hash_free_int_func, NULL);
+    ck_assert(htbl != NULL);
+    ck_assert_int_eq(hashtable_ts_insert(htbl, test_key(1), (void *)(uintptr_t)1), HASH_TABLE_OK);
+    ck_assert_int_eq(hashtable_ts_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.lock_contentions, 0);
+
+    /* Check a lookup on a const table waiting for its bucket is counted */
+    hash = htbl->hashfunc(test_key(1)) % htbl->size;
+    pthread_mutex_lock(&htbl->lock_nodes[hash]);
+    ck_assert_int_eq(pthread_create(&thread, NULL, lookup_thread, htbl), 0);
+    usleep(20000);
+    pthread_mutex_unlock(&htbl->lock_nodes[hash]);
+    pthread_join(thread, &rc);
+    ck_assert_int_eq((uintptr_t)rc, HASH_TABLE_OK);
+    ck_assert_int_eq(hashtable_ts_get_stats(htbl, &stats), HASH_TABLE_OK);
+    ck_assert_uint_eq(stats.lock_contentions, 1);
+    ck_assert(stats.lock_wait_ns > 0);
+    hashtable_ts_destroy(htbl);
+}
+END_TEST
+
+Suite * hashtable_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Hashtable tests");
+
+    /* Core test case */
+    tc_core = tcase_create("Hashtable test");
+    tcase_add_test(tc_core, hashtable_resize_test);
+    tcase_add_test(tc_core, hashtable_ts_resize_test);
+    tcase_add_test(tc_core, hashtable_ts_lock_stats_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create Hashtable Test Suite */
+    s = hashtable_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
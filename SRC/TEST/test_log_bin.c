@@ -0,0 +1,138 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bstrlib.h"
+#include "log.h"
+
+#define TEST_LOG_BIN_MAX_LINE_LENGTH  512
+#define TEST_LOG_BIN_FILE_TEMPLATE    "/tmp/test_log_bin_XXXXXX"
+
+static char log_file[sizeof(TEST_LOG_BIN_FILE_TEMPLATE)];
+
+static void log_bin_setup(void)
+{
+    log_config_t config = {0};
+    int fd;
+
+    strcpy(log_file, TEST_LOG_BIN_FILE_TEMPLATE);
+    fd = mkstemp(log_file);
+
+    ck_assert(fd >= 0);
+    close(fd);
+    ck_assert_int_eq(log_init(LOG_MME_ENV, OAILOG_LEVEL_ERROR, 4), 0);
+    config.udp_log_level = config.gtpv1u_log_level = config.gtpv2c_log_level = config.sctp_log_level = config.s1ap_log_level = MAX_LOG_LEVEL;
+    config.nas_log_level = config.mme_app_log_level = config.spgw_app_log_level = config.s11_log_level = config.s6a_log_level = MAX_LOG_LEVEL;
+    config.msc_log_level = config.itti_log_level = MAX_LOG_LEVEL;
+    config.util_log_level = OAILOG_LEVEL_INFO;
+    config.output = bfromcstr(log_file);
+    config.is_output_thread_safe = true;
+    config.is_output_binary = true;
+    log_set_config(&config);
+    bdestroy(config.output);
+}
+
+static void log_bin_teardown(void)
+{
+    log_exit();
+    unlink(log_file);
+}
+
+/* Check the last line of the log file ends with the expected message */
+static bool log_bin_last_line_ends_with(const char * const expected)
+{
+    char  line[TEST_LOG_BIN_MAX_LINE_LENGTH];
+    char  last_line[TEST_LOG_BIN_MAX_LINE_LENGTH] = {0};
+    FILE *file;
+
+    log_flush_messages();
+    file = fopen(log_file, "r");
+    if (file == NULL) {
+        return false;
+    }
+    while (fgets(line, sizeof(line), file)) {
+        strcpy(last_line, line);
+    }
+    fclose(file);
+    return (strlen(last_line) >= strlen(expected)) && (0 == strcmp(&last_line[strlen(last_line) - strlen(expected)], expected));
+}
+
+START_TEST(log_bin_star_width_test)
+{
+    log_call_site_t call_site = {.source_file = __FILE__, .line_num = __LINE__};
+
+    log_message_site(&call_site, OAILOG_LEVEL_INFO, LOG_UTIL, "width [%*d]\n", 6, 42);
+    ck_assert(call_site.is_binary_capable);
+    ck_assert_uint_eq(call_site.num_args, 2);
+    ck_assert(log_bin_last_line_ends_with("width [    42]\n"));
+
+    /* A negative width is a '-' flag */
+    log_message_site(&call_site, OAILOG_LEVEL_INFO, LOG_UTIL, "width [%*d]\n", -6, 42);
+    ck_assert(log_bin_last_line_ends_with("width [42    ]\n"));
+}
+END_TEST
+
+START_TEST(log_bin_star_precision_test)
+{
+    log_call_site_t call_site = {.source_file = __FILE__, .line_num = __LINE__};
+
+    log_message_site(&call_site, OAILOG_LEVEL_INFO, LOG_UTIL, "precision [%.*d] [%s]\n", 4, 7, "next");
+    ck_assert(call_site.is_binary_capable);
+    ck_assert_uint_eq(call_site.num_args, 3);
+    ck_assert(log_bin_last_line_ends_with("precision [0007] [next]\n"));
+
+    /* A negative precision is taken as if it was omitted */
+    log_message_site(&call_site, OAILOG_LEVEL_INFO, LOG_UTIL, "precision [%.*d] [%s]\n", -1, 7, "next");
+    ck_assert(log_bin_last_line_ends_with("precision [7] [next]\n"));
+}
+END_TEST
+
+START_TEST(log_bin_star_width_precision_test)
+{
+    log_call_site_t call_site = {.source_file = __FILE__, .line_num = __LINE__};
+
+    log_message_site(&call_site, OAILOG_LEVEL_INFO, LOG_UTIL, "both [%*.*f] [%d]\n", 10, 3, 3.14159, 99);
+    ck_assert(call_site.is_binary_capable);
+    ck_assert_uint_eq(call_site.num_args, 4);
+    ck_assert(log_bin_last_line_ends_with("both [     3.142] [99]\n"));
+}
+END_TEST
+
+Suite * log_bin_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Binary log tests");
+
+    /* Core test case */
+    tc_core = tcase_create("Binary log test");
+    tcase_add_checked_fixture(tc_core, log_bin_setup, log_bin_teardown);
+    tcase_add_test(tc_core, log_bin_star_width_test);
+    tcase_add_test(tc_core, log_bin_star_precision_test);
+    tcase_add_test(tc_core, log_bin_star_width_precision_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create Binary log Test Suite */
+    s = log_bin_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
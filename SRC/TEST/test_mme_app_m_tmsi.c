@@ -0,0 +1,158 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "common_types.h"
+#include "common_defs.h"
+#include "mme_app_m_tmsi.h"
+
+#define TEST_M_TMSI_POOL_SIZE    1024    /* smallest pool, one slot per UE */
+#define TEST_M_TMSI_PREFIX       0x2
+#define TEST_M_TMSI_PREFIX_BITS  2
+
+/* Owners are only compared, the addresses of these UEs stand for UE contexts */
+static char    ue[TEST_M_TMSI_POOL_SIZE + 1];
+static tmsi_t  m_tmsi[TEST_M_TMSI_POOL_SIZE];
+
+static int tmsi_compare(const void *a, const void *b)
+{
+    tmsi_t x = *(const tmsi_t *)a;
+    tmsi_t y = *(const tmsi_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void m_tmsi_setup(void)
+{
+    ck_assert_int_eq(mme_app_m_tmsi_pool_init(TEST_M_TMSI_POOL_SIZE, TEST_M_TMSI_PREFIX, TEST_M_TMSI_PREFIX_BITS), RETURNok);
+}
+
+static void m_tmsi_teardown(void)
+{
+    mme_app_m_tmsi_pool_exit();
+}
+
+START_TEST(m_tmsi_unique_test)
+{
+    tmsi_t sorted[TEST_M_TMSI_POOL_SIZE];
+    int i;
+
+    for (i = 0; i < TEST_M_TMSI_POOL_SIZE; i++) {
+        m_tmsi[i] = mme_app_m_tmsi_allocate(&ue[i]);
+        ck_assert_uint_ne(m_tmsi[i], INVALID_M_TMSI);
+        /* Check the prefix of the MME */
+        ck_assert_uint_eq(m_tmsi[i] >> (32 - TEST_M_TMSI_PREFIX_BITS), TEST_M_TMSI_PREFIX);
+        sorted[i] = m_tmsi[i];
+    }
+    ck_assert_uint_eq(mme_app_m_tmsi_nb_allocated(), TEST_M_TMSI_POOL_SIZE);
+
+    /* Check no two live UEs share an M-TMSI */
+    qsort(sorted, TEST_M_TMSI_POOL_SIZE, sizeof(tmsi_t), tmsi_compare);
+    for (i = 1; i < TEST_M_TMSI_POOL_SIZE; i++) {
+        ck_assert_uint_ne(sorted[i - 1], sorted[i]);
+    }
+
+    /* Check the pool is exhausted */
+    ck_assert_uint_eq(mme_app_m_tmsi_allocate(&ue[TEST_M_TMSI_POOL_SIZE]), INVALID_M_TMSI);
+}
+END_TEST
+
+START_TEST(m_tmsi_reuse_test)
+{
+    tmsi_t new_m_tmsi;
+    int i;
+
+    for (i = 0; i < TEST_M_TMSI_POOL_SIZE; i++) {
+        m_tmsi[i] = mme_app_m_tmsi_allocate(&ue[i]);
+        ck_assert_uint_ne(m_tmsi[i], INVALID_M_TMSI);
+    }
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[7], &ue[7]) == true);
+    ck_assert_uint_eq(mme_app_m_tmsi_nb_allocated(), TEST_M_TMSI_POOL_SIZE - 1);
+
+    /* Only one slot is free, it is reused with a new generation */
+    new_m_tmsi = mme_app_m_tmsi_allocate(&ue[TEST_M_TMSI_POOL_SIZE]);
+    ck_assert_uint_ne(new_m_tmsi, INVALID_M_TMSI);
+    ck_assert_uint_ne(new_m_tmsi, m_tmsi[7]);
+    for (i = 0; i < TEST_M_TMSI_POOL_SIZE; i++) {
+        ck_assert_uint_ne(new_m_tmsi, m_tmsi[i]);
+    }
+
+    /* Check the old M-TMSI of the slot is stale */
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[7], &ue[7]) == false);
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[7], &ue[TEST_M_TMSI_POOL_SIZE]) == false);
+    ck_assert(mme_app_m_tmsi_release(new_m_tmsi, &ue[TEST_M_TMSI_POOL_SIZE]) == true);
+    ck_assert_uint_eq(mme_app_m_tmsi_nb_allocated(), TEST_M_TMSI_POOL_SIZE - 1);
+}
+END_TEST
+
+START_TEST(m_tmsi_foreign_owner_test)
+{
+    tmsi_t other_mme_m_tmsi;
+
+    m_tmsi[0] = mme_app_m_tmsi_allocate(&ue[0]);
+    m_tmsi[1] = mme_app_m_tmsi_allocate(&ue[1]);
+
+    /* Check a UE context cannot release or move the M-TMSI of another one */
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[0], &ue[1]) == false);
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[0], NULL) == false);
+    ck_assert(mme_app_m_tmsi_move(m_tmsi[0], &ue[1], &ue[2]) == false);
+    ck_assert_uint_eq(mme_app_m_tmsi_nb_allocated(), 2);
+
+    /* Check M-TMSIs of another MME prefix are ignored */
+    other_mme_m_tmsi = (m_tmsi[0] & ~(0xFFFFFFFFU << (32 - TEST_M_TMSI_PREFIX_BITS))) | (1U << (32 - TEST_M_TMSI_PREFIX_BITS));
+    ck_assert(mme_app_m_tmsi_release(other_mme_m_tmsi, &ue[0]) == false);
+    ck_assert(mme_app_m_tmsi_release(INVALID_M_TMSI, &ue[0]) == false);
+
+    /* Check the owner releases it after a move */
+    ck_assert(mme_app_m_tmsi_move(m_tmsi[0], &ue[0], &ue[2]) == true);
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[0], &ue[0]) == false);
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[0], &ue[2]) == true);
+    ck_assert(mme_app_m_tmsi_release(m_tmsi[1], &ue[1]) == true);
+    ck_assert_uint_eq(mme_app_m_tmsi_nb_allocated(), 0);
+}
+END_TEST
+
+START_TEST(m_tmsi_invalid_prefix_test)
+{
+    ck_assert_int_eq(mme_app_m_tmsi_pool_init(TEST_M_TMSI_POOL_SIZE, 0x4, 2), RETURNerror);
+    ck_assert_int_eq(mme_app_m_tmsi_pool_init(TEST_M_TMSI_POOL_SIZE, 0x1, 3), RETURNerror);
+    ck_assert_int_eq(mme_app_m_tmsi_pool_init(TEST_M_TMSI_POOL_SIZE, 0x1, 10), RETURNerror);
+}
+END_TEST
+
+Suite * m_tmsi_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("M-TMSI tests");
+
+    /* Core test case */
+    tc_core = tcase_create("M-TMSI test");
+    tcase_add_checked_fixture(tc_core, m_tmsi_setup, m_tmsi_teardown);
+    tcase_add_test(tc_core, m_tmsi_unique_test);
+    tcase_add_test(tc_core, m_tmsi_reuse_test);
+    tcase_add_test(tc_core, m_tmsi_foreign_owner_test);
+    tcase_add_test(tc_core, m_tmsi_invalid_prefix_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create M-TMSI Test Suite */
+    s = m_tmsi_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,247 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "log.h"
+#include "intertask_interface_init.h"
+#include "mme_config.h"
+#include "mme_app_ue_context.h"
+#include "mme_app_defs.h"
+#include "mme_app_overload.h"
+
+#define TEST_OVERLOAD_START_LOAD           80
+#define TEST_OVERLOAD_STOP_LOAD            50
+#define TEST_OVERLOAD_MAX_TRANSACTIONS     10   /* one S11 transaction is 10% of load */
+
+/* No UE context collection: the load only comes from the queues and the transactions */
+mme_app_desc_t mme_app_desc;
+
+static void overload_config_init(mme_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+    config->max_ues = 100;
+    config->overload_config.start_load = TEST_OVERLOAD_START_LOAD;
+    config->overload_config.stop_load = TEST_OVERLOAD_STOP_LOAD;
+    config->overload_config.max_s6a_transactions = TEST_OVERLOAD_MAX_TRANSACTIONS;
+    config->overload_config.max_s11_transactions = TEST_OVERLOAD_MAX_TRANSACTIONS;
+    config->overload_config.action = OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT;
+}
+
+static void overload_setup(void)
+{
+    mme_config_t config;
+
+    overload_config_init(&config);
+    ck_assert_int_eq(mme_app_overload_init(&config), 0);
+    mme_app_desc.s11_task_id = TASK_S11;
+}
+
+/* Returns the id of the message MME_APP sent to S1AP, or -1 if none */
+static int overload_s1ap_message(uint32_t *load_percent, overload_action_t *action)
+{
+    MessageDef *message_p = NULL;
+    int message_id;
+
+    itti_poll_msg(TASK_S1AP, &message_p);
+    if (message_p == NULL) {
+        return -1;
+    }
+    message_id = ITTI_MSG_ID(message_p);
+    if (S1AP_OVERLOAD_START == message_id) {
+        *action = S1AP_OVERLOAD_START(message_p).action;
+        *load_percent = S1AP_OVERLOAD_START(message_p).load_percent;
+    } else if (S1AP_OVERLOAD_STOP == message_id) {
+        *load_percent = S1AP_OVERLOAD_STOP(message_p).load_percent;
+    }
+    itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
+    return message_id;
+}
+
+static void overload_set_s11_transactions(uint32_t transactions)
+{
+    mme_app_overload_stats_t stats;
+
+    mme_app_overload_get_stats(&stats);
+    for (; stats.transactions[MME_APP_OVERLOAD_S11] < transactions; stats.transactions[MME_APP_OVERLOAD_S11]++) {
+        mme_app_overload_transaction_start(MME_APP_OVERLOAD_S11);
+    }
+    for (; stats.transactions[MME_APP_OVERLOAD_S11] > transactions; stats.transactions[MME_APP_OVERLOAD_S11]--) {
+        mme_app_overload_transaction_end(MME_APP_OVERLOAD_S11);
+    }
+}
+
+START_TEST(overload_init_test)
+{
+    mme_config_t config;
+
+    /* No hysteresis */
+    overload_config_init(&config);
+    config.overload_config.stop_load = config.overload_config.start_load;
+    ck_assert_int_eq(mme_app_overload_init(&config), -1);
+
+    /* Load of the transactions can not be computed */
+    overload_config_init(&config);
+    config.overload_config.max_s11_transactions = 0;
+    ck_assert_int_eq(mme_app_overload_init(&config), -1);
+}
+END_TEST
+
+START_TEST(overload_load_test)
+{
+    const char *source = NULL;
+
+    ck_assert_uint_eq(mme_app_overload_load(&source), 0);
+
+    overload_set_s11_transactions(3);
+    mme_app_overload_transaction_start(MME_APP_OVERLOAD_S6A);
+    ck_assert_uint_eq(mme_app_overload_load(&source), 30);
+    ck_assert_str_eq(source, "S11 transactions");
+
+    /* Answers to requests sent before the counting do not wrap the counter */
+    mme_app_overload_transaction_end(MME_APP_OVERLOAD_S6A);
+    mme_app_overload_transaction_end(MME_APP_OVERLOAD_S6A);
+    overload_set_s11_transactions(0);
+    mme_app_overload_transaction_end(MME_APP_OVERLOAD_S11);
+    ck_assert_uint_eq(mme_app_overload_load(NULL), 0);
+
+    /* Above the maximum of transactions */
+    overload_set_s11_transactions(15);
+    ck_assert_uint_eq(mme_app_overload_load(&source), 150);
+    overload_set_s11_transactions(0);
+}
+END_TEST
+
+START_TEST(overload_hysteresis_test)
+{
+    mme_app_overload_stats_t stats;
+    uint32_t load_percent = 0;
+    overload_action_t action = OVERLOAD_ACTION_MAX;
+
+    /* Under the start load */
+    overload_set_s11_transactions(7);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), -1);
+
+    /* Start load reached: one OVERLOAD START */
+    overload_set_s11_transactions(8);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), S1AP_OVERLOAD_START);
+    ck_assert_uint_eq(load_percent, 80);
+    ck_assert_int_eq(action, OVERLOAD_ACTION_REJECT_NON_EMERGENCY_MO_DT);
+    overload_set_s11_transactions(9);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), -1);
+
+    /* Between the stop and the start loads: still overloaded */
+    overload_set_s11_transactions(6);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), -1);
+    mme_app_overload_get_stats(&stats);
+    ck_assert(stats.is_overloaded);
+    ck_assert_uint_eq(stats.load, 60);
+    ck_assert_uint_eq(stats.peak_load, 90);
+
+    /* Stop load reached: one OVERLOAD STOP */
+    overload_set_s11_transactions(5);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), S1AP_OVERLOAD_STOP);
+    ck_assert_uint_eq(load_percent, 50);
+    overload_set_s11_transactions(7);
+    mme_app_overload_evaluate();
+    ck_assert_int_eq(overload_s1ap_message(&load_percent, &action), -1);
+
+    mme_app_overload_get_stats(&stats);
+    ck_assert(!stats.is_overloaded);
+    ck_assert_uint_eq(stats.nb_start, 1);
+    ck_assert_uint_eq(stats.nb_stop, 1);
+    overload_set_s11_transactions(0);
+}
+END_TEST
+
+START_TEST(overload_s11_in_process_test)
+{
+    mme_app_overload_stats_t stats;
+    MessageDef *message_p = NULL;
+
+    /* The S11 task counts the requests to a remote S-GW */
+    mme_app_overload_s11_response();
+    mme_app_overload_get_stats(&stats);
+    ck_assert_uint_eq(stats.transactions[MME_APP_OVERLOAD_S11], 0);
+
+    /* S-GW in this process: MME_APP counts from the request to the response */
+    mme_app_desc.s11_task_id = TASK_SPGW_APP;
+    message_p = itti_alloc_new_message(TASK_MME_APP, S11_CREATE_SESSION_REQUEST);
+    ck_assert_int_eq(mme_app_overload_send_s11_request(message_p), 0);
+    mme_app_overload_get_stats(&stats);
+    ck_assert_uint_eq(stats.transactions[MME_APP_OVERLOAD_S11], 1);
+
+    itti_poll_msg(TASK_SPGW_APP, &message_p);
+    ck_assert(message_p != NULL);
+    ck_assert_int_eq(ITTI_MSG_ID(message_p), S11_CREATE_SESSION_REQUEST);
+    itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
+    mme_app_overload_s11_response();
+    mme_app_overload_get_stats(&stats);
+    ck_assert_uint_eq(stats.transactions[MME_APP_OVERLOAD_S11], 0);
+}
+END_TEST
+
+START_TEST(overload_initial_ue_message_test)
+{
+    mme_app_overload_stats_t stats;
+
+    ck_assert_uint_eq(mme_app_overload_initial_ue_message(false), 1);
+    ck_assert_uint_eq(mme_app_overload_initial_ue_message(true), 1);
+    ck_assert_uint_eq(mme_app_overload_initial_ue_message(false), 2);
+
+    mme_app_overload_get_stats(&stats);
+    ck_assert_uint_eq(stats.nb_admitted, 1);
+    ck_assert_uint_eq(stats.nb_dropped, 2);
+}
+END_TEST
+
+Suite * mme_app_overload_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("MME overload control tests");
+
+    /* Core test case */
+    tc_core = tcase_create("MME overload control test");
+    tcase_add_checked_fixture(tc_core, overload_setup, NULL);
+    tcase_add_test(tc_core, overload_init_test);
+    tcase_add_test(tc_core, overload_load_test);
+    tcase_add_test(tc_core, overload_hysteresis_test);
+    tcase_add_test(tc_core, overload_s11_in_process_test);
+    tcase_add_test(tc_core, overload_initial_ue_message_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* MME_APP sends its overload requests to the S1AP queue, its S11 requests to the S-GW queue, polled by the tests */
+    OAILOG_INIT(LOG_MME_ENV, OAILOG_LEVEL_ERROR, 4);
+    if (itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+        return EXIT_FAILURE;
+    }
+    itti_mark_task_ready(TASK_S1AP);
+    itti_mark_task_ready(TASK_SPGW_APP);
+
+    /* Create MME overload control Test Suite */
+    s = mme_app_overload_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
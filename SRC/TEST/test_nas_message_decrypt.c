@@ -0,0 +1,127 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "common_types.h"
+#include "nas_message.h"
+#include "secu_defs.h"
+#include "emmData.h"
+
+#define TEST_NAS_HEADER_LENGTH  6    /* security header type and protocol discriminator, MAC, sequence number */
+
+/* Attach Complete with an Activate Default EPS Bearer Context Accept */
+static const uint8_t plain_message[] = {0x07, 0x43, 0x00, 0x03, 0x52, 0x00, 0xC2};
+
+static const uint8_t knas_enc[AUTH_KNAS_ENC_SIZE] = {
+    0x2B, 0xD6, 0x45, 0x9F, 0x82, 0xC5, 0xB3, 0x00, 0x95, 0x2C, 0x49, 0x10, 0x48, 0x81, 0xFF, 0x48
+};
+
+/* Security context of the UE: EEA1 and EIA0 (MAC 0), first uplink message (COUNT 0) */
+static void security_context_init(emm_security_context_t *security)
+{
+    memset(security, 0, sizeof(*security));
+    security->selected_algorithms.encryption = NAS_SECURITY_ALGORITHMS_EEA1;
+    security->selected_algorithms.integrity = NAS_SECURITY_ALGORITHMS_EIA0;
+    memcpy(security->knas_enc, knas_enc, sizeof(knas_enc));
+}
+
+/* Integrity protected and ciphered uplink message, as sent by the UE */
+static int protected_message(uint8_t *buffer)
+{
+    nas_stream_cipher_t stream_cipher = {0};
+
+    buffer[0] = (SECURITY_HEADER_TYPE_INTEGRITY_PROTECTED_CYPHERED << 4) | EPS_MOBILITY_MANAGEMENT_MESSAGE;
+    memset(&buffer[1], 0, TEST_NAS_HEADER_LENGTH - 1);
+    stream_cipher.key = (uint8_t *)knas_enc;
+    stream_cipher.key_length = AUTH_KNAS_ENC_SIZE;
+    stream_cipher.count = 0;
+    stream_cipher.bearer = 0;
+    stream_cipher.direction = SECU_DIRECTION_UPLINK;
+    stream_cipher.message = (uint8_t *)plain_message;
+    stream_cipher.blength = sizeof(plain_message) << 3;
+    ck_assert_int_eq(nas_stream_encrypt_eea1(&stream_cipher, &buffer[TEST_NAS_HEADER_LENGTH]), 0);
+    return TEST_NAS_HEADER_LENGTH + sizeof(plain_message);
+}
+
+START_TEST(nas_message_decrypt_test)
+{
+    emm_security_context_t security;
+    nas_message_security_header_t header;
+    nas_message_decode_status_t status;
+    uint8_t inbuf[TEST_NAS_HEADER_LENGTH + sizeof(plain_message)];
+    uint8_t outbuf[sizeof(inbuf)];
+    uint8_t copy[sizeof(inbuf)];
+    int length;
+
+    security_context_init(&security);
+    length = protected_message(inbuf);
+    ck_assert(memcmp(&inbuf[TEST_NAS_HEADER_LENGTH], plain_message, sizeof(plain_message)) != 0);
+    memcpy(copy, inbuf, length);
+
+    /* Check the plain message is written at the start of outbuf, inbuf is left as is */
+    memset(&header, 0, sizeof(header));
+    memset(&status, 0, sizeof(status));
+    ck_assert_int_eq(nas_message_decrypt(inbuf, outbuf, &header, length, &security, &status), sizeof(plain_message));
+    ck_assert(status.mac_matched);
+    ck_assert_int_eq(header.protocol_discriminator, EPS_MOBILITY_MANAGEMENT_MESSAGE);
+    ck_assert_int_eq(memcmp(outbuf, plain_message, sizeof(plain_message)), 0);
+    ck_assert_int_eq(memcmp(inbuf, copy, length), 0);
+}
+END_TEST
+
+START_TEST(nas_message_decrypt_in_place_test)
+{
+    emm_security_context_t security;
+    nas_message_security_header_t header;
+    nas_message_decode_status_t status;
+    uint8_t buffer[TEST_NAS_HEADER_LENGTH + sizeof(plain_message) + 1];
+    int length;
+
+    security_context_init(&security);
+    length = protected_message(buffer);
+    buffer[length] = 0xA5;
+
+    /* Check the plain message replaces the ciphered one after the security header */
+    memset(&header, 0, sizeof(header));
+    memset(&status, 0, sizeof(status));
+    ck_assert_int_eq(nas_message_decrypt(buffer, buffer, &header, length, &security, &status), sizeof(plain_message));
+    ck_assert(status.mac_matched);
+    ck_assert_int_eq(header.protocol_discriminator, EPS_MOBILITY_MANAGEMENT_MESSAGE);
+    ck_assert_int_eq(memcmp(&buffer[TEST_NAS_HEADER_LENGTH], plain_message, sizeof(plain_message)), 0);
+    ck_assert_uint_eq(buffer[length], 0xA5);
+}
+END_TEST
+
+Suite * nas_message_decrypt_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("NAS message decrypt tests");
+
+    /* Core test case */
+    tc_core = tcase_create("NAS message decrypt test");
+    tcase_add_test(tc_core, nas_message_decrypt_test);
+    tcase_add_test(tc_core, nas_message_decrypt_in_place_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create NAS message decrypt Test Suite */
+    s = nas_message_decrypt_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
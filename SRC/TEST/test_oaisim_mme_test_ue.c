@@ -0,0 +1,141 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "oaisim_mme_test_ue.h"
+
+typedef struct {
+    const char *k;
+    const char *op;
+    const char *opc;
+    const char *rand;
+    const char *sqn;
+    const char *amf;
+    const char *mac_a;
+    const char *res;
+    const char *ck;
+    const char *ik;
+    const char *ak;
+} milenage_test_set_t;
+
+/*
+ * Test set 1 of 3GPP TS 35.208 #4.3
+ */
+static const milenage_test_set_t milenage_test_set_1 = {
+    "465b5ce8b199b49faa5f0a2ee238a6bc", "cdc202d5123e20f62b6d676ac72cb318", "cd63cb71954a9f4e48a5994e37a02baf",
+    "23553cbe9637a89d218ae64dae47bf35", "ff9bb4d0b607", "b9b9",
+    "4a9ffac354dfafb3", "a54211d5e3ba50bf", "b40ba9a3c58b2a05bbf0d987b21bf8cb", "f769bcd751044604127672711c6d3441", "aa689c648370"
+};
+
+static const uint8_t plmn[3] = {0x02, 0xF8, 0x39};
+
+static void expect_bytes(const char *expected, const uint8_t *bytes, size_t length)
+{
+    uint8_t expected_bytes[16];
+
+    ck_assert(test_hex_to_bytes(expected, expected_bytes, length));
+    ck_assert(0 == memcmp(bytes, expected_bytes, length));
+}
+
+/* Provisioned with OP or with OPc, the USIM gives the vector of the specification */
+static void milenage_test(const milenage_test_set_t *set, bool with_opc)
+{
+    test_usim_t usim;
+    uint8_t rand[16], sqn[6], amf[2];
+    uint8_t res[8], ck[16], ik[16], ak[6], mac_a[8];
+
+    ck_assert(test_usim_init(&usim, set->k, (with_opc) ? NULL : set->op, (with_opc) ? set->opc : NULL, plmn));
+    expect_bytes(set->opc, usim.opc, sizeof(usim.opc));
+    ck_assert(test_hex_to_bytes(set->rand, rand, sizeof(rand)));
+    ck_assert(test_hex_to_bytes(set->sqn, sqn, sizeof(sqn)));
+    ck_assert(test_hex_to_bytes(set->amf, amf, sizeof(amf)));
+
+    test_usim_milenage(&usim, rand, sqn, amf, res, ck, ik, ak, mac_a);
+    expect_bytes(set->mac_a, mac_a, sizeof(mac_a));
+    expect_bytes(set->res, res, sizeof(res));
+    expect_bytes(set->ck, ck, sizeof(ck));
+    expect_bytes(set->ik, ik, sizeof(ik));
+    expect_bytes(set->ak, ak, sizeof(ak));
+    test_usim_free(&usim);
+}
+
+START_TEST(milenage_op_test)
+{
+    milenage_test(&milenage_test_set_1, false);
+}
+END_TEST
+
+START_TEST(milenage_opc_test)
+{
+    milenage_test(&milenage_test_set_1, true);
+}
+END_TEST
+
+START_TEST(hex_to_bytes_test)
+{
+    uint8_t bytes[2];
+
+    ck_assert(test_hex_to_bytes("b9B9", bytes, sizeof(bytes)));
+    ck_assert_int_eq(bytes[0], 0xB9);
+    ck_assert_int_eq(bytes[1], 0xB9);
+    ck_assert(!test_hex_to_bytes("b9b", bytes, sizeof(bytes)));
+    ck_assert(!test_hex_to_bytes("b9xx", bytes, sizeof(bytes)));
+}
+END_TEST
+
+Suite * test_ue_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("Test UE tests");
+
+    /* Core test case */
+    tc_core = tcase_create("Test UE USIM test");
+    tcase_add_test(tc_core, milenage_op_test);
+    tcase_add_test(tc_core, milenage_opc_test);
+    tcase_add_test(tc_core, hex_to_bytes_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* Create test UE Test Suite */
+    s = test_ue_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,235 @@
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "log.h"
+#include "common_types.h"
+#include "mme_config.h"
+#include "intertask_interface_init.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme.h"
+#include "s1ap_mme_paging.h"
+
+#define TEST_PAGING_NB_ENBS      4
+
+/* eNB i has the SCTP association i + 1 */
+static enb_description_t *enbs[TEST_PAGING_NB_ENBS];
+
+/* TAI of TAC tac in PLMN 208.93 */
+static void tai_init(tai_t *tai, tac_t tac)
+{
+    tai->plmn.mcc_digit1 = 2;
+    tai->plmn.mcc_digit2 = 0;
+    tai->plmn.mcc_digit3 = 8;
+    tai->plmn.mnc_digit1 = 9;
+    tai->plmn.mnc_digit2 = 3;
+    tai->plmn.mnc_digit3 = 0x0F;
+    tai->tac = tac;
+}
+
+static void paging_request_init(itti_s1ap_paging_request_t *paging, const tac_t *tacs, int nb_tac)
+{
+    memset(paging, 0, sizeof(*paging));
+    paging->mme_ue_s1ap_id = 1;
+    paging->mme_code = 1;
+    paging->m_tmsi = 0xC0000001;
+    paging->ue_identity_index = 1;
+    for (int i = 0; i < nb_tac; i++) {
+        tai_init(&paging->tai_list.tai[paging->tai_list.n_tais++], tacs[i]);
+    }
+}
+
+static void paging_setup(void)
+{
+    mme_config.max_enbs = TEST_PAGING_NB_ENBS;
+    mme_config.max_ues = 2;
+    ck_assert_int_eq(s1ap_mme_paging_init(), 0);
+    for (int i = 0; i < TEST_PAGING_NB_ENBS; i++) {
+        enbs[i] = s1ap_new_enb();
+        enbs[i]->enb_id = i + 1;
+        enbs[i]->sctp_assoc_id = i + 1;
+        enbs[i]->s1_state = S1AP_READY;
+    }
+}
+
+static void paging_teardown(void)
+{
+    for (int i = 0; i < TEST_PAGING_NB_ENBS; i++) {
+        s1ap_mme_paging_remove_enb(enbs[i]);
+        hashtable_ts_destroy(&enbs[i]->ue_coll);
+        free_wrapper((void**)&enbs[i]);
+    }
+    s1ap_mme_paging_exit();
+}
+
+/* Index eNB i under the TACs given */
+static void paging_add_enb(int i, const tac_t *tacs, int nb_tac)
+{
+    tai_t tai[TAI_LIST_MAX_SIZE];
+
+    for (int j = 0; j < nb_tac; j++) {
+        tai_init(&tai[j], tacs[j]);
+    }
+    ck_assert_int_eq(s1ap_mme_paging_add_enb(enbs[i], tai, nb_tac), 0);
+}
+
+/* Bit i set if eNB i is selected */
+static uint32_t paging_select(const tac_t *tacs, int nb_tac, int max_enbs, int *nb_enb)
+{
+    itti_s1ap_paging_request_t paging;
+    enb_description_t *selected[TEST_PAGING_NB_ENBS];
+    uint32_t mask = 0;
+
+    paging_request_init(&paging, tacs, nb_tac);
+    *nb_enb = s1ap_mme_paging_select_enbs(&paging.tai_list, selected, max_enbs);
+    for (int i = 0; i < *nb_enb; i++) {
+        mask |= 1 << (selected[i]->sctp_assoc_id - 1);
+    }
+    return mask;
+}
+
+START_TEST(paging_tai_index_test)
+{
+    const tac_t tacs_0[] = {1, 2, 1};
+    const tac_t tacs_1[] = {2};
+    const tac_t tacs_2[] = {3};
+    const tac_t page_1[] = {1};
+    const tac_t page_2[] = {2};
+    const tac_t page_12[] = {1, 2};
+    const tac_t page_4[] = {4};
+    int nb_enb = 0;
+
+    /* The duplicated TAC of eNB 0 is indexed once */
+    paging_add_enb(0, tacs_0, 3);
+    ck_assert_int_eq(enbs[0]->nb_supported_tai, 2);
+    paging_add_enb(1, tacs_1, 1);
+    paging_add_enb(2, tacs_2, 1);
+
+    ck_assert_uint_eq(paging_select(page_1, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0x1);
+    ck_assert_uint_eq(paging_select(page_2, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0x3);
+    ck_assert_int_eq(nb_enb, 2);
+    ck_assert_uint_eq(paging_select(page_4, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0);
+
+    /* An eNB serving several TAIs of the paging is selected once */
+    ck_assert_uint_eq(paging_select(page_12, 2, TEST_PAGING_NB_ENBS, &nb_enb), 0x3);
+    ck_assert_int_eq(nb_enb, 2);
+
+    /* A new S1 SETUP replaces the TAIs of the eNB */
+    paging_add_enb(0, tacs_2, 1);
+    ck_assert_uint_eq(paging_select(page_1, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0);
+    ck_assert_uint_eq(paging_select(tacs_2, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0x5);
+
+    /* Removed or not ready eNBs are not paged */
+    s1ap_mme_paging_remove_enb(enbs[2]);
+    ck_assert_uint_eq(paging_select(tacs_2, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0x1);
+    enbs[1]->s1_state = S1AP_RESETING;
+    ck_assert_uint_eq(paging_select(page_2, 1, TEST_PAGING_NB_ENBS, &nb_enb), 0);
+}
+END_TEST
+
+START_TEST(paging_max_enbs_test)
+{
+    const tac_t tacs[] = {7};
+    int nb_enb = 0;
+
+    for (int i = 0; i < TEST_PAGING_NB_ENBS; i++) {
+        paging_add_enb(i, tacs, 1);
+    }
+    paging_select(tacs, 1, TEST_PAGING_NB_ENBS - 1, &nb_enb);
+    ck_assert_int_eq(nb_enb, TEST_PAGING_NB_ENBS - 1);
+    paging_select(tacs, 1, TEST_PAGING_NB_ENBS, &nb_enb);
+    ck_assert_int_eq(nb_enb, TEST_PAGING_NB_ENBS);
+}
+END_TEST
+
+START_TEST(paging_fanout_test)
+{
+    const tac_t tacs_0[] = {1};
+    const tac_t tacs_1[] = {2};
+    const tac_t page[] = {1, 2, 3};
+    itti_s1ap_paging_request_t paging;
+    MessageDef *message_p = NULL;
+    uint8_t *buffer = NULL;
+    uint32_t length = 0;
+    uint32_t assoc_ids = 0;
+
+    paging_add_enb(0, tacs_0, 1);
+    paging_add_enb(1, tacs_1, 1);
+    paging_add_enb(3, tacs_1, 1);
+    paging_request_init(&paging, page, 3);
+    ck_assert_int_eq(s1ap_mme_paging_encode(&paging, &buffer, &length), 0);
+    ck_assert(length > 0);
+
+    /* One SCTP request per eNB on stream 0, all with the PDU encoded once */
+    ck_assert_int_eq(s1ap_mme_handle_paging_request(&paging), 0);
+    for (int i = 0; i < 3; i++) {
+        itti_poll_msg(TASK_SCTP, &message_p);
+        ck_assert(message_p != NULL);
+        ck_assert_int_eq(ITTI_MSG_ID(message_p), SCTP_DATA_REQ);
+        ck_assert_int_eq(SCTP_DATA_REQ(message_p).stream, 0);
+        ck_assert_int_eq(blength(SCTP_DATA_REQ(message_p).payload), length);
+        ck_assert(0 == memcmp(SCTP_DATA_REQ(message_p).payload->data, buffer, length));
+        assoc_ids |= 1 << (SCTP_DATA_REQ(message_p).assoc_id - 1);
+        bdestroy(SCTP_DATA_REQ(message_p).payload);
+        itti_free(ITTI_MSG_ORIGIN_ID(message_p), message_p);
+    }
+    ck_assert_uint_eq(assoc_ids, 0xB);
+    itti_poll_msg(TASK_SCTP, &message_p);
+    ck_assert(message_p == NULL);
+    free_wrapper((void**)&buffer);
+
+    /* No eNB serving the TAIs: nothing sent */
+    enbs[0]->s1_state = S1AP_RESETING;
+    paging_request_init(&paging, tacs_0, 1);
+    ck_assert_int_eq(s1ap_mme_handle_paging_request(&paging), -1);
+    itti_poll_msg(TASK_SCTP, &message_p);
+    ck_assert(message_p == NULL);
+}
+END_TEST
+
+Suite * s1ap_mme_paging_suite(void)
+{
+    Suite *s;
+    TCase *tc_core;
+
+    s = suite_create("S1AP paging tests");
+
+    /* Core test case */
+    tc_core = tcase_create("S1AP paging test");
+    tcase_add_checked_fixture(tc_core, paging_setup, paging_teardown);
+    tcase_add_test(tc_core, paging_tai_index_test);
+    tcase_add_test(tc_core, paging_max_enbs_test);
+    tcase_add_test(tc_core, paging_fanout_test);
+
+    suite_add_tcase(s, tc_core);
+
+    return s;
+}
+
+int main(void)
+{
+    int number_failed;
+    Suite *s;
+    SRunner *sr;
+
+    /* S1AP sends the PAGING PDUs to the SCTP queue, polled by the tests */
+    OAILOG_INIT(LOG_MME_ENV, OAILOG_LEVEL_ERROR, 4);
+    if (itti_init(TASK_MAX, THREAD_MAX, MESSAGES_ID_MAX, tasks_info, messages_info, NULL, NULL) < 0) {
+        return EXIT_FAILURE;
+    }
+    itti_mark_task_ready(TASK_SCTP);
+
+    /* Create S1AP paging Test Suite */
+    s = s1ap_mme_paging_suite();
+    sr = srunner_create(s);
+
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -36,12 +36,17 @@
 #include "assertions.h"
 #include "dynamic_memory_check.h"
 #include "log.h"
+#include "oai_clock.h"
 
 #if TRACE_HASHTABLE
 #  define PRINT_HASHTABLE(hTbLe, ...)  do {if (hTbLe->log_enabled) OAILOG_TRACE(LOG_UTIL, ##__VA_ARGS__);} while (0)
 #else
 #  define PRINT_HASHTABLE(...)
 #endif
+
+// lock of the bucket of a key, with the contention counters of the (const) table
+#define HASHTABLE_LOCK_NODE(hTbLe, hAsH) hashtable_lock_node (&(hTbLe)->lock_nodes[hAsH], (hTbLe)->lock_stats)
+
 //------------------------------------------------------------------------------
 char                                   *
 hashtable_rc_code2string (
@@ -81,6 +86,24 @@ hashtable_rc_code2string (
 
 void hash_free_int_func (void **memoryP) {}
 
+//------------------------------------------------------------------------------
+/*
+   Lock of a bucket
+   hashtable_lock_node() only reads the clock when the lock is taken by another thread, the uncontended path is a try lock.
+*/
+void hashtable_lock_node (pthread_mutex_t * const mutexP, hash_table_lock_stats_t * const lock_statsP)
+{
+  uint64_t                                start_ns = 0;
+
+  if (0 == pthread_mutex_trylock (mutexP)) {
+    return;
+  }
+  start_ns = oai_clock_precise_ns ();
+  pthread_mutex_lock (mutexP);
+  __atomic_fetch_add (&lock_statsP->contentions, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add (&lock_statsP->wait_ns, oai_clock_precise_ns () - start_ns, __ATOMIC_RELAXED);
+}
+
 //------------------------------------------------------------------------------
 /*
    Default hash function
@@ -152,6 +175,7 @@ hash_table_t * hashtable_init (hash_table_t * const hashtblP,
     bassignformat(hashtblP->name,"hashtable%u@%p", size, hashtblP);
   }
   hashtblP->is_allocated_by_malloc = false;
+  hashtblP->resizes = 0;
   return hashtblP;
 }
 
@@ -225,6 +249,14 @@ hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtblP,
     return NULL;
   }
 
+  if (!(hashtblP->lock_stats = calloc (1, sizeof (hash_table_lock_stats_t)))) {
+    free_wrapper((void **) &hashtblP->lock_nodes);
+    free_wrapper((void **) &hashtblP->nodes);
+    free_wrapper((void **) &hashtblP->name);
+    free_wrapper((void **) &hashtblP);
+    return NULL;
+  }
+
   pthread_mutex_init(&hashtblP->mutex, NULL);
   for (int i = 0; i < size; i++) {
     pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
@@ -354,6 +386,7 @@ hashtable_ts_destroy (
   }
 
   free_wrapper((void **) &hashtblP->nodes);
+  free_wrapper((void **) &hashtblP->lock_stats);
   free_wrapper((void **) &hashtblP->name);
   if (hashtblP->is_allocated_by_malloc) {
     free_wrapper((void **) &hashtblP);
@@ -407,7 +440,7 @@ hashtable_ts_is_key_exists (
   }
 
   hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock (&hashtblP->lock_nodes[hash]);
+  HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -658,7 +691,7 @@ hashtable_ts_insert (
   }
 
   hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -691,11 +724,11 @@ hashtable_ts_insert (
   __sync_fetch_and_add (&hashtblP->num_elements, 1);
   pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64" data %p) next %p return OK\n", __FUNCTION__, bdata(hashtblP->name), keyP, dataP, node->next);
-#define TEMPORARY_DEBUG 1
-#if TEMPORARY_DEBUG
+#if TRACE_HASHTABLE
   bstring b = bfromcstr(" ");
   hashtable_ts_dump_content(hashtblP, b);
   PRINT_HASHTABLE (hashtblP, "%s:%s\n", bdata(hashtblP->name), bdata(b));
+  bdestroy(b);
 #endif
   return HASH_TABLE_OK;
 }
@@ -768,7 +801,7 @@ hashtable_ts_free (
   }
 
   hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -865,7 +898,7 @@ hashtable_ts_remove (
   }
 
   hash = hashtblP->hashfunc (keyP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -951,7 +984,7 @@ hashtable_ts_get (
 
   hash = hashtblP->hashfunc (keyP) % hashtblP->size;
 
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -967,11 +1000,11 @@ hashtable_ts_get (
   pthread_mutex_unlock(&hashtblP->lock_nodes[hash]);
   PRINT_HASHTABLE (hashtblP, "%s(%s,key 0x%"PRIx64") return KEY_NOT_EXISTS\n", __FUNCTION__, bdata(hashtblP->name), keyP);
 
-#define TEMPORARY_DEBUG 1
-#if TEMPORARY_DEBUG
+#if TRACE_HASHTABLE
   bstring b = bfromcstr(" ");
   hashtable_ts_dump_content(hashtblP, b);
   PRINT_HASHTABLE (hashtblP, "%s:%s\n", bdata(hashtblP->name), bdata(b));
+  bdestroy(b);
 #endif
   return HASH_TABLE_KEY_NOT_EXISTS;
 }
@@ -982,10 +1015,9 @@ hashtable_ts_get (
    The number of elements in a hash table is not always known when creating the table.
    If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
-   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be moved into its new position.
+   The nodes are unlinked from the old buckets and linked in a new array of buckets, they are neither freed nor allocated.
+   After that, we can just free_wrapper the old array of buckets.
 */
 
 hashtable_rc_t
@@ -993,11 +1025,11 @@ hashtable_resize (
   hash_table_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  hash_table_t                            newtbl;
-  hash_size_t                             n;
-  hash_node_t                            *node,
-                                         *next;
-  void                                   *dummy = NULL;
+  hash_node_t                           **nodes = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             hash = 0;
+  hash_node_t                            *node = NULL,
+                                         *next = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1021,24 +1053,23 @@ hashtable_resize (
   size |= size >> 16;
   size++;
 
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (hash_node_t *))))
-    return -1;
-
+  if (!(nodes = calloc (size, sizeof (hash_node_t *))))
+    return HASH_TABLE_SYSTEM_ERROR;
 
   for (n = 0; n < hashtblP->size; ++n) {
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      hashtable_remove (hashtblP, node->key, &dummy);
-      hashtable_insert (&newtbl, node->key, node->data);
+      hash = hashtblP->hashfunc (node->key) % size;
+      node->next = nodes[hash];
+      nodes[hash] = node;
     }
   }
 
   free_wrapper((void **) &hashtblP->nodes);
-  hashtblP->nodes = newtbl.nodes;
-  hashtblP->size = newtbl.size;
+  hashtblP->nodes = nodes;
+  hashtblP->size = size;
+  hashtblP->resizes += 1;
+  PRINT_HASHTABLE (hashtblP, "%s(%s,size %zu) return OK\n", __FUNCTION__, bdata(hashtblP->name), size);
   return HASH_TABLE_OK;
 }
 
@@ -1049,10 +1080,9 @@ hashtable_resize (
    The number of elements in a hash table is not always known when creating the table.
    If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
-   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be moved into its new position.
+   The nodes are unlinked from the old buckets and linked in a new array of buckets, they are neither freed nor allocated.
+   After that, we can just free_wrapper the old arrays of buckets and of locks.
    Dangerous not really thread safe.
 */
 
@@ -1061,11 +1091,12 @@ hashtable_ts_resize (
   hash_table_ts_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  hash_table_ts_t                         newtbl = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0};
-  hash_size_t                             n      = 0;
+  hash_node_t                           **nodes = NULL;
+  pthread_mutex_t                        *lock_nodes = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             hash = 0;
   hash_node_t                            *node   = NULL,
                                          *next   = NULL;
-  void                                   *dummy  = NULL;
 
   if (!hashtblP) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1089,34 +1120,109 @@ hashtable_ts_resize (
   size |= size >> 16;
   size++;
 
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (hash_node_t *))))
+  if (!(nodes = calloc (size, sizeof (hash_node_t *))))
     return HASH_TABLE_SYSTEM_ERROR;
 
-  if (!(newtbl.lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
-    free_wrapper((void **) &newtbl.nodes);
+  if (!(lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
+    free_wrapper((void **) &nodes);
     return HASH_TABLE_SYSTEM_ERROR;
   }
-  for (n = 0; n < hashtblP->size; ++n) {
-    pthread_mutex_init(&newtbl.lock_nodes[n], NULL);
+  for (n = 0; n < size; ++n) {
+    pthread_mutex_init(&lock_nodes[n], NULL);
   }
 
   pthread_mutex_lock(&hashtblP->mutex);
   for (n = 0; n < hashtblP->size; ++n) {
+    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      hashtable_ts_remove (hashtblP, node->key, &dummy);
-      hashtable_ts_insert (&newtbl, node->key, node->data);
+      hash = hashtblP->hashfunc (node->key) % size;
+      node->next = nodes[hash];
+      nodes[hash] = node;
     }
+    hashtblP->nodes[n] = NULL;
+    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
+    pthread_mutex_destroy(&hashtblP->lock_nodes[n]);
   }
 
   free_wrapper((void **) &hashtblP->nodes);
   free_wrapper((void **) &hashtblP->lock_nodes);
-  hashtblP->size = newtbl.size;
-  hashtblP->nodes = newtbl.nodes;
-  hashtblP->lock_nodes = newtbl.lock_nodes;
+  hashtblP->size = size;
+  hashtblP->nodes = nodes;
+  hashtblP->lock_nodes = lock_nodes;
+  hashtblP->resizes += 1;
   pthread_mutex_unlock(&hashtblP->mutex);
+  PRINT_HASHTABLE (hashtblP, "%s(%s,size %zu) return OK\n", __FUNCTION__, bdata(hashtblP->name), size);
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   hashtable_get_stats() walks through the buckets to count the length of their chains, a bad distribution of the keys
+   by the hash function shows as long chains while the load factor (num_elements / size) is low.
+*/
+hashtable_rc_t
+hashtable_get_stats (
+  const hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  hash_node_t                            *node = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             chain = 0;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  for (n = 0; n < hashtblP->size; ++n) {
+    for (chain = 0, node = hashtblP->nodes[n]; node; node = node->next) {
+      chain++;
+    }
+    statsP->num_elements += chain;
+    statsP->max_chain = (chain > statsP->max_chain) ? chain : statsP->max_chain;
+    statsP->chains[(chain < HASH_TABLE_STATS_CHAIN_LENGTHS) ? chain : HASH_TABLE_STATS_CHAIN_LENGTHS - 1] += 1;
+  }
+  statsP->size    = hashtblP->size;
+  statsP->resizes = hashtblP->resizes;
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   hashtable_ts_get_stats() locks the buckets one after the other, the statistics are not a snapshot of the table.
+*/
+hashtable_rc_t
+hashtable_ts_get_stats (
+  const hash_table_ts_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  hash_node_t                            *node = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             chain = 0;
+
+  if (!hashtblP) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  pthread_mutex_lock((pthread_mutex_t *) &hashtblP->mutex);
+  for (n = 0; n < hashtblP->size; ++n) {
+    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
+    for (chain = 0, node = hashtblP->nodes[n]; node; node = node->next) {
+      chain++;
+    }
+    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
+    statsP->num_elements += chain;
+    statsP->max_chain = (chain > statsP->max_chain) ? chain : statsP->max_chain;
+    statsP->chains[(chain < HASH_TABLE_STATS_CHAIN_LENGTHS) ? chain : HASH_TABLE_STATS_CHAIN_LENGTHS - 1] += 1;
+  }
+  statsP->size             = hashtblP->size;
+  statsP->resizes          = hashtblP->resizes;
+  statsP->lock_contentions = __atomic_load_n (&hashtblP->lock_stats->contentions, __ATOMIC_RELAXED);
+  statsP->lock_wait_ns     = __atomic_load_n (&hashtblP->lock_stats->wait_ns, __ATOMIC_RELAXED);
+  pthread_mutex_unlock((pthread_mutex_t *) &hashtblP->mutex);
   return HASH_TABLE_OK;
 }
@@ -57,6 +57,8 @@ typedef enum hashtable_return_code_e {
 #define HASH_TABLE_DEFAULT_HASH_FUNC NULL
 #define HASH_TABLE_DEFAULT_free_wrapper_FUNC NULL
 
+#define HASH_TABLE_STATS_CHAIN_LENGTHS (8)  // histogram of the chain lengths, the last entry counts the longer chains
+
 
 typedef struct hash_node_s {
     hash_key_t          key;
@@ -65,6 +67,12 @@ typedef struct hash_node_s {
 
 } hash_node_t;
 
+// Updated by the lookups of a const table through its pointer, with __atomic builtins only
+typedef struct hash_table_lock_stats_s {
+    uint64_t            contentions;                             // bucket locks found taken by another thread
+    uint64_t            wait_ns;                                 // time waited on these locks
+} hash_table_lock_stats_t;
+
 typedef struct hash_table_s {
     hash_size_t         size;
     hash_size_t         num_elements;
@@ -74,6 +82,7 @@ typedef struct hash_table_s {
     bstring             name;
     bool                is_allocated_by_malloc;
     bool                log_enabled;
+    uint64_t            resizes;
 } hash_table_t;
 
 typedef struct hash_table_ts_s {
@@ -87,8 +96,20 @@ typedef struct hash_table_ts_s {
     bstring             name;
     bool                is_allocated_by_malloc;
     bool                log_enabled;
+    uint64_t            resizes;
+    hash_table_lock_stats_t *lock_stats;
 } hash_table_ts_t;
 
+typedef struct hashtable_stats_s {
+    hash_size_t         size;
+    hash_size_t         num_elements;
+    hash_size_t         max_chain;
+    hash_size_t         chains[HASH_TABLE_STATS_CHAIN_LENGTHS];  // number of buckets by length of their chain
+    uint64_t            resizes;
+    uint64_t            lock_contentions;                        // bucket locks found taken by another thread
+    uint64_t            lock_wait_ns;                            // time waited on these locks
+} hashtable_stats_t;
+
 char*           hashtable_rc_code2string(hashtable_rc_t rc);
 void            hash_free_int_func(void** memory);
 hash_table_t * hashtable_init (hash_table_t * const hashtbl,const hash_size_t size,hash_size_t (*hashfunc) (const
@@ -107,6 +128,7 @@ hashtable_rc_t  hashtable_free (hash_table_t * const hashtbl, const hash_key_t k
 hashtable_rc_t  hashtable_remove(hash_table_t * const hashtbl, const hash_key_t key, void** element);
 hashtable_rc_t  hashtable_get    (const hash_table_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_resize (hash_table_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_get_stats (const hash_table_t * const hashtbl, hashtable_stats_t * const stats);
 
 // Thread-safe functions
 hash_table_ts_t * hashtable_ts_init (hash_table_ts_t * const hashtbl,const hash_size_t size,hash_size_t (*hashfunc)
@@ -125,6 +147,8 @@ hashtable_rc_t  hashtable_ts_free (hash_table_ts_t * const hashtbl, const hash_k
 hashtable_rc_t  hashtable_ts_remove(hash_table_ts_t * const hashtbl, const hash_key_t key, void** element);
 hashtable_rc_t  hashtable_ts_get    (const hash_table_ts_t * const hashtbl, const hash_key_t key, void **element) __attribute__ ((hot));
 hashtable_rc_t  hashtable_ts_resize (hash_table_ts_t * const hashtbl, const hash_size_t size);
+hashtable_rc_t  hashtable_ts_get_stats (const hash_table_ts_t * const hashtbl, hashtable_stats_t * const stats);
+void            hashtable_lock_node (pthread_mutex_t * const mutex, hash_table_lock_stats_t * const lock_stats);
 
 #endif
 
@@ -41,6 +41,9 @@
 #  define PRINT_HASHTABLE(...)
 #endif
 
+// lock of the bucket of a key, with the contention counters of the (const) table
+#define OBJ_HASHTABLE_LOCK_NODE(hTbLe, hAsH) hashtable_lock_node (&(hTbLe)->lock_nodes[hAsH], (hTbLe)->lock_stats)
+
 //------------------------------------------------------------------------------
 // Free function selected if we do not want to free_wrapper the key when removing an entry
 void
@@ -135,6 +138,7 @@ obj_hash_table_t *obj_hashtable_init (
     bassignformat(hashtblP->name,"obj_hashtable%u@%p", size, hashtblP);
   }
   hashtblP->log_enabled = true;
+  hashtblP->resizes = 0;
   return hashtblP;
 }
 
@@ -205,6 +209,14 @@ obj_hashtable_ts_init (
     return NULL;
   }
 
+  if (!(hashtblP->lock_stats = calloc (1, sizeof (hash_table_lock_stats_t)))) {
+    free_wrapper((void **) &hashtblP->lock_nodes);
+    free_wrapper((void **) &hashtblP->nodes);
+    free_wrapper((void **) &hashtblP->name);
+    free_wrapper((void **) &hashtblP);
+    return NULL;
+  }
+
   pthread_mutex_init(&hashtblP->mutex, NULL);
   for (int i = 0; i < size; i++) {
     pthread_mutex_init(&hashtblP->lock_nodes[i], NULL);
@@ -317,6 +329,7 @@ obj_hashtable_ts_destroy (
   }
 
   free_wrapper((void **) &hashtblP->nodes);
+  free_wrapper((void **) &hashtblP->lock_stats);
   free_wrapper((void **) &hashtblP);
   return HASH_TABLE_OK;
 }
@@ -380,7 +393,7 @@ obj_hashtable_ts_is_key_exists (
   }
 
   hash = hashtblP->hashfunc (keyP, key_sizeP) % hashtblP->size;
-  pthread_mutex_lock (&hashtblP->lock_nodes[hash]);
+  OBJ_HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -569,7 +582,7 @@ obj_hashtable_ts_insert (
   }
 
   hash = hashtblP->hashfunc (keyP, key_sizeP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  OBJ_HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -695,7 +708,7 @@ obj_hashtable_ts_free (
   }
 
   hash = hashtblP->hashfunc (keyP, key_sizeP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  OBJ_HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -800,7 +813,7 @@ obj_hashtable_ts_remove (
   }
 
   hash = hashtblP->hashfunc (keyP, key_sizeP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  OBJ_HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -903,7 +916,7 @@ obj_hashtable_ts_get (
   }
 
   hash = hashtblP->hashfunc (keyP, key_sizeP) % hashtblP->size;
-  pthread_mutex_lock(&hashtblP->lock_nodes[hash]);
+  OBJ_HASHTABLE_LOCK_NODE (hashtblP, hash);
   node = hashtblP->nodes[hash];
 
   while (node) {
@@ -1012,21 +1025,20 @@ obj_hashtable_ts_get_keys (
    The number of elements in a hash table is not always known when creating the table.
    If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
-   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary obj_hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be moved into its new position.
+   The nodes are unlinked from the old buckets and linked in a new array of buckets, nodes and keys are neither freed nor allocated.
+   After that, we can just free_wrapper the old array of buckets.
 */
 hashtable_rc_t
 obj_hashtable_resize (
   obj_hash_table_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  obj_hash_table_t                        newtbl = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0};
-  hash_size_t                             n;
-  obj_hash_node_t                        *node,
-                                         *next;
-  void                                   *dummy = NULL;
+  obj_hash_node_t                       **nodes = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             hash = 0;
+  obj_hash_node_t                        *node = NULL,
+                                         *next = NULL;
 
   if (hashtblP == NULL) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1050,23 +1062,22 @@ obj_hashtable_resize (
   size |= size >> 16;
   size++;
 
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (obj_hash_node_t *))))
+  if (!(nodes = calloc (size, sizeof (obj_hash_node_t *))))
     return HASH_TABLE_SYSTEM_ERROR;
 
   for (n = 0; n < hashtblP->size; ++n) {
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      obj_hashtable_remove (hashtblP, node->key, node->key_size, &dummy);
-      obj_hashtable_insert (&newtbl, node->key, node->key_size, node->data);
+      hash = hashtblP->hashfunc (node->key, node->key_size) % size;
+      node->next = nodes[hash];
+      nodes[hash] = node;
     }
   }
 
   free_wrapper((void **) &hashtblP->nodes);
-  hashtblP->size = newtbl.size;
-  hashtblP->nodes = newtbl.nodes;
+  hashtblP->size = size;
+  hashtblP->nodes = nodes;
+  hashtblP->resizes += 1;
   PRINT_HASHTABLE (hashtblP, "return OK\n");
   return HASH_TABLE_OK;
 }
@@ -1077,21 +1088,21 @@ obj_hashtable_resize (
    The number of elements in a hash table is not always known when creating the table.
    If the number of elements grows too large, it will seriously reduce the performance of most hash table operations.
    If the number of elements are reduced, the hash table will waste memory. That is why we provide a function for resizing the table.
-   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be inserted into its new position.
-   We create a temporary obj_hash_table_t object (newtbl) to be used while building the new hashes.
-   This allows us to reuse hashtable_insert() and hashtable_free(), when moving the elements to the new table.
-   After that, we can just free_wrapper the old table and copy the elements from newtbl to hashtbl.
+   Resizing a hash table is not as easy as a realloc(). All hash values must be recalculated and each element must be moved into its new position.
+   The nodes are unlinked from the old buckets and linked in a new array of buckets, nodes and keys are neither freed nor allocated.
+   After that, we can just free_wrapper the old arrays of buckets and of locks.
 */
 hashtable_rc_t
 obj_hashtable_ts_resize (
   obj_hash_table_t * const hashtblP,
   const hash_size_t sizeP)
 {
-  obj_hash_table_t                        newtbl = {.mutex = PTHREAD_MUTEX_INITIALIZER, 0};
-  hash_size_t                             n;
-  obj_hash_node_t                        *node,
-                                         *next;
-  void                                   *dummy = NULL;
+  obj_hash_node_t                       **nodes = NULL;
+  pthread_mutex_t                        *lock_nodes = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             hash = 0;
+  obj_hash_node_t                        *node = NULL,
+                                         *next = NULL;
 
   if (hashtblP == NULL) {
     return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
@@ -1115,35 +1126,108 @@ obj_hashtable_ts_resize (
   size |= size >> 16;
   size++;
 
-  newtbl.size = size;
-  newtbl.hashfunc = hashtblP->hashfunc;
-
-  if (!(newtbl.nodes = calloc (size, sizeof (obj_hash_node_t *))))
+  if (!(nodes = calloc (size, sizeof (obj_hash_node_t *))))
     return HASH_TABLE_SYSTEM_ERROR;
 
-  if (!(newtbl.lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
-    free_wrapper((void **) &newtbl.nodes);
+  if (!(lock_nodes = calloc (size, sizeof (pthread_mutex_t)))) {
+    free_wrapper((void **) &nodes);
     return HASH_TABLE_SYSTEM_ERROR;
   }
-  for (n = 0; n < hashtblP->size; ++n) {
-    pthread_mutex_init(&newtbl.lock_nodes[n], NULL);
+  for (n = 0; n < size; ++n) {
+    pthread_mutex_init(&lock_nodes[n], NULL);
   }
 
   pthread_mutex_lock(&hashtblP->mutex);
   for (n = 0; n < hashtblP->size; ++n) {
+    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
     for (node = hashtblP->nodes[n]; node; node = next) {
       next = node->next;
-      obj_hashtable_ts_remove (hashtblP, node->key, node->key_size, &dummy);
-      obj_hashtable_insert (&newtbl, node->key, node->key_size, node->data);
+      hash = hashtblP->hashfunc (node->key, node->key_size) % size;
+      node->next = nodes[hash];
+      nodes[hash] = node;
     }
+    hashtblP->nodes[n] = NULL;
+    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
+    pthread_mutex_destroy(&hashtblP->lock_nodes[n]);
   }
 
   free_wrapper((void **) &hashtblP->nodes);
-  free_wrapper((void **) &hashtblP->nodes);
-  hashtblP->size = newtbl.size;
-  hashtblP->nodes = newtbl.nodes;
-  hashtblP->lock_nodes = newtbl.lock_nodes;
+  free_wrapper((void **) &hashtblP->lock_nodes);
+  hashtblP->size = size;
+  hashtblP->nodes = nodes;
+  hashtblP->lock_nodes = lock_nodes;
+  hashtblP->resizes += 1;
   pthread_mutex_unlock(&hashtblP->mutex);
   PRINT_HASHTABLE (hashtblP, "return OK\n");
   return HASH_TABLE_OK;
 }
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   obj_hashtable_get_stats() walks through the buckets to count the length of their chains, see hashtable_get_stats().
+*/
+hashtable_rc_t
+obj_hashtable_get_stats (
+  const obj_hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  obj_hash_node_t                        *node = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             chain = 0;
+
+  if (hashtblP == NULL) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  for (n = 0; n < hashtblP->size; ++n) {
+    for (chain = 0, node = hashtblP->nodes[n]; node; node = node->next) {
+      chain++;
+    }
+    statsP->num_elements += chain;
+    statsP->max_chain = (chain > statsP->max_chain) ? chain : statsP->max_chain;
+    statsP->chains[(chain < HASH_TABLE_STATS_CHAIN_LENGTHS) ? chain : HASH_TABLE_STATS_CHAIN_LENGTHS - 1] += 1;
+  }
+  statsP->size    = hashtblP->size;
+  statsP->resizes = hashtblP->resizes;
+  return HASH_TABLE_OK;
+}
+
+//------------------------------------------------------------------------------
+/*
+   Statistics
+   obj_hashtable_ts_get_stats() locks the buckets one after the other, the statistics are not a snapshot of the table.
+*/
+hashtable_rc_t
+obj_hashtable_ts_get_stats (
+  const obj_hash_table_t * const hashtblP,
+  hashtable_stats_t * const statsP)
+{
+  obj_hash_node_t                        *node = NULL;
+  hash_size_t                             n = 0;
+  hash_size_t                             chain = 0;
+
+  if (hashtblP == NULL) {
+    return HASH_TABLE_BAD_PARAMETER_HASHTABLE;
+  }
+
+  memset (statsP, 0, sizeof (*statsP));
+  pthread_mutex_lock((pthread_mutex_t *) &hashtblP->mutex);
+  for (n = 0; n < hashtblP->size; ++n) {
+    pthread_mutex_lock(&hashtblP->lock_nodes[n]);
+    for (chain = 0, node = hashtblP->nodes[n]; node; node = node->next) {
+      chain++;
+    }
+    pthread_mutex_unlock(&hashtblP->lock_nodes[n]);
+    statsP->num_elements += chain;
+    statsP->max_chain = (chain > statsP->max_chain) ? chain : statsP->max_chain;
+    statsP->chains[(chain < HASH_TABLE_STATS_CHAIN_LENGTHS) ? chain : HASH_TABLE_STATS_CHAIN_LENGTHS - 1] += 1;
+  }
+  statsP->size             = hashtblP->size;
+  statsP->resizes          = hashtblP->resizes;
+  statsP->lock_contentions = __atomic_load_n (&hashtblP->lock_stats->contentions, __ATOMIC_RELAXED);
+  statsP->lock_wait_ns     = __atomic_load_n (&hashtblP->lock_stats->wait_ns, __ATOMIC_RELAXED);
+  pthread_mutex_unlock((pthread_mutex_t *) &hashtblP->mutex);
+  return HASH_TABLE_OK;
+}
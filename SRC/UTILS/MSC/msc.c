@@ -66,9 +66,13 @@
 #include "timer.h"
 
 #include "msc.h"
+#if MESSAGE_CHART_GENERATOR_BINARY
+#include "msc_bin.h"
+#endif
 #include "assertions.h"
 #include "dynamic_memory_check.h"
 #include "log.h"
+#include "oai_clock.h"
 
 //-------------------------------
 #define MSC_MAX_QUEUE_ELEMENTS    1024
@@ -149,8 +153,7 @@ void *msc_task (void *args_p)
 //------------------------------------------------------------------------------
 static void msc_get_elapsed_time_since_start(struct timeval * const elapsed_time)
 {
-  // no thread safe but do not matter a lot
-  gettimeofday(elapsed_time, NULL);
+  oai_clock_coarse_realtime(elapsed_time);
   // no timersub call for fastest operations
   elapsed_time->tv_sec = elapsed_time->tv_sec - g_msc_start_time_second;
 }
@@ -163,7 +166,9 @@ msc_init (
 {
   int                                     i = 0;
   int                                     rv = 0;
+#if !MESSAGE_CHART_GENERATOR_BINARY
   void                                   *pointer_p = NULL;
+#endif
   char                                    msc_filename[256];
 
 #if LOG_OAI
@@ -171,11 +176,22 @@ msc_init (
   g_msc_start_time_second = log_get_start_time_sec();
 #else
   struct timeval                          start_time = {.tv_sec=0, .tv_usec=0};
-  rv = gettimeofday(&start_time, NULL);
+  oai_clock_coarse_realtime(&start_time);
   g_msc_start_time_second = start_time.tv_sec;
 #endif
 
   fprintf (stderr, "Initializing MSC logs\n");
+#if MESSAGE_CHART_GENERATOR_BINARY
+  // no queue, no memory pool, records are written by the calling thread in the mapped file
+  rv = snprintf (msc_filename, 256, "/tmp/openair.msc.%u.bin", envP);
+
+  if ((0 >= rv) || (256 < rv)) {
+    fprintf (stderr, "Error in MSC log file name");
+  }
+
+  rv = msc_bin_open (msc_filename, envP, g_msc_start_time_second);
+  AssertFatal (0 == rv, "Could not open MSC binary file %s", msc_filename);
+#else
   rv = snprintf (msc_filename, 256, "/tmp/openair.msc.%u.log", envP);   // TODO NAME
 
   if ((0 >= rv) || (256 < rv)) {
@@ -201,6 +217,7 @@ msc_init (
     rv = lfds611_stack_guaranteed_push (g_msc_memory_stack_p, pointer_p);
     AssertFatal (rv, "lfds611_stack_guaranteed_push failed for item %u\n", i);
   }
+#endif
 
   for (i = MIN_MSC_PROTOS; i < MAX_MSC_PROTOS; i++) {
     switch (i) {
@@ -399,8 +416,10 @@ msc_init (
 //------------------------------------------------------------------------------
 void msc_start_use (void)
 {
+#if !MESSAGE_CHART_GENERATOR_BINARY
   lfds611_queue_use (g_msc_message_queue_p);
   lfds611_stack_use (g_msc_memory_stack_p);
+#endif
 }
 
 
@@ -410,6 +429,10 @@ void msc_flush_messages (void)
   int                                     rv = 0;
   msc_queue_item_t                       *item_p = NULL;
 
+#if MESSAGE_CHART_GENERATOR_BINARY
+  // nothing buffered, the kernel writes back the mapped file
+  return;
+#endif
   while ((rv = lfds611_queue_dequeue (g_msc_message_queue_p, (void **)&item_p)) == 1) {
     if (NULL != item_p->message_str) {
       fputs (item_p->message_str, g_msc_fd);
@@ -429,6 +452,9 @@ void msc_end (void)
 {
   int                                     rv = 0;
 
+#if MESSAGE_CHART_GENERATOR_BINARY
+  msc_bin_close ();
+#endif
   if (NULL != g_msc_fd) {
     msc_flush_messages ();
     rv = fflush (g_msc_fd);
@@ -452,6 +478,12 @@ void msc_log_declare_proto (const msc_proto_t protoP)
   msc_queue_item_t                       *new_item_p = NULL;
   char                                   *char_message_p = NULL;
 
+#if MESSAGE_CHART_GENERATOR_BINARY
+  if ((MIN_MSC_PROTOS <= protoP) && (MAX_MSC_PROTOS > protoP)) {
+    msc_bin_log_declare_proto (protoP, &g_msc_proto2str[protoP][0], __sync_fetch_and_add (&g_message_number, 1));
+  }
+  return;
+#endif
   if ((MIN_MSC_PROTOS <= protoP) && (MAX_MSC_PROTOS > protoP)) {
     // may be build a memory pool for that also ?
     new_item_p = malloc (sizeof (msc_queue_item_t));
@@ -512,6 +544,16 @@ void msc_log_event (const msc_proto_t protoP, char *format, ...)
     return;
   }
 
+#if MESSAGE_CHART_GENERATOR_BINARY
+  {
+    struct timeval elapsed_time;
+    msc_get_elapsed_time_since_start(&elapsed_time);
+    va_start (args, format);
+    msc_bin_log (MSC_BIN_RECORD_EVENT, protoP, MSC_BIN_OP_NONE, protoP, __sync_fetch_and_add (&g_message_number, 1), &elapsed_time, format, args);
+    va_end (args);
+    return;
+  }
+#endif
   new_item_p = malloc (sizeof (msc_queue_item_t));
 
   if (NULL != new_item_p) {
@@ -596,6 +638,17 @@ msc_log_message (
     return;
   }
 
+#if MESSAGE_CHART_GENERATOR_BINARY
+  {
+    struct timeval elapsed_time;
+    msc_get_elapsed_time_since_start(&elapsed_time);
+    va_start (args, format);
+    msc_bin_log (MSC_BIN_RECORD_MESSAGE, proto1P, msc_bin_operation_str2int (message_operationP), proto2P,
+        __sync_fetch_and_add (&g_message_number, 1), &elapsed_time, format, args);
+    va_end (args);
+    return;
+  }
+#endif
   new_item_p = malloc (sizeof (msc_queue_item_t));
 
   if (NULL != new_item_p) {
@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file msc_bin.c
+   \brief Binary message chart generator trace. The calling thread records the message number, a timestamp, the protocols,
+   the id of the format string and the raw arguments in a ring mapped on a file, formatting is done offline by msc_bin2txt.
+   The file survives a crash of the process, there is no flush.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "msc.h"
+#include "msc_bin.h"
+
+#define MSC_BIN_MAX_RECORD_SIZE  (sizeof(msc_bin_record_hdr_t) + MSC_BIN_MAX_ARGS * (16 + MSC_BIN_MAX_STRING_LENGTH))  /* less than MSC_BIN_CHUNK_SIZE */
+
+/*! \struct  msc_bin_format_t
+* \brief Writer side description of a format string, found by the address of the format string.
+*/
+typedef struct msc_bin_format_s {
+  const char        *format;        /*!< \brief Key, stored last */
+  uint32_t           id;            /*!< \brief MSC_BIN_FORMAT_ID_NONE if not recordable raw */
+  uint8_t            num_args;
+  uint8_t            arg_type[MSC_BIN_MAX_ARGS];
+} msc_bin_format_t;
+
+typedef struct msc_bin_s {
+  int                fd;
+  uint8_t           *map;
+  size_t             map_size;
+  msc_bin_file_hdr_t *hdr;
+  uint8_t           *format_table;
+  uint8_t           *ring;
+  pthread_mutex_t    format_mutex;
+  uint32_t           num_formats;
+  msc_bin_format_t   formats[MSC_BIN_MAX_FORMATS];  /*!< \brief Open addressing on the format address */
+} msc_bin_t;
+
+const char * const msc_bin_operation2str[MSC_BIN_OP_NONE] = {"<-", "x-", "->", "-x"};
+
+static msc_bin_t g_msc_bin = {.fd = -1, .format_mutex = PTHREAD_MUTEX_INITIALIZER};
+
+//------------------------------------------------------------------------------
+// Parse one printf conversion specification starting at '%', glibc syntax without positional arguments
+void msc_bin_parse_conversion(const char * const specP, msc_bin_conversion_t * const convP)
+{
+  const char *p = specP + 1;
+
+  memset(convP, 0, sizeof(*convP));
+  convP->arg_type = MSC_BIN_ARG_UNSUPPORTED;
+
+  convP->flags = p;
+  while (('-' == *p) || ('+' == *p) || (' ' == *p) || ('#' == *p) || ('0' == *p) || ('\'' == *p)) p++;
+  convP->flags_length = p - convP->flags;
+
+  convP->width = p;
+  if ('*' == *p) {
+    p++;
+  } else {
+    while (isdigit(*p)) p++;
+  }
+  convP->width_length = p - convP->width;
+
+  if ('.' == *p) {
+    p++;
+    convP->has_precision = true;
+    convP->precision = p;
+    if ('*' == *p) {
+      // not recorded
+      convP->length = p - specP;
+      return;
+    }
+    while (isdigit(*p)) p++;
+    convP->precision_length = p - convP->precision;
+  }
+
+  convP->conversion = p;
+  msc_bin_arg_type_t int_type = MSC_BIN_ARG_INT;
+  bool               is_long_double_or_wide = false;
+  switch (*p) {
+    case 'h': p++; if ('h' == *p) p++; break;
+    case 'l': p++; int_type = MSC_BIN_ARG_LONG; if ('l' == *p) {p++; int_type = MSC_BIN_ARG_LONG_LONG;} break;
+    case 'q': p++; int_type = MSC_BIN_ARG_LONG_LONG; break;
+    case 'j': p++; int_type = MSC_BIN_ARG_INTMAX; break;
+    case 'z':
+    case 'Z': p++; int_type = MSC_BIN_ARG_SIZE; break;
+    case 't': p++; int_type = MSC_BIN_ARG_PTRDIFF; break;
+    case 'L': p++; is_long_double_or_wide = true; break;
+    default:;
+  }
+
+  switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      convP->arg_type = (is_long_double_or_wide) ? MSC_BIN_ARG_UNSUPPORTED : int_type;
+      break;
+    case 'c':
+      convP->arg_type = (p == convP->conversion) ? MSC_BIN_ARG_INT : MSC_BIN_ARG_UNSUPPORTED;
+      break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+      convP->arg_type = (is_long_double_or_wide) ? MSC_BIN_ARG_UNSUPPORTED : MSC_BIN_ARG_DOUBLE;
+      break;
+    case 'p':
+      convP->arg_type = MSC_BIN_ARG_POINTER;
+      break;
+    case 's':
+      // a precision may mean a non NUL terminated buffer, format it in the calling thread
+      convP->arg_type = ((p == convP->conversion) && (!convP->has_precision)) ? MSC_BIN_ARG_STRING : MSC_BIN_ARG_UNSUPPORTED;
+      break;
+    case '%':
+      convP->arg_type = (p == specP + 1) ? MSC_BIN_ARG_NONE : MSC_BIN_ARG_UNSUPPORTED;
+      break;
+    default:
+      // %n, %m, %C, %S, end of string, ...
+      convP->arg_type = MSC_BIN_ARG_UNSUPPORTED;
+      convP->length = p - specP;
+      return;
+  }
+  p++;
+  convP->conversion_length = p - convP->conversion;
+  convP->length = p - specP;
+}
+
+//------------------------------------------------------------------------------
+msc_bin_operation_t msc_bin_operation_str2int(const char * const operationP)
+{
+  int i = 0;
+
+  for (i = 0; i < MSC_BIN_OP_NONE; i++) {
+    if ((operationP[0] == msc_bin_operation2str[i][0]) && (operationP[1] == msc_bin_operation2str[i][1])) {
+      return (msc_bin_operation_t)i;
+    }
+  }
+  return MSC_BIN_OP_NONE;
+}
+
+//------------------------------------------------------------------------------
+int msc_bin_open(const char * const filenameP, const msc_env_t envP, const int64_t start_time_secP)
+{
+  size_t   format_table_offset = (sizeof(msc_bin_file_hdr_t) + 4095) & ~(size_t)4095;
+  size_t   ring_offset = format_table_offset + MSC_BIN_FORMAT_TABLE_SIZE;
+
+  g_msc_bin.map_size = ring_offset + MSC_BIN_RING_SIZE;
+  g_msc_bin.fd = open(filenameP, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (0 > g_msc_bin.fd) {
+    fprintf (stderr, "Could not open MSC binary file %s : %s\n", filenameP, strerror (errno));
+    return -1;
+  }
+  if (ftruncate(g_msc_bin.fd, g_msc_bin.map_size)) {
+    fprintf (stderr, "Could not size MSC binary file %s : %s\n", filenameP, strerror (errno));
+    close(g_msc_bin.fd);
+    g_msc_bin.fd = -1;
+    return -1;
+  }
+  g_msc_bin.map = mmap(NULL, g_msc_bin.map_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_msc_bin.fd, 0);
+  if (MAP_FAILED == g_msc_bin.map) {
+    fprintf (stderr, "Could not map MSC binary file %s : %s\n", filenameP, strerror (errno));
+    g_msc_bin.map = NULL;
+    close(g_msc_bin.fd);
+    g_msc_bin.fd = -1;
+    return -1;
+  }
+  g_msc_bin.hdr          = (msc_bin_file_hdr_t *)g_msc_bin.map;
+  g_msc_bin.format_table = g_msc_bin.map + format_table_offset;
+  g_msc_bin.ring         = g_msc_bin.map + ring_offset;
+  g_msc_bin.num_formats  = 0;
+  memset(g_msc_bin.formats, 0, sizeof(g_msc_bin.formats));
+
+  // file is zero filled by ftruncate, the magic is written last
+  g_msc_bin.hdr->version             = MSC_BIN_VERSION;
+  g_msc_bin.hdr->env                 = envP;
+  g_msc_bin.hdr->format_table_offset = format_table_offset;
+  g_msc_bin.hdr->format_table_size   = MSC_BIN_FORMAT_TABLE_SIZE;
+  g_msc_bin.hdr->format_table_used   = 0;
+  g_msc_bin.hdr->ring_offset         = ring_offset;
+  g_msc_bin.hdr->ring_size           = MSC_BIN_RING_SIZE;
+  g_msc_bin.hdr->chunk_size          = MSC_BIN_CHUNK_SIZE;
+  g_msc_bin.hdr->head                = 0;
+  g_msc_bin.hdr->start_time_sec      = start_time_secP;
+  __atomic_store_n (&g_msc_bin.hdr->magic, MSC_BIN_MAGIC, __ATOMIC_RELEASE);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void msc_bin_close(void)
+{
+  if (NULL != g_msc_bin.map) {
+    if (msync(g_msc_bin.map, g_msc_bin.map_size, MS_SYNC)) {
+      fprintf (stderr, "Error while syncing MSC binary file: %s\n", strerror (errno));
+    }
+    munmap(g_msc_bin.map, g_msc_bin.map_size);
+    g_msc_bin.map = NULL;
+    g_msc_bin.hdr = NULL;
+  }
+  if (0 <= g_msc_bin.fd) {
+    close(g_msc_bin.fd);
+    g_msc_bin.fd = -1;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Declarations are kept in the file header, they must survive the overwrite of the oldest records
+void msc_bin_log_declare_proto(const msc_proto_t protoP, const char * const nameP, const uint64_t message_numberP)
+{
+  if ((NULL == g_msc_bin.hdr) || (MIN_MSC_PROTOS > protoP) || (MAX_MSC_PROTOS <= protoP)) {
+    return;
+  }
+  strncpy(&g_msc_bin.hdr->proto_name[protoP][0], nameP, MSC_BIN_MAX_PROTO_NAME_LENGTH - 1);
+  g_msc_bin.hdr->proto_number[protoP] = message_numberP;
+  __atomic_store_n (&g_msc_bin.hdr->is_proto_declared[protoP], 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+// Parse the format and append it to the format table of the file, once per format string
+static const msc_bin_format_t * msc_bin_register_format(msc_bin_format_t * const entryP, const char * const formatP)
+{
+  msc_bin_conversion_t  conv;
+  msc_bin_format_hdr_t *format_hdr_p = NULL;
+  const char           *p = formatP;
+  size_t                length = strlen(formatP);
+  uint32_t              size = (sizeof(msc_bin_format_hdr_t) + length + 1 + 7) & ~7;
+  uint32_t              used = g_msc_bin.hdr->format_table_used;
+  bool                  is_binary_capable = ((used + size) <= MSC_BIN_FORMAT_TABLE_SIZE);
+
+  entryP->num_args = 0;
+  while ((is_binary_capable) && (*p)) {
+    if ('%' != *p) {
+      p++;
+      continue;
+    }
+    msc_bin_parse_conversion(p, &conv);
+    if (MSC_BIN_ARG_UNSUPPORTED == conv.arg_type) {
+      is_binary_capable = false;
+      break;
+    }
+    p += conv.length;
+    if (MSC_BIN_ARG_NONE == conv.arg_type) {
+      continue;
+    }
+    if ((entryP->num_args + 2) > MSC_BIN_MAX_ARGS) {
+      is_binary_capable = false;
+      break;
+    }
+    if ((1 == conv.width_length) && ('*' == conv.width[0])) {
+      entryP->arg_type[entryP->num_args++] = MSC_BIN_ARG_INT;
+    }
+    entryP->arg_type[entryP->num_args++] = conv.arg_type;
+  }
+
+  if (is_binary_capable) {
+    format_hdr_p = (msc_bin_format_hdr_t *)&g_msc_bin.format_table[used];
+    memcpy((char *)format_hdr_p + sizeof(msc_bin_format_hdr_t), formatP, length + 1);
+    format_hdr_p->id   = g_msc_bin.num_formats;
+    format_hdr_p->size = size;
+    entryP->id = g_msc_bin.num_formats++;
+    __atomic_store_n (&g_msc_bin.hdr->format_table_used, used + size, __ATOMIC_RELEASE);
+  } else {
+    // never recorded raw, but do not parse it again
+    entryP->id = MSC_BIN_FORMAT_ID_NONE;
+  }
+  __atomic_store_n (&entryP->format, formatP, __ATOMIC_RELEASE);
+  return entryP;
+}
+
+//------------------------------------------------------------------------------
+// Returns NULL if the table of formats is full
+static const msc_bin_format_t * msc_bin_get_format(const char * const formatP)
+{
+  uint32_t                 slot = (uint32_t)(((uintptr_t)formatP >> 3) * 2654435761U) & (MSC_BIN_MAX_FORMATS - 1);
+  const msc_bin_format_t  *entry_p = NULL;
+  const char              *key = NULL;
+  int                      i = 0;
+
+  for (i = 0; i < MSC_BIN_MAX_FORMATS; i++) {
+    key = __atomic_load_n (&g_msc_bin.formats[slot].format, __ATOMIC_ACQUIRE);
+    if (formatP == key) {
+      return &g_msc_bin.formats[slot];
+    }
+    if (NULL == key) {
+      pthread_mutex_lock (&g_msc_bin.format_mutex);
+      // may have been registered by another thread meanwhile, in this slot or in a next one
+      key = g_msc_bin.formats[slot].format;
+      if (NULL == key) {
+        entry_p = msc_bin_register_format(&g_msc_bin.formats[slot], formatP);
+        pthread_mutex_unlock (&g_msc_bin.format_mutex);
+        return entry_p;
+      }
+      pthread_mutex_unlock (&g_msc_bin.format_mutex);
+      if (formatP == key) {
+        return &g_msc_bin.formats[slot];
+      }
+    }
+    slot = (slot + 1) & (MSC_BIN_MAX_FORMATS - 1);
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// Encode the raw arguments after the record header, returns the record size, 0 if a string argument does not fit
+static uint32_t msc_bin_encode_args(const msc_bin_format_t * const formatP, uint8_t * const recordP, va_list args)
+{
+  uint8_t      *arg_p = recordP + sizeof(msc_bin_record_hdr_t);
+  const char   *str = NULL;
+  uint32_t      str_length = 0;
+  int           i = 0;
+
+  for (i = 0; i < formatP->num_args; i++) {
+    switch (formatP->arg_type[i]) {
+      case MSC_BIN_ARG_INT:       *(int64_t *)arg_p  = va_arg(args, int); break;
+      case MSC_BIN_ARG_LONG:      *(int64_t *)arg_p  = va_arg(args, long); break;
+      case MSC_BIN_ARG_LONG_LONG: *(int64_t *)arg_p  = va_arg(args, long long); break;
+      case MSC_BIN_ARG_SIZE:      *(uint64_t *)arg_p = va_arg(args, size_t); break;
+      case MSC_BIN_ARG_INTMAX:    *(int64_t *)arg_p  = va_arg(args, intmax_t); break;
+      case MSC_BIN_ARG_PTRDIFF:   *(int64_t *)arg_p  = va_arg(args, ptrdiff_t); break;
+      case MSC_BIN_ARG_DOUBLE:    *(double *)arg_p   = va_arg(args, double); break;
+      case MSC_BIN_ARG_POINTER:   *(uint64_t *)arg_p = (uintptr_t)va_arg(args, void *); break;
+      case MSC_BIN_ARG_STRING:
+        str = va_arg(args, const char *);
+        if (str) {
+          str_length = strnlen(str, MSC_BIN_MAX_STRING_LENGTH);
+          // may be longer, do not truncate it silently
+          if (MSC_BIN_MAX_STRING_LENGTH == str_length) {
+            return 0;
+          }
+          *(uint64_t *)arg_p = str_length;
+          memcpy(arg_p + 8, str, str_length);
+          arg_p[8 + str_length] = '\0';
+          arg_p += (str_length + 8) & ~7;
+        } else {
+          *(uint64_t *)arg_p = MSC_BIN_STRING_NULL;
+        }
+        break;
+      default:;
+    }
+    arg_p += 8;
+  }
+  return arg_p - recordP;
+}
+
+//------------------------------------------------------------------------------
+// Reserve space in the ring, skipping the end of the current chunk if the record does not fit in it
+static uint64_t msc_bin_reserve(const uint32_t sizeP)
+{
+  uint64_t   head = __atomic_load_n (&g_msc_bin.hdr->head, __ATOMIC_ACQUIRE);
+  uint64_t   position = 0;
+  uint32_t   chunk_left = 0;
+
+  do {
+    position   = head;
+    chunk_left = MSC_BIN_CHUNK_SIZE - (position & (MSC_BIN_CHUNK_SIZE - 1));
+    if (sizeP > chunk_left) {
+      position += chunk_left;
+    }
+  } while (!__atomic_compare_exchange_n (&g_msc_bin.hdr->head, &head, position + sizeP, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+  return position;
+}
+
+//------------------------------------------------------------------------------
+void msc_bin_log(
+  const msc_bin_record_type_t typeP,
+  const msc_proto_t proto1P,
+  const msc_bin_operation_t operationP,
+  const msc_proto_t proto2P,
+  const uint64_t message_numberP,
+  const struct timeval * const elapsed_timeP,
+  const char * const formatP,
+  va_list args)
+{
+  uint64_t                record[(MSC_BIN_MAX_RECORD_SIZE + 7) / 8];
+  msc_bin_record_hdr_t   *hdr_p = (msc_bin_record_hdr_t *)record;
+  const msc_bin_format_t *format_p = NULL;
+  uint8_t                *ring_record_p = NULL;
+  uint64_t                position = 0;
+  uint32_t                size = 0;
+  int                     rv = 0;
+  va_list                 raw_args;
+
+  if (NULL == g_msc_bin.hdr) {
+    return;
+  }
+  format_p = msc_bin_get_format(formatP);
+  if ((format_p) && (MSC_BIN_FORMAT_ID_NONE != format_p->id)) {
+    // args are needed again for the text record
+    va_copy (raw_args, args);
+    size = msc_bin_encode_args(format_p, (uint8_t *)record, raw_args);
+    va_end (raw_args);
+    hdr_p->format_id = format_p->id;
+  }
+  if (0 == size) {
+    rv = vsnprintf((char *)record + sizeof(msc_bin_record_hdr_t), MSC_BIN_MAX_TEXT_LENGTH, formatP, args);
+    if (0 > rv) {
+      return;
+    }
+    if (rv >= MSC_BIN_MAX_TEXT_LENGTH) {
+      rv = MSC_BIN_MAX_TEXT_LENGTH - 1;
+    }
+    size = (sizeof(msc_bin_record_hdr_t) + rv + 1 + 7) & ~7;
+    hdr_p->format_id = MSC_BIN_FORMAT_ID_NONE;
+  }
+  hdr_p->message_number = message_numberP;
+  hdr_p->size           = size;
+  hdr_p->tv_sec         = elapsed_timeP->tv_sec;
+  hdr_p->tv_usec        = elapsed_timeP->tv_usec;
+  hdr_p->type           = typeP;
+  hdr_p->proto1         = proto1P;
+  hdr_p->operation      = operationP;
+  hdr_p->proto2         = proto2P;
+  hdr_p->reserved       = 0;
+
+  position      = msc_bin_reserve(size);
+  ring_record_p = &g_msc_bin.ring[position & (MSC_BIN_RING_SIZE - 1)];
+  // the position validates the record, the previous one at this place has a position older by a multiple of the ring size
+  memcpy(ring_record_p + sizeof(uint64_t), (uint8_t *)record + sizeof(uint64_t), size - sizeof(uint64_t));
+  __atomic_store_n ((uint64_t *)ring_record_p, position, __ATOMIC_RELEASE);
+}
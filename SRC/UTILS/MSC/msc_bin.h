@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file msc_bin.h
+   \brief Binary message chart generator trace, written in a memory mapped ring file, converted offline in the text format of msc.c by msc_bin2txt
+*/
+#ifndef FILE_MSC_BIN_SEEN
+#define FILE_MSC_BIN_SEEN
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/time.h>
+
+#include "msc.h"
+
+#define MSC_BIN_MAGIC                   0x4243534D  /* "MSCB" */
+#define MSC_BIN_VERSION                          1
+#define MSC_BIN_RING_SIZE                (1 << 24)  /* bytes, power of 2, oldest records are overwritten */
+#define MSC_BIN_CHUNK_SIZE                    4096  /* records never cross a chunk boundary */
+#define MSC_BIN_FORMAT_TABLE_SIZE        (1 << 18)  /* bytes, append only, never overwritten */
+#define MSC_BIN_MAX_FORMATS                   1024  /* power of 2 */
+#define MSC_BIN_MAX_PROTO_NAME_LENGTH           16
+#define MSC_BIN_MAX_ARGS                        16
+#define MSC_BIN_MAX_STRING_LENGTH              128
+#define MSC_BIN_MAX_TEXT_LENGTH                512
+#define MSC_BIN_MAX_SPEC_LENGTH                 48
+#define MSC_BIN_FORMAT_ID_NONE          0xFFFFFFFF  /* record body is the formatted text */
+#define MSC_BIN_STRING_NULL             0xFFFFFFFF
+
+typedef enum {
+  MSC_BIN_RECORD_EVENT = 1,
+  MSC_BIN_RECORD_MESSAGE,
+} msc_bin_record_type_t;
+
+/*! \enum  msc_bin_operation_t
+* \brief Operation of a MSC message, MSC_LOG_RX_MESSAGE, MSC_LOG_RX_DISCARDED_MESSAGE, MSC_LOG_TX_MESSAGE, MSC_LOG_TX_MESSAGE_FAILED.
+*/
+typedef enum {
+  MSC_BIN_OP_RX = 0,
+  MSC_BIN_OP_RX_DISCARDED,
+  MSC_BIN_OP_TX,
+  MSC_BIN_OP_TX_FAILED,
+  MSC_BIN_OP_NONE
+} msc_bin_operation_t;
+
+/*! \enum  msc_bin_arg_type_t
+* \brief C type of a raw argument recorded in a binary MSC record, deduced from the printf conversion.
+*/
+typedef enum {
+  MSC_BIN_ARG_INT = 0,
+  MSC_BIN_ARG_LONG,
+  MSC_BIN_ARG_LONG_LONG,
+  MSC_BIN_ARG_SIZE,
+  MSC_BIN_ARG_INTMAX,
+  MSC_BIN_ARG_PTRDIFF,
+  MSC_BIN_ARG_DOUBLE,
+  MSC_BIN_ARG_POINTER,
+  MSC_BIN_ARG_STRING,
+  MSC_BIN_ARG_NONE,         /* "%%" */
+  MSC_BIN_ARG_UNSUPPORTED
+} msc_bin_arg_type_t;
+
+/*! \struct  msc_bin_conversion_t
+* \brief One printf conversion specification split in its parts, so that a '*' width can be replaced by its recorded value.
+*/
+typedef struct msc_bin_conversion_s {
+  size_t              length;            /*!< \brief From '%' to the conversion character included */
+  const char         *flags;
+  size_t              flags_length;
+  const char         *width;             /*!< \brief Digits or "*" */
+  size_t              width_length;
+  const char         *precision;         /*!< \brief Digits, after the '.' */
+  size_t              precision_length;
+  bool                has_precision;
+  const char         *conversion;        /*!< \brief Length modifier and conversion character */
+  size_t              conversion_length;
+  msc_bin_arg_type_t  arg_type;
+} msc_bin_conversion_t;
+
+/*! \struct  msc_bin_file_hdr_t
+* \brief Header of a binary MSC file, followed by the format table then by the ring of records.
+*/
+typedef struct msc_bin_file_hdr_s {
+  uint32_t        magic;
+  uint16_t        version;
+  uint16_t        env;                   /*!< \brief msc_env_t */
+  uint32_t        format_table_offset;   /*!< \brief From the beginning of the file */
+  uint32_t        format_table_size;
+  uint32_t        format_table_used;     /*!< \brief Bytes, updated by the writers under mutex */
+  uint32_t        ring_offset;           /*!< \brief From the beginning of the file */
+  uint32_t        ring_size;
+  uint32_t        chunk_size;
+  uint64_t        head;                  /*!< \brief Absolute position of the next record, updated by the writers with CAS */
+  int64_t         start_time_sec;
+  uint64_t        proto_number[MAX_MSC_PROTOS];  /*!< \brief Message number of the [PROTO] line */
+  uint8_t         is_proto_declared[MAX_MSC_PROTOS];
+  char            proto_name[MAX_MSC_PROTOS][MSC_BIN_MAX_PROTO_NAME_LENGTH];
+} msc_bin_file_hdr_t;
+
+/*! \struct  msc_bin_format_hdr_t
+* \brief Entry of the format table, followed by the NUL terminated format string, 8 bytes aligned.
+*/
+typedef struct msc_bin_format_hdr_s {
+  uint32_t        size;                  /*!< \brief Whole entry size */
+  uint32_t        id;
+} msc_bin_format_hdr_t;
+
+/*! \struct  msc_bin_record_hdr_t
+* \brief Header of a record in the ring, followed by the raw arguments (8 bytes slots, strings are length + bytes)
+* or by the formatted text if format_id is MSC_BIN_FORMAT_ID_NONE (format not recordable raw, or string argument
+* of MSC_BIN_MAX_STRING_LENGTH bytes or more).
+*/
+typedef struct msc_bin_record_hdr_s {
+  uint64_t        position;              /*!< \brief Absolute position of the record, stored last, a stale value means no valid record */
+  uint64_t        message_number;
+  uint32_t        size;                  /*!< \brief Whole record size, 8 bytes aligned */
+  uint32_t        format_id;
+  uint32_t        tv_sec;                /*!< \brief Elapsed time since MSC start */
+  uint32_t        tv_usec;
+  uint8_t         type;                  /*!< \brief msc_bin_record_type_t */
+  uint8_t         proto1;
+  uint8_t         operation;             /*!< \brief msc_bin_operation_t */
+  uint8_t         proto2;
+  uint32_t        reserved;
+} msc_bin_record_hdr_t;
+
+extern const char * const msc_bin_operation2str[MSC_BIN_OP_NONE];
+
+void msc_bin_parse_conversion(const char * const specP, msc_bin_conversion_t * const convP);
+msc_bin_operation_t msc_bin_operation_str2int(const char * const operationP);
+
+int  msc_bin_open(const char * const filenameP, const msc_env_t envP, const int64_t start_time_secP);
+void msc_bin_close(void);
+void msc_bin_log_declare_proto(const msc_proto_t protoP, const char * const nameP, const uint64_t message_numberP);
+void msc_bin_log(
+  const msc_bin_record_type_t typeP,
+  const msc_proto_t proto1P,
+  const msc_bin_operation_t operationP,
+  const msc_proto_t proto2P,
+  const uint64_t message_numberP,
+  const struct timeval * const elapsed_timeP,
+  const char * const formatP,
+  va_list args);
+#endif
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file msc_bin2txt.c
+   \brief Offline converter of a binary MSC file (/tmp/openair.msc.<env>.bin) to the text format of msc.c (/tmp/openair.msc.<env>.log),
+   the input of SCRIPTS/msc_gen. Records overwritten in the ring are lost, protocol declarations are not.
+   Usage: msc_bin2txt [-i /tmp/openair.msc.4.bin] [-o /tmp/openair.msc.4.log]
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "msc.h"
+#include "msc_bin.h"
+
+typedef struct msc_bin2txt_format_s {
+  const char        *format;
+  uint8_t            arg_type[MSC_BIN_MAX_ARGS];
+} msc_bin2txt_format_t;
+
+static msc_bin2txt_format_t    g_formats[MSC_BIN_MAX_FORMATS];
+static uint32_t                g_num_formats = 0;
+
+//------------------------------------------------------------------------------
+static void msc_bin2txt_load_formats(const msc_bin_file_hdr_t * const hdrP, const uint8_t * const mapP)
+{
+  const uint8_t              *table = mapP + hdrP->format_table_offset;
+  const msc_bin_format_hdr_t *format_hdr_p = NULL;
+  msc_bin_conversion_t        conv;
+  const char                 *p = NULL;
+  uint32_t                    offset = 0;
+  int                         num_args = 0;
+
+  while ((offset + sizeof(msc_bin_format_hdr_t)) <= hdrP->format_table_used) {
+    format_hdr_p = (const msc_bin_format_hdr_t *)&table[offset];
+    if ((0 == format_hdr_p->size) || (MSC_BIN_MAX_FORMATS <= format_hdr_p->id)) {
+      break;
+    }
+    p = (const char *)format_hdr_p + sizeof(msc_bin_format_hdr_t);
+    g_formats[format_hdr_p->id].format = p;
+    // same parsing as the writer, formats of the table are all recordable raw
+    num_args = 0;
+    while (*p) {
+      if ('%' != *p) {
+        p++;
+        continue;
+      }
+      msc_bin_parse_conversion(p, &conv);
+      p += conv.length;
+      if ((MSC_BIN_ARG_NONE == conv.arg_type) || ((num_args + 2) > MSC_BIN_MAX_ARGS)) {
+        continue;
+      }
+      if ((1 == conv.width_length) && ('*' == conv.width[0])) {
+        g_formats[format_hdr_p->id].arg_type[num_args++] = MSC_BIN_ARG_INT;
+      }
+      g_formats[format_hdr_p->id].arg_type[num_args++] = conv.arg_type;
+    }
+    if (format_hdr_p->id >= g_num_formats) {
+      g_num_formats = format_hdr_p->id + 1;
+    }
+    offset += format_hdr_p->size;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Print the user part of a record the same way vsnprintf() did it in msc.c
+static void msc_bin2txt_print_args(const msc_bin_record_hdr_t * const recordP, FILE * const outP)
+{
+  const uint8_t          *arg_p = (const uint8_t *)recordP + sizeof(msc_bin_record_hdr_t);
+  const char             *p = NULL;
+  msc_bin_conversion_t    conv;
+  char                    spec[MSC_BIN_MAX_SPEC_LENGTH];
+  int                     spec_length = 0;
+  int                     arg_index = 0;
+  uint64_t                value = 0;
+
+  if (MSC_BIN_FORMAT_ID_NONE == recordP->format_id) {
+    fputs ((const char *)arg_p, outP);
+    return;
+  }
+  if ((recordP->format_id >= g_num_formats) || (NULL == g_formats[recordP->format_id].format)) {
+    fprintf (outP, "UNKNOWN_FORMAT_%u", recordP->format_id);
+    return;
+  }
+
+  p = g_formats[recordP->format_id].format;
+  while (*p) {
+    if ('%' != *p) {
+      const char *literal = p;
+      while ((*p) && ('%' != *p)) p++;
+      fwrite (literal, 1, p - literal, outP);
+      continue;
+    }
+    msc_bin_parse_conversion(p, &conv);
+    p += conv.length;
+    if (MSC_BIN_ARG_NONE == conv.arg_type) {
+      fputc ('%', outP);
+      continue;
+    }
+    // rebuild the conversion with '*' replaced by the recorded value
+    spec_length = snprintf(spec, sizeof(spec), "%%%.*s", (int)conv.flags_length, conv.flags);
+    if ((1 == conv.width_length) && ('*' == conv.width[0])) {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%d", (int)*(const int64_t *)arg_p);
+      arg_p += 8;
+      arg_index++;
+    } else {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%.*s", (int)conv.width_length, conv.width);
+    }
+    if (conv.has_precision) {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, ".%.*s", (int)conv.precision_length, conv.precision);
+    }
+    snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%.*s", (int)conv.conversion_length, conv.conversion);
+
+    value = *(const uint64_t *)arg_p;
+    switch (g_formats[recordP->format_id].arg_type[arg_index]) {
+      case MSC_BIN_ARG_INT:       fprintf (outP, spec, (int)value); break;
+      case MSC_BIN_ARG_LONG:      fprintf (outP, spec, (long)value); break;
+      case MSC_BIN_ARG_LONG_LONG: fprintf (outP, spec, (long long)value); break;
+      case MSC_BIN_ARG_SIZE:      fprintf (outP, spec, (size_t)value); break;
+      case MSC_BIN_ARG_INTMAX:    fprintf (outP, spec, (intmax_t)value); break;
+      case MSC_BIN_ARG_PTRDIFF:   fprintf (outP, spec, (ptrdiff_t)value); break;
+      case MSC_BIN_ARG_DOUBLE:    fprintf (outP, spec, *(const double *)arg_p); break;
+      case MSC_BIN_ARG_POINTER:   fprintf (outP, spec, (void *)(uintptr_t)value); break;
+      case MSC_BIN_ARG_STRING:
+        if (MSC_BIN_STRING_NULL == value) {
+          fprintf (outP, spec, "(null)");
+        } else {
+          fprintf (outP, spec, (const char *)arg_p + 8);
+          arg_p += (value + 8) & ~7;
+        }
+        break;
+      default:;
+    }
+    arg_p += 8;
+    arg_index++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void msc_bin2txt_print_record(const msc_bin_record_hdr_t * const recordP, FILE * const outP)
+{
+  if (MSC_BIN_RECORD_EVENT == recordP->type) {
+    fprintf (outP, "%" PRIu64 " [EVENT] %d %04ld:%06ld",
+        recordP->message_number, recordP->proto1, (long)recordP->tv_sec, (long)recordP->tv_usec);
+  } else if (MSC_BIN_RECORD_MESSAGE == recordP->type) {
+    // the mac of the message bytes is not computed by msc.c either
+    fprintf (outP, "%" PRIu64 " [MESSAGE] %d %s %d %" PRIu64 " %04ld:%06ld",
+        recordP->message_number, recordP->proto1,
+        (recordP->operation < MSC_BIN_OP_NONE) ? msc_bin_operation2str[recordP->operation] : "->",
+        recordP->proto2, (uint64_t)0, (long)recordP->tv_sec, (long)recordP->tv_usec);
+  } else {
+    return;
+  }
+  msc_bin2txt_print_args(recordP, outP);
+  fputc ('\n', outP);
+}
+
+//------------------------------------------------------------------------------
+// Walk the chunks of the ring from the oldest one not overwritten by the chunk of the head, returns the number of records
+static uint64_t msc_bin2txt_print_ring(const msc_bin_file_hdr_t * const hdrP, const uint8_t * const mapP, FILE * const outP)
+{
+  const uint8_t              *ring = mapP + hdrP->ring_offset;
+  const msc_bin_record_hdr_t *record_p = NULL;
+  uint64_t                    head = hdrP->head;
+  uint64_t                    chunk = 0;
+  uint64_t                    position = 0;
+  uint64_t                    chunk_end = 0;
+  uint64_t                    num_records = 0;
+
+  if (head > hdrP->ring_size) {
+    chunk = (head - hdrP->ring_size + hdrP->chunk_size - 1) & ~((uint64_t)hdrP->chunk_size - 1);
+  }
+  for (; chunk < head; chunk += hdrP->chunk_size) {
+    chunk_end = chunk + hdrP->chunk_size;
+    position  = chunk;
+    while ((position < head) && ((position + sizeof(msc_bin_record_hdr_t)) <= chunk_end)) {
+      record_p = (const msc_bin_record_hdr_t *)&ring[position & (hdrP->ring_size - 1)];
+      // end of the records of this chunk, or record not completely written
+      if ((position != record_p->position) || (sizeof(msc_bin_record_hdr_t) > record_p->size) || ((position + record_p->size) > chunk_end)) {
+        break;
+      }
+      msc_bin2txt_print_record(record_p, outP);
+      num_records++;
+      position += record_p->size;
+    }
+  }
+  return num_records;
+}
+
+//------------------------------------------------------------------------------
+int
+main (
+  int argc,
+  char *argv[])
+{
+  const char                         *input = "/tmp/openair.msc.4.bin";
+  char                               *output = NULL;
+  FILE                               *out = NULL;
+  const msc_bin_file_hdr_t           *hdr = NULL;
+  uint8_t                            *map = NULL;
+  struct stat                         st;
+  uint64_t                            num_records = 0;
+  size_t                              length = 0;
+  int                                 fd = -1;
+  int                                 c = 0;
+  int                                 i = 0;
+
+  while ((c = getopt (argc, argv, "i:o:")) != -1) {
+    switch (c) {
+    case 'i':
+      input = optarg;
+      break;
+    case 'o':
+      output = optarg;
+      break;
+    default:
+      fprintf (stderr, "Usage: %s [-i /tmp/openair.msc.4.bin] [-o /tmp/openair.msc.4.log]\n", argv[0]);
+      return -1;
+    }
+  }
+  if (NULL == output) {
+    // same name with the .log extension of the text MSC files
+    length = strlen(input);
+    output = malloc(length + 5);
+    strcpy(output, input);
+    if ((length > 4) && (0 == strcmp(&output[length - 4], ".bin"))) {
+      output[length - 4] = '\0';
+    }
+    strcat(output, ".log");
+  }
+
+  fd = open (input, O_RDONLY);
+  if ((0 > fd) || (fstat (fd, &st))) {
+    fprintf (stderr, "Could not open %s : %s\n", input, strerror (errno));
+    return -1;
+  }
+  if (sizeof(msc_bin_file_hdr_t) > (size_t)st.st_size) {
+    fprintf (stderr, "%s is not a MSC binary file\n", input);
+    return -1;
+  }
+  map = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (MAP_FAILED == map) {
+    fprintf (stderr, "Could not map %s : %s\n", input, strerror (errno));
+    return -1;
+  }
+  hdr = (const msc_bin_file_hdr_t *)map;
+  if ((MSC_BIN_MAGIC != hdr->magic) || (MSC_BIN_VERSION != hdr->version) ||
+      ((uint64_t)hdr->ring_offset + hdr->ring_size > (uint64_t)st.st_size) ||
+      ((uint64_t)hdr->format_table_offset + hdr->format_table_size > (uint64_t)st.st_size) ||
+      (hdr->format_table_used > hdr->format_table_size) ||
+      (0 == hdr->chunk_size) || (hdr->ring_size & (hdr->ring_size - 1)) || (hdr->ring_size % hdr->chunk_size)) {
+    fprintf (stderr, "%s is not a MSC binary file of version %u\n", input, MSC_BIN_VERSION);
+    return -1;
+  }
+
+  out = (0 == strcmp(output, "-")) ? stdout : fopen (output, "w");
+  if (NULL == out) {
+    fprintf (stderr, "Could not open %s : %s\n", output, strerror (errno));
+    return -1;
+  }
+
+  for (i = MIN_MSC_PROTOS; i < MAX_MSC_PROTOS; i++) {
+    if (hdr->is_proto_declared[i]) {
+      fprintf (out, "%" PRIu64 " [PROTO] %d %.*s\n", hdr->proto_number[i], i, MSC_BIN_MAX_PROTO_NAME_LENGTH, &hdr->proto_name[i][0]);
+    }
+  }
+  msc_bin2txt_load_formats(hdr, map);
+  num_records = msc_bin2txt_print_ring(hdr, map, out);
+
+  if (stdout != out) {
+    fclose (out);
+  }
+  fprintf (stderr, "%" PRIu64 " records, %u formats, %" PRIu64 " bytes written since MSC start, %s\n", num_records, g_num_formats, hdr->head, output);
+  munmap (map, st.st_size);
+  close (fd);
+  return 0;
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+
+/*! \file bstr_pool.c
+   \brief Pools of bstrings of a fixed capacity, taken by a producer and given back by the last consumer of the data.
+*/
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+#include "dynamic_memory_check.h"
+#include "bstr_pool.h"
+
+#define BSTR_POOL_ITEM_ALIGN    (64)  /* cache line */
+
+struct bstr_pool_s {
+  uint8_t                    *items;          // items * stride bytes, an item is a struct tagbstring followed by its bytes
+  uint8_t                    *items_end;
+  uint32_t                    stride;
+  uint32_t                    capacity;
+  pthread_mutex_t             lock;           // protects the free items and the statistics
+  uint32_t                   *free_items;     // stack of the indexes of the free items, the last given back on top
+  uint32_t                    nb_free;
+  bstr_pool_stats_t           stats;
+};
+
+/* Written at the creation and the destruction of the pools, before and after the producers and consumers run */
+static bstr_pool_t             *g_bstr_pools[BSTR_POOL_MAX_POOLS] = {NULL};
+
+//------------------------------------------------------------------------------
+bstr_pool_t *bstr_pool_create (const uint32_t items, const uint32_t capacity)
+{
+  bstr_pool_t                            *pool = NULL;
+  int                                     slot = 0;
+
+  for (slot = 0; (slot < BSTR_POOL_MAX_POOLS) && (g_bstr_pools[slot]); slot++);
+  if ((BSTR_POOL_MAX_POOLS == slot) || (0 == items) || (0 == capacity)) {
+    return NULL;
+  }
+  pool = calloc (1, sizeof (*pool));
+  if (NULL == pool) {
+    return NULL;
+  }
+  pool->capacity = capacity;
+  pool->stride = (sizeof (struct tagbstring) + capacity + BSTR_POOL_ITEM_ALIGN - 1) & ~(BSTR_POOL_ITEM_ALIGN - 1);
+  // Large allocations are mapped: the pages of an item are backed when its bytes are written
+  if (posix_memalign ((void **)&pool->items, BSTR_POOL_ITEM_ALIGN, (size_t)items * pool->stride)) {
+    free_wrapper ((void**)&pool);
+    return NULL;
+  }
+  pool->items_end = pool->items + (size_t)items * pool->stride;
+  pool->free_items = calloc (items, sizeof (uint32_t));
+  if (NULL == pool->free_items) {
+    free_wrapper ((void**)&pool->items);
+    free_wrapper ((void**)&pool);
+    return NULL;
+  }
+  // item 0 on top, taken first
+  for (uint32_t i = 0; i < items; i++) {
+    pool->free_items[i] = items - 1 - i;
+  }
+  pool->nb_free = items;
+  pool->stats.items = items;
+  pthread_mutex_init (&pool->lock, NULL);
+  g_bstr_pools[slot] = pool;
+  return pool;
+}
+
+//------------------------------------------------------------------------------
+void bstr_pool_destroy (bstr_pool_t *pool)
+{
+  if (NULL == pool) {
+    return;
+  }
+  for (int slot = 0; slot < BSTR_POOL_MAX_POOLS; slot++) {
+    if (g_bstr_pools[slot] == pool) {
+      g_bstr_pools[slot] = NULL;
+    }
+  }
+  pthread_mutex_destroy (&pool->lock);
+  free_wrapper ((void**)&pool->free_items);
+  free_wrapper ((void**)&pool->items);
+  free_wrapper ((void**)&pool);
+}
+
+//------------------------------------------------------------------------------
+bstring bstr_pool_get (bstr_pool_t * const pool)
+{
+  struct tagbstring                      *b = NULL;
+
+  pthread_mutex_lock (&pool->lock);
+  if (0 == pool->nb_free) {
+    pool->stats.exhausted++;
+    pthread_mutex_unlock (&pool->lock);
+    return NULL;
+  }
+  b = (struct tagbstring *)(pool->items + (size_t)pool->free_items[--pool->nb_free] * pool->stride);
+  pool->stats.gets++;
+  pool->stats.used++;
+  if (pool->stats.used > pool->stats.peak_used) {
+    pool->stats.peak_used = pool->stats.used;
+  }
+  pthread_mutex_unlock (&pool->lock);
+  // write protected: bstrlib does not resize nor free it
+  b->mlen = -1;
+  b->slen = 0;
+  b->data = (unsigned char *)(b + 1);
+  return b;
+}
+
+//------------------------------------------------------------------------------
+uint32_t bstr_pool_capacity (const bstr_pool_t * const pool)
+{
+  return pool->capacity;
+}
+
+//------------------------------------------------------------------------------
+void bstr_pool_release (bstring *b)
+{
+  bstr_pool_t                            *pool = NULL;
+
+  if ((NULL == b) || (NULL == *b)) {
+    return;
+  }
+  for (int slot = 0; slot < BSTR_POOL_MAX_POOLS; slot++) {
+    pool = g_bstr_pools[slot];
+    if ((pool) && ((uint8_t *)*b >= pool->items) && ((uint8_t *)*b < pool->items_end)) {
+      pthread_mutex_lock (&pool->lock);
+      pool->free_items[pool->nb_free++] = (uint32_t)(((uint8_t *)*b - pool->items) / pool->stride);
+      pool->stats.used--;
+      pthread_mutex_unlock (&pool->lock);
+      *b = NULL;
+      return;
+    }
+  }
+  bdestroy (*b);
+  *b = NULL;
+}
+
+//------------------------------------------------------------------------------
+void bstr_pool_get_stats (bstr_pool_t * const pool, bstr_pool_stats_t * const stats)
+{
+  pthread_mutex_lock (&pool->lock);
+  *stats = pool->stats;
+  pthread_mutex_unlock (&pool->lock);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+
+/*! \file bstr_pool.h
+   \brief Pools of bstrings of a fixed capacity, taken by a producer and given back by the last consumer of the data.
+   The items of a pool are carved out of one allocation, its pages are only backed by memory once written. A bstring of
+   a pool is write protected: bdestroy() leaves it alone, bstr_pool_release() gives it back to its pool and destroys
+   any other bstring, so a consumer does not need to know where the bstring comes from.
+*/
+
+#ifndef FILE_BSTR_POOL_SEEN
+#define FILE_BSTR_POOL_SEEN
+
+#include <stdint.h>
+
+#include "bstrlib.h"
+
+#define BSTR_POOL_MAX_POOLS     (4)   /* pools of the process */
+
+typedef struct bstr_pool_s bstr_pool_t;
+
+typedef struct bstr_pool_stats_s {
+  uint32_t                    items;          // items of the pool
+  uint32_t                    used;           // items taken and not given back
+  uint32_t                    peak_used;      // high water mark of used
+  uint64_t                    gets;           // items taken
+  uint64_t                    exhausted;      // bstr_pool_get() that found no free item
+} bstr_pool_stats_t;
+
+/** \brief Create a pool of items bstrings of capacity bytes
+ * @returns NULL if the pool can not be allocated or BSTR_POOL_MAX_POOLS pools exist
+ **/
+bstr_pool_t *bstr_pool_create(const uint32_t items, const uint32_t capacity);
+
+/** \brief Destroy a pool, all its items must have been given back */
+void bstr_pool_destroy(bstr_pool_t *pool);
+
+/** \brief Take an empty bstring of the pool, its bytes can be written up to bstr_pool_capacity()
+ * @returns NULL if all the items are taken
+ **/
+bstring bstr_pool_get(bstr_pool_t * const pool);
+
+uint32_t bstr_pool_capacity(const bstr_pool_t * const pool);
+
+/** \brief Give back a bstring to its pool, or destroy it if it is not from a pool; *b is set to NULL */
+void bstr_pool_release(bstring *b);
+
+void bstr_pool_get_stats(bstr_pool_t * const pool, bstr_pool_stats_t * const stats);
+
+#endif /* FILE_BSTR_POOL_SEEN */
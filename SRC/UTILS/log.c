@@ -40,6 +40,7 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <inttypes.h>
+#include <time.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
@@ -47,22 +48,24 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <fcntl.h>
+#include <libconfig.h>
 
-#include "liblfds611.h"
 #include "intertask_interface.h"
 #include "timer.h"
-#include "hashtable.h"
 
 #include "log.h"
 #include "assertions.h"
 #include "dynamic_memory_check.h"
+#include "oai_clock.h"
 
 #if HAVE_CONFIG_H
 #  include "config.h"
 #endif
 
 //-------------------------------
-#define LOG_MAX_QUEUE_ELEMENTS                1024
+#define LOG_RING_MAX_ITEMS                    1024  /* power of 2, one ring per logging thread */
+#define LOG_FLUSH_MAX_ITEMS_PER_RING            64  /* per ring and per round of the log task */
+#define LOG_MESSAGE_MAX_REUSE_SIZE             512  /* bigger buffers are not kept for reuse */
 #define LOG_MAX_PROTO_NAME_LENGTH               16
 #define LOG_MESSAGE_MIN_ALLOC_SIZE             256
 
@@ -80,6 +83,17 @@
 #define LOG_ANSI_CODE_MAX_LENGTH                15
 #define LOG_MAX_SERVER_ADDRESS_LENGTH           96
 #define LOG_MAX_PORT_NUM_LENGTH                  6
+
+#define LOG_BIN_MAX_CALL_SITES                8192
+#define LOG_BIN_RING_SIZE                (1 << 18)  /* bytes, power of 2, one ring per logging thread */
+#define LOG_BIN_MAX_STRING_LENGTH              256
+#define LOG_BIN_MAX_SPEC_LENGTH                 48
+#define LOG_BIN_STRING_NULL             0xFFFFFFFF
+
+#define LOG_CALL_SITE_RULE_MAX_LOCATION_LENGTH 128
+
+#define LOG_RATE_LIMIT_DEFAULT_SUMMARY_PERIOD_SEC 10
+#define LOG_RATE_LIMIT_EXEMPT_LEVEL       OAILOG_LEVEL_CRITICAL  /* this level and more severe ones are never limited */
 //-------------------------------
 
 typedef unsigned long                   log_message_number_t;
@@ -93,6 +107,101 @@ typedef enum {
   MAX_LOG_TCP_STATE
 } log_tcp_state_t;
 
+/*! \enum  log_bin_arg_type_t
+* \brief C type of a raw argument recorded in a binary log record, deduced from the printf conversion.
+*/
+typedef enum {
+  LOG_BIN_ARG_INT = 0,
+  LOG_BIN_ARG_LONG,
+  LOG_BIN_ARG_LONG_LONG,
+  LOG_BIN_ARG_SIZE,
+  LOG_BIN_ARG_INTMAX,
+  LOG_BIN_ARG_PTRDIFF,
+  LOG_BIN_ARG_DOUBLE,
+  LOG_BIN_ARG_POINTER,
+  LOG_BIN_ARG_STRING,
+  LOG_BIN_ARG_NONE,         /* "%%" */
+  LOG_BIN_ARG_UNSUPPORTED
+} log_bin_arg_type_t;
+
+/*! \struct  log_bin_conversion_t
+* \brief One printf conversion specification split in its parts, so that '*' can be replaced by recorded values.
+*/
+typedef struct log_bin_conversion_s {
+  size_t              length;            /*!< \brief From '%' to the conversion character included */
+  const char         *flags;
+  size_t              flags_length;
+  const char         *width;             /*!< \brief Digits or "*" */
+  size_t              width_length;
+  const char         *precision;         /*!< \brief Digits or "*", after the '.' */
+  size_t              precision_length;
+  bool                has_precision;
+  const char         *conversion;        /*!< \brief Length modifier and conversion character */
+  size_t              conversion_length;
+  log_bin_arg_type_t  arg_type;
+} log_bin_conversion_t;
+
+/*! \struct  log_bin_record_hdr_t
+* \brief Header of a record in a binary log ring, followed by the raw arguments (8 bytes slots, strings are length + bytes).
+*/
+typedef struct log_bin_record_hdr_s {
+  uint32_t                                size;          /*!< \brief Whole record size, 8 bytes aligned, 0 means skip to the ring wrap */
+  uint32_t                                call_site_id;
+  uint8_t                                 log_level;
+  uint8_t                                 proto;
+  uint16_t                                indent;
+  uint32_t                                tv_sec;        /*!< \brief Elapsed time since log start */
+  uint32_t                                tv_usec;
+  uint32_t                                reserved;
+} log_bin_record_hdr_t;
+
+/*! \struct  log_bin_ring_t
+* \brief Single producer (the logging thread), single consumer (the log task) ring of binary log records.
+*/
+typedef struct log_bin_ring_s {
+  uint8_t                                *buffer;
+  uint64_t                                head;              /*!< \brief Written by the producer thread only */
+  uint64_t                                tail;              /*!< \brief Written by the log task only */
+  uint64_t                                dropped;           /*!< \brief Records lost because the ring was full */
+  uint64_t                                reported_dropped;  /*!< \brief Already reported by the log task */
+} log_bin_ring_t;
+
+/*! \struct  log_ring_t
+* \brief Single producer (the logging thread), single consumer (the log task) ring of formatted messages.
+* Slots are owned by the producer in [tail + LOG_RING_MAX_ITEMS, head[ and by the log task in [tail, head[,
+* the bstring of a slot is allocated on first use and reused, no other synchronization than head and tail.
+*/
+typedef struct log_ring_s {
+  uint64_t                                head;              /*!< \brief Written by the producer thread only */
+  uint64_t                                tail;              /*!< \brief Written by the log task only */
+  uint64_t                                dropped;           /*!< \brief Messages lost because the ring was full */
+  uint64_t                                reported_dropped;  /*!< \brief Already reported by the log task */
+  log_queue_item_t                        items[LOG_RING_MAX_ITEMS];
+} log_ring_t;
+
+
+/*! \struct  log_site_rule_t
+* \brief Parsed log_call_site_rule_t.
+*/
+typedef struct log_site_rule_s {
+  char                                    source_file[LOG_CALL_SITE_RULE_MAX_LOCATION_LENGTH]; /*!< \brief Path suffix */
+  unsigned int                            line_num;          /*!< \brief 0 means any line */
+  bool                                    is_enabled;
+} log_site_rule_t;
+
+/*! \struct  log_rate_limit_t
+* \brief Rate limits of a protocol, token buckets are implemented as GCRA (one atomic timestamp per bucket).
+*/
+typedef struct log_rate_limit_s {
+  bool                                    is_active;
+  uint64_t                                interval_ns;       /*!< \brief Protocol bucket, 0 means no limit */
+  uint64_t                                tolerance_ns;      /*!< \brief (burst - 1) * interval_ns */
+  uint64_t                                call_site_interval_ns;
+  uint64_t                                call_site_tolerance_ns;
+  uint32_t                                sampling;          /*!< \brief 0 or 1 means no sampling */
+  uint64_t                                tat_ns;            /*!< \brief Theoretical arrival time of the protocol bucket */
+  uint32_t                                suppressed_rate;   /*!< \brief Dropped by the protocol bucket since last summary */
+} log_rate_limit_t;
 
 /*! \struct  oai_log_t
 * \brief Structure containing all the logging utility internal variables.
@@ -112,18 +221,39 @@ typedef struct oai_log_s {
   int                                     log_start_time_second;                                       /*!< \brief Logging utility reference time              */
   log_level_t                             log_level[MAX_LOG_PROTOS];                                   /*!< \brief Loglevel id of each client (protocol/layer) */
 
-  log_message_number_t                    log_message_number;                                          /*!< \brief Counter of log message        */
-  struct lfds611_queue_state             *log_message_queue_p;                                         /*!< \brief Thread safe log message queue */
-  struct lfds611_stack_state             *log_free_message_queue_p;                                          /*!< \brief Thread safe memory pool       */
+  log_message_number_t                    log_message_number;                                          /*!< \brief Counter of log message, written by the log task only in thread safe mode */
+
+  pthread_mutex_t                         thread_ctxt_mutex;                                           /*!< \brief Protects thread context registration and call site registration */
+  log_thread_ctxt_t                      *thread_ctxts;                                                /*!< \brief List of thread contexts, each one owns its rings */
+
+  bool                                    is_output_binary;                                            /*!< \brief Deferred formatting of log messages in log task */
+  uint32_t                                num_call_sites;                                              /*!< \brief Registered call sites, id 0 is unused */
+  log_call_site_t                        *call_sites[LOG_BIN_MAX_CALL_SITES];                          /*!< \brief Call site table, indexed by call site id */
+  bstring                                 bin_bstr;                                                    /*!< \brief Formatting buffer of the log task */
 
-  hash_table_ts_t                           *thread_context_htbl;                                         /*!< \brief Container for log_thread_ctxt_t */
+  log_call_site_t                        *hit_call_sites;                                              /*!< \brief Call sites hit at least once, protected by thread_ctxt_mutex */
+  int                                     num_site_rules;
+  log_site_rule_t                         site_rules[LOG_MAX_CALL_SITE_RULES];                         /*!< \brief Overrides of the log level filter, last match wins */
+
+  bool                                    is_rate_limit_active;                                        /*!< \brief At least one protocol has rate limits or sampling */
+  log_rate_limit_t                        rate_limit[MAX_LOG_PROTOS];
+  uint64_t                                summary_period_ns;                                           /*!< \brief Period of the summary of suppressed messages */
+  uint64_t                                next_summary_ns;
 } oai_log_t;
 
 static oai_log_t g_oai_log={0};    /*!< \brief  logging utility internal variables global var definition*/
 
-inline static void log_reuse_item(log_queue_item_t * item_p) __attribute__((always_inline));
-static log_queue_item_t * new_queue_item(void);
+static __thread log_thread_ctxt_t *log_thread_ctxt_p = NULL;  /*!< \brief Context of the calling thread, created on first use */
 
+static log_queue_item_t * new_queue_item(void);
+static log_thread_ctxt_t * log_new_thread_ctxt(void);
+static void log_message_int(log_thread_ctxt_t * thread_ctxtP, const log_level_t log_levelP, const log_proto_t protoP,
+    const char *const source_fileP, const unsigned int line_numP, char *format, va_list args);
+static int log_bin_flush_ring(log_thread_ctxt_t * const thread_ctxtP, const int max_recordsP);
+static void log_call_site_invalidate_all(void);
+static void log_rate_limit_summary(void);
+static void log_message_unfiltered(log_thread_ctxt_t * thread_ctxtP, const log_level_t log_levelP, const log_proto_t protoP,
+    const char *const source_fileP, const unsigned int line_numP, char *format, ...) __attribute__ ((format (printf, 6, 7)));
 
 //------------------------------------------------------------------------------
 int log_get_start_time_sec (void)
@@ -132,39 +262,69 @@ int log_get_start_time_sec (void)
 }
 
 //------------------------------------------------------------------------------
-static void log_reuse_item(log_queue_item_t * item_p)
+static log_queue_item_t * new_queue_item(void)
 {
-  int         rv = 0;
-#if LOG_OAI_CLEAN_HARD
-  if (item_p->bstr) {
-    bdestroy(item_p->bstr);
-  }
-  memset((void*)item_p, 0, sizeof(* item_p));
+  log_queue_item_t * item_p = calloc(1, sizeof(log_queue_item_t));
+  AssertFatal((item_p), "Allocation of log container failed");
   item_p->bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
-#else
-  if (item_p->bstr) {
-    if (512 < item_p->bstr->mlen) {
-      bdestroy(item_p->bstr);
-      item_p->bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
-    }
-  }
-#endif
-  rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, item_p);
-  if (0 == rv) {
-    free_wrapper ((void**) &item_p);
+  AssertFatal((item_p->bstr), "Allocation of buf in log container failed");
+  return item_p;
+}
+
+//------------------------------------------------------------------------------
+static inline log_thread_ctxt_t * log_get_thread_ctxt(void)
+{
+  if (NULL == log_thread_ctxt_p) {
+    return log_new_thread_ctxt();
   }
+  return log_thread_ctxt_p;
 }
 
 //------------------------------------------------------------------------------
-static log_queue_item_t * new_queue_item(void)
+static log_thread_ctxt_t * log_new_thread_ctxt(void)
 {
-  log_queue_item_t * item_p = calloc(1, sizeof(log_queue_item_t));
-  AssertFatal((item_p), "Allocation of log container failed");
-  item_p->bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
-  AssertFatal((item_p->bstr), "Allocation of buf in log container failed");
+  log_thread_ctxt_t *thread_ctxt = calloc(1, sizeof(log_thread_ctxt_t));
+  AssertFatal(NULL != thread_ctxt, "Error Could not create log thread context\n");
+  thread_ctxt->tid  = pthread_self();
+  thread_ctxt->ring = calloc(1, sizeof(log_ring_t));
+  AssertFatal(NULL != thread_ctxt->ring, "Error Could not create log thread ring\n");
+
+  // contexts are never freed, the log task may still have messages to flush after the thread exited
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  thread_ctxt->next = g_oai_log.thread_ctxts;
+  __atomic_store_n (&g_oai_log.thread_ctxts, thread_ctxt, __ATOMIC_RELEASE);
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+  log_thread_ctxt_p = thread_ctxt;
+  return thread_ctxt;
+}
+
+//------------------------------------------------------------------------------
+// Returns the free slot at head of the ring of the calling thread, NULL if the ring is full
+static log_queue_item_t * log_ring_reserve(log_thread_ctxt_t * const thread_ctxtP)
+{
+  log_ring_t       *ring_p = thread_ctxtP->ring;
+  log_queue_item_t *item_p = NULL;
+
+  if ((ring_p->head - __atomic_load_n (&ring_p->tail, __ATOMIC_ACQUIRE)) >= LOG_RING_MAX_ITEMS) {
+    ring_p->dropped++;
+    return NULL;
+  }
+  item_p = &ring_p->items[ring_p->head & (LOG_RING_MAX_ITEMS - 1)];
+  if (NULL == item_p->bstr) {
+    item_p->bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
+    AssertFatal((item_p->bstr), "Allocation of buf in log container failed");
+  } else {
+    btrunc(item_p->bstr, 0);
+  }
   return item_p;
 }
 
+//------------------------------------------------------------------------------
+static inline void log_ring_commit(log_thread_ctxt_t * const thread_ctxtP)
+{
+  __atomic_store_n (&thread_ctxtP->ring->head, thread_ctxtP->ring->head + 1, __ATOMIC_RELEASE);
+}
+
 //------------------------------------------------------------------------------
 void* log_task (__attribute__ ((unused)) void *args_p)
 {
@@ -285,9 +445,93 @@ void log_connect_to_server(void)
    g_oai_log.tcp_state = LOG_TCP_STATE_CONNECTED;
 }
 
+//------------------------------------------------------------------------------
+static void log_set_rate_limit(log_rate_limit_t * const rate_limitP, const log_rate_limit_config_t * const configP)
+{
+  rate_limitP->interval_ns            = (configP->messages_per_sec) ? (1000000000 / configP->messages_per_sec) : 0;
+  rate_limitP->tolerance_ns           = (configP->burst > 1) ? (uint64_t)(configP->burst - 1) * rate_limitP->interval_ns : 0;
+  rate_limitP->call_site_interval_ns  = (configP->call_site_messages_per_sec) ? (1000000000 / configP->call_site_messages_per_sec) : 0;
+  rate_limitP->call_site_tolerance_ns = (configP->call_site_burst > 1) ? (uint64_t)(configP->call_site_burst - 1) * rate_limitP->call_site_interval_ns : 0;
+  rate_limitP->sampling               = configP->sampling;
+  rate_limitP->is_active              = (configP->messages_per_sec) || (configP->call_site_messages_per_sec) || (configP->sampling > 1);
+}
+
+//------------------------------------------------------------------------------
+// Parse the call site rules, the rate limits and the summary period of a LOGGING section of the MME or SP-GW configuration
+void log_config_parse(const config_setting_t * const settingP, log_config_t * const configP)
+{
+  config_setting_t                       *subsetting = NULL;
+  config_setting_t                       *sub2setting = NULL;
+  const char                             *astring = NULL;
+  int                                     aint = 0;
+  int                                     num = 0;
+  int                                     i = 0;
+
+  // the CALL_SITES_ENABLED and CALL_SITES_DISABLED lists are applied in file order, the last matching entry wins
+  for (int member = 0; member < config_setting_length (settingP); member++) {
+    const char                             *name = NULL;
+    bool                                    is_enabled = false;
+
+    subsetting = config_setting_get_elem (settingP, member);
+    name = config_setting_name (subsetting);
+    if (name == NULL) {
+      continue;
+    } else if (0 == strcmp (name, LOG_CONFIG_STRING_CALL_SITES_ENABLED)) {
+      is_enabled = true;
+    } else if (0 != strcmp (name, LOG_CONFIG_STRING_CALL_SITES_DISABLED)) {
+      continue;
+    }
+    num = config_setting_length (subsetting);
+    for (i = 0; (i < num) && (configP->num_call_site_rules < LOG_MAX_CALL_SITE_RULES); i++) {
+      astring = config_setting_get_string_elem (subsetting, i);
+      if (astring != NULL) {
+        configP->call_site_rule[configP->num_call_site_rules].location   = bfromcstr(astring);
+        configP->call_site_rule[configP->num_call_site_rules++].is_enabled = is_enabled;
+      }
+    }
+  }
+
+  subsetting = config_setting_get_member (settingP, LOG_CONFIG_STRING_RATE_LIMITS);
+  if (subsetting != NULL) {
+    num = config_setting_length (subsetting);
+    for (i = 0; i < num; i++) {
+      log_rate_limit_config_t rate_limit = {0};
+      int                     proto = 0;
+
+      sub2setting = config_setting_get_elem (subsetting, i);
+      if (!config_setting_lookup_string (sub2setting, LOG_CONFIG_STRING_PROTOCOL, &astring)) {
+        continue;
+      }
+      if ((config_setting_lookup_int (sub2setting, LOG_CONFIG_STRING_MESSAGES_PER_SEC, &aint)) && (0 < aint))
+        rate_limit.messages_per_sec = aint;
+      if ((config_setting_lookup_int (sub2setting, LOG_CONFIG_STRING_BURST, &aint)) && (0 < aint))
+        rate_limit.burst = aint;
+      if ((config_setting_lookup_int (sub2setting, LOG_CONFIG_STRING_CALL_SITE_MESSAGES_PER_SEC, &aint)) && (0 < aint))
+        rate_limit.call_site_messages_per_sec = aint;
+      if ((config_setting_lookup_int (sub2setting, LOG_CONFIG_STRING_CALL_SITE_BURST, &aint)) && (0 < aint))
+        rate_limit.call_site_burst = aint;
+      if ((config_setting_lookup_int (sub2setting, LOG_CONFIG_STRING_SAMPLING, &aint)) && (0 < aint))
+        rate_limit.sampling = aint;
+
+      if (0 == strcasecmp (astring, LOG_CONFIG_STRING_ALL_PROTOCOLS)) {
+        for (proto = MIN_LOG_PROTOS; proto < MAX_LOG_PROTOS; proto++) {
+          configP->rate_limit[proto] = rate_limit;
+        }
+      } else if (MAX_LOG_PROTOS != (proto = log_proto_str2int (astring))) {
+        configP->rate_limit[proto] = rate_limit;
+      }
+    }
+  }
+
+  if ((config_setting_lookup_int (settingP, LOG_CONFIG_STRING_SUPPRESSED_SUMMARY_PERIOD, &aint)) && (0 < aint))
+    configP->suppressed_summary_period_sec = aint;
+}
+
 //------------------------------------------------------------------------------
 void log_set_config(const log_config_t * const config)
 {
+  int                                     i = 0;
+
   if (config) {
     if ((MAX_LOG_LEVEL > config->udp_log_level) && (MIN_LOG_LEVEL <= config->udp_log_level))         g_oai_log.log_level[LOG_UDP] = config->udp_log_level;
     if ((MAX_LOG_LEVEL > config->gtpv1u_log_level) && (MIN_LOG_LEVEL <= config->gtpv1u_log_level))   g_oai_log.log_level[LOG_GTPV1U]   = config->gtpv1u_log_level;
@@ -307,7 +551,28 @@ void log_set_config(const log_config_t * const config)
     if ((MAX_LOG_LEVEL > config->msc_log_level) && (MIN_LOG_LEVEL <= config->msc_log_level))           g_oai_log.log_level[LOG_MSC]      = config->msc_log_level;
     if ((MAX_LOG_LEVEL > config->itti_log_level) && (MIN_LOG_LEVEL <= config->itti_log_level))         g_oai_log.log_level[LOG_ITTI]     = config->itti_log_level;
 
+    for (i = 0; i < config->num_call_site_rules; i++) {
+      if (config->call_site_rule[i].location) {
+        log_call_site_set_rule (bdata(config->call_site_rule[i].location), config->call_site_rule[i].is_enabled);
+      }
+    }
+    // log levels may have changed
+    log_call_site_invalidate_all();
+
+    g_oai_log.is_rate_limit_active = false;
+    for (i = MIN_LOG_PROTOS; i < MAX_LOG_PROTOS; i++) {
+      log_set_rate_limit (&g_oai_log.rate_limit[i], &config->rate_limit[i]);
+      g_oai_log.is_rate_limit_active |= g_oai_log.rate_limit[i].is_active;
+    }
+    // like NAS_LOG_LEVEL
+    if (!g_oai_log.rate_limit[LOG_NAS_EMM].is_active) log_set_rate_limit (&g_oai_log.rate_limit[LOG_NAS_EMM], &config->rate_limit[LOG_NAS]);
+    if (!g_oai_log.rate_limit[LOG_NAS_ESM].is_active) log_set_rate_limit (&g_oai_log.rate_limit[LOG_NAS_ESM], &config->rate_limit[LOG_NAS]);
+    g_oai_log.summary_period_ns = (uint64_t)((config->suppressed_summary_period_sec) ?
+        config->suppressed_summary_period_sec : LOG_RATE_LIMIT_DEFAULT_SUMMARY_PERIOD_SEC) * 1000000000;
+
     g_oai_log.is_output_fd_buffered = config->is_output_thread_safe;
+    // records are formatted by the log task, so only available with the thread safe output
+    g_oai_log.is_output_binary = (config->is_output_binary) && (config->is_output_thread_safe);
 
     if (config->output) {
       if (1 != biseqcstrcaseless(config->output, LOG_CONFIG_STRING_OUTPUT_CONSOLE)) {
@@ -357,6 +622,120 @@ void log_set_config(const log_config_t * const config)
   }
 }
 
+//------------------------------------------------------------------------------
+// Force all call sites to evaluate again their filters on their next hit
+static void log_call_site_invalidate_all(void)
+{
+  log_call_site_t                        *call_site = NULL;
+
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  for (call_site = g_oai_log.hit_call_sites; call_site; call_site = call_site->next) {
+    __atomic_store_n (&call_site->state, LOG_CALL_SITE_STATE_UNKNOWN, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+}
+
+//------------------------------------------------------------------------------
+// Slow path of log_call_site_is_enabled(), on the first hit of a call site and after a filter change
+bool log_call_site_refresh (
+  log_call_site_t * const call_siteP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP)
+{
+  bool                                    is_enabled = false;
+  size_t                                  file_length = 0;
+  size_t                                  rule_length = 0;
+  const log_site_rule_t                  *rule = NULL;
+  int                                     i = 0;
+
+  if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
+    return false;
+  }
+  if ((MIN_LOG_LEVEL > log_levelP) || (MAX_LOG_LEVEL <= log_levelP)) {
+    return false;
+  }
+
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  if (!call_siteP->is_listed) {
+    call_siteP->next = g_oai_log.hit_call_sites;
+    g_oai_log.hit_call_sites = call_siteP;
+    call_siteP->is_listed = true;
+  }
+  is_enabled = (log_levelP <= g_oai_log.log_level[protoP]);
+
+  file_length = strlen (call_siteP->source_file);
+  for (i = 0; i < g_oai_log.num_site_rules; i++) {
+    rule = &g_oai_log.site_rules[i];
+    if ((rule->line_num) && (rule->line_num != call_siteP->line_num)) {
+      continue;
+    }
+    rule_length = strlen (rule->source_file);
+    if ((rule_length > file_length) || (strcmp (&call_siteP->source_file[file_length - rule_length], rule->source_file))) {
+      continue;
+    }
+    // "mme_app.c" must not match "xmme_app.c"
+    if ((rule_length < file_length) && ('/' != call_siteP->source_file[file_length - rule_length - 1])) {
+      continue;
+    }
+    is_enabled = rule->is_enabled;
+  }
+  __atomic_store_n (&call_siteP->state, (is_enabled) ? LOG_CALL_SITE_STATE_ENABLED : LOG_CALL_SITE_STATE_DISABLED, __ATOMIC_RELAXED);
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+  return is_enabled;
+}
+
+//------------------------------------------------------------------------------
+// Enable or disable the call sites at "source file[:line]" whatever the log level of their protocol, can be called at any time.
+// Returns 0 on success, -1 if the location is invalid or too many rules.
+int log_call_site_set_rule (const char * const locationP, const bool is_enabledP)
+{
+  log_site_rule_t                         rule = {.source_file = {0}, .line_num = 0, .is_enabled = is_enabledP};
+  const char                             *colon = NULL;
+  size_t                                  length = 0;
+  int                                     i = 0;
+
+  if ((NULL == locationP) || (0 == locationP[0])) {
+    return -1;
+  }
+  colon = strrchr (locationP, ':');
+  length = (colon) ? (size_t)(colon - locationP) : strlen (locationP);
+  if ((0 == length) || (LOG_CALL_SITE_RULE_MAX_LOCATION_LENGTH <= length)) {
+    return -1;
+  }
+  memcpy (rule.source_file, locationP, length);
+  if (colon) {
+    rule.line_num = strtoul (colon + 1, NULL, 10);
+  }
+
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  // same location: replace the rule
+  for (i = 0; i < g_oai_log.num_site_rules; i++) {
+    if ((rule.line_num == g_oai_log.site_rules[i].line_num) && (0 == strcmp (rule.source_file, g_oai_log.site_rules[i].source_file))) {
+      break;
+    }
+  }
+  if (LOG_MAX_CALL_SITE_RULES <= i) {
+    pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+    return -1;
+  }
+  g_oai_log.site_rules[i] = rule;
+  if (i == g_oai_log.num_site_rules) {
+    g_oai_log.num_site_rules++;
+  }
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+  log_call_site_invalidate_all();
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void log_call_site_clear_rules (void)
+{
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  g_oai_log.num_site_rules = 0;
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+  log_call_site_invalidate_all();
+}
+
 //------------------------------------------------------------------------------
 const char * log_level_int2str(const log_level_t log_level)
 {
@@ -382,11 +761,116 @@ log_level_t log_level_str2int(const char * const log_level_str)
   return MAX_LOG_LEVEL; // == invalid
 }
 
+//------------------------------------------------------------------------------
+log_proto_t log_proto_str2int(const char * const log_proto_str)
+{
+  int log_proto;
+
+  if (log_proto_str) {
+    for (log_proto = MIN_LOG_PROTOS; log_proto < MAX_LOG_PROTOS; log_proto++) {
+      if (0 == strcasecmp(log_proto_str, &g_oai_log.log_proto2str[log_proto][0])) {
+        return log_proto;
+      }
+    }
+  }
+  // By default
+  return MAX_LOG_PROTOS; // == invalid
+}
+
+//------------------------------------------------------------------------------
+static inline uint64_t log_get_monotonic_ns(void)
+{
+  return oai_clock_coarse_ns ();
+}
+
+//------------------------------------------------------------------------------
+// Generic cell rate algorithm, equivalent to a token bucket of (tolerance / interval + 1) tokens refilled every interval
+static bool log_gcra_conforms(uint64_t * const tatP, const uint64_t now_ns, const uint64_t interval_ns, const uint64_t tolerance_ns)
+{
+  uint64_t                                tat = __atomic_load_n (tatP, __ATOMIC_RELAXED);
+  uint64_t                                new_tat = 0;
+
+  do {
+    if (tat > now_ns + tolerance_ns) {
+      return false;
+    }
+    new_tat = ((tat > now_ns) ? tat : now_ns) + interval_ns;
+  } while (!__atomic_compare_exchange_n (tatP, &tat, new_tat, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Sampling, then call site bucket, then protocol bucket. Returns false if the message has to be dropped.
+static bool log_rate_limit_conforms(log_call_site_t * const call_siteP, const log_level_t log_levelP, const log_proto_t protoP)
+{
+  log_rate_limit_t                       *rate_limit = &g_oai_log.rate_limit[protoP];
+  uint64_t                                now_ns = 0;
+
+  if ((!rate_limit->is_active) || (LOG_RATE_LIMIT_EXEMPT_LEVEL >= log_levelP)) {
+    return true;
+  }
+  if ((rate_limit->sampling > 1) && (__atomic_fetch_add (&call_siteP->num_hits, 1, __ATOMIC_RELAXED) % rate_limit->sampling)) {
+    __atomic_fetch_add (&call_siteP->suppressed_sampling, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  if ((rate_limit->call_site_interval_ns) || (rate_limit->interval_ns)) {
+    now_ns = log_get_monotonic_ns();
+    if ((rate_limit->call_site_interval_ns) &&
+        (!log_gcra_conforms (&call_siteP->tat_ns, now_ns, rate_limit->call_site_interval_ns, rate_limit->call_site_tolerance_ns))) {
+      __atomic_fetch_add (&call_siteP->suppressed_rate, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+    if ((rate_limit->interval_ns) &&
+        (!log_gcra_conforms (&rate_limit->tat_ns, now_ns, rate_limit->interval_ns, rate_limit->tolerance_ns))) {
+      __atomic_fetch_add (&rate_limit->suppressed_rate, 1, __ATOMIC_RELAXED);
+      return false;
+    }
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Log the counts of suppressed messages, at most once per summary period, by the log task or by the thread dropping a message
+static void log_rate_limit_summary(void)
+{
+  log_call_site_t                        *call_site = NULL;
+  uint64_t                                now_ns = log_get_monotonic_ns();
+  uint64_t                                next_ns = __atomic_load_n (&g_oai_log.next_summary_ns, __ATOMIC_RELAXED);
+  uint32_t                                suppressed_rate = 0;
+  uint32_t                                suppressed_sampling = 0;
+  log_thread_ctxt_t                      *thread_ctxt = NULL;
+  int                                     i = 0;
+
+  if ((now_ns < next_ns) ||
+      (!__atomic_compare_exchange_n (&g_oai_log.next_summary_ns, &next_ns, now_ns + g_oai_log.summary_period_ns, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))) {
+    return;
+  }
+  // may lock thread_ctxt_mutex, so before walking the call sites
+  thread_ctxt = log_get_thread_ctxt();
+
+  for (i = MIN_LOG_PROTOS; i < MAX_LOG_PROTOS; i++) {
+    suppressed_rate = __atomic_exchange_n (&g_oai_log.rate_limit[i].suppressed_rate, 0, __ATOMIC_RELAXED);
+    if (suppressed_rate) {
+      log_message_unfiltered (thread_ctxt, OAILOG_LEVEL_WARNING, LOG_UTIL, __FILE__, __LINE__,
+          "Suppressed %u %s messages (protocol rate limit)\n", suppressed_rate, &g_oai_log.log_proto2str[i][0]);
+    }
+  }
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  for (call_site = g_oai_log.hit_call_sites; call_site; call_site = call_site->next) {
+    suppressed_rate     = __atomic_exchange_n (&call_site->suppressed_rate, 0, __ATOMIC_RELAXED);
+    suppressed_sampling = __atomic_exchange_n (&call_site->suppressed_sampling, 0, __ATOMIC_RELAXED);
+    if ((suppressed_rate) || (suppressed_sampling)) {
+      log_message_unfiltered (thread_ctxt, OAILOG_LEVEL_WARNING, LOG_UTIL, call_site->source_file, call_site->line_num,
+          "Suppressed %u messages (call site rate limit) %u messages (sampling)\n", suppressed_rate, suppressed_sampling);
+    }
+  }
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+}
+
 //------------------------------------------------------------------------------
 static void log_get_elapsed_time_since_start(struct timeval * const elapsed_time)
 {
-  // no thread safe but do not matter a lot
-  gettimeofday(elapsed_time, NULL);
+  oai_clock_coarse_realtime(elapsed_time);
   // no timersub call for fastest operations
   elapsed_time->tv_sec = elapsed_time->tv_sec - g_oai_log.log_start_time_second;
 }
@@ -406,83 +890,54 @@ int
 log_init (
   __attribute__ ((unused))const log_env_t envP,
   const log_level_t default_log_levelP,
-  const int max_threadsP)
+  __attribute__ ((unused))const int max_threadsP)
 {
   int                                     i = 0;
-  int                                     rv = 0;
-  log_queue_item_t                       *item_p = NULL;
   struct timeval                          start_time = {.tv_sec=0, .tv_usec=0};
 
   signal(SIGPIPE, log_signal_callback_handler);
 
   g_oai_log.log_fd = NULL;
 
-  rv = gettimeofday(&start_time, NULL);
+  // same clock as the time stamps of the log lines
+  oai_clock_coarse_realtime(&start_time);
   g_oai_log.log_start_time_second = start_time.tv_sec;
 
 
   OAI_FPRINTF_INFO("Initializing OAI Logging\n");
 
-  bstring b = bfromcstr("Logging thread context hashtable");
-  g_oai_log.thread_context_htbl = hashtable_ts_create (LOG_MESSAGE_MIN_ALLOC_SIZE, NULL, free_wrapper, b);
-  bdestroy(b);
-  AssertFatal (NULL != g_oai_log.thread_context_htbl, "Could not create hashtable for Log!\n");
-  g_oai_log.thread_context_htbl->log_enabled = false;
-
-
-  log_thread_ctxt_t *thread_ctxt = calloc(1, sizeof(log_thread_ctxt_t));
-  AssertFatal(NULL != thread_ctxt, "Error Could not create log thread context\n");
-  pthread_t p = pthread_self();
-  thread_ctxt->tid = p;
-  hashtable_rc_t hash_rc = hashtable_ts_insert(g_oai_log.thread_context_htbl, (hash_key_t) p, thread_ctxt);
-  if (HASH_TABLE_OK != hash_rc) {
-    OAI_FPRINTF_ERR("Error Could not register log thread context\n");
-    free_wrapper((void**) &thread_ctxt);
-  }
-
-  rv = lfds611_stack_new (&g_oai_log.log_free_message_queue_p, (lfds611_atom_t) max_threadsP + 2);
-
-  if (0 >= rv) {
-    AssertFatal (0, "lfds611_stack_new failed!\n");
-  }
-
-  rv = lfds611_queue_new (&g_oai_log.log_message_queue_p, (lfds611_atom_t) LOG_MAX_QUEUE_ELEMENTS);
-  AssertFatal (rv, "lfds611_queue_new failed!\n");
-  AssertFatal (g_oai_log.log_message_queue_p != NULL, "g_oai_log.log_message_queue_p is NULL!\n");
-  log_start_use ();
-
-  for (i = 0; i < max_threadsP * 30; i++) {
-    item_p = new_queue_item();
-    rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, item_p);
-    AssertFatal (rv, "lfds611_stack_guaranteed_push failed for item %u\n", i);
-  }
-
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_SCTP][0], LOG_MAX_PROTO_NAME_LENGTH, "SCTP");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_UDP][0], LOG_MAX_PROTO_NAME_LENGTH, "UDP");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_GTPV1U][0], LOG_MAX_PROTO_NAME_LENGTH, "GTPv1-U");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_GTPV2C][0], LOG_MAX_PROTO_NAME_LENGTH, "GTPv2-C");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_S1AP][0], LOG_MAX_PROTO_NAME_LENGTH, "S1AP");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_MME_APP][0], LOG_MAX_PROTO_NAME_LENGTH, "MME-APP");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_NAS][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_NAS_EMM][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS-EMM");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_NAS_ESM][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS-ESM");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_SPGW_APP][0], LOG_MAX_PROTO_NAME_LENGTH, "SPGW-APP");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_S11][0], LOG_MAX_PROTO_NAME_LENGTH, "S11");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_S6A][0], LOG_MAX_PROTO_NAME_LENGTH, "S6A");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_UTIL][0], LOG_MAX_PROTO_NAME_LENGTH, "UTIL");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_CONFIG][0], LOG_MAX_PROTO_NAME_LENGTH, "CONFIG");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_MSC][0], LOG_MAX_PROTO_NAME_LENGTH, "MSC");
-  rv = snprintf (&g_oai_log.log_proto2str[LOG_ITTI][0], LOG_MAX_PROTO_NAME_LENGTH, "ITTI");
-
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_TRACE][0], LOG_LEVEL_NAME_MAX_LENGTH, "TRACE");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_DEBUG][0], LOG_LEVEL_NAME_MAX_LENGTH, "DEBUG");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_INFO][0], LOG_LEVEL_NAME_MAX_LENGTH, "INFO");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_NOTICE][0], LOG_LEVEL_NAME_MAX_LENGTH, "NOTICE");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_WARNING][0], LOG_LEVEL_NAME_MAX_LENGTH, "WARNING");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_ERROR][0], LOG_LEVEL_NAME_MAX_LENGTH, "ERROR");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_CRITICAL][0], LOG_LEVEL_NAME_MAX_LENGTH, "CRITICAL");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_ALERT][0], LOG_LEVEL_NAME_MAX_LENGTH, "ALERT");
-  rv = snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_EMERGENCY][0], LOG_LEVEL_NAME_MAX_LENGTH, "EMERGENCY");
+  pthread_mutex_init (&g_oai_log.thread_ctxt_mutex, NULL);
+  g_oai_log.num_call_sites = 1;
+  g_oai_log.bin_bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
+
+  log_thread_ctxt_t *thread_ctxt = log_get_thread_ctxt();
+
+  snprintf (&g_oai_log.log_proto2str[LOG_SCTP][0], LOG_MAX_PROTO_NAME_LENGTH, "SCTP");
+  snprintf (&g_oai_log.log_proto2str[LOG_UDP][0], LOG_MAX_PROTO_NAME_LENGTH, "UDP");
+  snprintf (&g_oai_log.log_proto2str[LOG_GTPV1U][0], LOG_MAX_PROTO_NAME_LENGTH, "GTPv1-U");
+  snprintf (&g_oai_log.log_proto2str[LOG_GTPV2C][0], LOG_MAX_PROTO_NAME_LENGTH, "GTPv2-C");
+  snprintf (&g_oai_log.log_proto2str[LOG_S1AP][0], LOG_MAX_PROTO_NAME_LENGTH, "S1AP");
+  snprintf (&g_oai_log.log_proto2str[LOG_MME_APP][0], LOG_MAX_PROTO_NAME_LENGTH, "MME-APP");
+  snprintf (&g_oai_log.log_proto2str[LOG_NAS][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS");
+  snprintf (&g_oai_log.log_proto2str[LOG_NAS_EMM][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS-EMM");
+  snprintf (&g_oai_log.log_proto2str[LOG_NAS_ESM][0], LOG_MAX_PROTO_NAME_LENGTH, "NAS-ESM");
+  snprintf (&g_oai_log.log_proto2str[LOG_SPGW_APP][0], LOG_MAX_PROTO_NAME_LENGTH, "SPGW-APP");
+  snprintf (&g_oai_log.log_proto2str[LOG_S11][0], LOG_MAX_PROTO_NAME_LENGTH, "S11");
+  snprintf (&g_oai_log.log_proto2str[LOG_S6A][0], LOG_MAX_PROTO_NAME_LENGTH, "S6A");
+  snprintf (&g_oai_log.log_proto2str[LOG_UTIL][0], LOG_MAX_PROTO_NAME_LENGTH, "UTIL");
+  snprintf (&g_oai_log.log_proto2str[LOG_CONFIG][0], LOG_MAX_PROTO_NAME_LENGTH, "CONFIG");
+  snprintf (&g_oai_log.log_proto2str[LOG_MSC][0], LOG_MAX_PROTO_NAME_LENGTH, "MSC");
+  snprintf (&g_oai_log.log_proto2str[LOG_ITTI][0], LOG_MAX_PROTO_NAME_LENGTH, "ITTI");
+
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_TRACE][0], LOG_LEVEL_NAME_MAX_LENGTH, "TRACE");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_DEBUG][0], LOG_LEVEL_NAME_MAX_LENGTH, "DEBUG");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_INFO][0], LOG_LEVEL_NAME_MAX_LENGTH, "INFO");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_NOTICE][0], LOG_LEVEL_NAME_MAX_LENGTH, "NOTICE");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_WARNING][0], LOG_LEVEL_NAME_MAX_LENGTH, "WARNING");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_ERROR][0], LOG_LEVEL_NAME_MAX_LENGTH, "ERROR");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_CRITICAL][0], LOG_LEVEL_NAME_MAX_LENGTH, "CRITICAL");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_ALERT][0], LOG_LEVEL_NAME_MAX_LENGTH, "ALERT");
+  snprintf (&g_oai_log.log_level2str[OAILOG_LEVEL_EMERGENCY][0], LOG_LEVEL_NAME_MAX_LENGTH, "EMERGENCY");
 
   for (i=MIN_LOG_PROTOS; i < MAX_LOG_PROTOS; i++) {
     g_oai_log.log_level[i] = default_log_levelP;
@@ -492,6 +947,8 @@ log_init (
     g_oai_log.log_level2str[i][LOG_LEVEL_NAME_MAX_LENGTH-1]     = '\0';
   }
 
+  // call sites hit before the log levels were set
+  log_call_site_invalidate_all();
   log_message (thread_ctxt, OAILOG_LEVEL_INFO, LOG_UTIL, __FILE__, __LINE__, "Initializing OAI logging Done\n");
   return 0;
 }
@@ -509,65 +966,128 @@ void log_itti_connect(
 }
 
 //------------------------------------------------------------------------------
+// Not mandatory anymore, the thread context is created on the first log of a thread
 void
 log_start_use (
   void)
 {
-  pthread_t      p       = pthread_self();
-  hashtable_rc_t hash_rc = hashtable_ts_is_key_exists (g_oai_log.thread_context_htbl, (hash_key_t) p);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    lfds611_queue_use (g_oai_log.log_message_queue_p);
-    lfds611_stack_use (g_oai_log.log_free_message_queue_p);
-    log_thread_ctxt_t *thread_ctxt = calloc(1, sizeof(log_thread_ctxt_t));
-    if (thread_ctxt) {
-      thread_ctxt->tid = p;
-      hash_rc = hashtable_ts_insert(g_oai_log.thread_context_htbl, (hash_key_t) p, thread_ctxt);
-      if (HASH_TABLE_OK != hash_rc) {
-        OAI_FPRINTF_ERR("Error Could not register log thread context\n");
-        free_wrapper((void**) &thread_ctxt);
-      }
-    } else {
-      OAI_FPRINTF_ERR("Error Could not create log thread context\n");
+  log_get_thread_ctxt();
+}
+
+//------------------------------------------------------------------------------
+// Write one message on the output stream, in the log task context. Returns false if the output stream had to be closed.
+static bool log_output_message(const log_level_t log_levelP, bstring bstr, const bool with_message_numberP)
+{
+  int                                     rv = 0;
+  int                                     rv_put = 0;
+
+  if (0 == blength(bstr)) {
+    return true;
+  }
+  if ((g_oai_log.is_output_is_fd) && (!g_oai_log.log_fd)) {
+    // stream closed on a previous error, waiting for the reconnection
+    return false;
+  }
+  if (g_oai_log.is_output_is_fd) {
+    if (with_message_numberP) {
+      rv_put = fprintf (g_oai_log.log_fd, "%06" PRIu64 " ", g_oai_log.log_message_number++);
+    }
+    if (0 <= rv_put) {
+      rv_put = fputs ((const char *)bstr->data, g_oai_log.log_fd);
+    }
+  } else if (with_message_numberP) {
+    syslog (log_levelP ,"%06" PRIu64 " %s", g_oai_log.log_message_number++, bdata(bstr));
+  } else {
+    syslog (log_levelP ,"%s", bdata(bstr));
+  }
+  if (rv_put < 0) {
+    // error occured
+    OAI_FPRINTF_ERR("Error while writing log %d\n", rv_put);
+    rv = fclose (g_oai_log.log_fd);
+    if (rv != 0) {
+      OAI_FPRINTF_ERR("Error while closing Log file stream: %s\n", strerror (errno));
+    }
+    g_oai_log.log_fd = NULL;
+    // do not exit
+    if (LOG_TCP_STATE_DISABLED != g_oai_log.tcp_state) {
+      // Let ITTI LOG Timer do the reconnection
+      g_oai_log.tcp_state = LOG_TCP_STATE_NOT_CONNECTED;
+    }
+    return false;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static void log_report_dropped(log_thread_ctxt_t * const thread_ctxtP, const uint64_t droppedP, uint64_t * const reported_droppedP, const char * const whatP)
+{
+  if (droppedP != *reported_droppedP) {
+    bassignformat (g_oai_log.bin_bstr, "%08lX %" PRIu64 " %s dropped, ring full\n", thread_ctxtP->tid, droppedP - *reported_droppedP, whatP);
+    log_output_message(OAILOG_LEVEL_WARNING, g_oai_log.bin_bstr, true);
+    *reported_droppedP = droppedP;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Flush at most max_itemsP messages of the ring of a thread, returns the number of messages flushed, -1 on output error
+static int log_ring_flush(log_thread_ctxt_t * const thread_ctxtP, const int max_itemsP)
+{
+  log_ring_t                             *ring_p = thread_ctxtP->ring;
+  log_queue_item_t                       *item_p = NULL;
+  uint64_t                                head = __atomic_load_n (&ring_p->head, __ATOMIC_ACQUIRE);
+  uint64_t                                tail = ring_p->tail;
+  int                                     num_items = 0;
+  bool                                    is_output_ok = true;
+
+  while ((tail < head) && (num_items < max_itemsP) && (is_output_ok)) {
+    item_p = &ring_p->items[tail & (LOG_RING_MAX_ITEMS - 1)];
+    is_output_ok = log_output_message(item_p->log_level, item_p->bstr, true);
+    if (LOG_MESSAGE_MAX_REUSE_SIZE < item_p->bstr->mlen) {
+      // the producer will allocate a new one
+      bdestroy(item_p->bstr);
+      item_p->bstr = NULL;
     }
+    tail++;
+    num_items++;
+  }
+  __atomic_store_n (&ring_p->tail, tail, __ATOMIC_RELEASE);
+  if (is_output_ok) {
+    log_report_dropped(thread_ctxtP, ring_p->dropped, &ring_p->reported_dropped, "log messages");
   }
+  return (is_output_ok) ? num_items : -1;
 }
 
 //------------------------------------------------------------------------------
+// Round robin on the rings of all logging threads, at most LOG_FLUSH_MAX_ITEMS_PER_RING messages per ring and per round
 void
 log_flush_messages (
   void)
 {
+  log_thread_ctxt_t                      *thread_ctxt = NULL;
+  int                                     num_items = 0;
   int                                     rv = 0;
-  int                                     rv_put = 0;
-  log_queue_item_t                       *item_p = NULL;
 
+  if (g_oai_log.is_rate_limit_active) {
+    log_rate_limit_summary();
+  }
   if (g_oai_log.log_fd) {
-    while ((rv = lfds611_queue_dequeue (g_oai_log.log_message_queue_p, (void **)&item_p)) == 1) {
-      rv_put = 0;
-      if (blength(item_p->bstr) > 0) {
-        if (g_oai_log.is_output_is_fd) {
-          rv_put = fputs ((const char *)item_p->bstr->data, g_oai_log.log_fd);
-        } else {
-          syslog (item_p->log_level ,"%s", bdata(item_p->bstr));
-        }
-      }
-      btrunc(item_p->bstr, 0);
-      rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, item_p);
-      if (rv_put < 0) {
-        // error occured
-        OAI_FPRINTF_ERR("Error while writing log %d\n", rv_put);
-        rv = fclose (g_oai_log.log_fd);
-        if (rv != 0) {
-          OAI_FPRINTF_ERR("Error while closing Log file stream: %s\n", strerror (errno));
-        }
-        // do not exit
-        if (LOG_TCP_STATE_DISABLED != g_oai_log.tcp_state) {
-          // Let ITTI LOG Timer do the reconnection
-          g_oai_log.tcp_state = LOG_TCP_STATE_NOT_CONNECTED;
+    do {
+      num_items = 0;
+      for (thread_ctxt = __atomic_load_n (&g_oai_log.thread_ctxts, __ATOMIC_ACQUIRE); thread_ctxt; thread_ctxt = thread_ctxt->next) {
+        rv = log_ring_flush (thread_ctxt, LOG_FLUSH_MAX_ITEMS_PER_RING);
+        if (0 > rv) {
           return;
         }
+        num_items += rv;
+        if (thread_ctxt->bin_ring) {
+          rv = log_bin_flush_ring (thread_ctxt, LOG_FLUSH_MAX_ITEMS_PER_RING);
+          if (0 > rv) {
+            return;
+          }
+          num_items += rv;
+        }
       }
-    }
+    } while (num_items);
     fflush (g_oai_log.log_fd);
   }
 }
@@ -580,6 +1100,11 @@ log_exit (
   int                                     rv = 0;
 
   OAI_FPRINTF_INFO("[TRACE] Entering %s\n", __FUNCTION__);
+  if (g_oai_log.is_rate_limit_active) {
+    // last summary
+    __atomic_store_n (&g_oai_log.next_summary_ns, 0, __ATOMIC_RELAXED);
+    log_rate_limit_summary();
+  }
   if (g_oai_log.log_fd) {
     log_flush_messages ();
     rv = fflush (g_oai_log.log_fd);
@@ -617,17 +1142,8 @@ void log_stream_hex(
   log_queue_item_t  * message = NULL;
   size_t              octet_index = 0;
   int                 rv = 0;
-  log_thread_ctxt_t  *thread_ctxt = NULL;
-  hashtable_rc_t      hash_rc = HASH_TABLE_OK;
+  log_thread_ctxt_t  *thread_ctxt = log_get_thread_ctxt();
 
-  pthread_t             p           = pthread_self();
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    log_start_use();
-  }
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
   if (messageP) {
     log_message_start(thread_ctxt, log_levelP, protoP, &message, source_fileP, line_numP, "%s (%ld bytes)", messageP, sizeP);
   } else {
@@ -659,17 +1175,7 @@ void log_stream_hex_array(
   log_queue_item_t *  message = NULL;
   size_t              octet_index = 0;
   size_t              index = 0;
-  log_thread_ctxt_t  *thread_ctxt = NULL;
-  hashtable_rc_t      hash_rc = HASH_TABLE_OK;
-
-  pthread_t             p           = pthread_self();
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    log_start_use();
-  }
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+  log_thread_ctxt_t  *thread_ctxt = log_get_thread_ctxt();
 
   if (messageP) {
     log_message(thread_ctxt, log_levelP, protoP, source_fileP, line_numP, "%s", messageP);
@@ -684,6 +1190,7 @@ void log_stream_hex_array(
         if (octet_index != 0) {
           log_message_add(message, " |");
           log_message_finish(message);
+          message = NULL;
         }
         log_message_start(thread_ctxt, log_levelP, protoP, &message, source_fileP, line_numP, " %04ld |", octet_index);
       }
@@ -724,14 +1231,97 @@ log_message_add (
     }
   }
 }
+
+//------------------------------------------------------------------------------
+// Returns the item cached in the thread context, or a new one
+static log_queue_item_t * log_get_free_item(log_thread_ctxt_t * const thread_ctxtP)
+{
+  log_queue_item_t                       *item_p = thread_ctxtP->free_item;
+
+  if (item_p) {
+    thread_ctxtP->free_item = NULL;
+    if (NULL == item_p->bstr) {
+      item_p->bstr = bfromcstralloc(LOG_MESSAGE_MIN_ALLOC_SIZE, "");
+      AssertFatal((item_p->bstr), "Allocation of buf in log container failed");
+    } else {
+      btrunc(item_p->bstr, 0);
+    }
+    return item_p;
+  }
+  return new_queue_item();
+}
+
+//------------------------------------------------------------------------------
+static void log_put_free_item(log_thread_ctxt_t * const thread_ctxtP, log_queue_item_t * item_p)
+{
+  if ((NULL == thread_ctxtP->free_item) && ((NULL == item_p->bstr) || (LOG_MESSAGE_MAX_REUSE_SIZE >= item_p->bstr->mlen))) {
+    thread_ctxtP->free_item = item_p;
+  } else {
+    bdestroy(item_p->bstr);
+    free_wrapper ((void**) &item_p);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Write a message on the output stream in the context of the calling thread, unbuffered (not thread safe) mode
+static void log_output_message_unbuffered(log_queue_item_t * const messageP)
+{
+  if (g_oai_log.is_output_is_fd) {
+    fprintf(g_oai_log.log_fd, "%s", bdata(messageP->bstr));
+  } else {
+    syslog (messageP->log_level ,"%s", bdata(messageP->bstr));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Prefix of all log messages, the message number is added by the log task in thread safe mode
+static int log_format_header(
+  bstring bstr,
+  const bool with_message_numberP,
+  const struct timeval * const elapsed_timeP,
+  const log_thread_ctxt_t * const thread_ctxtP,
+  const int indentP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *const source_fileP,
+  const unsigned int line_numP)
+{
+  int                                     filename_length = strlen(source_fileP);
+  const char                             *source_file = source_fileP;
+
+  if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
+    source_file = &source_fileP[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH];
+  }
+  if (with_message_numberP) {
+    return bassignformat (bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
+        __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_timeP->tv_sec, elapsed_timeP->tv_usec,
+        thread_ctxtP->tid,
+        LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
+        LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
+        LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_file, line_numP,
+        indentP, " ");
+  }
+  return bassignformat (bstr, "%05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
+      elapsed_timeP->tv_sec, elapsed_timeP->tv_usec,
+      thread_ctxtP->tid,
+      LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
+      LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
+      LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_file, line_numP,
+      indentP, " ");
+}
+
 //------------------------------------------------------------------------------
 void
 log_message_finish (
   log_queue_item_t * messageP)
 {
   int                                     rv = 0;
+  log_thread_ctxt_t                      *thread_ctxt = NULL;
+  log_queue_item_t                       *item_p = NULL;
+  bstring                                 bstr = NULL;
 
   if (messageP) {
+    thread_ctxt = log_get_thread_ctxt();
     rv = bcatcstr (messageP->bstr, "\n");
 
     if (BSTR_ERR == rv) {
@@ -739,24 +1329,19 @@ log_message_finish (
     }
     // send message
     if (g_oai_log.is_output_fd_buffered) {
-      rv = lfds611_queue_enqueue (g_oai_log.log_message_queue_p, messageP);
-    } else {
-      if (g_oai_log.is_output_is_fd) {
-        fprintf(g_oai_log.log_fd, "%s", bdata(messageP->bstr));
-      } else {
-        syslog (messageP->log_level ,"%s", bdata(messageP->bstr));
-      }
-      rv = 0;
-    }
-
-    if (0 == rv) {
-      btrunc(messageP->bstr, 0);
-      rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, messageP);
-      if (0 == rv) {
-        bdestroy(messageP->bstr);
-        free_wrapper ((void**) &messageP);
+      item_p = log_ring_reserve(thread_ctxt);
+      if (item_p) {
+        // swap the buffers, no copy
+        bstr            = item_p->bstr;
+        item_p->bstr    = messageP->bstr;
+        messageP->bstr  = bstr;
+        item_p->log_level = messageP->log_level;
+        log_ring_commit(thread_ctxt);
       }
+    } else {
+      log_output_message_unbuffered(messageP);
     }
+    log_put_free_item(thread_ctxt, messageP);
   }
 }
 
@@ -774,9 +1359,8 @@ log_message_start (
 {
   va_list                                 args;
   int                                     rv              = 0;
-  int                                     filename_length = 0;
   log_thread_ctxt_t                      *thread_ctxt     = thread_ctxtP;
-  hashtable_rc_t                          hash_rc         = HASH_TABLE_OK;
+  struct timeval                          elapsed_time;
 
   if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
     return;
@@ -789,132 +1373,101 @@ log_message_start (
   }
 
   if (NULL == thread_ctxt){
-    pthread_t             p           = pthread_self();
-    hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-    if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-      // make the thread safe LFDS collections usable by this thread
-      log_start_use();
-      hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-      AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
-    }
+    thread_ctxt = log_get_thread_ctxt();
   }
 
   if (! *messageP) {
-    rv = lfds611_stack_pop (g_oai_log.log_free_message_queue_p, (void **)messageP);
+    *messageP = log_get_free_item(thread_ctxt);
+    (*messageP)->log_level = log_levelP;
+    log_get_elapsed_time_since_start(&elapsed_time);
+    rv = log_format_header((*messageP)->bstr, !g_oai_log.is_output_fd_buffered, &elapsed_time, thread_ctxt, thread_ctxt->indent,
+        log_levelP, protoP, source_fileP, line_numP);
 
-    if (0 == rv) {
-      *messageP = new_queue_item();
-      AssertFatal(*messageP, "Out of memory error");
-      OAI_FPRINTF_ERR("Warning allocating an extra log_queue_item_t in LOG\n");
-      rv = 1;
-    } else {
-      btrunc((*messageP)->bstr, 0);
+    if (BSTR_ERR == rv) {
+      OAI_FPRINTF_ERR("Error while logging message : %s", &g_oai_log.log_proto2str[protoP][0]);
+      goto error_event_start;
     }
 
-    if (1 == rv) {
-      struct timeval elapsed_time;
-
-#if DAEMONIZE
-      (*messageP)->log_level = log_levelP;
-#endif
-      log_get_elapsed_time_since_start(&elapsed_time);
-      filename_length = strlen(source_fileP);
-      if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
-        rv = bformata ((*messageP)->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-            __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-            thread_ctxt->tid,
-            LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-            LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-            LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, &source_fileP[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH], line_numP,
-            thread_ctxt->indent, " ");
-      } else {
-        rv = bformata ((*messageP)->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-            __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-            thread_ctxt->tid,
-            LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-            LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-            LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_fileP, line_numP,
-            thread_ctxt->indent, " ");
-      }
-
-      if (BSTR_ERR == rv) {
-        OAI_FPRINTF_ERR("Error while logging message : %s", &g_oai_log.log_proto2str[protoP][0]);
-        goto error_event_start;
-      }
-
-      va_start (args, format);
-      rv = bformata ((*messageP)->bstr, format, args);
-      va_end (args);
+    va_start (args, format);
+    rv = bvcformata ((*messageP)->bstr, 4096, format, args); // big number
+    va_end (args);
 
-      if (BSTR_ERR == rv) {
-        OAI_FPRINTF_ERR("Error while logging message : %s", &g_oai_log.log_proto2str[protoP][0]);
-        goto error_event_start;
-      }
-      return;
+    if (BSTR_ERR == rv) {
+      OAI_FPRINTF_ERR("Error while logging message : %s", &g_oai_log.log_proto2str[protoP][0]);
+      goto error_event_start;
     }
   }
   return;
 error_event_start:
-  // put in memory pool the message buffer
-  btrunc((*messageP)->bstr, 0);
-  rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, *messageP);
+  // put in thread cache the message buffer
+  log_put_free_item(thread_ctxt, *messageP);
+  *messageP = NULL;
   return;
 }
 
 //------------------------------------------------------------------------------
-// hard-coded to use LOG_LEVEL_TRACE
+// The level filter has already been applied by the call site, see log_call_site_is_enabled()
+static void
+log_message_unfiltered (
+  log_thread_ctxt_t * thread_ctxtP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *const source_fileP,
+  const unsigned int line_numP,
+  char *format,
+  ...)
+{
+  va_list                                 args;
+
+  va_start (args, format);
+  log_message_int(thread_ctxtP, log_levelP, protoP, source_fileP, line_numP, format, args);
+  va_end (args);
+}
+
+//------------------------------------------------------------------------------
+// hard-coded to use LOG_LEVEL_TRACE, the indent follows the calls whether the call site is enabled or not
 void
 log_func (
+  const bool  is_loggedP,
   const bool  is_enteringP,
   const log_proto_t protoP,
   const char *const source_fileP,
   const unsigned int line_numP,
   const char *const functionP)
 {
-  log_thread_ctxt_t        *thread_ctxt = NULL;
-  hashtable_rc_t            hash_rc     = HASH_TABLE_OK;
-  pthread_t                 p           = pthread_self();
+  log_thread_ctxt_t        *thread_ctxt = log_get_thread_ctxt();
 
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    log_start_use();
-  }
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
   if (is_enteringP) {
-    log_message(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Entering %s()\n", functionP);
+    if (is_loggedP) {
+      log_message_unfiltered(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Entering %s()\n", functionP);
+    }
     thread_ctxt->indent += LOG_FUNC_INDENT_SPACES;
   } else {
     thread_ctxt->indent -= LOG_FUNC_INDENT_SPACES;
     if (thread_ctxt->indent < 0) thread_ctxt->indent = 0;
-    log_message(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Leaving %s()\n", functionP);
+    if (is_loggedP) {
+      log_message_unfiltered(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Leaving %s()\n", functionP);
+    }
   }
 }
 //------------------------------------------------------------------------------
-// hard-coded to use LOG_LEVEL_TRACE
+// hard-coded to use LOG_LEVEL_TRACE, the indent follows the calls whether the call site is enabled or not
 void
 log_func_return (
+  const bool  is_loggedP,
   const log_proto_t protoP,
   const char *const source_fileP,
   const unsigned int line_numP,
   const char *const functionP,
   const long return_codeP)
 {
-  log_thread_ctxt_t        *thread_ctxt = NULL;
-  hashtable_rc_t            hash_rc     = HASH_TABLE_OK;
-  pthread_t                 p           = pthread_self();
+  log_thread_ctxt_t        *thread_ctxt = log_get_thread_ctxt();
 
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-    // make the thread safe LFDS collections usable by this thread
-    log_start_use();
-  }
-  hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-  AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
   thread_ctxt->indent -= LOG_FUNC_INDENT_SPACES;
   if (thread_ctxt->indent < 0) thread_ctxt->indent = 0;
-  log_message(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Leaving %s() (rc=%ld)\n", functionP, return_codeP);
+  if (is_loggedP) {
+    log_message_unfiltered(thread_ctxt, OAILOG_LEVEL_TRACE, protoP, source_fileP, line_numP, "Leaving %s() (rc=%ld)\n", functionP, return_codeP);
+  }
 }
 //------------------------------------------------------------------------------
 void
@@ -928,11 +1481,34 @@ log_message (
   ...)
 {
   va_list                                 args;
+
+  if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
+    return;
+  }
+  if (log_levelP > g_oai_log.log_level[protoP]) {
+    return;
+  }
+  va_start (args, format);
+  log_message_int(thread_ctxtP, log_levelP, protoP, source_fileP, line_numP, format, args);
+  va_end (args);
+}
+
+//------------------------------------------------------------------------------
+// No log level filter here, done by callers
+static void
+log_message_int (
+  log_thread_ctxt_t * thread_ctxtP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  const char *const source_fileP,
+  const unsigned int line_numP,
+  char *format,
+  va_list args)
+{
   int                                     rv              = 0;
-  int                                     filename_length = 0;
   log_queue_item_t                       *new_item_p      = NULL;
   log_thread_ctxt_t                      *thread_ctxt     = thread_ctxtP;
-  hashtable_rc_t                          hash_rc         = HASH_TABLE_OK;
+  struct timeval                          elapsed_time;
 
   if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
     return;
@@ -940,101 +1516,440 @@ log_message (
   if ((MIN_LOG_LEVEL > log_levelP) || (MAX_LOG_LEVEL <= log_levelP)) {
     return;
   }
-  if (log_levelP > g_oai_log.log_level[protoP]) {
-    return;
-  }
   if (NULL == thread_ctxt){
-    pthread_t             p           = pthread_self();
-    hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-    if (HASH_TABLE_KEY_NOT_EXISTS == hash_rc) {
-      // make the thread safe LFDS collections usable by this thread
-      log_start_use();
-      hash_rc = hashtable_ts_get (g_oai_log.thread_context_htbl, (hash_key_t) p, (void **)&thread_ctxt);
-      AssertFatal(NULL != thread_ctxt, "Could not get new log thread context\n");
+    thread_ctxt = log_get_thread_ctxt();
+  }
+
+  if (g_oai_log.is_output_fd_buffered) {
+    // format in place in the ring of the thread
+    new_item_p = log_ring_reserve(thread_ctxt);
+    if (NULL == new_item_p) {
+      return;
     }
+  } else {
+    new_item_p = log_get_free_item(thread_ctxt);
+  }
+  new_item_p->log_level = log_levelP;
+
+  log_get_elapsed_time_since_start(&elapsed_time);
+  rv = log_format_header(new_item_p->bstr, !g_oai_log.is_output_fd_buffered, &elapsed_time, thread_ctxt, thread_ctxt->indent,
+      log_levelP, protoP, source_fileP, line_numP);
+
+  if (BSTR_ERR == rv) {
+    OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
+    goto error_event;
+  }
+  rv = bvcformata (new_item_p->bstr, 4096, format, args); // big number
+
+  if (BSTR_ERR == rv) {
+    OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
+    goto error_event;
+  }
+
+  if (g_oai_log.is_output_fd_buffered) {
+    log_ring_commit(thread_ctxt);
+  } else {
+    log_output_message_unbuffered(new_item_p);
+    log_put_free_item(thread_ctxt, new_item_p);
+  }
+  return;
+error_event:
+  // the reserved ring slot is not committed, so it will be reused
+  if (!g_oai_log.is_output_fd_buffered) {
+    log_put_free_item(thread_ctxt, new_item_p);
   }
+}
 
-  rv = lfds611_stack_pop (g_oai_log.log_free_message_queue_p, (void **)&new_item_p);
+//------------------------------------------------------------------------------
+// Parse one printf conversion specification starting at '%', glibc syntax without positional arguments
+static void log_bin_parse_conversion(const char * const specP, log_bin_conversion_t * const convP)
+{
+  const char *p = specP + 1;
 
-  if (0 == rv) {
-    new_item_p = new_queue_item();
-    AssertFatal(new_item_p, "Out of memory error");
-    OAI_FPRINTF_ERR("Warning allocating an extra log_queue_item_t in LOG\n");
-    rv = 1;
+  memset(convP, 0, sizeof(*convP));
+  convP->arg_type = LOG_BIN_ARG_UNSUPPORTED;
+
+  convP->flags = p;
+  while (('-' == *p) || ('+' == *p) || (' ' == *p) || ('#' == *p) || ('0' == *p) || ('\'' == *p)) p++;
+  convP->flags_length = p - convP->flags;
+
+  convP->width = p;
+  if ('*' == *p) {
+    p++;
   } else {
-    btrunc(new_item_p->bstr, 0); // you never know
-  }
-
-  if (new_item_p) {
-    if (1 == rv) {
-      struct timeval elapsed_time;
-      log_get_elapsed_time_since_start(&elapsed_time);
-      filename_length = strlen(source_fileP);
-      if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
-        rv = bassignformat (new_item_p->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-            __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-            thread_ctxt->tid,
-            LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-            LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-            LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, &source_fileP[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH], line_numP,
-            thread_ctxt->indent, " ");
-      } else {
-        rv = bassignformat (new_item_p->bstr, "%06" PRIu64 " %05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
-            __sync_fetch_and_add (&g_oai_log.log_message_number, 1), elapsed_time.tv_sec, elapsed_time.tv_usec,
-            thread_ctxt->tid,
-            LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[log_levelP][0],
-            LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[protoP][0],
-            LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_fileP, line_numP,
-            thread_ctxt->indent, " ");
-      }
+    while (isdigit(*p)) p++;
+  }
+  convP->width_length = p - convP->width;
+
+  if ('.' == *p) {
+    p++;
+    convP->has_precision = true;
+    convP->precision = p;
+    if ('*' == *p) {
+      p++;
+    } else {
+      while (isdigit(*p)) p++;
+    }
+    convP->precision_length = p - convP->precision;
+  }
 
-      if (BSTR_ERR == rv) {
-        OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
-        goto error_event;
-      }
-      va_start (args, format);
-      rv = bvcformata (new_item_p->bstr, 4096, format, args); // big number
-      va_end (args);
+  convP->conversion = p;
+  log_bin_arg_type_t int_type = LOG_BIN_ARG_INT;
+  bool               is_long_double_or_wide = false;
+  switch (*p) {
+    case 'h': p++; if ('h' == *p) p++; break;
+    case 'l': p++; int_type = LOG_BIN_ARG_LONG; if ('l' == *p) {p++; int_type = LOG_BIN_ARG_LONG_LONG;} break;
+    case 'q': p++; int_type = LOG_BIN_ARG_LONG_LONG; break;
+    case 'j': p++; int_type = LOG_BIN_ARG_INTMAX; break;
+    case 'z':
+    case 'Z': p++; int_type = LOG_BIN_ARG_SIZE; break;
+    case 't': p++; int_type = LOG_BIN_ARG_PTRDIFF; break;
+    case 'L': p++; is_long_double_or_wide = true; break;
+    default:;
+  }
 
-      if (BSTR_ERR == rv) {
-        OAI_FPRINTF_ERR("Error while logging LOG message : %s", &g_oai_log.log_proto2str[protoP][0]);
-        goto error_event;
+  switch (*p) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      convP->arg_type = (is_long_double_or_wide) ? LOG_BIN_ARG_UNSUPPORTED : int_type;
+      break;
+    case 'c':
+      convP->arg_type = (p == convP->conversion) ? LOG_BIN_ARG_INT : LOG_BIN_ARG_UNSUPPORTED;
+      break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+      convP->arg_type = (is_long_double_or_wide) ? LOG_BIN_ARG_UNSUPPORTED : LOG_BIN_ARG_DOUBLE;
+      break;
+    case 'p':
+      convP->arg_type = LOG_BIN_ARG_POINTER;
+      break;
+    case 's':
+      // a precision may mean a non NUL terminated buffer, let the calling thread format it
+      convP->arg_type = ((p == convP->conversion) && (!convP->has_precision)) ? LOG_BIN_ARG_STRING : LOG_BIN_ARG_UNSUPPORTED;
+      break;
+    case '%':
+      convP->arg_type = (p == specP + 1) ? LOG_BIN_ARG_NONE : LOG_BIN_ARG_UNSUPPORTED;
+      break;
+    default:
+      // %n, %m, %C, %S, end of string, ...
+      convP->arg_type = LOG_BIN_ARG_UNSUPPORTED;
+      convP->length = p - specP;
+      return;
+  }
+  p++;
+  convP->conversion_length = p - convP->conversion;
+  convP->length = p - specP;
+}
+
+//------------------------------------------------------------------------------
+static void log_bin_register_call_site(log_call_site_t * const call_siteP, const char * const formatP)
+{
+  log_bin_conversion_t conv;
+  const char          *p = formatP;
+
+  pthread_mutex_lock (&g_oai_log.thread_ctxt_mutex);
+  if (0 == call_siteP->id) {
+    call_siteP->format            = formatP;
+    call_siteP->num_args          = 0;
+    call_siteP->is_binary_capable = (g_oai_log.num_call_sites < LOG_BIN_MAX_CALL_SITES);
+
+    while ((call_siteP->is_binary_capable) && (*p)) {
+      if ('%' != *p) {
+        p++;
+        continue;
+      }
+      log_bin_parse_conversion(p, &conv);
+      if (LOG_BIN_ARG_UNSUPPORTED == conv.arg_type) {
+        call_siteP->is_binary_capable = false;
+        break;
+      }
+      p += conv.length;
+      if (LOG_BIN_ARG_NONE == conv.arg_type) {
+        continue;
+      }
+      if ((call_siteP->num_args + 3) > LOG_BIN_MAX_ARGS) {
+        call_siteP->is_binary_capable = false;
+        break;
+      }
+      // a '*' width or precision is an int argument before the converted one
+      if ((1 == conv.width_length) && ('*' == conv.width[0])) {
+        call_siteP->arg_type[call_siteP->num_args++] = LOG_BIN_ARG_INT;
       }
+      if ((1 == conv.precision_length) && ('*' == conv.precision[0])) {
+        call_siteP->arg_type[call_siteP->num_args++] = LOG_BIN_ARG_INT;
+      }
+      call_siteP->arg_type[call_siteP->num_args++] = conv.arg_type;
+    }
 
-      if (g_oai_log.is_output_fd_buffered) {
-        rv = lfds611_queue_enqueue (g_oai_log.log_message_queue_p, new_item_p);
-      } else {
-        if (g_oai_log.is_output_is_fd) {
-          fprintf(g_oai_log.log_fd, "%s", bdata(new_item_p->bstr));
+    if (call_siteP->is_binary_capable) {
+      g_oai_log.call_sites[g_oai_log.num_call_sites] = call_siteP;
+      __atomic_store_n (&call_siteP->id, g_oai_log.num_call_sites, __ATOMIC_RELEASE);
+      g_oai_log.num_call_sites++;
+    } else {
+      // never registered, but do not parse it again
+      __atomic_store_n (&call_siteP->id, LOG_BIN_MAX_CALL_SITES, __ATOMIC_RELEASE);
+    }
+  }
+  pthread_mutex_unlock (&g_oai_log.thread_ctxt_mutex);
+}
+
+//------------------------------------------------------------------------------
+static log_bin_ring_t * log_bin_new_ring(log_thread_ctxt_t * const thread_ctxtP)
+{
+  log_bin_ring_t    *ring_p = calloc(1, sizeof(log_bin_ring_t));
+  AssertFatal(NULL != ring_p, "Allocation of binary log ring failed");
+  ring_p->buffer = malloc(LOG_BIN_RING_SIZE);
+  AssertFatal(NULL != ring_p->buffer, "Allocation of binary log ring buffer failed");
+
+  // rings are never freed, the log task may still have records to format after the thread exited
+  __atomic_store_n (&thread_ctxtP->bin_ring, ring_p, __ATOMIC_RELEASE);
+  return ring_p;
+}
+
+//------------------------------------------------------------------------------
+// Encode the raw arguments after the record header, then copy the record in the ring of the calling thread
+static bool log_bin_record(
+  log_call_site_t * const call_siteP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  va_list args)
+{
+  uint64_t              record[(sizeof(log_bin_record_hdr_t) / 8) + LOG_BIN_MAX_ARGS * (2 + LOG_BIN_MAX_STRING_LENGTH / 8)];
+  log_bin_record_hdr_t *hdr_p = (log_bin_record_hdr_t *)record;
+  uint8_t              *arg_p = (uint8_t *)record + sizeof(log_bin_record_hdr_t);
+  log_thread_ctxt_t    *thread_ctxt = log_get_thread_ctxt();
+  log_bin_ring_t       *ring_p = thread_ctxt->bin_ring;
+  struct timeval        elapsed_time;
+  const char           *str = NULL;
+  uint32_t              str_length = 0;
+  int                   i = 0;
+
+  if (NULL == ring_p) {
+    ring_p = log_bin_new_ring(thread_ctxt);
+  }
+
+  for (i = 0; i < call_siteP->num_args; i++) {
+    switch (call_siteP->arg_type[i]) {
+      case LOG_BIN_ARG_INT:       *(int64_t *)arg_p  = va_arg(args, int); break;
+      case LOG_BIN_ARG_LONG:      *(int64_t *)arg_p  = va_arg(args, long); break;
+      case LOG_BIN_ARG_LONG_LONG: *(int64_t *)arg_p  = va_arg(args, long long); break;
+      case LOG_BIN_ARG_SIZE:      *(uint64_t *)arg_p = va_arg(args, size_t); break;
+      case LOG_BIN_ARG_INTMAX:    *(int64_t *)arg_p  = va_arg(args, intmax_t); break;
+      case LOG_BIN_ARG_PTRDIFF:   *(int64_t *)arg_p  = va_arg(args, ptrdiff_t); break;
+      case LOG_BIN_ARG_DOUBLE:    *(double *)arg_p   = va_arg(args, double); break;
+      case LOG_BIN_ARG_POINTER:   *(uint64_t *)arg_p = (uintptr_t)va_arg(args, void *); break;
+      case LOG_BIN_ARG_STRING:
+        str = va_arg(args, const char *);
+        if (str) {
+          str_length = strnlen(str, LOG_BIN_MAX_STRING_LENGTH);
+          // may be longer, do not truncate it silently, let the caller log a text message
+          if (LOG_BIN_MAX_STRING_LENGTH == str_length) {
+            return false;
+          }
+          *(uint64_t *)arg_p = str_length;
+          memcpy(arg_p + 8, str, str_length);
+          arg_p[8 + str_length] = '\0';
+          arg_p += (str_length + 8) & ~7;
         } else {
-          syslog (new_item_p->log_level ,"%s", bdata(new_item_p->bstr));
+          *(uint64_t *)arg_p = LOG_BIN_STRING_NULL;
         }
-        rv = 0;
+        break;
+      default:
+        return false;
+    }
+    arg_p += 8;
+  }
+
+  log_get_elapsed_time_since_start(&elapsed_time);
+  hdr_p->size         = arg_p - (uint8_t *)record;
+  hdr_p->call_site_id = call_siteP->id;
+  hdr_p->log_level    = log_levelP;
+  hdr_p->proto        = protoP;
+  hdr_p->indent       = thread_ctxt->indent;
+  hdr_p->tv_sec       = elapsed_time.tv_sec;
+  hdr_p->tv_usec      = elapsed_time.tv_usec;
+  hdr_p->reserved     = 0;
+
+  // reserve contiguous space, records never wrap
+  uint64_t   tail      = __atomic_load_n (&ring_p->tail, __ATOMIC_ACQUIRE);
+  uint64_t   head      = ring_p->head;
+  uint32_t   offset    = head & (LOG_BIN_RING_SIZE - 1);
+  uint32_t   padding   = ((offset + hdr_p->size) > LOG_BIN_RING_SIZE) ? (LOG_BIN_RING_SIZE - offset) : 0;
+
+  if ((head + padding + hdr_p->size - tail) > LOG_BIN_RING_SIZE) {
+    ring_p->dropped++;
+    return true;
+  }
+  if (padding) {
+    if (padding >= sizeof(log_bin_record_hdr_t)) {
+      ((log_bin_record_hdr_t *)&ring_p->buffer[offset])->size = 0;
+    }
+    head  += padding;
+    offset = 0;
+  }
+  memcpy(&ring_p->buffer[offset], record, hdr_p->size);
+  __atomic_store_n (&ring_p->head, head + hdr_p->size, __ATOMIC_RELEASE);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Format a binary record the same way log_message() does
+static void log_bin_format_record(const log_thread_ctxt_t * const thread_ctxtP, const log_bin_record_hdr_t * const hdrP, bstring bstr)
+{
+  log_call_site_t      *call_site = g_oai_log.call_sites[hdrP->call_site_id];
+  const uint8_t        *arg_p = (const uint8_t *)hdrP + sizeof(log_bin_record_hdr_t);
+  const char           *p = call_site->format;
+  const char           *source_file = call_site->source_file;
+  int                   filename_length = strlen(source_file);
+  log_bin_conversion_t  conv;
+  char                  spec[LOG_BIN_MAX_SPEC_LENGTH];
+  int                   spec_length = 0;
+  int                   arg_index = 0;
+  uint64_t              value = 0;
+
+  if (filename_length > LOG_DISPLAYED_FILENAME_MAX_LENGTH) {
+    source_file = &source_file[filename_length-LOG_DISPLAYED_FILENAME_MAX_LENGTH];
+  }
+  bassignformat (bstr, "%05ld:%06ld %08lX %-*.*s %-*.*s %-*.*s:%04u   %*s",
+      (long)hdrP->tv_sec, (long)hdrP->tv_usec,
+      thread_ctxtP->tid,
+      LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, LOG_DISPLAYED_LOG_LEVEL_NAME_MAX_LENGTH, &g_oai_log.log_level2str[hdrP->log_level][0],
+      LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, LOG_DISPLAYED_PROTO_NAME_MAX_LENGTH, &g_oai_log.log_proto2str[hdrP->proto][0],
+      LOG_DISPLAYED_FILENAME_MAX_LENGTH, LOG_DISPLAYED_FILENAME_MAX_LENGTH, source_file, call_site->line_num,
+      (int)hdrP->indent, " ");
+
+  while (*p) {
+    if ('%' != *p) {
+      const char *literal = p;
+      while ((*p) && ('%' != *p)) p++;
+      bcatblk (bstr, literal, p - literal);
+      continue;
+    }
+    log_bin_parse_conversion(p, &conv);
+    p += conv.length;
+    if (LOG_BIN_ARG_NONE == conv.arg_type) {
+      bconchar (bstr, '%');
+      continue;
+    }
+    // rebuild the conversion with '*' replaced by the recorded values
+    spec_length = snprintf(spec, sizeof(spec), "%%%.*s", (int)conv.flags_length, conv.flags);
+    if ((1 == conv.width_length) && ('*' == conv.width[0])) {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%d", (int)*(const int64_t *)arg_p);
+      arg_p += 8;
+      arg_index++;
+    } else {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%.*s", (int)conv.width_length, conv.width);
+    }
+    if ((1 == conv.precision_length) && ('*' == conv.precision[0])) {
+      // a negative precision is taken as if it was omitted
+      if (0 <= *(const int64_t *)arg_p) {
+        spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, ".%d", (int)*(const int64_t *)arg_p);
       }
-      if (0 == rv) {
-        btrunc(new_item_p->bstr, 0);
-        rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, new_item_p);
-        if (0 == rv) {
-          OAI_FPRINTF_ERR("Error while logging LOG message : lfds611_stack_guaranteed_push %s", &g_oai_log.log_proto2str[protoP][0]);
-          bdestroy (new_item_p->bstr);
-          free_wrapper ((void**) &new_item_p);
+      arg_p += 8;
+      arg_index++;
+    } else if (conv.has_precision) {
+      spec_length += snprintf(&spec[spec_length], sizeof(spec) - spec_length, ".%.*s", (int)conv.precision_length, conv.precision);
+    }
+    snprintf(&spec[spec_length], sizeof(spec) - spec_length, "%.*s", (int)conv.conversion_length, conv.conversion);
+
+    value = *(const uint64_t *)arg_p;
+    switch (call_site->arg_type[arg_index]) {
+      case LOG_BIN_ARG_INT:       bformata (bstr, spec, (int)value); break;
+      case LOG_BIN_ARG_LONG:      bformata (bstr, spec, (long)value); break;
+      case LOG_BIN_ARG_LONG_LONG: bformata (bstr, spec, (long long)value); break;
+      case LOG_BIN_ARG_SIZE:      bformata (bstr, spec, (size_t)value); break;
+      case LOG_BIN_ARG_INTMAX:    bformata (bstr, spec, (intmax_t)value); break;
+      case LOG_BIN_ARG_PTRDIFF:   bformata (bstr, spec, (ptrdiff_t)value); break;
+      case LOG_BIN_ARG_DOUBLE:    bformata (bstr, spec, *(const double *)arg_p); break;
+      case LOG_BIN_ARG_POINTER:   bformata (bstr, spec, (void *)(uintptr_t)value); break;
+      case LOG_BIN_ARG_STRING:
+        if (LOG_BIN_STRING_NULL == value) {
+          bformata (bstr, spec, "(null)");
+        } else {
+          bformata (bstr, spec, (const char *)arg_p + 8);
+          arg_p += (value + 8) & ~7;
         }
-      }
-    } else {
-      AssertFatal(0, "Should not go here");
-      bdestroy (new_item_p->bstr);
-      free_wrapper ((void**) &new_item_p);
-      OAI_FPRINTF_ERR("Error while lfds611_stack_pop()\n");
+        break;
+      default:;
     }
+    arg_p += 8;
+    arg_index++;
   }
+}
 
-  return;
-error_event:
-  btrunc(new_item_p->bstr, 0);
-  rv = lfds611_stack_guaranteed_push (g_oai_log.log_free_message_queue_p, new_item_p);
-  if (0 == rv) {
-    bdestroy (new_item_p->bstr);
-    free_wrapper ((void**) &new_item_p);
+//------------------------------------------------------------------------------
+// Called by the log task only, the single consumer of all rings, returns the number of records flushed, -1 on output error
+static int log_bin_flush_ring(log_thread_ctxt_t * const thread_ctxtP, const int max_recordsP)
+{
+  log_bin_ring_t             *ring_p = __atomic_load_n (&thread_ctxtP->bin_ring, __ATOMIC_ACQUIRE);
+  const log_bin_record_hdr_t *hdr_p  = NULL;
+  uint64_t                    head   = __atomic_load_n (&ring_p->head, __ATOMIC_ACQUIRE);
+  uint64_t                    tail   = ring_p->tail;
+  uint32_t                    offset = 0;
+  int                         num_records = 0;
+  bool                        is_output_ok = true;
+
+  while ((tail < head) && (num_records < max_recordsP) && (is_output_ok)) {
+    offset = tail & (LOG_BIN_RING_SIZE - 1);
+    hdr_p  = (const log_bin_record_hdr_t *)&ring_p->buffer[offset];
+    if (((LOG_BIN_RING_SIZE - offset) < sizeof(log_bin_record_hdr_t)) || (0 == hdr_p->size)) {
+      tail += LOG_BIN_RING_SIZE - offset;
+      continue;
+    }
+    log_bin_format_record(thread_ctxtP, hdr_p, g_oai_log.bin_bstr);
+    tail += hdr_p->size;
+    num_records++;
+    is_output_ok = log_output_message(hdr_p->log_level, g_oai_log.bin_bstr, true);
+  }
+  __atomic_store_n (&ring_p->tail, tail, __ATOMIC_RELEASE);
+  if (is_output_ok) {
+    log_report_dropped(thread_ctxtP, ring_p->dropped, &ring_p->reported_dropped, "binary log records");
   }
+  return (is_output_ok) ? num_records : -1;
 }
 
+//------------------------------------------------------------------------------
+void
+log_message_site (
+  log_call_site_t * const call_siteP,
+  const log_level_t log_levelP,
+  const log_proto_t protoP,
+  char *format,
+  ...)
+{
+  va_list                                 args;
+  uint32_t                                id = 0;
+  bool                                    is_recorded = false;
+
+  if ((MIN_LOG_PROTOS > protoP) || (MAX_LOG_PROTOS <= protoP)) {
+    return;
+  }
+  if ((MIN_LOG_LEVEL > log_levelP) || (MAX_LOG_LEVEL <= log_levelP)) {
+    return;
+  }
+  // no log level filter, done by log_call_site_is_enabled(), rules may enable the call site whatever the level is
+  if ((g_oai_log.is_rate_limit_active) && (!log_rate_limit_conforms (call_siteP, log_levelP, protoP))) {
+    // no log task to do it
+    if (!g_oai_log.is_output_fd_buffered) {
+      log_rate_limit_summary();
+    }
+    return;
+  }
+
+  if (g_oai_log.is_output_binary) {
+    id = __atomic_load_n (&call_siteP->id, __ATOMIC_ACQUIRE);
+    if (0 == id) {
+      log_bin_register_call_site(call_siteP, format);
+      id = call_siteP->id;
+    }
+    // a format that is not a literal may change between calls
+    if ((LOG_BIN_MAX_CALL_SITES > id) && (format == call_siteP->format)) {
+      va_start (args, format);
+      is_recorded = log_bin_record(call_siteP, log_levelP, protoP, args);
+      va_end (args);
+    }
+  }
+  if (!is_recorded) {
+    va_start (args, format);
+    log_message_int(NULL, log_levelP, protoP, call_siteP->source_file, call_siteP->line_num, format, args);
+    va_end (args);
+  }
+}
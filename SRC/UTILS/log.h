@@ -49,7 +49,19 @@ extern int fd_g_debug_lvl;
 #define LOG_CONFIG_STRING_LOGGING                        "LOGGING"
 #define LOG_CONFIG_STRING_OUTPUT                         "OUTPUT"
 #define LOG_CONFIG_STRING_OUTPUT_THREAD_SAFE             "THREAD_SAFE"
+#define LOG_CONFIG_STRING_OUTPUT_BINARY                  "BINARY"
 #define LOG_CONFIG_STRING_COLOR                          "COLOR"
+#define LOG_CONFIG_STRING_CALL_SITES_ENABLED             "CALL_SITES_ENABLED"
+#define LOG_CONFIG_STRING_CALL_SITES_DISABLED            "CALL_SITES_DISABLED"
+#define LOG_CONFIG_STRING_RATE_LIMITS                    "RATE_LIMITS"
+#define LOG_CONFIG_STRING_PROTOCOL                       "PROTOCOL"
+#define LOG_CONFIG_STRING_ALL_PROTOCOLS                  "ALL"
+#define LOG_CONFIG_STRING_MESSAGES_PER_SEC               "MESSAGES_PER_SEC"
+#define LOG_CONFIG_STRING_BURST                          "BURST"
+#define LOG_CONFIG_STRING_CALL_SITE_MESSAGES_PER_SEC     "CALL_SITE_MESSAGES_PER_SEC"
+#define LOG_CONFIG_STRING_CALL_SITE_BURST                "CALL_SITE_BURST"
+#define LOG_CONFIG_STRING_SAMPLING                       "SAMPLING"
+#define LOG_CONFIG_STRING_SUPPRESSED_SUMMARY_PERIOD      "SUPPRESSED_SUMMARY_PERIOD_SEC"
 #define LOG_CONFIG_STRING_OUTPUT_CONSOLE                 "CONSOLE"
 #define LOG_CONFIG_STRING_OUTPUT_SYSLOG                  "SYSLOG"
 #define LOG_CONFIG_STRING_GTPV1U_LOG_LEVEL               "GTPV1U_LOG_LEVEL"
@@ -88,6 +100,11 @@ typedef enum {
   MAX_LOG_LEVEL
 } log_level_t;
 
+/* Least severe level compiled in, numeric value of log_level_t since it is tested by the preprocessor */
+#if !defined(LOG_OAI_MIN_LEVEL)
+#  define LOG_OAI_MIN_LEVEL  8 /* OAILOG_LEVEL_TRACE */
+#endif
+
 typedef enum {
   MIN_LOG_PROTOS = 0,
   LOG_UDP = MIN_LOG_PROTOS,
@@ -109,18 +126,10 @@ typedef enum {
   MAX_LOG_PROTOS,
 } log_proto_t;
 
-/*! \struct  log_thread_ctxt_t
-* \brief Structure containing a thread context.
-*/
-typedef struct log_thread_ctxt_s {
-  int indent;
-  pthread_t tid;
-} log_thread_ctxt_t;
-
 /*! \struct  log_queue_item_t
 * \brief Structure containing a string to be logged.
-* This structure is pushed in thread safe queues by thread producers of logs.
-* This structure is then popped by a dedicated thread that will write the string
+* This structure is pushed in the ring of the thread producer of the log.
+* This structure is then popped by the log task that will write the string
 * in the opened stream ( file, tcp, stdout)
 */
 typedef struct log_queue_item_s {
@@ -128,6 +137,76 @@ typedef struct log_queue_item_s {
   bstring                                 bstr;      /*!< \brief string containing the message. */
 } log_queue_item_t;
 
+/*! \struct  log_thread_ctxt_t
+* \brief Structure containing a thread context, reached through a thread local pointer.
+* The rings are written by the thread only and read by the log task only.
+*/
+typedef struct log_thread_ctxt_s {
+  int indent;
+  pthread_t tid;
+  struct log_ring_s        *ring;       /*!< \brief Formatted messages of this thread, see log.c. */
+  struct log_bin_ring_s    *bin_ring;   /*!< \brief Binary records of this thread, allocated on first use, see log.c. */
+  log_queue_item_t         *free_item;  /*!< \brief Cached item for log_message_start() and the unbuffered mode. */
+  struct log_thread_ctxt_s *next;       /*!< \brief List of all thread contexts, walked by the log task. */
+} log_thread_ctxt_t;
+
+#define LOG_BIN_MAX_ARGS                 16
+
+/*! \struct  log_call_site_t
+* \brief Static descriptor of a log statement, one instance per OAILOG_xxx() call site.
+* In binary mode the call site is registered on its first hit, then the records pushed by the calling
+* thread only carry its id, a timestamp and the raw arguments, the formatting is done by the log task.
+*/
+typedef struct log_call_site_s {
+  uint32_t      id;                              /*!< \brief Index in the call site table, 0 while not registered. */
+  const char   *source_file;                     /*!< \brief __FILE__ of the call site. */
+  unsigned int  line_num;                        /*!< \brief __LINE__ of the call site. */
+  const char   *format;                          /*!< \brief Format string seen at registration time. */
+  bool          is_binary_capable;               /*!< \brief False if the format cannot be recorded raw (%n, %m, %ls, %.Ns...). */
+  uint8_t       num_args;                        /*!< \brief Number of arguments consumed by the format, including '*' ones. */
+  uint8_t       arg_type[LOG_BIN_MAX_ARGS];      /*!< \brief C type of each argument, see log_bin_arg_type_t in log.c. */
+  int8_t        state;                           /*!< \brief Cached result of the runtime filters, see log_call_site_state_t. */
+  uint64_t      tat_ns;                          /*!< \brief Rate limit: theoretical arrival time of the next message (GCRA). */
+  uint32_t      num_hits;                        /*!< \brief Sampling: enabled hits counter. */
+  uint32_t      suppressed_rate;                 /*!< \brief Dropped by a rate limit since the last summary. */
+  uint32_t      suppressed_sampling;             /*!< \brief Dropped by sampling since the last summary. */
+  bool          is_listed;                       /*!< \brief Already in the list of hit call sites. */
+  struct log_call_site_s *next;                  /*!< \brief List of hit call sites, walked when a filter changes. */
+} log_call_site_t;
+
+/*! \enum  log_call_site_state_t
+* \brief Cached result of the runtime filters of a call site, tested before the evaluation of the log arguments.
+* Any change of a log level or of a call site rule resets all call sites to LOG_CALL_SITE_STATE_UNKNOWN.
+*/
+typedef enum {
+  LOG_CALL_SITE_STATE_UNKNOWN = 0,   /* static init value, filters evaluated on next hit */
+  LOG_CALL_SITE_STATE_ENABLED,
+  LOG_CALL_SITE_STATE_DISABLED,
+} log_call_site_state_t;
+
+#define LOG_MAX_CALL_SITE_RULES          32
+
+/*! \struct  log_call_site_rule_t
+* \brief Overrides the log level filter of matching call sites.
+*/
+typedef struct log_call_site_rule_s {
+  bstring       location;                        /*!< \brief "source file[:line]", the file is matched as a path suffix, no line means all lines. */
+  bool          is_enabled;
+} log_call_site_rule_t;
+
+
+/*! \struct  log_rate_limit_config_t
+* \brief Rate limits and sampling of the log messages of a protocol, 0 means no limit.
+* EMERGENCY, ALERT and CRITICAL messages are never limited.
+*/
+typedef struct log_rate_limit_config_s {
+  uint32_t      messages_per_sec;                /*!< \brief Token bucket shared by all the call sites of the protocol. */
+  uint32_t      burst;
+  uint32_t      call_site_messages_per_sec;      /*!< \brief Token bucket of each call site of the protocol. */
+  uint32_t      call_site_burst;
+  uint32_t      sampling;                        /*!< \brief Keep 1 message out of N, counted per call site. */
+} log_rate_limit_config_t;
+
 /*! \struct  log_config_t
 * \brief Structure containing the dynamically configurable parameters of the Logging facilities.
 * This structure is filled by configuration facilities when parsing a configuration file.
@@ -135,6 +214,7 @@ typedef struct log_queue_item_s {
 typedef struct log_config_s {
   bstring       output;             /*!< \brief Where logs go, choice in { "CONSOLE", "`path to file`", "`IPv4@`:`TCP port num`"} . */
   bool          is_output_thread_safe; /*!< \brief Is final string goes in a thread safe buffer of is flushed without care . */
+  bool          is_output_binary;   /*!< \brief Record raw arguments in per-thread rings, format them in the log task (requires is_output_thread_safe). */
   log_level_t   udp_log_level;      /*!< \brief UDP ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
   log_level_t   gtpv1u_log_level;   /*!< \brief GTPv1-U ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
   log_level_t   gtpv2c_log_level;   /*!< \brief GTPv2-C ITTI task log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
@@ -150,14 +230,21 @@ typedef struct log_config_s {
   log_level_t   itti_log_level;     /*!< \brief ITTI layer log level starting from OAILOG_LEVEL_EMERGENCY up to MAX_LOG_LEVEL (no log) */
   uint8_t       asn1_verbosity_level; /*!< \brief related to asn1c generated code for S1AP verbosity level */
   bool          color;              /*!< \brief use of ANSI styling codes or no */
+  int                  num_call_site_rules;
+  log_call_site_rule_t call_site_rule[LOG_MAX_CALL_SITE_RULES]; /*!< \brief Per call site enable/disable, applied in order */
+  log_rate_limit_config_t rate_limit[MAX_LOG_PROTOS];           /*!< \brief Per protocol rate limits and sampling */
+  uint32_t      suppressed_summary_period_sec; /*!< \brief Period of the summary of the messages dropped by rate limits and sampling */
 } log_config_t;
 
 # if LOG_OAI
 
 void log_connect_to_server(void);
 void log_set_config(const log_config_t * const config);
+struct config_setting_t;
+void log_config_parse(const struct config_setting_t * const setting, log_config_t * const config);
 const char * log_level_int2str(const log_level_t log_level);
 log_level_t log_level_str2int(const char * const log_level_str);
+log_proto_t log_proto_str2int(const char * const log_proto_str);
 
 int log_init(
   const log_env_t envP,
@@ -207,7 +294,8 @@ void log_message_start (
 
 void
 log_func (
-  bool  is_entering,
+  const bool  is_logged,
+  const bool  is_entering,
   const log_proto_t protoP,
   const char *const source_fileP,
   const unsigned int line_numP,
@@ -215,6 +303,7 @@ log_func (
 
 void
 log_func_return (
+  const bool  is_loggedP,
   const log_proto_t protoP,
   const char *const source_fileP,
   const unsigned int line_numP,
@@ -230,47 +319,111 @@ void log_message (
       char *format,
       ...) __attribute__ ((format (printf, 6, 7)));
 
+void log_message_site (
+      log_call_site_t * const call_siteP,
+      const log_level_t log_levelP,
+      const log_proto_t protoP,
+      char *format,
+      ...) __attribute__ ((format (printf, 4, 5)));
+
+bool log_call_site_refresh (
+      log_call_site_t * const call_siteP,
+      const log_level_t log_levelP,
+      const log_proto_t protoP);
+
+int log_call_site_set_rule (const char * const locationP, const bool is_enabledP);
+void log_call_site_clear_rules (void);
+
 int log_get_start_time_sec (void);
 
+//------------------------------------------------------------------------------
+// Called before the evaluation of the arguments of a log, the slow path is taken only after a filter change
+static inline bool log_call_site_is_enabled (
+      log_call_site_t * const call_siteP,
+      const log_level_t log_levelP,
+      const log_proto_t protoP)
+{
+  int8_t state = __atomic_load_n (&call_siteP->state, __ATOMIC_RELAXED);
+
+  if (__builtin_expect (LOG_CALL_SITE_STATE_DISABLED == state, 1)) {
+    return false;
+  }
+  if (LOG_CALL_SITE_STATE_ENABLED == state) {
+    return true;
+  }
+  return log_call_site_refresh (call_siteP, log_levelP, protoP);
+}
+
+#    define OAILOG_CALL_SITE_DO(lOgLeVeL, pRoTo, sTaTeMeNt)               do { \
+                                                                   static log_call_site_t _oailog_call_site_ = {.source_file = __FILE__, .line_num = __LINE__}; \
+                                                                   if (log_call_site_is_enabled(&_oailog_call_site_, lOgLeVeL, pRoTo)) { \
+                                                                     sTaTeMeNt; \
+                                                                   } \
+                                                                 } while(0) /*!< \brief static call site descriptor, statement executed only if the call site is enabled */
+#    define OAILOG_CALL_SITE_IS_ENABLED(lOgLeVeL, pRoTo)               ({ \
+                                                                   static log_call_site_t _oailog_call_site_ = {.source_file = __FILE__, .line_num = __LINE__}; \
+                                                                   log_call_site_is_enabled(&_oailog_call_site_, lOgLeVeL, pRoTo); \
+                                                                 }) /*!< \brief static call site descriptor, for statements that have work to do even if the call site is disabled */
+#    define OAILOG_CALL_SITE(lOgLeVeL, pRoTo, ...)                      OAILOG_CALL_SITE_DO(lOgLeVeL, pRoTo, \
+                                                                   log_message_site(&_oailog_call_site_, lOgLeVeL, pRoTo, ##__VA_ARGS__)) /*!< \brief see log_call_site_t */
+
 #    define OAILOG_SET_CONFIG                                           log_set_config
+#    define OAILOG_CONFIG_PARSE                                         log_config_parse
 #    define OAILOG_LEVEL_STR2INT                                        log_level_str2int
 #    define OAILOG_LEVEL_INT2STR                                        log_level_int2str
+#    define OAILOG_PROTO_STR2INT                                        log_proto_str2int
 #    define OAILOG_INIT                                                 log_init
 #    define OAILOG_START_USE                                            log_start_use
 #    define OAILOG_ITTI_CONNECT                                         log_itti_connect
 #    define OAILOG_EXIT()                                               log_exit()
-#    define OAILOG_SPEC(pRoTo, ...)                                     do { log_message(NULL, OAILOG_LEVEL_NOTICE,   pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)/*!< \brief 3GPP trace on specifications */
-#    define OAILOG_EMERGENCY(pRoTo, ...)                                do { log_message(NULL, OAILOG_LEVEL_EMERGENCY,pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)/*!< \brief system is unusable */
-#    define OAILOG_ALERT(pRoTo, ...)                                    do { log_message(NULL, OAILOG_LEVEL_ALERT,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief action must be taken immediately */
-#    define OAILOG_CRITICAL(pRoTo, ...)                                 do { log_message(NULL, OAILOG_LEVEL_CRITICAL, pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief critical conditions */
-#    define OAILOG_ERROR(pRoTo, ...)                                    do { log_message(NULL, OAILOG_LEVEL_ERROR,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief error conditions */
-#    define OAILOG_WARNING(pRoTo, ...)                                  do { log_message(NULL, OAILOG_LEVEL_WARNING,  pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief warning conditions */
-#    define OAILOG_NOTICE(pRoTo, ...)                                   do { log_message(NULL, OAILOG_LEVEL_NOTICE,   pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief normal but significant condition */
-#    define OAILOG_INFO(pRoTo, ...)                                     do { log_message(NULL, OAILOG_LEVEL_INFO,     pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief informational */
+#    define OAILOG_EMERGENCY(pRoTo, ...)                                OAILOG_CALL_SITE(OAILOG_LEVEL_EMERGENCY, pRoTo, ##__VA_ARGS__) /*!< \brief system is unusable */
+#    if LOG_OAI_MIN_LEVEL >= 1
+#      define OAILOG_ALERT(pRoTo, ...)                                  OAILOG_CALL_SITE(OAILOG_LEVEL_ALERT, pRoTo, ##__VA_ARGS__) /*!< \brief action must be taken immediately */
+#    endif
+#    if LOG_OAI_MIN_LEVEL >= 2
+#      define OAILOG_CRITICAL(pRoTo, ...)                               OAILOG_CALL_SITE(OAILOG_LEVEL_CRITICAL, pRoTo, ##__VA_ARGS__) /*!< \brief critical conditions */
+#    endif
+#    if LOG_OAI_MIN_LEVEL >= 3
+#      define OAILOG_ERROR(pRoTo, ...)                                  OAILOG_CALL_SITE(OAILOG_LEVEL_ERROR, pRoTo, ##__VA_ARGS__) /*!< \brief error conditions */
+#    endif
+#    if LOG_OAI_MIN_LEVEL >= 4
+#      define OAILOG_WARNING(pRoTo, ...)                                OAILOG_CALL_SITE(OAILOG_LEVEL_WARNING, pRoTo, ##__VA_ARGS__) /*!< \brief warning conditions */
+#    endif
+#    if LOG_OAI_MIN_LEVEL >= 5
+#      define OAILOG_SPEC(pRoTo, ...)                                   OAILOG_CALL_SITE(OAILOG_LEVEL_NOTICE, pRoTo, ##__VA_ARGS__) /*!< \brief 3GPP trace on specifications */
+#      define OAILOG_NOTICE(pRoTo, ...)                                 OAILOG_CALL_SITE(OAILOG_LEVEL_NOTICE, pRoTo, ##__VA_ARGS__) /*!< \brief normal but significant condition */
+#    endif
+#    if LOG_OAI_MIN_LEVEL >= 6
+#      define OAILOG_INFO(pRoTo, ...)                                   OAILOG_CALL_SITE(OAILOG_LEVEL_INFO, pRoTo, ##__VA_ARGS__) /*!< \brief informational */
+#    endif
 #    define OAILOG_MESSAGE_START(lOgLeVeL, pRoTo, cOnTeXt, ...)         do { log_message_start(NULL, lOgLeVeL, pRoTo, cOnTeXt, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief when need to log only 1 message with many char messages, ex formating a dumped struct */
 #    define OAILOG_MESSAGE_ADD(cOnTeXt, ...)                            do { log_message_add(cOnTeXt, ##__VA_ARGS__); } while(0) /*!< \brief can be called as many times as needed after OAILOG_MESSAGE_START() */
 #    define OAILOG_MESSAGE_FINISH(cOnTeXt)                              do { log_message_finish(cOnTeXt); } while(0) /*!< \brief Send the message built by OAILOG_MESSAGE_START() n*LOG_MESSAGE_ADD() (n=0..N) */
 #    define OAILOG_STREAM_HEX(lOgLeVeL, pRoTo, mEsSaGe, sTrEaM, sIzE)   do { \
-                                                                   OAI_GCC_DIAG_OFF(pointer-sign); \
-                                                                   log_stream_hex(lOgLeVeL, pRoTo, __FILE__, __LINE__, mEsSaGe, sTrEaM, sIzE);\
-                                                                   OAI_GCC_DIAG_ON(pointer-sign); \
+                                                                   if ((lOgLeVeL) <= LOG_OAI_MIN_LEVEL) { \
+                                                                     OAI_GCC_DIAG_OFF(pointer-sign); \
+                                                                     OAILOG_CALL_SITE_DO(lOgLeVeL, pRoTo, log_stream_hex(lOgLeVeL, pRoTo, __FILE__, __LINE__, mEsSaGe, sTrEaM, sIzE));\
+                                                                     OAI_GCC_DIAG_ON(pointer-sign); \
+                                                                   } \
                                                                  } while(0); /*!< \brief trace buffer content */
-#    if DEBUG_IS_ON
-#      define OAILOG_DEBUG(pRoTo, ...)                                  do { log_message(NULL, OAILOG_LEVEL_DEBUG,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief debug informations */
-#      if TRACE_IS_ON
-#        define OAILOG_EXTERNAL(lOgLeVeL, pRoTo, ...)                   do { log_message(NULL, lOgLeVeL       ,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0)
-#        define OAILOG_TRACE(pRoTo, ...)                                do { log_message(NULL, OAILOG_LEVEL_TRACE,    pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief most detailled informations, struct dumps */
-#        define OAILOG_FUNC_IN(pRoTo)                                   do { log_func(true, pRoTo, __FILE__, __LINE__, __FUNCTION__); } while(0) /*!< \brief informational */
-#        define OAILOG_FUNC_OUT(pRoTo)                                  do { log_func(false, pRoTo, __FILE__, __LINE__, __FUNCTION__); return;} while(0) /*!< \brief informational */
-#        define OAILOG_FUNC_RETURN(pRoTo, rEtUrNcOdE)                   do { log_func_return(pRoTo, __FILE__, __LINE__, __FUNCTION__, (long)rEtUrNcOdE); return rEtUrNcOdE;} while(0) /*!< \brief informational */
-#        define OAILOG_STREAM_HEX_ARRAY(pRoTo, mEsSaGe, sTrEaM, sIzE)       do { log_stream_hex_array(OAILOG_LEVEL_TRACE, pRoTo, __FILE__, __LINE__, mEsSaGe, sTrEaM, sIzE); } while(0) /*!< \brief trace buffer content with indexes */
+#    if DEBUG_IS_ON && (LOG_OAI_MIN_LEVEL >= 7)
+#      define OAILOG_DEBUG(pRoTo, ...)                                  OAILOG_CALL_SITE(OAILOG_LEVEL_DEBUG, pRoTo, ##__VA_ARGS__) /*!< \brief debug informations */
+#      if TRACE_IS_ON && (LOG_OAI_MIN_LEVEL >= 8)
+#        define OAILOG_EXTERNAL(lOgLeVeL, pRoTo, ...)                   do { log_message(NULL, lOgLeVeL, pRoTo, __FILE__, __LINE__, ##__VA_ARGS__); } while(0) /*!< \brief level known at run time only, filtered in log.c */
+#        define OAILOG_TRACE(pRoTo, ...)                                OAILOG_CALL_SITE(OAILOG_LEVEL_TRACE, pRoTo, ##__VA_ARGS__) /*!< \brief most detailled informations, struct dumps */
+#        define OAILOG_FUNC_IN(pRoTo)                                   log_func(OAILOG_CALL_SITE_IS_ENABLED(OAILOG_LEVEL_TRACE, pRoTo), true, pRoTo, __FILE__, __LINE__, __FUNCTION__) /*!< \brief informational, the indent is kept even if the call site is disabled */
+#        define OAILOG_FUNC_OUT(pRoTo)                                  do { log_func(OAILOG_CALL_SITE_IS_ENABLED(OAILOG_LEVEL_TRACE, pRoTo), false, pRoTo, __FILE__, __LINE__, __FUNCTION__); return;} while(0) /*!< \brief informational, the indent is kept even if the call site is disabled */
+#        define OAILOG_FUNC_RETURN(pRoTo, rEtUrNcOdE)                   do { log_func_return(OAILOG_CALL_SITE_IS_ENABLED(OAILOG_LEVEL_TRACE, pRoTo), pRoTo, __FILE__, __LINE__, __FUNCTION__, (long)rEtUrNcOdE); return rEtUrNcOdE;} while(0) /*!< \brief informational, the indent is kept even if the call site is disabled */
+#        define OAILOG_STREAM_HEX_ARRAY(pRoTo, mEsSaGe, sTrEaM, sIzE)   OAILOG_CALL_SITE_DO(OAILOG_LEVEL_TRACE, pRoTo, log_stream_hex_array(OAILOG_LEVEL_TRACE, pRoTo, __FILE__, __LINE__, mEsSaGe, sTrEaM, sIzE)) /*!< \brief trace buffer content with indexes */
 #      endif
 #    endif
 #  else
 #    define OAILOG_SPEC(...)
 #    define OAILOG_SET_CONFIG(a)
+#    define OAILOG_CONFIG_PARSE(a,b)
 #    define OAILOG_LEVEL_STR2INT(a)                                     OAILOG_LEVEL_EMERGENCY
 #    define OAILOG_LEVEL_INT2STR(a)                                     "EMERGENCY"
+#    define OAILOG_PROTO_STR2INT(a)                                     MAX_LOG_PROTOS
 #    define OAILOG_INIT(a,b,c)                                          0
 #    define OAILOG_START_USE()
 #    define OAILOG_ITTI_CONNECT()
@@ -287,6 +440,27 @@ int log_get_start_time_sec (void);
 #    define OAILOG_MESSAGE_FINISH(cOnTeXt)
 #  endif
 
+#  if !defined(OAILOG_ALERT)
+#    define OAILOG_ALERT(...)
+#  endif
+#  if !defined(OAILOG_CRITICAL)
+#    define OAILOG_CRITICAL(...)
+#  endif
+#  if !defined(OAILOG_ERROR)
+#    define OAILOG_ERROR(...)
+#  endif
+#  if !defined(OAILOG_WARNING)
+#    define OAILOG_WARNING(...)
+#  endif
+#  if !defined(OAILOG_SPEC)
+#    define OAILOG_SPEC(...)
+#  endif
+#  if !defined(OAILOG_NOTICE)
+#    define OAILOG_NOTICE(...)
+#  endif
+#  if !defined(OAILOG_INFO)
+#    define OAILOG_INFO(...)
+#  endif
 #  if !defined(OAILOG_DEBUG)
 #    define OAILOG_DEBUG(...)                                           {void;}
 #  endif
@@ -300,10 +474,10 @@ int log_get_start_time_sec (void);
 #    define OAILOG_FUNC_IN(pRoTo)                                       (void)(pRoTo)
 #  endif
 #  if !defined(OAILOG_FUNC_OUT)
-#    define OAILOG_FUNC_OUT(pRoTo)                                      do{ return;} while 0
+#    define OAILOG_FUNC_OUT(pRoTo)                                      do{ return;} while(0)
 #  endif
 #  if !defined(OAILOG_FUNC_RETURN)
-#    define OAILOG_FUNC_RETURN(pRoTo, rEtUrNcOdE)                       do{ return rEtUrNcOdE;} while 0
+#    define OAILOG_FUNC_RETURN(pRoTo, rEtUrNcOdE)                       do{ return rEtUrNcOdE;} while(0)
 #  endif
 #  if !defined(OAILOG_STREAM_HEX)
 #    define OAILOG_STREAM_HEX(...)                                      {void;}
@@ -34,6 +34,7 @@
  * Timer Constants
  ******************************************************************************/
 #define MME_STATISTIC_TIMER_S  (60)
+#define MME_T3413_TIMER_S      (4)  ///< Paging retransmission (s)
 
 /*******************************************************************************
  * GTPV1 User Plane Constants
@@ -60,6 +61,7 @@
  ******************************************************************************/
 
 #define SCTP_RECV_BUFFER_SIZE (1 << 16)
+#define SCTP_RECV_BUFFER_POOL_ITEMS (256)   /* receive buffers handed to S1AP at once, virtual memory of SCTP_RECV_BUFFER_SIZE each */
 #define SCTP_OUT_STREAMS      (32)
 #define SCTP_IN_STREAMS       (32)
 #define SCTP_MAX_ATTEMPTS     (5)
@@ -77,5 +79,18 @@
 
 #define RELATIVE_CAPACITY       (15)
 
+#define M_TMSI_PREFIX_BITS      (2)     ///< Default most significant M-TMSI bits reserved for a prefix
+#define M_TMSI_PREFIX           (0)     ///< Default prefix of the M-TMSIs allocated by this MME
+
+/*******************************************************************************
+ * Overload control Constants
+ ******************************************************************************/
+
+#define MME_OVERLOAD_TIMER_MS             (200)  ///< Period of the load evaluation (ms)
+#define MME_OVERLOAD_START_LOAD           (80)   ///< Load (percent) from which OVERLOAD START is sent
+#define MME_OVERLOAD_STOP_LOAD            (50)   ///< Load (percent) under which OVERLOAD STOP is sent
+#define MME_OVERLOAD_MAX_S6A_TRANSACTIONS (256)  ///< S6a requests without answer at 100% load
+#define MME_OVERLOAD_MAX_S11_TRANSACTIONS (256)  ///< S11 requests without response at 100% load
+
 
 #endif /* FILE_MME_DEFAULT_VALUES_SEEN */
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file nas_pdu_copy.c
+   \brief Counters of the bytes of uplink NAS PDUs copied between the SCTP receive buffer and the NAS decoder.
+*/
+#include <stdint.h>
+#include <stddef.h>
+
+#include "nas_pdu_copy.h"
+
+static nas_pdu_copy_stats_t             g_nas_pdu_copy_stats = {0};
+
+//------------------------------------------------------------------------------
+void nas_pdu_copy_count (const nas_pdu_copy_t where, const size_t length)
+{
+  if (where < NAS_PDU_COPY_MAX) {
+    __atomic_fetch_add (&g_nas_pdu_copy_stats.copies[where], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add (&g_nas_pdu_copy_stats.bytes[where], length, __ATOMIC_RELAXED);
+  }
+}
+
+//------------------------------------------------------------------------------
+void nas_pdu_copy_uplink_message (void)
+{
+  __atomic_fetch_add (&g_nas_pdu_copy_stats.uplink_messages, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+void nas_pdu_copy_get_stats (nas_pdu_copy_stats_t * const stats)
+{
+  int                                     i = 0;
+
+  stats->uplink_messages = __atomic_load_n (&g_nas_pdu_copy_stats.uplink_messages, __ATOMIC_RELAXED);
+  for (i = 0; i < NAS_PDU_COPY_MAX; i++) {
+    stats->copies[i] = __atomic_load_n (&g_nas_pdu_copy_stats.copies[i], __ATOMIC_RELAXED);
+    stats->bytes[i]  = __atomic_load_n (&g_nas_pdu_copy_stats.bytes[i], __ATOMIC_RELAXED);
+  }
+}
+
+//------------------------------------------------------------------------------
+double nas_pdu_copy_bytes_per_message (const nas_pdu_copy_stats_t * const stats)
+{
+  uint64_t                                bytes = 0;
+  int                                     i = 0;
+
+  if (0 == stats->uplink_messages) {
+    return 0;
+  }
+  for (i = 0; i < NAS_PDU_COPY_MAX; i++) {
+    bytes += stats->bytes[i];
+  }
+  return (double)bytes / (double)stats->uplink_messages;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file nas_pdu_copy.h
+   \brief Counters of the bytes of uplink NAS PDUs copied between the SCTP receive buffer and the NAS decoder.
+   The SCTP receive buffer, taken from a pool, is the payload of SCTP_DATA_IND, the NAS-PDU buffer of the decoded S1AP
+   message is the NAS message of the ITTI message and the NAS decoder reads the NAS message in place. The places where
+   the bytes of an uplink NAS PDU still have to be copied count them.
+*/
+
+#ifndef FILE_NAS_PDU_COPY_SEEN
+#define FILE_NAS_PDU_COPY_SEEN
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum nas_pdu_copy_e {
+  NAS_PDU_COPY_S1AP = 0,      ///< NAS-PDU of the decoded S1AP message into the ITTI message
+  NAS_PDU_COPY_NAS,           ///< Security protected NAS message into a plain NAS message buffer
+  NAS_PDU_COPY_MAX
+} nas_pdu_copy_t;
+
+typedef struct nas_pdu_copy_stats_s {
+  uint64_t                    uplink_messages;               // uplink NAS messages handed to the NAS decoder
+  uint64_t                    copies[NAS_PDU_COPY_MAX];
+  uint64_t                    bytes[NAS_PDU_COPY_MAX];
+} nas_pdu_copy_stats_t;
+
+/** \brief Counts length bytes of an uplink NAS PDU copied at where. */
+void nas_pdu_copy_count(const nas_pdu_copy_t where, const size_t length);
+
+/** \brief Counts an uplink NAS message handed to the NAS decoder. */
+void nas_pdu_copy_uplink_message(void);
+
+void nas_pdu_copy_get_stats(nas_pdu_copy_stats_t * const stats);
+
+/** \brief Bytes copied per uplink NAS message since the start. */
+double nas_pdu_copy_bytes_per_message(const nas_pdu_copy_stats_t * const stats);
+
+#endif /* FILE_NAS_PDU_COPY_SEEN */
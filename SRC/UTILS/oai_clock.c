@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file oai_clock.c
+   \brief Coarse clock cached by a ticker thread and precise clock of the process.
+*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#include "assertions.h"
+#include "oai_clock.h"
+
+/* Reads of a thread, counters are only written by their thread */
+typedef struct oai_clock_thread_reads_s {
+  uint64_t                             coarse_reads;
+  uint64_t                             precise_reads;
+  struct oai_clock_thread_reads_s     *next;
+} oai_clock_thread_reads_t;
+
+typedef struct oai_clock_s {
+  uint64_t                    monotonic_ns;       // cached by the ticker thread
+  uint64_t                    realtime_ns;
+  uint64_t                    ticks;
+  uint32_t                    tick_us;
+  bool                        is_ticking;
+  pthread_t                   ticker;
+  pthread_mutex_t             thread_reads_mutex;
+  oai_clock_thread_reads_t   *thread_reads;       // never freed, the counts of exited threads remain
+} oai_clock_t;
+
+static oai_clock_t                             g_oai_clock = {
+  .thread_reads_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+static __thread oai_clock_thread_reads_t      *oai_clock_thread_reads_p = NULL;
+
+//------------------------------------------------------------------------------
+static inline uint64_t oai_clock_read_ns (const clockid_t clock_id)
+{
+  struct timespec                         ts;
+
+  clock_gettime (clock_id, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static inline void oai_clock_ns_to_timeval (const uint64_t ns, struct timeval * const tv)
+{
+  tv->tv_sec  = ns / 1000000000;
+  tv->tv_usec = (ns % 1000000000) / 1000;
+}
+
+//------------------------------------------------------------------------------
+static oai_clock_thread_reads_t * oai_clock_new_thread_reads (void)
+{
+  oai_clock_thread_reads_t *thread_reads = calloc (1, sizeof (oai_clock_thread_reads_t));
+
+  AssertFatal (NULL != thread_reads, "Could not allocate the clock reads of the thread\n");
+  pthread_mutex_lock (&g_oai_clock.thread_reads_mutex);
+  thread_reads->next = g_oai_clock.thread_reads;
+  g_oai_clock.thread_reads = thread_reads;
+  pthread_mutex_unlock (&g_oai_clock.thread_reads_mutex);
+  oai_clock_thread_reads_p = thread_reads;
+  return thread_reads;
+}
+
+//------------------------------------------------------------------------------
+static inline oai_clock_thread_reads_t * oai_clock_get_thread_reads (void)
+{
+  if (NULL == oai_clock_thread_reads_p) {
+    return oai_clock_new_thread_reads ();
+  }
+  return oai_clock_thread_reads_p;
+}
+
+//------------------------------------------------------------------------------
+// Single writer, a plain increment that the stats may read at any time
+static inline void oai_clock_count (uint64_t * const counterP)
+{
+  __atomic_store_n (counterP, *counterP + 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static void oai_clock_tick (void)
+{
+  __atomic_store_n (&g_oai_clock.monotonic_ns, oai_clock_read_ns (CLOCK_MONOTONIC), __ATOMIC_RELAXED);
+  __atomic_store_n (&g_oai_clock.realtime_ns, oai_clock_read_ns (CLOCK_REALTIME), __ATOMIC_RELAXED);
+  __atomic_fetch_add (&g_oai_clock.ticks, 1, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+static void *oai_clock_ticker (__attribute__ ((unused)) void *args_p)
+{
+  struct timespec                         next = {0};
+
+  clock_gettime (CLOCK_MONOTONIC, &next);
+  while (__atomic_load_n (&g_oai_clock.is_ticking, __ATOMIC_ACQUIRE)) {
+    next.tv_nsec += g_oai_clock.tick_us * 1000;
+    while (next.tv_nsec >= 1000000000) {
+      next.tv_nsec -= 1000000000;
+      next.tv_sec++;
+    }
+    // absolute time, the period does not drift with the time spent refreshing
+    while (EINTR == clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL));
+    oai_clock_tick ();
+  }
+  return NULL;
+}
+
+//------------------------------------------------------------------------------
+// The ticker thread does not survive a fork, the child falls back to the coarse clocks of the kernel
+static void oai_clock_atfork_child (void)
+{
+  __atomic_store_n (&g_oai_clock.is_ticking, false, __ATOMIC_RELAXED);
+}
+
+//------------------------------------------------------------------------------
+int oai_clock_init (const uint32_t tick_us)
+{
+  static bool                             is_atfork_registered = false;
+
+  if ((0 == tick_us) || (g_oai_clock.is_ticking)) {
+    return (0 == tick_us) ? -1 : 0;
+  }
+  if (!is_atfork_registered) {
+    if (pthread_atfork (NULL, NULL, oai_clock_atfork_child)) {
+      return -1;
+    }
+    is_atfork_registered = true;
+  }
+  g_oai_clock.tick_us = tick_us;
+  oai_clock_tick ();
+  __atomic_store_n (&g_oai_clock.is_ticking, true, __ATOMIC_RELEASE);
+  if (pthread_create (&g_oai_clock.ticker, NULL, oai_clock_ticker, NULL)) {
+    __atomic_store_n (&g_oai_clock.is_ticking, false, __ATOMIC_RELEASE);
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+void oai_clock_exit (void)
+{
+  if (__atomic_exchange_n (&g_oai_clock.is_ticking, false, __ATOMIC_ACQ_REL)) {
+    pthread_join (g_oai_clock.ticker, NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint64_t oai_clock_coarse_ns (void)
+{
+  oai_clock_count (&oai_clock_get_thread_reads ()->coarse_reads);
+  if (__atomic_load_n (&g_oai_clock.is_ticking, __ATOMIC_RELAXED)) {
+    return __atomic_load_n (&g_oai_clock.monotonic_ns, __ATOMIC_RELAXED);
+  }
+  return oai_clock_read_ns (CLOCK_MONOTONIC_COARSE);
+}
+
+//------------------------------------------------------------------------------
+void oai_clock_coarse_monotonic (struct timeval * const tv)
+{
+  oai_clock_ns_to_timeval (oai_clock_coarse_ns (), tv);
+}
+
+//------------------------------------------------------------------------------
+void oai_clock_coarse_realtime (struct timeval * const tv)
+{
+  oai_clock_count (&oai_clock_get_thread_reads ()->coarse_reads);
+  if (__atomic_load_n (&g_oai_clock.is_ticking, __ATOMIC_RELAXED)) {
+    oai_clock_ns_to_timeval (__atomic_load_n (&g_oai_clock.realtime_ns, __ATOMIC_RELAXED), tv);
+    return;
+  }
+  oai_clock_ns_to_timeval (oai_clock_read_ns (CLOCK_REALTIME_COARSE), tv);
+}
+
+//------------------------------------------------------------------------------
+uint64_t oai_clock_precise_ns (void)
+{
+  oai_clock_count (&oai_clock_get_thread_reads ()->precise_reads);
+  return oai_clock_read_ns (CLOCK_MONOTONIC);
+}
+
+//------------------------------------------------------------------------------
+void oai_clock_get_stats (oai_clock_stats_t * const stats)
+{
+  oai_clock_thread_reads_t               *thread_reads = NULL;
+
+  stats->coarse_reads  = 0;
+  stats->precise_reads = 0;
+  pthread_mutex_lock (&g_oai_clock.thread_reads_mutex);
+  for (thread_reads = g_oai_clock.thread_reads; thread_reads; thread_reads = thread_reads->next) {
+    stats->coarse_reads  += __atomic_load_n (&thread_reads->coarse_reads, __ATOMIC_RELAXED);
+    stats->precise_reads += __atomic_load_n (&thread_reads->precise_reads, __ATOMIC_RELAXED);
+  }
+  pthread_mutex_unlock (&g_oai_clock.thread_reads_mutex);
+  stats->ticks   = __atomic_load_n (&g_oai_clock.ticks, __ATOMIC_RELAXED);
+  stats->tick_us = (__atomic_load_n (&g_oai_clock.is_ticking, __ATOMIC_RELAXED)) ? g_oai_clock.tick_us : 0;
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file oai_clock.h
+   \brief Clocks of the process.
+   The coarse clock is the monotonic and the wall clock time cached by a ticker thread every tick: a read is one load and never
+   enters the kernel, the time is late by up to a tick. It stamps the log lines, the MSC events and the ITTI dump, and arms
+   the GTPv2-C timers. Without ticker thread (oai_clock_init() not called, or in the child of a fork), it reads
+   CLOCK_MONOTONIC_COARSE and CLOCK_REALTIME_COARSE. Call oai_clock_init() after the fork of a daemon.
+   The precise clock is CLOCK_MONOTONIC, read through the vDSO (TSC on x86 when it is the clock source of the kernel), for
+   latency measurements.
+*/
+
+#ifndef FILE_OAI_CLOCK_SEEN
+#define FILE_OAI_CLOCK_SEEN
+
+#include <stdint.h>
+#include <sys/time.h>
+
+#define OAI_CLOCK_TICK_US   (4000)    ///< Period of the ticker thread (us), the resolution of the kernel coarse clocks at HZ=250
+
+typedef struct oai_clock_stats_s {
+  uint64_t                    coarse_reads;       // by all the threads since the start
+  uint64_t                    precise_reads;
+  uint64_t                    ticks;
+  uint32_t                    tick_us;            // 0 without ticker thread
+} oai_clock_stats_t;
+
+/** \brief Starts the ticker thread of the coarse clock, refreshed every tick_us. */
+int oai_clock_init(const uint32_t tick_us);
+
+/** \brief Stops the ticker thread, the coarse clock falls back to the coarse clocks of the kernel. */
+void oai_clock_exit(void);
+
+/** \brief Coarse monotonic time (ns). */
+uint64_t oai_clock_coarse_ns(void);
+
+/** \brief Coarse monotonic time, as a timeval for the protocol timers. */
+void oai_clock_coarse_monotonic(struct timeval * const tv);
+
+/** \brief Coarse wall clock time, as gettimeofday(). */
+void oai_clock_coarse_realtime(struct timeval * const tv);
+
+/** \brief Precise monotonic time (ns). */
+uint64_t oai_clock_precise_ns(void);
+
+void oai_clock_get_stats(oai_clock_stats_t * const stats);
+
+#endif /* FILE_OAI_CLOCK_SEEN */
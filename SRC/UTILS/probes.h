@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file probes.h
+   \brief Static tracepoints (USDT) of the control plane, provider "oai", for perf, bpftrace or systemtap.
+   With TRACE_USDT the probes are compiled as sys/sdt.h markers: a nop in the code and a note in the ELF, nothing runs until a
+   tracer attaches. Without TRACE_USDT the probes and their arguments are removed.
+   Probes and arguments:
+     itti_send          message_id, message_number, origin task, destination task, instance
+     itti_receive       message_id, message_number, task, origin task
+     timer_fire         timer_id, task, instance, timer argument
+     sctp_rx            assoc_id, stream, length
+     sctp_tx            assoc_id, stream, length
+     s1ap_decode_start  assoc_id, stream, length
+     s1ap_decode_done   assoc_id, stream, procedure code, direction, rc
+     s1ap_encode_start  procedure code, direction
+     s1ap_encode_done   procedure code, direction, length, rc
+     s1ap_ue_rx         procedure code, assoc_id, enb_ue_s1ap_id, mme_ue_s1ap_id
+     s1ap_ue_tx         procedure code, assoc_id, enb_ue_s1ap_id, mme_ue_s1ap_id
+     nas_decode_start   ue_id, length
+     nas_decode_done    ue_id, message type, rc
+     nas_encrypt_start  ue_id, security header type
+     nas_encrypt_done   ue_id, security header type, length
+     s6a_air            imsi (string)
+     s6a_aia            imsi (string), result code
+     s6a_ulr            imsi (string)
+     s6a_ula            imsi (string), result code
+     s11_request        GTPv2-C message type, local teid, remote teid
+     s11_response       GTPv2-C message type, local teid
+   Example scripts are in SCRIPTS/bpftrace.
+*/
+#ifndef FILE_PROBES_SEEN
+#define FILE_PROBES_SEEN
+
+#if TRACE_USDT
+#  include <sys/sdt.h>
+#  define OAI_PROBE1(nAME, a1)                         DTRACE_PROBE1 (oai, nAME, a1)
+#  define OAI_PROBE2(nAME, a1, a2)                     DTRACE_PROBE2 (oai, nAME, a1, a2)
+#  define OAI_PROBE3(nAME, a1, a2, a3)                 DTRACE_PROBE3 (oai, nAME, a1, a2, a3)
+#  define OAI_PROBE4(nAME, a1, a2, a3, a4)             DTRACE_PROBE4 (oai, nAME, a1, a2, a3, a4)
+#  define OAI_PROBE5(nAME, a1, a2, a3, a4, a5)         DTRACE_PROBE5 (oai, nAME, a1, a2, a3, a4, a5)
+#else
+#  define OAI_PROBE1(nAME, a1)
+#  define OAI_PROBE2(nAME, a1, a2)
+#  define OAI_PROBE3(nAME, a1, a2, a3)
+#  define OAI_PROBE4(nAME, a1, a2, a3, a4)
+#  define OAI_PROBE5(nAME, a1, a2, a3, a4, a5)
+#endif
+
+#endif /* FILE_PROBES_SEEN */